@@ -117,7 +117,7 @@ os_error_t AppIntegration::initializeModularApps() {
     ESP_LOGI(TAG, "Installing available modular apps");
 
     // Install Calendar App
-    InstallResult result = s_modularAppManager.installAppFromFile("/packages/calendar.app");
+    InstallResult result = s_modularAppManager.installAppFromFile(OS_APP_PACKAGE_DIR "/calendar.app");
     if (result == InstallResult::SUCCESS) {
         ESP_LOGI(TAG, "Calendar app installed successfully");
     } else {
@@ -125,7 +125,7 @@ os_error_t AppIntegration::initializeModularApps() {
     }
 
     // Install Enhanced Terminal App
-    result = s_modularAppManager.installAppFromFile("/packages/enhanced_terminal.app");
+    result = s_modularAppManager.installAppFromFile(OS_APP_PACKAGE_DIR "/enhanced_terminal.app");
     if (result == InstallResult::SUCCESS) {
         ESP_LOGI(TAG, "Enhanced terminal app installed successfully");
     } else {
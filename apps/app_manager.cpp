@@ -2,7 +2,11 @@
 #include "../system/os_manager.h"
 #include "../system/event_system.h"
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <algorithm>
+#include <cstring>
 
 static const char* TAG = "AppManager";
 
@@ -26,6 +30,7 @@ os_error_t AppManager::initialize() {
                    [this](const EventData& event) { handleAppEvent(event); });
 
     m_lastCleanup = millis();
+    m_lastLaunchAt = m_lastCleanup;
     m_initialized = true;
 
     ESP_LOGI(TAG, "Application Manager initialized");
@@ -39,12 +44,18 @@ os_error_t AppManager::shutdown() {
 
     ESP_LOGI(TAG, "Shutting down Application Manager");
 
-    // Kill all running applications
+    // Drop the warm pool, waiting for a prepare() in progress, then kill all running applications
+    while (!m_warmApps.empty()) {
+        dropWarmApp(m_warmApps.begin()->first);
+    }
     killAllApps();
 
     // Clear registry
     m_appFactories.clear();
     m_runningApps.clear();
+    m_appArenas.clear();
+    m_appBusyUs.clear();
+    m_pendingLaunches.clear();
     m_currentAppId.clear();
 
     m_initialized = false;
@@ -62,7 +73,14 @@ os_error_t AppManager::update(uint32_t deltaTime) {
     for (auto& [appId, app] : m_runningApps) {
         if (app && app->isRunning()) {
             try {
-                app->update(deltaTime);
+                {
+                    OS_PROFILE_APP(OS().getProfiler(), app->getProfileWindow());
+                    OS_TRACE_SCOPE(TraceRecorder::intern(appId));
+                    app->update(deltaTime);
+                }
+                if (!m_pendingLaunches.empty()) {
+                    recordLaunch(appId);
+                }
                 
                 // Check if app requested exit
                 if (app->isExitRequested()) {
@@ -77,8 +95,15 @@ os_error_t AppManager::update(uint32_t deltaTime) {
         }
     }
 
-    // Periodic cleanup
+    updatePrelaunch();
+
     uint32_t now = millis();
+    if (now - m_lastCpuUpdate >= 1000) {
+        updateCpuUsage();
+        m_lastCpuUpdate = now;
+    }
+
+    // Periodic cleanup
     if (now - m_lastCleanup >= 10000) { // Every 10 seconds
         cleanupStoppedApps();
         enforceResourceLimits();
@@ -128,30 +153,67 @@ os_error_t AppManager::launchApp(const std::string& appId) {
         return OS_ERROR_INVALID_PARAM;
     }
 
-    // Check if app is already running
-    if (isAppRunning(appId)) {
+    int64_t startUs = esp_timer_get_time();
+    m_lastLaunchAt = millis();
+
+    // Check if app is already running (or only hibernated)
+    if (isAppRunning(appId) || isAppHibernated(appId)) {
         ESP_LOGW(TAG, "Application '%s' is already running", appId.c_str());
         return switchToApp(appId);
     }
 
-    // Check resource limits
-    if (m_runningApps.size() >= m_maxConcurrentApps) {
+    // Check resource limits; hibernating a background app frees a slot
+    if (m_runningApps.size() >= m_maxConcurrentApps && !makeRoom()) {
         ESP_LOGW(TAG, "Maximum concurrent apps reached (%d)", m_maxConcurrentApps);
         return OS_ERROR_BUSY;
     }
 
-    // Create application instance
-    auto app = createApp(appId);
+    bool warm = false;
+    os_error_t result = startInstance(appId, nullptr, &warm);
+    if (result != OS_OK) {
+        return result;
+    }
+    m_totalLaunches++;
+    m_pendingLaunches[appId] = {startUs, warm};
+
+    ESP_LOGI(TAG, "Launched application '%s'%s", appId.c_str(), warm ? " from the warm pool" : "");
+
+    // Switch to the new app
+    return switchToApp(appId);
+}
+
+os_error_t AppManager::startInstance(const std::string& appId, const std::vector<uint8_t>* snapshot,
+                                     bool* fromWarmPool) {
+    // A prelaunched instance has already been prepared and initialised
+    auto app = takeWarmApp(appId);
+    if (fromWarmPool) {
+        *fromWarmPool = app != nullptr;
+    }
+
+    os_error_t result;
     if (!app) {
-        ESP_LOGE(TAG, "Failed to create application '%s'", appId.c_str());
-        return OS_ERROR_GENERIC;
+        app = createApp(appId);
+        if (!app) {
+            ESP_LOGE(TAG, "Failed to create application '%s'", appId.c_str());
+            return OS_ERROR_GENERIC;
+        }
+
+        // Cold start: the data phase runs here, on the main thread
+        result = app->prepare();
+        if (result != OS_OK) {
+            ESP_LOGE(TAG, "Failed to prepare application '%s': %d", appId.c_str(), result);
+            return result;
+        }
+
+        result = initializeInstance(appId, *app);
+        if (result != OS_OK) {
+            return result;
+        }
     }
 
-    // Initialize the application
-    os_error_t result = app->initialize();
-    if (result != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize application '%s': %d", appId.c_str(), result);
-        return result;
+    // A snapshot that does not apply leaves the app as freshly initialised
+    if (snapshot && app->restoreSnapshot(*snapshot) != OS_OK) {
+        ESP_LOGW(TAG, "Could not restore snapshot of '%s'", appId.c_str());
     }
 
     // Start the application
@@ -159,17 +221,225 @@ os_error_t AppManager::launchApp(const std::string& appId) {
     if (result != OS_OK) {
         ESP_LOGE(TAG, "Failed to start application '%s': %d", appId.c_str(), result);
         app->shutdown();
+        app.reset();
+        releaseArena(appId);
         return result;
     }
 
-    // Add to running apps
+    // Add to running apps; the profiler window is looked up once, here
+    app->attachProfileWindow(OS().getProfiler().addApp(appId));
     m_runningApps[appId] = std::move(app);
-    m_totalLaunches++;
+    return OS_OK;
+}
 
-    ESP_LOGI(TAG, "Launched application '%s'", appId.c_str());
+os_error_t AppManager::initializeInstance(const std::string& appId, BaseApp& app) {
+    // Give the app its own arena before it allocates anything
+    // (the map key outlives the app, so it is safe to use as the arena name)
+    auto arenaIt = m_appArenas.emplace(appId, nullptr).first;
+    arenaIt->second = std::make_unique<MemoryArena>(OS().getMemoryManager(), arenaIt->first.c_str());
+    app.attachArena(arenaIt->second.get());
 
-    // Switch to the new app
-    return switchToApp(appId);
+    // Initialize the application
+    os_error_t result = app.initialize();
+    if (result != OS_OK) {
+        ESP_LOGE(TAG, "Failed to initialize application '%s': %d", appId.c_str(), result);
+        releaseArena(appId);
+    }
+    return result;
+}
+
+void AppManager::setPrelaunchApps(const std::vector<std::string>& appIds) {
+    m_prelaunchApps = appIds;
+    m_prelaunchFailed.clear();
+}
+
+os_error_t AppManager::prelaunchApp(const std::string& appId) {
+    if (!m_initialized || appId.empty()) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    if (m_appFactories.find(appId) == m_appFactories.end()) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    if (isAppRunning(appId) || isAppHibernated(appId) || isAppWarm(appId)) {
+        return OS_OK;
+    }
+    if (m_preparing || m_warmApps.size() >= OS_APP_WARM_POOL ||
+        m_runningApps.size() + m_warmApps.size() >= m_maxConcurrentApps) {
+        return OS_ERROR_BUSY;
+    }
+
+    auto app = createApp(appId);
+    if (!app) {
+        return OS_ERROR_GENERIC;
+    }
+
+    auto warm = std::make_unique<WarmApp>();
+    warm->appId = appId;
+    warm->app = std::move(app);
+    m_preparing = warm.get();
+    m_warmApps[appId] = std::move(warm);
+
+    // One worker at a time; it deletes itself when prepare() returns
+    if (xTaskCreatePinnedToCore(prepareTask, "app_prepare", OS_APP_PREPARE_TASK_STACK, m_preparing,
+                                OS_APP_PREPARE_TASK_PRIORITY, nullptr, OS_APP_PREPARE_TASK_CORE) != pdPASS) {
+        ESP_LOGW(TAG, "No worker task for '%s', preparing inline", appId.c_str());
+        m_preparing->result = m_preparing->app->prepare();
+        m_preparing->phase.store(WarmApp::PREPARED);
+    }
+
+    ESP_LOGI(TAG, "Prelaunching application '%s'", appId.c_str());
+    return OS_OK;
+}
+
+void AppManager::prepareTask(void* param) {
+    WarmApp* warm = static_cast<WarmApp*>(param);
+    int64_t start = esp_timer_get_time();
+
+    try {
+        warm->result = warm->app->prepare();
+    } catch (...) {
+        warm->result = OS_ERROR_GENERIC;
+    }
+    warm->prepareMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+    // Publishes result and prepareMs to the main thread
+    warm->phase.store(WarmApp::PREPARED);
+    OS().wake();
+    vTaskDelete(nullptr);
+}
+
+void AppManager::finishPrepared(WarmApp& warm) {
+    if (m_preparing == &warm) {
+        m_preparing = nullptr;
+    }
+
+    if (warm.result != OS_OK) {
+        ESP_LOGW(TAG, "Prelaunch of '%s' failed in prepare(): %d", warm.appId.c_str(), warm.result);
+        warm.app.reset();
+        warm.phase.store(WarmApp::FAILED);
+        m_prelaunchFailed.push_back(warm.appId);
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (initializeInstance(warm.appId, *warm.app) != OS_OK) {
+        warm.app.reset();
+        warm.phase.store(WarmApp::FAILED);
+        m_prelaunchFailed.push_back(warm.appId);
+        return;
+    }
+
+    warm.phase.store(WarmApp::READY);
+    m_totalPrelaunches++;
+    ESP_LOGI(TAG, "Prelaunched application '%s' (prepare %d ms, initialize %d ms)", warm.appId.c_str(),
+             warm.prepareMs, (int)((esp_timer_get_time() - start) / 1000));
+}
+
+std::unique_ptr<BaseApp> AppManager::takeWarmApp(const std::string& appId) {
+    auto it = m_warmApps.find(appId);
+    if (it == m_warmApps.end()) {
+        return nullptr;
+    }
+
+    // Launched while its data is still loading: the rest of prepare() is
+    // still less than starting over
+    WarmApp& warm = *it->second;
+    while (warm.phase.load() == WarmApp::PREPARING) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    if (warm.phase.load() == WarmApp::PREPARED) {
+        finishPrepared(warm);
+    }
+
+    std::unique_ptr<BaseApp> app;
+    if (warm.phase.load() == WarmApp::READY) {
+        app = std::move(warm.app);
+    }
+    m_warmApps.erase(it);
+    return app;
+}
+
+bool AppManager::dropWarmApp(const std::string& appId) {
+    auto it = m_warmApps.find(appId);
+    if (it == m_warmApps.end()) {
+        return false;
+    }
+
+    WarmApp& warm = *it->second;
+    while (warm.phase.load() == WarmApp::PREPARING) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    if (m_preparing == &warm) {
+        m_preparing = nullptr;
+    }
+    if (warm.phase.load() == WarmApp::READY) {
+        warm.app->shutdown();
+        warm.app.reset();
+        releaseArena(appId);
+    }
+    m_warmApps.erase(it);
+    return true;
+}
+
+void AppManager::updatePrelaunch() {
+    // Finish on the main thread what the worker has prepared
+    for (auto it = m_warmApps.begin(); it != m_warmApps.end();) {
+        if (it->second->phase.load() == WarmApp::PREPARED) {
+            finishPrepared(*it->second);
+        }
+        if (it->second->phase.load() == WarmApp::FAILED) {
+            it = m_warmApps.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Start the next prelaunch once boot and the last launch have settled
+    if (m_preparing || m_prelaunchApps.empty() || millis() - m_lastLaunchAt < OS_APP_PRELAUNCH_DELAY_MS ||
+        m_warmApps.size() >= OS_APP_WARM_POOL ||
+        m_runningApps.size() + m_warmApps.size() >= m_maxConcurrentApps ||
+        getTotalMemoryUsage() >= OS_APP_HEAP_SIZE * 0.8) {
+        return;
+    }
+
+    for (const auto& appId : m_prelaunchApps) {
+        if (isAppRunning(appId) || isAppHibernated(appId) || isAppWarm(appId) ||
+            std::find(m_prelaunchFailed.begin(), m_prelaunchFailed.end(), appId) != m_prelaunchFailed.end()) {
+            continue;
+        }
+        if (prelaunchApp(appId) != OS_OK) {
+            m_prelaunchFailed.push_back(appId);
+        }
+        break;
+    }
+}
+
+void AppManager::recordLaunch(const std::string& appId) {
+    auto it = m_pendingLaunches.find(appId);
+    if (it == m_pendingLaunches.end()) {
+        return;
+    }
+
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - it->second.startUs) / 1000);
+    AppLaunchStats& stats = m_launchStats[appId];
+    stats.launches++;
+    stats.warmLaunches += it->second.warm ? 1 : 0;
+    stats.lastMs = ms;
+    stats.maxMs = std::max(stats.maxMs, ms);
+    stats.totalMs += ms;
+
+    ESP_LOGI(TAG, "Application '%s' reached its first update %d ms after launch (%s)",
+             appId.c_str(), ms, it->second.warm ? "warm" : "cold");
+    m_pendingLaunches.erase(it);
+}
+
+bool AppManager::getLaunchStats(const std::string& appId, AppLaunchStats& stats) const {
+    auto it = m_launchStats.find(appId);
+    if (it == m_launchStats.end()) {
+        return false;
+    }
+    stats = it->second;
+    return true;
 }
 
 os_error_t AppManager::killApp(const std::string& appId) {
@@ -177,9 +447,23 @@ os_error_t AppManager::killApp(const std::string& appId) {
         return OS_ERROR_INVALID_PARAM;
     }
 
+    m_lastUsed.erase(appId);
+    m_pendingLaunches.erase(appId);
+    bool wasWarm = dropWarmApp(appId);
+    auto hibernated = m_hibernatedApps.find(appId);
+    bool instanceKept = hibernated == m_hibernatedApps.end() || hibernated->second.instanceKept;
+    if (hibernated != m_hibernatedApps.end()) {
+        dropHibernated(appId);
+    }
+
     auto it = m_runningApps.find(appId);
     if (it == m_runningApps.end()) {
-        return OS_ERROR_NOT_FOUND;
+        if (!instanceKept) {
+            m_totalKills++;
+            ESP_LOGI(TAG, "Killed hibernated application '%s'", appId.c_str());
+            return OS_OK;
+        }
+        return wasWarm ? OS_OK : OS_ERROR_NOT_FOUND;
     }
 
     auto& app = it->second;
@@ -189,8 +473,12 @@ os_error_t AppManager::killApp(const std::string& appId) {
         app->shutdown();
     }
 
-    // Remove from running apps
+    OS().getProfiler().removeApp(appId);
+    m_appBusyUs.erase(appId);
+
+    // Remove from running apps, then drop the whole arena in one operation
     m_runningApps.erase(it);
+    releaseArena(appId);
     m_totalKills++;
 
     // Switch to another app if this was the current one
@@ -238,10 +526,18 @@ os_error_t AppManager::switchToApp(const std::string& appId) {
         return OS_ERROR_INVALID_PARAM;
     }
 
+    if (isAppHibernated(appId)) {
+        os_error_t result = wakeApp(appId);
+        if (result != OS_OK) {
+            return result;
+        }
+    }
+
     BaseApp* app = getApp(appId);
     if (!app || !app->isRunning()) {
         return OS_ERROR_NOT_FOUND;
     }
+    m_lastUsed[appId] = millis();
 
     if (m_currentAppId == appId) {
         return OS_OK; // Already current
@@ -270,6 +566,190 @@ os_error_t AppManager::switchToApp(const std::string& appId) {
     return OS_OK;
 }
 
+os_error_t AppManager::hibernateApp(const std::string& appId) {
+    if (!m_initialized || appId.empty()) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    auto it = m_runningApps.find(appId);
+    if (it == m_runningApps.end() || !it->second) {
+        return isAppHibernated(appId) ? OS_OK : OS_ERROR_NOT_FOUND;
+    }
+    if (appId == m_currentAppId) {
+        return OS_ERROR_BUSY;
+    }
+    BaseApp* app = it->second.get();
+    if (app->isHibernated()) {
+        return OS_OK;
+    }
+
+    HibernatedApp entry;
+    entry.hadUI = app->hasUI();
+    entry.footprint = app->getMemoryUsage();
+    entry.hibernatedAt = millis();
+
+    os_error_t result = app->hibernate();
+    if (result != OS_OK) {
+        return result;
+    }
+
+    // With a snapshot the instance can go; without one it stays, minus its UI
+    std::vector<uint8_t> snapshot;
+    entry.instanceKept = app->saveSnapshot(snapshot) != OS_OK ||
+                         storeSnapshot(appId, snapshot, entry) != OS_OK;
+    if (!entry.instanceKept) {
+        app->shutdown();
+        OS().getProfiler().removeApp(appId);
+        m_appBusyUs.erase(appId);
+        m_runningApps.erase(it);
+        releaseArena(appId);
+    }
+
+    m_hibernatedApps[appId] = entry;
+    m_totalHibernations++;
+
+    ESP_LOGI(TAG, "Hibernated application '%s' (%d KB, %s)", appId.c_str(), entry.footprint / 1024,
+             entry.instanceKept ? "UI only" : entry.spilled ? "snapshot on flash" : "snapshot in PSRAM");
+    return OS_OK;
+}
+
+os_error_t AppManager::wakeApp(const std::string& appId) {
+    auto hibernated = m_hibernatedApps.find(appId);
+    if (hibernated == m_hibernatedApps.end()) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    HibernatedApp entry = hibernated->second;
+    uint32_t start = millis();
+
+    if (!entry.instanceKept) {
+        if (m_runningApps.size() >= m_maxConcurrentApps && !makeRoom()) {
+            ESP_LOGW(TAG, "No slot to wake application '%s'", appId.c_str());
+            return OS_ERROR_BUSY;
+        }
+
+        std::vector<uint8_t> snapshot(entry.snapshotSize);
+        if (entry.spilled) {
+            int read = OS().getHALManager().getStorage().readFile(snapshotPath(appId).c_str(),
+                                                                  snapshot.data(), snapshot.size());
+            if (read != (int)snapshot.size()) {
+                ESP_LOGW(TAG, "Snapshot of '%s' unreadable, starting afresh", appId.c_str());
+                snapshot.clear();
+            }
+        } else if (entry.snapshotSize > 0) {
+            memcpy(snapshot.data(), entry.snapshot, entry.snapshotSize);
+        }
+
+        os_error_t result = startInstance(appId, snapshot.empty() ? nullptr : &snapshot);
+        if (result != OS_OK) {
+            return result;
+        }
+    } else {
+        BaseApp* app = getApp(appId);
+        if (!app) {
+            dropHibernated(appId);
+            return OS_ERROR_NOT_FOUND;
+        }
+        app->wake();
+    }
+    dropHibernated(appId);
+
+    BaseApp* app = getApp(appId);
+    if (app && entry.hadUI && !app->hasUI()) {
+        app->createUI(lv_scr_act());
+    }
+
+    m_lastWakeMs = millis() - start;
+    m_totalWakes++;
+    ESP_LOGI(TAG, "Woke application '%s' in %d ms", appId.c_str(), m_lastWakeMs);
+    return OS_OK;
+}
+
+os_error_t AppManager::storeSnapshot(const std::string& appId, const std::vector<uint8_t>& snapshot,
+                                     HibernatedApp& entry) {
+    entry.snapshotSize = snapshot.size();
+    if (snapshot.empty()) {
+        return OS_OK;
+    }
+
+    if (m_snapshotBytes + snapshot.size() <= OS_HIBERNATE_PSRAM_BUDGET) {
+        entry.snapshot = OS_MALLOC_PSRAM(snapshot.size());
+        if (entry.snapshot) {
+            memcpy(entry.snapshot, snapshot.data(), snapshot.size());
+            m_snapshotBytes += snapshot.size();
+            return OS_OK;
+        }
+    }
+
+    // Over budget or out of PSRAM: keep it on flash instead
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    if (!storage.exists(OS_HIBERNATE_DIR)) {
+        storage.createDirectory(OS_HIBERNATE_DIR);
+    }
+    std::string path = snapshotPath(appId);
+    if (storage.writeFile(path.c_str(), snapshot.data(), snapshot.size()) != (int)snapshot.size()) {
+        ESP_LOGW(TAG, "Could not spill snapshot of '%s'", appId.c_str());
+        storage.deleteFile(path.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    entry.spilled = true;
+    m_snapshotSpills++;
+    return OS_OK;
+}
+
+void AppManager::dropHibernated(const std::string& appId) {
+    auto it = m_hibernatedApps.find(appId);
+    if (it == m_hibernatedApps.end()) {
+        return;
+    }
+    if (it->second.snapshot) {
+        OS_FREE(it->second.snapshot);
+        m_snapshotBytes -= it->second.snapshotSize;
+    }
+    if (it->second.spilled) {
+        OS().getHALManager().getStorage().deleteFile(snapshotPath(appId).c_str());
+    }
+    m_hibernatedApps.erase(it);
+}
+
+bool AppManager::pickHibernationCandidate(std::string& appId) const {
+    uint32_t now = millis();
+    bool found = false;
+    AppPriority bestPriority = AppPriority::APP_SYSTEM;
+    uint64_t bestScore = 0;
+
+    for (const auto& [id, app] : m_runningApps) {
+        if (!app || id == m_currentAppId || app->isHibernated() ||
+            app->getPriority() >= AppPriority::APP_SYSTEM) {
+            continue;
+        }
+        auto lastUsed = m_lastUsed.find(id);
+        uint64_t idleSeconds = lastUsed != m_lastUsed.end() ? (now - lastUsed->second) / 1000 : 0;
+        uint64_t score = (idleSeconds + 1) * (app->getMemoryUsage() / 1024 + 1);
+        if (!found || app->getPriority() < bestPriority ||
+            (app->getPriority() == bestPriority && score > bestScore)) {
+            appId = id;
+            bestPriority = app->getPriority();
+            bestScore = score;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool AppManager::makeRoom() {
+    std::string appId;
+    while (m_runningApps.size() >= m_maxConcurrentApps && pickHibernationCandidate(appId)) {
+        if (hibernateApp(appId) != OS_OK) {
+            return false;
+        }
+    }
+    return m_runningApps.size() < m_maxConcurrentApps;
+}
+
+std::string AppManager::snapshotPath(const std::string& appId) const {
+    return std::string(OS_HIBERNATE_DIR "/") + appId + ".snap";
+}
+
 BaseApp* AppManager::getCurrentApp() const {
     return getApp(m_currentAppId);
 }
@@ -311,6 +791,7 @@ AppInfo AppManager::getAppInfo(const std::string& appId) const {
     // Return empty info if not found
     AppInfo info;
     info.id = appId;
+    info.cpuUsage = 0;
     info.state = AppState::STOPPED;
     return info;
 }
@@ -323,6 +804,11 @@ os_error_t AppManager::killAllApps() {
     for (const auto& [appId, app] : m_runningApps) {
         appIds.push_back(appId);
     }
+    for (const auto& [appId, entry] : m_hibernatedApps) {
+        if (!entry.instanceKept) {
+            appIds.push_back(appId);
+        }
+    }
 
     // Kill each app
     for (const auto& appId : appIds) {
@@ -340,6 +826,11 @@ size_t AppManager::getTotalMemoryUsage() const {
             total += app->getMemoryUsage();
         }
     }
+    for (const auto& [appId, warm] : m_warmApps) {
+        if (warm->phase.load() == WarmApp::READY) {
+            total += warm->app->getMemoryUsage();
+        }
+    }
     return total;
 }
 
@@ -351,17 +842,35 @@ void AppManager::printStats() const {
     ESP_LOGI(TAG, "Total launches: %d", m_totalLaunches);
     ESP_LOGI(TAG, "Total kills: %d", m_totalKills);
     ESP_LOGI(TAG, "Total memory usage: %d KB", getTotalMemoryUsage() / 1024);
+    ESP_LOGI(TAG, "Hibernated: %d now, %d total, %d wakes (last %d ms), snapshots %d KB in PSRAM, %d spilled",
+             m_hibernatedApps.size(), m_totalHibernations, m_totalWakes, m_lastWakeMs,
+             m_snapshotBytes / 1024, m_snapshotSpills);
+    ESP_LOGI(TAG, "Warm pool: %d/%d, %d prelaunched in total%s", m_warmApps.size(), OS_APP_WARM_POOL,
+             m_totalPrelaunches, m_preparing ? ", one preparing" : "");
+
+    ESP_LOGI(TAG, "=== Launch Latency (to first update) ===");
+    for (const auto& [appId, stats] : m_launchStats) {
+        ESP_LOGI(TAG, "App '%s': %d launches (%d warm), last %d ms, avg %d ms, max %d ms",
+                 appId.c_str(), stats.launches, stats.warmLaunches, stats.lastMs,
+                 (int)(stats.totalMs / stats.launches), stats.maxMs);
+    }
 
     ESP_LOGI(TAG, "=== Running Applications ===");
     for (const auto& [appId, app] : m_runningApps) {
         if (app) {
             AppInfo info = app->getAppInfo();
-            ESP_LOGI(TAG, "App '%s': %s, runtime: %d s, memory: %d KB",
+            const MemoryArena* arena = app->getArena();
+            ESP_LOGI(TAG, "App '%s': %s, runtime: %d s, cpu: %d%%, memory: %d KB (arena %d/%d KB, peak %d KB)",
                     appId.c_str(),
                     info.state == AppState::RUNNING ? "running" :
-                    info.state == AppState::PAUSED ? "paused" : "other",
+                    info.state == AppState::PAUSED ? "paused" :
+                    info.state == AppState::HIBERNATED ? "hibernated" : "other",
                     info.runTime / 1000,
-                    info.memoryUsage / 1024);
+                    info.cpuUsage,
+                    info.memoryUsage / 1024,
+                    arena ? arena->getUsed() / 1024 : 0,
+                    arena ? arena->getReserved() / 1024 : 0,
+                    arena ? arena->getPeakReserved() / 1024 : 0);
         }
     }
 }
@@ -386,20 +895,62 @@ void AppManager::cleanupStoppedApps() {
     while (it != m_runningApps.end()) {
         if (!it->second || it->second->getState() == AppState::STOPPED) {
             ESP_LOGD(TAG, "Cleaning up stopped app '%s'", it->first.c_str());
+            std::string appId = it->first;
             it = m_runningApps.erase(it);
+            OS().getProfiler().removeApp(appId);
+            m_appBusyUs.erase(appId);
+            releaseArena(appId);
         } else {
             ++it;
         }
     }
 }
 
+void AppManager::releaseArena(const std::string& appId) {
+    auto it = m_appArenas.find(appId);
+    if (it != m_appArenas.end()) {
+        ESP_LOGD(TAG, "Releasing arena for '%s': %d bytes reserved, peak %d",
+                 appId.c_str(), it->second->getReserved(), it->second->getPeakReserved());
+        it->second->release();
+        m_appArenas.erase(it);
+    }
+}
+
 void AppManager::enforceResourceLimits() {
-    // Check memory usage and kill apps if needed
+    // Background apps left alone for a while give up their UI; apps with
+    // tasks of their own are still doing something and are left running
+    uint32_t now = millis();
+    std::vector<std::string> idle;
+    for (const auto& [appId, app] : m_runningApps) {
+        auto lastUsed = m_lastUsed.find(appId);
+        if (app && !app->isHibernated() && appId != m_currentAppId && app->getTasks().empty() &&
+            app->getPriority() < AppPriority::APP_SYSTEM && lastUsed != m_lastUsed.end() &&
+            now - lastUsed->second >= OS_APP_HIBERNATE_IDLE_MS) {
+            idle.push_back(appId);
+        }
+    }
+    for (const auto& appId : idle) {
+        hibernateApp(appId);
+    }
+
+    // Check memory usage; hibernate first, then kill apps if needed
     size_t totalMemory = getTotalMemoryUsage();
     size_t systemMemory = OS().getMemoryManager().getTotalAllocated();
     
     if (totalMemory > OS_APP_HEAP_SIZE || systemMemory > OS_SYSTEM_HEAP_SIZE) {
         ESP_LOGW(TAG, "Memory usage high, considering app cleanup");
+
+        // Warm apps are only a head start; they go before anything running
+        while (!m_warmApps.empty()) {
+            dropWarmApp(m_warmApps.begin()->first);
+        }
+        
+        std::string victim;
+        while (getTotalMemoryUsage() >= OS_APP_HEAP_SIZE * 0.8 && pickHibernationCandidate(victim)) {
+            if (hibernateApp(victim) != OS_OK) {
+                break;
+            }
+        }
         
         // Find lowest priority apps to kill
         std::vector<std::pair<std::string, AppPriority>> candidates;
@@ -424,6 +975,55 @@ void AppManager::enforceResourceLimits() {
             killApp(appId);
         }
     }
+
+    // Pause background apps that keep a core busy; the foreground app and
+    // system apps are allowed to
+    if (!CpuMonitor::isSupported()) {
+        return;
+    }
+
+    std::vector<std::string> hogs;
+    for (const auto& [appId, app] : m_runningApps) {
+        if (app && app->isRunning() && appId != m_currentAppId &&
+            app->getPriority() < AppPriority::APP_SYSTEM &&
+            app->getCpuUsage() > OS_APP_CPU_LIMIT) {
+            hogs.push_back(appId);
+        }
+    }
+
+    for (const auto& appId : hogs) {
+        ESP_LOGW(TAG, "Pausing background app '%s' using %d%% CPU",
+                 appId.c_str(), getApp(appId)->getCpuUsage());
+        pauseApp(appId);
+    }
+}
+
+void AppManager::updateCpuUsage() {
+    const CpuMonitor& cpu = OS().getCpuMonitor();
+    const FrameProfiler& profiler = OS().getProfiler();
+    uint32_t elapsed = millis() - m_lastCpuUpdate;
+    if (elapsed == 0) {
+        return;
+    }
+
+    for (const auto& [appId, app] : m_runningApps) {
+        if (!app) {
+            continue;
+        }
+
+        // Main loop share: time spent in update() since the last window
+        uint64_t busyUs = profiler.getAppBusyUs(appId);
+        uint64_t& lastBusyUs = m_appBusyUs[appId];
+        uint32_t usage = (uint32_t)(((busyUs - lastBusyUs) / 10) / elapsed);
+        lastBusyUs = busyUs;
+
+        // Plus the app's own FreeRTOS tasks (UART, network, ...)
+        for (TaskHandle_t task : app->getTasks()) {
+            usage += cpu.getTaskLoad(task);
+        }
+
+        app->setCpuUsage(usage > 100 ? 100 : (uint8_t)usage);
+    }
 }
 
 void AppManager::handleAppEvent(const EventData& eventData) {
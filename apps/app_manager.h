@@ -3,7 +3,9 @@
 
 #include "../system/os_config.h"
 #include "../system/event_system.h"
+#include "../system/memory_arena.h"
 #include "base_app.h"
+#include <atomic>
 #include <memory>
 #include <map>
 #include <vector>
@@ -15,10 +17,35 @@
  * 
  * Manages application lifecycle, installation, and execution.
  * Provides the framework for running multiple applications.
+ *
+ * Background apps can be hibernated: their UI is destroyed and, if they
+ * implement BaseApp::saveSnapshot(), their state is saved to PSRAM (or to
+ * flash past OS_HIBERNATE_PSRAM_BUDGET) and the instance and arena are
+ * freed. Switching back rebuilds the app from the snapshot. Apps without
+ * a snapshot keep their instance and only give up their UI.
+ *
+ * Startup is split in two: BaseApp::prepare() loads data and may run on
+ * a worker task, then initialize() and start() run on the main thread.
+ * Apps named with setPrelaunchApps() are prepared in the background once
+ * the device has been idle for OS_APP_PRELAUNCH_DELAY_MS, initialised,
+ * and kept in a warm pool of up to OS_APP_WARM_POOL instances; launching
+ * one of them only starts and shows it. Launch latency, from launchApp()
+ * to the app's first update(), is kept per app.
  */
 
 typedef std::function<std::unique_ptr<BaseApp>()> AppFactory;
 
+/**
+ * @brief Launch latency of one application
+ */
+struct AppLaunchStats {
+    uint32_t launches = 0;
+    uint32_t warmLaunches = 0;      // Taken from the warm pool
+    uint32_t lastMs = 0;
+    uint32_t maxMs = 0;
+    uint64_t totalMs = 0;
+};
+
 class AppManager {
 public:
     AppManager() = default;
@@ -93,6 +120,56 @@ public:
      */
     os_error_t switchToApp(const std::string& appId);
 
+    /**
+     * @brief Hibernate a background application
+     * @param appId Application identifier to hibernate
+     * @return OS_OK on success, OS_ERROR_BUSY for the foreground app, error code on failure
+     */
+    os_error_t hibernateApp(const std::string& appId);
+
+    /**
+     * @brief Check if application is hibernated
+     * @param appId Application identifier
+     * @return true if hibernated, false otherwise
+     */
+    bool isAppHibernated(const std::string& appId) const {
+        return m_hibernatedApps.find(appId) != m_hibernatedApps.end();
+    }
+
+    /**
+     * @brief Set the applications to prelaunch when the device is idle
+     * @param appIds Application identifiers, in order of preference
+     */
+    void setPrelaunchApps(const std::vector<std::string>& appIds);
+
+    /**
+     * @brief Prepare and initialise an application into the warm pool now
+     * 
+     * prepare() runs on a worker task; the app is initialised on the main
+     * thread by a later update() and stays hidden until launched.
+     * @param appId Application identifier
+     * @return OS_OK if started or already warm or running, OS_ERROR_BUSY if the pool is full
+     *         or another app is being prepared
+     */
+    os_error_t prelaunchApp(const std::string& appId);
+
+    /**
+     * @brief Check if application is in the warm pool
+     * @param appId Application identifier
+     * @return true if prelaunched and not yet launched
+     */
+    bool isAppWarm(const std::string& appId) const {
+        return m_warmApps.find(appId) != m_warmApps.end();
+    }
+
+    /**
+     * @brief Get launch latency statistics of an application
+     * @param appId Application identifier
+     * @param stats Filled with the statistics
+     * @return true if the app has been launched at least once
+     */
+    bool getLaunchStats(const std::string& appId, AppLaunchStats& stats) const;
+
     /**
      * @brief Get current foreground application
      * @return Pointer to foreground app or nullptr if none
@@ -162,6 +239,134 @@ public:
     void printStats() const;
 
 private:
+    struct HibernatedApp {
+        void* snapshot = nullptr;       // PSRAM copy; nullptr when spilled or empty
+        size_t snapshotSize = 0;
+        bool spilled = false;           // Snapshot is in OS_HIBERNATE_DIR
+        bool instanceKept = false;      // No snapshot: only the UI was released
+        bool hadUI = false;
+        size_t footprint = 0;           // Memory usage when hibernated
+        uint32_t hibernatedAt = 0;
+    };
+
+    struct WarmApp {
+        enum Phase : uint8_t {
+            PREPARING,      // prepare() running on the worker task
+            PREPARED,       // Waiting for initialize() on the main thread
+            READY,          // Initialised, not started
+            FAILED
+        };
+
+        std::string appId;
+        std::unique_ptr<BaseApp> app;
+        std::atomic<uint8_t> phase{PREPARING};
+        os_error_t result = OS_OK;      // From prepare(); written before phase
+        uint32_t prepareMs = 0;
+    };
+
+    struct PendingLaunch {
+        int64_t startUs;
+        bool warm;
+    };
+
+    /**
+     * @brief Take a warm instance or create, prepare and initialise one, then start it
+     * @param appId Application identifier
+     * @param snapshot State to restore before starting, or nullptr
+     * @param fromWarmPool Set to whether a prelaunched instance was used, if not nullptr
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t startInstance(const std::string& appId, const std::vector<uint8_t>* snapshot,
+                             bool* fromWarmPool = nullptr);
+
+    /**
+     * @brief Attach a fresh arena and initialise a prepared instance
+     * @param appId Application identifier
+     * @param app Instance whose prepare() has run
+     * @return OS_OK on success, error code on failure (the arena is released)
+     */
+    os_error_t initializeInstance(const std::string& appId, BaseApp& app);
+
+    /**
+     * @brief Take an initialised instance out of the warm pool
+     * 
+     * Waits for a prepare() still in progress.
+     * @param appId Application identifier
+     * @return The instance, or nullptr if not warm or its startup failed
+     */
+    std::unique_ptr<BaseApp> takeWarmApp(const std::string& appId);
+
+    /**
+     * @brief Initialise a warm app whose prepare() has finished
+     * @param warm Warm pool entry in the PREPARED phase
+     */
+    void finishPrepared(WarmApp& warm);
+
+    /**
+     * @brief Shut down and forget a warm app
+     * @param appId Application identifier
+     * @return true if the app was warm
+     */
+    bool dropWarmApp(const std::string& appId);
+
+    /**
+     * @brief Finish prepared warm apps and start the next prelaunch when idle
+     */
+    void updatePrelaunch();
+
+    /**
+     * @brief Worker task running one warm app's prepare()
+     * @param param WarmApp
+     */
+    static void prepareTask(void* param);
+
+    /**
+     * @brief Record the latency of a launch that reached its first update()
+     * @param appId Application identifier
+     */
+    void recordLaunch(const std::string& appId);
+
+    /**
+     * @brief Bring a hibernated application back
+     * @param appId Application identifier
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t wakeApp(const std::string& appId);
+
+    /**
+     * @brief Keep a snapshot in PSRAM, or on flash when over budget
+     * @param appId Application identifier
+     * @param snapshot Snapshot bytes
+     * @param entry Updated with where the snapshot went
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t storeSnapshot(const std::string& appId, const std::vector<uint8_t>& snapshot,
+                             HibernatedApp& entry);
+
+    /**
+     * @brief Free a hibernated app's snapshot and forget it
+     * @param appId Application identifier
+     */
+    void dropHibernated(const std::string& appId);
+
+    /**
+     * @brief Pick the background app to hibernate first
+     * 
+     * Lowest priority first, then the largest product of idle time and
+     * memory footprint. The foreground and system apps are never picked.
+     * @param appId Set to the chosen app
+     * @return true if there is a candidate
+     */
+    bool pickHibernationCandidate(std::string& appId) const;
+
+    /**
+     * @brief Hibernate background apps until an instance slot is free
+     * @return true if a slot is free
+     */
+    bool makeRoom();
+
+    std::string snapshotPath(const std::string& appId) const;
+
     /**
      * @brief Create application instance
      * @param appId Application identifier
@@ -174,11 +379,22 @@ private:
      */
     void cleanupStoppedApps();
 
+    /**
+     * @brief Release an application's arena back to the app heap
+     * @param appId Application identifier
+     */
+    void releaseArena(const std::string& appId);
+
     /**
      * @brief Check resource limits and cleanup if needed
      */
     void enforceResourceLimits();
 
+    /**
+     * @brief Recompute per-app CPU usage from update() time and owned tasks
+     */
+    void updateCpuUsage();
+
     /**
      * @brief Handle application events
      * @param eventData Event data
@@ -188,6 +404,22 @@ private:
     // Application registry and instances
     std::map<std::string, AppFactory> m_appFactories;
     std::map<std::string, std::unique_ptr<BaseApp>> m_runningApps;
+    std::map<std::string, std::unique_ptr<MemoryArena>> m_appArenas;
+    std::map<std::string, uint64_t> m_appBusyUs;    // Profiler busy time at last CPU update
+    std::map<std::string, HibernatedApp> m_hibernatedApps;
+    std::map<std::string, uint32_t> m_lastUsed;     // millis() of the last launch or switch
+    size_t m_snapshotBytes = 0;                     // Snapshot bytes held in PSRAM
+
+    // Prelaunch and warm pool
+    std::map<std::string, std::unique_ptr<WarmApp>> m_warmApps;
+    std::vector<std::string> m_prelaunchApps;       // From setPrelaunchApps()
+    std::vector<std::string> m_prelaunchFailed;     // Not retried until setPrelaunchApps()
+    WarmApp* m_preparing = nullptr;                 // Entry the worker task owns
+    uint32_t m_lastLaunchAt = 0;                    // millis() of the last launch, or of initialize()
+
+    // Launch latency
+    std::map<std::string, PendingLaunch> m_pendingLaunches;
+    std::map<std::string, AppLaunchStats> m_launchStats;
     
     // State
     std::string m_currentAppId;
@@ -196,7 +428,13 @@ private:
     // Statistics
     uint32_t m_totalLaunches = 0;
     uint32_t m_totalKills = 0;
+    uint32_t m_totalHibernations = 0;
+    uint32_t m_totalWakes = 0;
+    uint32_t m_snapshotSpills = 0;
+    uint32_t m_lastWakeMs = 0;
+    uint32_t m_totalPrelaunches = 0;
     uint32_t m_lastCleanup = 0;
+    uint32_t m_lastCpuUpdate = 0;
     
     bool m_initialized = false;
 };
@@ -2,6 +2,7 @@
 #include "../system/os_manager.h"
 #include <esp_log.h>
 #include <cstdarg>
+#include <algorithm>
 
 BaseApp::BaseApp(const std::string& id, const std::string& name, const std::string& version)
     : m_id(id), m_name(name), m_version(version) {
@@ -89,6 +90,49 @@ os_error_t BaseApp::handleEvent(uint32_t eventType, void* eventData, size_t data
     return OS_OK;
 }
 
+os_error_t BaseApp::prepare() {
+    return OS_OK;
+}
+
+os_error_t BaseApp::saveSnapshot(std::vector<uint8_t>& snapshot) {
+    return OS_ERROR_NOT_SUPPORTED;
+}
+
+os_error_t BaseApp::restoreSnapshot(const std::vector<uint8_t>& snapshot) {
+    return OS_ERROR_NOT_SUPPORTED;
+}
+
+os_error_t BaseApp::hibernate() {
+    if (m_state != AppState::RUNNING && m_state != AppState::PAUSED) {
+        return OS_ERROR_GENERIC;
+    }
+
+    if (m_uiContainer) {
+        destroyUI();
+        m_uiContainer = nullptr;
+    }
+
+    setState(AppState::HIBERNATED);
+    log(ESP_LOG_INFO, "Application hibernated");
+    
+    PUBLISH_EVENT(EVENT_APP_SUSPEND, (void*)m_id.c_str(), m_id.length());
+    
+    return OS_OK;
+}
+
+os_error_t BaseApp::wake() {
+    if (m_state != AppState::HIBERNATED) {
+        return OS_ERROR_GENERIC;
+    }
+
+    setState(AppState::RUNNING);
+    log(ESP_LOG_INFO, "Application woken");
+    
+    PUBLISH_EVENT(EVENT_APP_RESUME, (void*)m_id.c_str(), m_id.length());
+    
+    return OS_OK;
+}
+
 AppInfo BaseApp::getAppInfo() const {
     AppInfo info;
     info.id = m_id;
@@ -98,12 +142,23 @@ AppInfo BaseApp::getAppInfo() const {
     info.author = m_author;
     info.priority = m_priority;
     info.memoryUsage = m_memoryUsage;
+    info.cpuUsage = m_cpuUsage;
     info.startTime = m_startTime;
     info.runTime = getRuntime();
     info.state = m_state;
     return info;
 }
 
+void BaseApp::registerTask(TaskHandle_t handle) {
+    if (handle && std::find(m_tasks.begin(), m_tasks.end(), handle) == m_tasks.end()) {
+        m_tasks.push_back(handle);
+    }
+}
+
+void BaseApp::unregisterTask(TaskHandle_t handle) {
+    m_tasks.erase(std::remove(m_tasks.begin(), m_tasks.end(), handle), m_tasks.end());
+}
+
 uint32_t BaseApp::getRuntime() const {
     if (m_startTime == 0) {
         return 0;
@@ -119,7 +174,7 @@ void BaseApp::setState(AppState state) {
         // Log state changes in debug mode
         #if OS_DEBUG_ENABLED >= 2
         const char* stateNames[] = {
-            "STOPPED", "STARTING", "RUNNING", "PAUSED", "STOPPING", "ERROR"
+            "STOPPED", "STARTING", "RUNNING", "PAUSED", "HIBERNATED", "STOPPING", "ERROR"
         };
         log(ESP_LOG_DEBUG, ("State changed: " + std::string(stateNames[(int)previousState]) + 
                            " -> " + std::string(stateNames[(int)state])).c_str());
@@ -2,9 +2,15 @@
 #define BASE_APP_H
 
 #include "../system/os_config.h"
+#include "../system/memory_arena.h"
+#include "../system/frame_profiler.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <lvgl.h>
 #include <string>
+#include <cstring>
 #include <functional>
+#include <vector>
 
 /**
  * @file base_app.h
@@ -19,6 +25,7 @@ enum class AppState {
     STARTING,
     RUNNING,
     PAUSED,
+    HIBERNATED,     // UI released, state kept in a snapshot or the idle instance
     STOPPING,
     ERROR
 };
@@ -38,11 +45,75 @@ struct AppInfo {
     std::string author;
     AppPriority priority;
     size_t memoryUsage;
+    uint8_t cpuUsage;       // Percent of one core: update() time plus owned tasks
     uint32_t startTime;
     uint32_t runTime;
     AppState state;
 };
 
+/**
+ * @brief Appends fields to a hibernation snapshot (little-endian)
+ */
+class AppSnapshotWriter {
+public:
+    explicit AppSnapshotWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void putU32(uint32_t value) { put(&value, sizeof(value)); }
+    void putI32(int32_t value) { put(&value, sizeof(value)); }
+    void putDouble(double value) { put(&value, sizeof(value)); }
+    void putString(const std::string& value) {
+        putU32((uint32_t)value.size());
+        put(value.data(), value.size());
+    }
+
+private:
+    void put(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_out.insert(m_out.end(), bytes, bytes + size);
+    }
+
+    std::vector<uint8_t>& m_out;
+};
+
+/**
+ * @brief Reads fields written by AppSnapshotWriter; fails once past the end
+ */
+class AppSnapshotReader {
+public:
+    explicit AppSnapshotReader(const std::vector<uint8_t>& in) : m_in(in) {}
+
+    bool getU32(uint32_t& value) { return get(&value, sizeof(value)); }
+    bool getI32(int32_t& value) { return get(&value, sizeof(value)); }
+    bool getDouble(double& value) { return get(&value, sizeof(value)); }
+    bool getString(std::string& value) {
+        uint32_t size;
+        if (!getU32(size) || size > m_in.size() - m_position) {
+            m_failed = true;
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_in.data()) + m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    bool ok() const { return !m_failed; }
+
+private:
+    bool get(void* data, size_t size) {
+        if (m_failed || size > m_in.size() - m_position) {
+            m_failed = true;
+            return false;
+        }
+        memcpy(data, m_in.data() + m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    const std::vector<uint8_t>& m_in;
+    size_t m_position = 0;
+    bool m_failed = false;
+};
+
 class BaseApp {
 public:
     /**
@@ -58,8 +129,22 @@ public:
      */
     virtual ~BaseApp() = default;
 
+    /**
+     * @brief Load the application's data ahead of initialize()
+     *
+     * Called once, before initialize(), possibly on a worker task while
+     * the device is idle (see AppManager prelaunch). File and flash I/O,
+     * parsing and index building belong here; LVGL, the arena and other
+     * main-thread state do not, since the arena is attached afterwards.
+     * @return OS_OK on success, error code on failure
+     */
+    virtual os_error_t prepare();
+
     /**
      * @brief Initialize the application
+     *
+     * Runs on the main thread after prepare(). A prelaunched app may be
+     * initialised well before it is started and shown.
      * @return OS_OK on success, error code on failure
      */
     virtual os_error_t initialize() = 0;
@@ -123,6 +208,38 @@ public:
      */
     virtual os_error_t handleEvent(uint32_t eventType, void* eventData, size_t dataSize);
 
+    /**
+     * @brief Save what the app needs to come back after hibernation
+     *
+     * Called with the UI already destroyed. Apps that implement this and
+     * restoreSnapshot() are shut down and freed while hibernated; the
+     * others keep their instance and only give up their UI.
+     * @param snapshot Filled with the app's state
+     * @return OS_OK on success, OS_ERROR_NOT_SUPPORTED if the app has no snapshot
+     */
+    virtual os_error_t saveSnapshot(std::vector<uint8_t>& snapshot);
+
+    /**
+     * @brief Restore state saved by saveSnapshot() into a new instance
+     *
+     * Called after initialize() and before start() and createUI().
+     * @param snapshot State from saveSnapshot()
+     * @return OS_OK on success, error code on failure
+     */
+    virtual os_error_t restoreSnapshot(const std::vector<uint8_t>& snapshot);
+
+    /**
+     * @brief Release the UI and enter the hibernated state
+     * @return OS_OK on success, OS_ERROR_GENERIC unless running or paused
+     */
+    os_error_t hibernate();
+
+    /**
+     * @brief Leave the hibernated state; the caller recreates the UI
+     * @return OS_OK on success, OS_ERROR_GENERIC unless hibernated
+     */
+    os_error_t wake();
+
     /**
      * @brief Get application information
      * @return Application info structure
@@ -165,6 +282,18 @@ public:
      */
     bool isPaused() const { return m_state == AppState::PAUSED; }
 
+    /**
+     * @brief Check if application is hibernated
+     * @return true if hibernated, false otherwise
+     */
+    bool isHibernated() const { return m_state == AppState::HIBERNATED; }
+
+    /**
+     * @brief Check if the application's UI currently exists
+     * @return true if createUI() built a container that is still alive
+     */
+    bool hasUI() const { return m_uiContainer != nullptr; }
+
     /**
      * @brief Set application description
      * @param description Description string
@@ -196,10 +325,54 @@ public:
     uint32_t getRuntime() const;
 
     /**
-     * @brief Get memory usage estimate
-     * @return Memory usage in bytes
+     * @brief Get memory usage
+     * @return Bytes reserved by the app arena plus any self-reported estimate
+     */
+    size_t getMemoryUsage() const {
+        return m_memoryUsage + (m_arena ? m_arena->getReserved() : 0);
+    }
+
+    /**
+     * @brief Attach the per-app arena owned by the AppManager
+     * @param arena Arena to allocate from (nullptr to detach)
+     */
+    void attachArena(MemoryArena* arena) { m_arena = arena; }
+
+    /**
+     * @brief Get the attached arena
+     * @return Pointer to arena or nullptr if none is attached
+     */
+    MemoryArena* getArena() const { return m_arena; }
+
+    /**
+     * @brief Attach the profiler window the AppManager records updates into
+     * @param window Window from FrameProfiler::addApp() (nullptr to detach)
+     */
+    void attachProfileWindow(FrameProfiler::SampleWindow* window) { m_profileWindow = window; }
+
+    /**
+     * @brief Get the attached profiler window
+     * @return Window or nullptr if none is attached
+     */
+    FrameProfiler::SampleWindow* getProfileWindow() const { return m_profileWindow; }
+
+    /**
+     * @brief Get CPU usage over the last accounting window
+     * @return Percent of one core
      */
-    size_t getMemoryUsage() const { return m_memoryUsage; }
+    uint8_t getCpuUsage() const { return m_cpuUsage; }
+
+    /**
+     * @brief Set CPU usage (called by the AppManager)
+     * @param usage Percent of one core
+     */
+    void setCpuUsage(uint8_t usage) { m_cpuUsage = usage; }
+
+    /**
+     * @brief Get FreeRTOS tasks owned by the application
+     * @return Registered task handles
+     */
+    const std::vector<TaskHandle_t>& getTasks() const { return m_tasks; }
 
     /**
      * @brief Request application exit
@@ -225,6 +398,32 @@ protected:
      */
     void setMemoryUsage(size_t usage) { m_memoryUsage = usage; }
 
+    /**
+     * @brief Attribute a FreeRTOS task's CPU time to this application
+     * @param handle Task handle (ignored if nullptr)
+     */
+    void registerTask(TaskHandle_t handle);
+
+    /**
+     * @brief Stop attributing a task to this application
+     * @param handle Task handle about to be deleted
+     */
+    void unregisterTask(TaskHandle_t handle);
+
+    /**
+     * @brief Allocate from the application's arena
+     * 
+     * Memory is released as a whole when the app is killed; do not free
+     * it individually. Use it for buffers that live as long as the app
+     * (the terminal scrollback and receive rings, for instance).
+     * @param size Size in bytes
+     * @param alignment Required alignment (power of two)
+     * @return Pointer to memory or nullptr if no arena / over budget
+     */
+    void* arenaAllocate(size_t size, size_t alignment = sizeof(void*) * 2) {
+        return m_arena ? m_arena->allocate(size, alignment) : nullptr;
+    }
+
     /**
      * @brief Log application message
      * @param level Log level
@@ -245,6 +444,10 @@ protected:
     AppPriority m_priority = AppPriority::APP_NORMAL;
     uint32_t m_startTime = 0;
     size_t m_memoryUsage = 0;
+    uint8_t m_cpuUsage = 0;
+    std::vector<TaskHandle_t> m_tasks;
+    MemoryArena* m_arena = nullptr;
+    FrameProfiler::SampleWindow* m_profileWindow = nullptr;
     bool m_exitRequested = false;
     bool m_initialized = false;
 
@@ -97,6 +97,45 @@ os_error_t BasicAppsSuite::destroyUI() {
     return OS_OK;
 }
 
+os_error_t BasicAppsSuite::saveSnapshot(std::vector<uint8_t>& snapshot) {
+    // Sheet cells as typed, the calculator and the selection; expenses are reloaded
+    AppSnapshotWriter writer(snapshot);
+    writer.putString(m_calculatorExpression);
+    writer.putString(m_calculatorResult);
+    writer.putI32(m_selectedRow);
+    writer.putI32(m_selectedCol);
+    writer.putU32((uint32_t)m_sheet.getCellCount());
+    m_sheet.forEachCell([&writer](int row, int col, const std::string& input) {
+        writer.putI32(row);
+        writer.putI32(col);
+        writer.putString(input);
+    });
+    return OS_OK;
+}
+
+os_error_t BasicAppsSuite::restoreSnapshot(const std::vector<uint8_t>& snapshot) {
+    AppSnapshotReader reader(snapshot);
+    int32_t row = 0, col = 0;
+    uint32_t cells = 0;
+    reader.getString(m_calculatorExpression);
+    reader.getString(m_calculatorResult);
+    reader.getI32(row);
+    reader.getI32(col);
+    reader.getU32(cells);
+    m_selectedRow = row;
+    m_selectedCol = col;
+
+    // Inputs go back in any order; formulas recalculate as their inputs arrive
+    m_sheet.clear();
+    for (uint32_t i = 0; i < cells && reader.ok(); i++) {
+        std::string input;
+        if (reader.getI32(row) && reader.getI32(col) && reader.getString(input)) {
+            m_sheet.setCell(row, col, input);
+        }
+    }
+    return reader.ok() ? OS_OK : OS_ERROR_INVALID_PARAM;
+}
+
 void BasicAppsSuite::createMainUI() {
     createTabView();
 }
@@ -265,37 +304,127 @@ void BasicAppsSuite::createGamesTab() {
 }
 
 void BasicAppsSuite::createSpreadsheetTab() {
-    // Create simple grid for demonstration
+    createSpreadsheetToolbar();
+    createSpreadsheetGrid();
+    selectCell(m_selectedRow, m_selectedCol);
+}
+
+void BasicAppsSuite::createSpreadsheetToolbar() {
+    // Formula bar: selected cell, its input, copy and paste
+    m_spreadsheetToolbar = lv_obj_create(m_spreadsheetTab);
+    lv_obj_set_size(m_spreadsheetToolbar, LV_PCT(100), 56);
+    lv_obj_align(m_spreadsheetToolbar, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_pad_all(m_spreadsheetToolbar, 4, 0);
+    lv_obj_clear_flag(m_spreadsheetToolbar, LV_OBJ_FLAG_SCROLLABLE);
+    
+    m_cellReference = lv_label_create(m_spreadsheetToolbar);
+    lv_label_set_text(m_cellReference, "A1");
+    lv_obj_set_width(m_cellReference, 60);
+    lv_obj_align(m_cellReference, LV_ALIGN_LEFT_MID, 0, 0);
+    
+    lv_obj_t* pasteBtn = lv_btn_create(m_spreadsheetToolbar);
+    lv_obj_set_size(pasteBtn, 80, 40);
+    lv_obj_align(pasteBtn, LV_ALIGN_RIGHT_MID, 0, 0);
+    lv_obj_add_event_cb(pasteBtn, pasteButtonCallback, LV_EVENT_CLICKED, this);
+    lv_obj_t* pasteLabel = lv_label_create(pasteBtn);
+    lv_label_set_text(pasteLabel, "Paste");
+    lv_obj_center(pasteLabel);
+    
+    lv_obj_t* copyBtn = lv_btn_create(m_spreadsheetToolbar);
+    lv_obj_set_size(copyBtn, 80, 40);
+    lv_obj_align_to(copyBtn, pasteBtn, LV_ALIGN_OUT_LEFT_MID, -8, 0);
+    lv_obj_add_event_cb(copyBtn, copyButtonCallback, LV_EVENT_CLICKED, this);
+    lv_obj_t* copyLabel = lv_label_create(copyBtn);
+    lv_label_set_text(copyLabel, "Copy");
+    lv_obj_center(copyLabel);
+    
+    m_cellEditor = lv_textarea_create(m_spreadsheetToolbar);
+    lv_textarea_set_one_line(m_cellEditor, true);
+    lv_textarea_set_placeholder_text(m_cellEditor, "Value or =formula");
+    lv_obj_set_size(m_cellEditor, LV_PCT(55), 40);
+    lv_obj_align(m_cellEditor, LV_ALIGN_LEFT_MID, 64, 0);
+    lv_obj_add_event_cb(m_cellEditor, cellEditCallback, LV_EVENT_READY, this);
+}
+
+void BasicAppsSuite::createSpreadsheetGrid() {
     m_spreadsheetGrid = lv_table_create(m_spreadsheetTab);
-    lv_obj_set_size(m_spreadsheetGrid, LV_PCT(100), LV_PCT(90));
-    lv_obj_align(m_spreadsheetGrid, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_size(m_spreadsheetGrid, LV_PCT(100), LV_PCT(85));
+    lv_obj_align_to(m_spreadsheetGrid, m_spreadsheetToolbar, LV_ALIGN_OUT_BOTTOM_MID, 0, 4);
     
-    // Setup basic 5x5 grid
-    lv_table_set_col_cnt(m_spreadsheetGrid, 5);
-    lv_table_set_row_cnt(m_spreadsheetGrid, 5);
+    // Header row and column around the visible cells
+    lv_table_set_col_cnt(m_spreadsheetGrid, SHEET_VISIBLE_COLS + 1);
+    lv_table_set_row_cnt(m_spreadsheetGrid, SHEET_VISIBLE_ROWS + 1);
+    lv_table_set_col_width(m_spreadsheetGrid, 0, 50);
     
-    // Set headers
-    for (int col = 0; col < 5; col++) {
+    for (int col = 0; col < SHEET_VISIBLE_COLS; col++) {
         char header[8];
         sprintf(header, "%c", 'A' + col);
-        lv_table_set_cell_value(m_spreadsheetGrid, 0, col, header);
-        lv_table_set_col_width(m_spreadsheetGrid, col, 80);
+        lv_table_set_cell_value(m_spreadsheetGrid, 0, col + 1, header);
+        lv_table_set_col_width(m_spreadsheetGrid, col + 1, 110);
     }
     
-    for (int row = 1; row < 5; row++) {
+    for (int row = 0; row < SHEET_VISIBLE_ROWS; row++) {
         char header[8];
-        sprintf(header, "%d", row);
-        lv_table_set_cell_value(m_spreadsheetGrid, row, 0, header);
+        sprintf(header, "%d", row + 1);
+        lv_table_set_cell_value(m_spreadsheetGrid, row + 1, 0, header);
+        for (int col = 0; col < SHEET_VISIBLE_COLS; col++) {
+            refreshGridCell(row, col);
+        }
     }
     
-    // Cell reference display
-    m_cellReference = lv_label_create(m_spreadsheetTab);
-    lv_label_set_text(m_cellReference, "A1");
-    lv_obj_align(m_spreadsheetTab, LV_ALIGN_BOTTOM_LEFT, 10, -10);
-    
     lv_obj_add_event_cb(m_spreadsheetGrid, cellClickCallback, LV_EVENT_CLICKED, this);
 }
 
+void BasicAppsSuite::updateCell(int row, int col, const std::string& value) {
+    if (m_sheet.setCell(row, col, value) != OS_OK) {
+        log(ESP_LOG_WARN, "Cell outside the sheet");
+        return;
+    }
+    
+    // Only cells the recalculation touched can show something new
+    for (uint32_t key : m_sheet.getLastChanged()) {
+        int changedRow = (int)(key >> 16);
+        int changedCol = (int)(key & 0xFFFF);
+        if (changedRow < SHEET_VISIBLE_ROWS && changedCol < SHEET_VISIBLE_COLS) {
+            refreshGridCell(changedRow, changedCol);
+        }
+    }
+}
+
+void BasicAppsSuite::refreshGridCell(int row, int col) {
+    if (m_spreadsheetGrid) {
+        lv_table_set_cell_value(m_spreadsheetGrid, row + 1, col + 1, m_sheet.getDisplay(row, col).c_str());
+    }
+}
+
+void BasicAppsSuite::selectCell(int row, int col) {
+    m_selectedRow = row;
+    m_selectedCol = col;
+    if (m_cellReference) {
+        lv_label_set_text(m_cellReference, getCellReference(row, col).c_str());
+    }
+    if (m_cellEditor) {
+        lv_textarea_set_text(m_cellEditor, m_sheet.getInput(row, col).c_str());
+    }
+}
+
+void BasicAppsSuite::copyCell() {
+    m_copiedInput = m_sheet.getInput(m_selectedRow, m_selectedCol);
+    m_hasCopiedCell = true;
+}
+
+void BasicAppsSuite::pasteCell() {
+    if (!m_hasCopiedCell) {
+        return;
+    }
+    updateCell(m_selectedRow, m_selectedCol, m_copiedInput);
+    selectCell(m_selectedRow, m_selectedCol);
+}
+
+std::string BasicAppsSuite::getCellReference(int row, int col) {
+    return SpreadsheetEngine::cellName(row, col);
+}
+
 void BasicAppsSuite::updateExpenseSummary() {
     lv_obj_clean(m_expenseSummary);
     
@@ -499,13 +628,11 @@ os_error_t BasicAppsSuite::saveSpreadsheet() {
 }
 
 void BasicAppsSuite::calculateResult() {
-    try {
-        float result = evaluateExpression(m_calculatorExpression);
-        m_calculatorResult = std::to_string(result);
-        
+    double result = 0.0;
+    if (evaluateExpression(m_calculatorExpression, result) == OS_OK) {
         // Format result to remove unnecessary decimal places
-        if (result == floor(result)) {
-            m_calculatorResult = std::to_string((int)result);
+        if (result == floor(result) && fabs(result) < 1e15) {
+            m_calculatorResult = std::to_string((long long)result);
         } else {
             std::stringstream ss;
             ss << std::fixed << std::setprecision(6) << result;
@@ -518,66 +645,20 @@ void BasicAppsSuite::calculateResult() {
         
         lv_textarea_set_text(m_calculatorDisplay, m_calculatorResult.c_str());
         m_calculatorNewInput = true;
-    } catch (...) {
+    } else {
         lv_textarea_set_text(m_calculatorDisplay, "Error");
         m_calculatorNewInput = true;
     }
 }
 
-float BasicAppsSuite::evaluateExpression(const std::string& expression) {
-    // Simple expression evaluator - for demo purposes
-    // In a real implementation, would use a proper parser
-    std::string expr = expression;
-    
-    // Replace symbols with operators - use string replacement for Unicode
-    size_t pos = expr.find("×");
-    while (pos != std::string::npos) {
-        expr.replace(pos, 3, "*"); // × is 3 bytes in UTF-8
-        pos = expr.find("×", pos + 1);
+os_error_t BasicAppsSuite::evaluateExpression(const std::string& expression, double& result) {
+    // Same compiler as spreadsheet formulas; the calculator has no cells
+    CompiledExpression compiled;
+    CellError error = compiled.compile(expression.c_str());
+    if (error == CellError::NONE) {
+        result = compiled.evaluate(nullptr, error);
     }
-    
-    pos = expr.find("÷");
-    while (pos != std::string::npos) {
-        expr.replace(pos, 3, "/"); // ÷ is 3 bytes in UTF-8
-        pos = expr.find("÷", pos + 1);
-    }
-    
-    // Very basic evaluation - only handles simple operations
-    size_t opPos = std::string::npos;
-    char op = 0;
-    
-    // Find last operator (right to left for correct precedence in simple cases)
-    for (int i = expr.length() - 1; i >= 0; i--) {
-        if (expr[i] == '+' || expr[i] == '-') {
-            opPos = i;
-            op = expr[i];
-            break;
-        }
-    }
-    
-    if (opPos == std::string::npos) {
-        for (int i = expr.length() - 1; i >= 0; i--) {
-            if (expr[i] == '*' || expr[i] == '/') {
-                opPos = i;
-                op = expr[i];
-                break;
-            }
-        }
-    }
-    
-    if (opPos != std::string::npos && opPos > 0) {
-        float left = evaluateExpression(expr.substr(0, opPos));
-        float right = evaluateExpression(expr.substr(opPos + 1));
-        
-        switch (op) {
-            case '+': return left + right;
-            case '-': return left - right;
-            case '*': return left * right;
-            case '/': return right != 0 ? left / right : 0;
-        }
-    }
-    
-    return std::stof(expr);
+    return error == CellError::NONE ? OS_OK : OS_ERROR_INVALID_PARAM;
 }
 
 // Static callbacks
@@ -626,7 +707,30 @@ void BasicAppsSuite::categoryFilterCallback(lv_event_t* e) {
 }
 
 void BasicAppsSuite::cellClickCallback(lv_event_t* e) {
-    // Handle spreadsheet cell click
+    BasicAppsSuite* app = static_cast<BasicAppsSuite*>(lv_event_get_user_data(e));
+    uint16_t row, col;
+    lv_table_get_selected_cell(app->m_spreadsheetGrid, &row, &col);
+    
+    // Row and column 0 are headers
+    if (row == LV_TABLE_CELL_NONE || col == LV_TABLE_CELL_NONE || row == 0 || col == 0) {
+        return;
+    }
+    app->selectCell(row - 1, col - 1);
+}
+
+void BasicAppsSuite::cellEditCallback(lv_event_t* e) {
+    BasicAppsSuite* app = static_cast<BasicAppsSuite*>(lv_event_get_user_data(e));
+    app->updateCell(app->m_selectedRow, app->m_selectedCol, lv_textarea_get_text(app->m_cellEditor));
+}
+
+void BasicAppsSuite::copyButtonCallback(lv_event_t* e) {
+    BasicAppsSuite* app = static_cast<BasicAppsSuite*>(lv_event_get_user_data(e));
+    app->copyCell();
+}
+
+void BasicAppsSuite::pasteButtonCallback(lv_event_t* e) {
+    BasicAppsSuite* app = static_cast<BasicAppsSuite*>(lv_event_get_user_data(e));
+    app->pasteCell();
 }
 
 void BasicAppsSuite::calculatorButtonCallback(lv_event_t* e) {
@@ -2,6 +2,7 @@
 #define BASIC_APPS_SUITE_H
 
 #include "base_app.h"
+#include "../system/spreadsheet_engine.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -22,14 +23,6 @@ struct Budget {
     float spentAmount;
 };
 
-// Simple spreadsheet structures
-struct Cell {
-    std::string value;
-    std::string formula;
-    int row;
-    int col;
-};
-
 // Game states
 enum class GameType {
     NONE,
@@ -54,6 +47,8 @@ public:
     os_error_t shutdown() override;
     os_error_t createUI(lv_obj_t* parent) override;
     os_error_t destroyUI() override;
+    os_error_t saveSnapshot(std::vector<uint8_t>& snapshot) override;
+    os_error_t restoreSnapshot(const std::vector<uint8_t>& snapshot) override;
 
 private:
     void createMainUI();
@@ -80,12 +75,12 @@ private:
     void createSpreadsheetGrid();
     void createSpreadsheetToolbar();
     void updateCell(int row, int col, const std::string& value);
-    void calculateFormula(int row, int col);
+    void refreshGridCell(int row, int col);
     void selectCell(int row, int col);
     void copyCell();
     void pasteCell();
     std::string getCellReference(int row, int col);
-    float evaluateExpression(const std::string& expression);
+    os_error_t evaluateExpression(const std::string& expression, double& result);
     
     // Games functions
     void createMemoryGame();
@@ -135,7 +130,7 @@ private:
     // Data
     std::vector<Expense> m_expenses;
     std::vector<Budget> m_budgets;
-    std::map<std::pair<int, int>, Cell> m_spreadsheetCells;
+    SpreadsheetEngine m_sheet;
     uint32_t m_nextExpenseId;
     
     // Expense tracking state
@@ -144,10 +139,12 @@ private:
     float m_balance;
     std::string m_selectedCategory;
     
-    // Spreadsheet state
+    // Spreadsheet state; the grid shows the top-left corner of the sheet
+    static constexpr int SHEET_VISIBLE_ROWS = 12;
+    static constexpr int SHEET_VISIBLE_COLS = 6;
     int m_selectedRow;
     int m_selectedCol;
-    Cell m_copiedCell;
+    std::string m_copiedInput;
     bool m_hasCopiedCell;
     
     // Games state
@@ -23,17 +23,8 @@ CalendarApp::~CalendarApp() {
     shutdown();
 }
 
-os_error_t CalendarApp::initialize() {
-    if (m_initialized) {
-        return OS_OK;
-    }
-
-    log(ESP_LOG_INFO, "Initializing Calendar application");
-
-    // Set memory usage estimate
-    setMemoryUsage(64 * 1024); // 64KB
-
-    // Load events from storage
+os_error_t CalendarApp::prepare() {
+    // Load events from storage; may run on the prelaunch worker
     loadEvents();
 
     // Add some sample events for demonstration
@@ -70,6 +61,20 @@ os_error_t CalendarApp::initialize() {
         m_events.push_back(sampleEvent2);
         saveEvents();
     }
+    eventsChanged();
+
+    return OS_OK;
+}
+
+os_error_t CalendarApp::initialize() {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    log(ESP_LOG_INFO, "Initializing Calendar application");
+
+    // Set memory usage estimate
+    setMemoryUsage(64 * 1024); // 64KB
 
     m_initialized = true;
     log(ESP_LOG_INFO, "Calendar application initialized with %d events", m_events.size());
@@ -78,10 +83,16 @@ os_error_t CalendarApp::initialize() {
 }
 
 os_error_t CalendarApp::update(uint32_t deltaTime) {
-    // Check for reminders periodically
-    if (millis() - m_lastReminderCheck >= REMINDER_CHECK_INTERVAL) {
+    // A look at the top of the reminder heap until something is due
+    std::time_t next = m_reminders.nextTime();
+    if (next != 0 && getCurrentTime() >= next) {
         checkReminders();
-        m_lastReminderCheck = millis();
+    }
+
+    // Follows edits and taken reminders; prepare() may run off the main loop,
+    // so the request is only ever made from here
+    if (m_reminders.nextTime() != m_registeredWakeup) {
+        updateWakeup();
     }
 
     return OS_OK;
@@ -99,6 +110,8 @@ os_error_t CalendarApp::shutdown() {
 
     // Clear events
     m_events.clear();
+    eventsChanged();
+    updateWakeup();
 
     m_initialized = false;
     log(ESP_LOG_INFO, "Calendar application shutdown complete");
@@ -181,6 +194,7 @@ os_error_t CalendarApp::addEvent(const CalendarEvent& event) {
     }
 
     m_events.push_back(event);
+    eventsChanged();
     saveEvents();
     updateCalendarDisplay();
 
@@ -198,6 +212,7 @@ os_error_t CalendarApp::removeEvent(const std::string& eventId) {
 
     log(ESP_LOG_INFO, "Removing event '%s'", it->title.c_str());
     m_events.erase(it);
+    eventsChanged();
     saveEvents();
     updateCalendarDisplay();
 
@@ -213,6 +228,7 @@ os_error_t CalendarApp::updateEvent(const CalendarEvent& event) {
     }
 
     *it = event;
+    eventsChanged();
     saveEvents();
     updateCalendarDisplay();
 
@@ -220,56 +236,32 @@ os_error_t CalendarApp::updateEvent(const CalendarEvent& event) {
     return OS_OK;
 }
 
-std::vector<CalendarEvent> CalendarApp::getEventsForDate(std::time_t date) const {
-    std::vector<CalendarEvent> dayEvents;
-    
-    // Get start and end of day
-    struct tm* tm_date = localtime(&date);
-    tm_date->tm_hour = 0;
-    tm_date->tm_min = 0;
-    tm_date->tm_sec = 0;
-    std::time_t dayStart = mktime(tm_date);
-    
-    tm_date->tm_hour = 23;
-    tm_date->tm_min = 59;
-    tm_date->tm_sec = 59;
-    std::time_t dayEnd = mktime(tm_date);
-
-    for (const auto& event : m_events) {
-        if ((event.startTime >= dayStart && event.startTime <= dayEnd) ||
-            (event.endTime >= dayStart && event.endTime <= dayEnd) ||
-            (event.startTime <= dayStart && event.endTime >= dayEnd)) {
-            dayEvents.push_back(event);
-        }
-    }
-
-    // Sort by start time
-    std::sort(dayEvents.begin(), dayEvents.end(),
-              [](const CalendarEvent& a, const CalendarEvent& b) {
-                  return a.startTime < b.startTime;
-              });
+void CalendarApp::getEventsForDate(std::time_t date, std::vector<CalendarOccurrence>& occurrences) const {
+    // From local midnight to the next one (23 or 25 hours on DST days)
+    struct tm tm_date;
+    localtime_r(&date, &tm_date);
+    tm_date.tm_hour = 0;
+    tm_date.tm_min = 0;
+    tm_date.tm_sec = 0;
+    tm_date.tm_isdst = -1;
+    std::time_t dayStart = mktime(&tm_date);
+    tm_date.tm_mday++;
+    tm_date.tm_isdst = -1;
+    std::time_t dayEnd = mktime(&tm_date);
 
-    return dayEvents;
+    m_index.query(m_events, dayStart, dayEnd, occurrences);
 }
 
-std::vector<CalendarEvent> CalendarApp::getEventsInRange(std::time_t startDate, std::time_t endDate) const {
-    std::vector<CalendarEvent> rangeEvents;
-
-    for (const auto& event : m_events) {
-        if ((event.startTime >= startDate && event.startTime <= endDate) ||
-            (event.endTime >= startDate && event.endTime <= endDate) ||
-            (event.startTime <= startDate && event.endTime >= endDate)) {
-            rangeEvents.push_back(event);
-        }
-    }
-
-    // Sort by start time
-    std::sort(rangeEvents.begin(), rangeEvents.end(),
-              [](const CalendarEvent& a, const CalendarEvent& b) {
-                  return a.startTime < b.startTime;
-              });
+void CalendarApp::getEventsInRange(std::time_t startDate, std::time_t endDate,
+                                   std::vector<CalendarOccurrence>& occurrences) const {
+    m_index.query(m_events, startDate, endDate, occurrences);
+}
 
-    return rangeEvents;
+void CalendarApp::eventsChanged() {
+    // CalendarOccurrence pointers into m_events are stale from here on
+    m_visible.clear();
+    m_index.rebuild(m_events);
+    m_reminders.rebuild(m_events, getCurrentTime());
 }
 
 void CalendarApp::setCalendarView(CalendarView view) {
@@ -529,8 +521,7 @@ void CalendarApp::updateCalendarDisplay() {
     switch (m_currentView) {
         case CalendarView::MONTH:
             if (m_calendar) {
-                // Update calendar widget (LVGL calendar automatically shows current month)
-                // Add event indicators if needed
+                updateMonthHighlights();
             }
             break;
 
@@ -541,16 +532,16 @@ void CalendarApp::updateCalendarDisplay() {
                 lv_obj_clean(m_eventList);
 
                 // Get events for current period
-                std::vector<CalendarEvent> events;
                 if (m_currentView == CalendarView::DAY) {
-                    events = getEventsForDate(m_currentDate);
+                    getEventsForDate(m_currentDate, m_visible);
                 } else {
                     // Agenda view shows next 30 days
-                    events = getEventsInRange(m_currentDate, m_currentDate + 30 * 86400);
+                    getEventsInRange(m_currentDate, m_currentDate + 30 * 86400, m_visible);
                 }
 
-                // Add events to list
-                for (const auto& event : events) {
+                // Add events to list; the IDs stay valid until the events change
+                for (const auto& occurrence : m_visible) {
+                    const CalendarEvent& event = *occurrence.event;
                     lv_obj_t* item = lv_list_add_btn(m_eventList, LV_SYMBOL_CALL, event.title.c_str());
                     lv_obj_set_user_data(item, (void*)event.id.c_str());
                     lv_obj_add_event_cb(item, eventClickCallback, LV_EVENT_CLICKED, this);
@@ -559,7 +550,7 @@ void CalendarApp::updateCalendarDisplay() {
                     lv_obj_set_style_bg_color(item, lv_color_hex(event.color), LV_STATE_DEFAULT);
                 }
 
-                if (events.empty()) {
+                if (m_visible.empty()) {
                     lv_obj_t* item = lv_list_add_text(m_eventList, "No events");
                     lv_obj_set_style_text_color(item, lv_color_hex(0x888888), 0);
                 }
@@ -599,22 +590,79 @@ void CalendarApp::updateToolbar() {
 
 void CalendarApp::checkReminders() {
     std::time_t now = getCurrentTime();
-    
-    for (const auto& event : m_events) {
-        if (event.hasReminder) {
-            std::time_t reminderTime = event.startTime - (event.reminderMinutes * 60);
-            
-            // Check if it's time for reminder (within 1 minute window)
-            if (now >= reminderTime && now <= reminderTime + 60) {
-                // Trigger reminder notification
-                log(ESP_LOG_INFO, "Reminder: %s in %d minutes", 
-                    event.title.c_str(), event.reminderMinutes);
-                
-                // In a real implementation, this would trigger a system notification
-                // For now, we just log it
+    CalendarOccurrence occurrence;
+    std::time_t reminderTime;
+
+    while (m_reminders.takeDue(m_events, now, occurrence, reminderTime)) {
+        // A reminder missed by more than the grace time (clock change, long
+        // suspend) is dropped rather than shown late
+        if (now - reminderTime > REMINDER_GRACE_SECONDS) {
+            log(ESP_LOG_DEBUG, "Skipped missed reminder: %s", occurrence.event->title.c_str());
+            continue;
+        }
+
+        // In a real implementation, this would trigger a system notification
+        // For now, we just log it
+        log(ESP_LOG_INFO, "Reminder: %s in %d minutes",
+            occurrence.event->title.c_str(), occurrence.event->reminderMinutes);
+    }
+}
+
+void CalendarApp::updateWakeup() {
+    // nextTime() is 0 with no reminder pending, which withdraws the request
+    m_registeredWakeup = m_reminders.nextTime();
+    OS().getHALManager().getPower().setWakeup(this, m_registeredWakeup);
+}
+
+void CalendarApp::updateMonthHighlights() {
+    struct tm tm_month;
+    localtime_r(&m_currentDate, &tm_month);
+    tm_month.tm_mday = 1;
+    tm_month.tm_hour = 0;
+    tm_month.tm_min = 0;
+    tm_month.tm_sec = 0;
+    tm_month.tm_isdst = -1;
+    std::time_t monthStart = mktime(&tm_month);
+    int year = tm_month.tm_year + 1900;
+    int month = tm_month.tm_mon;
+    tm_month.tm_mon++;
+    tm_month.tm_isdst = -1;
+    std::time_t monthEnd = mktime(&tm_month);
+
+    lv_calendar_set_showed_date(m_calendar, year, month + 1);
+
+    // Mark every day of the month an occurrence touches
+    getEventsInRange(monthStart, monthEnd, m_visible);
+    uint32_t days = 0;
+    for (const auto& occurrence : m_visible) {
+        std::time_t from = std::max(occurrence.start, monthStart);
+        std::time_t to = std::min(occurrence.end, monthEnd);
+        struct tm tm_day;
+        localtime_r(&from, &tm_day);
+        for (int day = tm_day.tm_mday; ; day++) {
+            days |= 1u << (day - 1);
+            tm_day.tm_mday = day + 1;
+            tm_day.tm_hour = 0;
+            tm_day.tm_min = 0;
+            tm_day.tm_sec = 0;
+            tm_day.tm_isdst = -1;
+            if (mktime(&tm_day) >= to || tm_day.tm_mon != month) {
+                break;
             }
         }
     }
+
+    // LVGL keeps a pointer to the array, so it lives in the app
+    uint16_t count = 0;
+    for (int day = 1; day <= 31; day++) {
+        if (days & (1u << (day - 1))) {
+            m_highlights[count].year = year;
+            m_highlights[count].month = month + 1;
+            m_highlights[count].day = day;
+            count++;
+        }
+    }
+    lv_calendar_set_highlighted_dates(m_calendar, m_highlights, count);
 }
 
 std::string CalendarApp::formatDate(std::time_t date, const char* format) const {
@@ -2,6 +2,7 @@
 #define CALENDAR_APP_H
 
 #include "base_app.h"
+#include "../system/calendar_index.h"
 #include <vector>
 #include <string>
 #include <ctime>
@@ -11,22 +12,14 @@
  * @brief Calendar Application for M5Stack Tab5
  * 
  * Provides calendar display, event management, and scheduling functionality.
+ *
+ * Views ask a CalendarIndex for the occurrences in the period shown, so
+ * their cost follows what is visible rather than the size of the calendar,
+ * and recurring events are expanded only for that period. Reminders come
+ * from a ReminderQueue checked on every update; both are rebuilt whenever
+ * the event list changes.
  */
 
-struct CalendarEvent {
-    std::string id;
-    std::string title;
-    std::string description;
-    std::time_t startTime;
-    std::time_t endTime;
-    std::string location;
-    bool isAllDay;
-    bool hasReminder;
-    uint32_t reminderMinutes;
-    std::string category;
-    uint32_t color;
-};
-
 enum class CalendarView {
     MONTH,
     WEEK,
@@ -40,6 +33,7 @@ public:
     ~CalendarApp() override;
 
     // BaseApp interface
+    os_error_t prepare() override;
     os_error_t initialize() override;
     os_error_t update(uint32_t deltaTime) override;
     os_error_t shutdown() override;
@@ -69,19 +63,20 @@ public:
     os_error_t updateEvent(const CalendarEvent& event);
 
     /**
-     * @brief Get events for specific date
-     * @param date Date to get events for
-     * @return Vector of events
+     * @brief Get the occurrences on a specific date
+     * @param date Any time on the date
+     * @param occurrences Filled sorted by start; valid until the events change
      */
-    std::vector<CalendarEvent> getEventsForDate(std::time_t date) const;
+    void getEventsForDate(std::time_t date, std::vector<CalendarOccurrence>& occurrences) const;
 
     /**
-     * @brief Get events in date range
-     * @param startDate Start date
-     * @param endDate End date
-     * @return Vector of events
+     * @brief Get the occurrences overlapping a time range
+     * @param startDate Range start
+     * @param endDate Range end (exclusive)
+     * @param occurrences Filled sorted by start; valid until the events change
      */
-    std::vector<CalendarEvent> getEventsInRange(std::time_t startDate, std::time_t endDate) const;
+    void getEventsInRange(std::time_t startDate, std::time_t endDate,
+                          std::vector<CalendarOccurrence>& occurrences) const;
 
     /**
      * @brief Set calendar view mode
@@ -161,6 +156,21 @@ private:
      */
     void checkReminders();
 
+    /**
+     * @brief Register the next reminder as a sleep wakeup with PowerHAL
+     */
+    void updateWakeup();
+
+    /**
+     * @brief Rebuild the range index and reminder queue after an edit
+     */
+    void eventsChanged();
+
+    /**
+     * @brief Show the month of m_currentDate with its event days highlighted
+     */
+    void updateMonthHighlights();
+
     /**
      * @brief Format date string
      * @param date Date to format
@@ -200,6 +210,11 @@ private:
 
     // Calendar data
     std::vector<CalendarEvent> m_events;
+    CalendarIndex m_index;
+    ReminderQueue m_reminders;
+    std::time_t m_registeredWakeup = 0;             // Last reminder time handed to PowerHAL
+    std::vector<CalendarOccurrence> m_visible;      // Occurrences the list view shows
+    lv_calendar_date_t m_highlights[31];            // Referenced by the calendar widget
     CalendarView m_currentView = CalendarView::MONTH;
     std::time_t m_currentDate;
     std::time_t m_selectedDate;
@@ -239,10 +254,9 @@ private:
     // State
     bool m_isEditing = false;
     std::string m_editingEventId;
-    uint32_t m_lastReminderCheck = 0;
 
     // Configuration
-    static constexpr uint32_t REMINDER_CHECK_INTERVAL = 60000; // 1 minute
+    static constexpr std::time_t REMINDER_GRACE_SECONDS = 60;  // Later than this counts as missed
     static constexpr size_t MAX_EVENTS = 1000;
     
     // Event categories and colors
@@ -1,7 +1,9 @@
 #include "camera_app.h"
 #include "../system/os_manager.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <esp_vfs_fat.h>
+#include <sys/stat.h>
 
 // Camera function stubs for when ESP camera library is not available
 #ifndef ESP_CAMERA_SUPPORTED
@@ -14,6 +16,21 @@ sensor_t* esp_camera_sensor_get() { return nullptr; }
 
 static const char* TAG = "CameraApp";
 
+static CameraFrameFormat frameFormat(pixformat_t format) {
+    switch (format) {
+        case PIXFORMAT_RGB565:
+            return CameraFrameFormat::RGB565;
+        case PIXFORMAT_YUV420:
+            return CameraFrameFormat::YUV420;
+        default:
+            return CameraFrameFormat::JPEG;
+    }
+}
+
+static void returnFrame(void* context) {
+    esp_camera_fb_return(static_cast<camera_fb_t*>(context));
+}
+
 CameraApp::CameraApp() 
     : BaseApp("camera", "Camera", "1.0.0") {
     setDescription("Camera application with SC2356 2MP sensor");
@@ -39,25 +56,22 @@ os_error_t CameraApp::initialize() {
         return result;
     }
 
-    // Allocate preview buffer
-    m_previewBufferSize = PREVIEW_WIDTH * PREVIEW_HEIGHT * 2; // RGB565
-    m_previewBuffer = (uint8_t*)heap_caps_malloc(m_previewBufferSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (!m_previewBuffer) {
-        log(ESP_LOG_ERROR, "Failed to allocate preview buffer");
-        return OS_ERROR_NO_MEMORY;
+    // Decode and preview buffers are allocated once, here
+    result = m_preview.initialize(PREVIEW_WIDTH, PREVIEW_HEIGHT);
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to initialize preview pipeline");
+        esp_camera_deinit();
+        m_cameraInitialized = false;
+        return result;
     }
 
-    // Initialize preview image descriptor
-    m_previewImageDesc.header.always_zero = 0;
-    m_previewImageDesc.header.w = PREVIEW_WIDTH;
-    m_previewImageDesc.header.h = PREVIEW_HEIGHT;
-    m_previewImageDesc.data_size = m_previewBufferSize;
-    m_previewImageDesc.header.cf = LV_IMG_CF_TRUE_COLOR;
-    m_previewImageDesc.data = m_previewBuffer;
-
-    setMemoryUsage(m_previewBufferSize + 4096); // Preview buffer + overhead
+    setMemoryUsage(PREVIEW_WIDTH * PREVIEW_HEIGHT * 2 * 2 + 4096); // Preview buffers + overhead
     m_initialized = true;
 
+    if (startPreviewTask() != OS_OK) {
+        log(ESP_LOG_WARN, "Preview task failed to start");
+    }
+
     log(ESP_LOG_INFO, "Camera application initialized successfully");
     return OS_OK;
 }
@@ -67,13 +81,13 @@ os_error_t CameraApp::update(uint32_t deltaTime) {
         return OS_ERROR_GENERIC;
     }
 
-    // Update preview if in preview mode
-    if (m_currentMode == CameraMode::PREVIEW && m_cameraInitialized) {
-        uint32_t now = millis();
-        if (now - m_lastFrameTime >= PREVIEW_UPDATE_INTERVAL) {
-            updatePreview();
-            m_lastFrameTime = now;
-        }
+    // Swap in the frame the preview task finished, if any
+    updatePreview();
+
+    // The recorder refuses frames once the file or index is full
+    if (m_recording && m_recorder.isFull()) {
+        log(ESP_LOG_WARN, "Recording limit reached");
+        stopVideoRecording();
     }
 
     // Update recording timer if recording
@@ -101,17 +115,17 @@ os_error_t CameraApp::shutdown() {
         stopVideoRecording();
     }
 
+    // The preview task holds frame buffers; stop it before the camera
+    stopPreviewTask();
+
     // Deinitialize camera
     if (m_cameraInitialized) {
         esp_camera_deinit();
         m_cameraInitialized = false;
     }
 
-    // Free preview buffer
-    if (m_previewBuffer) {
-        heap_caps_free(m_previewBuffer);
-        m_previewBuffer = nullptr;
-    }
+    // Free preview buffers
+    m_preview.shutdown();
 
     m_initialized = false;
     return OS_OK;
@@ -188,7 +202,7 @@ os_error_t CameraApp::initializeCamera() {
     config.pixel_format = PIXFORMAT_JPEG;
     config.frame_size = FRAMESIZE_HD;
     config.jpeg_quality = 12;
-    config.fb_count = 2;
+    config.fb_count = OS_CAMERA_FB_COUNT;
     config.grab_mode = CAMERA_GRAB_WHEN_EMPTY;
 
     // Initialize camera
@@ -263,13 +277,17 @@ os_error_t CameraApp::startVideoRecording() {
     }
 
     log(ESP_LOG_INFO, "Starting video recording");
-    
+
+    char filename[MAX_FILENAME_LENGTH];
+    snprintf(filename, sizeof(filename), "/sdcard/VID_%05d.avi", m_videosRecorded + 1);
+    os_error_t result = m_recorder.start(filename);
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to start recording: %s", filename);
+        return result;
+    }
+
     m_recording = true;
     m_recordingStartTime = millis();
-    
-    // TODO: Implement actual video recording
-    // This would involve setting up video encoder and file writing
-    
     return OS_OK;
 }
 
@@ -279,12 +297,22 @@ os_error_t CameraApp::stopVideoRecording() {
     }
 
     log(ESP_LOG_INFO, "Stopping video recording");
-    
+
+    // Drains the queued frames, then writes the index and final header
     m_recording = false;
+    os_error_t result = m_recorder.stop();
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Recording %s was not finalized", m_recorder.getPath());
+        return result;
+    }
+
     m_videosRecorded++;
-    
-    // TODO: Finalize video file
-    
+    VideoRecordStats stats = m_recorder.getStats();
+    log(ESP_LOG_INFO, "Video saved: %s (%d frames, %d dropped)",
+        m_recorder.getPath(), stats.framesRecorded, stats.framesDropped);
+    if (m_statusLabel) {
+        lv_label_set_text(m_statusLabel, "READY");
+    }
     return OS_OK;
 }
 
@@ -323,11 +351,16 @@ os_error_t CameraApp::setResolution(CaptureResolution resolution) {
 
 os_error_t CameraApp::toggleCamera() {
     if (m_cameraInitialized) {
+        stopPreviewTask();
         esp_camera_deinit();
         m_cameraInitialized = false;
         log(ESP_LOG_INFO, "Camera disabled");
     } else {
-        return initializeCamera();
+        os_error_t result = initializeCamera();
+        if (result == OS_OK) {
+            startPreviewTask();
+        }
+        return result;
     }
     return OS_OK;
 }
@@ -338,6 +371,16 @@ void CameraApp::printCameraStats() const {
     log(ESP_LOG_INFO, "  Videos recorded: %d", m_videosRecorded);
     log(ESP_LOG_INFO, "  Total frames: %d", m_totalFrames);
     log(ESP_LOG_INFO, "  Frame rate: %.1f FPS", m_frameRate);
+    m_preview.printStats(TAG);
+    m_frameGraph.printStats(TAG);
+
+    VideoRecordStats video = m_recorder.getStats();
+    log(ESP_LOG_INFO, "  Video frames written: %d, dropped: %d, write errors: %d",
+        video.framesRecorded, video.framesDropped, video.writeErrors);
+    log(ESP_LOG_INFO, "  Video throughput: %d KB/s, %llu KB in %d ms",
+        video.writeKBps, video.fileBytes / 1024, video.elapsedMs);
+    log(ESP_LOG_INFO, "  Video queue depth: %d (max %d of %d)",
+        video.queueDepth, video.maxQueueDepth, OS_VIDEO_SLOTS);
     log(ESP_LOG_INFO, "  Current mode: %d", (int)m_currentMode);
     log(ESP_LOG_INFO, "  Resolution: %d", (int)m_resolution);
     log(ESP_LOG_INFO, "  Recording: %s", m_recording ? "YES" : "NO");
@@ -352,8 +395,15 @@ void CameraApp::createPreviewUI() {
     lv_obj_set_style_border_color(m_previewContainer, lv_color_white(), 0);
     lv_obj_set_style_border_width(m_previewContainer, 2, 0);
 
-    // Create preview image
+    lv_obj_set_style_pad_all(m_previewContainer, 0, 0);
+    lv_obj_clear_flag(m_previewContainer, LV_OBJ_FLAG_SCROLLABLE);
+
+    // Create preview image; black until the first frame is swapped in
     m_previewImage = lv_img_create(m_previewContainer);
+    const lv_img_dsc_t* frame = m_preview.getFrontFrame();
+    if (frame) {
+        lv_img_set_src(m_previewImage, frame);
+    }
     lv_obj_center(m_previewImage);
 
     // Status label
@@ -408,35 +458,112 @@ void CameraApp::createCameraControls() {
 }
 
 void CameraApp::updatePreview() {
-    if (!m_cameraInitialized || !m_previewImage) {
+    if (!m_previewImage) {
         return;
     }
 
-    // Capture frame for preview
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (fb) {
-        // TODO: Convert JPEG to RGB565 for LVGL display
-        // This is a simplified implementation
-        // Real implementation would decode JPEG and scale to preview size
-        
-        lv_img_set_src(m_previewImage, &m_previewImageDesc);
-        
+    // Pointer swap only: the pixels were written by the preview task
+    const lv_img_dsc_t* frame = m_preview.takeFrame();
+    if (frame) {
+        lv_img_set_src(m_previewImage, frame);
         m_totalFrames++;
-        
-        // Calculate frame rate
-        uint32_t now = millis();
-        static uint32_t lastFpsUpdate = 0;
-        static uint32_t frameCount = 0;
-        frameCount++;
-        
-        if (now - lastFpsUpdate >= 1000) {
-            m_frameRate = frameCount * 1000.0f / (now - lastFpsUpdate);
-            frameCount = 0;
-            lastFpsUpdate = now;
+        m_fpsFrames++;
+    }
+
+    // Calculate frame rate
+    uint32_t now = millis();
+    if (now - m_fpsWindowStart >= 1000) {
+        m_frameRate = m_fpsFrames * 1000.0f / (now - m_fpsWindowStart);
+        m_fpsFrames = 0;
+        m_fpsWindowStart = now;
+    }
+}
+
+os_error_t CameraApp::startPreviewTask() {
+    if (m_previewTaskHandle || !m_cameraInitialized || !m_preview.isInitialized()) {
+        return m_previewTaskHandle ? OS_OK : OS_ERROR_GENERIC;
+    }
+
+    m_previewRunning = true;
+    if (xTaskCreatePinnedToCore(previewTask, "camera_preview", OS_CAMERA_TASK_STACK, this,
+                                OS_CAMERA_TASK_PRIORITY, &m_previewTaskHandle,
+                                OS_CAMERA_TASK_CORE) != pdPASS) {
+        m_previewRunning = false;
+        m_previewTaskHandle = nullptr;
+        return OS_ERROR_NO_MEMORY;
+    }
+    registerTask(m_previewTaskHandle);
+    return OS_OK;
+}
+
+void CameraApp::stopPreviewTask() {
+    if (!m_previewTaskHandle) {
+        return;
+    }
+
+    // The task exits within one buffer wait or sensor frame
+    TaskHandle_t task = m_previewTaskHandle;
+    unregisterTask(task);
+    m_previewRunning = false;
+    for (int attempt = 0; attempt < 30 && m_previewTaskHandle; attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (m_previewTaskHandle) {
+        log(ESP_LOG_WARN, "Preview task did not exit, deleting");
+        vTaskDelete(task);
+        m_previewTaskHandle = nullptr;
+    }
+
+    // Stages may still hold driver frames
+    if (!m_frameGraph.waitIdle(OS_FRAME_GRAPH_REMOVE_TIMEOUT_MS)) {
+        log(ESP_LOG_WARN, "Frame stages still hold camera buffers");
+    }
+}
+
+void CameraApp::previewTask(void* parameter) {
+    CameraApp* app = static_cast<CameraApp*>(parameter);
+    uint32_t sequence = 0;
+
+    while (app->m_previewRunning) {
+        bool recording = app->m_recorder.isActive();
+        if (!recording && app->m_currentMode != CameraMode::PREVIEW &&
+            app->m_currentMode != CameraMode::VIDEO) {
+            vTaskDelay(pdMS_TO_TICKS(PREVIEW_IDLE_MS));
+            continue;
         }
-        
-        esp_camera_fb_return(fb);
+
+        // Grab a frame only once there is somewhere to put it; a recording
+        // takes every frame and the preview shows those it has room for
+        if (!recording && !app->m_preview.waitWritable(PREVIEW_WAIT_MS)) {
+            continue;
+        }
+
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            vTaskDelay(pdMS_TO_TICKS(PREVIEW_IDLE_MS));
+            continue;
+        }
+
+        // A slot copy only; the card write happens on the recorder's core
+        if (recording && fb->format == PIXFORMAT_JPEG) {
+            app->m_recorder.addFrame(fb->buf, fb->len, (uint16_t)fb->width, (uint16_t)fb->height);
+        }
+
+        if (app->m_preview.waitWritable(0) &&
+            app->m_preview.render(fb->buf, fb->len, frameFormat(fb->format),
+                                  (uint16_t)fb->width, (uint16_t)fb->height) == OS_OK) {
+            OS().wake();
+        }
+
+        // Analysis goes last and shares the driver buffer; the graph
+        // returns it once the last stage is done
+        CameraFrameInfo frame = {fb->buf, fb->len, (uint16_t)fb->width, (uint16_t)fb->height,
+                                 frameFormat(fb->format), esp_timer_get_time(), sequence++};
+        app->m_frameGraph.dispatch(frame, returnFrame, fb);
     }
+
+    app->m_previewTaskHandle = nullptr;
+    vTaskDelete(NULL);
 }
 
 os_error_t CameraApp::saveImage(camera_fb_t* fb) {
@@ -464,6 +591,17 @@ os_error_t CameraApp::saveImage(camera_fb_t* fb) {
     }
 
     log(ESP_LOG_INFO, "Image saved: %s (%d bytes)", filename, fb->len);
+
+    // The preview on screen is the same picture already decoded: thumbnail it
+    // now so the file manager never has to decode the capture
+    const lv_img_dsc_t* frame = m_preview.getFrontFrame();
+    uint16_t x, y, w, h;
+    struct stat st;
+    if (frame && m_preview.getFrontPicture(x, y, w, h) && stat(filename, &st) == 0) {
+        uint32_t stride = frame->header.w * sizeof(uint16_t);
+        OS().getThumbnails().store(filename, (uint32_t)st.st_mtime, (uint32_t)st.st_size,
+                                   frame->data + y * stride + x * sizeof(uint16_t), w, h, stride);
+    }
     return OS_OK;
 }
 
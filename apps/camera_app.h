@@ -3,15 +3,31 @@
 
 #include "base_app.h"
 #include "../hal/hardware_config.h"
+#include "../hal/camera_preview.h"
+#include "../system/avi_recorder.h"
+#include "../system/frame_graph.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 // Camera support is conditional based on availability
 #ifdef ESP_CAMERA_SUPPORTED
 #include <esp_camera.h>
 #else
 // Stub definitions for camera types
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_YUV420,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG
+} pixformat_t;
+
 typedef struct {
     uint8_t* buf;
     size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
 } camera_fb_t;
 
 #define CAMERA_GRAB_WHEN_EMPTY 0
@@ -33,10 +49,6 @@ typedef enum {
     GAINCEILING_128X
 } gainceiling_t;
 
-typedef enum {
-    PIXFORMAT_JPEG
-} pixformat_t;
-
 typedef struct {
     int (*set_framesize)(void* sensor, framesize_t framesize);
     int (*set_brightness)(void* sensor, int level);
@@ -84,6 +96,15 @@ typedef struct {
  * Provides camera functionality using the SC2356 2MP sensor
  * via MIPI-CSI interface with live preview, photo capture,
  * and video recording capabilities.
+ *
+ * A preview task takes sensor frames and runs them through CameraPreview
+ * (hardware JPEG decode, PPA scale into two PSRAM buffers); update()
+ * only swaps the finished buffer into the image widget. While recording,
+ * the same task also hands every JPEG frame to an AviRecorder, whose
+ * writer task streams them to the card from the other core. Analysis
+ * stages registered with addFrameStage() get each driver frame last,
+ * without a copy, on WorkerPool cores; the buffer returns to the driver
+ * once the last stage is done.
  */
 
 enum class CameraMode {
@@ -162,6 +183,23 @@ public:
      */
     os_error_t toggleCamera();
 
+    /**
+     * @brief Register a frame analysis stage
+     * @param stage Stage, owned by the caller until removeFrameStage()
+     * @param core Worker core to run on, or WorkerPool::ANY_CORE
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t addFrameStage(FrameStage* stage, int core = WorkerPool::ANY_CORE) {
+        return m_frameGraph.addStage(stage, core);
+    }
+
+    /**
+     * @brief Unregister a frame analysis stage
+     * @param stage Stage from addFrameStage()
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t removeFrameStage(FrameStage* stage) { return m_frameGraph.removeStage(stage); }
+
     /**
      * @brief Get camera statistics
      */
@@ -179,10 +217,27 @@ private:
     void createCameraControls();
 
     /**
-     * @brief Update camera preview
+     * @brief Show the latest converted frame and update the frame rate
      */
     void updatePreview();
 
+    /**
+     * @brief Start the task feeding the preview pipeline
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t startPreviewTask();
+
+    /**
+     * @brief Stop the preview task (before the camera is deinitialized)
+     */
+    void stopPreviewTask();
+
+    /**
+     * @brief Preview task: sensor frame -> recorder and decode/scale -> back buffer
+     * @param parameter CameraApp instance
+     */
+    static void previewTask(void* parameter);
+
     /**
      * @brief Save captured image
      * @param fb Camera frame buffer
@@ -222,18 +277,22 @@ private:
     uint32_t m_photosCaptured = 0;
     uint32_t m_videosRecorded = 0;
     uint32_t m_totalFrames = 0;
-    uint32_t m_lastFrameTime = 0;
+    uint32_t m_fpsWindowStart = 0;
+    uint32_t m_fpsFrames = 0;
     float m_frameRate = 0.0f;
 
-    // Image buffer for preview
-    lv_img_dsc_t m_previewImageDesc;
-    uint8_t* m_previewBuffer = nullptr;
-    size_t m_previewBufferSize = 0;
+    // Preview pipeline and the task feeding it
+    CameraPreview m_preview;
+    AviRecorder m_recorder;
+    FrameGraph m_frameGraph;
+    TaskHandle_t m_previewTaskHandle = nullptr;
+    volatile bool m_previewRunning = false;
 
     // Configuration
-    static constexpr uint32_t PREVIEW_UPDATE_INTERVAL = 33; // ~30 FPS
-    static constexpr uint32_t PREVIEW_WIDTH = 320;
-    static constexpr uint32_t PREVIEW_HEIGHT = 240;
+    static constexpr uint32_t PREVIEW_WIDTH = 896;      // 16:9, fits the preview container
+    static constexpr uint32_t PREVIEW_HEIGHT = 504;
+    static constexpr uint32_t PREVIEW_WAIT_MS = 100;    // Back buffer wait; bounds task exit
+    static constexpr uint32_t PREVIEW_IDLE_MS = 50;     // Poll while not previewing
     static constexpr size_t MAX_FILENAME_LENGTH = 64;
 };
 
@@ -1,11 +1,9 @@
 #include "contact_management_app.h"
 #include "../system/os_manager.h"
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 
 ContactManagementApp::ContactManagementApp() 
-    : BaseApp("com.m5stack.contacts", "Contacts", "1.0.0"), m_nextContactId(1) {
+    : BaseApp("com.m5stack.contacts", "Contacts", "1.0.0") {
     setDescription("Contact management application with address book functionality");
     setAuthor("M5Stack");
     setPriority(AppPriority::APP_NORMAL);
@@ -33,7 +31,14 @@ os_error_t ContactManagementApp::initialize() {
 }
 
 os_error_t ContactManagementApp::update(uint32_t deltaTime) {
-    // Periodic operations can be added here
+    if (m_contactList) {
+        m_contactView.refresh(deltaTime);
+    }
+
+    // One rewrite for a burst of edits
+    if (m_store.isDirty() && millis() - m_lastChangeMs >= OS_CONTACTS_SAVE_DELAY_MS) {
+        saveContacts();
+    }
     return OS_OK;
 }
 
@@ -62,9 +67,8 @@ os_error_t ContactManagementApp::createUI(lv_obj_t* parent) {
                     LV_VER_RES - 60 - 40); // Account for status bar and dock
     lv_obj_align(m_uiContainer, LV_ALIGN_CENTER, 0, 0);
     
-    // Apply theme
-    lv_obj_set_style_bg_color(m_uiContainer, lv_color_hex(0x1E1E1E), 0);
-    lv_obj_set_style_border_opa(m_uiContainer, LV_OPA_TRANSP, 0);
+    // Apply theme (shared styles follow theme switches)
+    OS().getUIManager().getThemeManager().applyTheme(m_uiContainer);
     lv_obj_set_style_pad_all(m_uiContainer, 10, 0);
 
     createMainUI();
@@ -75,6 +79,7 @@ os_error_t ContactManagementApp::destroyUI() {
     if (m_uiContainer) {
         lv_obj_del(m_uiContainer);
         m_uiContainer = nullptr;
+        m_contactList = nullptr;    // Deleted with the container
     }
     return OS_OK;
 }
@@ -96,7 +101,7 @@ void ContactManagementApp::createSearchBar() {
     lv_obj_t* searchContainer = lv_obj_create(m_uiContainer);
     lv_obj_set_size(searchContainer, LV_PCT(100), 50);
     lv_obj_align(searchContainer, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_bg_color(searchContainer, lv_color_hex(0x2C2C2C), 0);
+    OS().getUIManager().getThemeManager().addStyle(searchContainer, StyleRole::TOOLBAR);
     lv_obj_set_style_pad_all(searchContainer, 5, 0);
     
     // Search input
@@ -119,7 +124,7 @@ void ContactManagementApp::createToolbar() {
     m_toolbar = lv_obj_create(m_uiContainer);
     lv_obj_set_size(m_toolbar, LV_PCT(100), 50);
     lv_obj_align_to(m_toolbar, m_searchBar->parent, LV_ALIGN_OUT_BOTTOM_MID, 0, 5);
-    lv_obj_set_style_bg_color(m_toolbar, lv_color_hex(0x2C2C2C), 0);
+    OS().getUIManager().getThemeManager().addStyle(m_toolbar, StyleRole::TOOLBAR);
     lv_obj_set_style_pad_all(m_toolbar, 5, 0);
     
     // Add button
@@ -147,7 +152,7 @@ void ContactManagementApp::createToolbar() {
     lv_obj_set_size(deleteBtn, 80, LV_PCT(100));
     lv_obj_align_to(deleteBtn, editBtn, LV_ALIGN_OUT_RIGHT_MID, 10, 0);
     lv_obj_add_event_cb(deleteBtn, deleteButtonCallback, LV_EVENT_CLICKED, this);
-    lv_obj_set_style_bg_color(deleteBtn, lv_color_hex(0xE74C3C), 0);
+    OS().getUIManager().getThemeManager().addStyle(deleteBtn, StyleRole::BUTTON_DANGER);
     
     lv_obj_t* deleteLabel = lv_label_create(deleteBtn);
     lv_label_set_text(deleteLabel, "Delete");
@@ -155,38 +160,50 @@ void ContactManagementApp::createToolbar() {
 }
 
 void ContactManagementApp::createContactList() {
-    m_contactList = lv_list_create(m_uiContainer);
-    lv_obj_set_size(m_contactList, LV_PCT(50), LV_PCT(100) - 110);
+    // A pool of rows rebound as the list scrolls, over the IDs of the last search
+    m_contactView.setBindCallback([this](size_t index, const VirtualListRow& row) { bindContactRow(index, row); });
+    m_contactView.setClickCallback([this](size_t index) { selectContact(index); });
+    m_contactList = m_contactView.create(m_uiContainer, (LV_HOR_RES - 20) / 2, LV_VER_RES - 100 - 20 - 110,
+                                         OS_CONTACT_ROW_HEIGHT);
     lv_obj_align_to(m_contactList, m_toolbar, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 5);
-    lv_obj_set_style_bg_color(m_contactList, lv_color_hex(0x2C2C2C), 0);
 }
 
 void ContactManagementApp::createContactDetails() {
     m_detailsPanel = lv_obj_create(m_uiContainer);
     lv_obj_set_size(m_detailsPanel, LV_PCT(45), LV_PCT(100) - 110);
     lv_obj_align_to(m_detailsPanel, m_contactList, LV_ALIGN_OUT_RIGHT_MID, 10, 0);
-    lv_obj_set_style_bg_color(m_detailsPanel, lv_color_hex(0x2C2C2C), 0);
+    OS().getUIManager().getThemeManager().addStyle(m_detailsPanel, StyleRole::PANEL);
     lv_obj_set_style_pad_all(m_detailsPanel, 15, 0);
 }
 
 void ContactManagementApp::refreshContactList() {
-    lv_obj_clean(m_contactList);
-    
-    const std::vector<Contact>& contacts = m_currentFilter.empty() ? m_contacts : m_filteredContacts;
-    
-    for (const auto& contact : contacts) {
-        lv_obj_t* btn = lv_list_add_btn(m_contactList, LV_SYMBOL_CALL, contact.name.c_str());
-        lv_obj_set_user_data(btn, (void*)contact.id);
-        lv_obj_add_event_cb(btn, contactListCallback, LV_EVENT_CLICKED, this);
-        
-        // Add category indicator
-        if (!contact.category.empty()) {
-            lv_obj_t* categoryLabel = lv_label_create(btn);
-            lv_label_set_text(categoryLabel, contact.category.c_str());
-            lv_obj_align(categoryLabel, LV_ALIGN_BOTTOM_RIGHT, -5, -2);
-            lv_obj_set_style_text_color(categoryLabel, lv_color_hex(0x95A5A6), 0);
-            lv_obj_set_style_text_font(categoryLabel, &lv_font_montserrat_12, 0);
-        }
+    // Same search again after a change; the list keeps its scroll position
+    m_store.search(m_currentFilter, m_currentCategory, m_resultIds);
+    if (m_contactList) {
+        auto selected = std::lower_bound(m_resultIds.begin(), m_resultIds.end(), m_selectedId);
+        bool found = selected != m_resultIds.end() && *selected == m_selectedId;
+        m_contactView.setCount(m_resultIds.size());
+        m_contactView.setSelected(found ? (int)(selected - m_resultIds.begin()) : -1);
+        m_contactView.invalidate();
+    }
+}
+
+void ContactManagementApp::bindContactRow(size_t index, const VirtualListRow& row) {
+    const Contact* contact = m_store.find(m_resultIds[index]);
+    if (!contact) {
+        return;
+    }
+    lv_label_set_text_static(row.icon, LV_SYMBOL_CALL);
+    lv_label_set_text(row.text, contact->name.c_str());
+    lv_label_set_text(row.detail, contact->category.c_str());
+}
+
+void ContactManagementApp::selectContact(size_t index) {
+    const Contact* contact = index < m_resultIds.size() ? m_store.find(m_resultIds[index]) : nullptr;
+    if (contact) {
+        m_selectedId = contact->id;
+        m_contactView.setSelected((int)index);
+        showContactDetails(*contact);
     }
 }
 
@@ -198,7 +215,7 @@ void ContactManagementApp::showContactDetails(const Contact& contact) {
     lv_obj_t* titleLabel = lv_label_create(m_detailsPanel);
     lv_label_set_text(titleLabel, contact.name.c_str());
     lv_obj_align(titleLabel, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_text_font(titleLabel, &lv_font_montserrat_16, 0);
+    OS().getUIManager().getThemeManager().addStyle(titleLabel, StyleRole::TEXT_TITLE);
     
     // Phone
     if (!contact.phone.empty()) {
@@ -239,15 +256,14 @@ void ContactManagementApp::createAddEditDialog() {
     m_addEditDialog = lv_obj_create(lv_scr_act());
     lv_obj_set_size(m_addEditDialog, 400, 350);
     lv_obj_center(m_addEditDialog);
-    lv_obj_set_style_bg_color(m_addEditDialog, lv_color_hex(0x2C2C2C), 0);
-    lv_obj_set_style_border_color(m_addEditDialog, lv_color_hex(0x3498DB), 0);
-    lv_obj_set_style_border_width(m_addEditDialog, 2, 0);
+    OS().getUIManager().getThemeManager().addStyle(m_addEditDialog, StyleRole::DIALOG);
     
     // Title
     lv_obj_t* title = lv_label_create(m_addEditDialog);
-    lv_label_set_text(title, m_editingContact ? "Edit Contact" : "Add Contact");
+    const Contact* editing = m_editingId ? m_store.find(m_editingId) : nullptr;
+    lv_label_set_text(title, editing ? "Edit Contact" : "Add Contact");
     lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 10);
-    lv_obj_set_style_text_font(title, &lv_font_montserrat_16, 0);
+    OS().getUIManager().getThemeManager().addStyle(title, StyleRole::TEXT_TITLE);
     
     // Name input
     lv_obj_t* nameLabel = lv_label_create(m_addEditDialog);
@@ -303,7 +319,7 @@ void ContactManagementApp::createAddEditDialog() {
     lv_obj_set_size(saveBtn, 80, 35);
     lv_obj_align(saveBtn, LV_ALIGN_BOTTOM_LEFT, 20, -20);
     lv_obj_add_event_cb(saveBtn, saveButtonCallback, LV_EVENT_CLICKED, this);
-    lv_obj_set_style_bg_color(saveBtn, lv_color_hex(0x27AE60), 0);
+    OS().getUIManager().getThemeManager().addStyle(saveBtn, StyleRole::BUTTON_SUCCESS);
     
     lv_obj_t* saveLabel = lv_label_create(saveBtn);
     lv_label_set_text(saveLabel, "Save");
@@ -313,29 +329,29 @@ void ContactManagementApp::createAddEditDialog() {
     lv_obj_set_size(cancelBtn, 80, 35);
     lv_obj_align(cancelBtn, LV_ALIGN_BOTTOM_RIGHT, -20, -20);
     lv_obj_add_event_cb(cancelBtn, cancelButtonCallback, LV_EVENT_CLICKED, this);
-    lv_obj_set_style_bg_color(cancelBtn, lv_color_hex(0xE74C3C), 0);
+    OS().getUIManager().getThemeManager().addStyle(cancelBtn, StyleRole::BUTTON_DANGER);
     
     lv_obj_t* cancelLabel = lv_label_create(cancelBtn);
     lv_label_set_text(cancelLabel, "Cancel");
     lv_obj_center(cancelLabel);
     
     // Pre-fill if editing
-    if (m_editingContact) {
-        lv_textarea_set_text(m_nameInput, m_editingContact->name.c_str());
-        lv_textarea_set_text(m_phoneInput, m_editingContact->phone.c_str());
-        lv_textarea_set_text(m_emailInput, m_editingContact->email.c_str());
-        lv_textarea_set_text(m_addressInput, m_editingContact->address.c_str());
+    if (editing) {
+        lv_textarea_set_text(m_nameInput, editing->name.c_str());
+        lv_textarea_set_text(m_phoneInput, editing->phone.c_str());
+        lv_textarea_set_text(m_emailInput, editing->email.c_str());
+        lv_textarea_set_text(m_addressInput, editing->address.c_str());
         
         // Set category
-        if (m_editingContact->category == "Family") lv_dropdown_set_selected(m_categoryInput, 0);
-        else if (m_editingContact->category == "Friends") lv_dropdown_set_selected(m_categoryInput, 1);
-        else if (m_editingContact->category == "Work") lv_dropdown_set_selected(m_categoryInput, 2);
+        if (editing->category == "Family") lv_dropdown_set_selected(m_categoryInput, 0);
+        else if (editing->category == "Friends") lv_dropdown_set_selected(m_categoryInput, 1);
+        else if (editing->category == "Work") lv_dropdown_set_selected(m_categoryInput, 2);
         else lv_dropdown_set_selected(m_categoryInput, 3);
     }
 }
 
-void ContactManagementApp::showAddEditDialog(Contact* contact) {
-    m_editingContact = contact;
+void ContactManagementApp::showAddEditDialog(const Contact* contact) {
+    m_editingId = contact ? contact->id : 0;
     createAddEditDialog();
 }
 
@@ -343,111 +359,85 @@ void ContactManagementApp::hideAddEditDialog() {
     if (m_addEditDialog) {
         lv_obj_del(m_addEditDialog);
         m_addEditDialog = nullptr;
-        m_editingContact = nullptr;
+        m_editingId = 0;
     }
 }
 
 void ContactManagementApp::searchContacts(const std::string& searchText) {
     m_currentFilter = searchText;
-    m_filteredContacts.clear();
-    
-    if (searchText.empty()) {
-        refreshContactList();
-        return;
-    }
-    
-    std::string lowerSearch = searchText;
-    std::transform(lowerSearch.begin(), lowerSearch.end(), lowerSearch.begin(), ::tolower);
-    
-    for (const auto& contact : m_contacts) {
-        std::string lowerName = contact.name;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-        
-        if (lowerName.find(lowerSearch) != std::string::npos ||
-            contact.phone.find(searchText) != std::string::npos ||
-            contact.email.find(lowerSearch) != std::string::npos) {
-            
-            if (m_currentCategory.empty() || contact.category == m_currentCategory) {
-                m_filteredContacts.push_back(contact);
-            }
-        }
+
+    // The index answers with IDs; only the rows on screen look at records
+    m_store.search(m_currentFilter, m_currentCategory, m_resultIds);
+    if (m_contactList) {
+        m_contactView.reset(m_resultIds.size());
     }
-    
-    refreshContactList();
 }
 
 void ContactManagementApp::filterByCategory(const std::string& category) {
     m_currentCategory = (category == "All") ? "" : category;
-    
-    if (!m_currentFilter.empty()) {
-        searchContacts(m_currentFilter);
-    } else {
-        m_filteredContacts.clear();
-        
-        if (m_currentCategory.empty()) {
-            refreshContactList();
-            return;
-        }
-        
-        for (const auto& contact : m_contacts) {
-            if (contact.category == m_currentCategory) {
-                m_filteredContacts.push_back(contact);
-            }
-        }
-        
-        refreshContactList();
-    }
+    searchContacts(m_currentFilter);
 }
 
 void ContactManagementApp::addContact(const Contact& contact) {
-    Contact newContact = contact;
-    newContact.id = m_nextContactId++;
-    m_contacts.push_back(newContact);
-    saveContacts();
+    m_selectedId = m_store.add(contact);
+    markChanged();
     refreshContactList();
 }
 
 void ContactManagementApp::editContact(uint32_t contactId, const Contact& contact) {
-    for (auto& c : m_contacts) {
-        if (c.id == contactId) {
-            c.name = contact.name;
-            c.phone = contact.phone;
-            c.email = contact.email;
-            c.address = contact.address;
-            c.category = contact.category;
-            break;
+    if (m_store.update(contactId, contact)) {
+        markChanged();
+        refreshContactList();
+        const Contact* updated = m_store.find(contactId);
+        if (updated && contactId == m_selectedId) {
+            showContactDetails(*updated);
         }
     }
-    saveContacts();
-    refreshContactList();
 }
 
 void ContactManagementApp::deleteContact(uint32_t contactId) {
-    m_contacts.erase(
-        std::remove_if(m_contacts.begin(), m_contacts.end(),
-                      [contactId](const Contact& c) { return c.id == contactId; }),
-        m_contacts.end());
-    saveContacts();
+    if (!m_store.remove(contactId)) {
+        return;
+    }
+    if (contactId == m_selectedId) {
+        m_selectedId = 0;
+    }
+    markChanged();
     refreshContactList();
     lv_obj_add_flag(m_detailsPanel, LV_OBJ_FLAG_HIDDEN);
 }
 
+void ContactManagementApp::markChanged() {
+    m_lastChangeMs = millis();
+}
+
 os_error_t ContactManagementApp::loadContacts() {
-    // For now, add some sample contacts
-    Contact contact1 = {"John Doe", "+1234567890", "john@example.com", "123 Main St", "Work", m_nextContactId++};
-    Contact contact2 = {"Jane Smith", "+0987654321", "jane@example.com", "456 Oak Ave", "Friends", m_nextContactId++};
-    Contact contact3 = {"Bob Johnson", "+1122334455", "bob@company.com", "789 Pine Rd", "Work", m_nextContactId++};
-    
-    m_contacts.push_back(contact1);
-    m_contacts.push_back(contact2);
-    m_contacts.push_back(contact3);
-    
-    return OS_OK;
+    os_error_t result = m_store.load(OS_CONTACTS_PATH);
+    if (result == OS_ERROR_NOT_FOUND) {
+        // First run: start the address book with a few samples
+        m_store.add({"John Doe", "+1234567890", "john@example.com", "123 Main St", "Work", 0});
+        m_store.add({"Jane Smith", "+0987654321", "jane@example.com", "456 Oak Ave", "Friends", 0});
+        m_store.add({"Bob Johnson", "+1122334455", "bob@company.com", "789 Pine Rd", "Work", 0});
+        markChanged();
+        return OS_OK;
+    }
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to load contacts from %s", OS_CONTACTS_PATH);
+    }
+    return result;
 }
 
 os_error_t ContactManagementApp::saveContacts() {
-    // In a real implementation, save to file system
-    return OS_OK;
+    if (!m_store.isDirty()) {
+        return OS_OK;
+    }
+    os_error_t result = m_store.save();
+    if (result != OS_OK) {
+        // Retry after the next delay rather than on every update
+        markChanged();
+        log(ESP_LOG_ERROR, "Failed to save contacts");
+    }
+    return result;
 }
 
 // Static callbacks
@@ -458,30 +448,24 @@ void ContactManagementApp::searchCallback(lv_event_t* e) {
     app->searchContacts(text ? text : "");
 }
 
-void ContactManagementApp::contactListCallback(lv_event_t* e) {
-    ContactManagementApp* app = static_cast<ContactManagementApp*>(lv_event_get_user_data(e));
-    lv_obj_t* btn = lv_event_get_target(e);
-    uint32_t contactId = (uint32_t)(uintptr_t)lv_obj_get_user_data(btn);
-    
-    for (const auto& contact : app->m_contacts) {
-        if (contact.id == contactId) {
-            app->showContactDetails(contact);
-            break;
-        }
-    }
-}
-
 void ContactManagementApp::addButtonCallback(lv_event_t* e) {
     ContactManagementApp* app = static_cast<ContactManagementApp*>(lv_event_get_user_data(e));
     app->showAddEditDialog();
 }
 
 void ContactManagementApp::editButtonCallback(lv_event_t* e) {
-    // Implementation for edit button - would need to get currently selected contact
+    ContactManagementApp* app = static_cast<ContactManagementApp*>(lv_event_get_user_data(e));
+    const Contact* contact = app->m_store.find(app->m_selectedId);
+    if (contact && !app->m_addEditDialog) {
+        app->showAddEditDialog(contact);
+    }
 }
 
 void ContactManagementApp::deleteButtonCallback(lv_event_t* e) {
-    // Implementation for delete button - would need to get currently selected contact
+    ContactManagementApp* app = static_cast<ContactManagementApp*>(lv_event_get_user_data(e));
+    if (app->m_selectedId) {
+        app->deleteContact(app->m_selectedId);
+    }
 }
 
 void ContactManagementApp::saveButtonCallback(lv_event_t* e) {
@@ -502,8 +486,8 @@ void ContactManagementApp::saveButtonCallback(lv_event_t* e) {
         default: contact.category = "Other"; break;
     }
     
-    if (app->m_editingContact) {
-        app->editContact(app->m_editingContact->id, contact);
+    if (app->m_editingId) {
+        app->editContact(app->m_editingId, contact);
     } else {
         app->addContact(contact);
     }
@@ -2,18 +2,22 @@
 #define CONTACT_MANAGEMENT_APP_H
 
 #include "base_app.h"
+#include "../system/contact_store.h"
+#include "../ui/virtual_list.h"
 #include <vector>
 #include <string>
 #include <functional>
 
-struct Contact {
-    std::string name;
-    std::string phone;
-    std::string email;
-    std::string address;
-    std::string category;
-    uint32_t id;
-};
+/**
+ * @file contact_management_app.h
+ * @brief Address book for M5Stack Tab5
+ *
+ * Contacts live in a ContactStore on the SD card (OS_CONTACTS_PATH) with
+ * its search index. A search or category change produces a list of IDs
+ * that a VirtualList shows a screenful at a time, so typing stays
+ * interactive with tens of thousands of contacts. Edits are batched into
+ * one save OS_CONTACTS_SAVE_DELAY_MS after the last change.
+ */
 
 class ContactManagementApp : public BaseApp {
 public:
@@ -35,8 +39,10 @@ private:
     void createAddEditDialog();
     
     void refreshContactList();
+    void bindContactRow(size_t index, const VirtualListRow& row);
+    void selectContact(size_t index);
     void showContactDetails(const Contact& contact);
-    void showAddEditDialog(Contact* contact = nullptr);
+    void showAddEditDialog(const Contact* contact = nullptr);
     void hideAddEditDialog();
     void searchContacts(const std::string& searchText);
     void filterByCategory(const std::string& category);
@@ -47,9 +53,9 @@ private:
     
     os_error_t loadContacts();
     os_error_t saveContacts();
+    void markChanged();
     
     static void searchCallback(lv_event_t* e);
-    static void contactListCallback(lv_event_t* e);
     static void addButtonCallback(lv_event_t* e);
     static void editButtonCallback(lv_event_t* e);
     static void deleteButtonCallback(lv_event_t* e);
@@ -57,13 +63,15 @@ private:
     static void cancelButtonCallback(lv_event_t* e);
     static void categoryFilterCallback(lv_event_t* e);
     
-    std::vector<Contact> m_contacts;
-    std::vector<Contact> m_filteredContacts;
-    uint32_t m_nextContactId;
+    ContactStore m_store;
+    std::vector<uint32_t> m_resultIds;      // Contacts listed, from the last search
+    uint32_t m_selectedId = 0;
+    uint32_t m_lastChangeMs = 0;
     
     // UI elements
     lv_obj_t* m_searchBar = nullptr;
     lv_obj_t* m_contactList = nullptr;
+    VirtualList m_contactView;
     lv_obj_t* m_toolbar = nullptr;
     lv_obj_t* m_detailsPanel = nullptr;
     lv_obj_t* m_addEditDialog = nullptr;
@@ -76,7 +84,7 @@ private:
     lv_obj_t* m_addressInput = nullptr;
     lv_obj_t* m_categoryInput = nullptr;
     
-    Contact* m_editingContact = nullptr;
+    uint32_t m_editingId = 0;               // 0 while adding
     std::string m_currentFilter;
     std::string m_currentCategory;
 };
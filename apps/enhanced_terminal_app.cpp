@@ -5,6 +5,7 @@
 #include <lwip/netdb.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <fcntl.h>
 #include <string.h>
 #include <algorithm>
 #include <sstream>
@@ -28,6 +29,10 @@ EnhancedTerminalApp::EnhancedTerminalApp()
 
 EnhancedTerminalApp::~EnhancedTerminalApp() {
     shutdown();
+    if (m_sessionMutex) {
+        vSemaphoreDelete(m_sessionMutex);
+        m_sessionMutex = nullptr;
+    }
 }
 
 os_error_t EnhancedTerminalApp::initialize() {
@@ -41,16 +46,32 @@ os_error_t EnhancedTerminalApp::initialize() {
     m_rxBufferSize = RX_BUFFER_SIZE;
     m_txBufferSize = TX_BUFFER_SIZE;
     
-    m_rxBuffer = (uint8_t*)heap_caps_malloc(m_rxBufferSize, MALLOC_CAP_DMA);
-    m_txBuffer = (uint8_t*)heap_caps_malloc(m_txBufferSize, MALLOC_CAP_DMA);
+    m_rxBuffer = (uint8_t*)OS_MALLOC_DMA(m_rxBufferSize);
+    m_txBuffer = (uint8_t*)OS_MALLOC_DMA(m_txBufferSize);
     
     if (!m_rxBuffer || !m_txBuffer) {
         log(ESP_LOG_ERROR, "Failed to allocate communication buffers");
         return OS_ERROR_NO_MEMORY;
     }
 
+    if (!m_sessionMutex) {
+        m_sessionMutex = xSemaphoreCreateMutex();
+        if (!m_sessionMutex) {
+            log(ESP_LOG_ERROR, "Failed to create session mutex");
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    os_error_t result = m_terminal.initialize(OS_TERM_SCROLLBACK_LINES, OS_TERM_SCROLLBACK_BYTES, getArena());
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to allocate terminal scrollback");
+        return result;
+    }
+    m_terminal.setAutoScroll(m_autoScroll);
+    m_terminal.appendText("Enhanced Terminal Ready");
+
     // Initialize RS-485 hardware
-    os_error_t result = initializeRS485();
+    result = initializeRS485();
     if (result != OS_OK) {
         log(ESP_LOG_WARN, "RS-485 initialization failed, continuing without RS-485");
     }
@@ -64,7 +85,7 @@ os_error_t EnhancedTerminalApp::initialize() {
     // Create default local session
     createSession(TerminalMode::LOCAL);
 
-    setMemoryUsage(m_rxBufferSize + m_txBufferSize + TERMINAL_BUFFER_SIZE + 
+    setMemoryUsage(m_rxBufferSize + m_txBufferSize + m_terminal.getScrollback().getMemoryUsage() +
                    (MAX_SESSIONS * sizeof(TerminalSession)));
     m_initialized = true;
 
@@ -80,16 +101,27 @@ os_error_t EnhancedTerminalApp::update(uint32_t deltaTime) {
     // Process received data from all sessions
     processReceivedData();
 
+    // Capturing shows counters only
+    if (m_capture.isActive() && m_statusLabel) {
+        uint32_t now = millis();
+        if (now - m_captureShownMs >= CAPTURE_SUMMARY_MS) {
+            char summary[160];
+            m_capture.formatSummary(summary, sizeof(summary));
+            lv_label_set_text(m_statusLabel, summary);
+            m_captureShownMs = now;
+        }
+    }
+
+    // One redraw for everything appended this frame, from any task
+    m_terminal.refresh();
+    m_vtView.refresh();
+
     // Update session states
     for (auto& session : m_sessions) {
         if (session && session->isActive) {
             switch (session->state) {
                 case ConnectionState::CONNECTING:
-                    // Check connection timeout
-                    if (millis() - session->connectTime > session->config.timeout) {
-                        session->state = ConnectionState::ERROR;
-                        log(ESP_LOG_WARN, "Connection timeout for session %s", session->id.c_str());
-                    }
+                    // The network task completes the connect or times it out
                     break;
                     
                 case ConnectionState::CONNECTED:
@@ -120,39 +152,51 @@ os_error_t EnhancedTerminalApp::shutdown() {
 
     log(ESP_LOG_INFO, "Shutting down Enhanced Terminal Application");
 
-    // Stop all tasks
+    // Close the log before the UART task goes; it stops recording at once
+    m_capture.stop();
+
+    // Stop all tasks; they exit within one select() or UART read timeout
+    TaskHandle_t networkTask = m_networkTaskHandle;
+    TaskHandle_t uartTask = m_uartTaskHandle;
+    unregisterTask(networkTask);
+    unregisterTask(uartTask);
+    m_tasksRunning = false;
+    for (int attempt = 0; attempt < 30 && (m_networkTaskHandle || m_uartTaskHandle); attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
     if (m_networkTaskHandle) {
-        m_tasksRunning = false;
-        vTaskDelete(m_networkTaskHandle);
+        log(ESP_LOG_WARN, "Network task did not exit, deleting");
+        vTaskDelete(networkTask);
         m_networkTaskHandle = nullptr;
     }
-
     if (m_uartTaskHandle) {
-        m_tasksRunning = false;
-        vTaskDelete(m_uartTaskHandle);
+        log(ESP_LOG_WARN, "UART task did not exit, deleting");
+        vTaskDelete(uartTask);
         m_uartTaskHandle = nullptr;
     }
 
-    // Close all sessions
-    for (auto& session : m_sessions) {
-        if (session && session->isActive) {
-            closeSession(session->id);
-        }
+    // Close all sessions; with the network task gone their sockets close here
+    while (!m_sessions.empty()) {
+        closeSession(m_sessions.back()->id);
     }
-    m_sessions.clear();
+    for (auto& session : m_closingSessions) {
+        releaseSessionIo(session.get());
+    }
+    m_closingSessions.clear();
 
     // Deinitialize UART
     uart_driver_delete(UART_PORT);
 
     // Free buffers
     if (m_rxBuffer) {
-        heap_caps_free(m_rxBuffer);
+        OS_FREE(m_rxBuffer);
         m_rxBuffer = nullptr;
     }
     if (m_txBuffer) {
-        heap_caps_free(m_txBuffer);
+        OS_FREE(m_txBuffer);
         m_txBuffer = nullptr;
     }
+    m_terminal.shutdown();
 
     m_initialized = false;
     log(ESP_LOG_INFO, "Enhanced Terminal application shutdown complete");
@@ -192,7 +236,6 @@ os_error_t EnhancedTerminalApp::destroyUI() {
         // All child objects will be automatically deleted
         m_terminalContainer = nullptr;
         m_sessionTabs = nullptr;
-        m_terminalTextArea = nullptr;
         m_inputTextArea = nullptr;
         m_controlPanel = nullptr;
         m_connectButton = nullptr;
@@ -200,6 +243,7 @@ os_error_t EnhancedTerminalApp::destroyUI() {
         m_sendButton = nullptr;
         m_clearButton = nullptr;
         m_settingsButton = nullptr;
+        m_captureButton = nullptr;
         m_statusLabel = nullptr;
         m_modeDropdown = nullptr;
         m_connectionDialog = nullptr;
@@ -230,8 +274,19 @@ std::string EnhancedTerminalApp::createSession(TerminalMode mode, const Connecti
     session->bytesTransmitted = 0;
     session->isActive = true;
 
+    // Network hosts run full-screen programs; give them a VT100 screen
+    if (mode == TerminalMode::TELNET || mode == TerminalMode::SSH) {
+        session->screen = std::make_unique<VtScreen>();
+        if (session->screen->initialize() != OS_OK) {
+            log(ESP_LOG_WARN, "No memory for terminal emulation, using scrollback");
+            session->screen.reset();
+        }
+    }
+
     std::string sessionId = session->id;
+    lockSessions();
     m_sessions.push_back(std::move(session));
+    unlockSessions();
 
     // Set as current session if it's the first one
     if (m_currentSessionId.empty()) {
@@ -245,6 +300,7 @@ std::string EnhancedTerminalApp::createSession(TerminalMode mode, const Connecti
         sessionId.c_str());
 
     updateSessionTabs();
+    updateOutputView();
     return sessionId;
 }
 
@@ -258,17 +314,25 @@ os_error_t EnhancedTerminalApp::closeSession(const std::string& sessionId) {
         return OS_ERROR_NOT_FOUND;
     }
 
-    auto& session = *it;
-    
-    // Close socket if it's a network session
-    if (session->socket >= 0) {
-        close(session->socket);
-        session->socket = -1;
+    if ((*it)->screen && m_vtView.getScreen() == (*it)->screen.get()) {
+        m_vtView.bind(nullptr);
     }
 
+    lockSessions();
+    std::unique_ptr<TerminalSession> session = std::move(*it);
+    m_sessions.erase(it);
+
     session->isActive = false;
     session->state = ConnectionState::DISCONNECTED;
 
+    // A watched socket may be inside select(); the network task closes it
+    if (session->ringStorage && m_networkTaskHandle) {
+        m_closingSessions.push_back(std::move(session));
+    } else {
+        releaseSessionIo(session.get());
+    }
+    unlockSessions();
+
     // Switch to another session if this was current
     if (m_currentSessionId == sessionId) {
         m_currentSessionId.clear();
@@ -280,12 +344,11 @@ os_error_t EnhancedTerminalApp::closeSession(const std::string& sessionId) {
         }
     }
 
-    // Remove from sessions list
-    m_sessions.erase(it);
     m_totalDisconnections++;
 
     log(ESP_LOG_INFO, "Closed session: %s", sessionId.c_str());
     updateSessionTabs();
+    updateOutputView();
 
     return OS_OK;
 }
@@ -302,6 +365,7 @@ os_error_t EnhancedTerminalApp::switchToSession(const std::string& sessionId) {
 
     m_currentSessionId = sessionId;
     updateSessionTabs();
+    updateOutputView();
 
     log(ESP_LOG_INFO, "Switched to session: %s", sessionId.c_str());
     return OS_OK;
@@ -334,9 +398,9 @@ os_error_t EnhancedTerminalApp::sendData(const uint8_t* data, size_t length) {
             
         case TerminalMode::TELNET:
         case TerminalMode::SSH:
-            // Send via socket
-            if (session->socket >= 0 && session->state == ConnectionState::CONNECTED) {
-                bytesSent = send(session->socket, data, length, 0);
+            // Queued for the network task, which sends when the socket is writable
+            if (session->ringStorage && session->state == ConnectionState::CONNECTED) {
+                bytesSent = session->txRing.write(data, length);
             }
             break;
             
@@ -352,7 +416,9 @@ os_error_t EnhancedTerminalApp::sendData(const uint8_t* data, size_t length) {
         m_totalBytesTransmitted += bytesSent;
         
         // Add to terminal display
-        if (session->mode != TerminalMode::LOCAL) {
+        if (session->mode == TerminalMode::RS485 && m_capture.isActive()) {
+            m_capture.record(true, data, bytesSent);
+        } else if (session->mode != TerminalMode::LOCAL) {
             char displayText[512];
             formatDataForDisplay(data, bytesSent, displayText, sizeof(displayText));
             addToTerminal(displayText, session->id, true);
@@ -398,20 +464,21 @@ std::string EnhancedTerminalApp::connectTelnet(const std::string& hostname, uint
         return "";
     }
 
-    // Create socket
+    // Create socket; non-blocking, the network task finishes the connect
     session->socket = socket(AF_INET, SOCK_STREAM, 0);
     if (session->socket < 0) {
         log(ESP_LOG_ERROR, "Failed to create socket for Telnet connection");
         closeSession(sessionId);
         return "";
     }
+    fcntl(session->socket, F_SETFL, fcntl(session->socket, F_GETFL, 0) | O_NONBLOCK);
 
-    // Set socket timeout
-    struct timeval tv;
-    tv.tv_sec = timeout / 1000;
-    tv.tv_usec = (timeout % 1000) * 1000;
-    setsockopt(session->socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(session->socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    uint8_t* rings = (uint8_t*)OS_MALLOC_PSRAM(NET_RX_RING_SIZE + NET_TX_RING_SIZE);
+    if (!rings) {
+        log(ESP_LOG_ERROR, "Failed to allocate buffers for Telnet connection");
+        closeSession(sessionId);
+        return "";
+    }
 
     // Resolve hostname
     struct hostent* host = gethostbyname(hostname.c_str());
@@ -428,21 +495,24 @@ std::string EnhancedTerminalApp::connectTelnet(const std::string& hostname, uint
     serverAddr.sin_port = htons(port);
     memcpy(&serverAddr.sin_addr.s_addr, host->h_addr, host->h_length);
 
-    session->state = ConnectionState::CONNECTING;
-    session->connectTime = millis();
-
-    if (connect(session->socket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+    if (connect(session->socket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0 &&
+        errno != EINPROGRESS) {
+        OS_FREE(rings);
         log(ESP_LOG_ERROR, "Failed to connect to %s:%d", hostname.c_str(), port);
         closeSession(sessionId);
         return "";
     }
 
-    session->state = ConnectionState::CONNECTED;
-    m_totalConnections++;
-
-    log(ESP_LOG_INFO, "Connected to Telnet server %s:%d", hostname.c_str(), port);
-    addToTerminal("Connected to Telnet server\n", sessionId);
+    // Hand the socket to the network task
+    lockSessions();
+    session->ringStorage = rings;
+    session->rxRing.init(rings, NET_RX_RING_SIZE);
+    session->txRing.init(rings + NET_RX_RING_SIZE, NET_TX_RING_SIZE);
+    session->connectTime = millis();
+    session->state = ConnectionState::CONNECTING;
+    unlockSessions();
 
+    log(ESP_LOG_INFO, "Connecting to Telnet server %s:%d", hostname.c_str(), port);
     return sessionId;
 }
 
@@ -471,15 +541,18 @@ std::string EnhancedTerminalApp::connectSSH(const std::string& hostname, uint16_
     // Real SSH would require cryptographic libraries and protocol implementation
 
     log(ESP_LOG_INFO, "SSH connection created (simplified implementation)");
-    addToTerminal("SSH connection established (simplified)\n", sessionId);
+    const TerminalSession* session = getSession(sessionId);
+    if (session && session->screen) {
+        session->screen->write("SSH connection established (simplified)\r\n");
+    } else {
+        addToTerminal("SSH connection established (simplified)\n", sessionId);
+    }
 
     return sessionId;
 }
 
 void EnhancedTerminalApp::clearTerminal() {
-    if (m_terminalTextArea) {
-        lv_textarea_set_text(m_terminalTextArea, "");
-    }
+    m_terminal.clear();
 }
 
 std::vector<std::string> EnhancedTerminalApp::getActiveSessions() const {
@@ -505,6 +578,10 @@ void EnhancedTerminalApp::setDisplayOptions(bool hexDisplay, bool showTimestamp,
     m_hexDisplay = hexDisplay;
     m_showTimestamp = showTimestamp;
     m_autoScroll = autoScroll;
+    m_terminal.setAutoScroll(autoScroll);
+
+    // Hex display shows network sessions raw in the scrollback
+    updateOutputView();
 }
 
 os_error_t EnhancedTerminalApp::initializeRS485() {
@@ -527,6 +604,7 @@ os_error_t EnhancedTerminalApp::initializeRS485() {
     // Start UART task
     m_tasksRunning = true;
     xTaskCreate(uartTask, "uart_task", UART_TASK_STACK_SIZE, this, UART_TASK_PRIORITY, &m_uartTaskHandle);
+    registerTask(m_uartTaskHandle);
 
     return OS_OK;
 }
@@ -545,6 +623,7 @@ os_error_t EnhancedTerminalApp::initializeNetwork() {
         m_tasksRunning = true;
         xTaskCreate(networkTask, "network_task", NETWORK_TASK_STACK_SIZE, this, 
                    NETWORK_TASK_PRIORITY, &m_networkTaskHandle);
+        registerTask(m_networkTaskHandle);
     } else {
         log(ESP_LOG_WARN, "WiFi not connected, network features disabled");
         m_networkInitialized = false;
@@ -562,14 +641,19 @@ void EnhancedTerminalApp::createTerminalUI() {
     // Create session tabs
     createSessionTabs();
 
-    // Create terminal text area
-    m_terminalTextArea = lv_textarea_create(m_uiContainer);
-    lv_obj_set_size(m_terminalTextArea, LV_HOR_RES - 40, LV_VER_RES - 200);
-    lv_obj_align(m_terminalTextArea, LV_ALIGN_TOP_MID, 0, 60);
-    lv_textarea_set_text(m_terminalTextArea, "Enhanced Terminal Ready\n");
-    lv_obj_set_style_bg_color(m_terminalTextArea, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_text_color(m_terminalTextArea, lv_color_hex(0x00FF00), 0);
-    lv_obj_set_style_text_font(m_terminalTextArea, &lv_font_montserrat_12, 0);
+    // Terminal output; shows the scrollback kept while the UI was closed
+    lv_obj_t* output = m_terminal.create(m_uiContainer, LV_HOR_RES - 40, LV_VER_RES - 200,
+                                         &lv_font_montserrat_12, lv_color_hex(0x00FF00));
+    if (output) {
+        lv_obj_align(output, LV_ALIGN_TOP_MID, 0, 60);
+    }
+
+    // Network sessions use an emulated screen in the same place
+    lv_obj_t* screenView = m_vtView.create(m_uiContainer, LV_HOR_RES - 40, LV_VER_RES - 200,
+                                           &lv_font_unscii_16, lv_color_hex(0x00FF00));
+    if (screenView) {
+        lv_obj_align(screenView, LV_ALIGN_TOP_MID, 0, 60);
+    }
 
     // Create input text area
     m_inputTextArea = lv_textarea_create(m_uiContainer);
@@ -618,6 +702,14 @@ void EnhancedTerminalApp::createTerminalUI() {
     lv_obj_center(clearLabel);
     lv_obj_add_event_cb(m_clearButton, clearButtonCallback, LV_EVENT_CLICKED, this);
 
+    m_captureButton = lv_btn_create(m_controlPanel);
+    lv_obj_set_size(m_captureButton, 70, 30);
+    lv_obj_align(m_captureButton, LV_ALIGN_LEFT_MID, 350, 0);
+    lv_obj_t* captureLabel = lv_label_create(m_captureButton);
+    lv_label_set_text(captureLabel, m_capture.isActive() ? "Stop" : "Capture");
+    lv_obj_center(captureLabel);
+    lv_obj_add_event_cb(m_captureButton, captureButtonCallback, LV_EVENT_CLICKED, this);
+
     m_settingsButton = lv_btn_create(m_controlPanel);
     lv_obj_set_size(m_settingsButton, 70, 30);
     lv_obj_align(m_settingsButton, LV_ALIGN_RIGHT_MID, -10, 0);
@@ -631,6 +723,8 @@ void EnhancedTerminalApp::createTerminalUI() {
     lv_obj_align(m_statusLabel, LV_ALIGN_BOTTOM_LEFT, 20, -10);
     lv_obj_set_style_text_color(m_statusLabel, lv_color_white(), 0);
     lv_label_set_text(m_statusLabel, "Ready");
+
+    updateOutputView();
 }
 
 void EnhancedTerminalApp::createSessionTabs() {
@@ -674,43 +768,74 @@ void EnhancedTerminalApp::updateSessionTabs() {
     }
 }
 
+void EnhancedTerminalApp::updateOutputView() {
+    const TerminalSession* session = getSession(m_currentSessionId);
+    VtScreen* screen = (session && !m_hexDisplay) ? session->screen.get() : nullptr;
+    if (screen != m_vtView.getScreen()) {
+        m_vtView.bind(screen);
+    }
+
+    lv_obj_t* emulated = m_vtView.getObject();
+    lv_obj_t* scrollback = m_terminal.getObject();
+    if (emulated) {
+        if (screen) {
+            lv_obj_clear_flag(emulated, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(emulated, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+    if (scrollback) {
+        if (screen) {
+            lv_obj_add_flag(scrollback, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_clear_flag(scrollback, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
 void EnhancedTerminalApp::processReceivedData() {
-    // Process data for each active session
+    // Sockets are serviced by the network task; only decoded output is left
     for (auto& session : m_sessions) {
-        if (!session || !session->isActive) {
+        if (!session || !session->ringStorage) {
             continue;
         }
 
-        if (session->mode == TerminalMode::RS485) {
-            // UART data is processed in UART task
-            continue;
+        // Every session's screen is kept current, shown or not
+        VtScreen* screen = m_hexDisplay ? nullptr : session->screen.get();
+
+        const char* notice = session->notice.exchange(nullptr);
+        if (notice && screen) {
+            screen->write(notice);
+            screen->write("\r");
+        } else if (notice) {
+            addToTerminal(notice, session->id);
         }
 
-        if (session->mode == TerminalMode::TELNET || session->mode == TerminalMode::SSH) {
-            if (session->socket >= 0 && session->state == ConnectionState::CONNECTED) {
-                uint8_t buffer[1024];
-                int bytesReceived = recv(session->socket, buffer, sizeof(buffer), MSG_DONTWAIT);
-                
-                if (bytesReceived > 0) {
-                    session->bytesReceived += bytesReceived;
-                    m_totalBytesReceived += bytesReceived;
-                    
-                    if (session->mode == TerminalMode::TELNET) {
-                        processTelnetData(session.get(), buffer, bytesReceived);
-                    } else {
-                        processSSHData(session.get(), buffer, bytesReceived);
-                    }
-                } else if (bytesReceived == 0) {
-                    // Connection closed
-                    session->state = ConnectionState::DISCONNECTED;
-                    addToTerminal("Connection closed by remote host\n", session->id);
-                } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                    // Error occurred
-                    session->state = ConnectionState::ERROR;
-                    addToTerminal("Connection error occurred\n", session->id);
-                }
+        uint8_t chunk[256];
+        size_t budget = NET_DRAIN_BUDGET;
+        while (budget > 0) {
+            size_t bytesRead = session->rxRing.read(chunk, std::min(budget, sizeof(chunk) - 1));
+            if (bytesRead == 0) {
+                break;
+            }
+            budget -= bytesRead;
+
+            if (screen) {
+                screen->write(chunk, bytesRead);
+            } else if (session->mode == TerminalMode::SSH) {
+                char displayText[1024];
+                formatDataForDisplay(chunk, bytesRead, displayText, sizeof(displayText));
+                addToTerminal(displayText, session->id, false);
+            } else {
+                chunk[bytesRead] = '\0';
+                addToTerminal(reinterpret_cast<const char*>(chunk), session->id, false);
             }
         }
+
+        // Keep the main loop awake until a flood has been drained
+        if (session->rxRing.available() > 0) {
+            OS().wake();
+        }
     }
 }
 
@@ -719,12 +844,11 @@ void EnhancedTerminalApp::processTelnetData(TerminalSession* session, const uint
         return;
     }
 
-    // Simple Telnet processing - handle IAC commands
-    std::string processedData;
+    // Simple Telnet processing - drop negotiation, pass the runs between
+    size_t runStart = 0;
     for (size_t i = 0; i < length; i++) {
         if (data[i] == TELNET_IAC && i + 2 < length) {
             uint8_t command = data[i + 1];
-            uint8_t option = data[i + 2];
             
             // Handle Telnet commands (simplified)
             switch (command) {
@@ -733,20 +857,18 @@ void EnhancedTerminalApp::processTelnetData(TerminalSession* session, const uint
                 case TELNET_DO:
                 case TELNET_DONT:
                     // Skip these for now
+                    session->rxRing.write(data + runStart, i - runStart);
                     i += 2;
+                    runStart = i + 1;
                     break;
                 default:
-                    processedData += (char)data[i];
                     break;
             }
-        } else {
-            processedData += (char)data[i];
         }
     }
 
-    if (!processedData.empty()) {
-        addToTerminal(processedData.c_str(), session->id, false);
-    }
+    // recv() was sized to the free space, so this never drops
+    session->rxRing.write(data + runStart, length - runStart);
 }
 
 void EnhancedTerminalApp::processSSHData(TerminalSession* session, const uint8_t* data, size_t length) {
@@ -754,14 +876,148 @@ void EnhancedTerminalApp::processSSHData(TerminalSession* session, const uint8_t
         return;
     }
 
-    // Simplified SSH processing - just display received data
-    char displayText[1024];
-    formatDataForDisplay(data, length, displayText, sizeof(displayText));
-    addToTerminal(displayText, session->id, false);
+    // Simplified SSH processing - formatted for display by the UI thread
+    session->rxRing.write(data, length);
+}
+
+int EnhancedTerminalApp::watchSession(TerminalSession* session, fd_set& readSet,
+                                      fd_set& writeSet, fd_set& errorSet) {
+    if (!session || session->socket < 0 || !session->ringStorage) {
+        return -1;
+    }
+
+    int fd = session->socket;
+    if (session->state == ConnectionState::CONNECTING) {
+        // Connect completion shows up as writable
+        FD_SET(fd, &writeSet);
+        FD_SET(fd, &errorSet);
+        return fd;
+    }
+
+    if (session->state != ConnectionState::CONNECTED) {
+        return -1;
+    }
+
+    // A full RX ring stops reading, so TCP flow control holds the peer back
+    if (session->rxRing.space() > 0) {
+        FD_SET(fd, &readSet);
+    }
+    if (session->txRing.available() > 0) {
+        FD_SET(fd, &writeSet);
+    }
+    FD_SET(fd, &errorSet);
+    return fd;
+}
+
+void EnhancedTerminalApp::serviceSession(TerminalSession* session, const fd_set& readSet,
+                                         const fd_set& writeSet, const fd_set& errorSet) {
+    if (!session || session->socket < 0 || !session->ringStorage) {
+        return;
+    }
+
+    int fd = session->socket;
+    auto fail = [session](const char* notice) {
+        session->notice.store(notice);
+        session->state = ConnectionState::ERROR;
+        OS().wake();
+    };
+
+    if (session->state == ConnectionState::CONNECTING) {
+        if (FD_ISSET(fd, &writeSet) || FD_ISSET(fd, &errorSet)) {
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+            if (error == 0) {
+                session->state = ConnectionState::CONNECTED;
+                m_totalConnections++;
+                log(ESP_LOG_INFO, "Connected to %s:%d", session->config.hostname.c_str(), session->config.port);
+                session->notice.store("Connected to Telnet server\n");
+                OS().wake();
+            } else {
+                log(ESP_LOG_ERROR, "Failed to connect to %s:%d (%d)",
+                    session->config.hostname.c_str(), session->config.port, error);
+                fail("Connection failed\n");
+            }
+        } else if (millis() - session->connectTime > session->config.timeout) {
+            log(ESP_LOG_WARN, "Connection timeout for session %s", session->id.c_str());
+            fail("Connection timed out\n");
+        }
+        return;
+    }
+
+    if (session->state != ConnectionState::CONNECTED) {
+        return;
+    }
+
+    if (FD_ISSET(fd, &readSet)) {
+        size_t room = std::min(m_rxBufferSize, session->rxRing.space());
+        int bytesReceived = recv(fd, m_rxBuffer, room, MSG_DONTWAIT);
+
+        if (bytesReceived > 0) {
+            session->bytesReceived += bytesReceived;
+            m_totalBytesReceived += bytesReceived;
+
+            if (session->mode == TerminalMode::TELNET) {
+                processTelnetData(session, m_rxBuffer, bytesReceived);
+            } else {
+                processSSHData(session, m_rxBuffer, bytesReceived);
+            }
+            OS().wake();
+        } else if (bytesReceived == 0) {
+            // Connection closed
+            session->notice.store("Connection closed by remote host\n");
+            session->state = ConnectionState::DISCONNECTED;
+            OS().wake();
+            return;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            fail("Connection error occurred\n");
+            return;
+        }
+    }
+
+    if (FD_ISSET(fd, &writeSet)) {
+        uint8_t chunk[512];
+        size_t pending = session->txRing.peek(chunk, sizeof(chunk));
+        int bytesSent = send(fd, chunk, pending, MSG_DONTWAIT);
+        if (bytesSent > 0) {
+            session->txRing.consume(bytesSent);
+        } else if (bytesSent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            fail("Connection error occurred\n");
+        }
+    } else if (FD_ISSET(fd, &errorSet)) {
+        fail("Connection error occurred\n");
+    }
+}
+
+void EnhancedTerminalApp::releaseSessionIo(TerminalSession* session) {
+    if (!session) {
+        return;
+    }
+
+    if (session->socket >= 0) {
+        close(session->socket);
+        session->socket = -1;
+    }
+    if (session->ringStorage) {
+        OS_FREE(session->ringStorage);
+        session->ringStorage = nullptr;
+    }
+}
+
+void EnhancedTerminalApp::lockSessions() {
+    if (m_sessionMutex) {
+        xSemaphoreTake(m_sessionMutex, portMAX_DELAY);
+    }
+}
+
+void EnhancedTerminalApp::unlockSessions() {
+    if (m_sessionMutex) {
+        xSemaphoreGive(m_sessionMutex);
+    }
 }
 
 void EnhancedTerminalApp::addToTerminal(const char* text, const std::string& sessionId, bool isTransmitted) {
-    if (!m_terminalTextArea || !text) {
+    if (!text) {
         return;
     }
 
@@ -773,12 +1029,10 @@ void EnhancedTerminalApp::addToTerminal(const char* text, const std::string& ses
     std::string formattedText;
     
     if (m_showTimestamp) {
-        struct timeval tv;
-        gettimeofday(&tv, nullptr);
-        struct tm* timeinfo = localtime(&tv.tv_sec);
-        char timestamp[32];
-        strftime(timestamp, sizeof(timestamp), "[%H:%M:%S] ", timeinfo);
-        formattedText += timestamp;
+        // One cache per task; the UART task and the UI thread both add lines
+        static thread_local TimestampPrefix s_timestamp(false);
+        char timestamp[TimestampPrefix::MAX_CHARS + 1];
+        formattedText.append(timestamp, s_timestamp.format(timestamp));
     }
 
     if (isTransmitted) {
@@ -792,12 +1046,8 @@ void EnhancedTerminalApp::addToTerminal(const char* text, const std::string& ses
         formattedText += '\n';
     }
 
-    // Add to terminal
-    lv_textarea_add_text(m_terminalTextArea, formattedText.c_str());
-
-    if (m_autoScroll) {
-        lv_textarea_set_cursor_pos(m_terminalTextArea, LV_TEXTAREA_CURSOR_LAST);
-    }
+    // Stored in the scrollback; drawn by the next refresh()
+    m_terminal.appendText(formattedText.data(), formattedText.size());
 }
 
 void EnhancedTerminalApp::formatDataForDisplay(const uint8_t* data, size_t length, 
@@ -807,15 +1057,7 @@ void EnhancedTerminalApp::formatDataForDisplay(const uint8_t* data, size_t lengt
     }
 
     if (m_hexDisplay) {
-        // Hex display
-        size_t pos = 0;
-        for (size_t i = 0; i < length && pos < bufferSize - 3; i++) {
-            snprintf(buffer + pos, bufferSize - pos, "%02X ", data[i]);
-            pos += 3;
-        }
-        if (pos < bufferSize) {
-            buffer[pos] = '\0';
-        }
+        HexFormat::hex(data, length, buffer, bufferSize);
     } else {
         // ASCII display
         size_t copyLen = std::min(length, bufferSize - 1);
@@ -824,6 +1066,29 @@ void EnhancedTerminalApp::formatDataForDisplay(const uint8_t* data, size_t lengt
     }
 }
 
+os_error_t EnhancedTerminalApp::startCapture(const char* path) {
+    os_error_t result = m_capture.start(path, "term485", m_rs485Config.baudRate);
+    if (m_statusLabel) {
+        lv_label_set_text(m_statusLabel, result == OS_OK ? m_capture.getPath() : "Capture failed to start");
+    }
+    m_captureShownMs = millis();
+    return result;
+}
+
+os_error_t EnhancedTerminalApp::stopCapture() {
+    if (!m_capture.isActive()) {
+        return OS_OK;
+    }
+
+    os_error_t result = m_capture.stop();
+    if (m_statusLabel) {
+        char summary[160];
+        m_capture.formatSummary(summary, sizeof(summary));
+        lv_label_set_text(m_statusLabel, summary);
+    }
+    return result;
+}
+
 std::string EnhancedTerminalApp::generateSessionId() {
     return "session_" + std::to_string(m_nextSessionId++);
 }
@@ -832,10 +1097,55 @@ void EnhancedTerminalApp::networkTask(void* parameter) {
     EnhancedTerminalApp* app = static_cast<EnhancedTerminalApp*>(parameter);
     
     while (app->m_tasksRunning) {
-        // Network processing would go here
-        vTaskDelay(pdMS_TO_TICKS(100));
+        fd_set readSet;
+        fd_set writeSet;
+        fd_set errorSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&errorSet);
+        int maxFd = -1;
+
+        app->lockSessions();
+        // Closed sessions' sockets are only closed here, never under select()
+        for (auto& session : app->m_closingSessions) {
+            releaseSessionIo(session.get());
+        }
+        app->m_closingSessions.clear();
+        for (auto& session : app->m_sessions) {
+            maxFd = std::max(maxFd, app->watchSession(session.get(), readSet, writeSet, errorSet));
+        }
+        app->unlockSessions();
+
+        if (maxFd < 0) {
+            vTaskDelay(pdMS_TO_TICKS(NET_IDLE_MS));
+            continue;
+        }
+
+        // One wait for every session; the timeout picks up new TX data
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = NET_SELECT_TIMEOUT_MS * 1000;
+        int ready = select(maxFd + 1, &readSet, &writeSet, &errorSet, &tv);
+        if (ready < 0) {
+            vTaskDelay(pdMS_TO_TICKS(NET_SELECT_TIMEOUT_MS));
+            continue;
+        }
+        if (ready == 0) {
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
+            FD_ZERO(&errorSet);
+        }
+
+        // Runs on timeouts too, so pending connects expire on time
+        OS_TRACE_SCOPE_ARG("net_service", ready);
+        app->lockSessions();
+        for (auto& session : app->m_sessions) {
+            app->serviceSession(session.get(), readSet, writeSet, errorSet);
+        }
+        app->unlockSessions();
     }
-    
+
+    app->m_networkTaskHandle = nullptr;
     vTaskDelete(nullptr);
 }
 
@@ -846,21 +1156,32 @@ void EnhancedTerminalApp::uartTask(void* parameter) {
     while (app->m_tasksRunning) {
         int bytesRead = uart_read_bytes(UART_PORT, buffer, sizeof(buffer), 100 / portTICK_PERIOD_MS);
         if (bytesRead > 0) {
+            OS_TRACE_SCOPE_ARG("uart_rx", bytesRead);
+
             // Find RS485 session
+            app->lockSessions();
             for (auto& session : app->m_sessions) {
                 if (session && session->mode == TerminalMode::RS485 && session->isActive) {
                     session->bytesReceived += bytesRead;
                     app->m_totalBytesReceived += bytesRead;
-                    
+
+                    // Capture bypasses formatting and the display
+                    if (app->m_capture.isActive()) {
+                        app->m_capture.record(false, buffer, bytesRead);
+                        break;
+                    }
+
                     char displayText[512];
                     app->formatDataForDisplay(buffer, bytesRead, displayText, sizeof(displayText));
                     app->addToTerminal(displayText, session->id, false);
                     break;
                 }
             }
+            app->unlockSessions();
         }
     }
-    
+
+    app->m_uartTaskHandle = nullptr;
     vTaskDelete(nullptr);
 }
 
@@ -892,6 +1213,22 @@ void EnhancedTerminalApp::sendButtonCallback(lv_event_t* e) {
     }
 }
 
+void EnhancedTerminalApp::captureButtonCallback(lv_event_t* e) {
+    EnhancedTerminalApp* app = static_cast<EnhancedTerminalApp*>(lv_event_get_user_data(e));
+    if (app && app->m_captureButton) {
+        if (app->m_capture.isActive()) {
+            app->stopCapture();
+        } else {
+            app->startCapture();
+        }
+
+        lv_obj_t* label = lv_obj_get_child(app->m_captureButton, 0);
+        if (label) {
+            lv_label_set_text(label, app->m_capture.isActive() ? "Stop" : "Capture");
+        }
+    }
+}
+
 void EnhancedTerminalApp::clearButtonCallback(lv_event_t* e) {
     EnhancedTerminalApp* app = static_cast<EnhancedTerminalApp*>(lv_event_get_user_data(e));
     if (app) {
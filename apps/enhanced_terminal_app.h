@@ -3,8 +3,15 @@
 
 #include "base_app.h"
 #include "../hal/hardware_config.h"
+#include "../system/byte_ring.h"
+#include "../system/hex_format.h"
+#include "../system/serial_capture.h"
+#include "../ui/terminal_view.h"
+#include "../ui/vt_view.h"
 #include <driver/uart.h>
+#include <freertos/semphr.h>
 #include <lwip/sockets.h>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
@@ -14,6 +21,20 @@
  * @brief Enhanced Terminal Application with Telnet and SSH support
  * 
  * Provides RS-485, Telnet, and SSH connectivity with advanced terminal features.
+ * Output goes into a bounded PSRAM scrollback rendered by TerminalView, so
+ * the UART and network tasks can append without touching LVGL.
+ * RS-485 sessions can instead be captured headless to a SerialCapture log,
+ * with only the counters shown in the status line.
+ *
+ * Telnet and SSH sockets belong to one network task that select()s across
+ * every session: it completes non-blocking connects, decodes received data
+ * into each session's RX ring and sends from its TX ring. The UI thread
+ * only queues input and drains decoded output, so idle sessions cost no
+ * syscalls per frame.
+ *
+ * Each network session parses host output into its own VtScreen cell
+ * grid, and one VtView shows the current one, re-rendering only the rows
+ * that changed. RS-485 and local sessions stay on the scrollback.
  */
 
 enum class TerminalMode {
@@ -50,8 +71,14 @@ struct TerminalSession {
     uint32_t connectTime;
     uint32_t bytesReceived;
     uint32_t bytesTransmitted;
-    std::string buffer;
+    std::unique_ptr<VtScreen> screen;           // Network sessions: emulated screen
     bool isActive;
+
+    // Socket I/O; the network task is the RX producer and the TX consumer
+    uint8_t* ringStorage = nullptr;
+    ByteRing rxRing;                            // Decoded output for the UI thread
+    ByteRing txRing;                            // Input waiting to be sent
+    std::atomic<const char*> notice{nullptr};   // Status line for the UI thread
 };
 
 class EnhancedTerminalApp : public BaseApp {
@@ -152,6 +179,25 @@ public:
      */
     void setDisplayOptions(bool hexDisplay, bool showTimestamp, bool autoScroll);
 
+    /**
+     * @brief Log RS-485 session traffic to storage instead of the terminal
+     * @param path Log path; nullptr for a new file in OS_CAPTURE_DIR
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t startCapture(const char* path = nullptr);
+
+    /**
+     * @brief Close the capture log and resume the terminal display
+     * @return OS_OK on success, error code if the log is incomplete
+     */
+    os_error_t stopCapture();
+
+    /**
+     * @brief Check if RS-485 traffic is being captured
+     * @return true while capturing
+     */
+    bool isCapturing() const { return m_capture.isActive(); }
+
 private:
     /**
      * @brief Initialize RS-485 hardware
@@ -186,12 +232,17 @@ private:
     void updateSessionTabs();
 
     /**
-     * @brief Process received data for all sessions
+     * @brief Show the emulated screen or the scrollback for the current session
+     */
+    void updateOutputView();
+
+    /**
+     * @brief Drain decoded output and status lines of all sessions (UI thread)
      */
     void processReceivedData();
 
     /**
-     * @brief Process Telnet protocol
+     * @brief Decode Telnet protocol into the session's RX ring (network task)
      * @param session Session to process
      * @param data Received data
      * @param length Data length
@@ -199,13 +250,42 @@ private:
     void processTelnetData(TerminalSession* session, const uint8_t* data, size_t length);
 
     /**
-     * @brief Process SSH protocol
+     * @brief Pass SSH data into the session's RX ring (network task)
      * @param session Session to process
      * @param data Received data
      * @param length Data length
      */
     void processSSHData(TerminalSession* session, const uint8_t* data, size_t length);
 
+    /**
+     * @brief Add a session socket to the select() sets (network task)
+     * @param session Session to watch
+     * @param readSet Sockets to read
+     * @param writeSet Sockets to write or finish connecting
+     * @param errorSet Sockets to check for errors
+     * @return Socket added, or -1 if the session has nothing to wait for
+     */
+    int watchSession(TerminalSession* session, fd_set& readSet, fd_set& writeSet, fd_set& errorSet);
+
+    /**
+     * @brief Connect, receive and send for one session after select() (network task)
+     * @param session Session to service
+     * @param readSet Readable sockets
+     * @param writeSet Writable sockets
+     * @param errorSet Sockets with errors
+     */
+    void serviceSession(TerminalSession* session, const fd_set& readSet,
+                        const fd_set& writeSet, const fd_set& errorSet);
+
+    /**
+     * @brief Close a session's socket and free its rings
+     * @param session Session no longer watched by the network task
+     */
+    static void releaseSessionIo(TerminalSession* session);
+
+    void lockSessions();
+    void unlockSessions();
+
     /**
      * @brief Add text to terminal display
      * @param text Text to add
@@ -250,9 +330,12 @@ private:
     static void settingsButtonCallback(lv_event_t* e);
     static void sessionTabCallback(lv_event_t* e);
     static void modeDropdownCallback(lv_event_t* e);
+    static void captureButtonCallback(lv_event_t* e);
 
-    // Terminal sessions
+    // Terminal sessions (changes to the list are made under m_sessionMutex)
     std::vector<std::unique_ptr<TerminalSession>> m_sessions;
+    std::vector<std::unique_ptr<TerminalSession>> m_closingSessions;  // Closed by the network task
+    SemaphoreHandle_t m_sessionMutex = nullptr;
     std::string m_currentSessionId;
     uint32_t m_nextSessionId = 1;
 
@@ -263,7 +346,6 @@ private:
     // UI elements
     lv_obj_t* m_terminalContainer = nullptr;
     lv_obj_t* m_sessionTabs = nullptr;
-    lv_obj_t* m_terminalTextArea = nullptr;
     lv_obj_t* m_inputTextArea = nullptr;
     lv_obj_t* m_controlPanel = nullptr;
     lv_obj_t* m_connectButton = nullptr;
@@ -271,6 +353,7 @@ private:
     lv_obj_t* m_sendButton = nullptr;
     lv_obj_t* m_clearButton = nullptr;
     lv_obj_t* m_settingsButton = nullptr;
+    lv_obj_t* m_captureButton = nullptr;
     lv_obj_t* m_statusLabel = nullptr;
     lv_obj_t* m_modeDropdown = nullptr;
 
@@ -283,16 +366,26 @@ private:
     lv_obj_t* m_connectDialogButton = nullptr;
     lv_obj_t* m_cancelDialogButton = nullptr;
 
-    // Communication buffers
+    // Communication buffers (m_rxBuffer is the network task's recv scratch)
     uint8_t* m_rxBuffer = nullptr;
     uint8_t* m_txBuffer = nullptr;
     size_t m_rxBufferSize = 0;
     size_t m_txBufferSize = 0;
 
+    // Scrollback and its virtualized view
+    TerminalView m_terminal;
+
+    // Emulated screen of the current network session
+    VtView m_vtView;
+
+    // Headless RS-485 capture (records from the UART task)
+    SerialCapture m_capture;
+    uint32_t m_captureShownMs = 0;
+
     // Task management
     TaskHandle_t m_networkTaskHandle = nullptr;
     TaskHandle_t m_uartTaskHandle = nullptr;
-    bool m_tasksRunning = false;
+    volatile bool m_tasksRunning = false;
 
     // Display settings
     bool m_hexDisplay = false;
@@ -319,14 +412,19 @@ private:
     static constexpr uart_port_t UART_PORT = UART_NUM_2;
     static constexpr size_t RX_BUFFER_SIZE = 4096;
     static constexpr size_t TX_BUFFER_SIZE = 2048;
-    static constexpr size_t TERMINAL_BUFFER_SIZE = 16384;
     static constexpr uint32_t NETWORK_TASK_STACK_SIZE = 8192;
     static constexpr uint32_t UART_TASK_STACK_SIZE = 4096;
+    static constexpr uint32_t CAPTURE_SUMMARY_MS = 500;   // Counter refresh while capturing
     static constexpr UBaseType_t NETWORK_TASK_PRIORITY = 6;
     static constexpr UBaseType_t UART_TASK_PRIORITY = 5;
     static constexpr size_t MAX_SESSIONS = 8;
     static constexpr uint32_t CONNECTION_TIMEOUT = 30000; // 30 seconds
     static constexpr uint32_t KEEPALIVE_INTERVAL = 60000; // 1 minute
+    static constexpr size_t NET_RX_RING_SIZE = 8192;      // Per network session, PSRAM
+    static constexpr size_t NET_TX_RING_SIZE = 2048;
+    static constexpr size_t NET_DRAIN_BUDGET = 4096;      // Output bytes per session per frame
+    static constexpr uint32_t NET_SELECT_TIMEOUT_MS = 10; // Bounds TX latency and connect timeouts
+    static constexpr uint32_t NET_IDLE_MS = 100;          // Poll interval with no sockets open
 };
 
 #endif // ENHANCED_TERMINAL_APP_H
\ No newline at end of file
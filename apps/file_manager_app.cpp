@@ -2,6 +2,8 @@
 #include "../system/os_manager.h"
 #include <esp_log.h>
 #include <algorithm>
+#include <iterator>
+#include <cstring>
 #include <ctime>
 
 static const char* TAG = "FileManager";
@@ -45,6 +47,26 @@ os_error_t FileManagerApp::initialize() {
         m_currentPath = "/";
     }
 
+    // Operations run on the storage worker; their progress arrives on the main loop
+    m_progressListener = SUBSCRIBE_EVENT(EVENT_HAL_FILE_OP_PROGRESS, [this](const EventData& event) {
+        FileOpStatus status;
+        if (event.data && event.dataSize == sizeof(status)) {
+            memcpy(&status, event.data, sizeof(status));
+            if (isOwnOperation(status.id)) {
+                showOperationProgress(status);
+            }
+        }
+    });
+    m_completeListener = SUBSCRIBE_EVENT(EVENT_HAL_FILE_OP_COMPLETE, [this](const EventData& event) {
+        FileOpStatus status;
+        if (event.data && event.dataSize == sizeof(status)) {
+            memcpy(&status, event.data, sizeof(status));
+            if (isOwnOperation(status.id)) {
+                onOperationComplete(status);
+            }
+        }
+    });
+
     setMemoryUsage(64 * 1024); // 64KB for file lists and UI
     m_initialized = true;
 
@@ -65,6 +87,24 @@ os_error_t FileManagerApp::update(uint32_t deltaTime) {
     // Update storage indicator if storage status changed
     updateStorageIndicator();
 
+    // Read the next page before scrolling reaches the end of what is loaded
+    if (m_fileList) {
+        // Rebind once per batch of thumbnails that finished loading
+        ThumbnailService& thumbnails = OS().getThumbnails();
+        thumbnails.update();
+        if (thumbnails.getGeneration() != m_thumbGeneration) {
+            m_thumbGeneration = thumbnails.getGeneration();
+            m_fileView.invalidate();
+        }
+
+        if (m_nextCursor != DIR_CURSOR_END &&
+            m_fileView.getLastVisible() + OS_FILE_LIST_PREFETCH >= m_entries.size() &&
+            loadNextPage() == OS_OK) {
+            m_fileView.setCount(m_entries.size());
+        }
+        m_fileView.refresh(deltaTime);
+    }
+
     return OS_OK;
 }
 
@@ -75,6 +115,21 @@ os_error_t FileManagerApp::shutdown() {
 
     log(ESP_LOG_INFO, "Shutting down File Manager Application");
 
+    // Completions will not reach us any more; nothing may stay paused on our behalf
+    if (cancelFileOperation() == OS_OK) {
+        pauseFileOperations(false);
+        m_operations.clear();
+    }
+    if (m_progressListener) {
+        OS().getEventSystem().unsubscribe(m_progressListener);
+        m_progressListener = 0;
+    }
+    if (m_completeListener) {
+        OS().getEventSystem().unsubscribe(m_completeListener);
+        m_completeListener = 0;
+    }
+    printOperationSummary();
+
     // Cleanup storage service
     if (m_storageService && m_ownStorageService) {
         m_storageService->shutdown();
@@ -114,6 +169,7 @@ os_error_t FileManagerApp::destroyUI() {
     log(ESP_LOG_INFO, "Destroying File Manager UI");
 
     if (m_uiContainer) {
+        m_fileView.printStats(TAG);
         lv_obj_del(m_uiContainer);
         m_uiContainer = nullptr;
         m_mainContainer = nullptr;
@@ -124,6 +180,9 @@ os_error_t FileManagerApp::destroyUI() {
         m_statusContainer = nullptr;
         m_storageLabel = nullptr;
         m_selectionLabel = nullptr;
+        m_pauseButton = nullptr;
+        m_pauseLabel = nullptr;
+        m_cancelButton = nullptr;
         
         // Toolbar buttons
         m_upButton = nullptr;
@@ -173,8 +232,10 @@ os_error_t FileManagerApp::refreshDirectory() {
 
     log(ESP_LOG_DEBUG, "Refreshing directory: %s", m_currentPath.c_str());
 
-    // List directory contents
-    os_error_t result = m_storageService->listDirectory(m_currentPath, m_currentFiles);
+    // Only the first page now; the rest loads as the list scrolls
+    m_entries.clear();
+    m_nextCursor = 0;
+    os_error_t result = loadNextPage();
     if (result != OS_OK) {
         log(ESP_LOG_ERROR, "Failed to list directory: %s", m_currentPath.c_str());
         return result;
@@ -192,15 +253,19 @@ os_error_t FileManagerApp::refreshDirectory() {
 }
 
 void FileManagerApp::selectFile(size_t index) {
-    if (index >= m_currentFiles.size()) {
+    if (index >= m_entries.size()) {
         return;
     }
 
     m_selectedIndex = index;
+    m_fileView.setSelected((int)index);
+    HALDirEntry& file = m_entries[index];
+    if (!file.hasInfo) {
+        OS().getHALManager().getStorage().getDirectoryEntry(m_currentPath.c_str(), index, file);
+    }
     
     // Update selection label
     if (m_selectionLabel) {
-        const FileInfo& file = m_currentFiles[index];
         char selectionText[128];
         if (file.isDirectory) {
             snprintf(selectionText, sizeof(selectionText), "Folder: %s", file.name.c_str());
@@ -212,55 +277,222 @@ void FileManagerApp::selectFile(size_t index) {
         lv_label_set_text(m_selectionLabel, selectionText);
     }
 
-    log(ESP_LOG_DEBUG, "Selected file: %s", m_currentFiles[index].name.c_str());
+    log(ESP_LOG_DEBUG, "Selected file: %s", file.name.c_str());
 }
 
 os_error_t FileManagerApp::executeFileOperation(FileOperation operation, const std::string& targetPath) {
-    if (!m_storageService || m_selectedIndex < 0 || m_selectedIndex >= m_currentFiles.size()) {
+    if (!m_storageService) {
         return OS_ERROR_INVALID_PARAM;
     }
 
-    const FileInfo& selectedFile = m_currentFiles[m_selectedIndex];
-    os_error_t result = OS_OK;
-
+    std::string sourcePath;
+    FileOpType type;
     switch (operation) {
         case FileOperation::COPY:
-            if (!targetPath.empty()) {
-                result = m_storageService->copyFile(selectedFile.path, targetPath);
-                if (result == OS_OK) {
-                    log(ESP_LOG_INFO, "File copied: %s -> %s", selectedFile.path.c_str(), targetPath.c_str());
-                }
-            }
-            break;
-
         case FileOperation::MOVE:
-            if (!targetPath.empty()) {
-                result = m_storageService->moveFile(selectedFile.path, targetPath);
-                if (result == OS_OK) {
-                    log(ESP_LOG_INFO, "File moved: %s -> %s", selectedFile.path.c_str(), targetPath.c_str());
-                    refreshDirectory(); // Refresh to update file list
-                }
+            if (m_operationSourcePath.empty() || targetPath.empty()) {
+                return OS_ERROR_INVALID_PARAM;
             }
+            sourcePath = m_operationSourcePath;
+            type = operation == FileOperation::COPY ? FileOpType::COPY : FileOpType::MOVE;
             break;
 
         case FileOperation::DELETE:
-            result = m_storageService->deleteFile(selectedFile.path);
-            if (result == OS_OK) {
-                log(ESP_LOG_INFO, "File deleted: %s", selectedFile.path.c_str());
-                refreshDirectory(); // Refresh to update file list
+            if (m_selectedIndex < 0 || m_selectedIndex >= (int)m_entries.size()) {
+                return OS_ERROR_INVALID_PARAM;
             }
+            sourcePath = getEntryPath(m_selectedIndex);
+            type = FileOpType::DELETE;
             break;
 
         default:
-            result = OS_ERROR_INVALID_PARAM;
-            break;
+            return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Runs on the storage worker, directories included; the UI keeps running
+    FileOpId id = OS().getHALManager().getStorage().queueFileOperation(
+        type, sourcePath.c_str(), type == FileOpType::DELETE ? nullptr : targetPath.c_str());
+    if (id == 0) {
+        log(ESP_LOG_WARN, "File operation queue full");
+        return OS_ERROR_BUSY;
+    }
+    m_operations.push_back(id);
+    log(ESP_LOG_INFO, "Queued %s of %s%s%s",
+        type == FileOpType::COPY ? "copy" : type == FileOpType::MOVE ? "move" : "delete",
+        sourcePath.c_str(), type == FileOpType::DELETE ? "" : " to ", targetPath.c_str());
+
+    if (operation != FileOperation::DELETE) {
+        m_pendingOperation = FileOperation::NONE;
+        m_operationSourcePath.clear();
+        updatePasteButtons();
+    }
+    if (m_selectionLabel) {
+        lv_label_set_text(m_selectionLabel, m_operations.size() > 1 ? "Queued" : "Starting...");
+    }
+    updateOperationControls();
+    // Counted when it completes
+    return OS_OK;
+}
+
+os_error_t FileManagerApp::cancelFileOperation() {
+    if (m_operations.empty()) {
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    // Completions arrive as events and remove the IDs; queued ones go first
+    // so the worker does not start them as the running one stops
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    for (auto it = m_operations.rbegin(); it != m_operations.rend(); ++it) {
+        storage.cancelFileOperation(*it);
+    }
+    return OS_OK;
+}
+
+void FileManagerApp::markOrPaste(FileOperation operation) {
+    if (m_pendingOperation == operation) {
+        size_t slash = m_operationSourcePath.find_last_of('/');
+        std::string target = m_currentPath;
+        if (target.empty() || target.back() != '/') {
+            target += '/';
+        }
+        target += m_operationSourcePath.substr(slash == std::string::npos ? 0 : slash + 1);
+        executeFileOperation(operation, target);
+        return;
+    }
+    if (m_selectedIndex < 0) {
+        return;
     }
 
-    if (result == OS_OK) {
+    m_pendingOperation = operation;
+    m_operationSourcePath = getEntryPath(m_selectedIndex);
+    updatePasteButtons();
+    log(ESP_LOG_INFO, "%s operation prepared for: %s",
+        operation == FileOperation::COPY ? "Copy" : "Move", m_operationSourcePath.c_str());
+}
+
+void FileManagerApp::updatePasteButtons() {
+    if (m_copyButton) {
+        lv_label_set_text(lv_obj_get_child(m_copyButton, 0),
+                          m_pendingOperation == FileOperation::COPY ? "Paste" : "Copy");
+    }
+    if (m_moveButton) {
+        lv_label_set_text(lv_obj_get_child(m_moveButton, 0),
+                          m_pendingOperation == FileOperation::MOVE ? "Paste" : "Move");
+    }
+}
+
+void FileManagerApp::pauseFileOperations(bool paused) {
+    OS().getHALManager().getStorage().pauseFileOperations(paused);
+    if (m_pauseLabel) {
+        lv_label_set_text(m_pauseLabel, paused ? "Resume" : "Pause");
+    }
+}
+
+bool FileManagerApp::isOwnOperation(FileOpId id) const {
+    return std::find(m_operations.begin(), m_operations.end(), id) != m_operations.end();
+}
+
+void FileManagerApp::showOperationProgress(const FileOpStatus& status) {
+    m_runningOperation = status.id;
+    if (!m_selectionLabel) {
+        return;
+    }
+
+    const char* verb = status.type == FileOpType::COPY ? "Copying" :
+                       status.type == FileOpType::MOVE ? "Moving" : "Deleting";
+    char text[160];
+    if (status.state == FileOpState::SCANNING) {
+        snprintf(text, sizeof(text), "%s: counting %d files...", verb, status.filesTotal);
+        lv_label_set_text(m_selectionLabel, text);
+        return;
+    }
+
+    char doneText[32];
+    char totalText[32];
+    formatFileSize((uint64_t)status.kbDone * 1024, doneText, sizeof(doneText));
+    formatFileSize((uint64_t)status.kbTotal * 1024, totalText, sizeof(totalText));
+    uint32_t percent = status.kbTotal ? (uint32_t)((uint64_t)status.kbDone * 100 / status.kbTotal)
+                     : status.filesTotal ? status.filesDone * 100 / status.filesTotal : 0;
+
+    char etaText[24];
+    if (status.state == FileOpState::PAUSED) {
+        snprintf(etaText, sizeof(etaText), "paused");
+    } else if (status.etaSeconds == FILE_OP_ETA_UNKNOWN) {
+        snprintf(etaText, sizeof(etaText), "--:-- left");
+    } else {
+        snprintf(etaText, sizeof(etaText), "%d:%02d left", status.etaSeconds / 60, status.etaSeconds % 60);
+    }
+
+    snprintf(text, sizeof(text), "%s %d/%d files, %s / %s (%d%%, %d KB/s, %s)", verb,
+             status.filesDone, status.filesTotal, doneText, totalText, percent,
+             status.kbPerSecond, etaText);
+    lv_label_set_text(m_selectionLabel, text);
+}
+
+void FileManagerApp::onOperationComplete(const FileOpStatus& status) {
+    m_operations.erase(std::remove(m_operations.begin(), m_operations.end(), status.id), m_operations.end());
+    if (m_runningOperation == status.id) {
+        m_runningOperation = 0;
+    }
+    const char* verb = status.type == FileOpType::COPY ? "Copy" :
+                       status.type == FileOpType::MOVE ? "Move" : "Delete";
+
+    if (status.state == FileOpState::DONE) {
         m_operationsPerformed++;
+        m_filesProcessed += status.filesDone;
+        m_kbProcessed += status.kbDone;
+        if (status.kbPerSecond > 0) {
+            m_operationMs += (uint64_t)status.kbDone * 1000 / status.kbPerSecond;
+        }
+        log(ESP_LOG_INFO, "%s finished: %d files, %d KB at %d KB/s", verb, status.filesDone,
+            status.kbDone, status.kbPerSecond);
+        printOperationSummary();
+    } else if (status.state == FileOpState::CANCELLED) {
+        log(ESP_LOG_INFO, "%s cancelled after %d of %d files", verb, status.filesDone, status.filesTotal);
+    } else {
+        log(ESP_LOG_ERROR, "%s failed: %d", verb, status.result);
+    }
+
+    if (m_selectionLabel && m_operations.empty()) {
+        char text[64];
+        snprintf(text, sizeof(text), "%s %s", verb,
+                 status.state == FileOpState::DONE ? "complete" :
+                 status.state == FileOpState::CANCELLED ? "cancelled" : "failed");
+        lv_label_set_text(m_selectionLabel, text);
+    }
+
+    // Nothing of ours left to hold; do not leave the queue paused for others
+    if (m_operations.empty() && OS().getHALManager().getStorage().areFileOperationsPaused()) {
+        pauseFileOperations(false);
     }
+    updateOperationControls();
 
-    return result;
+    // Refresh to update file list
+    refreshDirectory();
+}
+
+void FileManagerApp::updateOperationControls() {
+    bool busy = !m_operations.empty();
+    lv_obj_t* controls[] = {m_pauseButton, m_cancelButton};
+    for (lv_obj_t* control : controls) {
+        if (!control) {
+            continue;
+        }
+        if (busy) {
+            lv_obj_clear_flag(control, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(control, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+void FileManagerApp::printOperationSummary() {
+    if (m_operationsPerformed == 0) {
+        return;
+    }
+    uint32_t kbPerSecond = m_operationMs ? (uint32_t)(m_kbProcessed * 1000 / m_operationMs) : 0;
+    log(ESP_LOG_INFO, "File operations: %d performed, %d files, %llu KB in %llu ms (%d KB/s overall)",
+        m_operationsPerformed, m_filesProcessed, m_kbProcessed, m_operationMs, kbPerSecond);
 }
 
 os_error_t FileManagerApp::switchStorage(StorageType type) {
@@ -334,13 +566,14 @@ void FileManagerApp::createFileBrowserUI() {
     lv_obj_set_size(m_fileListContainer, LV_HOR_RES - 60, LV_VER_RES - 220);
     lv_obj_align(m_fileListContainer, LV_ALIGN_TOP_LEFT, 10, 40);
     lv_obj_set_style_bg_color(m_fileListContainer, lv_color_hex(0x2A2A2A), 0);
+    lv_obj_clear_flag(m_fileListContainer, LV_OBJ_FLAG_SCROLLABLE);  // The list scrolls itself
 
-    // Create file list
-    m_fileList = lv_list_create(m_fileListContainer);
-    lv_obj_set_size(m_fileList, LV_HOR_RES - 80, LV_VER_RES - 240);
+    // Create file list: a pool of rows rebound as it scrolls
+    m_fileView.setBindCallback([this](size_t index, const VirtualListRow& row) { bindFileRow(index, row); });
+    m_fileView.setClickCallback([this](size_t index) { openEntry(index); });
+    m_fileList = m_fileView.create(m_fileListContainer, LV_HOR_RES - 80, LV_VER_RES - 240,
+                                   OS_FILE_LIST_ROW_HEIGHT);
     lv_obj_center(m_fileList);
-    lv_obj_set_style_bg_color(m_fileList, lv_color_hex(0x2A2A2A), 0);
-    lv_obj_add_event_cb(m_fileList, fileListCallback, LV_EVENT_CLICKED, this);
 }
 
 void FileManagerApp::createToolbarUI() {
@@ -395,6 +628,16 @@ void FileManagerApp::createToolbarUI() {
     lv_obj_center(copyLabel);
     startX += buttonWidth + spacing;
 
+    // Move button
+    m_moveButton = lv_btn_create(m_toolbarContainer);
+    lv_obj_set_size(m_moveButton, buttonWidth, 35);
+    lv_obj_align(m_moveButton, LV_ALIGN_LEFT_MID, startX, 0);
+    lv_obj_add_event_cb(m_moveButton, moveButtonCallback, LV_EVENT_CLICKED, this);
+    lv_obj_t* moveLabel = lv_label_create(m_moveButton);
+    lv_label_set_text(moveLabel, "Move");
+    lv_obj_center(moveLabel);
+    startX += buttonWidth + spacing;
+
     // Delete button
     m_deleteButton = lv_btn_create(m_toolbarContainer);
     lv_obj_set_size(m_deleteButton, buttonWidth, 35);
@@ -433,6 +676,26 @@ void FileManagerApp::createStatusBarUI() {
     lv_obj_align(m_selectionLabel, LV_ALIGN_RIGHT_MID, -10, 0);
     lv_obj_set_style_text_color(m_selectionLabel, lv_color_hex(0x00AAFF), 0);
     lv_label_set_text(m_selectionLabel, "No selection");
+
+    // Operation controls, shown while operations are in flight
+    m_pauseButton = lv_btn_create(m_statusContainer);
+    lv_obj_set_size(m_pauseButton, 80, 30);
+    lv_obj_align(m_pauseButton, LV_ALIGN_CENTER, -45, 0);
+    lv_obj_add_event_cb(m_pauseButton, pauseButtonCallback, LV_EVENT_CLICKED, this);
+    m_pauseLabel = lv_label_create(m_pauseButton);
+    lv_label_set_text(m_pauseLabel,
+                      OS().getHALManager().getStorage().areFileOperationsPaused() ? "Resume" : "Pause");
+    lv_obj_center(m_pauseLabel);
+
+    m_cancelButton = lv_btn_create(m_statusContainer);
+    lv_obj_set_size(m_cancelButton, 80, 30);
+    lv_obj_align(m_cancelButton, LV_ALIGN_CENTER, 45, 0);
+    lv_obj_add_event_cb(m_cancelButton, cancelButtonCallback, LV_EVENT_CLICKED, this);
+    lv_obj_t* cancelLabel = lv_label_create(m_cancelButton);
+    lv_label_set_text(cancelLabel, "Cancel");
+    lv_obj_center(cancelLabel);
+
+    updateOperationControls();
 }
 
 void FileManagerApp::updateFileList() {
@@ -440,26 +703,83 @@ void FileManagerApp::updateFileList() {
         return;
     }
 
-    // Clear existing list
-    lv_obj_clean(m_fileList);
+    // Rows are bound on demand; nothing per entry is created here
+    m_fileView.reset(m_entries.size());
+}
 
-    // Add files to list
-    for (size_t i = 0; i < m_currentFiles.size(); i++) {
-        const FileInfo& file = m_currentFiles[i];
-        
-        lv_obj_t* btn = lv_list_add_btn(m_fileList, getFileTypeIcon(file), file.name.c_str());
-        lv_obj_set_height(btn, 30);
-        
-        // Set button color based on file type
-        if (file.isDirectory) {
-            lv_obj_set_style_bg_color(btn, lv_color_hex(0x4A4A4A), 0);
-        } else {
-            lv_obj_set_style_bg_color(btn, lv_color_hex(0x3A3A3A), 0);
-        }
-        
-        // Store index in user data
-        lv_obj_set_user_data(btn, (void*)i);
+os_error_t FileManagerApp::loadNextPage() {
+    if (m_nextCursor == DIR_CURSOR_END) {
+        return OS_OK;
+    }
+
+    std::vector<HALDirEntry> page;
+    size_t nextCursor = DIR_CURSOR_END;
+    os_error_t result = OS().getHALManager().getStorage().readDirectory(
+        m_currentPath.c_str(), m_nextCursor, OS_FILE_LIST_PAGE_SIZE, page, nextCursor);
+    if (result != OS_OK) {
+        m_nextCursor = DIR_CURSOR_END;
+        return result;
     }
+
+    // Cursors are entry indices, so m_entries stays indexable like the listing
+    m_entries.insert(m_entries.end(), std::make_move_iterator(page.begin()),
+                     std::make_move_iterator(page.end()));
+    m_nextCursor = nextCursor;
+    return OS_OK;
+}
+
+void FileManagerApp::bindFileRow(size_t index, const VirtualListRow& row) {
+    HALDirEntry& entry = m_entries[index];
+
+    // Only rows being shown pay for a stat()
+    if (!entry.isDirectory && !entry.hasInfo) {
+        OS().getHALManager().getStorage().getDirectoryEntry(m_currentPath.c_str(), index, entry);
+    }
+
+    // Pictures show their thumbnail once it is cached, the type icon until then
+    const lv_img_dsc_t* thumbnail = nullptr;
+    if (!entry.isDirectory && entry.hasInfo && ThumbnailService::isSupported(entry.name.c_str())) {
+        thumbnail = OS().getThumbnails().get(getEntryPath(index).c_str(), entry.timestamp,
+                                             (uint32_t)entry.size);
+    }
+    if (thumbnail) {
+        lv_img_set_src(row.image, thumbnail);
+        lv_obj_clear_flag(row.image, LV_OBJ_FLAG_HIDDEN);
+        lv_label_set_text_static(row.icon, "");
+    } else {
+        lv_obj_add_flag(row.image, LV_OBJ_FLAG_HIDDEN);
+        lv_label_set_text_static(row.icon, getFileTypeIcon(entry));
+    }
+    lv_label_set_text(row.text, entry.name.c_str());
+    if (entry.isDirectory) {
+        lv_label_set_text_static(row.detail, "");
+        lv_obj_set_style_bg_color(row.object, lv_color_hex(0x4A4A4A), 0);
+    } else {
+        char sizeText[32];
+        formatFileSize(entry.size, sizeText, sizeof(sizeText));
+        lv_label_set_text(row.detail, sizeText);
+        lv_obj_set_style_bg_color(row.object, lv_color_hex(0x3A3A3A), 0);
+    }
+}
+
+void FileManagerApp::openEntry(size_t index) {
+    if (index >= m_entries.size()) {
+        return;
+    }
+
+    if (m_entries[index].isDirectory) {
+        navigateToDirectory(getEntryPath(index));
+    } else {
+        selectFile(index);
+    }
+}
+
+std::string FileManagerApp::getEntryPath(size_t index) const {
+    std::string path = m_currentPath;
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    return path + m_entries[index].name;
 }
 
 void FileManagerApp::updateBreadcrumb() {
@@ -497,13 +817,13 @@ void FileManagerApp::formatTimestamp(time_t timestamp, char* buffer, size_t buff
     strftime(buffer, bufferSize, "%Y-%m-%d %H:%M", timeinfo);
 }
 
-const char* FileManagerApp::getFileTypeIcon(const FileInfo& fileInfo) {
-    if (fileInfo.isDirectory) {
+const char* FileManagerApp::getFileTypeIcon(const HALDirEntry& entry) {
+    if (entry.isDirectory) {
         return LV_SYMBOL_DIRECTORY;
     }
     
     // Simple file type detection based on extension
-    std::string name = fileInfo.name;
+    std::string name = entry.name;
     std::transform(name.begin(), name.end(), name.begin(), ::tolower);
     
     if (name.find(".jpg") != std::string::npos || name.find(".png") != std::string::npos ||
@@ -523,26 +843,6 @@ const char* FileManagerApp::getFileTypeIcon(const FileInfo& fileInfo) {
 }
 
 // UI Event Callbacks
-void FileManagerApp::fileListCallback(lv_event_t* e) {
-    FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
-    lv_obj_t* btn = lv_event_get_target(e);
-    
-    if (app && btn) {
-        size_t index = (size_t)lv_obj_get_user_data(btn);
-        if (index < app->m_currentFiles.size()) {
-            const FileInfo& file = app->m_currentFiles[index];
-            
-            if (file.isDirectory) {
-                // Navigate to directory
-                app->navigateToDirectory(file.path);
-            } else {
-                // Select file
-                app->selectFile(index);
-            }
-        }
-    }
-}
-
 void FileManagerApp::upButtonCallback(lv_event_t* e) {
     FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
     if (app) {
@@ -575,17 +875,16 @@ void FileManagerApp::homeButtonCallback(lv_event_t* e) {
 void FileManagerApp::refreshButtonCallback(lv_event_t* e) {
     FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
     if (app) {
+        // The card may have changed behind StorageHAL (another device, the service)
+        OS().getHALManager().getStorage().invalidateDirectory(app->m_currentPath.c_str());
         app->refreshDirectory();
     }
 }
 
 void FileManagerApp::copyButtonCallback(lv_event_t* e) {
     FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
-    if (app && app->m_selectedIndex >= 0) {
-        // Set pending copy operation
-        app->m_pendingOperation = FileOperation::COPY;
-        app->m_operationSourcePath = app->m_currentFiles[app->m_selectedIndex].path;
-        ESP_LOGI(TAG, "Copy operation prepared for: %s", app->m_operationSourcePath.c_str());
+    if (app) {
+        app->markOrPaste(FileOperation::COPY);
     }
 }
 
@@ -617,5 +916,22 @@ void FileManagerApp::newFolderButtonCallback(lv_event_t* e) {
 }
 
 void FileManagerApp::moveButtonCallback(lv_event_t* e) {
-    // Not implemented in this basic version
+    FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
+    if (app) {
+        app->markOrPaste(FileOperation::MOVE);
+    }
+}
+
+void FileManagerApp::pauseButtonCallback(lv_event_t* e) {
+    FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
+    if (app) {
+        app->pauseFileOperations(!OS().getHALManager().getStorage().areFileOperationsPaused());
+    }
+}
+
+void FileManagerApp::cancelButtonCallback(lv_event_t* e) {
+    FileManagerApp* app = static_cast<FileManagerApp*>(lv_event_get_user_data(e));
+    if (app) {
+        app->cancelFileOperation();
+    }
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "base_app.h"
 #include "../services/storage_service.h"
+#include "../hal/directory_cache.h"
+#include "../hal/file_operation_queue.h"
+#include "../ui/virtual_list.h"
 
 /**
  * @file file_manager_app.h
@@ -11,6 +14,17 @@
  * Provides file management capabilities with support for
  * SD card and USB storage devices including file operations,
  * directory navigation, and storage device management.
+ *
+ * Directories are read a page at a time through StorageHAL::readDirectory()
+ * as the list scrolls towards the end of what is loaded, and shown in a
+ * VirtualList, so a folder of thousands of photos costs a screenful of row
+ * widgets and one stat() per row actually displayed.
+ *
+ * Copy, move and delete are queued on StorageHAL's file operation worker
+ * and work on whole directory trees; Copy and Move mark the selection and
+ * paste into the directory shown when pressed again. Progress comes back
+ * through EVENT_HAL_FILE_OP_PROGRESS to the status bar, which offers pause
+ * and cancel while operations are in flight.
  */
 
 enum class FileManagerView {
@@ -60,10 +74,13 @@ public:
     void selectFile(size_t index);
 
     /**
-     * @brief Execute file operation
+     * @brief Queue a file operation
+     *
+     * Copy and move take the marked source (m_operationSourcePath), delete
+     * the selection; all return once the operation is queued.
      * @param operation Operation to perform
      * @param targetPath Target path for copy/move operations
-     * @return OS_OK on success, error code on failure
+     * @return OS_OK if queued, error code on failure
      */
     os_error_t executeFileOperation(FileOperation operation, const std::string& targetPath = "");
 
@@ -79,7 +96,58 @@ public:
      */
     void updateStorageInfo();
 
+    /**
+     * @brief Cancel this app's queued and running operations
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if none is in flight
+     */
+    os_error_t cancelFileOperation();
+
+    /**
+     * @brief Pause or resume file operations
+     * @param paused True to pause
+     */
+    void pauseFileOperations(bool paused);
+
 private:
+    /**
+     * @brief Mark the selection for a copy or move, or paste the marked
+     *        source into the current directory when pressed again
+     * @param operation COPY or MOVE
+     */
+    void markOrPaste(FileOperation operation);
+
+    /**
+     * @brief Label the Copy and Move buttons for the pending operation
+     */
+    void updatePasteButtons();
+
+    /**
+     * @brief Show an operation's progress and ETA in the status bar
+     * @param status Progress from EVENT_HAL_FILE_OP_PROGRESS
+     */
+    void showOperationProgress(const FileOpStatus& status);
+
+    /**
+     * @brief Handle the end of one of this app's operations
+     * @param status Final status from EVENT_HAL_FILE_OP_COMPLETE
+     */
+    void onOperationComplete(const FileOpStatus& status);
+
+    /**
+     * @brief Check if an operation was queued by this app
+     */
+    bool isOwnOperation(FileOpId id) const;
+
+    /**
+     * @brief Show the pause/cancel controls while operations are in flight
+     */
+    void updateOperationControls();
+
+    /**
+     * @brief Log operation counts and overall throughput
+     */
+    void printOperationSummary();
+
     /**
      * @brief Create file browser UI
      */
@@ -96,10 +164,36 @@ private:
     void createStatusBarUI();
 
     /**
-     * @brief Update file list display
+     * @brief Show the loaded entries from the top of the list
      */
     void updateFileList();
 
+    /**
+     * @brief Read the next page of the current directory into m_entries
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t loadNextPage();
+
+    /**
+     * @brief Fill a list row for an entry
+     * @param index Entry index
+     * @param row Row widgets
+     */
+    void bindFileRow(size_t index, const VirtualListRow& row);
+
+    /**
+     * @brief Open a directory or select a file
+     * @param index Entry index
+     */
+    void openEntry(size_t index);
+
+    /**
+     * @brief Get the full path of an entry
+     * @param index Entry index
+     * @return Path under the current directory
+     */
+    std::string getEntryPath(size_t index) const;
+
     /**
      * @brief Update navigation breadcrumb
      */
@@ -141,13 +235,12 @@ private:
 
     /**
      * @brief Get file type icon
-     * @param fileInfo File information
+     * @param entry Directory entry
      * @return Icon symbol
      */
-    const char* getFileTypeIcon(const FileInfo& fileInfo);
+    const char* getFileTypeIcon(const HALDirEntry& entry);
 
     // UI event callbacks
-    static void fileListCallback(lv_event_t* e);
     static void upButtonCallback(lv_event_t* e);
     static void homeButtonCallback(lv_event_t* e);
     static void refreshButtonCallback(lv_event_t* e);
@@ -157,6 +250,8 @@ private:
     static void propertiesButtonCallback(lv_event_t* e);
     static void storageButtonCallback(lv_event_t* e);
     static void newFolderButtonCallback(lv_event_t* e);
+    static void pauseButtonCallback(lv_event_t* e);
+    static void cancelButtonCallback(lv_event_t* e);
 
     // Storage service
     StorageService* m_storageService = nullptr;
@@ -166,7 +261,8 @@ private:
     FileManagerView m_currentView = FileManagerView::BROWSER;
     StorageType m_currentStorage = StorageType::SD_CARD;
     std::string m_currentPath;
-    std::vector<FileInfo> m_currentFiles;
+    std::vector<HALDirEntry> m_entries;     // Loaded so far, in directory order
+    size_t m_nextCursor = DIR_CURSOR_END;   // Next page to read; DIR_CURSOR_END once complete
     int m_selectedIndex = -1;
     FileOperation m_pendingOperation = FileOperation::NONE;
     std::string m_operationSourcePath;
@@ -176,10 +272,14 @@ private:
     lv_obj_t* m_toolbarContainer = nullptr;
     lv_obj_t* m_breadcrumbLabel = nullptr;
     lv_obj_t* m_fileListContainer = nullptr;
-    lv_obj_t* m_fileList = nullptr;
+    lv_obj_t* m_fileList = nullptr;         // m_fileView's widget
+    VirtualList m_fileView;
     lv_obj_t* m_statusContainer = nullptr;
     lv_obj_t* m_storageLabel = nullptr;
-    lv_obj_t* m_selectionLabel = nullptr;
+    lv_obj_t* m_selectionLabel = nullptr;   // Also shows operation progress
+    lv_obj_t* m_pauseButton = nullptr;
+    lv_obj_t* m_pauseLabel = nullptr;
+    lv_obj_t* m_cancelButton = nullptr;
 
     // Toolbar buttons
     lv_obj_t* m_upButton = nullptr;
@@ -196,9 +296,21 @@ private:
     lv_obj_t* m_dialogContainer = nullptr;
     lv_obj_t* m_confirmDialog = nullptr;
 
+    // Queued file operations; events for other apps' operations are ignored
+    std::vector<FileOpId> m_operations;
+    FileOpId m_runningOperation = 0;
+    ListenerId m_progressListener = 0;
+    ListenerId m_completeListener = 0;
+
+    // Thumbnail generation the rows were last bound at
+    uint32_t m_thumbGeneration = 0;
+
     // Statistics
     uint32_t m_filesAccessed = 0;
     uint32_t m_operationsPerformed = 0;
+    uint32_t m_filesProcessed = 0;          // By completed operations
+    uint64_t m_kbProcessed = 0;
+    uint64_t m_operationMs = 0;             // Time spent running, from each operation's rate
 
     // Configuration
     static constexpr size_t MAX_PATH_LENGTH = 256;
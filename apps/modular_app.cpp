@@ -2,8 +2,11 @@
 #include "app_manager.h"
 #include "../system/os_manager.h"
 #include "../services/storage_service.h"
+#include "../system/memory_manager.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <cJSON.h>
 #include <cstring>
 #include <algorithm>
 
@@ -92,79 +95,54 @@ InstallResult ModularAppManager::installApp(const uint8_t* packageData, size_t p
         return InstallResult::INVALID_PACKAGE;
     }
 
-    // Validate package
-    AppPackage packageInfo;
-    if (!validatePackage(packageData, packageSize, packageInfo)) {
-        ESP_LOGE(TAG, "Invalid package format");
-        return InstallResult::INVALID_PACKAGE;
+    AppPackageReader reader(*this);
+    beginInstall();
+    os_error_t result = reader.feed(packageData, packageSize);
+    if (result == OS_OK) {
+        result = reader.finish();
     }
+    return endInstall(result);
+}
 
-    // Check if already installed
-    if (isAppInstalled(packageInfo.id)) {
-        ESP_LOGW(TAG, "App '%s' already installed", packageInfo.id.c_str());
-        return InstallResult::ALREADY_INSTALLED;
+InstallResult ModularAppManager::installAppFromFile(const std::string& packagePath) {
+    if (!m_initialized || packagePath.empty()) {
+        return InstallResult::INVALID_PACKAGE;
     }
 
-    // Check storage space
-    size_t totalSpace, usedSpace, freeSpace;
-    getStorageInfo(totalSpace, usedSpace, freeSpace);
-    if (freeSpace < packageInfo.packageSize) {
-        ESP_LOGE(TAG, "Insufficient storage space for '%s'", packageInfo.id.c_str());
-        return InstallResult::INSUFFICIENT_SPACE;
-    }
+    ESP_LOGI(TAG, "Installing app from file: %s", packagePath.c_str());
 
-    // Check dependencies
-    if (!checkDependencies(packageInfo.id)) {
-        ESP_LOGE(TAG, "Missing dependencies for '%s'", packageInfo.id.c_str());
-        return InstallResult::DEPENDENCY_MISSING;
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    FileHandle handle = storage.openFile(packagePath.c_str(), FileOpenMode::READ);
+    if (handle == INVALID_FILE_HANDLE) {
+        ESP_LOGE(TAG, "Cannot open package %s", packagePath.c_str());
+        return InstallResult::INVALID_PACKAGE;
     }
 
-    // Extract package
-    os_error_t result = extractPackage(packageData, packageSize, packageInfo.id);
-    if (result != OS_OK) {
-        ESP_LOGE(TAG, "Failed to extract package '%s'", packageInfo.id.c_str());
+    uint8_t* chunk = static_cast<uint8_t*>(OS_MALLOC_PSRAM(OS_APP_INSTALL_CHUNK_SIZE));
+    if (!chunk) {
+        storage.closeFile(handle);
         return InstallResult::INSTALL_FAILED;
     }
 
-    // Update package info
-    packageInfo.installPath = m_installPath + "/" + packageInfo.id;
-    packageInfo.installTime = millis();
-    packageInfo.isInstalled = true;
-    packageInfo.isEnabled = true;
-
-    // Add to installed apps
-    m_installedApps.push_back(packageInfo);
-
-    // Register with app manager
-    result = registerAppWithManager(packageInfo.id);
-    if (result != OS_OK) {
-        ESP_LOGW(TAG, "Failed to register app '%s' with manager", packageInfo.id.c_str());
+    // Only one chunk of the package is ever in memory
+    AppPackageReader reader(*this);
+    beginInstall();
+    os_error_t result = OS_OK;
+    while (result == OS_OK) {
+        int read = storage.read(handle, chunk, OS_APP_INSTALL_CHUNK_SIZE);
+        if (read <= 0) {
+            result = read < 0 ? OS_ERROR_FILESYSTEM : OS_OK;
+            break;
+        }
+        result = reader.feed(chunk, (size_t)read);
     }
+    storage.closeFile(handle);
+    OS_FREE(chunk);
 
-    // Save registry
-    savePackageRegistry();
-
-    m_totalInstalls++;
-    ESP_LOGI(TAG, "Successfully installed app '%s'", packageInfo.id.c_str());
-
-    return InstallResult::SUCCESS;
-}
-
-InstallResult ModularAppManager::installAppFromFile(const std::string& packagePath) {
-    ESP_LOGI(TAG, "Installing app from file: %s", packagePath.c_str());
-    
-    // For simulation, we'll use predefined app data
-    if (packagePath.find("calendar") != std::string::npos) {
-        // Simulate calendar app installation
-        std::string dummyData = "CALENDAR_APP_PACKAGE_DATA";
-        return installApp(reinterpret_cast<const uint8_t*>(dummyData.c_str()), dummyData.size());
-    } else if (packagePath.find("terminal") != std::string::npos) {
-        // Simulate enhanced terminal installation
-        std::string dummyData = "TERMINAL_APP_PACKAGE_DATA";
-        return installApp(reinterpret_cast<const uint8_t*>(dummyData.c_str()), dummyData.size());
+    if (result == OS_OK) {
+        result = reader.finish();
     }
-    
-    return InstallResult::INVALID_PACKAGE;
+    return endInstall(result);
 }
 
 os_error_t ModularAppManager::uninstallApp(const std::string& appId) {
@@ -188,8 +166,8 @@ os_error_t ModularAppManager::uninstallApp(const std::string& appId) {
     OS().getAppManager().unregisterApp(appId);
 
     // Remove installation files
-    // Note: This would require filesystem implementation
     ESP_LOGI(TAG, "Removing installation files for '%s'", appId.c_str());
+    OS().getHALManager().getStorage().removeDirectory(it->installPath.c_str(), true);
 
     // Remove from installed apps
     m_installedApps.erase(it);
@@ -291,44 +269,52 @@ os_error_t ModularAppManager::updatePackageRegistry() {
     return OS_OK;
 }
 
-bool ModularAppManager::validatePackage(const uint8_t* packageData, size_t packageSize, 
-                                        AppPackage& packageInfo) {
-    if (!packageData || packageSize < 32) {
+bool ModularAppManager::parseManifest(const char* manifest, AppPackage& packageInfo,
+                                      std::string& baseVersion) const {
+    cJSON* root = cJSON_Parse(manifest);
+    if (!root) {
         return false;
     }
 
-    // Simple validation - in real implementation would parse actual package format
-    std::string data(reinterpret_cast<const char*>(packageData), packageSize);
-    
-    if (data.find("CALENDAR_APP") != std::string::npos) {
-        auto it = std::find_if(m_availableApps.begin(), m_availableApps.end(),
-                              [](const AppPackage& pkg) { return pkg.id == "calendar"; });
-        if (it != m_availableApps.end()) {
-            packageInfo = *it;
-            return true;
-        }
-    } else if (data.find("TERMINAL_APP") != std::string::npos) {
-        auto it = std::find_if(m_availableApps.begin(), m_availableApps.end(),
-                              [](const AppPackage& pkg) { return pkg.id == "enhanced_terminal"; });
-        if (it != m_availableApps.end()) {
-            packageInfo = *it;
-            return true;
+    auto text = [root](const char* key) -> std::string {
+        const cJSON* item = cJSON_GetObjectItem(root, key);
+        return cJSON_IsString(item) ? item->valuestring : "";
+    };
+    auto list = [root](const char* key) {
+        std::vector<std::string> values;
+        const cJSON* item;
+        cJSON_ArrayForEach(item, cJSON_GetObjectItem(root, key)) {
+            if (cJSON_IsString(item)) {
+                values.push_back(item->valuestring);
+            }
         }
-    }
+        return values;
+    };
 
-    return false;
+    packageInfo = AppPackage();
+    packageInfo.id = text("id");
+    packageInfo.name = text("name");
+    packageInfo.version = text("version");
+    packageInfo.description = text("description");
+    packageInfo.author = text("author");
+    packageInfo.category = text("category");
+    packageInfo.iconPath = text("icon");
+    packageInfo.permissions = list("permissions");
+    packageInfo.dependencies = list("dependencies");
+    baseVersion = text("base_version");
+    cJSON_Delete(root);
+
+    // The ID names the install directory
+    const std::string& id = packageInfo.id;
+    return !id.empty() && id.size() <= 64 && id[0] != '.' && !packageInfo.version.empty() &&
+           id.find_first_of("/\\") == std::string::npos;
 }
 
-bool ModularAppManager::checkDependencies(const std::string& appId) const {
-    const AppPackage* package = getAppPackage(appId);
-    if (!package) {
-        return false;
-    }
-
+bool ModularAppManager::checkDependencies(const AppPackage& package) const {
     // Check if all dependencies are installed
-    for (const auto& dep : package->dependencies) {
+    for (const auto& dep : package.dependencies) {
         if (!isAppInstalled(dep)) {
-            ESP_LOGW(TAG, "Missing dependency '%s' for app '%s'", dep.c_str(), appId.c_str());
+            ESP_LOGW(TAG, "Missing dependency '%s' for app '%s'", dep.c_str(), package.id.c_str());
             return false;
         }
     }
@@ -336,13 +322,263 @@ bool ModularAppManager::checkDependencies(const std::string& appId) const {
     return true;
 }
 
-os_error_t ModularAppManager::extractPackage(const uint8_t* packageData, size_t packageSize,
-                                            const std::string& appId) {
-    ESP_LOGI(TAG, "Extracting package for app '%s'", appId.c_str());
-    
-    // In real implementation, this would extract files to the installation directory
-    // For simulation, we just log the operation
-    
+void ModularAppManager::beginInstall() {
+    m_install = InstallState();
+}
+
+os_error_t ModularAppManager::onPackageManifest(const AppPackageHeader& header, const char* manifest) {
+    AppPackage& packageInfo = m_install.package;
+    if (!parseManifest(manifest, packageInfo, m_install.baseVersion)) {
+        ESP_LOGE(TAG, "Invalid package manifest");
+        return OS_ERROR_INVALID_PARAM;
+    }
+    packageInfo.packageSize = header.installSize;
+    m_install.delta = (header.flags & APP_PACKAGE_DELTA) != 0;
+
+    const AppPackage* installed = nullptr;
+    auto it = std::find_if(m_installedApps.begin(), m_installedApps.end(),
+                          [&packageInfo](const AppPackage& pkg) { return pkg.id == packageInfo.id; });
+    if (it != m_installedApps.end()) {
+        installed = &(*it);
+    }
+
+    // Everything here is checked before a single entry is written
+    if (m_install.delta) {
+        if (!installed || installed->version != m_install.baseVersion) {
+            ESP_LOGE(TAG, "Delta for '%s' %s needs %s installed", packageInfo.id.c_str(),
+                     packageInfo.version.c_str(), m_install.baseVersion.c_str());
+            m_install.failure = InstallResult::BASE_VERSION_MISMATCH;
+            return OS_ERROR_NOT_FOUND;
+        }
+    } else if (installed) {
+        ESP_LOGW(TAG, "App '%s' already installed", packageInfo.id.c_str());
+        m_install.failure = InstallResult::ALREADY_INSTALLED;
+        return OS_ERROR_BUSY;
+    }
+
+    // A delta is staged beside the version it replaces, so both need room
+    size_t totalSpace, usedSpace, freeSpace;
+    getStorageInfo(totalSpace, usedSpace, freeSpace);
+    if (freeSpace < packageInfo.packageSize) {
+        ESP_LOGE(TAG, "Insufficient storage space for '%s'", packageInfo.id.c_str());
+        m_install.failure = InstallResult::INSUFFICIENT_SPACE;
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    if (!checkDependencies(packageInfo)) {
+        ESP_LOGE(TAG, "Missing dependencies for '%s'", packageInfo.id.c_str());
+        m_install.failure = InstallResult::DEPENDENCY_MISSING;
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    std::string staging = m_installPath + "/" + packageInfo.id + ".partial";
+    storage.createDirectory(m_installPath.c_str());
+    storage.removeDirectory(staging.c_str(), true);     // Left behind by an interrupted install
+    if (storage.createDirectory(staging.c_str()) != OS_OK) {
+        return OS_ERROR_FILESYSTEM;
+    }
+    m_install.stagingPath = staging;
+
+    ESP_LOGI(TAG, "Installing '%s' %s%s%s (%d entries)", packageInfo.id.c_str(),
+             m_install.delta ? m_install.baseVersion.c_str() : "", m_install.delta ? " -> " : "",
+             packageInfo.version.c_str(), header.entryCount);
+    return OS_OK;
+}
+
+os_error_t ModularAppManager::onPackageEntry(const AppPackageEntry& entry, const char* path) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    m_install.entryPath = m_install.stagingPath + "/" + path;
+
+    os_error_t result = createParents(m_install.entryPath);
+    if (result != OS_OK) {
+        return result;
+    }
+    if (entry.type == AppPackageEntryType::DIRECTORY) {
+        return storage.createDirectory(m_install.entryPath.c_str());
+    }
+
+    m_install.output = storage.openFile(m_install.entryPath.c_str(), FileOpenMode::WRITE);
+    if (m_install.output == INVALID_FILE_HANDLE) {
+        return OS_ERROR_FILESYSTEM;
+    }
+    m_install.crc = 0;
+    m_install.expectedCrc = entry.crc;
+    m_install.sourcePath = m_installPath + "/" + m_install.package.id + "/" + path;
+    return OS_OK;
+}
+
+os_error_t ModularAppManager::onPackageData(const uint8_t* data, size_t size) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    if (storage.write(m_install.output, data, size) != (int)size) {
+        ESP_LOGE(TAG, "Failed to write %s", m_install.entryPath.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    m_install.crc = esp_rom_crc32_le(m_install.crc, data, size);
+    return OS_OK;
+}
+
+os_error_t ModularAppManager::onPackageCopy(uint64_t offset, uint32_t length) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+
+    if (!m_copyBuffer) {
+        m_copyBuffer = static_cast<uint8_t*>(OS_MALLOC_PSRAM(OS_APP_INSTALL_CHUNK_SIZE));
+        if (!m_copyBuffer) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+    if (m_install.source == INVALID_FILE_HANDLE) {
+        m_install.source = storage.openFile(m_install.sourcePath.c_str(), FileOpenMode::READ);
+        if (m_install.source == INVALID_FILE_HANDLE) {
+            ESP_LOGE(TAG, "Delta base %s is missing", m_install.sourcePath.c_str());
+            m_install.failure = InstallResult::BASE_VERSION_MISMATCH;
+            return OS_ERROR_NOT_FOUND;
+        }
+    }
+
+    if (storage.seek(m_install.source, (int64_t)offset) != OS_OK) {
+        return OS_ERROR_FILESYSTEM;
+    }
+    while (length > 0) {
+        size_t count = std::min<size_t>(length, OS_APP_INSTALL_CHUNK_SIZE);
+        if (storage.read(m_install.source, m_copyBuffer, count) != (int)count) {
+            ESP_LOGE(TAG, "Delta base %s is shorter than expected", m_install.sourcePath.c_str());
+            m_install.failure = InstallResult::BASE_VERSION_MISMATCH;
+            return OS_ERROR_INVALID_PARAM;
+        }
+        os_error_t result = onPackageData(m_copyBuffer, count);
+        if (result != OS_OK) {
+            return result;
+        }
+        length -= count;
+    }
+    return OS_OK;
+}
+
+os_error_t ModularAppManager::onPackageEntryEnd() {
+    bool file = m_install.output != INVALID_FILE_HANDLE;
+    closeEntry();
+
+    if (file && m_install.crc != m_install.expectedCrc) {
+        ESP_LOGE(TAG, "CRC mismatch in %s", m_install.entryPath.c_str());
+        m_install.failure = InstallResult::VERIFICATION_FAILED;
+        return OS_ERROR_INVALID_PARAM;
+    }
+    return OS_OK;
+}
+
+void ModularAppManager::closeEntry() {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    if (m_install.output != INVALID_FILE_HANDLE) {
+        storage.closeFile(m_install.output);
+        m_install.output = INVALID_FILE_HANDLE;
+    }
+    if (m_install.source != INVALID_FILE_HANDLE) {
+        storage.closeFile(m_install.source);
+        m_install.source = INVALID_FILE_HANDLE;
+    }
+}
+
+os_error_t ModularAppManager::createParents(const std::string& path) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    for (size_t slash = path.find('/', m_install.stagingPath.size() + 1); slash != std::string::npos;
+         slash = path.find('/', slash + 1)) {
+        os_error_t result = storage.createDirectory(path.substr(0, slash).c_str());
+        if (result != OS_OK) {
+            return result;
+        }
+    }
+    return OS_OK;
+}
+
+InstallResult ModularAppManager::endInstall(os_error_t result) {
+    closeEntry();
+    if (m_copyBuffer) {
+        OS_FREE(m_copyBuffer);
+        m_copyBuffer = nullptr;
+    }
+
+    if (result == OS_OK) {
+        result = commitInstall();
+    }
+
+    InstallResult install = InstallResult::SUCCESS;
+    if (result != OS_OK) {
+        // Nothing outside the staging directory has been touched yet
+        if (!m_install.stagingPath.empty()) {
+            OS().getHALManager().getStorage().removeDirectory(m_install.stagingPath.c_str(), true);
+        }
+
+        install = m_install.failure;
+        if (install == InstallResult::SUCCESS) {
+            install = result == OS_ERROR_INVALID_PARAM ? InstallResult::INVALID_PACKAGE :
+                      result == OS_ERROR_PERMISSION ? InstallResult::VERIFICATION_FAILED :
+                      InstallResult::INSTALL_FAILED;
+        }
+        ESP_LOGE(TAG, "Install of '%s' failed: %d", m_install.package.id.c_str(), static_cast<int>(install));
+    }
+
+    m_install = InstallState();
+    return install;
+}
+
+os_error_t ModularAppManager::commitInstall() {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    AppPackage& packageInfo = m_install.package;
+    std::string finalPath = m_installPath + "/" + packageInfo.id;
+
+    if (m_install.delta) {
+        // Swap the directories, keeping the old version until the new one is in place
+        OS().getAppManager().killApp(packageInfo.id);
+        std::string oldPath = finalPath + ".old";
+        storage.removeDirectory(oldPath.c_str(), true);
+        if (storage.renamePath(finalPath.c_str(), oldPath.c_str()) != OS_OK) {
+            return OS_ERROR_FILESYSTEM;
+        }
+        if (storage.renamePath(m_install.stagingPath.c_str(), finalPath.c_str()) != OS_OK) {
+            storage.renamePath(oldPath.c_str(), finalPath.c_str());
+            return OS_ERROR_FILESYSTEM;
+        }
+        storage.removeDirectory(oldPath.c_str(), true);
+
+        auto it = std::find_if(m_installedApps.begin(), m_installedApps.end(),
+                              [&packageInfo](const AppPackage& pkg) { return pkg.id == packageInfo.id; });
+        packageInfo.installPath = finalPath;
+        packageInfo.installTime = millis();
+        packageInfo.isInstalled = true;
+        packageInfo.isEnabled = it->isEnabled;
+        *it = packageInfo;
+
+        savePackageRegistry();
+        m_totalUpdates++;
+        ESP_LOGI(TAG, "Updated app '%s' to %s", packageInfo.id.c_str(), packageInfo.version.c_str());
+        return OS_OK;
+    }
+
+    storage.removeDirectory(finalPath.c_str(), true);   // Files of an app the registry lost
+    if (storage.renamePath(m_install.stagingPath.c_str(), finalPath.c_str()) != OS_OK) {
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    // Update package info
+    packageInfo.installPath = finalPath;
+    packageInfo.installTime = millis();
+    packageInfo.isInstalled = true;
+    packageInfo.isEnabled = true;
+
+    // Add to installed apps
+    m_installedApps.push_back(packageInfo);
+
+    // Register with app manager
+    if (registerAppWithManager(packageInfo.id) != OS_OK) {
+        ESP_LOGW(TAG, "Failed to register app '%s' with manager", packageInfo.id.c_str());
+    }
+
+    // Save registry
+    savePackageRegistry();
+
+    m_totalInstalls++;
+    ESP_LOGI(TAG, "Successfully installed app '%s'", packageInfo.id.c_str());
     return OS_OK;
 }
 
@@ -508,8 +744,7 @@ void AppStoreUI::installButtonCallback(lv_event_t* e) {
     
     if (ui && appId) {
         ESP_LOGI("AppStoreUI", "Installing app: %s", appId);
-        // Simulate installation
-        ui->m_manager.installAppFromFile(std::string("/packages/") + appId + ".app");
+        ui->m_manager.installAppFromFile(std::string(OS_APP_PACKAGE_DIR "/") + appId + ".app");
     }
 }
 
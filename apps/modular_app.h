@@ -2,6 +2,8 @@
 #define MODULAR_APP_H
 
 #include "base_app.h"
+#include "../system/app_package.h"
+#include "../hal/storage_hal.h"
 #include <functional>
 #include <vector>
 #include <memory>
@@ -12,6 +14,14 @@
  * 
  * Provides APK-like modular app functionality with installation, 
  * uninstallation, and dynamic loading capabilities.
+ *
+ * Packages (app_package.h) are installed as a stream: the file is read a
+ * chunk at a time and every entry is written to a staging directory next
+ * to the app's install directory as it arrives, so neither the package
+ * nor the app has to fit in RAM. The staging directory replaces the app
+ * only once the package digest and signature check out. A delta package
+ * carries only the blocks that changed since the installed version and
+ * rebuilds the rest from the installed files.
  */
 
 struct AppPackage {
@@ -38,10 +48,12 @@ enum class InstallResult {
     DEPENDENCY_MISSING,
     PERMISSION_DENIED,
     INVALID_PACKAGE,
-    INSTALL_FAILED
+    INSTALL_FAILED,
+    VERIFICATION_FAILED,    // Entry CRC or package signature did not match
+    BASE_VERSION_MISMATCH   // Delta package for a version that is not installed
 };
 
-class ModularAppManager {
+class ModularAppManager : private AppPackageSink {
 public:
     ModularAppManager() = default;
     ~ModularAppManager() = default;
@@ -59,7 +71,9 @@ public:
     os_error_t shutdown();
 
     /**
-     * @brief Install an app package
+     * @brief Install an app package already in memory
+     *
+     * Full packages install a new app, delta packages update an installed one.
      * @param packageData Package data buffer
      * @param packageSize Size of package data
      * @return Installation result
@@ -67,7 +81,9 @@ public:
     InstallResult installApp(const uint8_t* packageData, size_t packageSize);
 
     /**
-     * @brief Install app from file path
+     * @brief Install or update an app from a package file
+     *
+     * Streams the file in OS_APP_INSTALL_CHUNK_SIZE chunks.
      * @param packagePath Path to package file
      * @return Installation result
      */
@@ -135,31 +151,74 @@ public:
 
 private:
     /**
-     * @brief Validate app package
-     * @param packageData Package data
-     * @param packageSize Package size
+     * @brief State of the install in progress
+     */
+    struct InstallState {
+        AppPackage package;
+        std::string baseVersion;        // Delta packages only
+        std::string stagingPath;        // Empty until the manifest is accepted
+        std::string entryPath;
+        std::string sourcePath;         // Installed file a delta entry copies from
+        FileHandle output = INVALID_FILE_HANDLE;
+        FileHandle source = INVALID_FILE_HANDLE;
+        uint32_t crc = 0;
+        uint32_t expectedCrc = 0;
+        bool delta = false;
+        InstallResult failure = InstallResult::SUCCESS;    // Set when a check fails for a known reason
+    };
+
+    // AppPackageSink, called by the reader as the package streams in
+    os_error_t onPackageManifest(const AppPackageHeader& header, const char* manifest) override;
+    os_error_t onPackageEntry(const AppPackageEntry& entry, const char* path) override;
+    os_error_t onPackageData(const uint8_t* data, size_t size) override;
+    os_error_t onPackageCopy(uint64_t offset, uint32_t length) override;
+    os_error_t onPackageEntryEnd() override;
+
+    /**
+     * @brief Parse a package manifest
+     * @param manifest JSON manifest
      * @param packageInfo Output package info
+     * @param baseVersion Output version a delta applies to, empty for a full package
      * @return true if valid, false otherwise
      */
-    bool validatePackage(const uint8_t* packageData, size_t packageSize, 
-                        AppPackage& packageInfo);
+    bool parseManifest(const char* manifest, AppPackage& packageInfo, std::string& baseVersion) const;
 
     /**
      * @brief Check dependencies for app
-     * @param appId Application ID
+     * @param package App package info
      * @return true if dependencies satisfied, false otherwise
      */
-    bool checkDependencies(const std::string& appId) const;
+    bool checkDependencies(const AppPackage& package) const;
 
     /**
-     * @brief Extract package to installation directory
-     * @param packageData Package data
-     * @param packageSize Package size
-     * @param appId Application ID
+     * @brief Reset the install state before feeding a package
+     */
+    void beginInstall();
+
+    /**
+     * @brief Commit or roll back the install once the package is read
+     * @param result OS_OK if the whole package was read and verified
+     * @return Installation result
+     */
+    InstallResult endInstall(os_error_t result);
+
+    /**
+     * @brief Replace the app's install directory with the staging directory
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t commitInstall();
+
+    /**
+     * @brief Close the handles of the entry being written
+     */
+    void closeEntry();
+
+    /**
+     * @brief Create the directories between the staging directory and a path
+     * @param path File path inside the staging directory
      * @return OS_OK on success, error code on failure
      */
-    os_error_t extractPackage(const uint8_t* packageData, size_t packageSize,
-                             const std::string& appId);
+    os_error_t createParents(const std::string& path);
 
     /**
      * @brief Register app with main app manager
@@ -184,13 +243,18 @@ private:
     std::vector<AppPackage> m_installedApps;
     std::vector<AppPackage> m_availableApps;
     
+    // Install in progress
+    InstallState m_install;
+    uint8_t* m_copyBuffer = nullptr;    // Delta copies, allocated on first use
+
     // Configuration
-    std::string m_installPath = "/apps";
+    std::string m_installPath = OS_APP_INSTALL_DIR;
     std::string m_cachePath = "/tmp/apps";
     std::string m_registryPath = "/config/app_registry.json";
     
     // Statistics
     size_t m_totalInstalls = 0;
+    size_t m_totalUpdates = 0;
     size_t m_totalUninstalls = 0;
     
     bool m_initialized = false;
@@ -4,6 +4,8 @@
 #include <driver/gpio.h>
 #include <sys/time.h>
 #include <string.h>
+#include <algorithm>
+#include <cstdio>
 
 static const char* TAG = "RS485Terminal";
 
@@ -29,22 +31,36 @@ os_error_t RS485TerminalApp::initialize() {
     m_rxBufferSize = RX_BUFFER_SIZE;
     m_txBufferSize = TX_BUFFER_SIZE;
     
-    m_rxBuffer = (uint8_t*)heap_caps_malloc(m_rxBufferSize, MALLOC_CAP_DMA);
-    m_txBuffer = (uint8_t*)heap_caps_malloc(m_txBufferSize, MALLOC_CAP_DMA);
+    m_rxBuffer = (uint8_t*)OS_MALLOC_DMA(m_rxBufferSize);
+    m_txBuffer = (uint8_t*)OS_MALLOC_DMA(m_txBufferSize);
     
-    if (!m_rxBuffer || !m_txBuffer) {
+    // Receive ring lives in the app arena (PSRAM) for the app's whole life;
+    // only the UART task and update() touch it
+    m_rxRingStorage = (uint8_t*)arenaAllocate(RX_RING_SIZE);
+
+    if (!m_rxBuffer || !m_txBuffer || !m_rxRingStorage) {
         log(ESP_LOG_ERROR, "Failed to allocate communication buffers");
         return OS_ERROR_NO_MEMORY;
     }
+    m_rxRing.init(m_rxRingStorage, RX_RING_SIZE);
+
+    os_error_t result = m_terminal.initialize(OS_TERM_SCROLLBACK_LINES, OS_TERM_SCROLLBACK_BYTES, getArena());
+    if (result != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to allocate terminal scrollback");
+        return result;
+    }
+    m_terminal.setAutoScroll(m_autoScroll);
+    m_terminal.appendText("RS-485 Terminal Ready");
 
     // Initialize RS-485 hardware
-    os_error_t result = initializeRS485();
+    result = initializeRS485();
     if (result != OS_OK) {
         log(ESP_LOG_ERROR, "Failed to initialize RS-485 hardware");
         return result;
     }
 
-    setMemoryUsage(m_rxBufferSize + m_txBufferSize + TERMINAL_BUFFER_SIZE);
+    setMemoryUsage(m_rxBufferSize + m_txBufferSize + RX_RING_SIZE +
+                   m_terminal.getScrollback().getMemoryUsage());
     m_initialized = true;
 
     log(ESP_LOG_INFO, "RS-485 Terminal application initialized successfully");
@@ -56,11 +72,28 @@ os_error_t RS485TerminalApp::update(uint32_t deltaTime) {
         return OS_ERROR_GENERIC;
     }
 
-    // Process received data if available
+    // Display what the UART task collected since the last frame
     if (m_rs485Initialized) {
         processReceivedData();
+        if (m_modbusMode) {
+            processModbusResults();
+        }
     }
 
+    // Capturing shows counters only
+    if (m_capture.isActive() && m_captureLabel) {
+        uint32_t now = millis();
+        if (now - m_captureShownMs >= CAPTURE_SUMMARY_MS) {
+            char summary[160];
+            m_capture.formatSummary(summary, sizeof(summary));
+            lv_label_set_text(m_captureLabel, summary);
+            m_captureShownMs = now;
+        }
+    }
+
+    // One redraw for everything appended this frame
+    m_terminal.refresh();
+
     return OS_OK;
 }
 
@@ -71,28 +104,46 @@ os_error_t RS485TerminalApp::shutdown() {
 
     log(ESP_LOG_INFO, "Shutting down RS-485 Terminal Application");
 
-    // Stop UART task
+    // Stop UART task; it exits within one event queue timeout
     if (m_uartTaskHandle) {
+        TaskHandle_t task = m_uartTaskHandle;
+        unregisterTask(task);
         m_taskRunning = false;
-        vTaskDelete(m_uartTaskHandle);
-        m_uartTaskHandle = nullptr;
+        for (int attempt = 0; attempt < 30 && m_uartTaskHandle; attempt++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_uartTaskHandle) {
+            log(ESP_LOG_WARN, "UART task did not exit, deleting");
+            vTaskDelete(task);
+            m_uartTaskHandle = nullptr;
+        }
     }
 
+    // The UART task is gone, so nothing records into the log any more
+    m_capture.stop();
+
     // Deinitialize UART
     if (m_rs485Initialized) {
+        m_modbus.end();
+        m_modbusMode = false;
+        m_modbusRequested = false;
         uart_driver_delete(UART_PORT);
+        m_uartQueue = nullptr;
         m_rs485Initialized = false;
     }
 
     // Free buffers
     if (m_rxBuffer) {
-        heap_caps_free(m_rxBuffer);
+        OS_FREE(m_rxBuffer);
         m_rxBuffer = nullptr;
     }
     if (m_txBuffer) {
-        heap_caps_free(m_txBuffer);
+        OS_FREE(m_txBuffer);
         m_txBuffer = nullptr;
     }
+    // The ring storage is reclaimed with the app arena
+    m_rxRingStorage = nullptr;
+    m_terminal.shutdown();
 
     m_initialized = false;
     return OS_OK;
@@ -125,13 +176,15 @@ os_error_t RS485TerminalApp::destroyUI() {
         lv_obj_del(m_uiContainer);
         m_uiContainer = nullptr;
         m_terminalContainer = nullptr;
-        m_terminalTextArea = nullptr;
         m_inputTextArea = nullptr;
         m_controlPanel = nullptr;
         m_sendButton = nullptr;
         m_clearButton = nullptr;
         m_configButton = nullptr;
         m_modeButton = nullptr;
+        m_modbusButton = nullptr;
+        m_captureButton = nullptr;
+        m_captureLabel = nullptr;
         m_statusLabel = nullptr;
         m_configLabel = nullptr;
     }
@@ -171,13 +224,17 @@ os_error_t RS485TerminalApp::initializeRS485() {
         return OS_ERROR_HARDWARE;
     }
 
-    // Install UART driver
-    ret = uart_driver_install(UART_PORT, m_rxBufferSize, m_txBufferSize, 0, NULL, 0);
+    // Install UART driver with an event queue for the UART task
+    ret = uart_driver_install(UART_PORT, m_rxBufferSize, m_txBufferSize,
+                              UART_EVENT_QUEUE_DEPTH, &m_uartQueue, 0);
     if (ret != ESP_OK) {
         log(ESP_LOG_ERROR, "Failed to install UART driver: %s", esp_err_to_name(ret));
         return OS_ERROR_HARDWARE;
     }
 
+    // Raise UART_DATA after a short line idle instead of per FIFO threshold
+    uart_set_rx_timeout(UART_PORT, UART_RX_TIMEOUT_SYMBOLS);
+
     // Configure RS-485 mode
     ret = uart_set_mode(UART_PORT, UART_MODE_RS485_HALF_DUPLEX);
     if (ret != ESP_OK) {
@@ -186,16 +243,9 @@ os_error_t RS485TerminalApp::initializeRS485() {
     }
 
     // Configure RS-485 direction pin
-    gpio_config_t io_conf = {};
-    io_conf.intr_type = GPIO_INTR_DISABLE;
-    io_conf.mode = GPIO_MODE_OUTPUT;
-    io_conf.pin_bit_mask = 1ULL << RS485_DE_PIN;
-    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
-    ret = gpio_config(&io_conf);
-    if (ret != ESP_OK) {
-        log(ESP_LOG_ERROR, "Failed to configure RS-485 DE pin: %s", esp_err_to_name(ret));
-        return OS_ERROR_HARDWARE;
+    os_error_t result = configureDirectionPin();
+    if (result != OS_OK) {
+        return result;
     }
 
     // Start in receive mode
@@ -216,6 +266,7 @@ os_error_t RS485TerminalApp::initializeRS485() {
         log(ESP_LOG_ERROR, "Failed to create UART task");
         return OS_ERROR_GENERIC;
     }
+    registerTask(m_uartTaskHandle);
 
     m_rs485Initialized = true;
     log(ESP_LOG_INFO, "RS-485 hardware initialized successfully");
@@ -247,6 +298,9 @@ os_error_t RS485TerminalApp::configureRS485(const RS485Config& config) {
         return OS_ERROR_HARDWARE;
     }
 
+    // t3.5 follows the character time
+    m_modbus.setLineTiming((uint32_t)config.baudRate, getBitsPerChar());
+
     // Update config label if UI is active
     if (m_configLabel) {
         char configText[64];
@@ -265,6 +319,9 @@ os_error_t RS485TerminalApp::sendData(const uint8_t* data, size_t length) {
     if (!m_rs485Initialized || !data || length == 0) {
         return OS_ERROR_INVALID_PARAM;
     }
+    if (m_modbusMode) {
+        return OS_ERROR_BUSY;   // The master owns the bus
+    }
 
     // Switch to transmit mode
     setTransmitMode(true);
@@ -290,6 +347,11 @@ os_error_t RS485TerminalApp::sendData(const uint8_t* data, size_t length) {
     m_bytesTransmitted += length;
     m_packetsTransmitted++;
 
+    if (m_capture.isActive()) {
+        m_capture.record(true, data, length);
+        return OS_OK;
+    }
+
     // Add to terminal display
     char displayBuffer[512];
     formatDataForDisplay(data, length, displayBuffer, sizeof(displayBuffer));
@@ -309,10 +371,8 @@ os_error_t RS485TerminalApp::sendString(const char* text) {
 }
 
 void RS485TerminalApp::clearTerminal() {
-    if (m_terminalTextArea) {
-        lv_textarea_set_text(m_terminalTextArea, "");
-        log(ESP_LOG_INFO, "Terminal cleared");
-    }
+    m_terminal.clear();
+    log(ESP_LOG_INFO, "Terminal cleared");
 }
 
 void RS485TerminalApp::setTransmitMode(bool transmit) {
@@ -329,13 +389,175 @@ void RS485TerminalApp::setTransmitMode(bool transmit) {
 
 void RS485TerminalApp::printRS485Stats() const {
     log(ESP_LOG_INFO, "RS-485 Statistics:");
-    log(ESP_LOG_INFO, "  Bytes RX: %u", m_bytesReceived);
+    log(ESP_LOG_INFO, "  Bytes RX: %u", m_bytesReceived.load());
     log(ESP_LOG_INFO, "  Bytes TX: %u", m_bytesTransmitted);
     log(ESP_LOG_INFO, "  Packets RX: %u", m_packetsReceived);
     log(ESP_LOG_INFO, "  Packets TX: %u", m_packetsTransmitted);
-    log(ESP_LOG_INFO, "  Errors: %u", m_errorCount);
+    log(ESP_LOG_INFO, "  Errors: %u (parity %u, frame %u)",
+        m_errorCount.load(), m_parityErrors.load(), m_frameErrors.load());
+    log(ESP_LOG_INFO, "  FIFO overflows: %u, driver buffer full: %u, breaks: %u",
+        m_fifoOverflows.load(), m_bufferFull.load(), m_breaks.load());
+    log(ESP_LOG_INFO, "  RX ring: %u/%u bytes queued, high water %u, overflows %u (%u bytes dropped)",
+        (unsigned)m_rxRing.available(), (unsigned)m_rxRing.capacity(),
+        (unsigned)m_ringHighWater, m_ringOverflows.load(), m_bytesDropped.load());
     log(ESP_LOG_INFO, "  Baud Rate: %d", (int)m_config.baudRate);
-    log(ESP_LOG_INFO, "  Mode: %s", m_transmitMode ? "TX" : "RX");
+    log(ESP_LOG_INFO, "  Mode: %s", m_modbusMode ? "Modbus master" : m_transmitMode ? "TX" : "RX");
+    if (m_modbusMode || m_modbus.getPollCount() > 0) {
+        m_modbus.printStats(TAG);
+    }
+    m_terminal.printStats(TAG);
+}
+
+os_error_t RS485TerminalApp::startCapture(const char* path) {
+    if (!m_rs485Initialized) {
+        return OS_ERROR_NOT_AVAILABLE;
+    }
+
+    os_error_t result = m_capture.start(path, "rs485", (uint32_t)m_config.baudRate);
+    char line[128];
+    if (result == OS_OK) {
+        snprintf(line, sizeof(line), "Capturing to %s", m_capture.getPath());
+    } else {
+        snprintf(line, sizeof(line), "Capture failed to start (%d)", result);
+    }
+    addToTerminal(line, false);
+    m_captureShownMs = 0;
+    return result;
+}
+
+os_error_t RS485TerminalApp::stopCapture() {
+    if (!m_capture.isActive()) {
+        return OS_OK;
+    }
+
+    os_error_t result = m_capture.stop();
+    char summary[160];
+    m_capture.formatSummary(summary, sizeof(summary));
+    addToTerminal(summary, false);
+    if (m_captureLabel) {
+        lv_label_set_text(m_captureLabel, summary);
+    }
+    return result;
+}
+
+os_error_t RS485TerminalApp::setModbusMode(bool enabled) {
+    if (!m_rs485Initialized) {
+        return OS_ERROR_NOT_AVAILABLE;
+    }
+
+    // Wake the UART task so it switches without waiting out its timeout
+    m_modbusRequested = enabled;
+    uart_event_t wake = {};
+    wake.type = UART_EVENT_MAX;
+    xQueueSend(m_uartQueue, &wake, 0);
+
+    addToTerminal(enabled ? "Modbus master: <slave> <function> <address> <count> [interval ms], or clear"
+                          : "Modbus master stopped", false);
+    return OS_OK;
+}
+
+void RS485TerminalApp::applyModbusMode(bool enabled) {
+    if (enabled) {
+        os_error_t result = m_modbus.begin(UART_PORT, (uint32_t)m_config.baudRate,
+                                           getBitsPerChar(), RS485_DE_PIN);
+        if (result != OS_OK) {
+            log(ESP_LOG_ERROR, "Failed to start Modbus master");
+            m_modbusRequested = false;
+            return;
+        }
+        m_modbusMode = true;
+    } else {
+        m_modbus.end();
+        m_modbusMode = false;
+        uart_set_rx_timeout(UART_PORT, UART_RX_TIMEOUT_SYMBOLS);
+        configureDirectionPin();
+        gpio_set_level(RS485_DE_PIN, 0);
+    }
+    log(ESP_LOG_INFO, "Modbus master %s", enabled ? "started" : "stopped");
+}
+
+void RS485TerminalApp::processModbusResults() {
+    size_t count = m_modbus.getPollCount();
+    m_modbusShown.resize(count, 0);
+
+    // Only results that changed since the last frame
+    ModbusResult result;
+    for (size_t i = 0; i < count && m_modbus.getResult(i, result); i++) {
+        if (result.sequence == m_modbusShown[i]) {
+            continue;
+        }
+        m_modbusShown[i] = result.sequence;
+
+        char line[768];
+        int length = snprintf(line, sizeof(line), "MB %u/%02X @%u:", result.poll.slaveId,
+                              (unsigned)result.poll.function, result.poll.address);
+        if (result.exception) {
+            snprintf(line + length, sizeof(line) - length, " exception %u", result.exception);
+        } else {
+            for (size_t v = 0; v < result.valueCount && length < (int)sizeof(line) - 8; v++) {
+                length += snprintf(line + length, sizeof(line) - length, " %u", result.values[v]);
+            }
+        }
+        addToTerminal(line, false);
+    }
+}
+
+void RS485TerminalApp::handleModbusCommand(const char* text) {
+    if (strcmp(text, "clear") == 0) {
+        m_modbus.clearPolls();
+        m_modbusShown.clear();
+        addToTerminal("Modbus poll list cleared", true);
+        return;
+    }
+
+    unsigned slave = 0, function = 0, address = 0, count = 0, interval = 1000;
+    if (sscanf(text, "%u %u %u %u %u", &slave, &function, &address, &count, &interval) < 4 ||
+        function < 1 || function > 4 || slave > 0xFF || address > 0xFFFF || count > 0xFFFF) {
+        addToTerminal("Usage: <slave> <function 1-4> <address> <count> [interval ms]", true);
+        return;
+    }
+
+    ModbusPoll poll;
+    poll.slaveId = (uint8_t)slave;
+    poll.function = (ModbusFunction)function;
+    poll.address = (uint16_t)address;
+    poll.count = (uint16_t)count;
+    poll.intervalMs = interval;
+
+    char line[96];
+    uint32_t pollId = m_modbus.addPoll(poll);
+    if (pollId) {
+        snprintf(line, sizeof(line), "Poll %u: slave %u function %u @%u x%u every %u ms",
+                 pollId, slave, function, address, count, interval);
+    } else {
+        snprintf(line, sizeof(line), "Poll rejected (invalid request or list full)");
+    }
+    addToTerminal(line, true);
+}
+
+os_error_t RS485TerminalApp::configureDirectionPin() {
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.mode = GPIO_MODE_OUTPUT;
+    io_conf.pin_bit_mask = 1ULL << RS485_DE_PIN;
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        log(ESP_LOG_ERROR, "Failed to configure RS-485 DE pin: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+    return OS_OK;
+}
+
+uint8_t RS485TerminalApp::getBitsPerChar() const {
+    // Start bit, 5-8 data bits, optional parity, stop bits (1.5 rounds up)
+    uint8_t bits = 1 + 5 + (uint8_t)m_config.dataBits;
+    if (m_config.parity != RS485Parity::PARITY_NONE) {
+        bits++;
+    }
+    bits += m_config.stopBits == RS485StopBits::STOP_1_BIT ? 1 : 2;
+    return bits;
 }
 
 void RS485TerminalApp::createTerminalUI() {
@@ -347,16 +569,12 @@ void RS485TerminalApp::createTerminalUI() {
     lv_obj_set_style_border_color(m_terminalContainer, lv_color_white(), 0);
     lv_obj_set_style_border_width(m_terminalContainer, 1, 0);
 
-    // Create terminal text area (output)
-    m_terminalTextArea = lv_textarea_create(m_terminalContainer);
-    lv_obj_set_size(m_terminalTextArea, LV_HOR_RES - 220, LV_VER_RES - 220);
-    lv_obj_align(m_terminalTextArea, LV_ALIGN_TOP_LEFT, 5, 5);
-    lv_textarea_set_text(m_terminalTextArea, "RS-485 Terminal Ready\n");
-    lv_obj_set_style_bg_color(m_terminalTextArea, lv_color_black(), 0);
-    lv_obj_set_style_text_color(m_terminalTextArea, lv_color_hex(0x00FF00), 0);
-    lv_obj_set_style_text_font(m_terminalTextArea, &lv_font_montserrat_12, 0);
-    // Hide cursor by setting it to last position
-    lv_textarea_set_cursor_pos(m_terminalTextArea, LV_TEXTAREA_CURSOR_LAST);
+    // Terminal output; shows the scrollback kept while the UI was closed
+    lv_obj_t* output = m_terminal.create(m_terminalContainer, LV_HOR_RES - 220, LV_VER_RES - 220,
+                                         &lv_font_montserrat_12, lv_color_hex(0x00FF00));
+    if (output) {
+        lv_obj_align(output, LV_ALIGN_TOP_LEFT, 5, 5);
+    }
 
     // Create input text area
     m_inputTextArea = lv_textarea_create(m_uiContainer);
@@ -426,61 +644,119 @@ void RS485TerminalApp::createControlPanel() {
     lv_obj_t* modeLabel = lv_label_create(m_modeButton);
     lv_label_set_text(modeLabel, "ASCII");
     lv_obj_center(modeLabel);
+
+    // Modbus button (raw terminal / Modbus master toggle)
+    m_modbusButton = lv_btn_create(m_controlPanel);
+    lv_obj_set_size(m_modbusButton, 160, 40);
+    lv_obj_align(m_modbusButton, LV_ALIGN_TOP_MID, 0, 270);
+    lv_obj_add_event_cb(m_modbusButton, modbusButtonCallback, LV_EVENT_CLICKED, this);
+
+    lv_obj_t* modbusLabel = lv_label_create(m_modbusButton);
+    lv_label_set_text(modbusLabel, m_modbusRequested ? "MODBUS" : "RAW");
+    lv_obj_center(modbusLabel);
+
+    // Capture button (headless logging to storage)
+    m_captureButton = lv_btn_create(m_controlPanel);
+    lv_obj_set_size(m_captureButton, 160, 40);
+    lv_obj_align(m_captureButton, LV_ALIGN_TOP_MID, 0, 320);
+    lv_obj_add_event_cb(m_captureButton, captureButtonCallback, LV_EVENT_CLICKED, this);
+
+    lv_obj_t* captureText = lv_label_create(m_captureButton);
+    lv_label_set_text(captureText, m_capture.isActive() ? "STOP CAPTURE" : "CAPTURE");
+    lv_obj_center(captureText);
+
+    // Capture counters
+    m_captureLabel = lv_label_create(m_controlPanel);
+    lv_obj_set_width(m_captureLabel, 160);
+    lv_label_set_long_mode(m_captureLabel, LV_LABEL_LONG_WRAP);
+    lv_label_set_text(m_captureLabel, "");
+    lv_obj_set_style_text_color(m_captureLabel, lv_color_white(), 0);
+    lv_obj_align(m_captureLabel, LV_ALIGN_TOP_MID, 0, 370);
 }
 
 void RS485TerminalApp::processReceivedData() {
-    size_t length;
-    uart_get_buffered_data_len(UART_PORT, &length);
-    
-    if (length > 0) {
-        if (length > m_rxBufferSize) {
-            length = m_rxBufferSize;
+    size_t queued = m_rxRing.available();
+    if (queued == 0) {
+        return;
+    }
+    m_ringHighWater = std::max(m_ringHighWater, queued);
+
+    // Bounded per frame; the rest waits in the ring for the next update()
+    uint8_t chunk[RX_LINE_BYTES];
+    size_t budget = RX_FRAME_BUDGET;
+    while (budget > 0) {
+        size_t bytesRead = m_rxRing.read(chunk, std::min(budget, sizeof(chunk)));
+        if (bytesRead == 0) {
+            break;
         }
-        
-        int bytesRead = uart_read_bytes(UART_PORT, m_rxBuffer, length, pdMS_TO_TICKS(10));
-        if (bytesRead > 0) {
-            // Update statistics
-            m_bytesReceived += bytesRead;
-            m_packetsReceived++;
-            
-            // Add to terminal display
-            char displayBuffer[512];
-            formatDataForDisplay(m_rxBuffer, bytesRead, displayBuffer, sizeof(displayBuffer));
-            addToTerminal(displayBuffer, false);
+        budget -= bytesRead;
+        m_packetsReceived++;
+
+        char displayBuffer[512];
+        formatDataForDisplay(chunk, bytesRead, displayBuffer, sizeof(displayBuffer));
+        addToTerminal(displayBuffer, false);
+    }
+
+    // More than one frame's worth left over: come back without sleeping
+    if (m_rxRing.available() > 0) {
+        OS().wake();
+    }
+}
+
+void RS485TerminalApp::receiveFromDriver(size_t length) {
+    // Drain everything buffered, not just the announced bytes, so a burst
+    // never leaves data behind in the driver's ring
+    size_t buffered = 0;
+    uart_get_buffered_data_len(UART_PORT, &buffered);
+    length = std::max(length, buffered);
+
+    bool overflowed = false;
+    while (length > 0) {
+        int bytesRead = uart_read_bytes(UART_PORT, m_rxBuffer, std::min(length, m_rxBufferSize), 0);
+        if (bytesRead <= 0) {
+            break;
         }
+        length -= bytesRead;
+        m_bytesReceived += bytesRead;
+
+        // Capture bypasses the ring and the display entirely
+        if (m_capture.isActive()) {
+            m_capture.record(false, m_rxBuffer, bytesRead);
+            continue;
+        }
+
+        size_t written = m_rxRing.write(m_rxBuffer, bytesRead);
+        if (written < (size_t)bytesRead) {
+            m_bytesDropped += bytesRead - written;
+            overflowed = true;
+        }
+    }
+
+    if (overflowed) {
+        m_ringOverflows++;
+    }
+    if (m_rxRing.available() > 0) {
+        OS().wake();
     }
 }
 
 void RS485TerminalApp::addToTerminal(const char* text, bool isTransmitted) {
-    if (!m_terminalTextArea || !text) {
+    if (!text) {
         return;
     }
 
-    // Get current time for timestamp
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    struct tm* timeinfo = localtime(&tv.tv_sec);
-    
-    char timestamp[32];
-    if (m_showTimestamp) {
-        snprintf(timestamp, sizeof(timestamp), "[%02d:%02d:%02d.%03ld] ", 
-                timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, tv.tv_usec / 1000);
-    } else {
-        timestamp[0] = '\0';
-    }
-
-    // Format the line with direction indicator
+    // Timestamp and direction indicator, then the text
     char line[1024];
-    snprintf(line, sizeof(line), "%s%s %s\n", 
-            timestamp, isTransmitted ? "TX:" : "RX:", text);
+    size_t length = m_showTimestamp ? m_timestamp.format(line) : 0;
+    memcpy(line + length, isTransmitted ? "TX: " : "RX: ", 4);
+    length += 4;
 
-    // Add to text area
-    lv_textarea_add_text(m_terminalTextArea, line);
+    size_t textLength = std::min(strlen(text), sizeof(line) - length);
+    memcpy(line + length, text, textLength);
+    length += textLength;
 
-    // Auto-scroll to bottom if enabled
-    if (m_autoScroll) {
-        lv_textarea_set_cursor_pos(m_terminalTextArea, LV_TEXTAREA_CURSOR_LAST);
-    }
+    // Stored in the scrollback; drawn by the next refresh()
+    m_terminal.appendText(line, length);
 }
 
 void RS485TerminalApp::formatDataForDisplay(const uint8_t* data, size_t length, 
@@ -490,21 +766,10 @@ void RS485TerminalApp::formatDataForDisplay(const uint8_t* data, size_t length,
     }
 
     if (m_hexDisplay) {
-        // Format as hex
-        size_t pos = 0;
-        for (size_t i = 0; i < length && pos < bufferSize - 4; i++) {
-            pos += snprintf(buffer + pos, bufferSize - pos, "%02X ", data[i]);
-        }
-        if (pos > 0 && pos < bufferSize) {
-            buffer[pos - 1] = '\0'; // Remove trailing space
-        }
+        HexFormat::hex(data, length, buffer, bufferSize);
     } else {
-        // Format as ASCII (with printable character substitution)
-        size_t copyLength = (length < bufferSize - 1) ? length : bufferSize - 1;
-        for (size_t i = 0; i < copyLength; i++) {
-            buffer[i] = (data[i] >= 32 && data[i] <= 126) ? data[i] : '.';
-        }
-        buffer[copyLength] = '\0';
+        // Unprintable characters shown as '.'
+        HexFormat::ascii(data, length, buffer, bufferSize);
     }
 }
 
@@ -513,8 +778,12 @@ void RS485TerminalApp::sendButtonCallback(lv_event_t* e) {
     if (app && app->m_inputTextArea) {
         const char* text = lv_textarea_get_text(app->m_inputTextArea);
         if (text && strlen(text) > 0) {
-            app->sendString(text);
-            app->sendString("\r\n"); // Add CRLF
+            if (app->m_modbusRequested) {
+                app->handleModbusCommand(text);
+            } else {
+                app->sendString(text);
+                app->sendString("\r\n"); // Add CRLF
+            }
             lv_textarea_set_text(app->m_inputTextArea, ""); // Clear input
         }
     }
@@ -561,14 +830,103 @@ void RS485TerminalApp::modeButtonCallback(lv_event_t* e) {
     }
 }
 
+void RS485TerminalApp::modbusButtonCallback(lv_event_t* e) {
+    RS485TerminalApp* app = static_cast<RS485TerminalApp*>(lv_event_get_user_data(e));
+    if (app && app->m_modbusButton) {
+        bool enabled = !app->m_modbusRequested;
+        if (app->setModbusMode(enabled) != OS_OK) {
+            return;
+        }
+
+        lv_obj_t* label = lv_obj_get_child(app->m_modbusButton, 0);
+        if (label) {
+            lv_label_set_text(label, enabled ? "MODBUS" : "RAW");
+        }
+    }
+}
+
+void RS485TerminalApp::captureButtonCallback(lv_event_t* e) {
+    RS485TerminalApp* app = static_cast<RS485TerminalApp*>(lv_event_get_user_data(e));
+    if (app && app->m_captureButton) {
+        if (app->m_capture.isActive()) {
+            app->stopCapture();
+        } else {
+            app->startCapture();
+        }
+
+        lv_obj_t* label = lv_obj_get_child(app->m_captureButton, 0);
+        if (label) {
+            lv_label_set_text(label, app->m_capture.isActive() ? "STOP CAPTURE" : "CAPTURE");
+        }
+    }
+}
+
 void RS485TerminalApp::uartTask(void* parameter) {
     RS485TerminalApp* app = static_cast<RS485TerminalApp*>(parameter);
-    
+    uart_event_t event;
+
     while (app->m_taskRunning) {
-        // This task handles background UART processing if needed
-        // Main processing is done in processReceivedData()
-        vTaskDelay(pdMS_TO_TICKS(50));
+        // Mode changes happen here, so the bus never switches mid-frame
+        if (app->m_modbusRequested != app->m_modbusMode) {
+            app->applyModbusMode(app->m_modbusRequested);
+        }
+
+        // The master decides when the next poll or timeout is due; the
+        // 100 ms cap only bounds how long shutdown() waits for the task
+        TickType_t wait = pdMS_TO_TICKS(100);
+        if (app->m_modbusMode) {
+            wait = std::min(wait, app->m_modbus.service());
+        }
+        if (xQueueReceive(app->m_uartQueue, &event, wait) != pdTRUE) {
+            continue;
+        }
+
+        OS_TRACE_SCOPE_ARG("rs485_event", event.type);
+        switch (event.type) {
+            case UART_DATA:
+                if (app->m_modbusMode) {
+                    // timeout_flag marks t3.5 of line idle: the frame is complete
+                    app->m_modbus.onData(event.size, event.timeout_flag);
+                } else {
+                    app->receiveFromDriver(event.size);
+                }
+                break;
+
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // Hardware or driver buffer overran; what is left is torn, drop it
+                if (event.type == UART_FIFO_OVF) {
+                    app->m_fifoOverflows++;
+                } else {
+                    app->m_bufferFull++;
+                }
+                app->m_errorCount++;
+                app->m_modbus.onLineError();
+                uart_flush_input(UART_PORT);
+                xQueueReset(app->m_uartQueue);
+                break;
+
+            case UART_BREAK:
+                app->m_breaks++;
+                break;
+
+            case UART_PARITY_ERR:
+                app->m_parityErrors++;
+                app->m_errorCount++;
+                app->m_modbus.onLineError();
+                break;
+
+            case UART_FRAME_ERR:
+                app->m_frameErrors++;
+                app->m_errorCount++;
+                app->m_modbus.onLineError();
+                break;
+
+            default:
+                break;
+        }
     }
-    
+
+    app->m_uartTaskHandle = nullptr;
     vTaskDelete(NULL);
 }
\ No newline at end of file
@@ -3,7 +3,14 @@
 
 #include "base_app.h"
 #include "../hal/hardware_config.h"
+#include "../system/byte_ring.h"
+#include "../system/hex_format.h"
+#include "../system/modbus_master.h"
+#include "../system/serial_capture.h"
+#include "../ui/terminal_view.h"
 #include <driver/uart.h>
+#include <atomic>
+#include <vector>
 
 /**
  * @file rs485_terminal_app.h
@@ -11,6 +18,20 @@
  * 
  * Provides RS-485 communication terminal with data monitoring,
  * command sending, and protocol analysis capabilities.
+ *
+ * Reception runs entirely on the UART task: it waits on the driver's
+ * event queue, drains the driver buffer on UART_DATA and pushes the bytes
+ * into a PSRAM ring. update() consumes the ring in bounded batches on the
+ * UI thread, so a slow frame delays the display but never loses data.
+ * Output goes into a bounded PSRAM scrollback rendered by TerminalView.
+ *
+ * In Modbus mode the same task drives a ModbusMaster instead: UART_DATA
+ * events feed the response frame and the task wakes when the next poll is
+ * due. Raw sends are refused while the master owns the bus, and changed
+ * poll results are printed to the terminal.
+ *
+ * Capture mode logs raw traffic to a SerialCapture file straight from the
+ * UART task; nothing is formatted or drawn and the panel shows counters.
  */
 
 enum class RS485BaudRate {
@@ -101,6 +122,46 @@ public:
      */
     void setTransmitMode(bool transmit);
 
+    /**
+     * @brief Switch between raw terminal and Modbus RTU master mode
+     *
+     * Takes effect on the UART task, between transactions.
+     * @param enabled true to poll the Modbus list
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setModbusMode(bool enabled);
+
+    /**
+     * @brief Check if the Modbus master owns the bus
+     * @return true in Modbus mode
+     */
+    bool isModbusMode() const { return m_modbusMode; }
+
+    /**
+     * @brief Get the Modbus master (poll list and results)
+     * @return Modbus master reference
+     */
+    ModbusMaster& getModbus() { return m_modbus; }
+
+    /**
+     * @brief Log raw traffic to storage instead of the terminal
+     * @param path Log path; nullptr for a new file in OS_CAPTURE_DIR
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t startCapture(const char* path = nullptr);
+
+    /**
+     * @brief Close the capture log and resume the terminal display
+     * @return OS_OK on success, error code if the log is incomplete
+     */
+    os_error_t stopCapture();
+
+    /**
+     * @brief Check if traffic is being captured
+     * @return true while capturing
+     */
+    bool isCapturing() const { return m_capture.isActive(); }
+
     /**
      * @brief Get RS-485 statistics
      */
@@ -118,10 +179,48 @@ private:
     void createControlPanel();
 
     /**
-     * @brief Process received data
+     * @brief Display a batch of received data from the RX ring
      */
     void processReceivedData();
 
+    /**
+     * @brief Drain the UART driver buffer into the RX ring (UART task)
+     * @param length Bytes announced by the UART_DATA event
+     */
+    void receiveFromDriver(size_t length);
+
+    /**
+     * @brief Enter or leave Modbus mode (UART task)
+     * @param enabled true to hand the bus to the Modbus master
+     */
+    void applyModbusMode(bool enabled);
+
+    /**
+     * @brief Print poll results that changed since the last update
+     */
+    void processModbusResults();
+
+    /**
+     * @brief Handle a Modbus command typed into the input field
+     *
+     * "<slave> <function> <address> <count> [interval ms]" adds a poll,
+     * "clear" empties the list.
+     * @param text Command text
+     */
+    void handleModbusCommand(const char* text);
+
+    /**
+     * @brief Put the DE pin under GPIO control
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t configureDirectionPin();
+
+    /**
+     * @brief Get the character length of the current line settings
+     * @return Start + data + parity + stop bits
+     */
+    uint8_t getBitsPerChar() const;
+
     /**
      * @brief Add text to terminal display
      * @param text Text to add
@@ -144,8 +243,10 @@ private:
     static void clearButtonCallback(lv_event_t* e);
     static void configButtonCallback(lv_event_t* e);
     static void modeButtonCallback(lv_event_t* e);
+    static void modbusButtonCallback(lv_event_t* e);
+    static void captureButtonCallback(lv_event_t* e);
 
-    // UART task for background processing
+    // UART task: waits on driver events and fills the RX ring
     static void uartTask(void* parameter);
 
     // RS-485 configuration
@@ -155,44 +256,76 @@ private:
 
     // UI elements
     lv_obj_t* m_terminalContainer = nullptr;
-    lv_obj_t* m_terminalTextArea = nullptr;
     lv_obj_t* m_inputTextArea = nullptr;
     lv_obj_t* m_controlPanel = nullptr;
     lv_obj_t* m_sendButton = nullptr;
     lv_obj_t* m_clearButton = nullptr;
     lv_obj_t* m_configButton = nullptr;
     lv_obj_t* m_modeButton = nullptr;
+    lv_obj_t* m_modbusButton = nullptr;
+    lv_obj_t* m_captureButton = nullptr;
+    lv_obj_t* m_captureLabel = nullptr;
     lv_obj_t* m_statusLabel = nullptr;
     lv_obj_t* m_configLabel = nullptr;
 
-    // Communication buffers
+    // Communication buffers (m_rxBuffer is UART task scratch)
     uint8_t* m_rxBuffer = nullptr;
     uint8_t* m_txBuffer = nullptr;
     size_t m_rxBufferSize = 0;
     size_t m_txBufferSize = 0;
+    uint8_t* m_rxRingStorage = nullptr;
+    ByteRing m_rxRing;
+
+    // Scrollback and its virtualized view
+    TerminalView m_terminal;
+    QueueHandle_t m_uartQueue = nullptr;
 
-    // Statistics
-    uint32_t m_bytesReceived = 0;
+    // Statistics (RX counters are written by the UART task)
+    std::atomic<uint32_t> m_bytesReceived{0};
     uint32_t m_bytesTransmitted = 0;
     uint32_t m_packetsReceived = 0;
     uint32_t m_packetsTransmitted = 0;
-    uint32_t m_errorCount = 0;
+    std::atomic<uint32_t> m_errorCount{0};
+    std::atomic<uint32_t> m_ringOverflows{0};
+    std::atomic<uint32_t> m_bytesDropped{0};
+    std::atomic<uint32_t> m_fifoOverflows{0};
+    std::atomic<uint32_t> m_bufferFull{0};
+    std::atomic<uint32_t> m_breaks{0};
+    std::atomic<uint32_t> m_parityErrors{0};
+    std::atomic<uint32_t> m_frameErrors{0};
+    size_t m_ringHighWater = 0;
+
+    // Modbus master mode (switched on the UART task)
+    ModbusMaster m_modbus;
+    volatile bool m_modbusMode = false;
+    volatile bool m_modbusRequested = false;
+    std::vector<uint32_t> m_modbusShown;    // Result sequence printed per poll
+
+    // Headless capture (records from the UART task)
+    SerialCapture m_capture;
+    uint32_t m_captureShownMs = 0;
 
     // Task management
     TaskHandle_t m_uartTaskHandle = nullptr;
-    bool m_taskRunning = false;
+    volatile bool m_taskRunning = false;
 
     // Display settings
     bool m_hexDisplay = false;
     bool m_showTimestamp = true;
     bool m_autoScroll = true;
+    TimestampPrefix m_timestamp;
 
     // Configuration
     static constexpr uart_port_t UART_PORT = UART_NUM_2;
     static constexpr size_t RX_BUFFER_SIZE = 2048;
     static constexpr size_t TX_BUFFER_SIZE = 1024;
-    static constexpr size_t TERMINAL_BUFFER_SIZE = 8192;
+    static constexpr size_t RX_RING_SIZE = 64 * 1024;     // ~5 s at 115200 baud
+    static constexpr size_t RX_FRAME_BUDGET = 2048;       // Bytes displayed per update()
+    static constexpr size_t RX_LINE_BYTES = 128;          // Raw bytes per terminal line
+    static constexpr int UART_EVENT_QUEUE_DEPTH = 20;
+    static constexpr uint8_t UART_RX_TIMEOUT_SYMBOLS = 10; // Idle time before a UART_DATA event
     static constexpr uint32_t UART_TASK_STACK_SIZE = 4096;
+    static constexpr uint32_t CAPTURE_SUMMARY_MS = 500;   // Counter refresh while capturing
     static constexpr UBaseType_t UART_TASK_PRIORITY = 5;
 };
 
@@ -7,7 +7,7 @@
 
 TaskManagementApp::TaskManagementApp() 
     : BaseApp("com.m5stack.tasks", "Tasks", "1.0.0"), 
-      m_nextTaskId(1), m_selectedTaskId(0),
+      m_selectedTaskId(0),
       m_statusFilter(TaskStatus::TODO), m_priorityFilter(TaskPriority::TASK_LOW),
       m_showCompleted(false), m_selectedDueDate(0), m_selectedReminderTime(0) {
     setDescription("Task management application with to-do lists and prioritization");
@@ -37,9 +37,13 @@ os_error_t TaskManagementApp::initialize() {
 }
 
 os_error_t TaskManagementApp::update(uint32_t deltaTime) {
+    if (m_taskList) {
+        m_taskView.refresh(deltaTime);
+    }
+
     // Check for reminder notifications
     time_t currentTime = time(nullptr);
-    for (const auto& task : m_tasks) {
+    for (const auto& task : m_store.getTasks()) {
         if (task.hasReminder && task.status != TaskStatus::COMPLETED && 
             task.reminderTime > 0 && currentTime >= task.reminderTime) {
             // Trigger reminder notification
@@ -88,6 +92,7 @@ os_error_t TaskManagementApp::destroyUI() {
     if (m_uiContainer) {
         lv_obj_del(m_uiContainer);
         m_uiContainer = nullptr;
+        m_taskList = nullptr;
     }
     return OS_OK;
 }
@@ -200,8 +205,11 @@ void TaskManagementApp::createToolbar() {
 }
 
 void TaskManagementApp::createTaskList() {
-    m_taskList = lv_list_create(m_uiContainer);
-    lv_obj_set_size(m_taskList, LV_PCT(50), LV_PCT(100) - 110);
+    // A pool of rows rebound as the list scrolls, over the store's view
+    m_taskView.setBindCallback([this](size_t index, const VirtualListRow& row) { bindTaskRow(index, row); });
+    m_taskView.setClickCallback([this](size_t index) { selectTask(index); });
+    m_taskList = m_taskView.create(m_uiContainer, (LV_HOR_RES - 20) / 2, LV_VER_RES - 100 - 20 - 110,
+                                   OS_TASK_ROW_HEIGHT);
     lv_obj_align_to(m_taskList, m_toolbar, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 5);
     lv_obj_set_style_bg_color(m_taskList, lv_color_hex(0x2C2C2C), 0);
 }
@@ -215,51 +223,80 @@ void TaskManagementApp::createTaskDetails() {
 }
 
 void TaskManagementApp::refreshTaskList() {
-    lv_obj_clean(m_taskList);
-    
-    // Apply filters and sorting
-    filterTasks();
-    sortTasks();
-    
-    for (const auto& task : m_filteredTasks) {
-        // Create task item
-        std::string itemText = task.title;
-        if (task.status == TaskStatus::COMPLETED) {
-            itemText = LV_SYMBOL_OK " " + itemText;
-        } else if (task.status == TaskStatus::IN_PROGRESS) {
-            itemText = LV_SYMBOL_PLAY " " + itemText;
-        } else {
-            itemText = LV_SYMBOL_BULLET " " + itemText;
-        }
-        
-        lv_obj_t* btn = lv_list_add_btn(m_taskList, nullptr, itemText.c_str());
-        lv_obj_set_user_data(btn, (void*)(uintptr_t)task.id);
-        lv_obj_add_event_cb(btn, taskListCallback, LV_EVENT_CLICKED, this);
-        
-        // Set priority color
-        lv_color_t priorityColor = getPriorityColor(task.priority);
-        lv_obj_set_style_border_color(btn, priorityColor, 0);
-        lv_obj_set_style_border_width(btn, 3, 0);
-        lv_obj_set_style_border_side(btn, LV_BORDER_SIDE_LEFT, 0);
-        
-        // Add due date if set
-        if (task.dueDate > 0) {
-            struct tm* timeinfo = localtime(&task.dueDate);
-            char dateStr[32];
-            strftime(dateStr, sizeof(dateStr), "%m/%d", timeinfo);
-            
-            lv_obj_t* dateLabel = lv_label_create(btn);
-            lv_label_set_text(dateLabel, dateStr);
-            lv_obj_align(dateLabel, LV_ALIGN_BOTTOM_RIGHT, -5, -2);
-            lv_obj_set_style_text_color(dateLabel, lv_color_hex(0x95A5A6), 0);
-            lv_obj_set_style_text_font(dateLabel, &lv_font_montserrat_12, 0);
-        }
-        
-        // Strike through completed tasks
-        if (task.status == TaskStatus::COMPLETED) {
-            lv_obj_set_style_text_decor(btn, LV_TEXT_DECOR_STRIKETHROUGH, 0);
-            lv_obj_set_style_text_color(btn, lv_color_hex(0x7F8C8D), 0);
-        }
+    // Filter and order come from the dropdowns; the store filters its
+    // maintained order for the key, nothing is sorted here
+    TaskFilter filter;
+    filter.status = (int)lv_dropdown_get_selected(m_statusFilterDropdown) - 1;
+    filter.priority = (int)lv_dropdown_get_selected(m_priorityFilterDropdown) - 1;
+    filter.showCompleted = m_showCompleted;
+    m_store.setView((TaskSort)lv_dropdown_get_selected(m_sortDropdown), filter);
+
+    if (m_taskList) {
+        m_taskView.reset(m_store.getViewSize());
+        m_taskView.setSelected(m_store.getViewRow(m_selectedTaskId));
+    }
+}
+
+void TaskManagementApp::applyViewChange(const TaskViewChange& change) {
+    if (!m_taskList) {
+        return;
+    }
+
+    // Rows from the first touched to the last shifted by one; a task that
+    // stayed in place only changes its own row
+    size_t count = m_store.getViewSize();
+    if (change.removed >= 0 || change.inserted >= 0) {
+        int first = change.removed < 0 ? change.inserted :
+                    change.inserted < 0 ? change.removed : std::min(change.removed, change.inserted);
+        size_t last = change.removed >= 0 && change.inserted >= 0 ?
+                      (size_t)std::max(change.removed, change.inserted) + 1 : count;
+        m_taskView.setCount(count);
+        m_taskView.invalidate((size_t)first, last);
+    }
+    m_taskView.setSelected(m_store.getViewRow(m_selectedTaskId));
+}
+
+void TaskManagementApp::bindTaskRow(size_t index, const VirtualListRow& row) {
+    const AppTask& task = m_store.getViewTask(index);
+    if (task.status == TaskStatus::COMPLETED) {
+        lv_label_set_text_static(row.icon, LV_SYMBOL_OK);
+    } else if (task.status == TaskStatus::IN_PROGRESS) {
+        lv_label_set_text_static(row.icon, LV_SYMBOL_PLAY);
+    } else {
+        lv_label_set_text_static(row.icon, LV_SYMBOL_BULLET);
+    }
+    lv_label_set_text(row.text, task.title.c_str());
+
+    // Set priority color
+    lv_obj_set_style_border_color(row.object, getPriorityColor(task.priority), 0);
+    lv_obj_set_style_border_width(row.object, 3, 0);
+    lv_obj_set_style_border_side(row.object, LV_BORDER_SIDE_LEFT, 0);
+
+    // Due date if set
+    char dateStr[32] = "";
+    if (task.dueDate > 0) {
+        struct tm timeinfo;
+        localtime_r(&task.dueDate, &timeinfo);
+        strftime(dateStr, sizeof(dateStr), "%m/%d", &timeinfo);
+    }
+    lv_label_set_text(row.detail, dateStr);
+
+    // Strike through completed tasks; rows are reused, so undo it otherwise
+    if (task.status == TaskStatus::COMPLETED) {
+        lv_obj_set_style_text_decor(row.text, LV_TEXT_DECOR_STRIKETHROUGH, 0);
+        lv_obj_set_style_text_color(row.text, lv_color_hex(0x7F8C8D), 0);
+    } else {
+        lv_obj_set_style_text_decor(row.text, LV_TEXT_DECOR_NONE, 0);
+        lv_obj_set_style_text_color(row.text, lv_color_white(), 0);
+    }
+}
+
+void TaskManagementApp::selectTask(size_t index) {
+    if (index < m_store.getViewSize()) {
+        const AppTask& task = m_store.getViewTask(index);
+        m_selectedTaskId = task.id;
+        m_taskView.setSelected((int)index);
+        showTaskDetails(task);
     }
 }
 
@@ -429,7 +466,7 @@ void TaskManagementApp::createAddEditDialog() {
     }
 }
 
-void TaskManagementApp::showAddEditDialog(AppTask* task) {
+void TaskManagementApp::showAddEditDialog(const AppTask* task) {
     m_editingTask = task;
     createAddEditDialog();
 }
@@ -442,96 +479,45 @@ void TaskManagementApp::hideAddEditDialog() {
     }
 }
 
-void TaskManagementApp::filterTasks() {
-    m_filteredTasks.clear();
-    
-    for (const auto& task : m_tasks) {
-        bool includeTask = true;
-        
-        // Status filter
-        if (lv_dropdown_get_selected(m_statusFilterDropdown) > 0) {
-            TaskStatus filterStatus = (TaskStatus)(lv_dropdown_get_selected(m_statusFilterDropdown) - 1);
-            if (task.status != filterStatus) {
-                includeTask = false;
-            }
-        }
-        
-        // Priority filter
-        if (lv_dropdown_get_selected(m_priorityFilterDropdown) > 0) {
-            TaskPriority filterPriority = (TaskPriority)(lv_dropdown_get_selected(m_priorityFilterDropdown) - 1);
-            if (task.priority != filterPriority) {
-                includeTask = false;
-            }
-        }
-        
-        // Hide completed tasks if needed
-        if (!m_showCompleted && task.status == TaskStatus::COMPLETED) {
-            includeTask = false;
-        }
-        
-        if (includeTask) {
-            m_filteredTasks.push_back(task);
-        }
-    }
-}
-
-void TaskManagementApp::sortTasks() {
-    uint16_t sortOption = lv_dropdown_get_selected(m_sortDropdown);
-    
-    std::sort(m_filteredTasks.begin(), m_filteredTasks.end(), 
-              [sortOption](const AppTask& a, const AppTask& b) {
-        switch (sortOption) {
-            case 0: // Due Date
-                if (a.dueDate == 0 && b.dueDate == 0) return a.createdDate > b.createdDate;
-                if (a.dueDate == 0) return false;
-                if (b.dueDate == 0) return true;
-                return a.dueDate < b.dueDate;
-            case 1: // Priority
-                return a.priority > b.priority;
-            case 2: // Created
-                return a.createdDate > b.createdDate;
-            case 3: // Title
-                return a.title < b.title;
-            default:
-                return false;
-        }
-    });
-}
-
 void TaskManagementApp::addTask(const AppTask& task) {
     AppTask newTask = task;
-    newTask.id = m_nextTaskId++;
     newTask.createdDate = time(nullptr);
+    newTask.completedDate = 0;
     newTask.status = TaskStatus::TODO;
-    m_tasks.push_back(newTask);
+    TaskViewChange change;
+    m_store.add(newTask, change);
     saveTasks();
-    refreshTaskList();
+    applyViewChange(change);
 }
 
 void TaskManagementApp::editTask(uint32_t taskId, const AppTask& task) {
-    for (auto& t : m_tasks) {
-        if (t.id == taskId) {
-            t.title = task.title;
-            t.description = task.description;
-            t.priority = task.priority;
-            t.category = task.category;
-            t.dueDate = task.dueDate;
-            t.hasReminder = task.hasReminder;
-            t.reminderTime = task.reminderTime;
-            break;
-        }
+    const AppTask* existing = m_store.find(taskId);
+    if (!existing) {
+        return;
     }
+    AppTask updated = *existing;
+    updated.title = task.title;
+    updated.description = task.description;
+    updated.priority = task.priority;
+    updated.category = task.category;
+    updated.dueDate = task.dueDate;
+    updated.hasReminder = task.hasReminder;
+    updated.reminderTime = task.reminderTime;
+
+    TaskViewChange change;
+    m_store.update(taskId, updated, change);
     saveTasks();
-    refreshTaskList();
+    applyViewChange(change);
+    if (taskId == m_selectedTaskId && m_detailsPanel) {
+        showTaskDetails(*m_store.find(taskId));
+    }
 }
 
 void TaskManagementApp::deleteTask(uint32_t taskId) {
-    m_tasks.erase(
-        std::remove_if(m_tasks.begin(), m_tasks.end(),
-                      [taskId](const AppTask& t) { return t.id == taskId; }),
-        m_tasks.end());
+    TaskViewChange change;
+    m_store.remove(taskId, change);
     saveTasks();
-    refreshTaskList();
+    applyViewChange(change);
     lv_obj_add_flag(m_detailsPanel, LV_OBJ_FLAG_HIDDEN);
     
     // Disable toolbar buttons
@@ -540,39 +526,73 @@ void TaskManagementApp::deleteTask(uint32_t taskId) {
     lv_obj_add_state(m_completeBtn, LV_STATE_DISABLED);
 }
 
+void TaskManagementApp::toggleTaskStatus(uint32_t taskId) {
+    const AppTask* task = m_store.find(taskId);
+    if (!task) {
+        return;
+    }
+
+    // To do, in progress, completed and round again
+    switch (task->status) {
+        case TaskStatus::TODO: setTaskStatus(taskId, TaskStatus::IN_PROGRESS); break;
+        case TaskStatus::IN_PROGRESS: setTaskStatus(taskId, TaskStatus::COMPLETED); break;
+        default: setTaskStatus(taskId, TaskStatus::TODO); break;
+    }
+}
+
 void TaskManagementApp::markTaskCompleted(uint32_t taskId) {
-    for (auto& task : m_tasks) {
-        if (task.id == taskId) {
-            task.status = TaskStatus::COMPLETED;
-            task.completedDate = time(nullptr);
-            break;
-        }
+    setTaskStatus(taskId, TaskStatus::COMPLETED);
+}
+
+void TaskManagementApp::setTaskStatus(uint32_t taskId, TaskStatus status) {
+    const AppTask* existing = m_store.find(taskId);
+    if (!existing || existing->status == status) {
+        return;
     }
+    AppTask updated = *existing;
+    updated.status = status;
+    updated.completedDate = status == TaskStatus::COMPLETED ? time(nullptr) : 0;
+
+    TaskViewChange change;
+    m_store.update(taskId, updated, change);
     saveTasks();
-    refreshTaskList();
+    applyViewChange(change);
+    if (taskId == m_selectedTaskId && m_detailsPanel) {
+        showTaskDetails(*m_store.find(taskId));
+    }
 }
 
 os_error_t TaskManagementApp::loadTasks() {
-    // Add some sample tasks
-    AppTask task1 = {m_nextTaskId++, "Review project proposal", "Check the new project proposal and provide feedback", 
+    os_error_t ret = m_store.load(OS_TASKS_PATH);
+    if (ret != OS_ERROR_NOT_FOUND) {
+        return ret;
+    }
+
+    // First start: add some sample tasks
+    AppTask task1 = {0, "Review project proposal", "Check the new project proposal and provide feedback", 
                   TaskPriority::TASK_HIGH, TaskStatus::TODO, 0, time(nullptr), 0, "Work", false, 0};
     
-    AppTask task2 = {m_nextTaskId++, "Grocery shopping", "Buy milk, bread, eggs, and fruits", 
+    AppTask task2 = {0, "Grocery shopping", "Buy milk, bread, eggs, and fruits", 
                   TaskPriority::TASK_MEDIUM, TaskStatus::TODO, 0, time(nullptr), 0, "Personal", false, 0};
     
-    AppTask task3 = {m_nextTaskId++, "Call dentist", "Schedule appointment for dental checkup", 
+    AppTask task3 = {0, "Call dentist", "Schedule appointment for dental checkup", 
                   TaskPriority::TASK_LOW, TaskStatus::COMPLETED, 0, time(nullptr) - 86400, time(nullptr), "Health", false, 0};
     
-    m_tasks.push_back(task1);
-    m_tasks.push_back(task2);
-    m_tasks.push_back(task3);
+    TaskViewChange change;
+    m_store.add(task1, change);
+    m_store.add(task2, change);
+    m_store.add(task3, change);
     
-    return OS_OK;
+    return saveTasks();
 }
 
 os_error_t TaskManagementApp::saveTasks() {
-    // In a real implementation, save to file system
-    return OS_OK;
+    // Appends only the changes since the last save
+    os_error_t ret = m_store.save();
+    if (ret != OS_OK) {
+        log(ESP_LOG_ERROR, "Failed to save tasks");
+    }
+    return ret;
 }
 
 std::string TaskManagementApp::priorityToString(TaskPriority priority) {
@@ -605,20 +625,6 @@ lv_color_t TaskManagementApp::getPriorityColor(TaskPriority priority) {
 }
 
 // Static callbacks
-void TaskManagementApp::taskListCallback(lv_event_t* e) {
-    TaskManagementApp* app = static_cast<TaskManagementApp*>(lv_event_get_user_data(e));
-    lv_obj_t* btn = lv_event_get_target(e);
-    uint32_t taskId = (uint32_t)(uintptr_t)lv_obj_get_user_data(btn);
-    app->m_selectedTaskId = taskId;
-    
-    for (const auto& task : app->m_tasks) {
-        if (task.id == taskId) {
-            app->showTaskDetails(task);
-            break;
-        }
-    }
-}
-
 void TaskManagementApp::addButtonCallback(lv_event_t* e) {
     TaskManagementApp* app = static_cast<TaskManagementApp*>(lv_event_get_user_data(e));
     app->showAddEditDialog();
@@ -626,13 +632,9 @@ void TaskManagementApp::addButtonCallback(lv_event_t* e) {
 
 void TaskManagementApp::editButtonCallback(lv_event_t* e) {
     TaskManagementApp* app = static_cast<TaskManagementApp*>(lv_event_get_user_data(e));
-    if (app->m_selectedTaskId > 0) {
-        for (auto& task : app->m_tasks) {
-            if (task.id == app->m_selectedTaskId) {
-                app->showAddEditDialog(&task);
-                break;
-            }
-        }
+    const AppTask* task = app->m_store.find(app->m_selectedTaskId);
+    if (task) {
+        app->showAddEditDialog(task);
     }
 }
 
@@ -2,36 +2,21 @@
 #define TASK_MANAGEMENT_APP_H
 
 #include "base_app.h"
+#include "../system/task_store.h"
+#include "../ui/virtual_list.h"
 #include <vector>
 #include <string>
 #include <ctime>
 
-enum class TaskPriority {
-    TASK_LOW = 0,
-    TASK_MEDIUM = 1,
-    TASK_HIGH = 2,
-    TASK_URGENT = 3
-};
-
-enum class TaskStatus {
-    TODO = 0,
-    IN_PROGRESS = 1,
-    COMPLETED = 2
-};
-
-struct AppTask {
-    uint32_t id;
-    std::string title;
-    std::string description;
-    TaskPriority priority;
-    TaskStatus status;
-    time_t dueDate;
-    time_t createdDate;
-    time_t completedDate;
-    std::string category;
-    bool hasReminder;
-    time_t reminderTime;
-};
+/**
+ * @file task_management_app.h
+ * @brief To-do lists for M5Stack Tab5
+ *
+ * Tasks live in a TaskStore on the SD card (OS_TASKS_PATH), which keeps
+ * every sort order and the filtered view up to date as tasks change. A
+ * VirtualList shows the view; a filter or sort change rebinds the rows
+ * on screen, and an edit rebinds only the rows it moved.
+ */
 
 class TaskManagementApp : public BaseApp {
 public:
@@ -54,17 +39,19 @@ private:
     void createDatePicker();
     
     void refreshTaskList();
+    void applyViewChange(const TaskViewChange& change);
+    void bindTaskRow(size_t index, const VirtualListRow& row);
+    void selectTask(size_t index);
     void showTaskDetails(const AppTask& task);
-    void showAddEditDialog(AppTask* task = nullptr);
+    void showAddEditDialog(const AppTask* task = nullptr);
     void hideAddEditDialog();
-    void filterTasks();
-    void sortTasks();
     
     void addTask(const AppTask& task);
     void editTask(uint32_t taskId, const AppTask& task);
     void deleteTask(uint32_t taskId);
     void toggleTaskStatus(uint32_t taskId);
     void markTaskCompleted(uint32_t taskId);
+    void setTaskStatus(uint32_t taskId, TaskStatus status);
     
     os_error_t loadTasks();
     os_error_t saveTasks();
@@ -74,7 +61,6 @@ private:
     lv_color_t getPriorityColor(TaskPriority priority);
     
     // Callbacks
-    static void taskListCallback(lv_event_t* e);
     static void addButtonCallback(lv_event_t* e);
     static void editButtonCallback(lv_event_t* e);
     static void deleteButtonCallback(lv_event_t* e);
@@ -85,9 +71,7 @@ private:
     static void sortCallback(lv_event_t* e);
     static void dueDateCallback(lv_event_t* e);
     
-    std::vector<AppTask> m_tasks;
-    std::vector<AppTask> m_filteredTasks;
-    uint32_t m_nextTaskId;
+    TaskStore m_store;
     uint32_t m_selectedTaskId;
     
     // Filtering and sorting
@@ -98,6 +82,7 @@ private:
     
     // UI elements
     lv_obj_t* m_taskList = nullptr;
+    VirtualList m_taskView;
     lv_obj_t* m_detailsPanel = nullptr;
     lv_obj_t* m_toolbar = nullptr;
     lv_obj_t* m_filterBar = nullptr;
@@ -124,7 +109,7 @@ private:
     lv_obj_t* m_reminderSwitch = nullptr;
     lv_obj_t* m_reminderTimeBtn = nullptr;
     
-    AppTask* m_editingTask = nullptr;
+    const AppTask* m_editingTask = nullptr;
     time_t m_selectedDueDate;
     time_t m_selectedReminderTime;
 };
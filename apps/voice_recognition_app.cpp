@@ -19,14 +19,8 @@ VoiceRecognitionApp::~VoiceRecognitionApp() {
     shutdown();
 }
 
-os_error_t VoiceRecognitionApp::initialize() {
-    if (m_initialized) {
-        return OS_OK;
-    }
-
-    log(ESP_LOG_INFO, "Initializing Voice Recognition App");
-    
-    // Load settings and chat history
+os_error_t VoiceRecognitionApp::prepare() {
+    // Load settings and chat history; may run on the prelaunch worker
     loadSettings();
     loadChatHistory();
     
@@ -39,7 +33,17 @@ os_error_t VoiceRecognitionApp::initialize() {
     m_commandMappings["check battery"] = "device:battery";
     m_commandMappings["turn on wifi"] = "device:wifi_on";
     m_commandMappings["turn off wifi"] = "device:wifi_off";
-    
+
+    return OS_OK;
+}
+
+os_error_t VoiceRecognitionApp::initialize() {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    log(ESP_LOG_INFO, "Initializing Voice Recognition App");
+
     // Check network connectivity
     m_networkConnected = isNetworkAvailable();
     
@@ -55,28 +59,44 @@ os_error_t VoiceRecognitionApp::update(uint32_t deltaTime) {
     if (m_voiceState == VoiceState::LISTENING) {
         m_listeningTimeout += deltaTime;
         
-        // Auto-stop listening after 10 seconds
-        if (m_listeningTimeout > 10000) {
+        // Meter levels are the same RMS the voice-activity detector uses
+        uint8_t levels[VOICE_LEVEL_BANDS];
+        m_capture.getLevels(levels);
+        m_currentAmplitude = m_capture.getLevel() / 100.0f;
+        updateVoiceVisualizer(levels);
+        
+        // The capture end-points by itself after trailing silence
+        if (m_capture.isFinished()) {
             stopListening();
         }
-        
-        // Update voice visualizer with simulated amplitude
-        m_currentAmplitude = 0.3f + 0.7f * sin(m_listeningTimeout * 0.01f);
-        updateVoiceVisualizer(m_currentAmplitude);
     }
     
     if (m_voiceState == VoiceState::PROCESSING) {
-        // Simulate processing time
-        if (m_processingStartTime > 0 && 
-            (esp_timer_get_time() / 1000 - m_processingStartTime) > 2000) {
-            // Simulate completion of processing
-            m_voiceState = VoiceState::RESPONDING;
-            hideProcessingAnimation();
-            
-            // For demo purposes, provide a canned response
-            if (!m_currentInput.empty()) {
-                handleChatGPTResponse("I understand you said: \"" + m_currentInput + "\". How can I help you with that?");
+        processVoiceInput();
+    }
+    
+    // Render the reply as it streams in; sample the state first so no tail is lost
+    if (m_voiceState == VoiceState::RESPONDING) {
+        bool finished = m_chat.isFinished();
+        std::string tokens;
+        if (m_chat.takeTokens(tokens)) {
+            if (m_chatHistory.back().content.empty()) {
+                hideProcessingAnimation();
+                lv_label_set_text(m_statusLabel, "Responding...");
             }
+            updateChatHistory(tokens, false, true);
+        }
+        if (finished) {
+            finishChatResponse();
+        }
+    }
+    
+    // Idle with wake word on: the on-device spotter listens, nothing is uploaded
+    if (m_voiceState == VoiceState::IDLE && m_wakeWordEnabled) {
+        if (m_spotter.takeDetection()) {
+            startListening();
+        } else if (!m_spotter.isRunning()) {
+            armWakeWord();
         }
     }
     
@@ -90,13 +110,18 @@ os_error_t VoiceRecognitionApp::shutdown() {
 
     log(ESP_LOG_INFO, "Shutting down Voice Recognition App");
     
-    // Stop any ongoing voice operations
-    if (m_voiceState == VoiceState::LISTENING) {
-        stopListening();
+    // Stop any ongoing voice operations; the uploader reads from the capture
+    m_spotter.stop();
+    m_uploader.cancel();
+    m_capture.stop();
+    m_uploading = false;
+    if (m_voiceState == VoiceState::LISTENING || m_voiceState == VoiceState::PROCESSING) {
+        m_voiceState = VoiceState::IDLE;
     }
     if (m_voiceState == VoiceState::RESPONDING) {
         stopSpeaking();
     }
+    m_session.close();
     
     // Save settings and chat history
     saveSettings();
@@ -219,7 +244,7 @@ void VoiceRecognitionApp::createVoiceVisualizer() {
     lv_obj_set_style_border_width(m_voiceVisualizer, 2, 0);
     
     // Create visualizer bars
-    for (int i = 0; i < 8; i++) {
+    for (size_t i = 0; i < VOICE_LEVEL_BANDS; i++) {
         m_visualizerBars[i] = lv_bar_create(m_voiceVisualizer);
         lv_obj_set_size(m_visualizerBars[i], 20, 80);
         lv_obj_align(m_visualizerBars[i], LV_ALIGN_BOTTOM_LEFT, 20 + i * 30, -10);
@@ -274,7 +299,7 @@ void VoiceRecognitionApp::createChatInterface() {
     
     // Load existing chat history
     for (const auto& msg : m_chatHistory) {
-        updateChatHistory(msg.content, msg.isUser);
+        addChatBubble(msg.content, msg.isUser);
     }
 }
 
@@ -380,6 +405,22 @@ void VoiceRecognitionApp::startListening() {
         return;
     }
     
+    // The spotter and the capture share the microphone
+    m_spotter.stop();
+    os_error_t result = m_capture.start(m_microphoneSensitivity);
+    if (result != OS_OK) {
+        lv_label_set_text(m_statusLabel, "Microphone unavailable");
+        log(ESP_LOG_ERROR, "Failed to start voice capture: %d", result);
+        return;
+    }
+    
+    // Stream speech to the recognizer while the user is still talking
+    m_uploading = false;
+    if (m_networkConnected && !m_chatGPTAPIKey.empty()) {
+        m_uploading = m_uploader.start(&m_capture, &m_session, m_chatGPTAPIKey,
+                                       getLanguageCode(m_currentLanguage).c_str()) == OS_OK;
+    }
+    
     m_voiceState = VoiceState::LISTENING;
     m_listeningTimeout = 0;
     
@@ -396,6 +437,9 @@ void VoiceRecognitionApp::stopListening() {
         return;
     }
     
+    // A manual stop end-points now; speech already captured is still transcribed
+    m_capture.finish();
+    
     m_voiceState = VoiceState::PROCESSING;
     m_processingStartTime = esp_timer_get_time() / 1000;
     
@@ -405,25 +449,105 @@ void VoiceRecognitionApp::stopListening() {
     lv_obj_set_style_bg_color(m_listenButton, lv_color_hex(0x27AE60), 0);
     
     // Reset visualizer
-    for (int i = 0; i < 8; i++) {
+    for (size_t i = 0; i < VOICE_LEVEL_BANDS; i++) {
         lv_bar_set_value(m_visualizerBars[i], 0, LV_ANIM_ON);
     }
     
     showProcessingAnimation();
     
-    // For demo purposes, simulate voice input
-    m_currentInput = "Hello, what can you help me with today?";
-    lv_label_set_text(m_commandLabel, m_currentInput.c_str());
+    m_currentInput.clear();
+    lv_label_set_text(m_commandLabel, "");
     
     log(ESP_LOG_INFO, "Stopped voice listening, processing input");
 }
 
-void VoiceRecognitionApp::updateVoiceVisualizer(float amplitude) {
-    // Update visualizer bars with amplitude data
-    for (int i = 0; i < 8; i++) {
-        float barHeight = amplitude * (0.5f + 0.5f * sin((float)i * 0.8f + m_listeningTimeout * 0.01f));
-        int value = (int)(barHeight * 100);
-        lv_bar_set_value(m_visualizerBars[i], value, LV_ANIM_OFF);
+void VoiceRecognitionApp::processVoiceInput() {
+    // Most of the utterance is uploaded by now; wait for the tail and the transcript
+    if (!m_capture.isFinished() || (m_uploading && !m_uploader.isFinished())) {
+        return;
+    }
+    
+    std::string transcript;
+    SpeechUploadState result = SpeechUploadState::IDLE;
+    if (m_uploading) {
+        result = m_uploader.getState();
+        m_uploader.takeTranscript(transcript);
+        SpeechUploadStats stats = m_uploader.getStats();
+        log(ESP_LOG_INFO, "Speech upload: %d bytes, connect %d ms, transcript %d ms after end-point",
+            stats.bytesSent, stats.connectMs, stats.resultMs);
+    }
+    VoiceCaptureState captured = m_capture.getState();
+    VoiceCaptureStats captureStats = m_capture.getStats();
+    log(ESP_LOG_INFO, "Voice capture: %d frames, %d speech, %d trimmed, floor %.0f",
+        captureStats.framesRead, captureStats.speechFrames, captureStats.trimmedFrames,
+        captureStats.noiseFloor);
+    m_capture.stop();
+    m_uploading = false;
+    hideProcessingAnimation();
+    
+    if (result == SpeechUploadState::DONE && !transcript.empty()) {
+        m_voiceState = VoiceState::IDLE;
+        lv_label_set_text(m_commandLabel, transcript.c_str());
+        sendToChatGPT(transcript);
+        return;
+    }
+    
+    const char* status = "Ready to listen";
+    if (captured == VoiceCaptureState::NO_SPEECH || result == SpeechUploadState::NO_SPEECH ||
+        (result == SpeechUploadState::DONE && transcript.empty())) {
+        status = "No speech heard";
+    } else if (captured == VoiceCaptureState::ERROR) {
+        status = "Microphone unavailable";
+    } else if (result == SpeechUploadState::IDLE) {
+        status = m_chatGPTAPIKey.empty() ? "Set an API key to transcribe speech" : "Network unavailable";
+    } else if (result == SpeechUploadState::ERROR) {
+        status = "Speech recognition failed";
+        lv_label_set_text(m_commandLabel, transcript.c_str());
+    }
+    
+    m_voiceState = VoiceState::IDLE;
+    lv_label_set_text(m_statusLabel, status);
+    lv_obj_clear_state(m_listenButton, LV_STATE_DISABLED);
+    lv_obj_add_state(m_stopButton, LV_STATE_DISABLED);
+}
+
+void VoiceRecognitionApp::updateVoiceVisualizer(const uint8_t* levels) {
+    // One bar per slice of the latest 20 ms frame
+    for (size_t i = 0; i < VOICE_LEVEL_BANDS; i++) {
+        lv_bar_set_value(m_visualizerBars[i], levels[i], LV_ANIM_OFF);
+    }
+}
+
+void VoiceRecognitionApp::toggleWakeWord(bool enabled) {
+    m_wakeWordEnabled = enabled;
+    if (!enabled) {
+        m_spotter.stop();
+        if (m_statusLabel && m_voiceState == VoiceState::IDLE) {
+            lv_label_set_text(m_statusLabel, "Ready to listen");
+        }
+    }
+    // Enabling arms the spotter from update() once the app is idle
+}
+
+void VoiceRecognitionApp::armWakeWord() {
+    os_error_t result = m_spotter.start();
+    if (result == OS_OK) {
+        if (m_statusLabel) {
+            std::string prompt = "Say \"" + std::string(m_spotter.getKeyword()) + "\" to start";
+            lv_label_set_text(m_statusLabel, prompt.c_str());
+        }
+        return;
+    }
+    
+    // No model or no microphone: turn the option off rather than retry every frame
+    log(ESP_LOG_WARN, "Wake word unavailable: %d", result);
+    m_wakeWordEnabled = false;
+    if (m_wakeWordSwitch) {
+        lv_obj_clear_state(m_wakeWordSwitch, LV_STATE_CHECKED);
+    }
+    if (m_statusLabel) {
+        lv_label_set_text(m_statusLabel, result == OS_ERROR_NOT_FOUND ?
+                          "No wake-word model installed" : "Wake word unavailable");
     }
 }
 
@@ -435,6 +559,84 @@ void VoiceRecognitionApp::hideProcessingAnimation() {
     lv_obj_add_flag(m_processingSpinner, LV_OBJ_FLAG_HIDDEN);
 }
 
+void VoiceRecognitionApp::sendToChatGPT(const std::string& message) {
+    if (m_voiceState != VoiceState::IDLE || message.empty()) {
+        return;
+    }
+    
+    const char* failure = nullptr;
+    if (m_chatGPTAPIKey.empty()) {
+        failure = "Set an API key to chat";
+    } else if (!m_networkConnected) {
+        failure = "Network unavailable";
+    } else {
+        // The most recent turns give the model the conversation so far
+        m_chat.cancel();
+        size_t first = m_chatHistory.size() > OS_LLM_HISTORY_MESSAGES ?
+                       m_chatHistory.size() - OS_LLM_HISTORY_MESSAGES : 0;
+        for (size_t i = first; i < m_chatHistory.size(); i++) {
+            m_chat.addMessage(m_chatHistory[i].isUser ? "user" : "assistant", m_chatHistory[i].content);
+        }
+        m_chat.addMessage("user", message);
+        
+        os_error_t result = m_chat.start(&m_session, m_chatGPTAPIKey);
+        if (result != OS_OK) {
+            log(ESP_LOG_ERROR, "Failed to start chat request: %d", result);
+            failure = "Assistant unavailable";
+        }
+    }
+    if (failure) {
+        lv_label_set_text(m_statusLabel, failure);
+        lv_obj_clear_state(m_listenButton, LV_STATE_DISABLED);
+        lv_obj_add_state(m_stopButton, LV_STATE_DISABLED);
+        return;
+    }
+    
+    m_currentInput = message;
+    updateChatHistory(message, true);
+    updateChatHistory("", false);     // Empty reply bubble, filled as tokens arrive
+    m_voiceState = VoiceState::RESPONDING;
+    
+    lv_label_set_text(m_statusLabel, "Thinking...");
+    lv_obj_add_state(m_listenButton, LV_STATE_DISABLED);
+    lv_obj_clear_state(m_stopButton, LV_STATE_DISABLED);
+    showProcessingAnimation();
+}
+
+void VoiceRecognitionApp::finishChatResponse() {
+    ChatStreamStats stats = m_chat.getStats();
+    ChatStreamState state = m_chat.getState();
+    std::string error = m_chat.getError();
+    m_chat.cancel();
+    hideProcessingAnimation();
+    log(ESP_LOG_INFO, "Chat reply: first token %d ms, %d tokens in %d ms, %s connection",
+        stats.ttftMs, stats.tokens, stats.totalMs, stats.reusedConnection ? "reused" : "new");
+    
+    // A failed request leaves no empty bubble behind to be sent as context next time
+    if (m_chatHistory.empty() || m_chatHistory.back().content.empty()) {
+        if (!m_chatHistory.empty()) {
+            m_chatHistory.pop_back();
+        }
+        if (m_replyLabel) {
+            lv_obj_del(lv_obj_get_parent(m_replyLabel));
+        }
+        m_replyLabel = nullptr;
+        m_voiceState = VoiceState::IDLE;
+        lv_label_set_text(m_statusLabel, state == ChatStreamState::ERROR && !error.empty() ?
+                          error.c_str() : "No reply from the assistant");
+        lv_obj_clear_state(m_listenButton, LV_STATE_DISABLED);
+        lv_obj_add_state(m_stopButton, LV_STATE_DISABLED);
+        return;
+    }
+    
+    m_replyLabel = nullptr;
+    handleChatGPTResponse(m_chatHistory.back().content);
+    if (state == ChatStreamState::ERROR) {
+        lv_label_set_text(m_statusLabel, "Reply interrupted");
+    }
+    saveChatHistory();
+}
+
 void VoiceRecognitionApp::handleChatGPTResponse(const std::string& response) {
     m_voiceState = VoiceState::IDLE;
     m_lastResponse = response;
@@ -443,17 +645,28 @@ void VoiceRecognitionApp::handleChatGPTResponse(const std::string& response) {
     lv_obj_clear_state(m_listenButton, LV_STATE_DISABLED);
     lv_obj_add_state(m_stopButton, LV_STATE_DISABLED);
     
-    // Add to chat history
-    updateChatHistory(m_currentInput, true);  // User message
-    updateChatHistory(response, false);        // Assistant response
-    
-    // For demo, just display the response
+    // The reply is already in the chat history; it streamed in token by token
     lv_label_set_text(m_commandLabel, response.c_str());
     
     log(ESP_LOG_INFO, "Received ChatGPT response: %s", response.c_str());
 }
 
-void VoiceRecognitionApp::updateChatHistory(const std::string& message, bool isUser) {
+void VoiceRecognitionApp::stopSpeaking() {
+    // Nothing is voiced yet; stopping a response ends its stream
+    m_chat.cancel();
+    m_voiceState = VoiceState::IDLE;
+    m_replyLabel = nullptr;
+}
+
+void VoiceRecognitionApp::updateChatHistory(const std::string& message, bool isUser, bool append) {
+    // Streamed text extends the reply bubble instead of adding a message
+    if (append && m_replyLabel && !m_chatHistory.empty()) {
+        m_chatHistory.back().content += message;
+        lv_label_ins_text(m_replyLabel, LV_LABEL_POS_LAST, message.c_str());
+        lv_obj_scroll_to_y(m_chatList, LV_COORD_MAX, LV_ANIM_OFF);
+        return;
+    }
+    
     // Add to internal history
     ChatMessage chatMsg;
     chatMsg.content = message;
@@ -461,7 +674,11 @@ void VoiceRecognitionApp::updateChatHistory(const std::string& message, bool isU
     chatMsg.timestamp = time(nullptr);
     m_chatHistory.push_back(chatMsg);
     
-    // Update UI
+    lv_obj_t* label = addChatBubble(message, isUser);
+    m_replyLabel = isUser ? nullptr : label;
+}
+
+lv_obj_t* VoiceRecognitionApp::addChatBubble(const std::string& message, bool isUser) {
     std::string displayText = (isUser ? "You: " : "Assistant: ") + message;
     lv_obj_t* btn = lv_list_add_btn(m_chatList, nullptr, displayText.c_str());
     
@@ -471,8 +688,13 @@ void VoiceRecognitionApp::updateChatHistory(const std::string& message, bool isU
         lv_obj_set_style_text_color(btn, lv_color_hex(0x27AE60), 0);
     }
     
+    // Wrap rather than scroll so a long reply grows the bubble as it streams
+    lv_obj_t* label = lv_obj_get_child(btn, 0);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    
     // Scroll to bottom
     lv_obj_scroll_to_y(m_chatList, LV_COORD_MAX, LV_ANIM_ON);
+    return label;
 }
 
 bool VoiceRecognitionApp::isNetworkAvailable() {
@@ -533,6 +755,12 @@ void VoiceRecognitionApp::listenButtonCallback(lv_event_t* e) {
 
 void VoiceRecognitionApp::stopButtonCallback(lv_event_t* e) {
     VoiceRecognitionApp* app = static_cast<VoiceRecognitionApp*>(lv_event_get_user_data(e));
+    if (app->m_voiceState == VoiceState::RESPONDING) {
+        // Keep what has streamed so far
+        app->m_chat.cancel();
+        app->finishChatResponse();
+        return;
+    }
     app->stopListening();
 }
 
@@ -561,7 +789,7 @@ void VoiceRecognitionApp::volumeCallback(lv_event_t* e) {
 void VoiceRecognitionApp::wakeWordCallback(lv_event_t* e) {
     VoiceRecognitionApp* app = static_cast<VoiceRecognitionApp*>(lv_event_get_user_data(e));
     lv_obj_t* sw = lv_event_get_target(e);
-    app->m_wakeWordEnabled = lv_obj_has_state(sw, LV_STATE_CHECKED);
+    app->toggleWakeWord(lv_obj_has_state(sw, LV_STATE_CHECKED));
     app->saveSettings();
 }
 
@@ -574,6 +802,13 @@ void VoiceRecognitionApp::apiKeyCallback(lv_event_t* e) {
 
 void VoiceRecognitionApp::clearHistoryCallback(lv_event_t* e) {
     VoiceRecognitionApp* app = static_cast<VoiceRecognitionApp*>(lv_event_get_user_data(e));
+    if (app->m_voiceState == VoiceState::RESPONDING) {
+        app->stopSpeaking();
+        app->hideProcessingAnimation();
+        lv_label_set_text(app->m_statusLabel, "Ready to listen");
+        lv_obj_clear_state(app->m_listenButton, LV_STATE_DISABLED);
+        lv_obj_add_state(app->m_stopButton, LV_STATE_DISABLED);
+    }
     app->m_chatHistory.clear();
     lv_obj_clean(app->m_chatList);
     app->saveChatHistory();
@@ -590,13 +825,7 @@ void VoiceRecognitionApp::sendTextCallback(lv_event_t* e) {
     if (strlen(text) > 0) {
         std::string message = text;
         lv_textarea_set_text(app->m_textInput, "");
-        
-        // Add user message to chat
-        app->updateChatHistory(message, true);
-        
-        // For demo, provide a simple response
-        std::string response = "I received your message: \"" + message + "\". This is a demo response.";
-        app->updateChatHistory(response, false);
+        app->sendToChatGPT(message);
     }
 }
 
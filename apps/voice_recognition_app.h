@@ -2,6 +2,11 @@
 #define VOICE_RECOGNITION_APP_H
 
 #include "base_app.h"
+#include "../system/voice_capture.h"
+#include "../system/speech_uploader.h"
+#include "../system/keyword_spotter.h"
+#include "../system/https_session.h"
+#include "../system/chat_stream.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -41,6 +46,7 @@ public:
     VoiceRecognitionApp();
     ~VoiceRecognitionApp() override;
 
+    os_error_t prepare() override;
     os_error_t initialize() override;
     os_error_t update(uint32_t deltaTime) override;
     os_error_t shutdown() override;
@@ -65,7 +71,9 @@ private:
     // ChatGPT integration
     void sendToChatGPT(const std::string& message);
     void handleChatGPTResponse(const std::string& response);
-    void updateChatHistory(const std::string& message, bool isUser);
+    void updateChatHistory(const std::string& message, bool isUser, bool append = false);
+    lv_obj_t* addChatBubble(const std::string& message, bool isUser);
+    void finishChatResponse();
     
     // Text-to-speech functions
     void speakText(const std::string& text);
@@ -79,7 +87,7 @@ private:
     // Utility functions
     std::string languageToString(Language lang);
     std::string getLanguageCode(Language lang);
-    void updateVoiceVisualizer(float amplitude);
+    void updateVoiceVisualizer(const uint8_t* levels);
     void showProcessingAnimation();
     void hideProcessingAnimation();
     
@@ -88,6 +96,7 @@ private:
     void setMicrophoneSensitivity(uint8_t sensitivity);
     void setSpeakerVolume(uint8_t volume);
     void toggleWakeWord(bool enabled);
+    void armWakeWord();
     void setChatGPTAPIKey(const std::string& apiKey);
     
     // Network functions
@@ -130,6 +139,12 @@ private:
     std::string m_lastResponse;
     
     // Audio processing
+    VoiceCapture m_capture;
+    SpeechUploader m_uploader;
+    bool m_uploading = false;      // Utterance is streaming to the recognizer
+    KeywordSpotter m_spotter;      // Holds the microphone while idle with wake word on
+    HttpsSession m_session;        // One kept-alive connection for speech and chat requests
+    ChatStream m_chat;
     float m_currentAmplitude;
     uint32_t m_listeningTimeout;
     uint32_t m_processingStartTime;
@@ -152,6 +167,7 @@ private:
     lv_obj_t* m_textInput = nullptr;
     lv_obj_t* m_sendButton = nullptr;
     lv_obj_t* m_clearHistoryButton = nullptr;
+    lv_obj_t* m_replyLabel = nullptr;      // Assistant bubble the stream is filling
     
     // Settings UI
     lv_obj_t* m_languageDropdown = nullptr;
@@ -162,7 +178,7 @@ private:
     lv_obj_t* m_networkStatusLabel = nullptr;
     
     // Voice visualizer UI
-    lv_obj_t* m_visualizerBars[8] = {nullptr};
+    lv_obj_t* m_visualizerBars[VOICE_LEVEL_BANDS] = {nullptr};
     lv_obj_t* m_visualizerCanvas = nullptr;
 };
 
@@ -0,0 +1,37 @@
+/**
+ * @file benchmark_main.cpp
+ * @brief Firmware entry point of the benchmark environment (pio run -e benchmark)
+ *
+ * Boots the OS as usual, runs the whole suite once and prints the results
+ * on the serial console. Sending a line re-runs the cases whose names start
+ * with it (an empty line runs everything again).
+ */
+
+#include <Arduino.h>
+#include "../framework/system/os_manager.h"
+#include "../framework/system/benchmark_suite.h"
+
+static BenchmarkSuite suite;
+
+void setup() {
+    Serial.begin(115200);
+
+    if (OS().initialize() != OS_OK || OS().start() != OS_OK) {
+        printf("BENCH FAIL boot %d\n", OS_ERROR_GENERIC);
+        return;
+    }
+
+    suite.addLogicCases();
+    suite.addDeviceCases();
+    suite.run("esp32-p4");
+}
+
+void loop() {
+    OS().update();
+
+    if (Serial.available()) {
+        String filter = Serial.readStringUntil('\n');
+        filter.trim();
+        suite.run("esp32-p4", filter.c_str());
+    }
+}
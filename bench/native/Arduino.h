@@ -0,0 +1,19 @@
+/**
+ * @file Arduino.h
+ * @brief The few Arduino definitions the logic modules use, for host builds
+ */
+
+#ifndef BENCH_NATIVE_ARDUINO_H
+#define BENCH_NATIVE_ARDUINO_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+inline uint32_t millis() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // BENCH_NATIVE_ARDUINO_H
@@ -0,0 +1,20 @@
+/**
+ * @file esp_log.h
+ * @brief ESP-IDF log macros printing to stderr, for host builds
+ */
+
+#ifndef BENCH_NATIVE_ESP_LOG_H
+#define BENCH_NATIVE_ESP_LOG_H
+
+#include <cstdio>
+
+#define BENCH_NATIVE_LOG(level, tag, format, ...) \
+    fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) BENCH_NATIVE_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) BENCH_NATIVE_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) BENCH_NATIVE_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do {} while (0)
+#define ESP_LOGV(tag, format, ...) do {} while (0)
+
+#endif // BENCH_NATIVE_ESP_LOG_H
@@ -0,0 +1,17 @@
+/**
+ * @file esp_timer.h
+ * @brief esp_timer_get_time() on the host clock
+ */
+
+#ifndef BENCH_NATIVE_ESP_TIMER_H
+#define BENCH_NATIVE_ESP_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+inline int64_t esp_timer_get_time() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // BENCH_NATIVE_ESP_TIMER_H
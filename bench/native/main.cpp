@@ -0,0 +1,15 @@
+/**
+ * @file main.cpp
+ * @brief Host entry point of the native benchmark environment (pio run -e native)
+ *
+ * Runs the logic cases only; an optional argument filters them by name
+ * prefix. The exit status is the number of failed cases.
+ */
+
+#include "benchmark_suite.h"
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite;
+    suite.addLogicCases();
+    return (int)suite.run("native", argc > 1 ? argv[1] : nullptr);
+}
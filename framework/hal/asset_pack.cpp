@@ -0,0 +1,256 @@
+#include "asset_pack.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "AssetPack";
+
+// Bytes the LVGL driver prepends to an image so it reads like a .bin file
+static uint32_t headerSize(const AssetEntry& entry) {
+    return entry.type == AssetType::IMAGE ? sizeof(lv_img_header_t) : 0;
+}
+
+AssetPack::~AssetPack() {
+    unmount();
+}
+
+os_error_t AssetPack::mount() {
+    if (m_base) {
+        return OS_OK;
+    }
+
+    int64_t start = esp_timer_get_time();
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                ESP_PARTITION_SUBTYPE_ANY,
+                                                                OS_ASSET_PARTITION);
+    if (!partition) {
+        ESP_LOGW(TAG, "No '%s' partition, assets unavailable", OS_ASSET_PARTITION);
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    const void* mapped = nullptr;
+    esp_err_t ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &mapped, &m_mapHandle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map asset partition: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    // Only the index is checked; asset bytes are read in place on demand
+    const AssetPackHeader* header = static_cast<const AssetPackHeader*>(mapped);
+    bool valid = header->magic == ASSET_PACK_MAGIC && header->version == ASSET_PACK_VERSION &&
+                 header->totalSize <= partition->size &&
+                 header->indexOffset + header->count * sizeof(AssetEntry) <= header->namesOffset &&
+                 header->namesOffset <= header->dataOffset && header->dataOffset <= header->totalSize;
+    if (valid) {
+        const uint8_t* base = static_cast<const uint8_t*>(mapped);
+        uint32_t crc = esp_rom_crc32_le(0, base + header->indexOffset,
+                                        header->dataOffset - header->indexOffset);
+        valid = crc == header->indexCrc;
+    }
+    if (!valid) {
+        ESP_LOGW(TAG, "Asset partition holds no valid pack (flash it with 'pio run -t upload_assets')");
+        esp_partition_munmap(m_mapHandle);
+        m_mapHandle = 0;
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    m_base = static_cast<const uint8_t*>(mapped);
+    m_header = header;
+    m_entries = reinterpret_cast<const AssetEntry*>(m_base + header->indexOffset);
+    m_mountTimeUs = (uint32_t)(esp_timer_get_time() - start);
+
+    ESP_LOGI(TAG, "Asset pack mapped: %d assets, %d KB, %d us",
+             header->count, header->totalSize / 1024, m_mountTimeUs);
+    return OS_OK;
+}
+
+void AssetPack::unmount() {
+    if (!m_base) {
+        return;
+    }
+
+    esp_partition_munmap(m_mapHandle);
+    m_mapHandle = 0;
+    m_base = nullptr;
+    m_header = nullptr;
+    m_entries = nullptr;
+}
+
+os_error_t AssetPack::registerFilesystem() {
+    if (m_fsRegistered) {
+        return OS_OK;
+    }
+
+    lv_fs_drv_init(&m_fsDriver);
+    m_fsDriver.letter = OS_ASSET_DRIVE_LETTER;
+    m_fsDriver.open_cb = fsOpen;
+    m_fsDriver.close_cb = fsClose;
+    m_fsDriver.read_cb = fsRead;
+    m_fsDriver.seek_cb = fsSeek;
+    m_fsDriver.tell_cb = fsTell;
+    m_fsDriver.user_data = this;
+    lv_fs_drv_register(&m_fsDriver);
+    m_fsRegistered = true;
+    return OS_OK;
+}
+
+const AssetEntry* AssetPack::find(const char* name) const {
+    if (!m_base || !name) {
+        return nullptr;
+    }
+
+    m_lookups++;
+    uint32_t hash = hashName(name);
+
+    // Lower bound on the hash, then walk the (rare) collisions
+    uint32_t low = 0;
+    uint32_t high = m_header->count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (m_entries[mid].hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (uint32_t i = low; i < m_header->count && m_entries[i].hash == hash; i++) {
+        if (strcmp(nameOf(m_entries[i]), name) == 0) {
+            return &m_entries[i];
+        }
+    }
+
+    m_misses++;
+    return nullptr;
+}
+
+const uint8_t* AssetPack::get(const char* name, size_t& size) const {
+    const AssetEntry* entry = find(name);
+    if (!entry) {
+        size = 0;
+        return nullptr;
+    }
+    size = entry->size;
+    return data(entry);
+}
+
+bool AssetPack::getImage(const char* name, lv_img_dsc_t& dsc) const {
+    const AssetEntry* entry = find(name);
+    if (!entry || entry->type != AssetType::IMAGE) {
+        return false;
+    }
+
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.header.cf = entry->colorFormat;
+    dsc.header.w = entry->width;
+    dsc.header.h = entry->height;
+    dsc.data_size = entry->size;
+    dsc.data = data(entry);
+    return true;
+}
+
+void AssetPack::printStats() const {
+    if (!m_base) {
+        ESP_LOGI(TAG, "Asset pack not mounted");
+        return;
+    }
+    ESP_LOGI(TAG, "Assets: %d in %d KB, mapped in %d us, lookups: %d (%d missed)",
+             m_header->count, m_header->totalSize / 1024, m_mountTimeUs, m_lookups, m_misses);
+}
+
+uint32_t AssetPack::hashName(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const char* AssetPack::nameOf(const AssetEntry& entry) const {
+    return reinterpret_cast<const char*>(m_base + m_header->namesOffset + entry.nameOffset);
+}
+
+void* AssetPack::fsOpen(lv_fs_drv_t* drv, const char* path, lv_fs_mode_t mode) {
+    AssetPack* pack = static_cast<AssetPack*>(drv->user_data);
+    if (mode != LV_FS_MODE_RD) {
+        return nullptr;
+    }
+
+    // LVGL passes the path after "A:"; tolerate a leading slash
+    if (*path == '/') {
+        path++;
+    }
+    const AssetEntry* entry = pack->find(path);
+    if (!entry) {
+        return nullptr;
+    }
+
+    OpenAsset* file = static_cast<OpenAsset*>(lv_mem_alloc(sizeof(OpenAsset)));
+    if (file) {
+        file->entry = entry;
+        file->position = 0;
+    }
+    return file;
+}
+
+lv_fs_res_t AssetPack::fsClose(lv_fs_drv_t* drv, void* file) {
+    lv_mem_free(file);
+    return LV_FS_RES_OK;
+}
+
+lv_fs_res_t AssetPack::fsRead(lv_fs_drv_t* drv, void* file, void* buf, uint32_t btr, uint32_t* br) {
+    AssetPack* pack = static_cast<AssetPack*>(drv->user_data);
+    OpenAsset* asset = static_cast<OpenAsset*>(file);
+    *br = 0;
+    if (!pack->m_base) {
+        return LV_FS_RES_NOT_EX;
+    }
+
+    const AssetEntry* entry = asset->entry;
+    uint32_t skip = headerSize(*entry);
+    uint8_t* out = static_cast<uint8_t*>(buf);
+    uint32_t produced = 0;
+
+    // Images are stored without their LVGL header; give it back to readers
+    // that load by path, so the file looks like the original .bin
+    if (asset->position < skip) {
+        lv_img_header_t header = {};
+        header.cf = entry->colorFormat;
+        header.w = entry->width;
+        header.h = entry->height;
+        produced = std::min(skip - asset->position, btr);
+        memcpy(out, (const uint8_t*)&header + asset->position, produced);
+        asset->position += produced;
+    }
+    if (asset->position >= skip) {
+        uint32_t count = std::min(btr - produced, entry->size + skip - asset->position);
+        memcpy(out + produced, pack->data(entry) + asset->position - skip, count);
+        asset->position += count;
+        produced += count;
+    }
+
+    *br = produced;
+    return LV_FS_RES_OK;
+}
+
+lv_fs_res_t AssetPack::fsSeek(lv_fs_drv_t* drv, void* file, uint32_t pos, lv_fs_whence_t whence) {
+    OpenAsset* asset = static_cast<OpenAsset*>(file);
+    uint32_t size = asset->entry->size + headerSize(*asset->entry);
+
+    uint32_t target = pos;
+    if (whence == LV_FS_SEEK_CUR) {
+        target = asset->position + pos;
+    } else if (whence == LV_FS_SEEK_END) {
+        target = size + pos;
+    }
+    asset->position = std::min(target, size);
+    return LV_FS_RES_OK;
+}
+
+lv_fs_res_t AssetPack::fsTell(lv_fs_drv_t* drv, void* file, uint32_t* pos) {
+    *pos = static_cast<OpenAsset*>(file)->position;
+    return LV_FS_RES_OK;
+}
@@ -0,0 +1,177 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+#include <esp_partition.h>
+
+/**
+ * @file asset_pack.h
+ * @brief Read-only asset pack mapped from a flash partition
+ *
+ * tools/pack_assets.py packs the project's assets/ directory into one
+ * image at build time, which is flashed to the OS_ASSET_PARTITION data
+ * partition. At boot the partition is mapped with esp_partition_mmap(), so
+ * assets are read in place: nothing is copied to RAM and nothing goes
+ * through the filesystem.
+ *
+ * Layout (little endian):
+ * @code
+ *   AssetPackHeader
+ *   AssetEntry[count]      sorted by (hash, name) for binary search
+ *   names                  NUL terminated, relative paths ("icons/home.bin")
+ *   data                   each asset 16-byte aligned
+ * @endcode
+ *
+ * LVGL images converted to .bin with the LVGL image converter are stored
+ * with their header split into the entry, so getImage() can return a
+ * descriptor whose data points straight at flash. Every asset is also
+ * reachable through an LVGL filesystem driver ("A:icons/home.png"), for
+ * decoders and lv_font_load(), and as a raw blob through find().
+ */
+
+static constexpr uint32_t ASSET_PACK_MAGIC = 0x50413554;   // "T5AP"
+static constexpr uint16_t ASSET_PACK_VERSION = 1;
+
+enum class AssetType : uint8_t {
+    RAW,
+    IMAGE,      // LVGL image; colorFormat/width/height valid, data is pixels
+    FONT,       // LVGL binary font (.fnt) or TTF
+    AUDIO       // Ringtones and UI sounds (.wav, .pcm, .mp3)
+};
+
+struct AssetPackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t indexOffset;       // From the start of the pack
+    uint32_t namesOffset;
+    uint32_t dataOffset;
+    uint32_t totalSize;
+    uint32_t indexCrc;          // CRC32 of the entries and names
+};
+
+struct AssetEntry {
+    uint32_t hash;              // FNV-1a of the name
+    uint32_t nameOffset;        // From namesOffset
+    uint32_t offset;            // From the start of the pack
+    uint32_t size;
+    AssetType type;
+    uint8_t colorFormat;        // lv_img_cf_t for images
+    uint16_t width;
+    uint16_t height;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(AssetPackHeader) == 32, "Asset pack header layout is shared with pack_assets.py");
+static_assert(sizeof(AssetEntry) == 24, "Asset entry layout is shared with pack_assets.py");
+
+class AssetPack {
+public:
+    AssetPack() = default;
+    ~AssetPack();
+
+    /**
+     * @brief Map the asset partition and validate its index
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if there is no partition or pack
+     */
+    os_error_t mount();
+
+    /**
+     * @brief Unmap the partition
+     *
+     * Image descriptors and pointers handed out become invalid; the LVGL
+     * driver stays registered and fails to open anything afterwards.
+     */
+    void unmount();
+
+    /**
+     * @brief Check if a pack is mapped
+     * @return true if mounted
+     */
+    bool isMounted() const { return m_base != nullptr; }
+
+    /**
+     * @brief Register the LVGL filesystem driver for the pack
+     *
+     * Must be called after lv_init(). Paths are OS_ASSET_DRIVE_LETTER
+     * followed by ':' and the asset name.
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t registerFilesystem();
+
+    /**
+     * @brief Look up an asset
+     * @param name Asset name (path relative to assets/)
+     * @return Entry or nullptr if not found
+     */
+    const AssetEntry* find(const char* name) const;
+
+    /**
+     * @brief Get a pointer to an asset's bytes in mapped flash
+     * @param entry Entry from find()
+     * @return Data pointer
+     */
+    const uint8_t* data(const AssetEntry* entry) const { return m_base + entry->offset; }
+
+    /**
+     * @brief Look up an asset's bytes
+     * @param name Asset name
+     * @param size Set to the asset size
+     * @return Data pointer in mapped flash, or nullptr if not found
+     */
+    const uint8_t* get(const char* name, size_t& size) const;
+
+    /**
+     * @brief Build an image descriptor pointing at mapped flash
+     * @param name Image asset name
+     * @param dsc Filled on success; usable with lv_img_set_src() while mounted
+     * @return true if the asset is an LVGL image
+     */
+    bool getImage(const char* name, lv_img_dsc_t& dsc) const;
+
+    /**
+     * @brief Get number of assets
+     * @return Asset count
+     */
+    uint32_t getCount() const { return m_header ? m_header->count : 0; }
+
+    /**
+     * @brief Print pack statistics
+     */
+    void printStats() const;
+
+    /**
+     * @brief FNV-1a hash used by the index
+     */
+    static uint32_t hashName(const char* name);
+
+private:
+    const char* nameOf(const AssetEntry& entry) const;
+
+    // LVGL filesystem driver callbacks
+    struct OpenAsset {
+        const AssetEntry* entry;
+        uint32_t position;
+    };
+    static void* fsOpen(lv_fs_drv_t* drv, const char* path, lv_fs_mode_t mode);
+    static lv_fs_res_t fsClose(lv_fs_drv_t* drv, void* file);
+    static lv_fs_res_t fsRead(lv_fs_drv_t* drv, void* file, void* buf, uint32_t btr, uint32_t* br);
+    static lv_fs_res_t fsSeek(lv_fs_drv_t* drv, void* file, uint32_t pos, lv_fs_whence_t whence);
+    static lv_fs_res_t fsTell(lv_fs_drv_t* drv, void* file, uint32_t* pos);
+
+    const uint8_t* m_base = nullptr;
+    const AssetPackHeader* m_header = nullptr;
+    const AssetEntry* m_entries = nullptr;
+    esp_partition_mmap_handle_t m_mapHandle = 0;
+    lv_fs_drv_t m_fsDriver;
+    bool m_fsRegistered = false;
+
+    // Statistics
+    uint32_t m_mountTimeUs = 0;
+    mutable uint32_t m_lookups = 0;
+    mutable uint32_t m_misses = 0;
+};
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,145 @@
+#include "audio_input.h"
+#include "hardware_config.h"
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_log.h>
+
+static const char* TAG = "AudioInput";
+
+// ES8388 registers used for the record path
+static constexpr uint8_t ES8388_CONTROL1 = 0x00;
+static constexpr uint8_t ES8388_CONTROL2 = 0x01;
+static constexpr uint8_t ES8388_CHIPPOWER = 0x02;
+static constexpr uint8_t ES8388_ADCPOWER = 0x03;
+static constexpr uint8_t ES8388_DACPOWER = 0x04;
+static constexpr uint8_t ES8388_MASTERMODE = 0x08;
+static constexpr uint8_t ES8388_ADCCONTROL1 = 0x09;    // Mic PGA, 3 dB steps per channel
+static constexpr uint8_t ES8388_ADCCONTROL2 = 0x0A;    // Input select
+static constexpr uint8_t ES8388_ADCCONTROL3 = 0x0B;
+static constexpr uint8_t ES8388_ADCCONTROL4 = 0x0C;    // Serial format
+static constexpr uint8_t ES8388_ADCCONTROL5 = 0x0D;    // MCLK/LRCK ratio
+static constexpr uint8_t ES8388_ADCCONTROL8 = 0x10;    // Left digital volume
+static constexpr uint8_t ES8388_ADCCONTROL9 = 0x11;    // Right digital volume
+static constexpr uint8_t ES8388_DACCONTROL3 = 0x19;
+
+static constexpr uint8_t MAX_MIC_GAIN = 8;             // +24 dB
+
+AudioInput::~AudioInput() {
+    close();
+}
+
+os_error_t AudioInput::open(uint8_t micGain) {
+    if (m_channel) {
+        return OS_OK;
+    }
+
+    gpio_set_direction(ES8388_PWR_PIN, GPIO_MODE_OUTPUT);
+    gpio_set_level(ES8388_PWR_PIN, 1);
+
+    // MCLK must run before the codec state machine starts
+    i2s_chan_config_t chanConfig = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    chanConfig.dma_desc_num = OS_AUDIO_DMA_DESC;
+    chanConfig.dma_frame_num = OS_AUDIO_FRAME_SAMPLES;
+    esp_err_t ret = i2s_new_channel(&chanConfig, nullptr, &m_channel);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2S RX channel: %s", esp_err_to_name(ret));
+        m_channel = nullptr;
+        return OS_ERROR_HARDWARE;
+    }
+
+    i2s_std_config_t stdConfig = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(OS_AUDIO_SAMPLE_RATE),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = ES8388_MCLK_PIN,
+            .bclk = ES8388_BCLK_PIN,
+            .ws = ES8388_LRCK_PIN,
+            .dout = GPIO_NUM_NC,
+            .din = ES8388_DOUT_PIN,             // Codec DOUT carries ADC data to us
+            .invert_flags = {},
+        },
+    };
+
+    ret = i2s_channel_init_std_mode(m_channel, &stdConfig);
+    if (ret == ESP_OK) {
+        ret = i2s_channel_enable(m_channel);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start I2S RX channel: %s", esp_err_to_name(ret));
+        i2s_del_channel(m_channel);
+        m_channel = nullptr;
+        return OS_ERROR_HARDWARE;
+    }
+
+    if (!configureCodec(micGain)) {
+        ESP_LOGE(TAG, "ES8388 not responding");
+        close();
+        return OS_ERROR_HARDWARE;
+    }
+
+    ESP_LOGI(TAG, "Microphone open: %d Hz, %d-sample DMA frames x %d",
+             OS_AUDIO_SAMPLE_RATE, OS_AUDIO_FRAME_SAMPLES, OS_AUDIO_DMA_DESC);
+    return OS_OK;
+}
+
+void AudioInput::close() {
+    if (!m_channel) {
+        return;
+    }
+
+    writeCodec(ES8388_ADCPOWER, 0xFF);
+    i2s_channel_disable(m_channel);
+    i2s_del_channel(m_channel);
+    m_channel = nullptr;
+}
+
+size_t AudioInput::read(int16_t* samples, size_t count, uint32_t timeoutMs) {
+    if (!m_channel || !samples) {
+        return 0;
+    }
+
+    size_t bytesRead = 0;
+    i2s_channel_read(m_channel, samples, count * sizeof(int16_t), &bytesRead, timeoutMs);
+    return bytesRead / sizeof(int16_t);
+}
+
+bool AudioInput::configureCodec(uint8_t micGain) {
+    static bool busStarted = false;
+    if (!busStarted) {
+        busStarted = Wire1.begin(ES8388_I2C_SDA_PIN, ES8388_I2C_SCL_PIN, 100000);
+    }
+
+    micGain = micGain > MAX_MIC_GAIN ? MAX_MIC_GAIN : micGain;
+    const uint8_t sequence[][2] = {
+        {ES8388_DACCONTROL3, 0x04},     // Mute the DAC; playback is not ours
+        {ES8388_CONTROL2, 0x50},
+        {ES8388_CHIPPOWER, 0x00},
+        {ES8388_MASTERMODE, 0x00},      // Slave: clocks come from the I2S peripheral
+        {ES8388_DACPOWER, 0xC0},
+        {ES8388_CONTROL1, 0x12},
+        {ES8388_ADCPOWER, 0xFF},        // ADC off while it is configured
+        {ES8388_ADCCONTROL1, (uint8_t)((micGain << 4) | micGain)},
+        {ES8388_ADCCONTROL2, 0x00},     // LINPUT1/RINPUT1
+        {ES8388_ADCCONTROL3, 0x02},
+        {ES8388_ADCCONTROL4, 0x0C},     // Philips I2S, 16 bit
+        {ES8388_ADCCONTROL5, 0x02},     // Single speed, MCLK = 256 x LRCK
+        {ES8388_ADCCONTROL8, 0x00},     // 0 dB digital volume
+        {ES8388_ADCCONTROL9, 0x00},
+        {ES8388_ADCPOWER, 0x00},        // ADC, mic bias and PGA on
+        {ES8388_CHIPPOWER, 0xF0},       // Restart the state machine on the new clocks
+        {ES8388_CHIPPOWER, 0x00},
+    };
+    for (const auto& entry : sequence) {
+        if (!writeCodec(entry[0], entry[1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AudioInput::writeCodec(uint8_t reg, uint8_t value) {
+    Wire1.beginTransmission(ES8388_I2C_ADDR);
+    Wire1.write(reg);
+    Wire1.write(value);
+    return Wire1.endTransmission() == 0;
+}
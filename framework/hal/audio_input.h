@@ -0,0 +1,60 @@
+#ifndef AUDIO_INPUT_H
+#define AUDIO_INPUT_H
+
+#include "../system/os_config.h"
+#include <driver/i2s_std.h>
+
+/**
+ * @file audio_input.h
+ * @brief Microphone input through the ES8388 ADC and an I2S RX channel
+ *
+ * open() powers the codec, programs its ADC path over I2C (mic PGA, 16-bit
+ * Philips I2S, slave to our MCLK/LRCK) and starts a mono I2S RX channel at
+ * OS_AUDIO_SAMPLE_RATE. The driver fills OS_AUDIO_DMA_DESC DMA frames of
+ * OS_AUDIO_FRAME_SAMPLES each, so a reader has that many frame times of
+ * slack before samples are lost. read() is called from one task.
+ */
+
+class AudioInput {
+public:
+    AudioInput() = default;
+    ~AudioInput();
+
+    AudioInput(const AudioInput&) = delete;
+    AudioInput& operator=(const AudioInput&) = delete;
+
+    /**
+     * @brief Power the codec and start the RX channel
+     * @param micGain Mic PGA gain step, 0 (0 dB) to 8 (+24 dB)
+     * @return OS_OK on success, OS_ERROR_HARDWARE if codec or I2S setup failed
+     */
+    os_error_t open(uint8_t micGain);
+
+    /**
+     * @brief Stop the channel and power the ADC down
+     */
+    void close();
+
+    /**
+     * @brief Check if the channel is running
+     * @return true between open() and close()
+     */
+    bool isOpen() const { return m_channel != nullptr; }
+
+    /**
+     * @brief Read 16-bit mono samples, blocking until they arrive
+     * @param samples Destination buffer
+     * @param count Samples wanted
+     * @param timeoutMs Longest wait
+     * @return Samples read; fewer on timeout
+     */
+    size_t read(int16_t* samples, size_t count, uint32_t timeoutMs);
+
+private:
+    bool writeCodec(uint8_t reg, uint8_t value);
+    bool configureCodec(uint8_t micGain);
+
+    i2s_chan_handle_t m_channel = nullptr;
+};
+
+#endif // AUDIO_INPUT_H
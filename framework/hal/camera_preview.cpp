@@ -0,0 +1,340 @@
+#include "camera_preview.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "CameraPreview";
+
+static size_t alignBytes(size_t bytes) {
+    // Output buffers are cache-synced whole; round up to the cache line
+    return (bytes + OS_MEM_DMA_ALIGNMENT - 1) & ~(size_t)(OS_MEM_DMA_ALIGNMENT - 1);
+}
+
+static uint16_t alignUp(uint32_t value, uint32_t step) {
+    return (uint16_t)((value + step - 1) / step * step);
+}
+
+CameraPreview::~CameraPreview() {
+    shutdown();
+}
+
+os_error_t CameraPreview::initialize(uint16_t width, uint16_t height) {
+    if (m_initialized) {
+        return OS_OK;
+    }
+    if (width == 0 || height == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_initialized = true;   // Let shutdown() release a partial setup
+
+    jpeg_decode_engine_cfg_t engineConfig = {};
+    engineConfig.intr_priority = 0;
+    engineConfig.timeout_ms = OS_CAMERA_JPEG_TIMEOUT_MS;
+    esp_err_t ret = jpeg_new_decoder_engine(&engineConfig, &m_decoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open JPEG decoder: %s", esp_err_to_name(ret));
+        shutdown();
+        return OS_ERROR_HARDWARE;
+    }
+
+    ppa_client_config_t clientConfig = {};
+    clientConfig.oper_type = PPA_OPERATION_SRM;
+    clientConfig.max_pending_trans_num = 1;
+    ret = ppa_register_client(&clientConfig, &m_srmClient);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register PPA client: %s", esp_err_to_name(ret));
+        shutdown();
+        return OS_ERROR_HARDWARE;
+    }
+
+    // The decoder writes whole MCUs, so rows and columns pad to 16
+    m_decodeBufferSize = alignBytes((size_t)alignUp(OS_CAMERA_MAX_FRAME_WIDTH, 16) *
+                                    alignUp(OS_CAMERA_MAX_FRAME_HEIGHT, 16) * sizeof(uint16_t));
+    m_decodeBuffer = (uint8_t*)OS_MALLOC_DMA(m_decodeBufferSize);
+
+    m_bufferSize = alignBytes((size_t)width * height * sizeof(uint16_t));
+    for (int i = 0; i < 2; i++) {
+        m_buffers[i] = (uint8_t*)OS_MALLOC_DMA(m_bufferSize);
+    }
+    if (!m_decodeBuffer || !m_buffers[0] || !m_buffers[1]) {
+        ESP_LOGE(TAG, "Failed to allocate preview buffers (%d + 2 x %d bytes)",
+                 m_decodeBufferSize, m_bufferSize);
+        shutdown();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        memset(m_buffers[i], 0, m_bufferSize);
+        m_layouts[i] = {};
+
+        lv_img_dsc_t& frame = m_frames[i];
+        frame = {};
+        frame.header.always_zero = 0;
+        frame.header.cf = LV_IMG_CF_TRUE_COLOR;
+        frame.header.w = width;
+        frame.header.h = height;
+        frame.data_size = (uint32_t)width * height * sizeof(uint16_t);
+        frame.data = m_buffers[i];
+    }
+    m_front = 0;
+
+    m_writable = xSemaphoreCreateBinary();
+    if (!m_writable) {
+        shutdown();
+        return OS_ERROR_NO_MEMORY;
+    }
+    xSemaphoreGive(m_writable);
+    m_pending.store(false);
+    m_writing = false;
+    m_framesPublished = 0;
+    m_errors = 0;
+
+    ESP_LOGI(TAG, "Preview pipeline ready: %dx%d, decode buffer %d bytes",
+             width, height, m_decodeBufferSize);
+    return OS_OK;
+}
+
+void CameraPreview::shutdown() {
+    if (!m_initialized) {
+        return;
+    }
+
+    if (m_decoder) {
+        jpeg_del_decoder_engine(m_decoder);
+        m_decoder = nullptr;
+    }
+    if (m_srmClient) {
+        ppa_unregister_client(m_srmClient);
+        m_srmClient = nullptr;
+    }
+
+    if (m_decodeBuffer) {
+        OS_FREE(m_decodeBuffer);
+        m_decodeBuffer = nullptr;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (m_buffers[i]) {
+            OS_FREE(m_buffers[i]);
+            m_buffers[i] = nullptr;
+        }
+        m_frames[i].data = nullptr;
+    }
+
+    if (m_writable) {
+        vSemaphoreDelete(m_writable);
+        m_writable = nullptr;
+    }
+    m_pending.store(false);
+    m_writing = false;
+    m_initialized = false;
+}
+
+bool CameraPreview::waitWritable(uint32_t timeoutMs) {
+    if (!m_initialized || !m_writable) {
+        return false;
+    }
+    if (!m_writing) {
+        m_writing = xSemaphoreTake(m_writable, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+    }
+    return m_writing;
+}
+
+os_error_t CameraPreview::render(const uint8_t* data, size_t length, CameraFrameFormat format,
+                                 uint16_t width, uint16_t height) {
+    if (!m_initialized || !m_writing) {
+        return OS_ERROR_BUSY;
+    }
+    if (!data || length == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    const void* source = data;
+    ppa_srm_color_mode_t mode = PPA_SRM_COLOR_MODE_RGB565;
+    uint16_t stride = width;
+    uint16_t rows = height;
+    os_error_t result = OS_OK;
+
+    switch (format) {
+        case CameraFrameFormat::JPEG:
+            result = decodeJpeg(data, length, width, height, stride, rows);
+            source = m_decodeBuffer;
+            break;
+
+        case CameraFrameFormat::RGB565:
+            if (length < (size_t)width * height * 2) {
+                result = OS_ERROR_INVALID_PARAM;
+            }
+            break;
+
+        case CameraFrameFormat::YUV420:
+            // Chroma is subsampled 2x2, so the PPA wants even dimensions
+            mode = PPA_SRM_COLOR_MODE_YUV420;
+            if ((width & 1) || (height & 1) || length < (size_t)width * height * 3 / 2) {
+                result = OS_ERROR_INVALID_PARAM;
+            }
+            break;
+    }
+
+    if (result == OS_OK) {
+        result = scale(source, mode, width, height, stride, rows);
+    }
+    if (result != OS_OK) {
+        m_errors++;
+        return result;
+    }
+
+    // The back buffer belongs to the UI until takeFrame() hands one back
+    m_writing = false;
+    m_framesPublished++;
+    m_pending.store(true, std::memory_order_release);
+    return OS_OK;
+}
+
+const lv_img_dsc_t* CameraPreview::takeFrame() {
+    if (!m_initialized || !m_pending.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // LVGL draws on this thread, so the old front is no longer being read
+    m_front ^= 1;
+    m_pending.store(false, std::memory_order_relaxed);
+    xSemaphoreGive(m_writable);
+    return &m_frames[m_front];
+}
+
+const lv_img_dsc_t* CameraPreview::getFrontFrame() const {
+    return m_initialized ? &m_frames[m_front] : nullptr;
+}
+
+bool CameraPreview::getFrontPicture(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h) const {
+    const Layout& layout = m_layouts[m_front];
+    if (!m_initialized || layout.w == 0 || layout.h == 0) {
+        return false;
+    }
+    x = layout.x;
+    y = layout.y;
+    w = layout.w;
+    h = layout.h;
+    return true;
+}
+
+void CameraPreview::getStats(CameraPreviewStats& stats) const {
+    stats.frames = m_framesPublished.load();
+    stats.errors = m_errors.load();
+    stats.decodeUs = m_decodeUs;
+    stats.scaleUs = m_scaleUs;
+}
+
+void CameraPreview::printStats(const char* tag) const {
+    CameraPreviewStats stats;
+    getStats(stats);
+    ESP_LOGI(tag, "Preview pipeline: %dx%d, %d frames, %d errors",
+             m_width, m_height, stats.frames, stats.errors);
+    ESP_LOGI(tag, "Last frame: decode %d us, scale %d us", stats.decodeUs, stats.scaleUs);
+}
+
+os_error_t CameraPreview::decodeJpeg(const uint8_t* data, size_t length, uint16_t& width,
+                                     uint16_t& height, uint16_t& stride, uint16_t& rows) {
+    jpeg_decode_picture_info_t info = {};
+    if (jpeg_decoder_get_info(data, length, &info) != ESP_OK || info.width == 0 || info.height == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Output is whole MCUs: 16x16 for 4:2:0, 16x8 for 4:2:2, 8x8 otherwise
+    uint32_t mcuWidth = 8;
+    uint32_t mcuHeight = 8;
+    if (info.sample_method == JPEG_DOWN_SAMPLING_YUV420) {
+        mcuWidth = 16;
+        mcuHeight = 16;
+    } else if (info.sample_method == JPEG_DOWN_SAMPLING_YUV422) {
+        mcuWidth = 16;
+    }
+    width = (uint16_t)info.width;
+    height = (uint16_t)info.height;
+    stride = alignUp(info.width, mcuWidth);
+    rows = alignUp(info.height, mcuHeight);
+    if ((size_t)stride * rows * sizeof(uint16_t) > m_decodeBufferSize) {
+        ESP_LOGW(TAG, "Frame %dx%d exceeds the decode buffer", width, height);
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    jpeg_decode_cfg_t decodeConfig = {};
+    decodeConfig.output_format = JPEG_DECODE_OUT_FORMAT_RGB565;
+    decodeConfig.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;   // Little-endian RGB565 for LVGL
+    decodeConfig.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+
+    int64_t start = esp_timer_get_time();
+    uint32_t decoded = 0;
+    esp_err_t ret = jpeg_decoder_process(m_decoder, &decodeConfig, data, (uint32_t)length,
+                                         m_decodeBuffer, (uint32_t)m_decodeBufferSize, &decoded);
+    m_decodeUs = (uint32_t)(esp_timer_get_time() - start);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "JPEG decode failed: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+    return OS_OK;
+}
+
+os_error_t CameraPreview::scale(const void* source, ppa_srm_color_mode_t mode,
+                                uint16_t width, uint16_t height, uint16_t stride, uint16_t rows) {
+    if (width == 0 || height == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Fit inside the preview; the SRM engine scales in 1/16 steps
+    float fit = std::min((float)m_width / width, (float)m_height / height);
+    float factor = std::min(16.0f, (float)(int)(fit * 16.0f) / 16.0f);
+    if (factor <= 0.0f) {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    Layout layout;
+    layout.w = std::min<uint16_t>(m_width, (uint16_t)(width * factor));
+    layout.h = std::min<uint16_t>(m_height, (uint16_t)(height * factor));
+    layout.x = (m_width - layout.w) / 2;
+    layout.y = (m_height - layout.h) / 2;
+
+    uint8_t back = m_front ^ 1;
+    Layout& previous = m_layouts[back];
+    if (previous.x != layout.x || previous.y != layout.y ||
+        previous.w != layout.w || previous.h != layout.h) {
+        // Frame size changed: blank the old picture so the borders stay black
+        memset(m_buffers[back], 0, m_bufferSize);
+        previous = layout;
+    }
+
+    ppa_srm_oper_config_t config = {};
+    config.in.buffer = source;
+    config.in.pic_w = stride;
+    config.in.pic_h = rows;
+    config.in.block_w = width;
+    config.in.block_h = height;
+    config.in.block_offset_x = 0;
+    config.in.block_offset_y = 0;
+    config.in.srm_cm = mode;
+    config.out.buffer = m_buffers[back];
+    config.out.buffer_size = m_bufferSize;
+    config.out.pic_w = m_width;
+    config.out.pic_h = m_height;
+    config.out.block_offset_x = layout.x;
+    config.out.block_offset_y = layout.y;
+    config.out.srm_cm = PPA_SRM_COLOR_MODE_RGB565;
+    config.rotation_angle = PPA_SRM_ROTATION_ANGLE_0;
+    config.scale_x = factor;
+    config.scale_y = factor;
+    config.mode = PPA_TRANS_MODE_BLOCKING;
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = ppa_do_scale_rotate_mirror(m_srmClient, &config);
+    m_scaleUs = (uint32_t)(esp_timer_get_time() - start);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "PPA scale failed: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+    return OS_OK;
+}
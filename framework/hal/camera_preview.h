@@ -0,0 +1,166 @@
+#ifndef CAMERA_PREVIEW_H
+#define CAMERA_PREVIEW_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+#include <driver/jpeg_decode.h>
+#include <driver/ppa.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+
+/**
+ * @file camera_preview.h
+ * @brief Hardware camera preview pipeline: JPEG decode, PPA scale, swap
+ *
+ * JPEG frames go through the ESP32-P4 JPEG decoder into an RGB565 decode
+ * buffer sized for OS_CAMERA_MAX_FRAME_WIDTH x OS_CAMERA_MAX_FRAME_HEIGHT;
+ * RGB565 and YUV420 frames from the sensor skip the decoder. The PPA
+ * scale-rotate-mirror engine then fits the frame (aspect kept, 1/16 scale
+ * steps) into the back one of two RGB565 preview buffers, converting YUV
+ * on the way. Every buffer is allocated once in initialize().
+ *
+ * One producer task calls waitWritable() and render(); the LVGL thread
+ * calls takeFrame() and passes the result to lv_img_set_src(). The swap
+ * only moves the front index, and the producer gets the old front buffer
+ * back after LVGL has stopped drawing from it.
+ */
+
+enum class CameraFrameFormat : uint8_t {
+    JPEG,
+    RGB565,
+    YUV420
+};
+
+struct CameraPreviewStats {
+    uint32_t frames;        // Frames published to the UI
+    uint32_t errors;        // Decode or PPA failures
+    uint32_t decodeUs;      // Last JPEG decode
+    uint32_t scaleUs;       // Last PPA scale/convert
+};
+
+class CameraPreview {
+public:
+    CameraPreview() = default;
+    ~CameraPreview();
+
+    CameraPreview(const CameraPreview&) = delete;
+    CameraPreview& operator=(const CameraPreview&) = delete;
+
+    /**
+     * @brief Allocate buffers and open the JPEG decoder and PPA client
+     * @param width Preview width in pixels
+     * @param height Preview height in pixels
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(uint16_t width, uint16_t height);
+
+    /**
+     * @brief Release hardware and buffers (producer stopped)
+     */
+    void shutdown();
+
+    /**
+     * @brief Check if the pipeline is ready
+     * @return true if initialized
+     */
+    bool isInitialized() const { return m_initialized; }
+
+    /**
+     * @brief Wait until the back buffer is free (producer only)
+     * @param timeoutMs Longest wait
+     * @return true if render() may be called
+     */
+    bool waitWritable(uint32_t timeoutMs);
+
+    /**
+     * @brief Convert one sensor frame into the back buffer and publish it
+     *
+     * Must follow a successful waitWritable(). On failure the back buffer
+     * stays writable for the next frame.
+     * @param data Frame bytes
+     * @param length Byte count
+     * @param format Frame encoding
+     * @param width Frame width (ignored for JPEG, read from the stream)
+     * @param height Frame height (ignored for JPEG)
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t render(const uint8_t* data, size_t length, CameraFrameFormat format,
+                      uint16_t width, uint16_t height);
+
+    /**
+     * @brief Swap in a newly published frame (LVGL thread)
+     * @return Image to show, or nullptr if no new frame arrived
+     */
+    const lv_img_dsc_t* takeFrame();
+
+    /**
+     * @brief Get the image currently shown
+     * @return Front image (black until the first frame), or nullptr
+     */
+    const lv_img_dsc_t* getFrontFrame() const;
+
+    /**
+     * @brief Get where the picture sits inside the front image
+     * @param x Left edge
+     * @param y Top edge
+     * @param w Width
+     * @param h Height
+     * @return false until a frame has been drawn
+     */
+    bool getFrontPicture(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h) const;
+
+    /**
+     * @brief Get pipeline statistics
+     * @param stats Output statistics
+     */
+    void getStats(CameraPreviewStats& stats) const;
+
+    /**
+     * @brief Print pipeline statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    struct Layout {
+        uint16_t x, y, w, h;
+    };
+
+    os_error_t decodeJpeg(const uint8_t* data, size_t length, uint16_t& width,
+                          uint16_t& height, uint16_t& stride, uint16_t& rows);
+    os_error_t scale(const void* source, ppa_srm_color_mode_t mode,
+                     uint16_t width, uint16_t height, uint16_t stride, uint16_t rows);
+
+    bool m_initialized = false;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+
+    // Hardware
+    jpeg_decoder_handle_t m_decoder = nullptr;
+    ppa_client_handle_t m_srmClient = nullptr;
+
+    // Decoded full-size frame
+    uint8_t* m_decodeBuffer = nullptr;
+    size_t m_decodeBufferSize = 0;
+
+    // Preview buffers; the back one is m_front ^ 1
+    uint8_t* m_buffers[2] = {nullptr, nullptr};
+    size_t m_bufferSize = 0;
+    lv_img_dsc_t m_frames[2] = {};
+    Layout m_layouts[2] = {};           // Area last drawn; borders are black
+    uint8_t m_front = 0;
+
+    // Handoff
+    SemaphoreHandle_t m_writable = nullptr;
+    std::atomic<bool> m_pending{false};
+    bool m_writing = false;
+
+    // Statistics
+    std::atomic<uint32_t> m_framesPublished{0};
+    std::atomic<uint32_t> m_errors{0};
+    uint32_t m_decodeUs = 0;
+    uint32_t m_scaleUs = 0;
+};
+
+#endif // CAMERA_PREVIEW_H
@@ -0,0 +1,83 @@
+#include "cpu_governor.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "CpuGovernor";
+
+static const uint16_t s_stepMhz[CPU_GOVERNOR_STEPS] = {
+    OS_DVFS_MAX_MHZ, OS_DVFS_MAX_MHZ / 2, OS_DVFS_MAX_MHZ / 4, OS_DVFS_MIN_MHZ
+};
+
+// Slowest step each AppPriority may be clocked down to (LOW, NORMAL, HIGH, SYSTEM)
+static const uint8_t s_priorityFloor[] = {3, 2, 1, 1};
+
+uint16_t CpuGovernor::stepMhz(uint8_t step) {
+    return s_stepMhz[std::min<uint8_t>(step, CPU_GOVERNOR_STEPS - 1)];
+}
+
+uint8_t CpuGovernor::update(const GovernorInputs& inputs, uint32_t now) {
+    if (m_lastUpdate != 0) {
+        m_residencyMs[m_step] += now - m_lastUpdate;
+    }
+    m_lastUpdate = now;
+
+    uint8_t fastest = inputs.lowPowerMode ? 1 : 0;
+    uint8_t slowest = s_priorityFloor[std::min<uint8_t>(inputs.appPriority, 3)];
+    if (inputs.powerIdle) {
+        slowest = CPU_GOVERNOR_STEPS - 1;
+    }
+
+    uint8_t step = m_step;
+    if (inputs.interactive) {
+        if (step > fastest) {
+            m_boosts++;
+        }
+        m_lastInteraction = now;
+        m_lowLoad = false;
+        step = fastest;
+    } else if (inputs.powerIdle) {
+        step = slowest;
+    } else if (now - m_lastInteraction < OS_DVFS_BOOST_HOLD_MS) {
+        // Hold the boost through scroll throws and short pauses between taps
+    } else if (inputs.newSample) {
+        bool pressured = inputs.frameHeadroom < OS_DVFS_MIN_HEADROOM;
+        if (inputs.cpuLoad >= OS_DVFS_PANIC_LOAD) {
+            step = fastest;
+            m_lowLoad = false;
+        } else if (inputs.cpuLoad >= OS_DVFS_UP_LOAD || pressured) {
+            step = step > 0 ? step - 1 : 0;
+            m_lowLoad = false;
+        } else if (inputs.cpuLoad <= OS_DVFS_DOWN_LOAD) {
+            if (!m_lowLoad) {
+                m_lowLoad = true;
+                m_lowLoadSince = now;
+            } else if (now - m_lowLoadSince >= OS_DVFS_DOWN_HOLD_MS) {
+                step++;
+                m_lowLoadSince = now;
+            }
+        } else {
+            m_lowLoad = false;
+        }
+    }
+
+    step = std::max(fastest, std::min(step, slowest));
+    if (step != m_step) {
+        m_step = step;
+        m_transitions++;
+    }
+    return m_step;
+}
+
+void CpuGovernor::printStats() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < CPU_GOVERNOR_STEPS; i++) {
+        total += m_residencyMs[i];
+    }
+
+    ESP_LOGI(TAG, "CPU step: %d (%d MHz), transitions: %d, boosts: %d",
+             m_step, stepMhz(m_step), m_transitions, m_boosts);
+    for (uint8_t i = 0; i < CPU_GOVERNOR_STEPS; i++) {
+        ESP_LOGI(TAG, "  %3d MHz: %d ms (%d%%)", s_stepMhz[i], m_residencyMs[i],
+                 total ? (int)((uint64_t)m_residencyMs[i] * 100 / total) : 0);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef CPU_GOVERNOR_H
+#define CPU_GOVERNOR_H
+
+#include "../system/os_config.h"
+
+/**
+ * @file cpu_governor.h
+ * @brief Load-driven CPU frequency governor
+ *
+ * Picks one of CPU_GOVERNOR_STEPS clock steps (0 = fastest) from the main
+ * loop's CPU load, how much of the frame budget is left, and the priority
+ * of the foreground app. Touch and running animations jump straight to the
+ * fastest allowed step and hold it briefly; sustained low load walks down
+ * one step at a time. The thresholds leave a wide dead band so the load
+ * seen after a step down (roughly doubled) does not trigger a step back up.
+ * PowerHAL applies the chosen step through esp_pm.
+ */
+
+static constexpr uint8_t CPU_GOVERNOR_STEPS = 4;
+
+/**
+ * @brief Inputs sampled once per main loop iteration
+ */
+struct GovernorInputs {
+    uint8_t cpuLoad = 0;            // Percent, refreshed once per second
+    uint8_t frameHeadroom = 100;    // Percent of the frame budget left at p95
+    uint8_t appPriority = 1;        // AppPriority of the foreground app
+    bool interactive = false;       // Touch or animation in progress
+    bool lowPowerMode = false;
+    bool powerIdle = false;         // PowerState other than ACTIVE
+    bool newSample = false;         // cpuLoad was refreshed this iteration
+};
+
+class CpuGovernor {
+public:
+    CpuGovernor() = default;
+
+    /**
+     * @brief Evaluate inputs and choose a clock step
+     * @param inputs Current load and UI state
+     * @param now Current time in milliseconds
+     * @return Chosen step (0 = fastest)
+     */
+    uint8_t update(const GovernorInputs& inputs, uint32_t now);
+
+    /**
+     * @brief Get last chosen step
+     * @return Step index
+     */
+    uint8_t getStep() const { return m_step; }
+
+    /**
+     * @brief Get frequency of the last chosen step
+     * @return CPU frequency in MHz
+     */
+    uint16_t getFrequencyMhz() const { return stepMhz(m_step); }
+
+    /**
+     * @brief Get frequency of a step
+     * @param step Step index
+     * @return CPU frequency in MHz
+     */
+    static uint16_t stepMhz(uint8_t step);
+
+    /**
+     * @brief Get time spent at a step
+     * @param step Step index
+     * @return Milliseconds
+     */
+    uint32_t getResidencyMs(uint8_t step) const { return step < CPU_GOVERNOR_STEPS ? m_residencyMs[step] : 0; }
+
+    /**
+     * @brief Print per-step residency and transition counts
+     */
+    void printStats() const;
+
+private:
+    uint8_t m_step = 0;
+    uint32_t m_lastUpdate = 0;
+    uint32_t m_lastInteraction = 0;
+    uint32_t m_lowLoadSince = 0;
+    bool m_lowLoad = false;
+
+    // Statistics
+    uint32_t m_residencyMs[CPU_GOVERNOR_STEPS] = {};
+    uint32_t m_transitions = 0;
+    uint32_t m_boosts = 0;
+};
+
+#endif // CPU_GOVERNOR_H
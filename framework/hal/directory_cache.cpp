@@ -0,0 +1,297 @@
+#include "directory_cache.h"
+#include <esp_log.h>
+#include <sys/stat.h>
+#include <cstring>
+
+static const char* TAG = "DirectoryCache";
+
+DirectoryCache::~DirectoryCache() {
+    shutdown();
+}
+
+os_error_t DirectoryCache::initialize() {
+    if (m_lock) {
+        return OS_OK;
+    }
+
+    m_lock = xSemaphoreCreateMutex();
+    return m_lock ? OS_OK : OS_ERROR_NO_MEMORY;
+}
+
+void DirectoryCache::shutdown() {
+    for (auto& listing : m_listings) {
+        drop(listing);
+    }
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+}
+
+os_error_t DirectoryCache::readPage(const char* directory, size_t cursor, size_t maxEntries,
+                                    std::vector<HALDirEntry>& entries, size_t& nextCursor) {
+    entries.clear();
+    nextCursor = DIR_CURSOR_END;
+    if (!directory || !m_lock) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    Listing* listing = acquire(directory, trimmedLength(directory));
+    if (!listing) {
+        xSemaphoreGive(m_lock);
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    size_t end = cursor + maxEntries;
+    if (listing->complete || listing->entries.size() >= end) {
+        m_stats.hits++;
+    } else {
+        fill(*listing, end);
+    }
+    m_stats.pages++;
+
+    size_t available = listing->entries.size();
+    if (cursor < available) {
+        size_t last = end < available ? end : available;
+        entries.reserve(last - cursor);
+        for (size_t i = cursor; i < last; i++) {
+            const Entry& entry = listing->entries[i];
+            entries.push_back({&listing->names[entry.nameOffset], entry.size, entry.timestamp,
+                               entry.isDirectory, entry.hasInfo});
+        }
+        if (last < available || !listing->complete) {
+            nextCursor = last;
+        }
+    }
+
+    xSemaphoreGive(m_lock);
+    return OS_OK;
+}
+
+os_error_t DirectoryCache::getEntryInfo(const char* directory, size_t index, HALDirEntry& entry) {
+    if (!directory || !m_lock) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    Listing* listing = acquire(directory, trimmedLength(directory));
+    if (listing && index >= listing->entries.size() && !listing->complete) {
+        fill(*listing, index + 1);
+    }
+    if (!listing || index >= listing->entries.size()) {
+        xSemaphoreGive(m_lock);
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    Entry& cached = listing->entries[index];
+    if (!cached.hasInfo && !statEntry(*listing, cached)) {
+        xSemaphoreGive(m_lock);
+        return OS_ERROR_NOT_FOUND;
+    }
+    entry = {&listing->names[cached.nameOffset], cached.size, cached.timestamp,
+             cached.isDirectory, true};
+
+    xSemaphoreGive(m_lock);
+    return OS_OK;
+}
+
+void DirectoryCache::noteModified(const char* path) {
+    const char* slash = path ? strrchr(path, '/') : nullptr;
+    if (!slash || !m_lock) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    Listing* listing = find(path, slash == path ? 1 : slash - path);
+    if (listing) {
+        const char* name = slash + 1;
+        bool found = false;
+        for (auto& entry : listing->entries) {
+            if (strcmp(&listing->names[entry.nameOffset], name) == 0) {
+                entry.hasInfo = false;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            // New file: a complete listing lacks it, an open readdir may or may not see it
+            m_stats.invalidations++;
+            drop(*listing);
+        }
+    }
+    xSemaphoreGive(m_lock);
+}
+
+void DirectoryCache::noteCreatedOrRemoved(const char* path) {
+    const char* slash = path ? strrchr(path, '/') : nullptr;
+    if (!slash || !m_lock) {
+        return;
+    }
+
+    // Indices after the entry shift, so the parent's listing starts over
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    Listing* listing = find(path, slash == path ? 1 : slash - path);
+    if (listing) {
+        m_stats.invalidations++;
+        drop(*listing);
+    }
+    // A removed directory takes its own listing with it
+    listing = find(path, trimmedLength(path));
+    if (listing) {
+        drop(*listing);
+    }
+    xSemaphoreGive(m_lock);
+}
+
+void DirectoryCache::invalidate(const char* directory) {
+    if (!directory || !m_lock) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    Listing* listing = find(directory, trimmedLength(directory));
+    if (listing) {
+        m_stats.invalidations++;
+        drop(*listing);
+    }
+    xSemaphoreGive(m_lock);
+}
+
+void DirectoryCache::invalidateAll() {
+    if (!m_lock) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& listing : m_listings) {
+        drop(listing);
+    }
+    xSemaphoreGive(m_lock);
+}
+
+void DirectoryCache::printStats() const {
+    ESP_LOGI(TAG, "Pages: %d (%d cached), scans: %d, entries read: %d, stats: %d, invalidations: %d",
+             m_stats.pages, m_stats.hits, m_stats.scans, m_stats.entriesRead,
+             m_stats.stats, m_stats.invalidations);
+}
+
+DirectoryCache::Listing* DirectoryCache::find(const char* directory, size_t length) {
+    for (auto& listing : m_listings) {
+        if (!listing.path.empty() && listing.path.size() == length &&
+            listing.path.compare(0, length, directory, length) == 0) {
+            return &listing;
+        }
+    }
+    return nullptr;
+}
+
+DirectoryCache::Listing* DirectoryCache::acquire(const char* directory, size_t length) {
+    uint32_t now = millis();
+    Listing* listing = find(directory, length);
+    if (listing) {
+        listing->lastUse = now;
+        return listing;
+    }
+
+    // Replace an unused listing, or the least recently used one
+    listing = &m_listings[0];
+    for (auto& candidate : m_listings) {
+        if (candidate.path.empty()) {
+            listing = &candidate;
+            break;
+        }
+        if (now - candidate.lastUse > now - listing->lastUse) {
+            listing = &candidate;
+        }
+    }
+    drop(*listing);
+
+    listing->path.assign(directory, length);
+    listing->dir = opendir(listing->path.c_str());
+    if (!listing->dir) {
+        ESP_LOGE(TAG, "Failed to open directory %s", listing->path.c_str());
+        listing->path.clear();
+        return nullptr;
+    }
+    listing->lastUse = now;
+    m_stats.scans++;
+    return listing;
+}
+
+void DirectoryCache::drop(Listing& listing) {
+    if (listing.dir) {
+        closedir(listing.dir);
+        listing.dir = nullptr;
+    }
+    listing.path.clear();
+    listing.complete = false;
+    // Release the memory too; a camera folder can hold thousands of names
+    std::vector<Entry>().swap(listing.entries);
+    std::vector<char>().swap(listing.names);
+}
+
+void DirectoryCache::fill(Listing& listing, size_t count) {
+    while (!listing.complete && listing.entries.size() < count) {
+        struct dirent* dirent = readdir(listing.dir);
+        if (!dirent) {
+            closedir(listing.dir);
+            listing.dir = nullptr;
+            listing.complete = true;
+            break;
+        }
+        if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0) {
+            continue;
+        }
+
+        Entry entry = {};
+        entry.nameOffset = (uint32_t)listing.names.size();
+        size_t length = strlen(dirent->d_name);
+        listing.names.insert(listing.names.end(), dirent->d_name, dirent->d_name + length + 1);
+
+#ifdef DT_DIR
+        if (dirent->d_type == DT_DIR || dirent->d_type == DT_REG) {
+            entry.isDirectory = dirent->d_type == DT_DIR;
+            listing.entries.push_back(entry);
+            m_stats.entriesRead++;
+            continue;
+        }
+#endif
+        // The filesystem did not say; only stat() can tell a directory
+        if (statEntry(listing, entry)) {
+            listing.entries.push_back(entry);
+            m_stats.entriesRead++;
+        } else {
+            listing.names.resize(entry.nameOffset);
+        }
+    }
+}
+
+bool DirectoryCache::statEntry(Listing& listing, Entry& entry) {
+    char path[OS_MAX_FILENAME_LEN];
+    const char* separator = listing.path.back() == '/' ? "" : "/";
+    int length = snprintf(path, sizeof(path), "%s%s%s", listing.path.c_str(), separator,
+                          &listing.names[entry.nameOffset]);
+    if (length < 0 || length >= (int)sizeof(path)) {
+        return false;
+    }
+
+    struct stat st;
+    m_stats.stats++;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    entry.size = st.st_size;
+    entry.timestamp = st.st_mtime;
+    entry.isDirectory = S_ISDIR(st.st_mode);
+    entry.hasInfo = true;
+    return true;
+}
+
+size_t DirectoryCache::trimmedLength(const char* path) {
+    size_t length = strlen(path);
+    while (length > 1 && path[length - 1] == '/') {
+        length--;
+    }
+    return length;
+}
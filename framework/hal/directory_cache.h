@@ -0,0 +1,162 @@
+#ifndef DIRECTORY_CACHE_H
+#define DIRECTORY_CACHE_H
+
+#include "../system/os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file directory_cache.h
+ * @brief Paginated directory enumeration with a per-directory metadata cache
+ *
+ * A listing reads its directory lazily: readdir() only runs far enough to
+ * fill the page asked for, and the stream stays open for the next page.
+ * Entry types come from d_type, so a page costs no stat() unless the
+ * filesystem leaves the type unknown. Size and timestamp are fetched per
+ * entry on request (when a row is actually shown) and kept in the listing.
+ *
+ * StorageHAL reports its own mutations so listings never go stale: a
+ * changed file drops its cached metadata, a created or removed entry drops
+ * the listing of its parent.
+ */
+
+static constexpr size_t DIR_CURSOR_END = SIZE_MAX;
+
+struct HALDirEntry {
+    std::string name;
+    uint64_t size;              // Valid when hasInfo
+    uint32_t timestamp;         // Valid when hasInfo
+    bool isDirectory;
+    bool hasInfo;
+};
+
+struct DirCacheStats {
+    uint32_t pages;             // Pages served
+    uint32_t hits;              // Pages served without readdir()
+    uint32_t scans;             // Listings (re)started
+    uint32_t entriesRead;       // readdir() results kept
+    uint32_t stats;             // stat() calls issued
+    uint32_t invalidations;     // Listings dropped by mutations
+};
+
+class DirectoryCache {
+public:
+    DirectoryCache() = default;
+    ~DirectoryCache();
+
+    /**
+     * @brief Create the cache lock
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize();
+
+    /**
+     * @brief Close open directory streams and drop all listings
+     */
+    void shutdown();
+
+    /**
+     * @brief Read a page of entries
+     * @param directory Directory path
+     * @param cursor Index of the first entry (0 for the first page)
+     * @param maxEntries Entries wanted
+     * @param entries Filled with up to maxEntries entries (cleared first)
+     * @param nextCursor Cursor of the next page, DIR_CURSOR_END after the last
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if the directory cannot be opened
+     */
+    os_error_t readPage(const char* directory, size_t cursor, size_t maxEntries,
+                        std::vector<HALDirEntry>& entries, size_t& nextCursor);
+
+    /**
+     * @brief Get an entry with size and timestamp, stat()ing it if not cached
+     * @param directory Directory path
+     * @param index Entry index as returned by readPage()
+     * @param entry Filled on success
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if there is no such entry
+     */
+    os_error_t getEntryInfo(const char* directory, size_t index, HALDirEntry& entry);
+
+    /**
+     * @brief Note that a file's size or timestamp changed
+     *
+     * Drops the entry's cached metadata; drops the parent listing if the
+     * file is not in it (it was just created).
+     * @param path File path
+     */
+    void noteModified(const char* path);
+
+    /**
+     * @brief Note that an entry was created or removed
+     * @param path Path of the entry
+     */
+    void noteCreatedOrRemoved(const char* path);
+
+    /**
+     * @brief Drop a directory's listing
+     * @param directory Directory path
+     */
+    void invalidate(const char* directory);
+
+    /**
+     * @brief Drop every listing
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Get cache statistics
+     * @return Statistics snapshot
+     */
+    DirCacheStats getStats() const { return m_stats; }
+
+    /**
+     * @brief Print cache statistics
+     */
+    void printStats() const;
+
+private:
+    struct Entry {
+        uint32_t nameOffset;    // Into Listing::names, NUL terminated
+        uint32_t timestamp;
+        uint64_t size;
+        bool isDirectory;
+        bool hasInfo;
+    };
+
+    struct Listing {
+        std::string path;
+        DIR* dir = nullptr;     // Open while the listing is incomplete
+        bool complete = false;
+        std::vector<Entry> entries;
+        std::vector<char> names;
+        uint32_t lastUse = 0;
+    };
+
+    Listing* acquire(const char* directory, size_t length);
+    Listing* find(const char* directory, size_t length);
+    void drop(Listing& listing);
+
+    /**
+     * @brief readdir() until the listing holds count entries or is complete
+     */
+    void fill(Listing& listing, size_t count);
+
+    /**
+     * @brief stat() an entry into the listing
+     * @return true on success
+     */
+    bool statEntry(Listing& listing, Entry& entry);
+
+    /**
+     * @brief Length of a path without trailing slashes
+     */
+    static size_t trimmedLength(const char* path);
+
+    Listing m_listings[OS_STORAGE_DIR_CACHE_DIRS];
+    SemaphoreHandle_t m_lock = nullptr;
+    DirCacheStats m_stats = {};
+};
+
+#endif // DIRECTORY_CACHE_H
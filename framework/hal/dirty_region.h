@@ -0,0 +1,134 @@
+#ifndef DIRTY_REGION_H
+#define DIRTY_REGION_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+
+/**
+ * @file dirty_region.h
+ * @brief Bounded dirty-rectangle set for display flushing
+ *
+ * Collects the areas LVGL redraws in a frame. Rectangles that overlap or
+ * sit close enough that their union wastes little are merged, so a clock
+ * tick in the status bar stays a single small rectangle while unrelated
+ * updates at opposite corners are not collapsed into a full-screen copy.
+ */
+
+class DirtyRegion {
+public:
+    static constexpr size_t MAX_RECTS = OS_DISPLAY_DIRTY_RECTS;
+
+    DirtyRegion() = default;
+
+    /**
+     * @brief Add an area (inclusive coordinates, as LVGL provides them)
+     * @param area Area that changed
+     */
+    void add(const lv_area_t& area) {
+        lv_area_t rect = area;
+
+        // Absorb every rectangle the new one now merges with
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < m_count; i++) {
+                if (shouldMerge(m_rects[i], rect)) {
+                    rect = unionOf(m_rects[i], rect);
+                    m_rects[i] = m_rects[--m_count];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+
+        if (m_count < MAX_RECTS) {
+            m_rects[m_count++] = rect;
+            return;
+        }
+
+        // Full: grow whichever rectangle gains the fewest pixels
+        size_t best = 0;
+        uint32_t bestGrowth = UINT32_MAX;
+        for (size_t i = 0; i < m_count; i++) {
+            uint32_t growth = areaOf(unionOf(m_rects[i], rect)) - areaOf(m_rects[i]);
+            if (growth < bestGrowth) {
+                bestGrowth = growth;
+                best = i;
+            }
+        }
+        m_rects[best] = unionOf(m_rects[best], rect);
+    }
+
+    /**
+     * @brief Forget all rectangles
+     */
+    void clear() { m_count = 0; }
+
+    /**
+     * @brief Check if nothing is dirty
+     * @return true if empty
+     */
+    bool empty() const { return m_count == 0; }
+
+    /**
+     * @brief Get number of rectangles
+     * @return Rectangle count
+     */
+    size_t count() const { return m_count; }
+
+    /**
+     * @brief Get a rectangle
+     * @param index Rectangle index (< count())
+     * @return Inclusive area
+     */
+    const lv_area_t& rect(size_t index) const { return m_rects[index]; }
+
+    /**
+     * @brief Get bounding box of all rectangles
+     * @return Inclusive area (undefined when empty)
+     */
+    lv_area_t getBounds() const {
+        lv_area_t bounds = m_rects[0];
+        for (size_t i = 1; i < m_count; i++) {
+            bounds = unionOf(bounds, m_rects[i]);
+        }
+        return bounds;
+    }
+
+    /**
+     * @brief Get total pixels covered by the rectangles
+     * @return Pixel count
+     */
+    uint32_t getPixelCount() const {
+        uint32_t pixels = 0;
+        for (size_t i = 0; i < m_count; i++) {
+            pixels += areaOf(m_rects[i]);
+        }
+        return pixels;
+    }
+
+private:
+    static uint32_t areaOf(const lv_area_t& a) {
+        return (uint32_t)(a.x2 - a.x1 + 1) * (uint32_t)(a.y2 - a.y1 + 1);
+    }
+
+    static lv_area_t unionOf(const lv_area_t& a, const lv_area_t& b) {
+        lv_area_t u;
+        u.x1 = a.x1 < b.x1 ? a.x1 : b.x1;
+        u.y1 = a.y1 < b.y1 ? a.y1 : b.y1;
+        u.x2 = a.x2 > b.x2 ? a.x2 : b.x2;
+        u.y2 = a.y2 > b.y2 ? a.y2 : b.y2;
+        return u;
+    }
+
+    static bool shouldMerge(const lv_area_t& a, const lv_area_t& b) {
+        // Accept up to 25% extra pixels to save a separate copy
+        uint32_t separate = areaOf(a) + areaOf(b);
+        return areaOf(unionOf(a, b)) <= separate + separate / 4;
+    }
+
+    lv_area_t m_rects[MAX_RECTS];
+    size_t m_count = 0;
+};
+
+#endif // DIRTY_REGION_H
@@ -5,6 +5,20 @@
 #include <driver/gpio.h>
 #include <driver/ledc.h>
 #include <esp_psram.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_cache.h>
+#include <esp_timer.h>
+#include <cstring>
+#include <algorithm>
+
+// Vendor init sequence for the Tab5 panel, when the component is available
+#if __has_include(<esp_lcd_ili9881c.h>)
+#include <esp_lcd_ili9881c.h>
+#define DISPLAY_HAS_VENDOR_DRIVER 1
+#else
+#define DISPLAY_HAS_VENDOR_DRIVER 0
+#endif
 
 static const char* TAG = "DisplayHAL";
 
@@ -19,6 +33,11 @@ os_error_t DisplayHAL::initialize() {
 
     ESP_LOGI(TAG, "Initializing Display HAL (%dx%d)", OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT);
 
+    m_flushDone = xSemaphoreCreateBinary();
+    if (!m_flushDone) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
     // Initialize hardware pins and peripherals
     os_error_t hwResult = initializeHardware();
     if (hwResult != OS_OK) {
@@ -59,14 +78,37 @@ os_error_t DisplayHAL::shutdown() {
     // Disable display
     setEnabled(false);
 
-    // Clean up LVGL resources
-    if (m_buffer1) {
-        free(m_buffer1);
-        m_buffer1 = nullptr;
+    // Clean up LVGL resources (panel framebuffers are freed with the panel)
+    if (m_buffer1 && !m_panelBuffers) {
+        OS_FREE(m_buffer1);
+    }
+    if (m_buffer2 && !m_panelBuffers) {
+        OS_FREE(m_buffer2);
+    }
+    m_buffer1 = nullptr;
+    m_buffer2 = nullptr;
+    m_panelBuffers = false;
+    m_drawBackend.shutdown();
+
+    if (m_panel) {
+        esp_lcd_panel_del(m_panel);
+        m_panel = nullptr;
+    }
+    if (m_panelIO) {
+        esp_lcd_panel_io_del(m_panelIO);
+        m_panelIO = nullptr;
+    }
+    if (m_dsiBus) {
+        esp_lcd_del_dsi_bus(m_dsiBus);
+        m_dsiBus = nullptr;
     }
-    if (m_buffer2) {
-        free(m_buffer2);
-        m_buffer2 = nullptr;
+    if (m_phyLdo) {
+        esp_ldo_release_channel(m_phyLdo);
+        m_phyLdo = nullptr;
+    }
+    if (m_flushDone) {
+        vSemaphoreDelete(m_flushDone);
+        m_flushDone = nullptr;
     }
 
     m_lvglDisplay = nullptr;
@@ -81,8 +123,9 @@ os_error_t DisplayHAL::update(uint32_t deltaTime) {
         return OS_OK;
     }
 
-    // Handle LVGL tasks
-    lv_timer_handler();
+    // Handle LVGL tasks; the return value is the delay until the next timer
+    m_nextTimerDelay = lv_timer_handler();
+    m_lastTimerRun = millis();
 
     // Update FPS statistics
     updateFPS();
@@ -90,6 +133,15 @@ os_error_t DisplayHAL::update(uint32_t deltaTime) {
     return OS_OK;
 }
 
+uint32_t DisplayHAL::getTimeUntilNextRefresh() const {
+    if (!m_initialized || !m_enabled) {
+        return UINT32_MAX;
+    }
+
+    uint32_t elapsed = millis() - m_lastTimerRun;
+    return (elapsed >= m_nextTimerDelay) ? 0 : m_nextTimerDelay - elapsed;
+}
+
 bool DisplayHAL::selfTest() {
     if (!m_initialized) {
         return false;
@@ -186,6 +238,28 @@ os_error_t DisplayHAL::setLowPowerMode(bool enabled) {
     return OS_OK;
 }
 
+os_error_t DisplayHAL::setRefreshPeriod(uint32_t periodMs) {
+    if (!m_lvglDisplay || !m_lvglDisplay->refr_timer || periodMs == 0) {
+        return OS_ERROR_GENERIC;
+    }
+
+    lv_timer_set_period(m_lvglDisplay->refr_timer, periodMs);
+    m_refreshPeriod = periodMs;
+
+    // The cached delay may be from the old, slower period; don't let the
+    // main loop sleep past the new one
+    m_nextTimerDelay = std::min(m_nextTimerDelay, periodMs);
+    return OS_OK;
+}
+
+os_error_t DisplayHAL::setFlushMode(DisplayFlushMode mode) {
+    if (m_initialized) {
+        return OS_ERROR_BUSY;
+    }
+    m_flushMode = mode;
+    return OS_OK;
+}
+
 os_error_t DisplayHAL::forceRefresh() {
     if (!m_initialized || !m_enabled) {
         return OS_ERROR_GENERIC;
@@ -205,9 +279,15 @@ void DisplayHAL::printStats() const {
     ESP_LOGI(TAG, "Enabled: %s", m_enabled ? "yes" : "no");
     ESP_LOGI(TAG, "Brightness: %d/255", m_brightness);
     ESP_LOGI(TAG, "Low power mode: %s", m_lowPowerMode ? "yes" : "no");
-    ESP_LOGI(TAG, "FPS: %.1f", m_fps);
-    ESP_LOGI(TAG, "Total flushes: %d", m_totalFlushes);
+    ESP_LOGI(TAG, "FPS: %.1f (refresh period %d ms)", m_fps, m_refreshPeriod);
+    ESP_LOGI(TAG, "Flush mode: %s%s", m_flushMode == DisplayFlushMode::FULL_FRAME ? "full frame" : "partial",
+             m_panel ? "" : " (no panel)");
+    ESP_LOGI(TAG, "Total flushes: %d, frame swaps: %d, vsync timeouts: %d",
+             m_totalFlushes, m_frameSwaps, m_vsyncTimeouts);
+    ESP_LOGI(TAG, "Pixels flushed: %llu, synced to back buffer: %llu",
+             m_flushedPixels, m_syncedPixels);
     ESP_LOGI(TAG, "Last refresh: %d ms ago", millis() - m_lastRefresh);
+    m_drawBackend.printStats();
 }
 
 void DisplayHAL::lvglFlushCallback(lv_disp_drv_t* disp_drv, 
@@ -215,30 +295,206 @@ void DisplayHAL::lvglFlushCallback(lv_disp_drv_t* disp_drv,
                                   lv_color_t* color_p) {
     DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
     
-    if (self) {
-        self->m_totalFlushes++;
+    if (!self || !self->m_panel) {
+        lv_disp_flush_ready(disp_drv);
+        return;
     }
 
-    // TODO: Implement actual display flushing to hardware
-    // For now, just mark as ready
-    lv_disp_flush_ready(disp_drv);
+    uint32_t pixels = (uint32_t)(area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1);
+    OS_TRACE_SCOPE_ARG("lvgl_flush", pixels);
+    self->m_totalFlushes++;
+    self->m_flushedPixels += pixels;
+
+    bool lastArea = lv_disp_flush_is_last(disp_drv);
+    if (!self->m_frameOpen) {
+        self->m_frameOpen = true;
+        self->m_framesStarted++;
+    }
+    if (lastArea) {
+        self->m_frameOpen = false;
+    }
+
+    if (self->m_flushMode == DisplayFlushMode::PARTIAL) {
+        // 2D-DMA copies the area into the framebuffer; onColorTransDone reports ready
+        self->m_lastAreaPending = lastArea;
+        esp_err_t ret = esp_lcd_panel_draw_bitmap(self->m_panel, area->x1, area->y1,
+                                                  area->x2 + 1, area->y2 + 1, color_p);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Flush failed: %s", esp_err_to_name(ret));
+            if (lastArea) {
+                self->m_lastAreaPending = false;
+                self->markFrameDone();
+            }
+            lv_disp_flush_ready(disp_drv);
+        }
+        return;
+    }
+
+    // Direct mode: LVGL already drew into color_p, which is a whole framebuffer.
+    // Collect the areas and swap buffers once the last one is in.
+    self->m_dirty.add(*area);
+    if (!lastArea) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    // Drawing a framebuffer only writes back the cache for the given window
+    // and switches scan-out to it at the next frame
+    lv_area_t bounds = self->m_dirty.getBounds();
+    self->m_frontBuffer = color_p;
+    self->m_swapComplete = false;
+    self->m_swapPending = true;
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(self->m_panel, bounds.x1, bounds.y1,
+                                              bounds.x2 + 1, bounds.y2 + 1, color_p);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Framebuffer swap failed: %s", esp_err_to_name(ret));
+        self->m_swapPending = false;
+        self->m_dirty.clear();
+        self->markFrameDone();
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+    self->m_frameSwaps++;
 }
 
-os_error_t DisplayHAL::initializeLVGL() {
-    // Calculate buffer size (10 lines worth of pixels)
-    uint32_t bufferSize = OS_SCREEN_WIDTH * 10;
-    
-    // Allocate draw buffers
-    m_buffer1 = static_cast<lv_color_t*>(malloc(bufferSize * sizeof(lv_color_t)));
-    if (!m_buffer1) {
-        ESP_LOGE(TAG, "Failed to allocate primary draw buffer");
-        return OS_ERROR_NO_MEMORY;
+void DisplayHAL::lvglWaitCallback(lv_disp_drv_t* disp_drv) {
+    DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
+    OS_TRACE_SCOPE("lvgl_wait");
+
+    // Sleep instead of spinning; one frame period is the longest legitimate wait
+    if (xSemaphoreTake(self->m_flushDone, pdMS_TO_TICKS(3 * 1000 / DISPLAY_PANEL_REFRESH_HZ)) != pdTRUE) {
+        self->m_vsyncTimeouts++;
+        // A missed vsync only delays scan-out, so the swap can be taken as done.
+        // In PARTIAL mode the 2D-DMA may still be reading color_p: the buffer
+        // stays LVGL's to wait on, and LVGL calls back here until it is released.
+        // The exchange settles a race with onRefreshDone() so only one side
+        // completes the swap.
+        if (self->m_swapPending.exchange(false)) {
+            self->m_swapComplete = true;
+            self->markFrameDone();
+        }
+    }
+
+    if (self->m_swapComplete) {
+        // The old front buffer is now the back buffer LVGL draws into next
+        self->m_swapComplete = false;
+        self->syncBackBuffer();
+        lv_disp_flush_ready(disp_drv);
+    }
+}
+
+bool IRAM_ATTR DisplayHAL::onColorTransDone(esp_lcd_panel_handle_t panel,
+                                            esp_lcd_dpi_panel_event_data_t* edata, void* userCtx) {
+    DisplayHAL* self = static_cast<DisplayHAL*>(userCtx);
+    if (self->m_flushMode != DisplayFlushMode::PARTIAL) {
+        return false;
+    }
+
+    if (self->m_lastAreaPending.exchange(false)) {
+        self->markFrameDone();
+    }
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    lv_disp_flush_ready(&self->m_displayDriver);
+    xSemaphoreGiveFromISR(self->m_flushDone, &higherPriorityWoken);
+    return higherPriorityWoken == pdTRUE;
+}
+
+bool IRAM_ATTR DisplayHAL::onRefreshDone(esp_lcd_panel_handle_t panel,
+                                         esp_lcd_dpi_panel_event_data_t* edata, void* userCtx) {
+    DisplayHAL* self = static_cast<DisplayHAL*>(userCtx);
+    if (!self->m_swapPending.exchange(false)) {
+        return false;
+    }
+
+    // The frame that was scanning during the swap has finished
+    self->m_swapComplete = true;
+    self->markFrameDone();
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xSemaphoreGiveFromISR(self->m_flushDone, &higherPriorityWoken);
+    OS().wakeFromISR();
+    return higherPriorityWoken == pdTRUE;
+}
+
+void IRAM_ATTR DisplayHAL::markFrameDone() {
+    uint32_t done = m_framesDone;
+    m_frameDoneUs[done % FRAME_HISTORY] = esp_timer_get_time();
+    m_framesDone = done + 1;
+}
+
+bool DisplayHAL::getFrameDoneTime(uint32_t sequence, int64_t& doneUs) const {
+    uint32_t done = m_framesDone;
+    if (sequence == 0 || sequence > done || done - sequence >= FRAME_HISTORY) {
+        return false;
+    }
+    doneUs = m_frameDoneUs[(sequence - 1) % FRAME_HISTORY];
+    return true;
+}
+
+void DisplayHAL::syncBackBuffer() {
+    if (m_dirty.empty() || !m_frontBuffer) {
+        return;
+    }
+
+    lv_color_t* back = (m_frontBuffer == m_buffer1) ? m_buffer2 : m_buffer1;
+    for (size_t i = 0; i < m_dirty.count(); i++) {
+        const lv_area_t& rect = m_dirty.rect(i);
+        uint32_t width = rect.x2 - rect.x1 + 1;
+        size_t rowBytes = width * sizeof(lv_color_t);
+
+        for (lv_coord_t y = rect.y1; y <= rect.y2; y++) {
+            size_t offset = (size_t)y * OS_SCREEN_WIDTH + rect.x1;
+            memcpy(back + offset, m_frontBuffer + offset, rowBytes);
+        }
+
+        // Scan-out reads PSRAM directly; push the copied rows out of the cache
+        size_t start = (size_t)rect.y1 * OS_SCREEN_WIDTH + rect.x1;
+        size_t span = (size_t)(rect.y2 - rect.y1) * OS_SCREEN_WIDTH + width;
+        esp_cache_msync(back + start, span * sizeof(lv_color_t),
+                        ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
     }
 
-    // Optional second buffer for better performance
-    m_buffer2 = static_cast<lv_color_t*>(malloc(bufferSize * sizeof(lv_color_t)));
-    if (!m_buffer2) {
-        ESP_LOGW(TAG, "Failed to allocate secondary draw buffer, using single buffer");
+    m_syncedPixels += m_dirty.getPixelCount();
+    m_dirty.clear();
+}
+
+os_error_t DisplayHAL::initializeLVGL() {
+    uint32_t bufferSize;
+    uint32_t bufferBytes;
+
+    if (m_flushMode == DisplayFlushMode::FULL_FRAME) {
+        // Render straight into the panel's two PSRAM framebuffers
+        void* fb0 = nullptr;
+        void* fb1 = nullptr;
+        esp_err_t ret = esp_lcd_dpi_panel_get_frame_buffer(m_panel, 2, &fb0, &fb1);
+        if (ret != ESP_OK || !fb0 || !fb1) {
+            ESP_LOGE(TAG, "Failed to get panel framebuffers: %s", esp_err_to_name(ret));
+            return OS_ERROR_NO_MEMORY;
+        }
+        m_buffer1 = static_cast<lv_color_t*>(fb0);
+        m_buffer2 = static_cast<lv_color_t*>(fb1);
+        m_panelBuffers = true;
+        bufferSize = OS_SCREEN_WIDTH * OS_SCREEN_HEIGHT;
+        bufferBytes = bufferSize * sizeof(lv_color_t);
+    } else {
+        // Line buffers in internal DMA-capable memory, copied by 2D-DMA,
+        // padded to the cache line so PPA output syncs stay inside them
+        bufferSize = OS_SCREEN_WIDTH * DISPLAY_BUFFER_LINES;
+        bufferBytes = (bufferSize * sizeof(lv_color_t) + OS_MEM_DMA_ALIGNMENT - 1) &
+                      ~(uint32_t)(OS_MEM_DMA_ALIGNMENT - 1);
+
+        m_buffer1 = static_cast<lv_color_t*>(OS_MALLOC_DMA(bufferBytes));
+        if (!m_buffer1) {
+            ESP_LOGE(TAG, "Failed to allocate primary draw buffer");
+            return OS_ERROR_NO_MEMORY;
+        }
+
+        // Second buffer lets LVGL render while the previous area is in flight
+        m_buffer2 = static_cast<lv_color_t*>(OS_MALLOC_DMA(bufferBytes));
+        if (!m_buffer2) {
+            ESP_LOGW(TAG, "Failed to allocate secondary draw buffer, using single buffer");
+        }
     }
 
     // Initialize draw buffer
@@ -249,9 +505,16 @@ os_error_t DisplayHAL::initializeLVGL() {
     m_displayDriver.hor_res = OS_SCREEN_WIDTH;
     m_displayDriver.ver_res = OS_SCREEN_HEIGHT;
     m_displayDriver.flush_cb = lvglFlushCallback;
+    m_displayDriver.wait_cb = lvglWaitCallback;
     m_displayDriver.draw_buf = &m_drawBuffer;
+    m_displayDriver.direct_mode = (m_flushMode == DisplayFlushMode::FULL_FRAME);
     m_displayDriver.user_data = this;
 
+    // Hardware-assisted drawing; plain software rendering if the PPA is unavailable
+    if (m_drawBackend.initialize() == OS_OK) {
+        m_drawBackend.attach(&m_displayDriver, bufferBytes);
+    }
+
     // Register the driver
     m_lvglDisplay = lv_disp_drv_register(&m_displayDriver);
     if (!m_lvglDisplay) {
@@ -259,7 +522,8 @@ os_error_t DisplayHAL::initializeLVGL() {
         return OS_ERROR_GENERIC;
     }
 
-    ESP_LOGI(TAG, "LVGL display driver initialized (%s buffer)",
+    ESP_LOGI(TAG, "LVGL display driver initialized (%s, %s buffer)",
+             m_flushMode == DisplayFlushMode::FULL_FRAME ? "full frame" : "partial",
              m_buffer2 ? "double" : "single");
 
     return OS_OK;
@@ -339,15 +603,116 @@ os_error_t DisplayHAL::initializeHardware() {
     gpio_set_level(DISPLAY_RST_PIN, 1); // Release reset
     vTaskDelay(pdMS_TO_TICKS(DISPLAY_INIT_DELAY_MS));
 
-    // TODO: Initialize MIPI-DSI peripheral
-    // This requires ESP-IDF MIPI-DSI driver configuration
-    // For now, we'll use a placeholder
-    ESP_LOGW(TAG, "MIPI-DSI initialization not yet implemented");
+    // Without a panel LVGL still runs, flushes just complete immediately
+    if (initializePanel() != OS_OK) {
+        ESP_LOGE(TAG, "MIPI-DSI panel unavailable, rendering headless");
+        m_flushMode = DisplayFlushMode::PARTIAL;
+    }
 
     ESP_LOGI(TAG, "Display hardware initialized successfully");
     return OS_OK;
 }
 
+os_error_t DisplayHAL::initializePanel() {
+    // The DSI PHY is powered from an on-chip LDO channel
+    esp_ldo_channel_config_t ldoConfig = {};
+    ldoConfig.chan_id = MIPI_DSI_PHY_LDO_CHAN;
+    ldoConfig.voltage_mv = MIPI_DSI_PHY_LDO_MV;
+    esp_err_t ret = esp_ldo_acquire_channel(&ldoConfig, &m_phyLdo);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to power DSI PHY: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    esp_lcd_dsi_bus_config_t busConfig = {};
+    busConfig.bus_id = MIPI_DSI_HOST;
+    busConfig.num_data_lanes = MIPI_DSI_LANES;
+    busConfig.phy_clk_src = MIPI_DSI_PHY_CLK_SRC_DEFAULT;
+    busConfig.lane_bit_rate_mbps = MIPI_DSI_LANE_BITRATE_MBPS;
+    ret = esp_lcd_new_dsi_bus(&busConfig, &m_dsiBus);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create DSI bus: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    // Command channel for the controller init sequence
+    esp_lcd_dbi_io_config_t dbiConfig = {};
+    dbiConfig.virtual_channel = 0;
+    dbiConfig.lcd_cmd_bits = 8;
+    dbiConfig.lcd_param_bits = 8;
+    ret = esp_lcd_new_panel_io_dbi(m_dsiBus, &dbiConfig, &m_panelIO);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create DBI panel IO: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    // Video stream; the driver allocates the framebuffers in PSRAM and
+    // uses 2D-DMA for draw_bitmap copies
+    esp_lcd_dpi_panel_config_t dpiConfig = {};
+    dpiConfig.virtual_channel = 0;
+    dpiConfig.dpi_clk_src = MIPI_DSI_DPI_CLK_SRC_DEFAULT;
+    dpiConfig.dpi_clock_freq_mhz = DISPLAY_DPI_CLOCK_MHZ;
+    dpiConfig.pixel_format = LCD_COLOR_PIXEL_FORMAT_RGB565;
+    dpiConfig.num_fbs = (m_flushMode == DisplayFlushMode::FULL_FRAME) ? 2 : 1;
+    dpiConfig.video_timing.h_size = OS_SCREEN_WIDTH;
+    dpiConfig.video_timing.v_size = OS_SCREEN_HEIGHT;
+    dpiConfig.video_timing.hsync_pulse_width = DISPLAY_HSYNC_PULSE;
+    dpiConfig.video_timing.hsync_back_porch = DISPLAY_HSYNC_BACK_PORCH;
+    dpiConfig.video_timing.hsync_front_porch = DISPLAY_HSYNC_FRONT_PORCH;
+    dpiConfig.video_timing.vsync_pulse_width = DISPLAY_VSYNC_PULSE;
+    dpiConfig.video_timing.vsync_back_porch = DISPLAY_VSYNC_BACK_PORCH;
+    dpiConfig.video_timing.vsync_front_porch = DISPLAY_VSYNC_FRONT_PORCH;
+    dpiConfig.flags.use_dma2d = true;
+
+#if DISPLAY_HAS_VENDOR_DRIVER
+    ili9881c_vendor_config_t vendorConfig = {};
+    vendorConfig.mipi_config.dsi_bus = m_dsiBus;
+    vendorConfig.mipi_config.dpi_config = &dpiConfig;
+    vendorConfig.mipi_config.lane_num = MIPI_DSI_LANES;
+
+    esp_lcd_panel_dev_config_t devConfig = {};
+    devConfig.reset_gpio_num = -1;  // Reset is driven in initializeHardware()
+    devConfig.rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB;
+    devConfig.bits_per_pixel = 16;
+    devConfig.vendor_config = &vendorConfig;
+    ret = esp_lcd_new_panel_ili9881c(m_panelIO, &devConfig, &m_panel);
+#else
+    ESP_LOGW(TAG, "No panel vendor driver, starting DPI stream without controller init");
+    ret = esp_lcd_new_panel_dpi(m_dsiBus, &dpiConfig, &m_panel);
+#endif
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create DPI panel: %s", esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    ret = esp_lcd_panel_reset(m_panel);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_init(m_panel);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start panel: %s", esp_err_to_name(ret));
+        esp_lcd_panel_del(m_panel);
+        m_panel = nullptr;
+        return OS_ERROR_HARDWARE;
+    }
+
+    esp_lcd_dpi_panel_event_callbacks_t callbacks = {};
+    callbacks.on_color_trans_done = onColorTransDone;
+    callbacks.on_refresh_done = onRefreshDone;
+    ret = esp_lcd_dpi_panel_register_event_callbacks(m_panel, &callbacks, this);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register DPI callbacks: %s", esp_err_to_name(ret));
+        esp_lcd_panel_del(m_panel);
+        m_panel = nullptr;
+        return OS_ERROR_HARDWARE;
+    }
+
+    ESP_LOGI(TAG, "MIPI-DSI panel running (%d lanes @ %d Mbps, %d framebuffer%s)",
+             MIPI_DSI_LANES, MIPI_DSI_LANE_BITRATE_MBPS, dpiConfig.num_fbs,
+             dpiConfig.num_fbs > 1 ? "s" : "");
+    return OS_OK;
+}
+
 void DisplayHAL::updateFPS() {
     m_frameCount++;
     
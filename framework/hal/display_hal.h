@@ -2,15 +2,35 @@
 #define DISPLAY_HAL_H
 
 #include "../system/os_config.h"
+#include "dirty_region.h"
+#include "ppa_draw.h"
 #include <lvgl.h>
+#include <esp_lcd_types.h>
+#include <esp_lcd_mipi_dsi.h>
+#include <esp_ldo_regulator.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
 
 /**
  * @file display_hal.h
  * @brief Display Hardware Abstraction Layer for M5Stack Tab5
  * 
  * Manages the 5-inch 1280x720 MIPI-DSI display with LVGL integration.
+ *
+ * Flushes never block the CPU on pixel copies: in PARTIAL mode the DPI
+ * driver's 2D-DMA copies each LVGL area into the panel framebuffer and
+ * the DMA-done interrupt reports flush_ready. In FULL_FRAME mode LVGL
+ * renders directly into one of two PSRAM framebuffers; the finished one
+ * is swapped in on vsync and only the merged dirty rectangles are copied
+ * back so both buffers stay identical.
  */
 
+enum class DisplayFlushMode : uint8_t {
+    PARTIAL,        // Internal-RAM line buffers, DMA2D copy per area
+    FULL_FRAME      // Double PSRAM framebuffer, swap on vsync
+};
+
 class DisplayHAL {
 public:
     DisplayHAL() = default;
@@ -74,6 +94,44 @@ public:
      */
     os_error_t setLowPowerMode(bool enabled);
 
+    /**
+     * @brief Check if low power mode is enabled
+     * @return true if enabled, false otherwise
+     */
+    bool isLowPowerMode() const { return m_lowPowerMode; }
+
+    /**
+     * @brief Set LVGL render period (the display refresh timer)
+     * @param periodMs Milliseconds between refreshes
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setRefreshPeriod(uint32_t periodMs);
+
+    /**
+     * @brief Get LVGL render period
+     * @return Milliseconds between refreshes
+     */
+    uint32_t getRefreshPeriod() const { return m_refreshPeriod; }
+
+    /**
+     * @brief Select the flush mode (only before initialize())
+     * @param mode Flush mode
+     * @return OS_OK on success, OS_ERROR_BUSY if already initialized
+     */
+    os_error_t setFlushMode(DisplayFlushMode mode);
+
+    /**
+     * @brief Get the active flush mode
+     * @return Flush mode
+     */
+    DisplayFlushMode getFlushMode() const { return m_flushMode; }
+
+    /**
+     * @brief Get PPA draw backend
+     * @return Reference to draw backend
+     */
+    PPADrawBackend& getDrawBackend() { return m_drawBackend; }
+
     /**
      * @brief Get display width
      * @return Display width in pixels
@@ -104,6 +162,29 @@ public:
      */
     float getFPS() const { return m_fps; }
 
+    /**
+     * @brief Get number of frames that have started flushing
+     * @return Frame sequence number of the latest frame (1-based)
+     */
+    uint32_t getFramesStarted() const { return m_framesStarted; }
+
+    /**
+     * @brief Get the time a frame's last area completed
+     *
+     * PARTIAL mode completes when the last area's DMA into the framebuffer
+     * is done; FULL_FRAME mode when the swapped-in buffer reaches vsync.
+     * @param sequence Frame sequence number, as from getFramesStarted()
+     * @param doneUs Output esp_timer time in microseconds
+     * @return true if the frame completed and is still in the short history
+     */
+    bool getFrameDoneTime(uint32_t sequence, int64_t& doneUs) const;
+
+    /**
+     * @brief Get time until LVGL next needs its timer handler run
+     * @return Milliseconds until the next LVGL timer, UINT32_MAX if disabled
+     */
+    uint32_t getTimeUntilNextRefresh() const;
+
     /**
      * @brief Get display statistics
      */
@@ -120,6 +201,40 @@ private:
                                  const lv_area_t* area, 
                                  lv_color_t* color_p);
 
+    /**
+     * @brief LVGL wait callback while a flush is in flight
+     * @param disp_drv Display driver
+     */
+    static void lvglWaitCallback(lv_disp_drv_t* disp_drv);
+
+    /**
+     * @brief DPI color transfer done (ISR): a partial area reached the framebuffer
+     */
+    static bool onColorTransDone(esp_lcd_panel_handle_t panel,
+                                 esp_lcd_dpi_panel_event_data_t* edata, void* userCtx);
+
+    /**
+     * @brief DPI refresh done (ISR): one frame was scanned out (vsync)
+     */
+    static bool onRefreshDone(esp_lcd_panel_handle_t panel,
+                              esp_lcd_dpi_panel_event_data_t* edata, void* userCtx);
+
+    /**
+     * @brief Record completion of the oldest open frame (ISR safe)
+     */
+    void markFrameDone();
+
+    /**
+     * @brief Copy this frame's dirty rectangles into the new back buffer
+     */
+    void syncBackBuffer();
+
+    /**
+     * @brief Bring up the DSI PHY, bus and DPI panel
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initializePanel();
+
     /**
      * @brief Initialize hardware (GPIO, PWM, MIPI-DSI)
      * @return OS_OK on success, error code on failure
@@ -142,6 +257,22 @@ private:
     bool m_enabled = false;
     uint8_t m_brightness = 128;
     bool m_lowPowerMode = false;
+    DisplayFlushMode m_flushMode = OS_DISPLAY_FULL_FRAME ? DisplayFlushMode::FULL_FRAME
+                                                         : DisplayFlushMode::PARTIAL;
+
+    // MIPI-DSI panel
+    esp_ldo_channel_handle_t m_phyLdo = nullptr;
+    esp_lcd_dsi_bus_handle_t m_dsiBus = nullptr;
+    esp_lcd_panel_io_handle_t m_panelIO = nullptr;
+    esp_lcd_panel_handle_t m_panel = nullptr;
+
+    // Flush state shared with the DPI interrupts
+    SemaphoreHandle_t m_flushDone = nullptr;
+    std::atomic<bool> m_swapPending{false};  // Waiting for vsync after a framebuffer swap
+    std::atomic<bool> m_swapComplete{false}; // Vsync seen, back buffer needs syncing
+    lv_color_t* m_frontBuffer = nullptr;
+    DirtyRegion m_dirty;
+    PPADrawBackend m_drawBackend;
 
     // LVGL components
     lv_disp_t* m_lvglDisplay = nullptr;
@@ -149,13 +280,31 @@ private:
     lv_disp_draw_buf_t m_drawBuffer;
     lv_color_t* m_buffer1 = nullptr;
     lv_color_t* m_buffer2 = nullptr;
+    bool m_panelBuffers = false;             // Draw buffers are the DPI driver's framebuffers
 
     // Statistics
     uint32_t m_frameCount = 0;
     uint32_t m_lastFPSUpdate = 0;
     float m_fps = 0.0f;
     uint32_t m_totalFlushes = 0;
+    uint32_t m_frameSwaps = 0;
+    uint64_t m_flushedPixels = 0;
+    uint64_t m_syncedPixels = 0;
+    uint32_t m_vsyncTimeouts = 0;
     uint32_t m_lastRefresh = 0;
+
+    // Frame completion times for input latency measurement
+    static constexpr uint32_t FRAME_HISTORY = 4;
+    bool m_frameOpen = false;                // Flushed an area, last not yet sent
+    std::atomic<bool> m_lastAreaPending{false}; // PARTIAL: last area's DMA in flight
+    uint32_t m_framesStarted = 0;
+    volatile uint32_t m_framesDone = 0;
+    volatile int64_t m_frameDoneUs[FRAME_HISTORY] = {};
+
+    // LVGL timer scheduling (from lv_timer_handler)
+    uint32_t m_lastTimerRun = 0;
+    uint32_t m_nextTimerDelay = 0;
+    uint32_t m_refreshPeriod = LV_DISP_DEF_REFR_PERIOD;
 };
 
 #endif // DISPLAY_HAL_H
\ No newline at end of file
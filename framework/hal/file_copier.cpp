@@ -0,0 +1,477 @@
+#include "file_copier.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+static const char* TAG = "FileCopier";
+
+FileCopier::~FileCopier() {
+    shutdown();
+}
+
+os_error_t FileCopier::initialize() {
+    if (m_running) {
+        return OS_OK;
+    }
+
+    m_lock = xSemaphoreCreateMutex();
+    m_freeChunks = xSemaphoreCreateCounting(2, 2);
+    m_fullChunks = xSemaphoreCreateCounting(2, 0);
+    if (!m_lock || !m_freeChunks || !m_fullChunks) {
+        shutdown();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    for (auto& chunk : m_chunks) {
+        chunk.data = (uint8_t*)OS_MALLOC_DMA(OS_STORAGE_COPY_CHUNK_SIZE);
+        if (!chunk.data) {
+            shutdown();
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    m_running = true;
+    if (xTaskCreatePinnedToCore(writerTask, "os_copy_wr", OS_STORAGE_COPY_TASK_STACK, this,
+                                OS_STORAGE_COPY_TASK_PRIORITY, &m_writerTask,
+                                OS_STORAGE_COPY_TASK_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(copyTask, "os_copy", OS_STORAGE_COPY_TASK_STACK, this,
+                                OS_STORAGE_COPY_TASK_PRIORITY, &m_copyTask,
+                                OS_STORAGE_COPY_TASK_CORE) != pdPASS) {
+        shutdown();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    ESP_LOGI(TAG, "Copy engine ready: 2 x %d KB chunks", OS_STORAGE_COPY_CHUNK_SIZE / 1024);
+    return OS_OK;
+}
+
+void FileCopier::shutdown() {
+    if (m_lock) {
+        // Queued jobs never start; a running one stops after its chunk
+        xSemaphoreTake(m_lock, portMAX_DELAY);
+        std::deque<Job> dropped;
+        dropped.swap(m_jobs);
+        m_cancelActive = true;
+        xSemaphoreGive(m_lock);
+        for (auto& job : dropped) {
+            if (job.done) {
+                *job.result = OS_ERROR_CANCELLED;
+                xSemaphoreGive(job.done);
+            }
+        }
+    }
+
+    m_running = false;
+    if (m_copyTask) {
+        TaskHandle_t task = m_copyTask;
+        xTaskNotifyGive(task);
+        for (int attempt = 0; attempt < 200 && m_copyTask; attempt++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_copyTask) {
+            ESP_LOGW(TAG, "Copy task did not exit, deleting");
+            vTaskDelete(task);
+            m_copyTask = nullptr;
+        }
+    }
+    if (m_writerTask) {
+        TaskHandle_t task = m_writerTask;
+        xSemaphoreGive(m_fullChunks);
+        for (int attempt = 0; attempt < 100 && m_writerTask; attempt++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_writerTask) {
+            ESP_LOGW(TAG, "Writer task did not exit, deleting");
+            vTaskDelete(task);
+            m_writerTask = nullptr;
+        }
+    }
+
+    for (auto& chunk : m_chunks) {
+        if (chunk.data) {
+            OS_FREE(chunk.data);
+            chunk.data = nullptr;
+        }
+    }
+    if (m_freeChunks) {
+        vSemaphoreDelete(m_freeChunks);
+        m_freeChunks = nullptr;
+    }
+    if (m_fullChunks) {
+        vSemaphoreDelete(m_fullChunks);
+        m_fullChunks = nullptr;
+    }
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+    m_completions.clear();
+    m_activeProgress = nullptr;
+    m_activeId = 0;
+    m_cancelActive = false;
+}
+
+CopyJobId FileCopier::submit(const char* source, const char* dest, bool move,
+                             CopyProgressCallback progress, CopyCompleteCallback complete) {
+    if (!source || !dest) {
+        return 0;
+    }
+
+    Job job;
+    job.source = source;
+    job.dest = dest;
+    job.move = move;
+    job.progress = std::move(progress);
+    job.complete = std::move(complete);
+    return enqueue(std::move(job));
+}
+
+os_error_t FileCopier::run(const char* source, const char* dest, bool move, CopyControl* control) {
+    if (!source || !dest) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (!done) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    os_error_t result = OS_ERROR_GENERIC;
+    Job job;
+    job.source = source;
+    job.dest = dest;
+    job.move = move;
+    job.done = done;
+    job.result = &result;
+    job.control = control;
+    if (enqueue(std::move(job)) == 0) {
+        vSemaphoreDelete(done);
+        return OS_ERROR_BUSY;
+    }
+
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
+    return result;
+}
+
+CopyJobId FileCopier::enqueue(Job job) {
+    if (!m_running || !m_copyTask) {
+        return 0;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_jobs.size() >= OS_STORAGE_COPY_QUEUE_DEPTH) {
+        xSemaphoreGive(m_lock);
+        ESP_LOGW(TAG, "Copy queue full");
+        return 0;
+    }
+    job.id = ++m_nextId;
+    if (job.id == 0) {
+        job.id = ++m_nextId;
+    }
+    CopyJobId id = job.id;
+    m_jobs.push_back(std::move(job));
+    xSemaphoreGive(m_lock);
+
+    xTaskNotifyGive(m_copyTask);
+    return id;
+}
+
+bool FileCopier::cancel(CopyJobId id) {
+    if (id == 0 || !m_lock) {
+        return false;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_activeId == id) {
+        m_cancelActive = true;
+        xSemaphoreGive(m_lock);
+        return true;
+    }
+
+    for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+        if (it->id == id) {
+            Job job = std::move(*it);
+            m_jobs.erase(it);
+            xSemaphoreGive(m_lock);
+            finish(job, OS_ERROR_CANCELLED);
+            return true;
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return false;
+}
+
+bool FileCopier::getProgress(CopyJobId id, CopyProgress& progress) const {
+    if (id == 0 || !m_lock) {
+        return false;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    bool found = m_activeId == id;
+    if (found) {
+        progress = m_progress;
+    } else {
+        for (const auto& job : m_jobs) {
+            if (job.id == id) {
+                progress = {};
+                found = true;
+                break;
+            }
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return found;
+}
+
+void FileCopier::dispatch() {
+    if (!m_lock) {
+        return;
+    }
+
+    CopyProgressCallback progressCallback;
+    CopyProgress progress = {};
+    std::vector<Completion> ready;
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_progressDirty && m_activeProgress) {
+        progressCallback = m_activeProgress;
+        progress = m_progress;
+    }
+    m_progressDirty = false;
+    ready.swap(m_completions);
+    xSemaphoreGive(m_lock);
+
+    if (progressCallback) {
+        progressCallback(progress);
+    }
+    for (auto& completion : ready) {
+        completion.callback(completion.result, completion.progress);
+    }
+}
+
+void FileCopier::printStats() const {
+    ESP_LOGI(TAG, "Copies: %d done, %d failed, %llu bytes, peak %d KB/s",
+             m_jobsDone, m_jobsFailed, m_bytesCopied, m_peakBytesPerSecond / 1024);
+}
+
+void FileCopier::finish(Job& job, os_error_t result) {
+    if (job.done) {
+        *job.result = result;
+        xSemaphoreGive(job.done);
+        return;
+    }
+    if (!job.complete) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    CopyProgress progress = m_activeId == job.id ? m_progress : CopyProgress{};
+    m_completions.push_back({std::move(job.complete), result, progress});
+    xSemaphoreGive(m_lock);
+
+    // The callback runs on the main loop, which may be asleep
+    OS().wake();
+}
+
+os_error_t FileCopier::execute(Job& job) {
+    const char* source = job.source.c_str();
+    const char* dest = job.dest.c_str();
+
+    struct stat st;
+    if (stat(source, &st) != 0 || S_ISDIR(st.st_mode)) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_progress.totalBytes = st.st_size;
+    xSemaphoreGive(m_lock);
+
+    // Same filesystem: a move is just a directory update
+    if (job.move && rename(source, dest) == 0) {
+        xSemaphoreTake(m_lock, portMAX_DELAY);
+        m_progress.bytesCopied = st.st_size;
+        xSemaphoreGive(m_lock);
+        return OS_OK;
+    }
+
+    FILE* in = fopen(source, "rb");
+    if (!in) {
+        ESP_LOGE(TAG, "Failed to open %s: %s", source, strerror(errno));
+        return OS_ERROR_NOT_FOUND;
+    }
+    FILE* out = fopen(dest, "wb");
+    if (!out) {
+        ESP_LOGE(TAG, "Failed to create %s: %s", dest, strerror(errno));
+        fclose(in);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    // Chunks go straight to the driver instead of through stdio's buffer
+    setvbuf(in, nullptr, _IONBF, 0);
+    setvbuf(out, nullptr, _IONBF, 0);
+
+    os_error_t result = pipe(in, out);
+    fclose(in);
+    if (fclose(out) != 0 && result == OS_OK) {
+        result = OS_ERROR_FILESYSTEM;
+    }
+
+    if (result != OS_OK) {
+        unlink(dest);
+        return result;
+    }
+    if (job.move && unlink(source) != 0) {
+        ESP_LOGW(TAG, "Copied %s but could not remove it: %s", source, strerror(errno));
+        return OS_ERROR_FILESYSTEM;
+    }
+    return OS_OK;
+}
+
+os_error_t FileCopier::pipe(FILE* in, FILE* out) {
+    m_writeFile = out;
+    m_writeFailed = false;
+    m_writeIndex = 0;
+
+    os_error_t result = OS_OK;
+    uint8_t readIndex = 0;
+    while (true) {
+        CopyControl* control = m_activeControl;
+        while (control && control->pause && !control->cancel && m_running) {
+            vTaskDelay(pdMS_TO_TICKS(OS_FILE_OP_PAUSE_POLL_MS));
+        }
+        if (m_cancelActive || !m_running || (control && control->cancel)) {
+            result = OS_ERROR_CANCELLED;
+            break;
+        }
+        if (m_writeFailed) {
+            result = OS_ERROR_FILESYSTEM;
+            break;
+        }
+
+        // Wait for the writer to hand back a chunk, then refill it
+        xSemaphoreTake(m_freeChunks, portMAX_DELAY);
+        Chunk& chunk = m_chunks[readIndex];
+        chunk.length = fread(chunk.data, 1, OS_STORAGE_COPY_CHUNK_SIZE, in);
+        if (chunk.length == 0) {
+            xSemaphoreGive(m_freeChunks);
+            if (ferror(in)) {
+                result = OS_ERROR_FILESYSTEM;
+            }
+            break;
+        }
+        xSemaphoreGive(m_fullChunks);
+        readIndex ^= 1;
+    }
+
+    // Both chunks free again means the writer is idle
+    xSemaphoreTake(m_freeChunks, portMAX_DELAY);
+    xSemaphoreTake(m_freeChunks, portMAX_DELAY);
+    xSemaphoreGive(m_freeChunks);
+    xSemaphoreGive(m_freeChunks);
+    m_writeFile = nullptr;
+
+    if (result == OS_OK && m_writeFailed) {
+        result = OS_ERROR_FILESYSTEM;
+    }
+    return result;
+}
+
+void FileCopier::copyTask(void* arg) {
+    FileCopier* copier = static_cast<FileCopier*>(arg);
+
+    while (copier->m_running) {
+        xSemaphoreTake(copier->m_lock, portMAX_DELAY);
+        if (copier->m_jobs.empty()) {
+            xSemaphoreGive(copier->m_lock);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        Job job = std::move(copier->m_jobs.front());
+        copier->m_jobs.pop_front();
+        copier->m_activeId = job.id;
+        copier->m_cancelActive = false;
+        copier->m_activeProgress = job.progress;
+        copier->m_activeControl = job.control;
+        copier->m_progress = {};
+        copier->m_progressDirty = false;
+        copier->m_startUs = esp_timer_get_time();
+        copier->m_lastReportMs = millis();
+        xSemaphoreGive(copier->m_lock);
+
+        os_error_t result = copier->execute(job);
+        if (result == OS_OK) {
+            copier->m_jobsDone++;
+        } else if (result != OS_ERROR_CANCELLED) {
+            copier->m_jobsFailed++;
+            ESP_LOGE(TAG, "Copy %s -> %s failed: %d", job.source.c_str(), job.dest.c_str(), result);
+        }
+        copier->finish(job, result);
+
+        xSemaphoreTake(copier->m_lock, portMAX_DELAY);
+        copier->m_activeId = 0;
+        copier->m_activeProgress = nullptr;
+        copier->m_activeControl = nullptr;
+        xSemaphoreGive(copier->m_lock);
+    }
+
+    copier->m_copyTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void FileCopier::writerTask(void* arg) {
+    FileCopier* copier = static_cast<FileCopier*>(arg);
+
+    while (true) {
+        xSemaphoreTake(copier->m_fullChunks, portMAX_DELAY);
+        if (!copier->m_running) {
+            break;
+        }
+
+        Chunk& chunk = copier->m_chunks[copier->m_writeIndex];
+        copier->m_writeIndex ^= 1;
+        bool written = !copier->m_writeFailed &&
+                       fwrite(chunk.data, 1, chunk.length, copier->m_writeFile) == chunk.length;
+        if (!written) {
+            copier->m_writeFailed = true;
+        }
+
+        if (written) {
+            xSemaphoreTake(copier->m_lock, portMAX_DELAY);
+            CopyProgress& progress = copier->m_progress;
+            progress.bytesCopied += chunk.length;
+            int64_t elapsedUs = esp_timer_get_time() - copier->m_startUs;
+            if (elapsedUs > 0) {
+                progress.bytesPerSecond = (uint32_t)(progress.bytesCopied * 1000000 / elapsedUs);
+            }
+            copier->m_bytesCopied += chunk.length;
+            if (copier->m_activeControl) {
+                copier->m_activeControl->bytesCopied = (uint32_t)progress.bytesCopied;
+            }
+            if (progress.bytesPerSecond > copier->m_peakBytesPerSecond &&
+                progress.bytesCopied >= 4 * OS_STORAGE_COPY_CHUNK_SIZE) {
+                copier->m_peakBytesPerSecond = progress.bytesPerSecond;
+            }
+            uint32_t now = millis();
+            bool report = copier->m_activeProgress &&
+                          now - copier->m_lastReportMs >= OS_STORAGE_COPY_PROGRESS_MS;
+            if (report) {
+                copier->m_lastReportMs = now;
+                copier->m_progressDirty = true;
+            }
+            xSemaphoreGive(copier->m_lock);
+
+            if (report) {
+                OS().wake();
+            }
+        }
+
+        xSemaphoreGive(copier->m_freeChunks);
+    }
+
+    copier->m_writerTask = nullptr;
+    vTaskDelete(nullptr);
+}
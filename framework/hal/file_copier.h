@@ -0,0 +1,206 @@
+#ifndef FILE_COPIER_H
+#define FILE_COPIER_H
+
+#include "../system/os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @file file_copier.h
+ * @brief Pipelined background file copy engine
+ *
+ * A copy streams through two OS_STORAGE_COPY_CHUNK_SIZE buffers in
+ * DMA-capable PSRAM: the copy task reads chunk N+1 from the source while
+ * a writer task writes chunk N to the destination, so with source and
+ * destination on different devices (SD card to flash) both are busy at
+ * once. Streams run unbuffered, so the card DMA moves data straight to
+ * and from the chunks.
+ *
+ * Jobs run one at a time in submission order. Progress and completion
+ * callbacks run on the main loop from dispatch().
+ */
+
+typedef uint32_t CopyJobId;
+
+struct CopyProgress {
+    uint64_t bytesCopied;       // Written to the destination so far
+    uint64_t totalBytes;        // Source size
+    uint32_t bytesPerSecond;    // Average since the job started
+};
+
+/**
+ * @brief Copy progress, at most every OS_STORAGE_COPY_PROGRESS_MS
+ */
+typedef std::function<void(const CopyProgress& progress)> CopyProgressCallback;
+
+/**
+ * @brief Copy completion
+ * @param result OS_OK, OS_ERROR_CANCELLED or error code
+ * @param progress Final byte counts and throughput
+ */
+typedef std::function<void(os_error_t result, const CopyProgress& progress)> CopyCompleteCallback;
+
+/**
+ * @brief Lets the caller of run() steer its job from another task
+ *
+ * FAT files stay under 4 GB, so the byte count fits one word and reads
+ * without tearing.
+ */
+struct CopyControl {
+    volatile bool cancel = false;           // Stop after the current chunk
+    volatile bool pause = false;            // Hold between chunks
+    volatile uint32_t bytesCopied = 0;      // Written so far
+};
+
+class FileCopier {
+public:
+    FileCopier() = default;
+    ~FileCopier();
+
+    /**
+     * @brief Allocate the chunk buffers and start the copy and writer tasks
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize();
+
+    /**
+     * @brief Cancel all jobs and stop the tasks
+     */
+    void shutdown();
+
+    /**
+     * @brief Queue a copy or move
+     *
+     * A move is a rename() when source and destination share a
+     * filesystem, otherwise a copy followed by deleting the source.
+     * @param source Source file path
+     * @param dest Destination file path (replaced if it exists)
+     * @param move True to remove the source afterwards
+     * @param progress Optional progress callback
+     * @param complete Optional completion callback
+     * @return Job ID or 0 if the queue is full or the engine is not running
+     */
+    CopyJobId submit(const char* source, const char* dest, bool move,
+                     CopyProgressCallback progress, CopyCompleteCallback complete);
+
+    /**
+     * @brief Run a copy or move on the engine and wait for it
+     *
+     * Callable from the main loop: it does not depend on dispatch().
+     * @param source Source file path
+     * @param dest Destination file path
+     * @param move True to remove the source afterwards
+     * @param control Optional pause/cancel flags and progress, read while the job runs
+     * @return OS_OK on success, OS_ERROR_CANCELLED or error code on failure
+     */
+    os_error_t run(const char* source, const char* dest, bool move, CopyControl* control = nullptr);
+
+    /**
+     * @brief Cancel a queued or running job
+     *
+     * A running job stops after its current chunk and removes the partial
+     * destination; its completion reports OS_ERROR_CANCELLED.
+     * @param id Job ID from submit()
+     * @return true if the job was found
+     */
+    bool cancel(CopyJobId id);
+
+    /**
+     * @brief Get a job's progress
+     * @param id Job ID
+     * @param progress Filled if the job is queued or running
+     * @return true if the job was found
+     */
+    bool getProgress(CopyJobId id, CopyProgress& progress) const;
+
+    /**
+     * @brief Run progress and completion callbacks (main loop)
+     */
+    void dispatch();
+
+    /**
+     * @brief Check if jobs are queued or running
+     * @return true if busy
+     */
+    bool isBusy() const { return m_activeId != 0 || !m_jobs.empty(); }
+
+    /**
+     * @brief Print copy statistics
+     */
+    void printStats() const;
+
+private:
+    struct Job {
+        CopyJobId id = 0;
+        std::string source;
+        std::string dest;
+        bool move = false;
+        CopyProgressCallback progress;
+        CopyCompleteCallback complete;
+        SemaphoreHandle_t done = nullptr;   // Set for run(); signalled instead of a callback
+        os_error_t* result = nullptr;
+        CopyControl* control = nullptr;
+    };
+
+    struct Completion {
+        CopyCompleteCallback callback;
+        os_error_t result;
+        CopyProgress progress;
+    };
+
+    struct Chunk {
+        uint8_t* data = nullptr;
+        size_t length = 0;
+    };
+
+    CopyJobId enqueue(Job job);
+    void finish(Job& job, os_error_t result);
+
+    /**
+     * @brief Copy one file through the chunk pipeline (copy task)
+     */
+    os_error_t execute(Job& job);
+    os_error_t pipe(FILE* in, FILE* out);
+
+    static void copyTask(void* arg);
+    static void writerTask(void* arg);
+
+    Chunk m_chunks[2];
+    SemaphoreHandle_t m_freeChunks = nullptr;   // Counting: chunks the reader may fill
+    SemaphoreHandle_t m_fullChunks = nullptr;   // Counting: chunks the writer may drain
+    FILE* m_writeFile = nullptr;                // Destination of the running job
+    volatile bool m_writeFailed = false;
+    uint8_t m_writeIndex = 0;
+
+    TaskHandle_t m_copyTask = nullptr;
+    TaskHandle_t m_writerTask = nullptr;
+    volatile bool m_running = false;
+
+    // Guards the queue, the running job's progress and the completions
+    SemaphoreHandle_t m_lock = nullptr;
+    std::deque<Job> m_jobs;
+    CopyJobId m_nextId = 0;
+    volatile CopyJobId m_activeId = 0;
+    volatile bool m_cancelActive = false;
+    CopyControl* m_activeControl = nullptr;
+    CopyProgressCallback m_activeProgress;
+    CopyProgress m_progress = {};
+    int64_t m_startUs = 0;
+    uint32_t m_lastReportMs = 0;
+    bool m_progressDirty = false;
+    std::vector<Completion> m_completions;
+
+    // Statistics
+    uint32_t m_jobsDone = 0;
+    uint32_t m_jobsFailed = 0;
+    uint64_t m_bytesCopied = 0;
+    uint32_t m_peakBytesPerSecond = 0;
+};
+
+#endif // FILE_COPIER_H
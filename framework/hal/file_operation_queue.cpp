@@ -0,0 +1,498 @@
+#include "file_operation_queue.h"
+#include "storage_hal.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "FileOps";
+
+static os_error_t listNames(const std::string& directory, std::vector<std::string>& names) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        ESP_LOGE(TAG, "Failed to open directory %s", directory.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            names.emplace_back(entry->d_name);
+        }
+    }
+    // Closed before anything below is changed
+    closedir(dir);
+    return OS_OK;
+}
+
+FileOperationQueue::~FileOperationQueue() {
+    shutdown();
+}
+
+os_error_t FileOperationQueue::initialize(StorageHAL* storage) {
+    if (m_running) {
+        return OS_OK;
+    }
+    if (!storage) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    m_storage = storage;
+    m_lock = xSemaphoreCreateMutex();
+    if (!m_lock) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_running = true;
+    if (xTaskCreatePinnedToCore(workerTask, "os_file_op", OS_FILE_OP_TASK_STACK, this,
+                                OS_FILE_OP_TASK_PRIORITY, &m_task, OS_FILE_OP_TASK_CORE) != pdPASS) {
+        m_task = nullptr;
+        shutdown();
+        return OS_ERROR_NO_MEMORY;
+    }
+    return OS_OK;
+}
+
+void FileOperationQueue::shutdown() {
+    if (m_lock) {
+        // Queued operations never start; the running one stops after its chunk
+        xSemaphoreTake(m_lock, portMAX_DELAY);
+        m_operations.clear();
+        m_control.cancel = true;
+        xSemaphoreGive(m_lock);
+    }
+
+    m_running = false;
+    if (m_task) {
+        TaskHandle_t task = m_task;
+        xTaskNotifyGive(task);
+        for (int attempt = 0; attempt < 200 && m_task; attempt++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Worker task did not exit, deleting");
+            vTaskDelete(task);
+            m_task = nullptr;
+        }
+    }
+
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+    m_completions.clear();
+    m_activeId = 0;
+    m_control.cancel = false;
+    m_control.pause = false;
+}
+
+FileOpId FileOperationQueue::submit(FileOpType type, const char* source, const char* dest) {
+    if (!source || (type != FileOpType::DELETE && !dest)) {
+        return 0;
+    }
+    if (!m_running || !m_task) {
+        return 0;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_operations.size() >= OS_FILE_OP_QUEUE_DEPTH) {
+        xSemaphoreGive(m_lock);
+        ESP_LOGW(TAG, "File operation queue full");
+        return 0;
+    }
+    Operation operation;
+    operation.id = ++m_nextId;
+    if (operation.id == 0) {
+        operation.id = ++m_nextId;
+    }
+    operation.type = type;
+    operation.source = source;
+    if (dest) {
+        operation.dest = dest;
+    }
+    FileOpId id = operation.id;
+    m_operations.push_back(std::move(operation));
+    xSemaphoreGive(m_lock);
+
+    xTaskNotifyGive(m_task);
+    return id;
+}
+
+bool FileOperationQueue::cancel(FileOpId id) {
+    if (id == 0 || !m_lock) {
+        return false;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_activeId == id) {
+        m_control.cancel = true;
+        xSemaphoreGive(m_lock);
+        return true;
+    }
+
+    for (auto it = m_operations.begin(); it != m_operations.end(); ++it) {
+        if (it->id == id) {
+            FileOpStatus status = {};
+            status.id = id;
+            status.type = it->type;
+            status.state = FileOpState::CANCELLED;
+            status.result = OS_ERROR_CANCELLED;
+            m_operations.erase(it);
+            m_completions.push_back(status);
+            xSemaphoreGive(m_lock);
+            OS().wake();
+            return true;
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return false;
+}
+
+void FileOperationQueue::setPaused(bool paused) {
+    if (!m_lock || m_control.pause == paused) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    m_control.pause = paused;
+    if (paused) {
+        m_pauseStartUs = now;
+    } else if (m_pauseStartUs != 0) {
+        m_pausedUs += now - m_pauseStartUs;
+        m_pauseStartUs = 0;
+    }
+    m_lastReportMs = millis() - OS_FILE_OP_PROGRESS_MS;  // Show the change on the next update
+    xSemaphoreGive(m_lock);
+}
+
+bool FileOperationQueue::getStatus(FileOpStatus& status) const {
+    if (!m_lock) {
+        return false;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    bool running = m_activeId != 0;
+    if (running) {
+        status = snapshot();
+    }
+    xSemaphoreGive(m_lock);
+    return running;
+}
+
+void FileOperationQueue::update() {
+    if (!m_lock) {
+        return;
+    }
+
+    FileOpStatus progress = {};
+    bool report = false;
+    std::vector<FileOpStatus> finished;
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    uint32_t now = millis();
+    if (m_activeId != 0 && now - m_lastReportMs >= OS_FILE_OP_PROGRESS_MS) {
+        m_lastReportMs = now;
+        progress = snapshot();
+        report = true;
+    }
+    finished.swap(m_completions);
+    xSemaphoreGive(m_lock);
+
+    // Payloads are copied into the events
+    if (report) {
+        PUBLISH_EVENT(EVENT_HAL_FILE_OP_PROGRESS, &progress, sizeof(progress));
+    }
+    for (auto& status : finished) {
+        PUBLISH_EVENT(EVENT_HAL_FILE_OP_COMPLETE, &status, sizeof(status));
+    }
+}
+
+void FileOperationQueue::printStats() const {
+    ESP_LOGI(TAG, "File operations: %d done, %d failed, %d files, %d renamed whole",
+             m_operationsDone, m_operationsFailed, m_filesProcessed, m_renames);
+}
+
+FileOpStatus FileOperationQueue::snapshot() const {
+    FileOpStatus status = {};
+    status.id = m_activeId;
+    status.type = m_activeType;
+    status.state = m_state == FileOpState::RUNNING && m_control.pause ? FileOpState::PAUSED : m_state;
+    status.filesDone = m_filesDone;
+    status.filesTotal = m_filesTotal;
+    status.etaSeconds = FILE_OP_ETA_UNKNOWN;
+
+    uint64_t bytesDone = m_bytesDone;
+    if (m_state == FileOpState::RUNNING) {
+        bytesDone += m_control.bytesCopied;
+    }
+    bytesDone = std::min(bytesDone, m_bytesTotal);
+    status.kbDone = (uint32_t)(bytesDone / 1024);
+    status.kbTotal = (uint32_t)(m_bytesTotal / 1024);
+    if (m_startUs == 0) {
+        return status;      // Still counting
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t activeUs = now - m_startUs - m_pausedUs - (m_pauseStartUs ? now - m_pauseStartUs : 0);
+    if (activeUs <= 0) {
+        return status;
+    }
+    status.kbPerSecond = (uint16_t)std::min<uint64_t>(bytesDone * 1000000 / activeUs / 1024, 0xFFFF);
+    if (m_state != FileOpState::RUNNING) {
+        return status;
+    }
+
+    // Deletes cost per file, copies per byte
+    uint64_t remainingUs = 0;
+    if (m_activeType != FileOpType::DELETE && bytesDone > 0) {
+        remainingUs = (m_bytesTotal - bytesDone) * activeUs / bytesDone;
+    } else if (m_filesDone > 0) {
+        remainingUs = (uint64_t)(m_filesTotal - m_filesDone) * activeUs / m_filesDone;
+    } else {
+        return status;
+    }
+    status.etaSeconds = (uint16_t)std::min<uint64_t>((remainingUs + 999999) / 1000000, FILE_OP_ETA_UNKNOWN - 1);
+    return status;
+}
+
+os_error_t FileOperationQueue::checkpoint() {
+    while (m_control.pause && !m_control.cancel && m_running) {
+        vTaskDelay(pdMS_TO_TICKS(OS_FILE_OP_PAUSE_POLL_MS));
+    }
+    return m_control.cancel || !m_running ? OS_ERROR_CANCELLED : OS_OK;
+}
+
+void FileOperationQueue::noteFileDone(uint64_t bytes) {
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_filesDone++;
+    m_bytesDone += bytes;
+    m_control.bytesCopied = 0;
+    xSemaphoreGive(m_lock);
+    m_filesProcessed++;
+}
+
+os_error_t FileOperationQueue::execute(const Operation& operation) {
+    const std::string& source = operation.source;
+    const std::string& dest = operation.dest;
+
+    struct stat st;
+    if (stat(source.c_str(), &st) != 0) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    bool directory = S_ISDIR(st.st_mode);
+    if (operation.type != FileOpType::DELETE) {
+        // A tree copied into itself would never finish
+        if (dest.empty() || dest == source ||
+            (directory && dest.compare(0, source.size() + 1, source + "/") == 0)) {
+            return OS_ERROR_INVALID_PARAM;
+        }
+    }
+
+    os_error_t result = OS_OK;
+    if (directory) {
+        result = scan(source, 0);
+    } else {
+        xSemaphoreTake(m_lock, portMAX_DELAY);
+        m_filesTotal = 1;
+        m_bytesTotal = st.st_size;
+        xSemaphoreGive(m_lock);
+    }
+    if (result != OS_OK) {
+        return result;
+    }
+
+    // Rate and ETA count from here, not from the walk
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_state = FileOpState::RUNNING;
+    m_startUs = esp_timer_get_time();
+    m_pausedUs = 0;
+    m_pauseStartUs = m_control.pause ? m_startUs : 0;
+    xSemaphoreGive(m_lock);
+
+    switch (operation.type) {
+        case FileOpType::DELETE:
+            return deleteTree(source, 0);
+
+        case FileOpType::MOVE:
+            // Same volume: one directory update moves the whole tree
+            result = checkpoint();
+            if (result != OS_OK) {
+                return result;
+            }
+            if (m_storage->renamePath(source.c_str(), dest.c_str()) == OS_OK) {
+                xSemaphoreTake(m_lock, portMAX_DELAY);
+                m_filesDone = m_filesTotal;
+                m_bytesDone = m_bytesTotal;
+                xSemaphoreGive(m_lock);
+                m_filesProcessed += m_filesTotal;
+                m_renames++;
+                return OS_OK;
+            }
+            return copyTree(source, dest, true, 0);
+
+        case FileOpType::COPY:
+        default:
+            return copyTree(source, dest, false, 0);
+    }
+}
+
+os_error_t FileOperationQueue::scan(const std::string& path, int depth) {
+    if (depth > OS_FILE_OP_MAX_DEPTH) {
+        ESP_LOGE(TAG, "Tree too deep at %s", path.c_str());
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    std::vector<std::string> names;
+    os_error_t result = listNames(path, names);
+    for (size_t i = 0; i < names.size() && result == OS_OK; i++) {
+        result = checkpoint();
+        if (result != OS_OK) {
+            break;
+        }
+        std::string child = path + "/" + names[i];
+        struct stat st;
+        if (stat(child.c_str(), &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            result = scan(child, depth + 1);
+        } else {
+            xSemaphoreTake(m_lock, portMAX_DELAY);
+            m_filesTotal++;
+            m_bytesTotal += st.st_size;
+            xSemaphoreGive(m_lock);
+        }
+    }
+    return result;
+}
+
+os_error_t FileOperationQueue::copyTree(const std::string& source, const std::string& dest, bool move, int depth) {
+    if (depth > OS_FILE_OP_MAX_DEPTH) {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+    os_error_t result = checkpoint();
+    if (result != OS_OK) {
+        return result;
+    }
+
+    struct stat st;
+    if (stat(source.c_str(), &st) != 0) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        // Streams through the copy engine, which also honours the pause and cancel flags
+        m_control.bytesCopied = 0;
+        result = move ? m_storage->moveFile(source.c_str(), dest.c_str(), &m_control)
+                      : m_storage->copyFile(source.c_str(), dest.c_str(), &m_control);
+        if (result == OS_OK) {
+            noteFileDone(st.st_size);
+        }
+        return result;
+    }
+
+    result = m_storage->createDirectory(dest.c_str());
+    if (result != OS_OK) {
+        return result;
+    }
+    std::vector<std::string> names;
+    result = listNames(source, names);
+    for (size_t i = 0; i < names.size() && result == OS_OK; i++) {
+        result = copyTree(source + "/" + names[i], dest + "/" + names[i], move, depth + 1);
+    }
+    if (result == OS_OK && move) {
+        result = m_storage->removeDirectory(source.c_str());
+    }
+    return result;
+}
+
+os_error_t FileOperationQueue::deleteTree(const std::string& path, int depth) {
+    if (depth > OS_FILE_OP_MAX_DEPTH) {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+    os_error_t result = checkpoint();
+    if (result != OS_OK) {
+        return result;
+    }
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        result = m_storage->deleteFile(path.c_str());
+        if (result == OS_OK) {
+            noteFileDone(st.st_size);
+        }
+        return result;
+    }
+
+    std::vector<std::string> names;
+    result = listNames(path, names);
+    for (size_t i = 0; i < names.size() && result == OS_OK; i++) {
+        result = deleteTree(path + "/" + names[i], depth + 1);
+    }
+    if (result == OS_OK) {
+        result = m_storage->removeDirectory(path.c_str());
+    }
+    return result;
+}
+
+void FileOperationQueue::workerTask(void* arg) {
+    FileOperationQueue* queue = static_cast<FileOperationQueue*>(arg);
+
+    while (queue->m_running) {
+        xSemaphoreTake(queue->m_lock, portMAX_DELAY);
+        if (queue->m_operations.empty()) {
+            xSemaphoreGive(queue->m_lock);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        Operation operation = std::move(queue->m_operations.front());
+        queue->m_operations.pop_front();
+        queue->m_activeId = operation.id;
+        queue->m_activeType = operation.type;
+        queue->m_state = FileOpState::SCANNING;
+        queue->m_filesDone = 0;
+        queue->m_filesTotal = 0;
+        queue->m_bytesDone = 0;
+        queue->m_bytesTotal = 0;
+        queue->m_startUs = 0;
+        queue->m_control.cancel = false;
+        queue->m_control.bytesCopied = 0;
+        queue->m_lastReportMs = millis() - OS_FILE_OP_PROGRESS_MS;
+        xSemaphoreGive(queue->m_lock);
+
+        int64_t startUs = esp_timer_get_time();
+        os_error_t result = queue->execute(operation);
+        if (result == OS_OK) {
+            queue->m_operationsDone++;
+            ESP_LOGI(TAG, "%s %s: %d files, %llu bytes in %lld ms",
+                     operation.type == FileOpType::DELETE ? "Deleted" :
+                     operation.type == FileOpType::MOVE ? "Moved" : "Copied",
+                     operation.source.c_str(), queue->m_filesDone, queue->m_bytesDone,
+                     (esp_timer_get_time() - startUs) / 1000);
+        } else if (result != OS_ERROR_CANCELLED) {
+            queue->m_operationsFailed++;
+            ESP_LOGE(TAG, "Operation on %s failed: %d", operation.source.c_str(), result);
+        }
+
+        xSemaphoreTake(queue->m_lock, portMAX_DELAY);
+        queue->m_state = result == OS_OK ? FileOpState::DONE :
+                         result == OS_ERROR_CANCELLED ? FileOpState::CANCELLED : FileOpState::FAILED;
+        FileOpStatus status = queue->snapshot();
+        status.result = (int8_t)result;
+        status.etaSeconds = 0;
+        queue->m_completions.push_back(status);
+        queue->m_activeId = 0;
+        xSemaphoreGive(queue->m_lock);
+
+        // The event goes out from the main loop, which may be asleep
+        OS().wake();
+    }
+
+    queue->m_task = nullptr;
+    vTaskDelete(nullptr);
+}
@@ -0,0 +1,205 @@
+#ifndef FILE_OPERATION_QUEUE_H
+#define FILE_OPERATION_QUEUE_H
+
+#include "../system/os_config.h"
+#include "file_copier.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @file file_operation_queue.h
+ * @brief Background copy, move and delete of files and directory trees
+ *
+ * Operations queue behind each other and run on a worker task, so a UI
+ * callback only submits them. Each one first walks its source to count
+ * files and bytes, which gives the progress total and the ETA, then:
+ * - a move tries one rename() of the whole tree, which succeeds when
+ *   source and destination share a volume;
+ * - a copy, or a move across volumes, recreates the directories and
+ *   streams every file through the chunked copy engine (FileCopier),
+ *   removing each source file once it has been copied;
+ * - a delete removes files bottom-up, then the emptied directories.
+ * All changes go through StorageHAL so its caches stay coherent.
+ *
+ * Progress is published as EVENT_HAL_FILE_OP_PROGRESS from update() on the
+ * main loop, at most every OS_FILE_OP_PROGRESS_MS and coalesced to the
+ * latest; EVENT_HAL_FILE_OP_COMPLETE follows once per operation. Both carry
+ * a FileOpStatus. Pausing holds the worker between files and the copy
+ * engine between chunks; cancelling stops after the current chunk and
+ * leaves what was already done in place.
+ */
+
+class StorageHAL;
+
+typedef uint32_t FileOpId;
+
+enum class FileOpType : uint8_t {
+    COPY,
+    MOVE,
+    DELETE
+};
+
+enum class FileOpState : uint8_t {
+    QUEUED,
+    SCANNING,       // Counting the source tree
+    RUNNING,
+    PAUSED,
+    DONE,
+    FAILED,
+    CANCELLED
+};
+
+/**
+ * @brief Progress of one operation; the payload of the file operation events
+ */
+struct FileOpStatus {
+    FileOpId id;
+    uint32_t filesDone;
+    uint32_t filesTotal;
+    uint32_t kbDone;
+    uint32_t kbTotal;
+    uint16_t kbPerSecond;       // Average over the time spent running, pauses excluded
+    uint16_t etaSeconds;        // FILE_OP_ETA_UNKNOWN until there is a rate to go by
+    FileOpType type;
+    FileOpState state;
+    int8_t result;              // os_error_t once finished
+};
+
+static constexpr uint16_t FILE_OP_ETA_UNKNOWN = 0xFFFF;
+static_assert(sizeof(FileOpStatus) < OS_EVENT_INLINE_PAYLOAD, "FileOpStatus must travel inline in events");
+
+class FileOperationQueue {
+public:
+    FileOperationQueue() = default;
+    ~FileOperationQueue();
+
+    /**
+     * @brief Start the worker task
+     * @param storage Storage HAL the operations go through; must outlive the queue
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(StorageHAL* storage);
+
+    /**
+     * @brief Cancel all operations and stop the worker
+     */
+    void shutdown();
+
+    /**
+     * @brief Queue an operation on a file or directory
+     * @param type Copy, move or delete
+     * @param source Source path
+     * @param dest Destination path, replaced or merged into (ignored for delete)
+     * @return Operation ID or 0 if the queue is full or the worker is not running
+     */
+    FileOpId submit(FileOpType type, const char* source, const char* dest);
+
+    /**
+     * @brief Cancel a queued or running operation
+     * @param id Operation ID from submit()
+     * @return true if the operation was found
+     */
+    bool cancel(FileOpId id);
+
+    /**
+     * @brief Hold or resume the running operation and everything queued
+     * @param paused True to pause
+     */
+    void setPaused(bool paused);
+
+    /**
+     * @brief Check if operations are paused
+     * @return true if paused
+     */
+    bool isPaused() const { return m_control.pause; }
+
+    /**
+     * @brief Get the running operation's progress
+     * @param status Filled while an operation runs
+     * @return true if an operation is running
+     */
+    bool getStatus(FileOpStatus& status) const;
+
+    /**
+     * @brief Check if operations are queued or running
+     * @return true if busy
+     */
+    bool isBusy() const { return m_activeId != 0 || !m_operations.empty(); }
+
+    /**
+     * @brief Publish progress and completion events (main loop)
+     */
+    void update();
+
+    /**
+     * @brief Print operation statistics
+     */
+    void printStats() const;
+
+private:
+    struct Operation {
+        FileOpId id = 0;
+        FileOpType type = FileOpType::COPY;
+        std::string source;
+        std::string dest;
+    };
+
+    os_error_t execute(const Operation& operation);
+    os_error_t scan(const std::string& path, int depth);
+    os_error_t copyTree(const std::string& source, const std::string& dest, bool move, int depth);
+    os_error_t deleteTree(const std::string& path, int depth);
+
+    /**
+     * @brief Wait out a pause and check for cancellation (worker task)
+     * @return OS_OK to carry on, OS_ERROR_CANCELLED to stop
+     */
+    os_error_t checkpoint();
+
+    /**
+     * @brief Account for a finished file (worker task)
+     */
+    void noteFileDone(uint64_t bytes);
+
+    /**
+     * @brief Build the event payload for the running operation (lock held)
+     */
+    FileOpStatus snapshot() const;
+
+    static void workerTask(void* arg);
+
+    StorageHAL* m_storage = nullptr;
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_running = false;
+
+    // Guards the queue, the running operation's counters and the completions
+    SemaphoreHandle_t m_lock = nullptr;
+    std::deque<Operation> m_operations;
+    FileOpId m_nextId = 0;
+    volatile FileOpId m_activeId = 0;
+    FileOpType m_activeType = FileOpType::COPY;
+    FileOpState m_state = FileOpState::QUEUED;
+    uint32_t m_filesDone = 0;
+    uint32_t m_filesTotal = 0;
+    uint64_t m_bytesDone = 0;           // Files finished; the copy engine counts the current one
+    uint64_t m_bytesTotal = 0;
+    int64_t m_startUs = 0;
+    int64_t m_pausedUs = 0;             // Time spent paused since m_startUs
+    int64_t m_pauseStartUs = 0;
+    uint32_t m_lastReportMs = 0;
+    std::vector<FileOpStatus> m_completions;
+
+    // Shared with the copy engine for the file being copied
+    CopyControl m_control;
+
+    // Statistics
+    uint32_t m_operationsDone = 0;
+    uint32_t m_operationsFailed = 0;
+    uint32_t m_filesProcessed = 0;
+    uint32_t m_renames = 0;
+};
+
+#endif // FILE_OPERATION_QUEUE_H
@@ -0,0 +1,251 @@
+#include "gesture_recognizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static float distance(float dx, float dy) {
+    return sqrtf(dx * dx + dy * dy);
+}
+
+uint8_t GestureRecognizer::update(const TouchPoint* points, uint8_t count, uint32_t now,
+                                  TouchEventData* out) {
+    uint8_t n = 0;
+
+    if (count == 0) {
+        if (m_state == State::SINGLE) {
+            releaseSingle(now, out, n);
+        } else {
+            endContinuous(now, out, n);
+        }
+        m_state = State::IDLE;
+        return n;
+    }
+
+    switch (m_state) {
+        case State::IDLE:
+            if (count == 1) {
+                beginSingle(points[0], now);
+            } else if (count == 2) {
+                beginTwoFinger(points[0], points[1]);
+            } else {
+                m_state = State::WAIT_RELEASE;
+            }
+            break;
+
+        case State::SINGLE:
+        case State::LONG_PRESSED:
+        case State::SWIPING:
+        case State::DRAGGING:
+            if (count == 1 && points[0].id == m_id) {
+                updateSingle(points[0], now, out, n);
+            } else if (count == 2 && (m_state == State::SINGLE || m_state == State::DRAGGING)) {
+                // Second finger joined before a one-finger gesture was claimed
+                beginTwoFinger(points[0], points[1]);
+            } else {
+                endContinuous(now, out, n);
+                m_state = State::WAIT_RELEASE;
+            }
+            break;
+
+        case State::TWO_FINGER:
+        case State::TRANSFORMING:
+            updateTwoFinger(points, count, now, out, n);
+            break;
+
+        case State::WAIT_RELEASE:
+            break;
+    }
+
+    checkLongPress(now, out, n);
+    return n;
+}
+
+uint8_t GestureRecognizer::poll(uint32_t now, TouchEventData* out) {
+    uint8_t n = 0;
+    checkLongPress(now, out, n);
+    return n;
+}
+
+uint32_t GestureRecognizer::getTimeUntilDeadline(uint32_t now) const {
+    if (m_state != State::SINGLE || m_moved) {
+        return UINT32_MAX;
+    }
+
+    uint32_t held = now - m_downTime;
+    return held >= OS_GESTURE_LONG_PRESS_MS ? 0 : OS_GESTURE_LONG_PRESS_MS - held;
+}
+
+void GestureRecognizer::reset() {
+    m_state = State::IDLE;
+    m_active = GestureType::NONE;
+    m_lastTapTime = 0;
+}
+
+void GestureRecognizer::beginSingle(const TouchPoint& point, uint32_t now) {
+    m_state = State::SINGLE;
+    m_active = GestureType::NONE;
+    m_id = point.id;
+    m_downTime = now;
+    m_lastTime = now;
+    m_startX = point.x;
+    m_startY = point.y;
+    m_point = point;
+    m_velocityX = 0.0f;
+    m_velocityY = 0.0f;
+    m_moved = false;
+    m_scale = 1.0f;
+    m_rotation = 0.0f;
+}
+
+void GestureRecognizer::updateSingle(const TouchPoint& point, uint32_t now,
+                                     TouchEventData* out, uint8_t& n) {
+    // Velocity from consecutive samples, lightly smoothed for the fling
+    if (now > m_lastTime) {
+        float dt = (now - m_lastTime) / 1000.0f;
+        m_velocityX = 0.5f * m_velocityX + 0.5f * ((int)point.x - (int)m_point.x) / dt;
+        m_velocityY = 0.5f * m_velocityY + 0.5f * ((int)point.y - (int)m_point.y) / dt;
+    }
+    m_point = point;
+    m_lastTime = now;
+
+    int dx = (int)point.x - m_startX;
+    int dy = (int)point.y - m_startY;
+    if (!m_moved && dx * dx + dy * dy > OS_GESTURE_SLOP_PX * OS_GESTURE_SLOP_PX) {
+        m_moved = true;
+    }
+
+    if (m_state == State::SINGLE && m_moved) {
+        int major = std::max(abs(dx), abs(dy));
+        int minor = std::min(abs(dx), abs(dy));
+        if (major >= OS_GESTURE_SWIPE_PX) {
+            if (major >= 2 * minor) {
+                if (abs(dx) > abs(dy)) {
+                    m_active = dx > 0 ? GestureType::SWIPE_RIGHT : GestureType::SWIPE_LEFT;
+                } else {
+                    m_active = dy > 0 ? GestureType::SWIPE_DOWN : GestureType::SWIPE_UP;
+                }
+                m_state = State::SWIPING;
+                emit(m_active, GesturePhase::BEGIN, now, out, n);
+            } else {
+                m_state = State::DRAGGING;
+            }
+        }
+    } else if (m_state == State::SWIPING) {
+        emit(m_active, GesturePhase::UPDATE, now, out, n);
+    }
+}
+
+void GestureRecognizer::releaseSingle(uint32_t now, TouchEventData* out, uint8_t& n) {
+    if (m_moved || now - m_downTime >= OS_GESTURE_TAP_MS) {
+        return;
+    }
+
+    float gap = distance((float)m_point.x - m_lastTap.x, (float)m_point.y - m_lastTap.y);
+    if (m_lastTapTime != 0 && now - m_lastTapTime < OS_GESTURE_DOUBLE_TAP_MS &&
+        gap < 2 * OS_GESTURE_SLOP_PX) {
+        emit(GestureType::DOUBLE_TAP, GesturePhase::BEGIN, now, out, n);
+        m_lastTapTime = 0;
+        return;
+    }
+
+    emit(GestureType::TAP, GesturePhase::BEGIN, now, out, n);
+    m_lastTapTime = now;
+    m_lastTap = m_point;
+}
+
+void GestureRecognizer::checkLongPress(uint32_t now, TouchEventData* out, uint8_t& n) {
+    if (m_state == State::SINGLE && !m_moved && now - m_downTime >= OS_GESTURE_LONG_PRESS_MS) {
+        m_state = State::LONG_PRESSED;
+        emit(GestureType::LONG_PRESS, GesturePhase::BEGIN, now, out, n);
+    }
+}
+
+void GestureRecognizer::beginTwoFinger(const TouchPoint& a, const TouchPoint& b) {
+    m_state = State::TWO_FINGER;
+    m_active = GestureType::NONE;
+    m_ids[0] = a.id;
+    m_ids[1] = b.id;
+    m_startSpan = std::max(distance((float)a.x - b.x, (float)a.y - b.y), 1.0f);
+    m_lastAngle = angleOf(a, b);
+    m_scale = 1.0f;
+    m_rotation = 0.0f;
+    m_velocityX = 0.0f;
+    m_velocityY = 0.0f;
+}
+
+void GestureRecognizer::updateTwoFinger(const TouchPoint* points, uint8_t count, uint32_t now,
+                                        TouchEventData* out, uint8_t& n) {
+    const TouchPoint* a = nullptr;
+    const TouchPoint* b = nullptr;
+    if (count == 2) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (points[i].id == m_ids[0]) a = &points[i];
+            if (points[i].id == m_ids[1]) b = &points[i];
+        }
+    }
+    if (!a || !b) {
+        // A finger lifted or was replaced: the transform is over
+        endContinuous(now, out, n);
+        m_state = State::WAIT_RELEASE;
+        return;
+    }
+
+    float span = distance((float)a->x - b->x, (float)a->y - b->y);
+    float angle = angleOf(*a, *b);
+    float delta = angle - m_lastAngle;
+    if (delta > 180.0f) delta -= 360.0f;
+    if (delta < -180.0f) delta += 360.0f;
+    m_rotation += delta;
+    m_lastAngle = angle;
+    m_scale = span / m_startSpan;
+
+    m_point = *a;
+    m_point.x = (a->x + b->x) / 2;
+    m_point.y = (a->y + b->y) / 2;
+
+    if (m_state == State::TWO_FINGER) {
+        if (fabsf(span - m_startSpan) >= OS_GESTURE_PINCH_PX) {
+            m_active = span > m_startSpan ? GestureType::PINCH_OUT : GestureType::PINCH_IN;
+        } else if (fabsf(m_rotation) >= OS_GESTURE_ROTATE_DEG) {
+            m_active = GestureType::ROTATE;
+        }
+        if (m_active != GestureType::NONE) {
+            m_state = State::TRANSFORMING;
+            emit(m_active, GesturePhase::BEGIN, now, out, n);
+        }
+    } else {
+        emit(m_active, GesturePhase::UPDATE, now, out, n);
+    }
+}
+
+void GestureRecognizer::endContinuous(uint32_t now, TouchEventData* out, uint8_t& n) {
+    if (m_active == GestureType::NONE) {
+        return;
+    }
+    emit(m_active, GesturePhase::END, now, out, n);
+    m_active = GestureType::NONE;
+}
+
+void GestureRecognizer::emit(GestureType type, GesturePhase phase, uint32_t now,
+                             TouchEventData* out, uint8_t& n) const {
+    if (n >= MAX_EVENTS) {
+        return;
+    }
+
+    TouchEventData& event = out[n++];
+    event = TouchEventData();
+    event.event = TouchEvent::GESTURE;
+    event.gesture = type;
+    event.phase = phase;
+    event.point = m_point;
+    event.timestamp = now;
+    event.scale = m_scale;
+    event.rotation = m_rotation;
+    event.velocityX = (int16_t)std::max(-32767.0f, std::min(32767.0f, m_velocityX));
+    event.velocityY = (int16_t)std::max(-32767.0f, std::min(32767.0f, m_velocityY));
+}
+
+float GestureRecognizer::angleOf(const TouchPoint& a, const TouchPoint& b) {
+    // Screen y grows downwards, so increasing angle is clockwise
+    return atan2f((float)b.y - a.y, (float)b.x - a.x) * 180.0f / (float)M_PI;
+}
@@ -0,0 +1,112 @@
+#ifndef GESTURE_RECOGNIZER_H
+#define GESTURE_RECOGNIZER_H
+
+#include "touch_types.h"
+
+/**
+ * @file gesture_recognizer.h
+ * @brief Incremental multi-touch gesture recognizer
+ *
+ * A state machine advanced on every touch sample rather than after the
+ * fingers lift. One finger becomes a tap, double tap, long press (while
+ * still held) or a swipe as soon as its travel is unambiguous; two
+ * fingers become a pinch or rotate once the span or angle moves past its
+ * threshold, then stream continuous scale and rotation until a finger
+ * lifts. Fixed-size state only; no allocation.
+ */
+
+class GestureRecognizer {
+public:
+    static const uint8_t MAX_EVENTS = 4;    // Events one call can produce
+
+    GestureRecognizer() = default;
+
+    /**
+     * @brief Advance the state machine with a new touch set
+     * @param points Current touch points
+     * @param count Number of points
+     * @param now Sample time in milliseconds
+     * @param out Output events (room for MAX_EVENTS)
+     * @return Number of events written
+     */
+    uint8_t update(const TouchPoint* points, uint8_t count, uint32_t now, TouchEventData* out);
+
+    /**
+     * @brief Fire time-based gestures (long press) between samples
+     * @param now Current time in milliseconds
+     * @param out Output events (room for MAX_EVENTS)
+     * @return Number of events written
+     */
+    uint8_t poll(uint32_t now, TouchEventData* out);
+
+    /**
+     * @brief Get time until poll() could next fire a gesture
+     * @param now Current time in milliseconds
+     * @return Milliseconds, UINT32_MAX if nothing is pending
+     */
+    uint32_t getTimeUntilDeadline(uint32_t now) const;
+
+    /**
+     * @brief Check if fingers are down or a gesture is in progress
+     * @return true if active
+     */
+    bool isActive() const { return m_state != State::IDLE; }
+
+    /**
+     * @brief Abandon any gesture in progress
+     */
+    void reset();
+
+private:
+    enum class State {
+        IDLE,           // No fingers
+        SINGLE,         // One finger, not yet classified
+        LONG_PRESSED,   // Long press sent, waiting for release
+        SWIPING,        // Swipe recognized, streaming velocity
+        DRAGGING,       // One finger moved without a dominant direction
+        TWO_FINGER,     // Two fingers, below pinch/rotate thresholds
+        TRANSFORMING,   // Pinch or rotate recognized, streaming scale/angle
+        WAIT_RELEASE    // Gesture over or ambiguous; ignore until all fingers lift
+    };
+
+    void beginSingle(const TouchPoint& point, uint32_t now);
+    void beginTwoFinger(const TouchPoint& a, const TouchPoint& b);
+    void updateSingle(const TouchPoint& point, uint32_t now, TouchEventData* out, uint8_t& n);
+    void updateTwoFinger(const TouchPoint* points, uint8_t count, uint32_t now,
+                         TouchEventData* out, uint8_t& n);
+    void releaseSingle(uint32_t now, TouchEventData* out, uint8_t& n);
+    void checkLongPress(uint32_t now, TouchEventData* out, uint8_t& n);
+    void endContinuous(uint32_t now, TouchEventData* out, uint8_t& n);
+
+    void emit(GestureType type, GesturePhase phase, uint32_t now,
+              TouchEventData* out, uint8_t& n) const;
+
+    static float angleOf(const TouchPoint& a, const TouchPoint& b);
+
+    State m_state = State::IDLE;
+    GestureType m_active = GestureType::NONE;   // Continuous gesture being streamed
+
+    // Single finger
+    uint8_t m_id = 0;
+    uint32_t m_downTime = 0;
+    uint32_t m_lastTime = 0;
+    int16_t m_startX = 0;
+    int16_t m_startY = 0;
+    TouchPoint m_point;
+    float m_velocityX = 0.0f;
+    float m_velocityY = 0.0f;
+    bool m_moved = false;               // Left the tap slop
+
+    // Previous tap, for double tap
+    uint32_t m_lastTapTime = 0;
+    TouchPoint m_lastTap;
+
+    // Two fingers
+    uint8_t m_ids[2] = {};
+    float m_startSpan = 0.0f;
+    float m_lastAngle = 0.0f;
+    float m_scale = 1.0f;
+    float m_rotation = 0.0f;
+};
+
+#endif // GESTURE_RECOGNIZER_H
@@ -1,6 +1,7 @@
 #include "hal_manager.h"
 #include <esp_log.h>
 #include <esp_system.h>
+#include <algorithm>
 
 static const char* TAG = "HALManager";
 
@@ -15,22 +16,95 @@ os_error_t HALManager::initialize() {
 
     ESP_LOGI(TAG, "Initializing HAL Manager");
 
-    // Initialize hardware components
-    os_error_t result = initializeComponents();
+    // Without a worker pool the graph runs its stages in order on this task
+    BootGraph graph;
+    os_error_t result = addBootStages(graph, {});
+    if (result == OS_OK) {
+        result = graph.run();
+    }
     if (result != OS_OK) {
         ESP_LOGE(TAG, "Failed to initialize hardware components: %d", result);
         return result;
     }
 
-    // Build hardware info string
-    snprintf(m_hardwareInfo, sizeof(m_hardwareInfo),
-             "M5Stack Tab5 ESP32-P4 %dx%d Display GT911 Touch",
-             OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT);
+    return OS_OK;
+}
 
-    m_initialized = true;
-    ESP_LOGI(TAG, "HAL Manager initialized: %s", m_hardwareInfo);
+os_error_t HALManager::addBootStages(BootGraph& graph, const std::vector<const char*>& after) {
+    if (m_initialized) {
+        return OS_ERROR_BUSY;
+    }
 
-    return OS_OK;
+    // Storage is created up front: the asset pack mounts on the main task
+    // while its filesystems mount on a worker
+    m_storageHAL = new StorageHAL();
+    if (!m_storageHAL) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    os_error_t result = graph.addStage("display", [this]() {
+        m_displayHAL = new DisplayHAL();
+        if (!m_displayHAL || m_displayHAL->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Display HAL");
+            return OS_ERROR_HARDWARE;
+        }
+        return OS_OK;
+    }, after, BootAffinity::MAIN);
+
+    if (result == OS_OK) {
+        result = graph.addStage("touch", [this]() {
+            m_touchHAL = new TouchHAL();
+            if (!m_touchHAL || m_touchHAL->initialize() != OS_OK) {
+                ESP_LOGE(TAG, "Failed to initialize Touch HAL");
+                return OS_ERROR_HARDWARE;
+            }
+            return OS_OK;
+        }, after, BootAffinity::WORKER);
+    }
+
+    if (result == OS_OK) {
+        result = graph.addStage("power", [this]() {
+            m_powerHAL = new PowerHAL();
+            if (!m_powerHAL || m_powerHAL->initialize() != OS_OK) {
+                ESP_LOGE(TAG, "Failed to initialize Power HAL");
+                return OS_ERROR_HARDWARE;
+            }
+            return OS_OK;
+        }, after, BootAffinity::WORKER);
+    }
+
+    if (result == OS_OK) {
+        // The asset pack registers an LVGL driver, so it waits for lv_init()
+        result = graph.addStage("assets", [this]() {
+            m_storageHAL->mountAssets();    // Running without a pack is fine
+            return OS_OK;
+        }, {"display"}, BootAffinity::MAIN);
+    }
+
+    if (result == OS_OK) {
+        result = graph.addStage("storage", [this]() {
+            if (m_storageHAL->initialize() != OS_OK) {
+                ESP_LOGE(TAG, "Failed to initialize Storage HAL");
+                return OS_ERROR_HARDWARE;
+            }
+            return OS_OK;
+        }, after, BootAffinity::WORKER);
+    }
+
+    if (result == OS_OK) {
+        result = graph.addStage("hal", [this]() {
+            // Build hardware info string
+            snprintf(m_hardwareInfo, sizeof(m_hardwareInfo),
+                     "M5Stack Tab5 ESP32-P4 %dx%d Display GT911 Touch",
+                     OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT);
+
+            m_initialized = true;
+            ESP_LOGI(TAG, "HAL Manager initialized: %s", m_hardwareInfo);
+            return OS_OK;
+        }, {"display", "assets", "touch", "power"}, BootAffinity::MAIN);
+    }
+
+    return result;
 }
 
 os_error_t HALManager::shutdown() {
@@ -96,6 +170,24 @@ os_error_t HALManager::update(uint32_t deltaTime) {
     return OS_OK;
 }
 
+uint32_t HALManager::getTimeUntilNextDeadline() const {
+    uint32_t next = UINT32_MAX;
+
+    if (m_displayHAL) {
+        next = std::min(next, m_displayHAL->getTimeUntilNextRefresh());
+    }
+
+    if (m_touchHAL) {
+        next = std::min(next, m_touchHAL->getTimeUntilNextPoll());
+    }
+
+    if (m_powerHAL) {
+        next = std::min(next, m_powerHAL->getTimeUntilNextWakeup());
+    }
+
+    return next;
+}
+
 const char* HALManager::getHardwareInfo() const {
     return m_hardwareInfo;
 }
@@ -169,35 +261,3 @@ os_error_t HALManager::setLowPowerMode(bool enabled) {
     m_lowPowerMode = enabled;
     return OS_OK;
 }
-
-os_error_t HALManager::initializeComponents() {
-    // Initialize display HAL first (others may depend on it)
-    m_displayHAL = new DisplayHAL();
-    if (!m_displayHAL || m_displayHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Display HAL");
-        return OS_ERROR_HARDWARE;
-    }
-
-    // Initialize touch HAL
-    m_touchHAL = new TouchHAL();
-    if (!m_touchHAL || m_touchHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Touch HAL");
-        return OS_ERROR_HARDWARE;
-    }
-
-    // Initialize power management HAL
-    m_powerHAL = new PowerHAL();
-    if (!m_powerHAL || m_powerHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Power HAL");
-        return OS_ERROR_HARDWARE;
-    }
-
-    // Initialize storage HAL
-    m_storageHAL = new StorageHAL();
-    if (!m_storageHAL || m_storageHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Storage HAL");
-        return OS_ERROR_HARDWARE;
-    }
-
-    return OS_OK;
-}
\ No newline at end of file
@@ -6,13 +6,16 @@
 #include "touch_hal.h"
 #include "power_hal.h"
 #include "storage_hal.h"
+#include "../system/boot_graph.h"
 
 /**
  * @file hal_manager.h
  * @brief Hardware Abstraction Layer Manager for M5Stack Tab5
  * 
  * Manages all hardware abstraction components and provides
- * a unified interface to the underlying hardware.
+ * a unified interface to the underlying hardware. Components are boot
+ * graph stages: at system start they initialise side by side, and
+ * initialize() on its own runs the same stages one after another.
  */
 
 class HALManager {
@@ -26,6 +29,21 @@ public:
      */
     os_error_t initialize();
 
+    /**
+     * @brief Add the hardware components to a boot graph
+     * 
+     * The display initialises on the main task since it brings up LVGL.
+     * Touch, power and storage depend on nothing but the given stages and
+     * run on workers, so the GT911 reset and the SD mount overlap the
+     * display reset. The asset pack maps on the main task after the
+     * display. The "hal" stage completes the manager once display, assets,
+     * touch and power are up; "storage" may finish after it.
+     * @param graph Boot graph
+     * @param after Stages every component waits for
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t addBootStages(BootGraph& graph, const std::vector<const char*>& after);
+
     /**
      * @brief Shutdown the HAL manager
      * @return OS_OK on success, error code on failure
@@ -39,6 +57,12 @@ public:
      */
     os_error_t update(uint32_t deltaTime);
 
+    /**
+     * @brief Get time until a hardware component next needs servicing
+     * @return Milliseconds until the next deadline, UINT32_MAX if none
+     */
+    uint32_t getTimeUntilNextDeadline() const;
+
     /**
      * @brief Check if HAL is initialized
      * @return true if initialized, false otherwise
@@ -77,12 +101,6 @@ public:
     os_error_t setLowPowerMode(bool enabled);
 
 private:
-    /**
-     * @brief Initialize hardware components in order
-     * @return OS_OK on success, error code on failure
-     */
-    os_error_t initializeComponents();
-
     // Hardware component instances
     DisplayHAL* m_displayHAL = nullptr;
     TouchHAL* m_touchHAL = nullptr;
@@ -56,6 +56,19 @@
 #define MIPI_DSI_HOST           0
 #define MIPI_DSI_LANES          2       // Dual-lane MIPI-DSI
 #define MIPI_DSI_PIXEL_FORMAT   MIPI_DSI_FMT_RGB565
+#define MIPI_DSI_LANE_BITRATE_MBPS 730  // Per-lane bit rate
+#define MIPI_DSI_PHY_LDO_CHAN   3       // On-chip LDO powering the DSI PHY
+#define MIPI_DSI_PHY_LDO_MV     2500
+
+// DPI video timing (panel refresh ~60Hz)
+#define DISPLAY_DPI_CLOCK_MHZ   60
+#define DISPLAY_HSYNC_PULSE     40
+#define DISPLAY_HSYNC_BACK_PORCH 140
+#define DISPLAY_HSYNC_FRONT_PORCH 40
+#define DISPLAY_VSYNC_PULSE     4
+#define DISPLAY_VSYNC_BACK_PORCH 16
+#define DISPLAY_VSYNC_FRONT_PORCH 16
+#define DISPLAY_PANEL_REFRESH_HZ 60
 
 // MIPI-DSI Pin assignments (ESP32-P4 specific)
 // Note: These are hardware-fixed pins on ESP32-P4
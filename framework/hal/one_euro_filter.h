@@ -0,0 +1,69 @@
+#ifndef ONE_EURO_FILTER_H
+#define ONE_EURO_FILTER_H
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @file one_euro_filter.h
+ * @brief One-Euro low-pass filter for touch coordinates
+ *
+ * An exponential smoother whose cutoff rises with speed: a resting finger
+ * is filtered hard to remove jitter, a fast swipe barely at all so the
+ * cursor does not lag. Constant time and no allocation per sample.
+ * (Casiez, Roussel, Vogel: "1 Euro Filter", CHI 2012.)
+ */
+
+class OneEuroFilter {
+public:
+    /**
+     * @brief Construct with tuning parameters
+     * @param minCutoff Cutoff in Hz at zero speed (lower = less jitter)
+     * @param beta Cutoff increase per unit of speed (higher = less lag)
+     * @param derivativeCutoff Cutoff in Hz for the speed estimate
+     */
+    OneEuroFilter(float minCutoff = 1.0f, float beta = 0.0f, float derivativeCutoff = 1.0f)
+        : m_minCutoff(minCutoff), m_beta(beta), m_derivativeCutoff(derivativeCutoff) {}
+
+    /**
+     * @brief Forget history; the next sample passes through unchanged
+     */
+    void reset() { m_primed = false; }
+
+    /**
+     * @brief Filter one sample
+     * @param value Raw value
+     * @param dt Seconds since the previous sample
+     * @return Filtered value
+     */
+    float filter(float value, float dt) {
+        if (!m_primed || dt <= 0.0f) {
+            m_value = value;
+            m_derivative = 0.0f;
+            m_primed = true;
+            return value;
+        }
+
+        float derivative = (value - m_value) / dt;
+        m_derivative += alpha(m_derivativeCutoff, dt) * (derivative - m_derivative);
+
+        float cutoff = m_minCutoff + m_beta * fabsf(m_derivative);
+        m_value += alpha(cutoff, dt) * (value - m_value);
+        return m_value;
+    }
+
+private:
+    static float alpha(float cutoff, float dt) {
+        float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+        return 1.0f / (1.0f + tau / dt);
+    }
+
+    float m_minCutoff;
+    float m_beta;
+    float m_derivativeCutoff;
+    float m_value = 0.0f;
+    float m_derivative = 0.0f;
+    bool m_primed = false;
+};
+
+#endif // ONE_EURO_FILTER_H
@@ -4,6 +4,8 @@
 #include <esp_log.h>
 #include <esp_adc/adc_oneshot.h>
 #include <esp_system.h>
+#include <esp_sleep.h>
+#include <algorithm>
 
 static const char* TAG = "PowerHAL";
 
@@ -34,6 +36,8 @@ os_error_t PowerHAL::initialize() {
     updateBatteryStatus();
     updateTemperature();
 
+    initializeFrequencyScaling();
+
     m_initialized = true;
     ESP_LOGI(TAG, "Power HAL initialized");
 
@@ -48,6 +52,16 @@ os_error_t PowerHAL::shutdown() {
     ESP_LOGI(TAG, "Shutting down Power HAL");
 
     // TODO: Cleanup ADC resources
+
+    if (m_perfLock) {
+        if (m_perfLockHeld) {
+            esp_pm_lock_release(m_perfLock);
+            m_perfLockHeld = false;
+        }
+        esp_pm_lock_delete(m_perfLock);
+        m_perfLock = nullptr;
+    }
+    m_dvfsActive = false;
     m_initialized = false;
 
     ESP_LOGI(TAG, "Power HAL shutdown complete");
@@ -65,6 +79,13 @@ os_error_t PowerHAL::update(uint32_t deltaTime) {
     if (currentTime - m_lastBatteryUpdate >= 10000) {
         updateBatteryStatus();
         m_lastBatteryUpdate = currentTime;
+
+        // Listeners (status bar) only hear about actual changes
+        if (m_batteryLevel != m_reportedLevel || m_chargeState != m_reportedChargeState) {
+            m_reportedLevel = m_batteryLevel;
+            m_reportedChargeState = m_chargeState;
+            PUBLISH_EVENT(EVENT_HAL_BATTERY_CHANGE, &m_batteryLevel, sizeof(m_batteryLevel));
+        }
     }
 
     // Update temperature every 5 seconds
@@ -133,7 +154,7 @@ os_error_t PowerHAL::setPowerState(PowerState state) {
             break;
 
         case PowerState::IDLE:
-            // Reduce CPU frequency but keep peripherals active
+            // Peripherals stay active; the governor drops to its slowest step
             break;
 
         case PowerState::LIGHT_SLEEP:
@@ -141,9 +162,9 @@ os_error_t PowerHAL::setPowerState(PowerState state) {
             break;
 
         case PowerState::DEEP_SLEEP:
-            // Deep sleep mode
+            // Deep sleep mode; the RTC timer ends it at the next wakeup request
             ESP_LOGI(TAG, "Entering deep sleep mode");
-            // TODO: Configure wake-up sources
+            armSleepTimer(OS_DEEP_SLEEP_MAX_MS * 1000ULL);
             break;
 
         case PowerState::SHUTDOWN:
@@ -168,8 +189,8 @@ os_error_t PowerHAL::setLowPowerMode(bool enabled) {
 
     if (enabled) {
         ESP_LOGI(TAG, "Low power mode enabled");
-        // Reduce system clocks, disable unnecessary peripherals
-        // TODO: Implement actual low power configuration
+        // The governor stops using the fastest CPU step
+        // TODO: Disable unnecessary peripherals
     } else {
         ESP_LOGI(TAG, "Low power mode disabled");
         // Restore normal power configuration
@@ -203,6 +224,60 @@ os_error_t PowerHAL::setChargingEnabled(bool enabled) {
     return OS_OK;
 }
 
+bool PowerHAL::isActive() const {
+    return m_currentState == PowerState::ACTIVE;
+}
+
+void PowerHAL::setWakeup(const void* owner, std::time_t when) {
+    auto it = std::find_if(m_wakeups.begin(), m_wakeups.end(),
+                           [owner](const std::pair<const void*, std::time_t>& w) { return w.first == owner; });
+    if (when == 0) {
+        if (it != m_wakeups.end()) {
+            m_wakeups.erase(it);
+        }
+    } else if (it != m_wakeups.end()) {
+        it->second = when;
+    } else {
+        m_wakeups.emplace_back(owner, when);
+    }
+}
+
+uint32_t PowerHAL::getTimeUntilNextWakeup() const {
+    // A request that has come due already ended a sleep; until its owner
+    // moves it on it must not keep the main loop from blocking
+    std::time_t now = time(nullptr);
+    std::time_t next = 0;
+    for (const auto& wakeup : m_wakeups) {
+        if (wakeup.second > now && (next == 0 || wakeup.second < next)) {
+            next = wakeup.second;
+        }
+    }
+    if (next == 0) {
+        return UINT32_MAX;
+    }
+    int64_t ms = ((int64_t)next - now) * 1000;
+    return (uint32_t)std::min<int64_t>(ms, UINT32_MAX - 1);
+}
+
+bool PowerHAL::armSleepTimer(uint64_t maxUs) {
+    uint32_t untilMs = getTimeUntilNextWakeup();
+    uint64_t us = untilMs == UINT32_MAX ? maxUs : std::min<uint64_t>(maxUs, (uint64_t)untilMs * 1000);
+    if (us == UINT64_MAX) {
+        return false;
+    }
+
+    esp_err_t ret = esp_sleep_enable_timer_wakeup(us);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to arm wakeup timer: %s", esp_err_to_name(ret));
+        return false;
+    }
+    if (untilMs != UINT32_MAX && (uint64_t)untilMs * 1000 <= maxUs) {
+        m_timerWakeups++;
+        ESP_LOGI(TAG, "Wakeup timer armed for %d s", untilMs / 1000);
+    }
+    return true;
+}
+
 void PowerHAL::printStats() const {
     ESP_LOGI(TAG, "=== Power HAL Statistics ===");
     ESP_LOGI(TAG, "Power state: %d", (int)m_currentState);
@@ -214,6 +289,79 @@ void PowerHAL::printStats() const {
     ESP_LOGI(TAG, "Power consumption: %.1fmW", m_powerConsumption);
     ESP_LOGI(TAG, "Low battery warnings: %d", m_lowBatteryWarnings);
     ESP_LOGI(TAG, "Uptime: %d seconds", (millis() - m_initTime) / 1000);
+    ESP_LOGI(TAG, "Frequency scaling: %s", m_dvfsActive ? "active" : "advisory");
+    ESP_LOGI(TAG, "Wakeup requests: %d, sleeps ended by one: %d", m_wakeups.size(), m_timerWakeups);
+    m_governor.printStats();
+}
+
+void PowerHAL::updatePerformance(GovernorInputs inputs) {
+    if (!m_initialized) {
+        return;
+    }
+
+    inputs.lowPowerMode = m_lowPowerMode;
+    inputs.powerIdle = m_currentState != PowerState::ACTIVE;
+
+    uint8_t step = m_governor.update(inputs, millis());
+    if (step != m_appliedStep) {
+        applyCpuStep(step);
+        m_appliedStep = step;
+    }
+}
+
+void PowerHAL::initializeFrequencyScaling() {
+#if OS_DVFS_ENABLED
+    // Without a lock esp_pm runs at min_freq_mhz; the governor holds the
+    // lock and moves max_freq_mhz for every step above the slowest
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = CpuGovernor::stepMhz(0);
+    config.min_freq_mhz = OS_DVFS_MIN_MHZ;
+    config.light_sleep_enable = OS_DVFS_LIGHT_SLEEP;
+
+    esp_err_t ret = esp_pm_configure(&config);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "os_perf", &m_perfLock);
+    }
+    if (ret != ESP_OK) {
+        // Governor keeps running so its statistics still describe the load
+        ESP_LOGW(TAG, "CPU frequency scaling unavailable: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    m_dvfsActive = true;
+    m_appliedStep = m_governor.getStep();
+    if (esp_pm_lock_acquire(m_perfLock) == ESP_OK) {
+        m_perfLockHeld = true;
+    }
+    ESP_LOGI(TAG, "CPU frequency scaling %d-%d MHz", OS_DVFS_MIN_MHZ, CpuGovernor::stepMhz(0));
+#endif
+}
+
+void PowerHAL::applyCpuStep(uint8_t step) {
+    if (!m_dvfsActive) {
+        return;
+    }
+
+    if (step == CPU_GOVERNOR_STEPS - 1) {
+        if (m_perfLockHeld) {
+            esp_pm_lock_release(m_perfLock);
+            m_perfLockHeld = false;
+        }
+        return;
+    }
+
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = CpuGovernor::stepMhz(step);
+    config.min_freq_mhz = OS_DVFS_MIN_MHZ;
+    config.light_sleep_enable = OS_DVFS_LIGHT_SLEEP;
+    esp_err_t ret = esp_pm_configure(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set CPU to %d MHz: %s", config.max_freq_mhz, esp_err_to_name(ret));
+        return;
+    }
+    if (!m_perfLockHeld && esp_pm_lock_acquire(m_perfLock) == ESP_OK) {
+        m_perfLockHeld = true;
+    }
 }
 
 void PowerHAL::updateBatteryStatus() {
@@ -2,12 +2,21 @@
 #define POWER_HAL_H
 
 #include "../system/os_config.h"
+#include "cpu_governor.h"
+#include <esp_pm.h>
+#include <ctime>
+#include <utility>
+#include <vector>
 
 /**
  * @file power_hal.h
  * @brief Power Management Hardware Abstraction Layer for M5Stack Tab5
  * 
  * Manages power consumption, battery monitoring, and power states.
+ * Owns the CPU frequency governor: updatePerformance() is fed by the
+ * main loop and the chosen step is applied through esp_pm. Also collects
+ * wakeup requests (calendar reminders, for instance) so sleep is armed
+ * to end at the earliest one.
  */
 
 // Forward declaration - PowerState is defined in system/power_manager.h
@@ -73,6 +82,14 @@ public:
      */
     PowerState getPowerState() const { return m_currentState; }
 
+    /**
+     * @brief Check if the device is in the ACTIVE power state
+     *
+     * For callers that only have the forward-declared PowerState.
+     * @return true when active
+     */
+    bool isActive() const;
+
     /**
      * @brief Set low power mode
      * @param enabled True to enable low power mode
@@ -135,6 +152,50 @@ public:
      */
     float getPowerConsumption() const { return m_powerConsumption; }
 
+    /**
+     * @brief Run the CPU frequency governor and apply its step
+     *
+     * Power state and low power mode are filled in here; the caller
+     * supplies load, frame headroom, app priority and interaction.
+     * @param inputs Governor inputs
+     */
+    void updatePerformance(GovernorInputs inputs);
+
+    /**
+     * @brief Get the CPU frequency governor
+     * @return Governor state and statistics
+     */
+    const CpuGovernor& getCpuGovernor() const { return m_governor; }
+
+    /**
+     * @brief Check if clock changes reach the hardware
+     * @return false if esp_pm is unavailable (CONFIG_PM_ENABLE off)
+     */
+    bool isFrequencyScalingActive() const { return m_dvfsActive; }
+
+    /**
+     * @brief Ask to be woken at a time
+     *
+     * The earliest request bounds the main loop's tickless sleep and arms
+     * the RTC timer when the device goes to light or deep sleep.
+     * @param owner Requester, one request each (usually the app)
+     * @param when Wall-clock time; 0 withdraws the request
+     */
+    void setWakeup(const void* owner, std::time_t when);
+
+    /**
+     * @brief Get time until the earliest wakeup request still ahead
+     * @return Milliseconds, UINT32_MAX if there is none
+     */
+    uint32_t getTimeUntilNextWakeup() const;
+
+    /**
+     * @brief Arm the sleep timer for the earliest wakeup request
+     * @param maxUs Longest sleep in microseconds (UINT64_MAX for no limit)
+     * @return true if the timer was armed
+     */
+    bool armSleepTimer(uint64_t maxUs);
+
     /**
      * @brief Print power statistics
      */
@@ -156,6 +217,17 @@ private:
      */
     void updatePowerConsumption();
 
+    /**
+     * @brief Configure esp_pm and create the performance lock
+     */
+    void initializeFrequencyScaling();
+
+    /**
+     * @brief Set esp_pm limits for a governor step
+     * @param step Step index
+     */
+    void applyCpuStep(uint8_t step);
+
     // Power state
     PowerState m_currentState; // Will be initialized in constructor
     bool m_lowPowerMode = false;
@@ -172,8 +244,21 @@ private:
     uint32_t m_lastBatteryUpdate = 0;
     uint32_t m_lastTemperatureUpdate = 0;
     uint32_t m_lowBatteryWarnings = 0;
+    uint8_t m_reportedLevel = 0xFF;
+    ChargeState m_reportedChargeState = ChargeState::UNKNOWN;
     uint32_t m_initTime = 0;
 
+    // CPU frequency scaling
+    CpuGovernor m_governor;
+    esp_pm_lock_handle_t m_perfLock = nullptr;
+    bool m_perfLockHeld = false;
+    bool m_dvfsActive = false;
+    uint8_t m_appliedStep = 0;
+
+    // Wakeup requests
+    std::vector<std::pair<const void*, std::time_t>> m_wakeups;
+    uint32_t m_timerWakeups = 0;
+
     bool m_initialized = false;
 };
 
@@ -0,0 +1,454 @@
+#include "ppa_draw.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_memory_utils.h>
+#include <algorithm>
+
+static const char* TAG = "PPADraw";
+
+// Only one display: LVGL's draw_ctx_init has no user pointer of its own
+static PPADrawBackend* s_attachedBackend = nullptr;
+
+PPADrawBackend::~PPADrawBackend() {
+    shutdown();
+}
+
+os_error_t PPADrawBackend::initialize() {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    ppa_client_config_t config = {};
+    config.max_pending_trans_num = 1;
+
+    config.oper_type = PPA_OPERATION_FILL;
+    esp_err_t ret = ppa_register_client(&config, &m_fillClient);
+    if (ret == ESP_OK) {
+        config.oper_type = PPA_OPERATION_BLEND;
+        ret = ppa_register_client(&config, &m_blendClient);
+    }
+    if (ret == ESP_OK) {
+        config.oper_type = PPA_OPERATION_SRM;
+        ret = ppa_register_client(&config, &m_srmClient);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register PPA clients: %s", esp_err_to_name(ret));
+        m_initialized = true;   // Let shutdown() release what was registered
+        shutdown();
+        return OS_ERROR_HARDWARE;
+    }
+
+    m_initialized = true;
+    ESP_LOGI(TAG, "PPA draw backend ready (offload from %d px)", OS_DISPLAY_PPA_MIN_PIXELS);
+    return OS_OK;
+}
+
+os_error_t PPADrawBackend::shutdown() {
+    if (!m_initialized) {
+        return OS_OK;
+    }
+
+    if (m_fillClient) {
+        ppa_unregister_client(m_fillClient);
+        m_fillClient = nullptr;
+    }
+    if (m_blendClient) {
+        ppa_unregister_client(m_blendClient);
+        m_blendClient = nullptr;
+    }
+    if (m_srmClient) {
+        ppa_unregister_client(m_srmClient);
+        m_srmClient = nullptr;
+    }
+
+    if (s_attachedBackend == this) {
+        s_attachedBackend = nullptr;
+    }
+    m_initialized = false;
+    return OS_OK;
+}
+
+void PPADrawBackend::attach(lv_disp_drv_t* drv, uint32_t drawBufferBytes) {
+    s_attachedBackend = this;
+    m_drawBuffer = drv->draw_buf;
+    m_drawBufferBytes = drawBufferBytes;
+    drv->draw_ctx_init = initContext;
+    drv->draw_ctx_deinit = deinitContext;
+    drv->draw_ctx_size = sizeof(DrawContext);
+}
+
+void PPADrawBackend::printStats() const {
+    ESP_LOGI(TAG, "=== PPA Draw Statistics ===");
+    ESP_LOGI(TAG, "Offload: %s", isEnabled() ? "enabled" : "disabled");
+    ESP_LOGI(TAG, "PPA fills: %d, blends: %d, scales: %d, errors: %d",
+             m_ppaFills, m_ppaBlends, m_ppaScales, m_ppaErrors);
+    ESP_LOGI(TAG, "Software fallbacks: %d", m_swFallbacks);
+}
+
+void PPADrawBackend::initContext(lv_disp_drv_t* drv, lv_draw_ctx_t* ctx) {
+    lv_draw_sw_init_ctx(drv, ctx);
+
+    DrawContext* drawCtx = reinterpret_cast<DrawContext*>(ctx);
+    drawCtx->backend = s_attachedBackend;
+    drawCtx->sw.blend = blend;
+    drawCtx->sw.base_draw.draw_img_decoded = drawImageDecoded;
+}
+
+void PPADrawBackend::deinitContext(lv_disp_drv_t* drv, lv_draw_ctx_t* ctx) {
+    lv_draw_sw_deinit_ctx(drv, ctx);
+}
+
+void PPADrawBackend::blend(lv_draw_ctx_t* ctx, const lv_draw_sw_blend_dsc_t* dsc) {
+    PPADrawBackend* backend = reinterpret_cast<DrawContext*>(ctx)->backend;
+    if (backend && backend->isEnabled()) {
+        if (backend->blendHardware(ctx, dsc)) {
+            return;
+        }
+        backend->m_swFallbacks++;
+    }
+    lv_draw_sw_blend_basic(ctx, dsc);
+}
+
+void PPADrawBackend::drawImageDecoded(lv_draw_ctx_t* ctx, const lv_draw_img_dsc_t* dsc,
+                                      const lv_area_t* coords, const uint8_t* src,
+                                      lv_img_cf_t cf) {
+    // Unscaled images end up in blend() through the software path anyway
+    PPADrawBackend* backend = reinterpret_cast<DrawContext*>(ctx)->backend;
+    if (backend && backend->isEnabled() && backend->scaleHardware(ctx, dsc, coords, src, cf)) {
+        return;
+    }
+    lv_draw_sw_img_decoded(ctx, dsc, coords, src, cf);
+}
+
+bool PPADrawBackend::blendHardware(lv_draw_ctx_t* ctx, const lv_draw_sw_blend_dsc_t* dsc) {
+    if (dsc->blend_mode != LV_BLEND_MODE_NORMAL || dsc->opa <= LV_OPA_MIN) {
+        return false;
+    }
+    if (dsc->mask_buf && dsc->mask_res != LV_DRAW_MASK_RES_FULL_COVER) {
+        return false;
+    }
+
+    lv_area_t block;
+    if (!_lv_area_intersect(&block, dsc->blend_area, ctx->clip_area)) {
+        return false;
+    }
+    if (lv_area_get_size(&block) < OS_DISPLAY_PPA_MIN_PIXELS || !isDmaReadable(ctx->buf)) {
+        return false;
+    }
+
+    lv_color_t* buf = static_cast<lv_color_t*>(ctx->buf);
+    uint16_t bufW = lv_area_get_width(ctx->buf_area);
+    uint16_t bufH = lv_area_get_height(ctx->buf_area);
+    uint32_t bufBytes = outputBytes(ctx);
+
+    // Source coordinates are relative to the unclipped blend area
+    uint16_t srcX = block.x1 - dsc->blend_area->x1;
+    uint16_t srcY = block.y1 - dsc->blend_area->y1;
+    lv_area_move(&block, -ctx->buf_area->x1, -ctx->buf_area->y1);
+
+    esp_err_t ret;
+    if (!dsc->src_buf) {
+        if (dsc->opa >= LV_OPA_MAX) {
+            ret = fill(buf, bufW, bufH, bufBytes, block, dsc->color);
+            m_ppaFills++;
+        } else {
+            ret = blendOver(buf, bufW, bufH, bufBytes, block, nullptr, 0, 0, 0, dsc->color, dsc->opa);
+            m_ppaBlends++;
+        }
+    } else {
+        if (!isDmaReadable(dsc->src_buf)) {
+            return false;
+        }
+
+        uint16_t srcW = lv_area_get_width(dsc->blend_area);
+        uint16_t srcH = lv_area_get_height(dsc->blend_area);
+        if (dsc->opa >= LV_OPA_MAX) {
+            lv_area_t srcBlock = {(lv_coord_t)srcX, (lv_coord_t)srcY,
+                                  (lv_coord_t)(srcX + lv_area_get_width(&block) - 1),
+                                  (lv_coord_t)(srcY + lv_area_get_height(&block) - 1)};
+            ret = scale(dsc->src_buf, srcW, srcH, srcBlock, buf, bufW, bufH, bufBytes,
+                        block.x1, block.y1, 1.0f, 1.0f);
+            m_ppaScales++;
+        } else {
+            ret = blendOver(buf, bufW, bufH, bufBytes, block, dsc->src_buf, srcW, srcX, srcY,
+                            dsc->color, dsc->opa);
+            m_ppaBlends++;
+        }
+    }
+
+    if (ret != ESP_OK) {
+        m_ppaErrors++;
+        return false;
+    }
+    return true;
+}
+
+bool PPADrawBackend::scaleHardware(lv_draw_ctx_t* ctx, const lv_draw_img_dsc_t* dsc,
+                                   const lv_area_t* coords, const uint8_t* src, lv_img_cf_t cf) {
+    // The SRM engine scales in 1/16 steps and has no blending of its own
+    if (dsc->zoom == LV_IMG_ZOOM_NONE || dsc->angle != 0 || (dsc->zoom % 16) != 0) {
+        return false;
+    }
+    if (cf != LV_IMG_CF_TRUE_COLOR || dsc->opa < LV_OPA_MAX ||
+        dsc->recolor_opa > LV_OPA_MIN || dsc->blend_mode != LV_BLEND_MODE_NORMAL) {
+        return false;
+    }
+    if (lv_draw_mask_is_any(ctx->clip_area) || !isDmaReadable(src) || !isDmaReadable(ctx->buf)) {
+        return false;
+    }
+
+    lv_coord_t srcW = lv_area_get_width(coords);
+    lv_coord_t srcH = lv_area_get_height(coords);
+
+    lv_area_t dest;
+    _lv_img_buf_get_transformed_area(&dest, srcW, srcH, 0, dsc->zoom, &dsc->pivot);
+    lv_area_move(&dest, coords->x1, coords->y1);
+
+    lv_area_t block;
+    if (!_lv_area_intersect(&block, &dest, ctx->clip_area)) {
+        return true;    // Nothing visible
+    }
+    if (lv_area_get_size(&block) < OS_DISPLAY_PPA_MIN_PIXELS) {
+        return false;
+    }
+
+    // Map the visible destination block back onto source pixels
+    lv_area_t srcBlock;
+    srcBlock.x1 = ((block.x1 - dest.x1) * 256) / dsc->zoom;
+    srcBlock.y1 = ((block.y1 - dest.y1) * 256) / dsc->zoom;
+    srcBlock.x2 = std::min<lv_coord_t>(srcW - 1, srcBlock.x1 + (lv_area_get_width(&block) * 256) / dsc->zoom - 1);
+    srcBlock.y2 = std::min<lv_coord_t>(srcH - 1, srcBlock.y1 + (lv_area_get_height(&block) * 256) / dsc->zoom - 1);
+    if (srcBlock.x2 < srcBlock.x1 || srcBlock.y2 < srcBlock.y1) {
+        return false;
+    }
+
+    float factor = dsc->zoom / 256.0f;
+    esp_err_t ret = scale(reinterpret_cast<const lv_color_t*>(src), srcW, srcH, srcBlock,
+                          static_cast<lv_color_t*>(ctx->buf),
+                          lv_area_get_width(ctx->buf_area), lv_area_get_height(ctx->buf_area),
+                          outputBytes(ctx), block.x1 - ctx->buf_area->x1, block.y1 - ctx->buf_area->y1,
+                          factor, factor);
+    if (ret != ESP_OK) {
+        m_ppaErrors++;
+        return false;
+    }
+    m_ppaScales++;
+    return true;
+}
+
+esp_err_t PPADrawBackend::fill(lv_color_t* buf, uint16_t bufW, uint16_t bufH, uint32_t bufBytes,
+                               const lv_area_t& block, lv_color_t color) {
+    ppa_fill_oper_config_t config = {};
+    config.out.buffer = buf;
+    config.out.buffer_size = bufBytes;
+    config.out.pic_w = bufW;
+    config.out.pic_h = bufH;
+    config.out.block_offset_x = block.x1;
+    config.out.block_offset_y = block.y1;
+    config.out.fill_cm = PPA_FILL_COLOR_MODE_RGB565;
+    config.fill_block_w = lv_area_get_width(&block);
+    config.fill_block_h = lv_area_get_height(&block);
+    config.fill_argb_color.val = lv_color_to32(color);
+    config.mode = PPA_TRANS_MODE_BLOCKING;
+    return ppa_do_fill(m_fillClient, &config);
+}
+
+esp_err_t PPADrawBackend::blendOver(lv_color_t* buf, uint16_t bufW, uint16_t bufH, uint32_t bufBytes,
+                                    const lv_area_t& block, const lv_color_t* fg, uint16_t fgW,
+                                    uint16_t fgX, uint16_t fgY, lv_color_t color, lv_opa_t opa) {
+    uint16_t blockW = lv_area_get_width(&block);
+    uint16_t blockH = lv_area_get_height(&block);
+
+    ppa_blend_oper_config_t config = {};
+    config.in_bg.buffer = buf;
+    config.in_bg.pic_w = bufW;
+    config.in_bg.pic_h = bufH;
+    config.in_bg.block_w = blockW;
+    config.in_bg.block_h = blockH;
+    config.in_bg.block_offset_x = block.x1;
+    config.in_bg.block_offset_y = block.y1;
+    config.in_bg.blend_cm = PPA_BLEND_COLOR_MODE_RGB565;
+    config.bg_alpha_update_mode = PPA_ALPHA_NO_CHANGE;
+
+    if (fg) {
+        config.in_fg.buffer = fg;
+        config.in_fg.pic_w = fgW;
+        config.in_fg.pic_h = fgY + blockH;
+        config.in_fg.block_offset_x = fgX;
+        config.in_fg.block_offset_y = fgY;
+        config.in_fg.blend_cm = PPA_BLEND_COLOR_MODE_RGB565;
+    } else {
+        // Constant color: an A8 foreground whose alpha is overridden below,
+        // so its contents are never used. The bg buffer is large enough.
+        config.in_fg.buffer = buf;
+        config.in_fg.pic_w = bufW;
+        config.in_fg.pic_h = bufH;
+        config.in_fg.block_offset_x = block.x1;
+        config.in_fg.block_offset_y = block.y1;
+        config.in_fg.blend_cm = PPA_BLEND_COLOR_MODE_A8;
+        uint32_t rgb = lv_color_to32(color);
+        config.fg_fix_rgb_val.r = (rgb >> 16) & 0xFF;
+        config.fg_fix_rgb_val.g = (rgb >> 8) & 0xFF;
+        config.fg_fix_rgb_val.b = rgb & 0xFF;
+    }
+    config.in_fg.block_w = blockW;
+    config.in_fg.block_h = blockH;
+    config.fg_alpha_update_mode = PPA_ALPHA_FIX_VALUE;
+    config.fg_alpha_fix_val = opa;
+
+    // Blend in place
+    config.out.buffer = buf;
+    config.out.buffer_size = bufBytes;
+    config.out.pic_w = bufW;
+    config.out.pic_h = bufH;
+    config.out.block_offset_x = block.x1;
+    config.out.block_offset_y = block.y1;
+    config.out.blend_cm = PPA_BLEND_COLOR_MODE_RGB565;
+    config.mode = PPA_TRANS_MODE_BLOCKING;
+    return ppa_do_blend(m_blendClient, &config);
+}
+
+esp_err_t PPADrawBackend::scale(const lv_color_t* src, uint16_t srcW, uint16_t srcH,
+                                const lv_area_t& srcBlock, lv_color_t* buf, uint16_t bufW,
+                                uint16_t bufH, uint32_t bufBytes, uint16_t outX, uint16_t outY,
+                                float scaleX, float scaleY) {
+    ppa_srm_oper_config_t config = {};
+    config.in.buffer = src;
+    config.in.pic_w = srcW;
+    config.in.pic_h = srcH;
+    config.in.block_w = lv_area_get_width(&srcBlock);
+    config.in.block_h = lv_area_get_height(&srcBlock);
+    config.in.block_offset_x = srcBlock.x1;
+    config.in.block_offset_y = srcBlock.y1;
+    config.in.srm_cm = PPA_SRM_COLOR_MODE_RGB565;
+
+    config.out.buffer = buf;
+    config.out.buffer_size = bufBytes;
+    config.out.pic_w = bufW;
+    config.out.pic_h = bufH;
+    config.out.block_offset_x = outX;
+    config.out.block_offset_y = outY;
+    config.out.srm_cm = PPA_SRM_COLOR_MODE_RGB565;
+
+    config.rotation_angle = PPA_SRM_ROTATION_ANGLE_0;
+    config.scale_x = scaleX;
+    config.scale_y = scaleY;
+    config.mode = PPA_TRANS_MODE_BLOCKING;
+    return ppa_do_scale_rotate_mirror(m_srmClient, &config);
+}
+
+bool PPADrawBackend::isDmaReadable(const void* ptr) {
+    // Flash-mapped images (const arrays) are not reachable by the 2D-DMA
+    return ptr && (esp_ptr_dma_capable(ptr) || esp_ptr_external_ram(ptr));
+}
+
+uint32_t PPADrawBackend::outputBytes(const lv_draw_ctx_t* ctx) const {
+    // The PPA syncs and invalidates the whole output buffer, so report what
+    // was really allocated: the display's draw buffers are padded to the
+    // cache line, LVGL layers are not
+    const void* buf = ctx->buf;
+    if (m_drawBuffer && (buf == m_drawBuffer->buf1 || buf == m_drawBuffer->buf2)) {
+        return m_drawBufferBytes;
+    }
+    return (uint32_t)lv_area_get_size(ctx->buf_area) * sizeof(lv_color_t);
+}
+
+uint32_t PPADrawBackend::bufferBytes(uint16_t w, uint16_t h) {
+    // Benchmark buffers are cache-synced whole; round up to the cache line
+    uint32_t bytes = (uint32_t)w * h * sizeof(lv_color_t);
+    return (bytes + OS_MEM_DMA_ALIGNMENT - 1) & ~(uint32_t)(OS_MEM_DMA_ALIGNMENT - 1);
+}
+
+os_error_t PPADrawBackend::runBenchmark(uint16_t width, uint16_t height, uint32_t iterations,
+                                        PPABenchmarkResult& result) {
+    if (!m_initialized || width < 2 || height < 2 || iterations == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t pixels = (uint32_t)width * height;
+    uint32_t bytes = bufferBytes(width, height);
+    lv_color_t* dst = static_cast<lv_color_t*>(OS_MALLOC_DMA(bytes));
+    lv_color_t* src = static_cast<lv_color_t*>(OS_MALLOC_DMA(bytes));
+    if (!dst || !src) {
+        OS_FREE(dst);
+        OS_FREE(src);
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        src[i] = lv_color_make(i & 0xFF, (i >> 8) & 0xFF, 0x80);
+    }
+
+    lv_area_t block = {0, 0, (lv_coord_t)(width - 1), (lv_coord_t)(height - 1)};
+    lv_color_t color = lv_color_hex(0x3366CC);
+    uint16_t halfW = width / 2;
+    uint16_t halfH = height / 2;
+    lv_area_t halfBlock = {0, 0, (lv_coord_t)(halfW - 1), (lv_coord_t)(halfH - 1)};
+    bool ok = true;
+    int64_t start;
+
+    result = PPABenchmarkResult{};
+    result.pixels = pixels;
+
+    // Opaque fill
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        lv_color_fill(dst, color, pixels);
+    }
+    result.fillSwUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; i++) {
+        ok = fill(dst, width, height, bytes, block, color) == ESP_OK;
+    }
+    result.fillPpaUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    // 50% image blend
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint32_t p = 0; p < pixels; p++) {
+            dst[p] = lv_color_mix(src[p], dst[p], LV_OPA_50);
+        }
+    }
+    result.blendSwUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; i++) {
+        ok = blendOver(dst, width, height, bytes, block, src, width, 0, 0, color, LV_OPA_50) == ESP_OK;
+    }
+    result.blendPpaUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    // 2x nearest-neighbour upscale of the top-left quarter
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint16_t y = 0; y < halfH * 2; y++) {
+            const lv_color_t* row = src + (y / 2) * width;
+            for (uint16_t x = 0; x < halfW * 2; x++) {
+                dst[y * width + x] = row[x / 2];
+            }
+        }
+    }
+    result.scaleSwUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; i++) {
+        ok = scale(src, width, height, halfBlock, dst, width, height, bytes, 0, 0, 2.0f, 2.0f) == ESP_OK;
+    }
+    result.scalePpaUs = (uint32_t)((esp_timer_get_time() - start) / iterations);
+
+    OS_FREE(dst);
+    OS_FREE(src);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "PPA operation failed during benchmark");
+        return OS_ERROR_HARDWARE;
+    }
+
+    ESP_LOGI(TAG, "Benchmark %dx%d (%d iterations): fill sw=%d us ppa=%d us, "
+             "blend sw=%d us ppa=%d us, scale sw=%d us ppa=%d us",
+             width, height, iterations, result.fillSwUs, result.fillPpaUs,
+             result.blendSwUs, result.blendPpaUs, result.scaleSwUs, result.scalePpaUs);
+    return OS_OK;
+}
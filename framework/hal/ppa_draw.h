@@ -0,0 +1,160 @@
+#ifndef PPA_DRAW_H
+#define PPA_DRAW_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+#include <driver/ppa.h>
+
+/**
+ * @file ppa_draw.h
+ * @brief ESP32-P4 Pixel Processing Accelerator draw backend for LVGL
+ *
+ * Extends LVGL's software draw context: large opaque fills go to the PPA
+ * fill engine, alpha blends of colors and images to the blend engine, and
+ * unrotated image zoom to the scale-rotate-mirror engine. Anything small
+ * (below OS_DISPLAY_PPA_MIN_PIXELS), masked, rotated or in a format the
+ * PPA cannot read falls back to lv_draw_sw.
+ */
+
+/**
+ * @brief Per-path timings from runBenchmark()
+ */
+struct PPABenchmarkResult {
+    uint32_t pixels;        // Pixels per operation
+    uint32_t fillSwUs;
+    uint32_t fillPpaUs;
+    uint32_t blendSwUs;
+    uint32_t blendPpaUs;
+    uint32_t scaleSwUs;
+    uint32_t scalePpaUs;
+};
+
+class PPADrawBackend {
+public:
+    PPADrawBackend() = default;
+    ~PPADrawBackend();
+
+    /**
+     * @brief Register PPA clients
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize();
+
+    /**
+     * @brief Unregister PPA clients
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t shutdown();
+
+    /**
+     * @brief Install the backend's draw context on a display driver
+     * @param drv Driver to modify before lv_disp_drv_register(), with draw_buf set
+     * @param drawBufferBytes Bytes allocated for each of draw_buf's buffers
+     */
+    void attach(lv_disp_drv_t* drv, uint32_t drawBufferBytes);
+
+    /**
+     * @brief Route operations to the PPA or always use software
+     * @param enabled True to offload eligible operations
+     */
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /**
+     * @brief Check if offloading is enabled
+     * @return true if enabled, false otherwise
+     */
+    bool isEnabled() const { return m_enabled && m_initialized; }
+
+    /**
+     * @brief Time software and PPA paths on the same operations
+     * @param width Test area width
+     * @param height Test area height
+     * @param iterations Repetitions per path
+     * @param result Output timings (average per operation)
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t runBenchmark(uint16_t width, uint16_t height, uint32_t iterations,
+                            PPABenchmarkResult& result);
+
+    /**
+     * @brief Print offload statistics
+     */
+    void printStats() const;
+
+private:
+    struct DrawContext {
+        lv_draw_sw_ctx_t sw;        // Must stay first; LVGL treats this as lv_draw_sw_ctx_t
+        PPADrawBackend* backend;
+    };
+
+    static void initContext(lv_disp_drv_t* drv, lv_draw_ctx_t* ctx);
+    static void deinitContext(lv_disp_drv_t* drv, lv_draw_ctx_t* ctx);
+    static void blend(lv_draw_ctx_t* ctx, const lv_draw_sw_blend_dsc_t* dsc);
+    static void drawImageDecoded(lv_draw_ctx_t* ctx, const lv_draw_img_dsc_t* dsc,
+                                 const lv_area_t* coords, const uint8_t* src,
+                                 lv_img_cf_t cf);
+
+    /**
+     * @brief Try to run a blend descriptor on the PPA
+     * @return true if handled, false to fall back to software
+     */
+    bool blendHardware(lv_draw_ctx_t* ctx, const lv_draw_sw_blend_dsc_t* dsc);
+
+    /**
+     * @brief Try to scale an image on the PPA
+     * @return true if handled, false to fall back to software
+     */
+    bool scaleHardware(lv_draw_ctx_t* ctx, const lv_draw_img_dsc_t* dsc,
+                       const lv_area_t* coords, const uint8_t* src, lv_img_cf_t cf);
+
+    /**
+     * @brief Fill a block of a destination buffer
+     */
+    esp_err_t fill(lv_color_t* buf, uint16_t bufW, uint16_t bufH, uint32_t bufBytes,
+                   const lv_area_t& block, lv_color_t color);
+
+    /**
+     * @brief Blend a foreground block over a destination buffer in place
+     * @param fg Foreground pixels, or nullptr to blend a constant color
+     */
+    esp_err_t blendOver(lv_color_t* buf, uint16_t bufW, uint16_t bufH, uint32_t bufBytes,
+                        const lv_area_t& block, const lv_color_t* fg, uint16_t fgW,
+                        uint16_t fgX, uint16_t fgY, lv_color_t color, lv_opa_t opa);
+
+    /**
+     * @brief Copy a source block into a destination buffer with scaling
+     */
+    esp_err_t scale(const lv_color_t* src, uint16_t srcW, uint16_t srcH,
+                    const lv_area_t& srcBlock, lv_color_t* buf, uint16_t bufW,
+                    uint16_t bufH, uint32_t bufBytes, uint16_t outX, uint16_t outY, float scaleX, float scaleY);
+
+    /**
+     * @brief Check if the PPA's DMA can read a buffer
+     */
+    static bool isDmaReadable(const void* ptr);
+
+    /**
+     * @brief Bytes allocated behind a context's destination buffer
+     */
+    uint32_t outputBytes(const lv_draw_ctx_t* ctx) const;
+
+    static uint32_t bufferBytes(uint16_t w, uint16_t h);
+
+    const lv_disp_draw_buf_t* m_drawBuffer = nullptr;
+    uint32_t m_drawBufferBytes = 0;
+
+    ppa_client_handle_t m_fillClient = nullptr;
+    ppa_client_handle_t m_blendClient = nullptr;
+    ppa_client_handle_t m_srmClient = nullptr;
+    bool m_initialized = false;
+    bool m_enabled = OS_DISPLAY_PPA_ENABLED;
+
+    // Statistics
+    uint32_t m_ppaFills = 0;
+    uint32_t m_ppaBlends = 0;
+    uint32_t m_ppaScales = 0;
+    uint32_t m_swFallbacks = 0;
+    uint32_t m_ppaErrors = 0;
+};
+
+#endif // PPA_DRAW_H
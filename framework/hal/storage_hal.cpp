@@ -7,9 +7,15 @@
 #include <sdmmc_cmd.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <unistd.h>
 
 static const char* TAG = "StorageHAL";
 
+// Handles pack the table index with a generation so stale ones are rejected
+static constexpr uint32_t HANDLE_INDEX_BITS = 8;
+static constexpr uint32_t HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+static_assert(OS_MAX_FILES_OPEN <= HANDLE_INDEX_MASK, "Too many open files for the handle encoding");
+
 StorageHAL::~StorageHAL() {
     shutdown();
 }
@@ -21,6 +27,19 @@ os_error_t StorageHAL::initialize() {
 
     ESP_LOGI(TAG, "Initializing Storage HAL");
 
+    m_fileLock = xSemaphoreCreateMutex();
+    m_queueLock = xSemaphoreCreateMutex();
+    if (!m_fileLock || !m_queueLock) {
+        return OS_ERROR_NO_MEMORY;
+    }
+    for (auto& entry : m_files) {
+        entry.lock = xSemaphoreCreateMutex();
+        if (!entry.lock) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    // Packed assets are mapped separately by mountAssets(), on the LVGL task
     // Initialize internal flash storage (SPIFFS)
     os_error_t result = initializeInternalFlash();
     if (result != OS_OK) {
@@ -39,6 +58,23 @@ os_error_t StorageHAL::initialize() {
     createDirectory("/storage/config");
     createDirectory("/storage/logs");
 
+    if (startStorageTask() != OS_OK) {
+        ESP_LOGW(TAG, "Storage task unavailable, async I/O disabled");
+    }
+
+    if (m_cache.initialize() != OS_OK) {
+        ESP_LOGW(TAG, "Write-back cache unavailable, writing through");
+    }
+    if (m_dirCache.initialize() != OS_OK) {
+        ESP_LOGW(TAG, "Directory cache unavailable");
+    }
+    if (m_copier.initialize() != OS_OK) {
+        ESP_LOGW(TAG, "Copy engine unavailable, file copies disabled");
+    }
+    if (m_operations.initialize(this) != OS_OK) {
+        ESP_LOGW(TAG, "File operation queue unavailable");
+    }
+
     m_lastStatsUpdate = millis();
     m_initialized = true;
 
@@ -46,6 +82,18 @@ os_error_t StorageHAL::initialize() {
     return OS_OK;
 }
 
+os_error_t StorageHAL::mountAssets() {
+    if (m_assets.isMounted()) {
+        return OS_OK;
+    }
+
+    os_error_t result = m_assets.mount();
+    if (result == OS_OK) {
+        result = m_assets.registerFilesystem();
+    }
+    return result;
+}
+
 os_error_t StorageHAL::shutdown() {
     if (!m_initialized) {
         return OS_OK;
@@ -53,8 +101,32 @@ os_error_t StorageHAL::shutdown() {
 
     ESP_LOGI(TAG, "Shutting down Storage HAL");
 
-    // Sync all pending writes
+    // Queued requests are dropped; their buffers may already be gone
+    stopStorageTask();
+    m_requests.clear();
+    m_completions.clear();
+    m_operations.shutdown();     // Before the copy engine it waits on
+    m_copier.shutdown();
+
+    if (m_shutdownListener) {
+        OS().getEventSystem().unsubscribe(m_shutdownListener);
+        m_shutdownListener = 0;
+    }
+
+    // Sync all pending writes and close what apps left open
     sync();
+    for (size_t i = 0; i < OS_MAX_FILES_OPEN; i++) {
+        if (m_files[i].file) {
+            ESP_LOGW(TAG, "Closing leaked file handle %d", (int)i);
+            fclose(m_files[i].file);
+            m_cache.releaseStream(m_files[i].file);
+            m_files[i].file = nullptr;
+            m_files[i].pending = 0;
+        }
+    }
+    m_cache.shutdown();
+    m_dirCache.shutdown();
+    m_assets.unmount();
 
     // Unmount all storage devices
     for (const auto& storage : m_storageDevices) {
@@ -68,6 +140,20 @@ os_error_t StorageHAL::shutdown() {
     }
 
     m_storageDevices.clear();
+    for (auto& entry : m_files) {
+        if (entry.lock) {
+            vSemaphoreDelete(entry.lock);
+            entry.lock = nullptr;
+        }
+    }
+    if (m_fileLock) {
+        vSemaphoreDelete(m_fileLock);
+        m_fileLock = nullptr;
+    }
+    if (m_queueLock) {
+        vSemaphoreDelete(m_queueLock);
+        m_queueLock = nullptr;
+    }
     m_initialized = false;
 
     ESP_LOGI(TAG, "Storage HAL shutdown complete");
@@ -79,7 +165,19 @@ os_error_t StorageHAL::update(uint32_t deltaTime) {
         return OS_ERROR_GENERIC;
     }
 
+    // Cached appends must reach the card before power goes. Subscribed
+    // here rather than in initialize(), which may run on a boot worker
+    if (!m_shutdownListener) {
+        m_shutdownListener = SUBSCRIBE_EVENT(EVENT_SYSTEM_SHUTDOWN,
+                                             [this](const EventData&) { sync(); });
+    }
+
+    dispatchCompletions();
+    m_copier.dispatch();
+    m_operations.update();
+
     uint32_t currentTime = millis();
+    m_cache.flushExpired(currentTime);
     
     // Update storage statistics every 30 seconds
     if (currentTime - m_lastStatsUpdate >= 30000) {
@@ -178,7 +276,11 @@ os_error_t StorageHAL::createDirectory(const char* path) {
         return OS_ERROR_INVALID_PARAM;
     }
 
-    if (mkdir(path, 0755) == 0 || errno == EEXIST) {
+    if (mkdir(path, 0755) == 0) {
+        m_dirCache.noteCreatedOrRemoved(path);
+        return OS_OK;
+    }
+    if (errno == EEXIST) {
         return OS_OK;
     }
 
@@ -186,8 +288,72 @@ os_error_t StorageHAL::createDirectory(const char* path) {
     return OS_ERROR_FILESYSTEM;
 }
 
+os_error_t StorageHAL::removeDirectory(const char* path, bool recursive) {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    if (recursive) {
+        std::vector<std::string> names;
+        DIR* dir = opendir(path);
+        if (!dir) {
+            return OS_ERROR_NOT_FOUND;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                names.emplace_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+
+        for (const auto& name : names) {
+            std::string child = std::string(path) + "/" + name;
+            struct stat st;
+            if (stat(child.c_str(), &st) != 0) {
+                continue;
+            }
+            os_error_t result = S_ISDIR(st.st_mode) ? removeDirectory(child.c_str(), true)
+                                                    : deleteFile(child.c_str());
+            if (result != OS_OK) {
+                return result;
+            }
+        }
+    }
+
+    if (rmdir(path) == 0) {
+        m_dirCache.invalidate(path);
+        m_dirCache.noteCreatedOrRemoved(path);
+        return OS_OK;
+    }
+
+    ESP_LOGE(TAG, "Failed to remove directory %s: %s", path, strerror(errno));
+    return OS_ERROR_FILESYSTEM;
+}
+
+os_error_t StorageHAL::renamePath(const char* sourcePath, const char* destPath) {
+    if (!sourcePath || !destPath) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Appends still cached under the old name must land before it changes
+    m_cache.flushPath(sourcePath);
+    m_cache.flushDirectory(sourcePath);
+    if (rename(sourcePath, destPath) != 0) {
+        // Expected across volumes; callers fall back to copying
+        ESP_LOGD(TAG, "Rename %s -> %s failed: %s", sourcePath, destPath, strerror(errno));
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_dirCache.invalidate(sourcePath);
+    m_dirCache.noteCreatedOrRemoved(sourcePath);
+    m_dirCache.noteCreatedOrRemoved(destPath);
+    return OS_OK;
+}
+
 bool StorageHAL::exists(const char* path) const {
     if (!path) return false;
+    m_cache.flushPath(path);
     
     struct stat st;
     return stat(path, &st) == 0;
@@ -196,6 +362,7 @@ bool StorageHAL::exists(const char* path) const {
 HALFileInfo StorageHAL::getFileInfo(const char* path) const {
     HALFileInfo info;
     if (!path) return info;
+    m_cache.flushPath(path);
 
     struct stat st;
     if (stat(path, &st) == 0) {
@@ -213,34 +380,57 @@ std::vector<HALFileInfo> StorageHAL::listDirectory(const char* path) const {
     std::vector<HALFileInfo> files;
     if (!path) return files;
 
-    DIR* dir = opendir(path);
-    if (!dir) {
-        ESP_LOGE(TAG, "Failed to open directory %s", path);
-        return files;
-    }
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+    std::vector<HALDirEntry> page;
+    size_t cursor = 0;
+    while (cursor != DIR_CURSOR_END) {
+        size_t index = cursor;
+        if (readDirectory(path, cursor, OS_STORAGE_DIR_PAGE_SIZE, page, cursor) != OS_OK) {
+            break;
         }
-
-        std::string fullPath = std::string(path) + "/" + entry->d_name;
-        HALFileInfo info = getFileInfo(fullPath.c_str());
-        if (!info.name.empty()) {
-            files.push_back(info);
+        for (size_t i = 0; i < page.size(); i++, index++) {
+            HALDirEntry entry;
+            if (getDirectoryEntry(path, index, entry) != OS_OK) {
+                continue;
+            }
+            HALFileInfo info;
+            info.name = std::move(entry.name);
+            info.path.reserve(strlen(path) + 1 + info.name.size());
+            info.path.append(path).append("/").append(info.name);
+            info.size = entry.size;
+            info.timestamp = entry.timestamp;
+            info.isDirectory = entry.isDirectory;
+            files.push_back(std::move(info));
         }
     }
 
-    closedir(dir);
     return files;
 }
 
+os_error_t StorageHAL::readDirectory(const char* path, size_t cursor, size_t maxEntries,
+                                     std::vector<HALDirEntry>& entries, size_t& nextCursor) const {
+    if (!path || maxEntries == 0) {
+        entries.clear();
+        nextCursor = DIR_CURSOR_END;
+        return OS_ERROR_INVALID_PARAM;
+    }
+    return m_dirCache.readPage(path, cursor, maxEntries, entries, nextCursor);
+}
+
+os_error_t StorageHAL::getDirectoryEntry(const char* path, size_t index, HALDirEntry& entry) const {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    // Sizes must include appends still sitting in the write-back cache
+    m_cache.flushDirectory(path);
+    return m_dirCache.getEntryInfo(path, index, entry);
+}
+
 int StorageHAL::readFile(const char* path, void* buffer, size_t bufferSize) {
     if (!path || !buffer || bufferSize == 0) {
         return -1;
     }
 
+    m_cache.flushPath(path);
     FILE* file = fopen(path, "rb");
     if (!file) {
         ESP_LOGE(TAG, "Failed to open file for reading: %s", path);
@@ -261,6 +451,19 @@ int StorageHAL::writeFile(const char* path, const void* data, size_t dataSize, b
         return -1;
     }
 
+    // Small appends collect in the write-back cache
+    if (append && m_cache.append(path, data, dataSize)) {
+        m_dirCache.noteModified(path);
+        m_totalWrites++;
+        m_bytesWritten += dataSize;
+        return (int)dataSize;
+    }
+
+    // An overwrite replaces whatever was still cached
+    if (!append) {
+        m_cache.discardPath(path);
+    }
+
     FILE* file = fopen(path, append ? "ab" : "wb");
     if (!file) {
         ESP_LOGE(TAG, "Failed to open file for writing: %s", path);
@@ -269,6 +472,7 @@ int StorageHAL::writeFile(const char* path, const void* data, size_t dataSize, b
 
     size_t bytesWritten = fwrite(data, 1, dataSize, file);
     fclose(file);
+    m_dirCache.noteModified(path);
 
     m_totalWrites++;
     m_bytesWritten += bytesWritten;
@@ -281,7 +485,9 @@ os_error_t StorageHAL::deleteFile(const char* path) {
         return OS_ERROR_INVALID_PARAM;
     }
 
+    m_cache.discardPath(path);
     if (unlink(path) == 0) {
+        m_dirCache.noteCreatedOrRemoved(path);
         return OS_OK;
     }
 
@@ -289,38 +495,481 @@ os_error_t StorageHAL::deleteFile(const char* path) {
     return OS_ERROR_FILESYSTEM;
 }
 
-os_error_t StorageHAL::copyFile(const char* sourcePath, const char* destPath) {
+os_error_t StorageHAL::copyFile(const char* sourcePath, const char* destPath, CopyControl* control) {
     if (!sourcePath || !destPath) {
         return OS_ERROR_INVALID_PARAM;
     }
 
-    // Simple copy implementation
-    char buffer[1024];
-    int bytesRead = readFile(sourcePath, buffer, sizeof(buffer));
-    
-    if (bytesRead < 0) {
-        return OS_ERROR_FILESYSTEM;
+    return runCopy(sourcePath, destPath, false, control);
+}
+
+os_error_t StorageHAL::moveFile(const char* sourcePath, const char* destPath, CopyControl* control) {
+    if (!sourcePath || !destPath) {
+        return OS_ERROR_INVALID_PARAM;
     }
 
-    if (writeFile(destPath, buffer, bytesRead) < 0) {
-        return OS_ERROR_FILESYSTEM;
+    return runCopy(sourcePath, destPath, true, control);
+}
+
+CopyJobId StorageHAL::copyFileAsync(const char* sourcePath, const char* destPath,
+                                    CopyProgressCallback progress, CopyCompleteCallback complete) {
+    return startCopy(sourcePath, destPath, false, std::move(progress), std::move(complete));
+}
+
+CopyJobId StorageHAL::moveFileAsync(const char* sourcePath, const char* destPath,
+                                    CopyProgressCallback progress, CopyCompleteCallback complete) {
+    return startCopy(sourcePath, destPath, true, std::move(progress), std::move(complete));
+}
+
+CopyJobId StorageHAL::startCopy(const char* sourcePath, const char* destPath, bool move,
+                                CopyProgressCallback progress, CopyCompleteCallback complete) {
+    if (!sourcePath || !destPath) {
+        return 0;
     }
 
-    return OS_OK;
+    // The engine reads the medium directly, and replaces the destination
+    m_cache.flushPath(sourcePath);
+    m_cache.discardPath(destPath);
+
+    std::string source = sourcePath;
+    std::string dest = destPath;
+    return m_copier.submit(sourcePath, destPath, move, std::move(progress),
+        [this, source, dest, move, complete](os_error_t result, const CopyProgress& done) {
+            noteCopied(source, dest, move);
+            if (result == OS_OK) {
+                m_totalWrites++;
+                m_bytesWritten += done.bytesCopied;
+            }
+            if (complete) {
+                complete(result, done);
+            }
+        });
+}
+
+os_error_t StorageHAL::runCopy(const char* sourcePath, const char* destPath, bool move, CopyControl* control) {
+    m_cache.flushPath(sourcePath);
+    m_cache.discardPath(destPath);
+
+    os_error_t result = m_copier.run(sourcePath, destPath, move, control);
+    noteCopied(sourcePath, destPath, move);
+    return result;
+}
+
+void StorageHAL::noteCopied(const std::string& sourcePath, const std::string& destPath, bool move) {
+    // Also on failure: a partial destination may have come and gone
+    m_dirCache.noteModified(destPath.c_str());
+    if (move) {
+        m_dirCache.noteCreatedOrRemoved(sourcePath.c_str());
+    }
 }
 
 os_error_t StorageHAL::sync() {
-    // Force all cached writes to storage
-    sync();
+    // Write back cached appends, then force buffered writes on every
+    // open handle out to the medium
+    os_error_t result = m_cache.flushAll();
+    for (auto& entry : m_files) {
+        if (!entry.lock) {
+            continue;
+        }
+        xSemaphoreTake(entry.lock, portMAX_DELAY);
+        FILE* file = entry.file;
+        if (file && (fflush(file) != 0 || fsync(fileno(file)) != 0)) {
+            result = OS_ERROR_FILESYSTEM;
+        }
+        xSemaphoreGive(entry.lock);
+    }
+    return result;
+}
+
+FileHandle StorageHAL::openFile(const char* path, FileOpenMode mode) {
+    if (!path || !m_fileLock) {
+        return INVALID_FILE_HANDLE;
+    }
+
+    static const char* modes[] = {"rb", "wb", "ab", "r+b"};
+
+    xSemaphoreTake(m_fileLock, portMAX_DELAY);
+    size_t index = 0;
+    while (index < OS_MAX_FILES_OPEN && m_files[index].file) {
+        index++;
+    }
+    if (index == OS_MAX_FILES_OPEN) {
+        xSemaphoreGive(m_fileLock);
+        ESP_LOGW(TAG, "Cannot open %s: %d files already open", path, OS_MAX_FILES_OPEN);
+        return INVALID_FILE_HANDLE;
+    }
+
+    m_cache.flushPath(path);
+    FILE* file = fopen(path, modes[(int)mode]);
+    if (!file) {
+        xSemaphoreGive(m_fileLock);
+        ESP_LOGE(TAG, "Failed to open %s: %s", path, strerror(errno));
+        return INVALID_FILE_HANDLE;
+    }
+    m_cache.attachStream(file);
+    if (mode != FileOpenMode::READ) {
+        m_dirCache.noteModified(path);
+    }
+
+    OpenFile& entry = m_files[index];
+    entry.file = file;
+    entry.generation = (entry.generation + 1) & 0x7FFF;
+    if (entry.generation == 0) {
+        entry.generation = 1;
+    }
+    entry.pending = 0;
+    m_handleOpens++;
+    FileHandle handle = (FileHandle)((entry.generation << HANDLE_INDEX_BITS) | index);
+    xSemaphoreGive(m_fileLock);
+
+    return handle;
+}
+
+os_error_t StorageHAL::closeFile(FileHandle handle) {
+    if (handle <= 0 || !m_fileLock) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Wait for a synchronous call on another task to finish with the stream
+    FILE* file = acquire(handle);
+    if (!file) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    xSemaphoreTake(m_fileLock, portMAX_DELAY);
+    OpenFile& entry = m_files[handle & HANDLE_INDEX_MASK];
+    if (entry.pending > 0) {
+        xSemaphoreGive(m_fileLock);
+        release(handle);
+        return OS_ERROR_BUSY;
+    }
+    entry.file = nullptr;
+    xSemaphoreGive(m_fileLock);
+
+    int closed = fclose(file);
+    m_cache.releaseStream(file);
+    release(handle);
+    return closed == 0 ? OS_OK : OS_ERROR_FILESYSTEM;
+}
+
+FILE* StorageHAL::lookup(FileHandle handle) const {
+    if (handle <= 0) {
+        return nullptr;
+    }
+
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    uint16_t generation = (uint16_t)(handle >> HANDLE_INDEX_BITS);
+    if (index >= OS_MAX_FILES_OPEN || m_files[index].generation != generation) {
+        return nullptr;
+    }
+    return m_files[index].file;
+}
+
+FILE* StorageHAL::acquire(FileHandle handle) {
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    if (handle <= 0 || index >= OS_MAX_FILES_OPEN || !m_files[index].lock) {
+        return nullptr;
+    }
+
+    // Check again under the lock: the handle may have been closed meanwhile
+    xSemaphoreTake(m_files[index].lock, portMAX_DELAY);
+    FILE* file = lookup(handle);
+    if (!file) {
+        xSemaphoreGive(m_files[index].lock);
+    }
+    return file;
+}
+
+void StorageHAL::release(FileHandle handle) {
+    xSemaphoreGive(m_files[handle & HANDLE_INDEX_MASK].lock);
+}
+
+int StorageHAL::read(FileHandle handle, void* buffer, size_t size) {
+    if (!buffer) {
+        return -1;
+    }
+    FILE* file = acquire(handle);
+    if (!file) {
+        return -1;
+    }
+
+    int bytesRead = readStream(file, buffer, size);
+    release(handle);
+    return bytesRead;
+}
+
+int StorageHAL::write(FileHandle handle, const void* data, size_t size) {
+    if (!data) {
+        return -1;
+    }
+    FILE* file = acquire(handle);
+    if (!file) {
+        return -1;
+    }
+
+    int bytesWritten = writeStream(file, data, size);
+    release(handle);
+    return bytesWritten;
+}
+
+int StorageHAL::readStream(FILE* file, void* buffer, size_t size) {
+    size_t bytesRead = fread(buffer, 1, size, file);
+    if (bytesRead < size && ferror(file)) {
+        clearerr(file);
+        return -1;
+    }
+
+    m_totalReads++;
+    m_bytesRead += bytesRead;
+    return (int)bytesRead;
+}
+
+int StorageHAL::writeStream(FILE* file, const void* data, size_t size) {
+    size_t bytesWritten = fwrite(data, 1, size, file);
+    if (bytesWritten < size) {
+        clearerr(file);
+        return -1;
+    }
+
+    m_totalWrites++;
+    m_bytesWritten += bytesWritten;
+    return (int)bytesWritten;
+}
+
+os_error_t StorageHAL::seek(FileHandle handle, int64_t offset, FileSeekOrigin origin) {
+    FILE* file = acquire(handle);
+    if (!file) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    bool moved = fseeko(file, (off_t)offset, whence[(int)origin]) == 0;
+    release(handle);
+    return moved ? OS_OK : OS_ERROR_FILESYSTEM;
+}
+
+int64_t StorageHAL::tell(FileHandle handle) {
+    FILE* file = acquire(handle);
+    if (!file) {
+        return -1;
+    }
+
+    int64_t position = (int64_t)ftello(file);
+    release(handle);
+    return position;
+}
+
+int64_t StorageHAL::getFileSize(FileHandle handle) {
+    FILE* file = acquire(handle);
+    if (!file) {
+        return -1;
+    }
+
+    // Buffered writes are not visible to fstat until flushed
+    fflush(file);
+    struct stat st;
+    int64_t size = fstat(fileno(file), &st) == 0 ? (int64_t)st.st_size : -1;
+    release(handle);
+    return size;
+}
+
+os_error_t StorageHAL::flush(FileHandle handle) {
+    FILE* file = acquire(handle);
+    if (!file) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    bool flushed = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    release(handle);
+    return flushed ? OS_OK : OS_ERROR_FILESYSTEM;
+}
+
+size_t StorageHAL::getOpenFileCount() const {
+    size_t count = 0;
+    for (const auto& entry : m_files) {
+        if (entry.file) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t StorageHAL::readAsync(FileHandle handle, void* buffer, size_t size, int64_t offset,
+                               StorageCallback callback) {
+    if (!buffer) {
+        return 0;
+    }
+    AsyncRequest request{0, false, handle, buffer, size, offset, std::move(callback)};
+    return queueRequest(std::move(request));
+}
+
+uint32_t StorageHAL::writeAsync(FileHandle handle, const void* data, size_t size, int64_t offset,
+                                StorageCallback callback) {
+    if (!data) {
+        return 0;
+    }
+    AsyncRequest request{0, true, handle, const_cast<void*>(data), size, offset, std::move(callback)};
+    return queueRequest(std::move(request));
+}
+
+uint32_t StorageHAL::queueRequest(AsyncRequest request) {
+    if (!m_storageTask) {
+        return 0;
+    }
+
+    // Mark the handle busy so it cannot be closed under the request
+    xSemaphoreTake(m_fileLock, portMAX_DELAY);
+    if (!lookup(request.handle)) {
+        xSemaphoreGive(m_fileLock);
+        return 0;
+    }
+    m_files[request.handle & HANDLE_INDEX_MASK].pending++;
+    xSemaphoreGive(m_fileLock);
+
+    xSemaphoreTake(m_queueLock, portMAX_DELAY);
+    if (m_requests.size() >= OS_STORAGE_ASYNC_DEPTH) {
+        xSemaphoreGive(m_queueLock);
+        xSemaphoreTake(m_fileLock, portMAX_DELAY);
+        m_files[request.handle & HANDLE_INDEX_MASK].pending--;
+        xSemaphoreGive(m_fileLock);
+        ESP_LOGW(TAG, "Async queue full");
+        return 0;
+    }
+    request.id = ++m_nextRequestId;
+    if (request.id == 0) {
+        request.id = ++m_nextRequestId;
+    }
+    uint32_t id = request.id;
+    m_requests.push_back(std::move(request));
+    m_asyncRequests++;
+    xSemaphoreGive(m_queueLock);
+
+    xTaskNotifyGive(m_storageTask);
+    return id;
+}
+
+void StorageHAL::executeRequest(AsyncRequest& request) {
+    os_error_t result = OS_OK;
+    int bytes = 0;
+
+    // Seek and transfer under one lock so no synchronous call moves the
+    // position in between
+    FILE* file = acquire(request.handle);
+    if (!file) {
+        result = OS_ERROR_INVALID_PARAM;
+    } else {
+        if (request.offset >= 0 && fseeko(file, (off_t)request.offset, SEEK_SET) != 0) {
+            result = OS_ERROR_FILESYSTEM;
+        }
+        if (result == OS_OK) {
+            bytes = request.write ? writeStream(file, request.buffer, request.size)
+                                  : readStream(file, request.buffer, request.size);
+            if (bytes < 0) {
+                result = OS_ERROR_FILESYSTEM;
+                bytes = 0;
+            }
+        }
+        release(request.handle);
+    }
+    if (result != OS_OK) {
+        m_asyncErrors++;
+    }
+
+    xSemaphoreTake(m_fileLock, portMAX_DELAY);
+    m_files[request.handle & HANDLE_INDEX_MASK].pending--;
+    xSemaphoreGive(m_fileLock);
+
+    if (request.callback) {
+        xSemaphoreTake(m_queueLock, portMAX_DELAY);
+        m_completions.push_back({std::move(request.callback), result, (size_t)bytes});
+        xSemaphoreGive(m_queueLock);
+
+        // The callback runs on the main loop, which may be asleep
+        OS().wake();
+    }
+}
+
+void StorageHAL::dispatchCompletions() {
+    if (!m_queueLock) {
+        return;
+    }
+
+    std::vector<AsyncCompletion> ready;
+    xSemaphoreTake(m_queueLock, portMAX_DELAY);
+    ready.swap(m_completions);
+    xSemaphoreGive(m_queueLock);
+
+    for (auto& completion : ready) {
+        completion.callback(completion.result, completion.bytes);
+    }
+}
+
+os_error_t StorageHAL::startStorageTask() {
+    m_taskRunning = true;
+    if (xTaskCreatePinnedToCore(storageTask, "os_storage", OS_STORAGE_TASK_STACK, this,
+                                OS_STORAGE_TASK_PRIORITY, &m_storageTask,
+                                OS_STORAGE_TASK_CORE) != pdPASS) {
+        m_taskRunning = false;
+        m_storageTask = nullptr;
+        return OS_ERROR_NO_MEMORY;
+    }
     return OS_OK;
 }
 
+void StorageHAL::stopStorageTask() {
+    if (!m_storageTask) {
+        return;
+    }
+
+    m_taskRunning = false;
+    TaskHandle_t task = m_storageTask;
+    xTaskNotifyGive(task);
+
+    // The task clears its handle on exit; a card transfer may be in flight
+    for (int attempt = 0; attempt < 100 && m_storageTask; attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (m_storageTask) {
+        ESP_LOGW(TAG, "Storage task did not exit, deleting");
+        vTaskDelete(task);
+        m_storageTask = nullptr;
+    }
+}
+
+void StorageHAL::storageTask(void* arg) {
+    StorageHAL* storage = static_cast<StorageHAL*>(arg);
+
+    while (storage->m_taskRunning) {
+        xSemaphoreTake(storage->m_queueLock, portMAX_DELAY);
+        if (storage->m_requests.empty()) {
+            xSemaphoreGive(storage->m_queueLock);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        AsyncRequest request = std::move(storage->m_requests.front());
+        storage->m_requests.pop_front();
+        xSemaphoreGive(storage->m_queueLock);
+
+        storage->executeRequest(request);
+    }
+
+    storage->m_storageTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
 void StorageHAL::printStats() const {
     ESP_LOGI(TAG, "=== Storage HAL Statistics ===");
     ESP_LOGI(TAG, "Total reads: %d", m_totalReads);
     ESP_LOGI(TAG, "Total writes: %d", m_totalWrites);
     ESP_LOGI(TAG, "Bytes read: %llu", m_bytesRead);
     ESP_LOGI(TAG, "Bytes written: %llu", m_bytesWritten);
+    ESP_LOGI(TAG, "Open handles: %d/%d (%d opened), async requests: %d (%d failed)",
+             getOpenFileCount(), OS_MAX_FILES_OPEN, m_handleOpens, m_asyncRequests, m_asyncErrors);
+    m_cache.printStats();
+    m_dirCache.printStats();
+    m_copier.printStats();
+    m_operations.printStats();
+    m_assets.printStats();
     
     ESP_LOGI(TAG, "=== Storage Devices ===");
     for (const auto& storage : m_storageDevices) {
@@ -342,7 +991,7 @@ os_error_t StorageHAL::initializeInternalFlash() {
     esp_vfs_spiffs_conf_t conf = {
         .base_path = "/storage",
         .partition_label = nullptr,
-        .max_files = 5,
+        .max_files = OS_MAX_FILES_OPEN,
         .format_if_mount_failed = true
     };
 
@@ -2,6 +2,18 @@
 #define STORAGE_HAL_H
 
 #include "../system/os_config.h"
+#include "../system/event_system.h"
+#include "write_back_cache.h"
+#include "directory_cache.h"
+#include "file_copier.h"
+#include "file_operation_queue.h"
+#include "asset_pack.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <cstdio>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -11,6 +23,21 @@
  * 
  * Manages persistent storage including internal flash, SD card,
  * and configuration storage with file system abstraction.
+ *
+ * Besides whole-file readFile()/writeFile(), files can be opened as
+ * handles (at most OS_MAX_FILES_OPEN at once) for streaming, seeking and
+ * partial I/O. Handle reads and writes can also be queued to a storage
+ * task; their completion callbacks run on the main loop from update().
+ * Each handle has its own lock, so one handle may be used from several
+ * tasks and from queued requests at once.
+ * Small appends and handle streams go through a write-back cache that is
+ * flushed on a timer, by sync() and on EVENT_SYSTEM_SHUTDOWN.
+ * Large directories are read a page at a time with readDirectory(),
+ * deferring stat() to getDirectoryEntry() for the rows actually shown.
+ * Copies and moves stream through a pipelined background engine; whole
+ * directory trees are copied, moved and deleted by a queue on its own
+ * task that reports through EVENT_HAL_FILE_OP_PROGRESS/COMPLETE.
+ * Read-only UI assets come from a memory-mapped flash partition.
  */
 
 enum class HALStorageType {
@@ -37,6 +64,29 @@ struct HALFileInfo {
     bool isDirectory;
 };
 
+typedef int32_t FileHandle;
+static constexpr FileHandle INVALID_FILE_HANDLE = -1;
+
+enum class FileOpenMode : uint8_t {
+    READ,           // Existing file, read only
+    WRITE,          // Create or truncate, write only
+    APPEND,         // Create or append, write only
+    READ_WRITE      // Existing file, read and write
+};
+
+enum class FileSeekOrigin : uint8_t {
+    BEGIN,
+    CURRENT,
+    END
+};
+
+/**
+ * @brief Async I/O completion
+ * @param result OS_OK or error code
+ * @param bytes Bytes transferred
+ */
+typedef std::function<void(os_error_t result, size_t bytes)> StorageCallback;
+
 class StorageHAL {
 public:
     StorageHAL() = default;
@@ -48,6 +98,16 @@ public:
      */
     os_error_t initialize();
 
+    /**
+     * @brief Map the asset pack and register its LVGL driver
+     *
+     * Needs no filesystem, so the UI can use packed assets before
+     * initialize() has mounted anything. Call on the LVGL task after
+     * lv_init(); initialize() may run on another task.
+     * @return OS_OK on success, error code if there is no usable pack
+     */
+    os_error_t mountAssets();
+
     /**
      * @brief Shutdown storage systems
      * @return OS_OK on success, error code on failure
@@ -111,12 +171,24 @@ public:
 
     /**
      * @brief Remove directory
+     *
+     * A recursive removal blocks until the tree is gone; queue a
+     * FileOpType::DELETE from the UI.
      * @param path Directory path to remove
      * @param recursive True to remove recursively
      * @return OS_OK on success, error code on failure
      */
     os_error_t removeDirectory(const char* path, bool recursive = false);
 
+    /**
+     * @brief Rename a file or directory within its volume
+     * @param sourcePath Current path
+     * @param destPath New path
+     * @return OS_OK on success, OS_ERROR_FILESYSTEM if the paths are on
+     *         different volumes or the rename failed
+     */
+    os_error_t renamePath(const char* sourcePath, const char* destPath);
+
     /**
      * @brief Check if path exists
      * @param path Path to check
@@ -133,11 +205,45 @@ public:
 
     /**
      * @brief List directory contents
+     *
+     * Reads and stat()s the whole directory; prefer readDirectory() for
+     * folders that may be large.
      * @param path Directory path to list
      * @return Vector of file information
      */
     std::vector<HALFileInfo> listDirectory(const char* path) const;
 
+    /**
+     * @brief Read a page of directory entries
+     *
+     * Entries carry name and type only (hasInfo is set for those already
+     * stat()ed). The listing is cached, so following pages and re-reads
+     * cost no readdir() until a StorageHAL mutation touches the directory.
+     * @param path Directory path
+     * @param cursor 0 for the first page, then the returned nextCursor
+     * @param maxEntries Page size
+     * @param entries Filled with the page
+     * @param nextCursor Cursor of the next page, DIR_CURSOR_END after the last
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t readDirectory(const char* path, size_t cursor, size_t maxEntries,
+                             std::vector<HALDirEntry>& entries, size_t& nextCursor) const;
+
+    /**
+     * @brief Get one directory entry with its size and timestamp
+     * @param path Directory path
+     * @param index Entry index (cursor position) from readDirectory()
+     * @param entry Filled on success
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if there is no such entry
+     */
+    os_error_t getDirectoryEntry(const char* path, size_t index, HALDirEntry& entry) const;
+
+    /**
+     * @brief Forget a cached listing after changes made outside StorageHAL
+     * @param path Directory path
+     */
+    void invalidateDirectory(const char* path) { m_dirCache.invalidate(path); }
+
     /**
      * @brief Read file contents
      * @param path File path to read
@@ -166,11 +272,206 @@ public:
 
     /**
      * @brief Copy file
+     *
+     * Runs on the copy engine and blocks until it is done; use
+     * copyFileAsync() from the UI.
+     * @param sourcePath Source file path
+     * @param destPath Destination file path
+     * @param control Optional pause/cancel flags for a caller on another task
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t copyFile(const char* sourcePath, const char* destPath, CopyControl* control = nullptr);
+
+    /**
+     * @brief Move file, renaming when possible and copying across devices
      * @param sourcePath Source file path
      * @param destPath Destination file path
+     * @param control Optional pause/cancel flags for a caller on another task
      * @return OS_OK on success, error code on failure
      */
-    os_error_t copyFile(const char* sourcePath, const char* destPath);
+    os_error_t moveFile(const char* sourcePath, const char* destPath, CopyControl* control = nullptr);
+
+    /**
+     * @brief Copy a file in the background
+     * @param sourcePath Source file path
+     * @param destPath Destination file path
+     * @param progress Optional progress callback (main loop)
+     * @param complete Optional completion callback (main loop)
+     * @return Job ID or 0 on failure
+     */
+    CopyJobId copyFileAsync(const char* sourcePath, const char* destPath,
+                            CopyProgressCallback progress, CopyCompleteCallback complete);
+
+    /**
+     * @brief Move a file in the background
+     * @param sourcePath Source file path
+     * @param destPath Destination file path
+     * @param progress Optional progress callback (main loop)
+     * @param complete Optional completion callback (main loop)
+     * @return Job ID or 0 on failure
+     */
+    CopyJobId moveFileAsync(const char* sourcePath, const char* destPath,
+                            CopyProgressCallback progress, CopyCompleteCallback complete);
+
+    /**
+     * @brief Cancel a background copy or move
+     * @param id Job ID
+     * @return OS_OK if cancelled, OS_ERROR_NOT_FOUND if already finished
+     */
+    os_error_t cancelCopy(CopyJobId id) { return m_copier.cancel(id) ? OS_OK : OS_ERROR_NOT_FOUND; }
+
+    /**
+     * @brief Get a background copy's progress
+     * @param id Job ID
+     * @param progress Filled while the job is queued or running
+     * @return true if the job was found
+     */
+    bool getCopyProgress(CopyJobId id, CopyProgress& progress) const {
+        return m_copier.getProgress(id, progress);
+    }
+
+    /**
+     * @brief Queue a background copy, move or delete of a file or directory tree
+     *
+     * Progress arrives as EVENT_HAL_FILE_OP_PROGRESS and the result as
+     * EVENT_HAL_FILE_OP_COMPLETE, both with a FileOpStatus.
+     * @param type Operation
+     * @param sourcePath File or directory
+     * @param destPath Destination path (not used by a delete)
+     * @return Operation ID or 0 if the queue is full
+     */
+    FileOpId queueFileOperation(FileOpType type, const char* sourcePath, const char* destPath = nullptr) {
+        return m_operations.submit(type, sourcePath, destPath);
+    }
+
+    /**
+     * @brief Cancel a queued or running file operation
+     * @param id Operation ID
+     * @return OS_OK if cancelled, OS_ERROR_NOT_FOUND if already finished
+     */
+    os_error_t cancelFileOperation(FileOpId id) {
+        return m_operations.cancel(id) ? OS_OK : OS_ERROR_NOT_FOUND;
+    }
+
+    /**
+     * @brief Pause or resume file operations
+     * @param paused True to hold the running operation and the queue
+     */
+    void pauseFileOperations(bool paused) { m_operations.setPaused(paused); }
+
+    /**
+     * @brief Check if file operations are paused
+     * @return true if paused
+     */
+    bool areFileOperationsPaused() const { return m_operations.isPaused(); }
+
+    /**
+     * @brief Get the running file operation's progress
+     * @param status Filled while an operation runs
+     * @return true if an operation is running
+     */
+    bool getFileOperationStatus(FileOpStatus& status) const { return m_operations.getStatus(status); }
+
+    /**
+     * @brief Open a file handle
+     * @param path File path
+     * @param mode Open mode
+     * @return Handle, or INVALID_FILE_HANDLE on error or when
+     *         OS_MAX_FILES_OPEN handles are already open
+     */
+    FileHandle openFile(const char* path, FileOpenMode mode);
+
+    /**
+     * @brief Close a file handle
+     * @param handle Handle from openFile()
+     * @return OS_OK on success, OS_ERROR_BUSY while async requests on it
+     *         are queued, error code on failure
+     */
+    os_error_t closeFile(FileHandle handle);
+
+    /**
+     * @brief Read from the current position
+     * @param handle Open handle
+     * @param buffer Destination
+     * @param size Bytes to read
+     * @return Bytes read (0 at end of file) or -1 on error
+     */
+    int read(FileHandle handle, void* buffer, size_t size);
+
+    /**
+     * @brief Write at the current position
+     * @param handle Open handle
+     * @param data Source
+     * @param size Bytes to write
+     * @return Bytes written or -1 on error
+     */
+    int write(FileHandle handle, const void* data, size_t size);
+
+    /**
+     * @brief Move the file position
+     * @param handle Open handle
+     * @param offset Offset relative to origin
+     * @param origin Seek origin
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t seek(FileHandle handle, int64_t offset, FileSeekOrigin origin = FileSeekOrigin::BEGIN);
+
+    /**
+     * @brief Get the file position
+     * @param handle Open handle
+     * @return Position in bytes or -1 on error
+     */
+    int64_t tell(FileHandle handle);
+
+    /**
+     * @brief Get the size of an open file
+     * @param handle Open handle
+     * @return Size in bytes or -1 on error
+     */
+    int64_t getFileSize(FileHandle handle);
+
+    /**
+     * @brief Flush a handle's buffered writes to the medium
+     * @param handle Open handle
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t flush(FileHandle handle);
+
+    /**
+     * @brief Queue a read for the storage task
+     *
+     * The buffer must stay valid until the callback runs. Requests on one
+     * handle complete in order. A request's seek and transfer hold the
+     * handle's lock together, so synchronous calls on the handle are safe
+     * meanwhile; with offset -1 the request uses whatever position they
+     * leave.
+     * @param handle Open handle
+     * @param buffer Destination
+     * @param size Bytes to read
+     * @param offset File offset, or -1 for the current position
+     * @param callback Completion, invoked from update() on the main loop
+     * @return Request ID or 0 on failure
+     */
+    uint32_t readAsync(FileHandle handle, void* buffer, size_t size, int64_t offset,
+                       StorageCallback callback);
+
+    /**
+     * @brief Queue a write for the storage task
+     * @param handle Open handle
+     * @param data Source (must stay valid until the callback runs)
+     * @param size Bytes to write
+     * @param offset File offset, or -1 for the current position
+     * @param callback Completion, invoked from update() on the main loop
+     * @return Request ID or 0 on failure
+     */
+    uint32_t writeAsync(FileHandle handle, const void* data, size_t size, int64_t offset,
+                        StorageCallback callback);
+
+    /**
+     * @brief Get number of open handles
+     * @return Open handle count
+     */
+    size_t getOpenFileCount() const;
 
     /**
      * @brief Get free space on storage
@@ -195,10 +496,30 @@ public:
 
     /**
      * @brief Sync all pending writes to storage
+     *
+     * Writes back the append cache, then flushes every open handle.
      * @return OS_OK on success, error code on failure
      */
     os_error_t sync();
 
+    /**
+     * @brief Get write-back cache statistics
+     * @return Cache statistics
+     */
+    WriteCacheStats getCacheStats() const { return m_cache.getStats(); }
+
+    /**
+     * @brief Get directory cache statistics
+     * @return Cache statistics
+     */
+    DirCacheStats getDirCacheStats() const { return m_dirCache.getStats(); }
+
+    /**
+     * @brief Get the memory-mapped asset pack
+     * @return Asset pack (check isMounted())
+     */
+    const AssetPack& getAssets() const { return m_assets; }
+
     /**
      * @brief Print storage statistics
      */
@@ -229,16 +550,114 @@ private:
      */
     void updateStorageStats();
 
+    /**
+     * @brief Prepare caches for a copy and queue it, or run it when blocking
+     */
+    CopyJobId startCopy(const char* sourcePath, const char* destPath, bool move,
+                        CopyProgressCallback progress, CopyCompleteCallback complete);
+    os_error_t runCopy(const char* sourcePath, const char* destPath, bool move, CopyControl* control);
+
+    /**
+     * @brief Update caches after a copy or move changed the tree
+     */
+    void noteCopied(const std::string& sourcePath, const std::string& destPath, bool move);
+
+    struct OpenFile {
+        FILE* file = nullptr;
+        uint16_t generation = 0;
+        uint16_t pending = 0;       // Queued async requests
+        SemaphoreHandle_t lock = nullptr;   // Serializes use of the stream
+    };
+
+    struct AsyncRequest {
+        uint32_t id;
+        bool write;
+        FileHandle handle;
+        void* buffer;
+        size_t size;
+        int64_t offset;
+        StorageCallback callback;
+    };
+
+    struct AsyncCompletion {
+        StorageCallback callback;
+        os_error_t result;
+        size_t bytes;
+    };
+
+    /**
+     * @brief Resolve a handle to its stream
+     * @param handle Handle to check
+     * @return Stream or nullptr if the handle is stale or invalid
+     */
+    FILE* lookup(FileHandle handle) const;
+
+    /**
+     * @brief Take a handle's lock and resolve it to its stream
+     * @param handle Handle to use
+     * @return Stream with the lock held, or nullptr (lock not held) if the
+     *         handle is stale or invalid
+     */
+    FILE* acquire(FileHandle handle);
+
+    /**
+     * @brief Give back the lock taken by a successful acquire()
+     */
+    void release(FileHandle handle);
+
+    int readStream(FILE* file, void* buffer, size_t size);
+    int writeStream(FILE* file, const void* data, size_t size);
+
+    uint32_t queueRequest(AsyncRequest request);
+
+    /**
+     * @brief Run one async request on the storage task
+     */
+    void executeRequest(AsyncRequest& request);
+
+    /**
+     * @brief Run completion callbacks of finished requests (main loop)
+     */
+    void dispatchCompletions();
+
+    static void storageTask(void* arg);
+
+    os_error_t startStorageTask();
+    void stopStorageTask();
+
     // Storage status
     std::vector<HALStorageInfo> m_storageDevices;
     bool m_initialized = false;
 
+    // Write-back cache; mutable so const queries can flush a path first
+    mutable WriteBackCache m_cache;
+    mutable DirectoryCache m_dirCache;
+    FileCopier m_copier;
+    FileOperationQueue m_operations;
+    AssetPack m_assets;
+    ListenerId m_shutdownListener = 0;
+
+    // Open handles; m_fileLock guards the table, each slot's lock its stream
+    OpenFile m_files[OS_MAX_FILES_OPEN];
+    SemaphoreHandle_t m_fileLock = nullptr;
+
+    // Async I/O queue serviced by the storage task
+    TaskHandle_t m_storageTask = nullptr;
+    volatile bool m_taskRunning = false;
+    SemaphoreHandle_t m_queueLock = nullptr;
+    std::deque<AsyncRequest> m_requests;
+    std::vector<AsyncCompletion> m_completions;
+    uint32_t m_nextRequestId = 0;
+
     // Statistics
     uint32_t m_totalReads = 0;
     uint32_t m_totalWrites = 0;
     uint64_t m_bytesRead = 0;
     uint64_t m_bytesWritten = 0;
     uint32_t m_lastStatsUpdate = 0;
+    uint32_t m_handleOpens = 0;
+    uint32_t m_asyncRequests = 0;
+    uint32_t m_asyncErrors = 0;
 };
 
 #endif // STORAGE_HAL_H
\ No newline at end of file
@@ -2,7 +2,11 @@
 #include "../system/os_manager.h"
 #include <esp_log.h>
 #include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 static const char* TAG = "TouchHAL";
 
@@ -28,16 +32,36 @@ os_error_t TouchHAL::initialize() {
         return result;
     }
 
-    // Reserve space for touch points
-    m_currentTouches.reserve(10); // GT911 supports up to 10 points
-    m_previousTouches.reserve(10);
+    // The INT line wakes a tickless main loop when the panel is touched
+    gpio_config_t intConfig = {};
+    intConfig.pin_bit_mask = 1ULL << GT911_INT_PIN;
+    intConfig.mode = GPIO_MODE_INPUT;
+    intConfig.pull_up_en = GPIO_PULLUP_ENABLE;
+    intConfig.intr_type = GPIO_INTR_NEGEDGE;
+    esp_err_t ret = gpio_config(&intConfig);
+    if (ret == ESP_OK) {
+        ret = gpio_install_isr_service(0);
+    }
+    if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE) {
+        ret = gpio_isr_handler_add(GT911_INT_PIN, touchInterruptISR, this);
+    }
+    m_irqAttached = (ret == ESP_OK);
+    if (!m_irqAttached) {
+        ESP_LOGW(TAG, "Touch INT unavailable, falling back to polling: %s", esp_err_to_name(ret));
+    }
 
     // Enable touch and set default sensitivity
     setEnabled(true);
     setSensitivity(128);
 
     m_initialized = true;
-    ESP_LOGI(TAG, "Touch HAL initialized successfully");
+
+    if (m_irqAttached && startAcquisition() != OS_OK) {
+        ESP_LOGW(TAG, "Touch acquisition task unavailable, polling from the main loop");
+    }
+
+    ESP_LOGI(TAG, "Touch HAL initialized successfully (%s)",
+             isInterruptDriven() ? "interrupt driven" : "polled");
 
     return OS_OK;
 }
@@ -52,9 +76,15 @@ os_error_t TouchHAL::shutdown() {
     // Disable touch
     setEnabled(false);
 
+    if (m_irqAttached) {
+        gpio_isr_handler_remove(GT911_INT_PIN);
+        m_irqAttached = false;
+    }
+    stopAcquisition();
+    m_reports.reset();
+
     // Clear touch data
-    m_currentTouches.clear();
-    m_previousTouches.clear();
+    clearTouches();
     m_touchCallback = nullptr;
 
     m_initialized = false;
@@ -68,19 +98,167 @@ os_error_t TouchHAL::update(uint32_t deltaTime) {
         return OS_OK;
     }
 
-    // Read touch data from controller
-    os_error_t result = readTouchData();
+    // Long press fires while the finger is still, between reports
+    if (m_gestureEnabled) {
+        TouchEventData gestures[GestureRecognizer::MAX_EVENTS];
+        sendGestureEvents(gestures, m_gestures.poll(millis(), gestures));
+    }
+
+    if (isInterruptDriven()) {
+        // The acquisition task already did the I2C work; just consume
+        TouchReport report;
+        while (m_reports.pop(report)) {
+            m_drainLatency.add((uint32_t)(esp_timer_get_time() - report.irqUs));
+            applyReport(report);
+        }
+        return OS_OK;
+    }
+
+    // Polled: read the controller on the main loop
+    TouchReport report;
+    report.irqUs = m_irqPending ? m_irqTimeUs : esp_timer_get_time();
+    m_irqPending = false;
+
+    os_error_t result = readReport(report);
+    if (result == OS_ERROR_NOT_FOUND) {
+        return OS_OK;
+    }
     if (result != OS_OK) {
         return result;
     }
 
+    m_drainLatency.add((uint32_t)(esp_timer_get_time() - report.irqUs));
+    applyReport(report);
+    return OS_OK;
+}
+
+void TouchHAL::applyReport(const TouchReport& report) {
+    // The old current set becomes previous; no copy of the previous set
+    m_current ^= 1;
+    memcpy(m_touches[m_current], report.points, report.count * sizeof(TouchPoint));
+    m_touchCount[m_current] = report.count;
+    m_reportTimeUs = (uint32_t)report.irqUs;
+
     // Filter and process touch points
     filterTouchPoints();
     processTouchEvents();
 
+    m_indevPendingIrqUs = report.irqUs;
+}
+
+void TouchHAL::onIndevRead() {
+    if (m_indevPendingIrqUs == 0) {
+        return;
+    }
+    m_indevLatency.add((uint32_t)(esp_timer_get_time() - m_indevPendingIrqUs));
+    m_indevPendingIrqUs = 0;
+}
+
+uint32_t TouchHAL::getTimeUntilNextPoll() const {
+    if (!m_initialized || !m_enabled) {
+        return UINT32_MAX;
+    }
+
+    if (m_irqPending || !m_reports.empty()) {
+        return 0;
+    }
+
+    uint32_t gestureDeadline = m_gestureEnabled ? m_gestures.getTimeUntilDeadline(millis())
+                                                : UINT32_MAX;
+
+    // The acquisition task wakes the loop whenever it queues a report
+    if (isInterruptDriven()) {
+        return gestureDeadline;
+    }
+
+    // Keep polling while touched, and always when there is no INT line
+    if (!m_irqAttached || getActiveTouchCount() > 0 || m_gestures.isActive()) {
+        return std::min<uint32_t>(OS_TOUCH_POLL_MS, gestureDeadline);
+    }
+
+    return gestureDeadline;
+}
+
+void IRAM_ATTR TouchHAL::touchInterruptISR(void* arg) {
+    TouchHAL* touch = static_cast<TouchHAL*>(arg);
+    touch->m_irqTimeUs = esp_timer_get_time();
+
+    if (touch->m_acquisitionTask) {
+        BaseType_t higherPriorityWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(touch->m_acquisitionTask, &higherPriorityWoken);
+        portYIELD_FROM_ISR(higherPriorityWoken);
+        return;
+    }
+
+    touch->m_irqPending = true;
+    OS().wakeFromISR();
+}
+
+os_error_t TouchHAL::startAcquisition() {
+    m_reports.reset();
+    m_acquisitionRunning = true;
+
+    if (xTaskCreatePinnedToCore(acquisitionTask, "os_touch", OS_TOUCH_TASK_STACK, this,
+                                OS_TOUCH_TASK_PRIORITY, &m_acquisitionTask,
+                                OS_TOUCH_TASK_CORE) != pdPASS) {
+        m_acquisitionRunning = false;
+        m_acquisitionTask = nullptr;
+        return OS_ERROR_NO_MEMORY;
+    }
     return OS_OK;
 }
 
+void TouchHAL::stopAcquisition() {
+    if (!m_acquisitionTask) {
+        return;
+    }
+
+    m_acquisitionRunning = false;
+    TaskHandle_t task = m_acquisitionTask;
+    xTaskNotifyGive(task);
+
+    // The task clears its handle on exit; an I2C read may be in flight
+    for (int attempt = 0; attempt < 20 && m_acquisitionTask; attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    if (m_acquisitionTask) {
+        ESP_LOGW(TAG, "Touch acquisition task did not exit, deleting");
+        vTaskDelete(task);
+        m_acquisitionTask = nullptr;
+    }
+}
+
+void TouchHAL::acquisitionTask(void* arg) {
+    TouchHAL* touch = static_cast<TouchHAL*>(arg);
+
+    while (touch->m_acquisitionRunning) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!touch->m_acquisitionRunning) {
+            break;
+        }
+        if (!touch->m_enabled) {
+            continue;
+        }
+
+        TouchReport report;
+        report.irqUs = touch->m_irqTimeUs;
+        os_error_t result = touch->readReport(report);
+        if (result != OS_OK) {
+            continue;
+        }
+
+        // Each report is a full snapshot, so a dropped one only loses a
+        // sample; the next report still carries every active point
+        if (!touch->m_reports.push(report)) {
+            touch->m_reportsDropped++;
+        }
+        OS().wake();
+    }
+
+    touch->m_acquisitionTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
 bool TouchHAL::selfTest() {
     if (!m_initialized) {
         return false;
@@ -120,7 +298,7 @@ os_error_t TouchHAL::setEnabled(bool enabled) {
         ESP_LOGI(TAG, "Touch input disabled");
         // TODO: Disable GT911 touch detection
         // Clear current touches
-        m_currentTouches.clear();
+        clearTouches();
     }
 
     return OS_OK;
@@ -159,16 +337,6 @@ os_error_t TouchHAL::calibrate() {
     return OS_OK;
 }
 
-size_t TouchHAL::getActiveTouchCount() const {
-    size_t count = 0;
-    for (const auto& touch : m_currentTouches) {
-        if (touch.valid) {
-            count++;
-        }
-    }
-    return count;
-}
-
 os_error_t TouchHAL::setSensitivity(uint8_t sensitivity) {
     if (!m_initialized) {
         return OS_ERROR_GENERIC;
@@ -191,6 +359,13 @@ void TouchHAL::printStats() const {
     ESP_LOGI(TAG, "Active touches: %d", getActiveTouchCount());
     ESP_LOGI(TAG, "Total touches: %d", m_totalTouches);
     ESP_LOGI(TAG, "Total gestures: %d", m_totalGestures);
+    ESP_LOGI(TAG, "Acquisition: %s, reports %d, dropped %d, read errors %d",
+             isInterruptDriven() ? "interrupt" : "polled",
+             m_reportsRead, m_reportsDropped, m_readErrors);
+    ESP_LOGI(TAG, "Latency from INT (avg/max us): read %d/%d, drain %d/%d, indev %d/%d",
+             m_readLatency.averageUs(), m_readLatency.maxUs,
+             m_drainLatency.averageUs(), m_drainLatency.maxUs,
+             m_indevLatency.averageUs(), m_indevLatency.maxUs);
     ESP_LOGI(TAG, "Last calibration: %d ms ago", 
              m_lastCalibration > 0 ? millis() - m_lastCalibration : 0);
 }
@@ -207,35 +382,87 @@ os_error_t TouchHAL::initializeController() {
     return OS_OK;
 }
 
-os_error_t TouchHAL::readTouchData() {
-    // Store previous touches
-    m_previousTouches = m_currentTouches;
-    m_currentTouches.clear();
+bool TouchHAL::readRegisters(uint16_t reg, uint8_t* data, size_t length) {
+    Wire.beginTransmission(GT911_I2C_ADDR);
+    Wire.write((uint8_t)(reg >> 8));
+    Wire.write((uint8_t)(reg & 0xFF));
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (Wire.requestFrom((uint8_t)GT911_I2C_ADDR, (uint8_t)length) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        data[i] = Wire.read();
+    }
+    return true;
+}
+
+bool TouchHAL::writeRegister(uint16_t reg, uint8_t value) {
+    Wire.beginTransmission(GT911_I2C_ADDR);
+    Wire.write((uint8_t)(reg >> 8));
+    Wire.write((uint8_t)(reg & 0xFF));
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+os_error_t TouchHAL::readReport(TouchReport& report) {
+    // Status: bit 7 = buffer ready, bits 0-3 = number of points
+    uint8_t status = 0;
+    if (!readRegisters(GT911_REG_STATUS, &status, 1)) {
+        m_readErrors++;
+        return OS_ERROR_HARDWARE;
+    }
+    if (!(status & 0x80)) {
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    report.count = std::min<uint8_t>(status & 0x0F, GT911_MAX_POINTS);
 
-    // TODO: Implement actual GT911 touch data reading
-    // This is a simplified simulation for now
+    // 8 bytes per point: track id, x, y, size (little endian), reserved
+    uint8_t raw[GT911_MAX_POINTS * 8];
+    bool ok = report.count == 0 || readRegisters(GT911_REG_TOUCH, raw, report.count * 8);
 
-    // Read status register to check for touch data
-    // Read number of touch points
-    // Read each touch point data (x, y, pressure, id)
+    // Acknowledge so the controller can latch the next report
+    writeRegister(GT911_REG_STATUS, 0);
+    if (!ok) {
+        m_readErrors++;
+        return OS_ERROR_HARDWARE;
+    }
 
-    // For simulation, we'll just maintain empty touch data
-    // In real implementation, this would read from GT911 registers
+    report.readUs = esp_timer_get_time();
+    for (uint8_t i = 0; i < report.count; i++) {
+        const uint8_t* p = &raw[i * 8];
+        TouchPoint& point = report.points[i];
+        point.id = p[0];
+        point.x = p[1] | (p[2] << 8);
+        point.y = p[3] | (p[4] << 8);
+        point.pressure = (uint8_t)std::min<uint16_t>(p[5] | (p[6] << 8), 255);
+        point.valid = true;
+        point.timestamp = (uint32_t)report.irqUs;
+    }
 
+    m_reportsRead++;
+    m_readLatency.add((uint32_t)(report.readUs - report.irqUs));
     return OS_OK;
 }
 
 void TouchHAL::processTouchEvents() {
     uint32_t currentTime = millis();
+    const TouchPoint* current = m_touches[m_current];
+    const TouchPoint* previous = m_touches[m_current ^ 1];
+    uint8_t currentCount = m_touchCount[m_current];
+    uint8_t previousCount = m_touchCount[m_current ^ 1];
 
     // Process each current touch point
-    for (const auto& currentTouch : m_currentTouches) {
-        if (!currentTouch.valid) continue;
+    for (uint8_t i = 0; i < currentCount; i++) {
+        const TouchPoint& currentTouch = current[i];
 
         // Find corresponding previous touch
         bool foundPrevious = false;
-        for (const auto& prevTouch : m_previousTouches) {
-            if (prevTouch.id == currentTouch.id && prevTouch.valid) {
+        for (uint8_t j = 0; j < previousCount; j++) {
+            const TouchPoint& prevTouch = previous[j];
+            if (prevTouch.id == currentTouch.id) {
                 // Touch moved
                 if (abs(currentTouch.x - prevTouch.x) > OS_TOUCH_THRESHOLD ||
                     abs(currentTouch.y - prevTouch.y) > OS_TOUCH_THRESHOLD) {
@@ -260,17 +487,16 @@ void TouchHAL::processTouchEvents() {
             sendTouchEvent(eventData);
 
             m_totalTouches++;
-            m_lastTouchTime = currentTime;
         }
     }
 
     // Check for released touches
-    for (const auto& prevTouch : m_previousTouches) {
-        if (!prevTouch.valid) continue;
+    for (uint8_t j = 0; j < previousCount; j++) {
+        const TouchPoint& prevTouch = previous[j];
 
         bool stillActive = false;
-        for (const auto& currentTouch : m_currentTouches) {
-            if (currentTouch.id == prevTouch.id && currentTouch.valid) {
+        for (uint8_t i = 0; i < currentCount; i++) {
+            if (current[i].id == prevTouch.id) {
                 stillActive = true;
                 break;
             }
@@ -281,82 +507,84 @@ void TouchHAL::processTouchEvents() {
             TouchEventData eventData;
             eventData.event = TouchEvent::RELEASE;
             eventData.point = prevTouch;
+            eventData.point.timestamp = m_reportTimeUs;   // The report that saw the lift
             eventData.timestamp = currentTime;
             sendTouchEvent(eventData);
         }
     }
 
-    // Detect gestures if enabled
+    // Advance the gesture recognizer on every sample
     if (m_gestureEnabled) {
-        GestureType gesture = detectGesture();
-        if (gesture != GestureType::NONE) {
-            TouchEventData eventData;
-            eventData.event = TouchEvent::GESTURE;
-            eventData.gesture = gesture;
-            eventData.timestamp = currentTime;
-            sendTouchEvent(eventData);
-
-            m_totalGestures++;
-        }
+        TouchEventData gestures[GestureRecognizer::MAX_EVENTS];
+        sendGestureEvents(gestures, m_gestures.update(current, currentCount, currentTime, gestures));
     }
 }
 
-GestureType TouchHAL::detectGesture() {
-    // Simple gesture detection implementation
-    // In a real implementation, this would be much more sophisticated
-
-    uint32_t currentTime = millis();
-    size_t activeTouches = getActiveTouchCount();
-
-    if (activeTouches == 0) {
-        // No active touches, check if we just finished a gesture
-        if (m_inGesture && currentTime - m_lastTouchTime > OS_TOUCH_DEBOUNCE_MS) {
-            m_inGesture = false;
-            
-            uint32_t gestureDuration = currentTime - m_gestureStartTime;
-            
-            // Simple tap detection
-            if (gestureDuration < 200) {
-                return GestureType::TAP;
-            }
-            // Long press detection
-            else if (gestureDuration > 1000) {
-                return GestureType::LONG_PRESS;
-            }
-        }
-    } else if (activeTouches == 1 && !m_inGesture) {
-        // Start of potential gesture
-        m_inGesture = true;
-        m_gestureStartTime = currentTime;
-        if (!m_currentTouches.empty() && m_currentTouches[0].valid) {
-            m_gestureStartPoint = m_currentTouches[0];
+void TouchHAL::sendGestureEvents(const TouchEventData* events, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (events[i].phase == GesturePhase::BEGIN) {
+            m_totalGestures++;
         }
+        sendTouchEvent(events[i]);
     }
-
-    return GestureType::NONE;
 }
 
 void TouchHAL::filterTouchPoints() {
-    // Simple filtering to remove noise and apply smoothing
-    // In a real implementation, this would be more sophisticated
+    TouchPoint* touches = m_touches[m_current];
+    uint8_t count = m_touchCount[m_current];
+    bool matched[GT911_MAX_POINTS] = {};
 
-    for (auto& touch : m_currentTouches) {
-        if (!touch.valid) continue;
+    for (uint8_t i = 0; i < count; i++) {
+        TouchPoint& touch = touches[i];
 
         // Basic bounds checking
         if (touch.x >= OS_SCREEN_WIDTH) touch.x = OS_SCREEN_WIDTH - 1;
         if (touch.y >= OS_SCREEN_HEIGHT) touch.y = OS_SCREEN_HEIGHT - 1;
 
-        // Simple smoothing with previous touch if available
-        for (const auto& prevTouch : m_previousTouches) {
-            if (prevTouch.id == touch.id && prevTouch.valid) {
-                // Apply simple low-pass filter
-                touch.x = (touch.x + prevTouch.x) / 2;
-                touch.y = (touch.y + prevTouch.y) / 2;
-                break;
+        // Continue this track's filter, or start one in a free slot
+        // (at most five tracks, so these scans are constant time)
+        TrackFilter* track = nullptr;
+        for (uint8_t f = 0; f < GT911_MAX_POINTS && !track; f++) {
+            if (m_filters[f].active && m_filters[f].id == touch.id) {
+                track = &m_filters[f];
+                matched[f] = true;
             }
         }
+        for (uint8_t f = 0; f < GT911_MAX_POINTS && !track; f++) {
+            if (!m_filters[f].active && !matched[f]) {
+                track = &m_filters[f];
+                matched[f] = true;
+                track->id = touch.id;
+                track->active = true;
+                track->x.reset();
+                track->y.reset();
+            }
+        }
+        if (!track) {
+            continue;
+        }
+
+        float dt = (touch.timestamp - track->lastTimestamp) / 1000000.0f;
+        track->lastTimestamp = touch.timestamp;
+        touch.x = (uint16_t)lroundf(track->x.filter(touch.x, dt));
+        touch.y = (uint16_t)lroundf(track->y.filter(touch.y, dt));
+    }
+
+    // Lifted fingers end their tracks
+    for (uint8_t f = 0; f < GT911_MAX_POINTS; f++) {
+        if (!matched[f]) {
+            m_filters[f].active = false;
+        }
+    }
+}
+
+void TouchHAL::clearTouches() {
+    m_touchCount[0] = 0;
+    m_touchCount[1] = 0;
+    for (auto& track : m_filters) {
+        track.active = false;
     }
+    m_gestures.reset();
 }
 
 void TouchHAL::sendTouchEvent(const TouchEventData& eventData) {
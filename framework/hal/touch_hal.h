@@ -2,7 +2,12 @@
 #define TOUCH_HAL_H
 
 #include "../system/os_config.h"
-#include <vector>
+#include "../system/event_ring.h"
+#include "touch_types.h"
+#include "gesture_recognizer.h"
+#include "one_euro_filter.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /**
  * @file touch_hal.h
@@ -10,53 +15,40 @@
  * 
  * Manages the GT911 touch controller with multi-touch support
  * and gesture recognition capabilities.
+ *
+ * When the INT line is wired, a high-priority acquisition task reads each
+ * GT911 report as soon as the controller signals it and queues it with its
+ * interrupt timestamp; update() only drains that queue, so neither the I2C
+ * transfer nor the main-loop frame time sits between the finger and the
+ * sample. Without INT the controller is polled from update().
+ *
+ * Touch sets live in two fixed arrays sized to the controller's five
+ * points and swapped by index per report, so the sample path does no heap
+ * allocation; each point is smoothed by a per-track One-Euro filter.
  */
 
-struct TouchPoint {
-    uint16_t x;
-    uint16_t y;
-    uint8_t pressure;
-    uint8_t id;
-    bool valid;
-    uint32_t timestamp;
-    
-    TouchPoint() : x(0), y(0), pressure(0), id(0), valid(false), timestamp(0) {}
-};
-
-enum class TouchEvent {
-    PRESS,
-    RELEASE,
-    MOVE,
-    GESTURE
-};
-
-enum class GestureType {
-    NONE,
-    TAP,
-    DOUBLE_TAP,
-    LONG_PRESS,
-    SWIPE_UP,
-    SWIPE_DOWN,
-    SWIPE_LEFT,
-    SWIPE_RIGHT,
-    PINCH_IN,
-    PINCH_OUT,
-    ROTATE
-};
+typedef std::function<void(const TouchEventData&)> TouchCallback;
 
-struct TouchEventData {
-    TouchEvent event;
-    TouchPoint point;
-    GestureType gesture;
-    uint32_t timestamp;
-    
-    TouchEventData() : event(TouchEvent::PRESS), gesture(GestureType::NONE), timestamp(0) {}
+/**
+ * @brief Latency accumulator in microseconds
+ */
+struct TouchLatencyStats {
+    uint32_t samples = 0;
+    uint64_t totalUs = 0;
+    uint32_t maxUs = 0;
+
+    void add(uint32_t us) {
+        samples++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+    uint32_t averageUs() const { return samples ? (uint32_t)(totalUs / samples) : 0; }
 };
 
-typedef std::function<void(const TouchEventData&)> TouchCallback;
-
 class TouchHAL {
 public:
+    static const uint8_t GT911_MAX_POINTS = 5;
+
     TouchHAL() = default;
     ~TouchHAL();
 
@@ -119,15 +111,15 @@ public:
 
     /**
      * @brief Get current touch points
-     * @return Vector of active touch points
+     * @return Array of getActiveTouchCount() filtered points
      */
-    const std::vector<TouchPoint>& getCurrentTouches() const { return m_currentTouches; }
+    const TouchPoint* getCurrentTouches() const { return m_touches[m_current]; }
 
     /**
      * @brief Get number of active touches
      * @return Number of active touch points
      */
-    size_t getActiveTouchCount() const;
+    size_t getActiveTouchCount() const { return m_touchCount[m_current]; }
 
     /**
      * @brief Set touch sensitivity
@@ -146,7 +138,7 @@ public:
      * @brief Enable/disable gesture recognition
      * @param enabled True to enable gestures, false to disable
      */
-    void setGestureEnabled(bool enabled) { m_gestureEnabled = enabled; }
+    void setGestureEnabled(bool enabled) { m_gestureEnabled = enabled; m_gestures.reset(); }
 
     /**
      * @brief Check if gesture recognition is enabled
@@ -154,6 +146,33 @@ public:
      */
     bool isGestureEnabled() const { return m_gestureEnabled; }
 
+    /**
+     * @brief Get time until the controller should next be polled
+     * @return 0 if an interrupt is pending, OS_TOUCH_POLL_MS while touched,
+     *         UINT32_MAX when idle (the INT line wakes the main loop)
+     */
+    uint32_t getTimeUntilNextPoll() const;
+
+    /**
+     * @brief Record that the LVGL input device has read the latest sample
+     *
+     * Called from the indev read callback; closes the interrupt-to-indev
+     * latency measurement for the most recently drained report.
+     */
+    void onIndevRead();
+
+    /**
+     * @brief Check if reports are acquired by the INT-driven task
+     * @return true if interrupt driven, false if polled from update()
+     */
+    bool isInterruptDriven() const { return m_acquisitionTask != nullptr; }
+
+    /**
+     * @brief Get interrupt-to-LVGL-indev latency
+     * @return Latency accumulator
+     */
+    const TouchLatencyStats& getIndevLatency() const { return m_indevLatency; }
+
     /**
      * @brief Get touch statistics
      */
@@ -167,10 +186,48 @@ private:
     os_error_t initializeController();
 
     /**
-     * @brief Read touch data from controller
+     * @brief One GT911 report as queued by the acquisition task
+     */
+    struct TouchReport {
+        int64_t irqUs;          // INT edge (or poll start when polled)
+        int64_t readUs;         // I2C read complete
+        uint8_t count;
+        TouchPoint points[GT911_MAX_POINTS];
+    };
+
+    /**
+     * @brief Read one report from the controller and acknowledge it
+     * @param report Output report (irqUs must already be set)
+     * @return OS_OK if a report was read, OS_ERROR_NOT_FOUND if none was
+     *         ready, error code on I2C failure
+     */
+    os_error_t readReport(TouchReport& report);
+
+    /**
+     * @brief Make a report the current touch set and generate events
+     * @param report Report to apply
+     */
+    void applyReport(const TouchReport& report);
+
+    /**
+     * @brief Start the INT-driven acquisition task
      * @return OS_OK on success, error code on failure
      */
-    os_error_t readTouchData();
+    os_error_t startAcquisition();
+
+    /**
+     * @brief Stop the acquisition task
+     */
+    void stopAcquisition();
+
+    /**
+     * @brief Acquisition task body: wait for INT, read, queue
+     * @param arg TouchHAL instance
+     */
+    static void acquisitionTask(void* arg);
+
+    bool readRegisters(uint16_t reg, uint8_t* data, size_t length);
+    bool writeRegister(uint16_t reg, uint8_t value);
 
     /**
      * @brief Process touch events and detect gestures
@@ -178,16 +235,29 @@ private:
     void processTouchEvents();
 
     /**
-     * @brief Detect gestures from touch data
-     * @return Detected gesture type
+     * @brief Publish gesture events produced by the recognizer
+     * @param events Events to send
+     * @param count Number of events
      */
-    GestureType detectGesture();
+    void sendGestureEvents(const TouchEventData* events, uint8_t count);
 
     /**
-     * @brief Filter touch points (debouncing, smoothing)
+     * @brief Clamp and smooth the current touch points in place
      */
     void filterTouchPoints();
 
+    /**
+     * @brief Drop the current touch set and filter history
+     */
+    void clearTouches();
+
+    /**
+     * @brief GT911 INT line handler; wakes the acquisition task, or the
+     *        main loop when polling
+     * @param arg TouchHAL instance
+     */
+    static void touchInterruptISR(void* arg);
+
     /**
      * @brief Send touch event via callback
      * @param eventData Touch event data to send
@@ -201,21 +271,47 @@ private:
     uint8_t m_sensitivity = 128;
     bool m_gestureEnabled = true;
 
-    // Touch data
-    std::vector<TouchPoint> m_currentTouches;
-    std::vector<TouchPoint> m_previousTouches;
+    // Touch data: current and previous sets, swapped by index per report
+    TouchPoint m_touches[2][GT911_MAX_POINTS];
+    uint8_t m_touchCount[2] = {};
+    uint8_t m_current = 0;
     TouchCallback m_touchCallback;
 
+    // One-Euro smoothing state per GT911 track id
+    struct TrackFilter {
+        uint8_t id = 0;
+        bool active = false;
+        uint32_t lastTimestamp = 0;
+        OneEuroFilter x{OS_TOUCH_FILTER_MIN_CUTOFF, OS_TOUCH_FILTER_BETA, OS_TOUCH_FILTER_D_CUTOFF};
+        OneEuroFilter y{OS_TOUCH_FILTER_MIN_CUTOFF, OS_TOUCH_FILTER_BETA, OS_TOUCH_FILTER_D_CUTOFF};
+    };
+    TrackFilter m_filters[GT911_MAX_POINTS];
+
     // Gesture detection
-    uint32_t m_lastTouchTime = 0;
-    uint32_t m_gestureStartTime = 0;
-    TouchPoint m_gestureStartPoint;
-    bool m_inGesture = false;
+    GestureRecognizer m_gestures;
+
+    // Set from the INT line ISR, cleared once the controller is read
+    volatile bool m_irqPending = false;
+    volatile int64_t m_irqTimeUs = 0;
+    bool m_irqAttached = false;
+
+    // INT-driven acquisition
+    TaskHandle_t m_acquisitionTask = nullptr;
+    volatile bool m_acquisitionRunning = false;
+    EventRing<TouchReport, OS_TOUCH_RING_SIZE> m_reports;
+    int64_t m_indevPendingIrqUs = 0;    // Drained but not yet read by LVGL
+    uint32_t m_reportTimeUs = 0;        // INT time of the report being applied
 
     // Statistics
     uint32_t m_totalTouches = 0;
     uint32_t m_totalGestures = 0;
     uint32_t m_lastCalibration = 0;
+    uint32_t m_reportsRead = 0;
+    uint32_t m_reportsDropped = 0;
+    uint32_t m_readErrors = 0;
+    TouchLatencyStats m_readLatency;    // INT edge to I2C read complete
+    TouchLatencyStats m_drainLatency;   // INT edge to update() drain
+    TouchLatencyStats m_indevLatency;   // INT edge to LVGL indev read
 
     // GT911 specific
     static const uint8_t GT911_I2C_ADDR = 0x5D;
@@ -0,0 +1,75 @@
+#ifndef TOUCH_TYPES_H
+#define TOUCH_TYPES_H
+
+#include "../system/os_config.h"
+
+/**
+ * @file touch_types.h
+ * @brief Touch sample and event types shared by TouchHAL and its gesture recognizer
+ */
+
+struct TouchPoint {
+    uint16_t x;
+    uint16_t y;
+    uint8_t pressure;
+    uint8_t id;
+    bool valid;
+    uint32_t timestamp;         // INT edge of the report, esp_timer microseconds (wraps)
+
+    TouchPoint() : x(0), y(0), pressure(0), id(0), valid(false), timestamp(0) {}
+};
+
+enum class TouchEvent : uint8_t {
+    PRESS,
+    RELEASE,
+    MOVE,
+    GESTURE
+};
+
+enum class GestureType : uint8_t {
+    NONE,
+    TAP,
+    DOUBLE_TAP,
+    LONG_PRESS,
+    SWIPE_UP,
+    SWIPE_DOWN,
+    SWIPE_LEFT,
+    SWIPE_RIGHT,
+    PINCH_IN,
+    PINCH_OUT,
+    ROTATE
+};
+
+/**
+ * @brief Where a gesture event sits in its gesture
+ *
+ * Discrete gestures (tap, double tap, long press) are a single BEGIN.
+ * Continuous ones (swipe, pinch, rotate) send BEGIN once recognized,
+ * UPDATE per sample while the fingers stay down, then END.
+ */
+enum class GesturePhase : uint8_t {
+    BEGIN,
+    UPDATE,
+    END
+};
+
+struct TouchEventData {
+    TouchEvent event;
+    GestureType gesture;
+    GesturePhase phase;
+    TouchPoint point;           // Touch point, or two-finger centroid for pinch/rotate
+    uint32_t timestamp;         // Event time in milliseconds
+    float scale;                // Finger span relative to gesture start (pinch/rotate)
+    float rotation;             // Degrees turned since gesture start, clockwise positive
+    int16_t velocityX;          // Pixels per second (swipe)
+    int16_t velocityY;
+
+    TouchEventData() : event(TouchEvent::PRESS), gesture(GestureType::NONE),
+                       phase(GesturePhase::BEGIN), timestamp(0), scale(1.0f),
+                       rotation(0.0f), velocityX(0), velocityY(0) {}
+};
+
+static_assert(sizeof(TouchEventData) <= OS_EVENT_INLINE_PAYLOAD,
+              "TouchEventData should travel inline in EventData");
+
+#endif // TOUCH_TYPES_H
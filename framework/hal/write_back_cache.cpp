@@ -0,0 +1,308 @@
+#include "write_back_cache.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <cstring>
+
+static const char* TAG = "WriteBackCache";
+
+static constexpr uint32_t SECTOR_SIZE = 512;
+
+WriteBackCache::~WriteBackCache() {
+    shutdown();
+}
+
+os_error_t WriteBackCache::initialize() {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    m_lock = xSemaphoreCreateMutex();
+    if (!m_lock) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    for (auto& block : m_blocks) {
+        block.data = (uint8_t*)OS_MALLOC_DMA(OS_STORAGE_CACHE_BLOCK_SIZE);
+        if (!block.data) {
+            shutdown();
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+    for (auto& stream : m_streams) {
+        stream.data = (uint8_t*)OS_MALLOC_DMA(OS_STORAGE_STREAM_BUFFER_SIZE);
+        if (!stream.data) {
+            shutdown();
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    m_initialized = true;
+    ESP_LOGI(TAG, "Write-back cache: %d x %d KB append blocks, %d x %d KB stream buffers",
+             OS_STORAGE_CACHE_BLOCKS, OS_STORAGE_CACHE_BLOCK_SIZE / 1024,
+             OS_STORAGE_STREAM_BUFFERS, OS_STORAGE_STREAM_BUFFER_SIZE / 1024);
+    return OS_OK;
+}
+
+void WriteBackCache::shutdown() {
+    if (m_initialized) {
+        flushAll();
+    }
+
+    for (auto& block : m_blocks) {
+        if (block.data) {
+            OS_FREE(block.data);
+            block.data = nullptr;
+        }
+        block.length = 0;
+        block.path.clear();
+    }
+    for (auto& stream : m_streams) {
+        // Streams still open keep using the buffer until fclose(); their
+        // owner (StorageHAL) closes them before shutting the cache down
+        if (stream.data) {
+            OS_FREE(stream.data);
+            stream.data = nullptr;
+        }
+        stream.owner = nullptr;
+    }
+    m_stats.streamBuffersInUse = 0;
+
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+    m_initialized = false;
+}
+
+bool WriteBackCache::append(const char* path, const void* data, size_t size) {
+    if (!m_initialized || !path) {
+        return false;
+    }
+
+    uint32_t now = millis();
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_stats.appends++;
+
+    AppendBlock* block = findBlock(path);
+    bool bypass = size > OS_STORAGE_CACHE_BLOCK_SIZE / 2;
+    if (block && (bypass || block->length + size > OS_STORAGE_CACHE_BLOCK_SIZE)) {
+        // Keep call order: what is cached goes out before the new data
+        writeBlock(*block);
+        block = nullptr;
+    }
+
+    if (bypass) {
+        m_stats.bypassed++;
+        xSemaphoreGive(m_lock);
+        return false;
+    }
+
+    if (!block) {
+        block = claimBlock(path, now);
+    }
+    if (block->length > 0) {
+        m_stats.absorbed++;
+    } else {
+        block->dirtySince = now;
+    }
+
+    memcpy(block->data + block->length, data, size);
+    block->length += size;
+    block->lastUse = now;
+    block->sectorsIfSeparate += sectorsFor(size);
+
+    xSemaphoreGive(m_lock);
+    return true;
+}
+
+os_error_t WriteBackCache::flushPath(const char* path) {
+    if (!m_initialized || !path) {
+        return OS_OK;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    AppendBlock* block = findBlock(path);
+    os_error_t result = block ? writeBlock(*block) : OS_OK;
+    xSemaphoreGive(m_lock);
+    return result;
+}
+
+os_error_t WriteBackCache::flushDirectory(const char* directory) {
+    if (!m_initialized || !directory) {
+        return OS_OK;
+    }
+
+    size_t length = strlen(directory);
+    os_error_t result = OS_OK;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& block : m_blocks) {
+        if (block.length > 0 && block.path.compare(0, length, directory) == 0 &&
+            block.path.size() > length && block.path[length] == '/') {
+            if (writeBlock(block) != OS_OK) {
+                result = OS_ERROR_FILESYSTEM;
+            }
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return result;
+}
+
+void WriteBackCache::discardPath(const char* path) {
+    if (!m_initialized || !path) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    AppendBlock* block = findBlock(path);
+    if (block) {
+        block->length = 0;
+        block->sectorsIfSeparate = 0;
+        block->path.clear();
+    }
+    xSemaphoreGive(m_lock);
+}
+
+os_error_t WriteBackCache::flushAll() {
+    if (!m_initialized) {
+        return OS_OK;
+    }
+
+    os_error_t result = OS_OK;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& block : m_blocks) {
+        if (block.length > 0 && writeBlock(block) != OS_OK) {
+            result = OS_ERROR_FILESYSTEM;
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return result;
+}
+
+void WriteBackCache::flushExpired(uint32_t now) {
+    if (!m_initialized) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& block : m_blocks) {
+        if (block.length > 0 && now - block.dirtySince >= OS_STORAGE_CACHE_FLUSH_MS) {
+            writeBlock(block);
+        }
+    }
+    xSemaphoreGive(m_lock);
+}
+
+bool WriteBackCache::attachStream(FILE* file) {
+    if (!m_initialized || !file) {
+        return false;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& stream : m_streams) {
+        if (!stream.owner) {
+            // Must precede the first I/O on the stream
+            if (setvbuf(file, (char*)stream.data, _IOFBF, OS_STORAGE_STREAM_BUFFER_SIZE) != 0) {
+                break;
+            }
+            stream.owner = file;
+            m_stats.streamBuffersInUse++;
+            xSemaphoreGive(m_lock);
+            return true;
+        }
+    }
+    xSemaphoreGive(m_lock);
+    return false;
+}
+
+void WriteBackCache::releaseStream(FILE* file) {
+    if (!m_initialized || !file) {
+        return;
+    }
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    for (auto& stream : m_streams) {
+        if (stream.owner == file) {
+            stream.owner = nullptr;
+            m_stats.streamBuffersInUse--;
+            break;
+        }
+    }
+    xSemaphoreGive(m_lock);
+}
+
+WriteCacheStats WriteBackCache::getStats() const {
+    return m_stats;
+}
+
+void WriteBackCache::printStats() const {
+    uint32_t hitRate = m_stats.appends ? m_stats.absorbed * 100 / m_stats.appends : 0;
+    ESP_LOGI(TAG, "Appends: %d (%d%% absorbed, %d written through), device writes: %d, evictions: %d",
+             m_stats.appends, hitRate, m_stats.bypassed, m_stats.flushes, m_stats.evictions);
+    ESP_LOGI(TAG, "Sector rewrites avoided: %llu bytes, stream buffers in use: %d/%d",
+             m_stats.bytesSaved, m_stats.streamBuffersInUse, OS_STORAGE_STREAM_BUFFERS);
+}
+
+WriteBackCache::AppendBlock* WriteBackCache::findBlock(const char* path) {
+    for (auto& block : m_blocks) {
+        if (block.length > 0 && block.path == path) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+WriteBackCache::AppendBlock* WriteBackCache::claimBlock(const char* path, uint32_t now) {
+    AppendBlock* victim = nullptr;
+    for (auto& block : m_blocks) {
+        if (block.length == 0) {
+            victim = &block;
+            break;
+        }
+        if (!victim || now - block.lastUse > now - victim->lastUse) {
+            victim = &block;
+        }
+    }
+
+    if (victim->length > 0) {
+        m_stats.evictions++;
+        writeBlock(*victim);
+    }
+    victim->path = path;
+    victim->length = 0;
+    victim->sectorsIfSeparate = 0;
+    return victim;
+}
+
+os_error_t WriteBackCache::writeBlock(AppendBlock& block) {
+    if (block.length == 0) {
+        return OS_OK;
+    }
+
+    FILE* file = fopen(block.path.c_str(), "ab");
+    size_t written = 0;
+    if (file) {
+        written = fwrite(block.data, 1, block.length, file);
+        fclose(file);
+    }
+    m_stats.flushes++;
+
+    if (written != block.length) {
+        ESP_LOGE(TAG, "Failed to write back %d bytes to %s", (int)block.length, block.path.c_str());
+        block.length = 0;
+        block.sectorsIfSeparate = 0;
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    uint32_t sectors = sectorsFor(block.length);
+    if (block.sectorsIfSeparate > sectors) {
+        m_stats.bytesSaved += (uint64_t)(block.sectorsIfSeparate - sectors) * SECTOR_SIZE;
+    }
+    block.length = 0;
+    block.sectorsIfSeparate = 0;
+    return OS_OK;
+}
+
+uint32_t WriteBackCache::sectorsFor(size_t bytes) {
+    // A small append still rewrites the partial tail sector
+    return (uint32_t)((bytes + SECTOR_SIZE - 1) / SECTOR_SIZE);
+}
@@ -0,0 +1,151 @@
+#ifndef WRITE_BACK_CACHE_H
+#define WRITE_BACK_CACHE_H
+
+#include "../system/os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <cstdio>
+#include <string>
+
+/**
+ * @file write_back_cache.h
+ * @brief Write-back cache for small appends and handle streams
+ *
+ * Appends made through StorageHAL::writeFile() (logs, app save paths)
+ * collect in per-path blocks and reach the card as one write when a block
+ * fills, ages past OS_STORAGE_CACHE_FLUSH_MS, or is flushed explicitly,
+ * instead of one open/write/close and partial-sector rewrite per call.
+ * Open file handles borrow a larger block as their stdio buffer, so their
+ * transfers go to the card in big chunks from DMA-capable memory.
+ *
+ * All blocks are cache-line aligned DMA-capable PSRAM, which lets the
+ * SDMMC driver transfer straight from them without a bounce buffer.
+ */
+
+struct WriteCacheStats {
+    uint32_t appends;           // Appends offered to the cache
+    uint32_t absorbed;          // Appends merged into an already dirty block
+    uint32_t bypassed;          // Too large; written through
+    uint32_t flushes;           // Device writes issued for dirty blocks
+    uint32_t evictions;         // Flushes forced to free a block
+    uint64_t bytesSaved;        // Sector rewrites avoided by coalescing
+    uint32_t streamBuffersInUse;
+};
+
+class WriteBackCache {
+public:
+    WriteBackCache() = default;
+    ~WriteBackCache();
+
+    /**
+     * @brief Allocate cache blocks
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize();
+
+    /**
+     * @brief Flush everything and free the blocks
+     */
+    void shutdown();
+
+    /**
+     * @brief Append data to a file through the cache
+     *
+     * Flushes the path's block first when the data does not fit, so the
+     * file always receives appends in call order.
+     * @param path File path
+     * @param data Data to append
+     * @param size Data size
+     * @return true if cached, false if the caller must write it through
+     */
+    bool append(const char* path, const void* data, size_t size);
+
+    /**
+     * @brief Write out a path's pending appends
+     * @param path File path
+     * @return OS_OK on success, error code if the device write failed
+     */
+    os_error_t flushPath(const char* path);
+
+    /**
+     * @brief Write out pending appends of every path under a directory
+     * @param directory Directory path
+     * @return OS_OK on success, error code if a device write failed
+     */
+    os_error_t flushDirectory(const char* directory);
+
+    /**
+     * @brief Drop a path's pending appends (the file is being deleted)
+     * @param path File path
+     */
+    void discardPath(const char* path);
+
+    /**
+     * @brief Write out all pending appends
+     * @return OS_OK on success, error code if a device write failed
+     */
+    os_error_t flushAll();
+
+    /**
+     * @brief Write out blocks dirty for longer than OS_STORAGE_CACHE_FLUSH_MS
+     * @param now Current time in milliseconds
+     */
+    void flushExpired(uint32_t now);
+
+    /**
+     * @brief Give an open stream a block as its stdio buffer
+     * @param file Stream just opened
+     * @return true if a block was attached, false if it keeps stdio's default
+     */
+    bool attachStream(FILE* file);
+
+    /**
+     * @brief Return a stream's block after fclose()
+     * @param file Stream that was closed
+     */
+    void releaseStream(FILE* file);
+
+    /**
+     * @brief Get cache statistics
+     * @return Statistics snapshot
+     */
+    WriteCacheStats getStats() const;
+
+    /**
+     * @brief Print cache statistics
+     */
+    void printStats() const;
+
+private:
+    struct AppendBlock {
+        uint8_t* data = nullptr;
+        size_t length = 0;
+        std::string path;
+        uint32_t dirtySince = 0;
+        uint32_t lastUse = 0;
+        uint32_t sectorsIfSeparate = 0;   // Sector writes the appends would have cost
+    };
+
+    struct StreamBlock {
+        uint8_t* data = nullptr;
+        FILE* owner = nullptr;
+    };
+
+    AppendBlock* findBlock(const char* path);
+    AppendBlock* claimBlock(const char* path, uint32_t now);
+
+    /**
+     * @brief Write a block to its file and mark it clean (lock held)
+     */
+    os_error_t writeBlock(AppendBlock& block);
+
+    static uint32_t sectorsFor(size_t bytes);
+
+    AppendBlock m_blocks[OS_STORAGE_CACHE_BLOCKS];
+    StreamBlock m_streams[OS_STORAGE_STREAM_BUFFERS];
+    SemaphoreHandle_t m_lock = nullptr;
+    bool m_initialized = false;
+    WriteCacheStats m_stats = {};
+};
+
+#endif // WRITE_BACK_CACHE_H
@@ -12,6 +12,7 @@
 #define LV_FONT_MONTSERRAT_12 1
 #define LV_FONT_MONTSERRAT_14 1
 #define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_UNSCII_16 1
 
 #define LV_USE_THEME_DEFAULT 1
 #define LV_USE_THEME_MATERIAL 1
@@ -22,4 +23,6 @@
 #define LV_USE_BTN 1
 #define LV_USE_LABEL 1
 
+#define LV_USE_SNAPSHOT 1
+
 #endif
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "app_package.h"
+#include <esp_log.h>
+#include <mbedtls/pk.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "AppPackage";
+
+AppPackageReader::AppPackageReader(AppPackageSink& sink) : m_sink(sink) {
+    mbedtls_sha256_init(&m_sha);
+    mbedtls_sha256_starts(&m_sha, 0);
+    expect(State::HEADER, sizeof(AppPackageHeader));
+}
+
+AppPackageReader::~AppPackageReader() {
+    mbedtls_sha256_free(&m_sha);
+}
+
+os_error_t AppPackageReader::feed(const uint8_t* data, size_t size) {
+    if (m_error != OS_OK) {
+        return m_error;
+    }
+    if (!data && size > 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    os_error_t result = OS_OK;
+    while (size > 0 && result == OS_OK) {
+        if (m_state == State::DONE) {
+            ESP_LOGE(TAG, "Data after the end of the package");
+            result = OS_ERROR_INVALID_PARAM;
+            break;
+        }
+
+        // File contents and literals pass straight through to the sink
+        if (m_state == State::DATA || m_state == State::LITERAL) {
+            uint32_t left = m_state == State::DATA ? m_entryLeft : m_literalLeft;
+            uint32_t count = (uint32_t)std::min<size_t>(size, left);
+            hash(data, count);
+            result = m_sink.onPackageData(data, count);
+            data += count;
+            size -= count;
+            m_bytesRead += count;
+            m_entryLeft -= count;
+            m_outputLeft -= count;
+
+            if (result != OS_OK) {
+                break;
+            }
+            if (m_state == State::LITERAL && (m_literalLeft -= count) > 0) {
+                continue;
+            }
+            if (m_entryLeft == 0) {
+                result = endEntry();
+            } else if (m_state == State::LITERAL) {
+                result = beginEntryData();
+            }
+            continue;
+        }
+
+        if (gather(data, size)) {
+            result = parseRecord();
+        }
+    }
+
+    if (result != OS_OK) {
+        m_error = result;
+        m_state = State::FAILED;
+    }
+    return result;
+}
+
+os_error_t AppPackageReader::finish() {
+    if (m_error != OS_OK) {
+        return m_error;
+    }
+    if (m_state != State::DONE) {
+        ESP_LOGE(TAG, "Package truncated after %d bytes", (int)m_bytesRead);
+        m_error = OS_ERROR_INVALID_PARAM;
+        return m_error;
+    }
+
+    if (!isSigned()) {
+#if OS_APP_REQUIRE_SIGNATURE
+        ESP_LOGE(TAG, "Package is not signed");
+        m_error = OS_ERROR_PERMISSION;
+        return m_error;
+#else
+        return OS_OK;
+#endif
+    }
+
+    m_error = verifySignature();
+    return m_error;
+}
+
+bool AppPackageReader::gather(const uint8_t*& data, size_t& size) {
+    size_t count = std::min(size, m_need - m_record.size());
+    m_record.insert(m_record.end(), data, data + count);
+
+    // The trailer and signature are the only bytes outside the digest
+    if (m_state != State::TRAILER && m_state != State::SIGNATURE) {
+        hash(data, count);
+    }
+    if (m_state == State::DELTA_OP) {
+        m_entryLeft -= (uint32_t)count;
+    }
+
+    data += count;
+    size -= count;
+    m_bytesRead += count;
+    return m_record.size() == m_need;
+}
+
+os_error_t AppPackageReader::parseRecord() {
+    switch (m_state) {
+    case State::HEADER:
+        memcpy(&m_header, m_record.data(), sizeof(m_header));
+        if (m_header.magic != APP_PACKAGE_MAGIC || m_header.version != APP_PACKAGE_VERSION) {
+            ESP_LOGE(TAG, "Not a package (magic %08x, version %d)", m_header.magic, m_header.version);
+            return OS_ERROR_INVALID_PARAM;
+        }
+        if (m_header.manifestSize == 0 || m_header.manifestSize > OS_APP_MANIFEST_MAX ||
+            ((m_header.flags & APP_PACKAGE_DELTA) && m_header.blockSize == 0)) {
+            ESP_LOGE(TAG, "Bad package header");
+            return OS_ERROR_INVALID_PARAM;
+        }
+        expect(State::MANIFEST, m_header.manifestSize);
+        return OS_OK;
+
+    case State::MANIFEST: {
+        m_record.push_back('\0');
+        os_error_t result = m_sink.onPackageManifest(m_header, reinterpret_cast<const char*>(m_record.data()));
+        return result != OS_OK ? result : nextEntry();
+    }
+
+    case State::ENTRY:
+        memcpy(&m_entry, m_record.data(), sizeof(m_entry));
+        if (m_entry.pathLength == 0 || m_entry.pathLength > OS_APP_PACKAGE_PATH_MAX) {
+            ESP_LOGE(TAG, "Bad path length %d in entry %d", m_entry.pathLength, m_entriesRead);
+            return OS_ERROR_INVALID_PARAM;
+        }
+        if ((m_entry.type == AppPackageEntryType::FILE && m_entry.size != m_entry.outputSize) ||
+            (m_entry.type == AppPackageEntryType::DIRECTORY && (m_entry.size | m_entry.outputSize) != 0) ||
+            (m_entry.type == AppPackageEntryType::DELTA && !(m_header.flags & APP_PACKAGE_DELTA)) ||
+            m_entry.type > AppPackageEntryType::DELTA) {
+            ESP_LOGE(TAG, "Bad entry %d", m_entriesRead);
+            return OS_ERROR_INVALID_PARAM;
+        }
+        expect(State::PATH, m_entry.pathLength);
+        return OS_OK;
+
+    case State::PATH: {
+        m_record.push_back('\0');
+        const char* path = reinterpret_cast<const char*>(m_record.data());
+
+        // Relative, no "..", no empty components, no NULs: nothing may land outside the app
+        bool valid = strlen(path) == m_entry.pathLength && path[0] != '/' &&
+                     strchr(path, '\\') == nullptr && strstr(path, "//") == nullptr &&
+                     path[m_entry.pathLength - 1] != '/';
+        for (const char* part = path; valid && part; ) {
+            const char* slash = strchr(part, '/');
+            size_t length = slash ? (size_t)(slash - part) : strlen(part);
+            valid = !(length == 2 && part[0] == '.' && part[1] == '.') && !(length == 1 && part[0] == '.');
+            part = slash ? slash + 1 : nullptr;
+        }
+        if (!valid) {
+            ESP_LOGE(TAG, "Bad path in entry %d", m_entriesRead);
+            return OS_ERROR_INVALID_PARAM;
+        }
+
+        m_entryLeft = m_entry.size;
+        m_outputLeft = m_entry.outputSize;
+        os_error_t result = m_sink.onPackageEntry(m_entry, path);
+        return result != OS_OK ? result : beginEntryData();
+    }
+
+    case State::DELTA_OP: {
+        AppPackageDeltaOp op;
+        memcpy(&op, m_record.data(), sizeof(op));
+        if (op.length == 0 || op.length > m_outputLeft ||
+            (op.sourceBlock == APP_PACKAGE_LITERAL && op.length > m_entryLeft)) {
+            ESP_LOGE(TAG, "Bad delta op in entry %d", m_entriesRead);
+            return OS_ERROR_INVALID_PARAM;
+        }
+
+        if (op.sourceBlock == APP_PACKAGE_LITERAL) {
+            m_literalLeft = op.length;
+            m_state = State::LITERAL;
+            return OS_OK;
+        }
+
+        os_error_t result = m_sink.onPackageCopy((uint64_t)op.sourceBlock * m_header.blockSize, op.length);
+        if (result != OS_OK) {
+            return result;
+        }
+        m_outputLeft -= op.length;
+        return m_entryLeft == 0 ? endEntry() : beginEntryData();
+    }
+
+    case State::TRAILER:
+        memcpy(&m_trailer, m_record.data(), sizeof(m_trailer));
+        if (m_trailer.magic != APP_PACKAGE_END_MAGIC ||
+            m_trailer.signatureSize > OS_APP_SIGNATURE_MAX ||
+            (m_trailer.signatureSize != 0) != isSigned()) {
+            ESP_LOGE(TAG, "Bad package trailer");
+            return OS_ERROR_INVALID_PARAM;
+        }
+
+        mbedtls_sha256_finish(&m_sha, m_digest);
+        if (memcmp(m_digest, m_trailer.digest, sizeof(m_digest)) != 0) {
+            ESP_LOGE(TAG, "Package digest mismatch");
+            return OS_ERROR_INVALID_PARAM;
+        }
+
+        if (m_trailer.signatureSize > 0) {
+            expect(State::SIGNATURE, m_trailer.signatureSize);
+        } else {
+            m_state = State::DONE;
+        }
+        return OS_OK;
+
+    case State::SIGNATURE:
+        // Kept in m_record for finish()
+        m_state = State::DONE;
+        return OS_OK;
+
+    default:
+        return OS_ERROR_GENERIC;
+    }
+}
+
+os_error_t AppPackageReader::beginEntryData() {
+    if (m_entryLeft == 0) {
+        return endEntry();
+    }
+
+    if (m_entry.type == AppPackageEntryType::FILE) {
+        m_state = State::DATA;
+        return OS_OK;
+    }
+
+    if (m_entryLeft < sizeof(AppPackageDeltaOp)) {
+        ESP_LOGE(TAG, "Truncated delta op in entry %d", m_entriesRead);
+        return OS_ERROR_INVALID_PARAM;
+    }
+    expect(State::DELTA_OP, sizeof(AppPackageDeltaOp));
+    return OS_OK;
+}
+
+os_error_t AppPackageReader::endEntry() {
+    if (m_outputLeft != 0) {
+        ESP_LOGE(TAG, "Entry %d is %d bytes short", m_entriesRead, (int)m_outputLeft);
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    os_error_t result = m_sink.onPackageEntryEnd();
+    if (result != OS_OK) {
+        return result;
+    }
+    m_entriesRead++;
+    return nextEntry();
+}
+
+os_error_t AppPackageReader::nextEntry() {
+    if (m_entriesRead == m_header.entryCount) {
+        expect(State::TRAILER, sizeof(AppPackageTrailer));
+    } else {
+        expect(State::ENTRY, sizeof(AppPackageEntry));
+    }
+    return OS_OK;
+}
+
+os_error_t AppPackageReader::verifySignature() const {
+    static const char* key = OS_APP_SIGNING_KEY;
+    if (key[0] == '\0') {
+#if OS_APP_REQUIRE_SIGNATURE
+        ESP_LOGE(TAG, "No signing key built in");
+        return OS_ERROR_PERMISSION;
+#else
+        ESP_LOGW(TAG, "No signing key built in, signature not checked");
+        return OS_OK;
+#endif
+    }
+
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+    int ret = mbedtls_pk_parse_public_key(&pk, reinterpret_cast<const unsigned char*>(key), strlen(key) + 1);
+    if (ret == 0) {
+        ret = mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, m_digest, sizeof(m_digest),
+                                m_record.data(), m_record.size());
+    }
+    mbedtls_pk_free(&pk);
+
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Package signature rejected: -0x%04x", -ret);
+        return OS_ERROR_PERMISSION;
+    }
+    return OS_OK;
+}
+
+void AppPackageReader::expect(State state, size_t bytes) {
+    m_state = state;
+    m_need = bytes;
+    m_record.clear();
+}
+
+void AppPackageReader::hash(const uint8_t* data, size_t size) {
+    if (size > 0) {
+        mbedtls_sha256_update(&m_sha, data, size);
+    }
+}
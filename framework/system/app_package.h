@@ -0,0 +1,213 @@
+#ifndef APP_PACKAGE_H
+#define APP_PACKAGE_H
+
+#include "os_config.h"
+#include <mbedtls/sha256.h>
+#include <vector>
+
+/**
+ * @file app_package.h
+ * @brief Streaming reader for .app packages
+ *
+ * tools/pack_app.py builds packages, full or as a delta against an older
+ * version. Layout (little endian):
+ * @code
+ *   AppPackageHeader
+ *   manifest               JSON, manifestSize bytes
+ *   entryCount times:
+ *     AppPackageEntry
+ *     path                 pathLength bytes, relative, '/' separated
+ *     data                 size bytes: file contents, nothing for a
+ *                          directory, or for a delta a run of
+ *                          AppPackageDeltaOp, each COPY or LITERAL
+ *                          followed by its bytes
+ *   AppPackageTrailer
+ *   signature              signatureSize bytes, DER ECDSA over the digest
+ * @endcode
+ *
+ * The digest is SHA-256 of everything before the trailer. The reader is
+ * fed whatever chunk sizes the source produces and keeps nothing but the
+ * record being parsed, so a package never has to fit in RAM: file bytes
+ * are handed to the sink as they arrive, entry by entry. Each entry
+ * carries the CRC32 of the file it produces so the sink can reject a bad
+ * entry as soon as it ends; the digest and signature are checked by
+ * finish(), and a sink should only commit what it wrote after that.
+ */
+
+static constexpr uint32_t APP_PACKAGE_MAGIC = 0x4B503554;       // "T5PK"
+static constexpr uint32_t APP_PACKAGE_END_MAGIC = 0x45503554;   // "T5PE"
+static constexpr uint16_t APP_PACKAGE_VERSION = 1;
+static constexpr uint32_t APP_PACKAGE_LITERAL = 0xFFFFFFFF;     // AppPackageDeltaOp::sourceBlock
+
+enum AppPackageFlags : uint16_t {
+    APP_PACKAGE_DELTA = 1 << 0,     // Entries are relative to the installed base version
+    APP_PACKAGE_SIGNED = 1 << 1
+};
+
+enum class AppPackageEntryType : uint8_t {
+    FILE,
+    DIRECTORY,
+    DELTA       // File rebuilt from blocks of the installed file plus literal bytes
+};
+
+struct AppPackageHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;             // AppPackageFlags
+    uint32_t manifestSize;
+    uint32_t entryCount;
+    uint32_t blockSize;         // Delta block size
+    uint32_t installSize;       // Sum of the files' sizes once installed
+    uint32_t reserved[2];
+};
+
+struct AppPackageEntry {
+    uint16_t pathLength;
+    AppPackageEntryType type;
+    uint8_t reserved;
+    uint32_t size;              // Bytes that follow the path
+    uint32_t outputSize;        // Size of the resulting file
+    uint32_t crc;               // CRC32 of the resulting file
+};
+
+struct AppPackageDeltaOp {
+    uint32_t sourceBlock;       // Block of the installed file, or APP_PACKAGE_LITERAL
+    uint32_t length;            // Bytes to copy from there, or literal bytes that follow
+};
+
+struct AppPackageTrailer {
+    uint32_t magic;
+    uint16_t signatureSize;
+    uint16_t reserved;
+    uint8_t digest[32];
+};
+
+static_assert(sizeof(AppPackageHeader) == 32, "Package header layout is shared with pack_app.py");
+static_assert(sizeof(AppPackageEntry) == 16, "Package entry layout is shared with pack_app.py");
+static_assert(sizeof(AppPackageDeltaOp) == 8, "Delta op layout is shared with pack_app.py");
+static_assert(sizeof(AppPackageTrailer) == 40, "Package trailer layout is shared with pack_app.py");
+
+/**
+ * @brief Receives a package as it is read
+ *
+ * Any error returned stops the reader and is returned from feed().
+ */
+class AppPackageSink {
+public:
+    virtual ~AppPackageSink() = default;
+
+    /**
+     * @brief Header and manifest have arrived, before any entry
+     * @param header Package header
+     * @param manifest JSON manifest, NUL terminated
+     */
+    virtual os_error_t onPackageManifest(const AppPackageHeader& header, const char* manifest) = 0;
+
+    /**
+     * @brief An entry starts
+     * @param entry Entry header
+     * @param path Relative path, NUL terminated and already checked for ".."
+     */
+    virtual os_error_t onPackageEntry(const AppPackageEntry& entry, const char* path) = 0;
+
+    /**
+     * @brief Next bytes of the resulting file
+     * @param data Bytes, valid for the call only
+     * @param size Byte count
+     */
+    virtual os_error_t onPackageData(const uint8_t* data, size_t size) = 0;
+
+    /**
+     * @brief Next bytes of the resulting file come from the installed file
+     * @param offset Byte offset in the installed file
+     * @param length Byte count
+     */
+    virtual os_error_t onPackageCopy(uint64_t offset, uint32_t length) = 0;
+
+    /**
+     * @brief The current entry is complete
+     */
+    virtual os_error_t onPackageEntryEnd() = 0;
+};
+
+class AppPackageReader {
+public:
+    explicit AppPackageReader(AppPackageSink& sink);
+    ~AppPackageReader();
+
+    AppPackageReader(const AppPackageReader&) = delete;
+    AppPackageReader& operator=(const AppPackageReader&) = delete;
+
+    /**
+     * @brief Consume the next chunk of the package
+     * @param data Chunk
+     * @param size Chunk size, any size
+     * @return OS_OK, OS_ERROR_INVALID_PARAM for a malformed package, or
+     *         the sink's error; once failed every call fails
+     */
+    os_error_t feed(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Check the end of the package: digest, signature, nothing left over
+     * @return OS_OK, OS_ERROR_INVALID_PARAM if truncated or the digest
+     *         differs, OS_ERROR_PERMISSION if the signature is missing or wrong
+     */
+    os_error_t finish();
+
+    const AppPackageHeader& getHeader() const { return m_header; }
+    bool isSigned() const { return (m_header.flags & APP_PACKAGE_SIGNED) != 0; }
+    uint64_t getBytesRead() const { return m_bytesRead; }
+    uint32_t getEntriesRead() const { return m_entriesRead; }
+
+private:
+    enum class State : uint8_t {
+        HEADER,
+        MANIFEST,
+        ENTRY,
+        PATH,
+        DATA,
+        DELTA_OP,
+        LITERAL,
+        TRAILER,
+        SIGNATURE,
+        DONE,
+        FAILED
+    };
+
+    /**
+     * @brief Gather bytes into m_record until m_need have arrived
+     * @return true once the record is complete
+     */
+    bool gather(const uint8_t*& data, size_t& size);
+
+    /**
+     * @brief Act on a complete record and pick the next state
+     */
+    os_error_t parseRecord();
+
+    os_error_t beginEntryData();
+    os_error_t endEntry();
+    os_error_t nextEntry();
+    os_error_t verifySignature() const;
+    void expect(State state, size_t bytes);
+    void hash(const uint8_t* data, size_t size);
+
+    AppPackageSink& m_sink;
+    mbedtls_sha256_context m_sha;
+    State m_state = State::HEADER;
+    std::vector<uint8_t> m_record;      // Header, manifest, path, op, trailer or signature
+    size_t m_need = 0;
+
+    AppPackageHeader m_header = {};
+    AppPackageEntry m_entry = {};
+    AppPackageTrailer m_trailer = {};
+    uint32_t m_entriesRead = 0;
+    uint32_t m_entryLeft = 0;           // Package bytes left in the entry
+    uint32_t m_literalLeft = 0;
+    uint64_t m_outputLeft = 0;          // Bytes the entry still has to produce
+    uint64_t m_bytesRead = 0;
+    uint8_t m_digest[32] = {};
+    os_error_t m_error = OS_OK;
+};
+
+#endif // APP_PACKAGE_H
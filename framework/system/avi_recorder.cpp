@@ -0,0 +1,361 @@
+#include "avi_recorder.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "AviRecorder";
+
+static constexpr uint32_t FOURCC_FRAME = avi_fourcc('0', '0', 'd', 'c');
+static constexpr uint32_t AVIF_HASINDEX = 0x00000010;
+static constexpr uint32_t AVIIF_KEYFRAME = 0x00000010;
+
+AviRecorder::~AviRecorder() {
+    stop();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t AviRecorder::start(const char* path) {
+    if (m_active) {
+        return OS_ERROR_BUSY;
+    }
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    snprintf(m_path, sizeof(m_path), "%s", path);
+
+    m_pool = (uint8_t*)OS_MALLOC_PSRAM((size_t)OS_VIDEO_SLOT_SIZE * OS_VIDEO_SLOTS);
+    m_index = (AviIndexEntry*)OS_MALLOC_PSRAM(sizeof(AviIndexEntry) * OS_VIDEO_MAX_FRAMES);
+    m_freeSlots = xQueueCreate(OS_VIDEO_SLOTS, sizeof(uint8_t));
+    m_fullSlots = xQueueCreate(OS_VIDEO_SLOTS, sizeof(uint8_t));
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+    }
+    if (!m_pool || !m_index || !m_freeSlots || !m_fullSlots || !m_mutex) {
+        ESP_LOGE(TAG, "Failed to allocate %d frame slots", OS_VIDEO_SLOTS);
+        releaseResources();
+        return OS_ERROR_NO_MEMORY;
+    }
+    for (uint8_t i = 0; i < OS_VIDEO_SLOTS; i++) {
+        xQueueSend(m_freeSlots, &i, 0);
+    }
+
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    m_handle = storage.openFile(m_path, FileOpenMode::WRITE);
+    if (m_handle == INVALID_FILE_HANDLE) {
+        releaseResources();
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_stats = {};
+    m_width = 0;
+    m_height = 0;
+    m_largestFrame = 0;
+    m_moviBytes = 4;
+    m_queuedBytes = 0;
+    m_full = false;
+
+    // Placeholder; stop() rewrites it with the final counts
+    AviFileHeader header;
+    fillHeader(header, false);
+    if (storage.write(m_handle, &header, sizeof(header)) != (int)sizeof(header)) {
+        storage.closeFile(m_handle);
+        m_handle = INVALID_FILE_HANDLE;
+        releaseResources();
+        return OS_ERROR_FILESYSTEM;
+    }
+    m_stats.fileBytes = sizeof(header);
+    m_startUs = esp_timer_get_time();
+    m_firstFrameUs = 0;
+    m_lastFrameUs = 0;
+
+    m_writerRunning = true;
+    if (xTaskCreatePinnedToCore(writerTask, "avi_writer", OS_VIDEO_TASK_STACK, this,
+                                OS_VIDEO_TASK_PRIORITY, &m_writerTask,
+                                OS_VIDEO_TASK_CORE) != pdPASS) {
+        m_writerRunning = false;
+        m_writerTask = nullptr;
+        storage.closeFile(m_handle);
+        m_handle = INVALID_FILE_HANDLE;
+        releaseResources();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_active = true;
+    ESP_LOGI(TAG, "Recording to %s (%d x %d KB slots)", m_path,
+             OS_VIDEO_SLOTS, OS_VIDEO_SLOT_SIZE / 1024);
+    return OS_OK;
+}
+
+os_error_t AviRecorder::stop() {
+    if (!m_active) {
+        return OS_OK;
+    }
+
+    // No new frames; the writer drains what is queued, then exits
+    lock();
+    m_active = false;
+    unlock();
+
+    TaskHandle_t task = m_writerTask;
+    m_writerRunning = false;
+    for (int attempt = 0; attempt < 500 && m_writerTask; attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (m_writerTask) {
+        ESP_LOGW(TAG, "AVI writer did not exit, deleting");
+        vTaskDelete(task);
+        m_writerTask = nullptr;
+    }
+
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    uint32_t frames = m_stats.framesRecorded;
+    uint32_t indexBytes = frames * sizeof(AviIndexEntry);
+    uint32_t indexHeader[2] = {avi_fourcc('i', 'd', 'x', '1'), indexBytes};
+
+    bool finished = storage.write(m_handle, indexHeader, sizeof(indexHeader)) == (int)sizeof(indexHeader) &&
+                    (indexBytes == 0 || storage.write(m_handle, m_index, indexBytes) == (int)indexBytes);
+    if (finished) {
+        m_stats.fileBytes += sizeof(indexHeader) + indexBytes;
+        AviFileHeader header;
+        fillHeader(header, true);
+        finished = storage.seek(m_handle, 0) == OS_OK &&
+                   storage.write(m_handle, &header, sizeof(header)) == (int)sizeof(header);
+    }
+
+    os_error_t result = storage.closeFile(m_handle);
+    m_handle = INVALID_FILE_HANDLE;
+    if (!finished || m_stats.writeErrors > 0) {
+        result = OS_ERROR_FILESYSTEM;
+    }
+
+    m_stats.elapsedMs = (uint32_t)((esp_timer_get_time() - m_startUs) / 1000);
+    ESP_LOGI(TAG, "Recording %s closed: %d frames, %llu bytes, %d dropped, %d write errors",
+             m_path, frames, m_stats.fileBytes, m_stats.framesDropped, m_stats.writeErrors);
+    releaseResources();
+    return result;
+}
+
+bool AviRecorder::addFrame(const uint8_t* data, size_t length, uint16_t width, uint16_t height) {
+    if (!m_active || !data || length == 0) {
+        return false;
+    }
+
+    size_t chunk = CHUNK_HEADER + length + (length & 1);
+    lock();
+    if (!m_active) {
+        unlock();   // stop() is draining the queue
+        return false;
+    }
+
+    uint64_t projected = m_stats.fileBytes + m_queuedBytes + chunk +
+                         8 + (uint64_t)(m_stats.framesRecorded + OS_VIDEO_SLOTS + 1) * sizeof(AviIndexEntry);
+    uint32_t accepted = m_stats.framesRecorded + (uint32_t)uxQueueMessagesWaiting(m_fullSlots);
+    if (projected > OS_VIDEO_MAX_FILE_BYTES || accepted >= OS_VIDEO_MAX_FRAMES) {
+        if (!m_full) {
+            ESP_LOGW(TAG, "Recording limit reached, dropping frames");
+        }
+        m_full = true;
+        m_stats.framesDropped++;
+        unlock();
+        return false;
+    }
+
+    uint8_t index;
+    if (chunk > OS_VIDEO_SLOT_SIZE || xQueueReceive(m_freeSlots, &index, 0) != pdTRUE) {
+        m_stats.framesDropped++;
+        unlock();
+        return false;
+    }
+
+    // Chunk header, JPEG and pad byte are laid out for a single write
+    uint8_t* slot = slotAt(index);
+    uint32_t chunkHeader[2] = {FOURCC_FRAME, (uint32_t)length};
+    memcpy(slot, chunkHeader, sizeof(chunkHeader));
+    memcpy(slot + CHUNK_HEADER, data, length);
+    if (length & 1) {
+        slot[CHUNK_HEADER + length] = 0;
+    }
+    m_slotLengths[index] = (uint32_t)chunk;
+
+    m_lastFrameUs = esp_timer_get_time();
+    if (m_width == 0) {
+        m_width = width;
+        m_height = height;
+        m_firstFrameUs = m_lastFrameUs;
+    }
+    m_largestFrame = std::max<uint32_t>(m_largestFrame, (uint32_t)length);
+    m_queuedBytes += chunk;
+
+    xQueueSend(m_fullSlots, &index, 0);     // Never full: it holds at most every slot
+    uint32_t depth = (uint32_t)uxQueueMessagesWaiting(m_fullSlots);
+    m_stats.maxQueueDepth = std::max(m_stats.maxQueueDepth, depth);
+    unlock();
+    return true;
+}
+
+VideoRecordStats AviRecorder::getStats() const {
+    lock();
+    VideoRecordStats stats = m_stats;
+    unlock();
+    if (m_active) {
+        stats.elapsedMs = (uint32_t)((esp_timer_get_time() - m_startUs) / 1000);
+        stats.queueDepth = m_fullSlots ? (uint32_t)uxQueueMessagesWaiting(m_fullSlots) : 0;
+    }
+    stats.writeKBps = stats.elapsedMs > 0 ? (uint32_t)(stats.fileBytes * 1000 / 1024 / stats.elapsedMs) : 0;
+    return stats;
+}
+
+void AviRecorder::fillHeader(AviFileHeader& header, bool indexed) const {
+    // Frame rate as measured between the first and last accepted frames
+    uint32_t frames = m_stats.framesRecorded;
+    uint32_t usPerFrame = DEFAULT_US_PER_FRAME;
+    if (frames > 1 && m_lastFrameUs > m_firstFrameUs) {
+        usPerFrame = (uint32_t)((m_lastFrameUs - m_firstFrameUs) / (frames - 1));
+    }
+    usPerFrame = std::max<uint32_t>(usPerFrame, 1);
+
+    memset(&header, 0, sizeof(header));
+    header.riff = avi_fourcc('R', 'I', 'F', 'F');
+    header.riffSize = (uint32_t)(sizeof(AviFileHeader) - 8 + (m_moviBytes - 4) +
+                                 (indexed ? 8 + frames * sizeof(AviIndexEntry) : 0));
+    header.aviType = avi_fourcc('A', 'V', 'I', ' ');
+
+    header.hdrlList = avi_fourcc('L', 'I', 'S', 'T');
+    header.hdrlSize = offsetof(AviFileHeader, moviList) - offsetof(AviFileHeader, hdrlType);
+    header.hdrlType = avi_fourcc('h', 'd', 'r', 'l');
+
+    header.avih = avi_fourcc('a', 'v', 'i', 'h');
+    header.avihSize = offsetof(AviFileHeader, strlList) - offsetof(AviFileHeader, microSecPerFrame);
+    header.microSecPerFrame = usPerFrame;
+    header.maxBytesPerSec = (uint32_t)((uint64_t)m_largestFrame * 1000000 / usPerFrame);
+    header.flags = AVIF_HASINDEX;
+    header.totalFrames = frames;
+    header.streams = 1;
+    header.suggestedBufferSize = m_largestFrame + CHUNK_HEADER;
+    header.width = m_width;
+    header.height = m_height;
+
+    header.strlList = avi_fourcc('L', 'I', 'S', 'T');
+    header.strlSize = offsetof(AviFileHeader, moviList) - offsetof(AviFileHeader, strlType);
+    header.strlType = avi_fourcc('s', 't', 'r', 'l');
+
+    header.strh = avi_fourcc('s', 't', 'r', 'h');
+    header.strhSize = offsetof(AviFileHeader, strf) - offsetof(AviFileHeader, fccType);
+    header.fccType = avi_fourcc('v', 'i', 'd', 's');
+    header.fccHandler = avi_fourcc('M', 'J', 'P', 'G');
+    header.scale = usPerFrame;      // rate / scale = measured frames per second
+    header.rate = 1000000;
+    header.length = frames;
+    header.streamBufferSize = m_largestFrame + CHUNK_HEADER;
+    header.quality = 0xFFFFFFFF;
+    header.frameRight = (int16_t)m_width;
+    header.frameBottom = (int16_t)m_height;
+
+    header.strf = avi_fourcc('s', 't', 'r', 'f');
+    header.strfSize = offsetof(AviFileHeader, moviList) - offsetof(AviFileHeader, biSize);
+    header.biSize = header.strfSize;
+    header.biWidth = m_width;
+    header.biHeight = m_height;
+    header.biPlanes = 1;
+    header.biBitCount = 24;
+    header.biCompression = avi_fourcc('M', 'J', 'P', 'G');
+    header.biSizeImage = (uint32_t)m_width * m_height * 3;
+
+    header.moviList = avi_fourcc('L', 'I', 'S', 'T');
+    header.moviSize = m_moviBytes;
+    header.moviType = avi_fourcc('m', 'o', 'v', 'i');
+}
+
+uint8_t* AviRecorder::slotAt(uint8_t index) const {
+    return m_pool + (size_t)index * OS_VIDEO_SLOT_SIZE;
+}
+
+void AviRecorder::releaseResources() {
+    if (m_pool) {
+        OS_FREE(m_pool);
+        m_pool = nullptr;
+    }
+    if (m_index) {
+        OS_FREE(m_index);
+        m_index = nullptr;
+    }
+    if (m_freeSlots) {
+        vQueueDelete(m_freeSlots);
+        m_freeSlots = nullptr;
+    }
+    if (m_fullSlots) {
+        vQueueDelete(m_fullSlots);
+        m_fullSlots = nullptr;
+    }
+    m_queuedBytes = 0;
+}
+
+void AviRecorder::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void AviRecorder::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
+
+void AviRecorder::writerTask(void* parameter) {
+    AviRecorder* recorder = static_cast<AviRecorder*>(parameter);
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    uint32_t sinceSync = 0;
+
+    // Drain the queue even after stop() so every accepted frame is kept
+    while (recorder->m_writerRunning || uxQueueMessagesWaiting(recorder->m_fullSlots) > 0) {
+        uint8_t index;
+        if (xQueueReceive(recorder->m_fullSlots, &index, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+
+        const uint8_t* slot = recorder->slotAt(index);
+        uint32_t size = recorder->m_slotLengths[index];
+        uint32_t frameLength = reinterpret_cast<const uint32_t*>(slot)[1];
+
+        bool written = storage.write(recorder->m_handle, slot, size) == (int)size;
+        if (!written) {
+            // Drop the partial chunk so the list stays parseable
+            storage.seek(recorder->m_handle, sizeof(AviFileHeader) + recorder->m_moviBytes - 4);
+        } else {
+            AviIndexEntry& entry = recorder->m_index[recorder->m_stats.framesRecorded];
+            entry.chunkId = FOURCC_FRAME;
+            entry.flags = AVIIF_KEYFRAME;
+            entry.offset = recorder->m_moviBytes;
+            entry.size = frameLength;
+            if (++sinceSync >= OS_VIDEO_SYNC_FRAMES) {
+                storage.flush(recorder->m_handle);
+                sinceSync = 0;
+            }
+        }
+
+        recorder->lock();
+        if (written) {
+            recorder->m_moviBytes += size;
+            recorder->m_stats.framesRecorded++;
+            recorder->m_stats.fileBytes += size;
+        } else {
+            recorder->m_stats.writeErrors++;
+            recorder->m_stats.framesDropped++;
+        }
+        recorder->m_queuedBytes -= size;
+        recorder->unlock();
+
+        xQueueSend(recorder->m_freeSlots, &index, 0);
+    }
+
+    recorder->m_writerTask = nullptr;
+    vTaskDelete(NULL);
+}
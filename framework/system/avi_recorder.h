@@ -0,0 +1,187 @@
+#ifndef AVI_RECORDER_H
+#define AVI_RECORDER_H
+
+#include "os_config.h"
+#include "../hal/storage_hal.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/**
+ * @file avi_recorder.h
+ * @brief MJPEG/AVI video recording with an asynchronous writer
+ *
+ * The camera task hands each JPEG frame to addFrame(), which copies it
+ * into a free PSRAM slot behind a ready-made '00dc' chunk header and
+ * queues the slot; it never waits, so a slow card drops frames (counted)
+ * instead of stalling the camera. A writer task on OS_VIDEO_TASK_CORE
+ * streams queued slots through a StorageHAL handle with one write each
+ * and keeps the idx1 entries in PSRAM. stop() drains the queue, appends
+ * idx1 and rewrites the header with the frame count, size and the frame
+ * rate measured over the recording.
+ *
+ * AVI 1.0 only: recording stops accepting frames (isFull()) before the
+ * file reaches OS_VIDEO_MAX_FILE_BYTES or the index OS_VIDEO_MAX_FRAMES.
+ *
+ * addFrame() is called from one producer task; start() and stop() from one.
+ */
+
+static constexpr uint32_t avi_fourcc(char a, char b, char c, char d) {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+/**
+ * @brief Fixed AVI header up to and including the 'movi' list tag
+ */
+struct AviFileHeader {
+    uint32_t riff, riffSize, aviType;
+    uint32_t hdrlList, hdrlSize, hdrlType;
+
+    // MainAVIHeader
+    uint32_t avih, avihSize;
+    uint32_t microSecPerFrame, maxBytesPerSec, paddingGranularity, flags;
+    uint32_t totalFrames, initialFrames, streams, suggestedBufferSize;
+    uint32_t width, height;
+    uint32_t reserved[4];
+
+    uint32_t strlList, strlSize, strlType;
+
+    // AVIStreamHeader
+    uint32_t strh, strhSize;
+    uint32_t fccType, fccHandler, streamFlags;
+    uint16_t priority, language;
+    uint32_t streamInitialFrames, scale, rate, start, length;
+    uint32_t streamBufferSize, quality, sampleSize;
+    int16_t frameLeft, frameTop, frameRight, frameBottom;
+
+    // BITMAPINFOHEADER
+    uint32_t strf, strfSize;
+    uint32_t biSize;
+    int32_t biWidth, biHeight;
+    uint16_t biPlanes, biBitCount;
+    uint32_t biCompression, biSizeImage;
+    int32_t biXPelsPerMeter, biYPelsPerMeter;
+    uint32_t biClrUsed, biClrImportant;
+
+    uint32_t moviList, moviSize, moviType;
+};
+static_assert(sizeof(AviFileHeader) == 224, "AVI header layout");
+
+struct AviIndexEntry {
+    uint32_t chunkId;
+    uint32_t flags;
+    uint32_t offset;        // From the 'movi' tag
+    uint32_t size;
+};
+static_assert(sizeof(AviIndexEntry) == 16, "AVI index layout");
+
+struct VideoRecordStats {
+    uint32_t framesRecorded;    // Written to the file
+    uint32_t framesDropped;     // No free slot, too large, or file full
+    uint32_t writeErrors;
+    uint32_t queueDepth;        // Slots waiting for the writer now
+    uint32_t maxQueueDepth;
+    uint64_t fileBytes;
+    uint32_t elapsedMs;
+    uint32_t writeKBps;         // Average over the recording
+};
+
+class AviRecorder {
+public:
+    AviRecorder() = default;
+    ~AviRecorder();
+
+    AviRecorder(const AviRecorder&) = delete;
+    AviRecorder& operator=(const AviRecorder&) = delete;
+
+    /**
+     * @brief Create the file and start accepting frames
+     * @param path AVI path
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t start(const char* path);
+
+    /**
+     * @brief Write out queued frames, append the index and close
+     * @return OS_OK on success, error code if a write failed
+     */
+    os_error_t stop();
+
+    /**
+     * @brief Check if a recording is running
+     * @return true between start() and stop()
+     */
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief Check if the file or index limit was reached
+     * @return true if further frames are dropped; call stop()
+     */
+    bool isFull() const { return m_full; }
+
+    /**
+     * @brief Queue one JPEG frame (producer only, never blocks on storage)
+     * @param data JPEG bytes
+     * @param length Byte count
+     * @param width Frame width
+     * @param height Frame height
+     * @return true if queued, false if dropped
+     */
+    bool addFrame(const uint8_t* data, size_t length, uint16_t width, uint16_t height);
+
+    /**
+     * @brief Get recording counters
+     * @return Statistics snapshot
+     */
+    VideoRecordStats getStats() const;
+
+    /**
+     * @brief Get the file path
+     * @return Path of the running or last recording
+     */
+    const char* getPath() const { return m_path; }
+
+private:
+    static constexpr size_t CHUNK_HEADER = 8;
+    static constexpr uint32_t DEFAULT_US_PER_FRAME = 33333;   // Until two frames are timed
+
+    void fillHeader(AviFileHeader& header, bool indexed) const;
+    uint8_t* slotAt(uint8_t index) const;
+    void releaseResources();
+    void lock() const;
+    void unlock() const;
+
+    static void writerTask(void* parameter);
+
+    // File
+    char m_path[96] = {};
+    FileHandle m_handle = INVALID_FILE_HANDLE;
+    volatile bool m_active = false;
+    volatile bool m_full = false;
+    volatile bool m_writerRunning = false;
+    TaskHandle_t m_writerTask = nullptr;
+
+    // Slot pool: the producer fills free slots, the writer drains the full queue
+    uint8_t* m_pool = nullptr;
+    uint32_t m_slotLengths[OS_VIDEO_SLOTS] = {};   // Chunk bytes, header and pad included
+    QueueHandle_t m_freeSlots = nullptr;
+    QueueHandle_t m_fullSlots = nullptr;
+    SemaphoreHandle_t m_mutex = nullptr;
+    uint64_t m_queuedBytes = 0;     // Accepted but not yet written
+
+    // Index, appended by the writer
+    AviIndexEntry* m_index = nullptr;
+    uint32_t m_moviBytes = 0;       // 'movi' list payload, tag included
+
+    // Stream properties
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    uint32_t m_largestFrame = 0;
+    int64_t m_startUs = 0;
+    int64_t m_firstFrameUs = 0;
+    int64_t m_lastFrameUs = 0;
+    VideoRecordStats m_stats = {};
+};
+
+#endif // AVI_RECORDER_H
@@ -0,0 +1,243 @@
+#include "benchmark_suite.h"
+#include "os_manager.h"
+#include "memory_manager.h"
+#include "task_scheduler.h"
+#include "../hal/hal_manager.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <string>
+
+/**
+ * @file benchmark_device.cpp
+ * @brief Benchmark cases that need the OS: memory pools, events, the
+ * scheduler, storage and the display
+ */
+
+static os_error_t benchmarkPool(BenchmarkReport& report, uint32_t caps) {
+    static const size_t blockSize = 64;
+    static const size_t blockCount = 512;
+    static const uint32_t rounds = 200;
+
+    MemoryPool pool(blockSize, blockCount, caps);
+    if (pool.getTotalBlocks() == 0) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    // One block in and out: the hot path of short-lived event payloads
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < rounds * blockCount; i++) {
+        pool.deallocate(pool.allocate());
+    }
+    int64_t pairUs = esp_timer_get_time() - start;
+
+    // Fill and drain: every free-list link and bitmap word is touched
+    std::vector<void*> blocks(blockCount);
+    start = esp_timer_get_time();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < blockCount; i++) {
+            blocks[i] = pool.allocate();
+        }
+        for (size_t i = 0; i < blockCount; i++) {
+            pool.deallocate(blocks[(i * 7) % blockCount]);
+        }
+    }
+    int64_t fillUs = esp_timer_get_time() - start;
+
+    double operations = (double)rounds * blockCount;
+    report.result("alloc_free_pair", pairUs * 1000.0 / operations, "ns");
+    report.result("fill_drain_op", fillUs * 1000.0 / (operations * 2), "ns");
+    return pool.getFreeBlocks() == blockCount ? OS_OK : OS_ERROR_GENERIC;
+}
+
+static os_error_t benchmarkEvents(BenchmarkReport& report) {
+    std::vector<DispatchBenchmarkResult> results;
+    os_error_t error = OS().getEventSystem().runDispatchBenchmark(1000, results);
+    if (error != OS_OK) {
+        return error;
+    }
+
+    char metric[24];
+    for (const DispatchBenchmarkResult& result : results) {
+        snprintf(metric, sizeof(metric), "sync_%d", result.listeners);
+        report.result(metric, result.syncNs, "ns");
+        snprintf(metric, sizeof(metric), "queued_%d", result.listeners);
+        report.result(metric, result.asyncNs, "ns");
+    }
+    return OS_OK;
+}
+
+static os_error_t benchmarkScheduler(BenchmarkReport& report) {
+    static const uint32_t tasks = 32;
+    static const uint32_t rounds = 200;
+
+    // A scheduler of its own: the OS one is using some of its OS_MAX_TASKS slots
+    TaskScheduler scheduler;
+    if (scheduler.initialize() != OS_OK) {
+        return OS_ERROR_GENERIC;
+    }
+
+    volatile uint32_t executed = 0;
+    for (uint32_t i = 0; i < tasks; i++) {
+        if (scheduler.schedulePeriodic([&executed]() { executed = executed + 1; }, 1,
+                                       (uint8_t)(i % (OS_TASK_PRIORITY_HIGH + 1))) == 0) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    // Every task is due after the 1 ms period, so each update runs all 32
+    int64_t busyUs = 0;
+    int64_t maxUs = 0;
+    for (uint32_t round = 0; round < rounds; round++) {
+        delayMicroseconds(1100);
+        int64_t start = esp_timer_get_time();
+        scheduler.update(1);
+        int64_t elapsed = esp_timer_get_time() - start;
+        busyUs += elapsed;
+        maxUs = std::max(maxUs, elapsed);
+    }
+    uint32_t ran = executed;
+
+    // Straight after a full update nothing is due
+    int64_t start = esp_timer_get_time();
+    for (uint32_t round = 0; round < rounds; round++) {
+        scheduler.update(0);
+    }
+    int64_t idleUs = esp_timer_get_time() - start;
+    scheduler.shutdown();
+
+    report.result("update_32_due", (double)busyUs / rounds, "us");
+    report.result("update_32_due_max", (double)maxUs, "us");
+    report.result("per_task", busyUs * 1000.0 / std::max<uint32_t>(ran, 1), "ns");
+    report.result("update_idle", idleUs * 1000.0 / rounds, "ns");
+    return ran > 0 ? OS_OK : OS_ERROR_TIMEOUT;
+}
+
+static os_error_t benchmarkStorage(BenchmarkReport& report, HALStorageType type) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    if (!storage.isMounted(type)) {
+        report.skip("not_mounted");
+        return OS_OK;
+    }
+
+    std::string path = storage.getStorageInfo(type).mountPoint + "/.benchmark.tmp";
+    uint8_t* buffer = static_cast<uint8_t*>(OS_MALLOC_DMA(OS_BENCHMARK_IO_CHUNK));
+    if (!buffer) {
+        return OS_ERROR_NO_MEMORY;
+    }
+    for (size_t i = 0; i < OS_BENCHMARK_IO_CHUNK; i++) {
+        buffer[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    os_error_t error = OS_OK;
+    int64_t writeUs = 0, readUs = 0, randomWriteUs = 0, randomReadUs = 0;
+
+    // Sequential write, including the flush to the medium
+    int64_t start = esp_timer_get_time();
+    FileHandle handle = storage.openFile(path.c_str(), FileOpenMode::WRITE);
+    for (size_t done = 0; handle != INVALID_FILE_HANDLE && done < OS_BENCHMARK_FILE_SIZE && error == OS_OK;
+         done += OS_BENCHMARK_IO_CHUNK) {
+        if (storage.write(handle, buffer, OS_BENCHMARK_IO_CHUNK) != OS_BENCHMARK_IO_CHUNK) {
+            error = OS_ERROR_FILESYSTEM;
+        }
+    }
+    if (handle == INVALID_FILE_HANDLE || storage.flush(handle) != OS_OK) {
+        error = OS_ERROR_FILESYSTEM;
+    }
+    storage.closeFile(handle);
+    writeUs = esp_timer_get_time() - start;
+
+    // Sequential read
+    if (error == OS_OK) {
+        start = esp_timer_get_time();
+        handle = storage.openFile(path.c_str(), FileOpenMode::READ);
+        size_t total = 0;
+        int read;
+        while (handle != INVALID_FILE_HANDLE && (read = storage.read(handle, buffer, OS_BENCHMARK_IO_CHUNK)) > 0) {
+            total += read;
+        }
+        storage.closeFile(handle);
+        readUs = esp_timer_get_time() - start;
+        if (total != OS_BENCHMARK_FILE_SIZE) {
+            error = OS_ERROR_FILESYSTEM;
+        }
+    }
+
+    // Random blocks, from a fixed seed so every run touches the same offsets
+    static const uint32_t blocks = OS_BENCHMARK_FILE_SIZE / OS_BENCHMARK_RANDOM_BLOCK;
+    for (int pass = 0; pass < 2 && error == OS_OK; pass++) {
+        bool writing = pass == 0;
+        uint32_t seed = 12345;
+        start = esp_timer_get_time();
+        handle = storage.openFile(path.c_str(), FileOpenMode::READ_WRITE);
+        for (uint32_t op = 0; handle != INVALID_FILE_HANDLE && op < OS_BENCHMARK_RANDOM_OPS && error == OS_OK; op++) {
+            seed = seed * 1103515245 + 12345;
+            int64_t offset = (int64_t)((seed >> 8) % blocks) * OS_BENCHMARK_RANDOM_BLOCK;
+            int moved = storage.seek(handle, offset) != OS_OK ? -1 :
+                        writing ? storage.write(handle, buffer, OS_BENCHMARK_RANDOM_BLOCK)
+                                : storage.read(handle, buffer, OS_BENCHMARK_RANDOM_BLOCK);
+            if (moved != OS_BENCHMARK_RANDOM_BLOCK) {
+                error = OS_ERROR_FILESYSTEM;
+            }
+        }
+        if (handle == INVALID_FILE_HANDLE || (writing && storage.flush(handle) != OS_OK)) {
+            error = OS_ERROR_FILESYSTEM;
+        }
+        storage.closeFile(handle);
+        (writing ? randomWriteUs : randomReadUs) = esp_timer_get_time() - start;
+    }
+
+    storage.deleteFile(path.c_str());
+    OS_FREE(buffer);
+    if (error != OS_OK) {
+        return error;
+    }
+
+    report.result("seq_write", BenchmarkReport::kbPerSecond(OS_BENCHMARK_FILE_SIZE, writeUs), "KB/s");
+    report.result("seq_read", BenchmarkReport::kbPerSecond(OS_BENCHMARK_FILE_SIZE, readUs), "KB/s");
+    report.result("random_write", OS_BENCHMARK_RANDOM_OPS * 1000000.0 / std::max<int64_t>(randomWriteUs, 1), "ops/s");
+    report.result("random_read", OS_BENCHMARK_RANDOM_OPS * 1000000.0 / std::max<int64_t>(randomReadUs, 1), "ops/s");
+    return OS_OK;
+}
+
+static os_error_t benchmarkDisplay(BenchmarkReport& report) {
+    DisplayHAL& display = OS().getHALManager().getDisplay();
+
+    // Render and flush the whole screen; returns once the last area is sent
+    int64_t totalUs = 0;
+    int64_t maxUs = 0;
+    for (uint32_t frame = 0; frame < OS_BENCHMARK_FLUSH_FRAMES; frame++) {
+        int64_t start = esp_timer_get_time();
+        os_error_t error = display.forceRefresh();
+        if (error != OS_OK) {
+            return error;
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        totalUs += elapsed;
+        maxUs = std::max(maxUs, elapsed);
+    }
+
+    double averageUs = (double)totalUs / OS_BENCHMARK_FLUSH_FRAMES;
+    report.result("full_flush", averageUs, "us");
+    report.result("full_flush_max", (double)maxUs, "us");
+    report.result("full_flush_rate", 1000000.0 / averageUs, "fps");
+    return OS_OK;
+}
+
+void BenchmarkSuite::addDeviceCases() {
+    add("memory_pool.internal", [](BenchmarkReport& report) {
+        return benchmarkPool(report, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    });
+    add("memory_pool.psram", [](BenchmarkReport& report) {
+        return benchmarkPool(report, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    });
+    add("event.dispatch", benchmarkEvents);
+    add("scheduler.update", benchmarkScheduler);
+    add("storage.flash", [](BenchmarkReport& report) {
+        return benchmarkStorage(report, HALStorageType::INTERNAL_FLASH);
+    });
+    add("storage.sd", [](BenchmarkReport& report) {
+        return benchmarkStorage(report, HALStorageType::SD_CARD);
+    });
+    add("display.flush", benchmarkDisplay);
+}
@@ -0,0 +1,77 @@
+#include "benchmark_suite.h"
+#include "hex_format.h"
+#include "spreadsheet_engine.h"
+#include <cstdio>
+#include <cstring>
+
+void BenchmarkReport::result(const char* metric, double value, const char* unit) {
+    printf("BENCH %s %s %.3f %s\n", m_case, metric, value, unit);
+    m_results++;
+}
+
+double BenchmarkReport::kbPerSecond(uint64_t bytes, int64_t us) {
+    return (double)bytes * 1000000.0 / 1024.0 / (double)(us > 0 ? us : 1);
+}
+
+void BenchmarkReport::skip(const char* reason) {
+    printf("BENCH SKIP %s %s\n", m_case, reason);
+    m_skipped = true;
+}
+
+void BenchmarkSuite::add(const char* name, BenchmarkCase function) {
+    if (name && function) {
+        m_cases.push_back({name, function});
+    }
+}
+
+size_t BenchmarkSuite::run(const char* target, const char* filter) {
+    size_t ran = 0;
+    size_t failures = 0;
+
+    printf("BENCH BEGIN %d %s\n", BENCHMARK_SUITE_VERSION, target ? target : "unknown");
+    for (const Case& benchmark : m_cases) {
+        if (filter && filter[0] && strncmp(benchmark.name, filter, strlen(filter)) != 0) {
+            continue;
+        }
+
+        BenchmarkReport report(benchmark.name);
+        os_error_t result = benchmark.function(report);
+        if (result != OS_OK) {
+            printf("BENCH FAIL %s %d\n", benchmark.name, result);
+            failures++;
+        }
+        ran++;
+        fflush(stdout);
+    }
+    printf("BENCH END %d %d\n", (int)ran, (int)failures);
+    fflush(stdout);
+    return failures;
+}
+
+void BenchmarkSuite::addLogicCases() {
+    add("formatter.hex", [](BenchmarkReport& report) {
+        static const uint32_t iterations = 200;
+        HexBenchmarkResult result;
+        HexFormat::benchmark(4096, iterations, result);
+        report.result("hex_snprintf", BenchmarkReport::kbPerSecond(result.bytes, result.snprintfUs), "KB/s");
+        report.result("hex_table", BenchmarkReport::kbPerSecond(result.bytes, result.tableUs), "KB/s");
+        report.result("hexdump", BenchmarkReport::kbPerSecond(result.bytes, result.hexdumpUs), "KB/s");
+        report.result("timestamp_localtime", result.localtimeUs * 1000.0 / iterations, "ns");
+        report.result("timestamp_cached", result.cachedUs * 1000.0 / iterations, "ns");
+        return OS_OK;
+    });
+
+    add("spreadsheet.recalc", [](BenchmarkReport& report) {
+        RecalcBenchmarkResult result;
+        os_error_t error = SpreadsheetEngine::runRecalcBenchmark(OS_BENCHMARK_SHEET_CELLS, result);
+        if (error != OS_OK) {
+            return error;
+        }
+        report.result("build", result.buildUs / 1000.0, "ms");
+        report.result("full", result.fullUs, "us");
+        report.result("full_per_formula", result.fullUs * 1000.0 / (result.fullFormulas ? result.fullFormulas : 1), "ns");
+        report.result("edit_top", result.topUs, "us");
+        report.result("edit_bottom", result.bottomUs, "us");
+        return OS_OK;
+    });
+}
@@ -0,0 +1,109 @@
+#ifndef BENCHMARK_SUITE_H
+#define BENCHMARK_SUITE_H
+
+#include "os_config.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @file benchmark_suite.h
+ * @brief Fixed benchmark suite with machine-readable results
+ *
+ * Results are printed to stdout (the USB serial console on the device),
+ * one per line, bracketed so a host script can pick them out of the log:
+ * @code
+ *   BENCH BEGIN <suite version> <target>
+ *   BENCH <case> <metric> <value> <unit>
+ *   BENCH SKIP <case> <reason>
+ *   BENCH FAIL <case> <error>
+ *   BENCH END <cases> <failures>
+ * @endcode
+ * Names contain no spaces. Units say which way is better: times (ns, us,
+ * ms) should fall, rates (KB/s, ops/s, fps) should rise;
+ * tools/bench_compare.py compares two captures on that basis.
+ *
+ * The logic cases (terminal formatter, spreadsheet) need nothing but the
+ * C++ runtime and also run in the native environment; the device cases
+ * (benchmark_device.cpp) need the OS initialised.
+ */
+
+static constexpr uint16_t BENCHMARK_SUITE_VERSION = 1;
+
+class BenchmarkReport {
+public:
+    explicit BenchmarkReport(const char* caseName) : m_case(caseName) {}
+
+    /**
+     * @brief Print one result
+     * @param metric Metric name
+     * @param value Value
+     * @param unit Unit
+     */
+    void result(const char* metric, double value, const char* unit);
+
+    /**
+     * @brief Mark the case skipped (hardware missing); nothing else is printed
+     * @param reason Why, no spaces
+     */
+    void skip(const char* reason);
+
+    /**
+     * @brief Convert bytes moved in a time to KB/s
+     * @param bytes Bytes
+     * @param us Microseconds
+     * @return KB/s
+     */
+    static double kbPerSecond(uint64_t bytes, int64_t us);
+
+    bool isSkipped() const { return m_skipped; }
+    size_t getResultCount() const { return m_results; }
+
+private:
+    const char* m_case;
+    size_t m_results = 0;
+    bool m_skipped = false;
+};
+
+typedef std::function<os_error_t(BenchmarkReport& report)> BenchmarkCase;
+
+class BenchmarkSuite {
+public:
+    BenchmarkSuite() = default;
+
+    /**
+     * @brief Add a case
+     * @param name Static case name, no spaces
+     * @param function Measures and reports; an error counts as a failure
+     */
+    void add(const char* name, BenchmarkCase function);
+
+    /**
+     * @brief Add the cases that only need the C++ runtime
+     */
+    void addLogicCases();
+
+    /**
+     * @brief Add the cases that need the OS and its hardware (benchmark_device.cpp)
+     */
+    void addDeviceCases();
+
+    /**
+     * @brief Run the cases in order of add() and print the results
+     * @param target Target name printed in the BEGIN line
+     * @param filter Only run cases whose name starts with this, or nullptr for all
+     * @return Number of failed cases
+     */
+    size_t run(const char* target, const char* filter = nullptr);
+
+    size_t getCaseCount() const { return m_cases.size(); }
+
+private:
+    struct Case {
+        const char* name;
+        BenchmarkCase function;
+    };
+
+    std::vector<Case> m_cases;
+};
+
+#endif // BENCHMARK_SUITE_H
@@ -0,0 +1,292 @@
+#include "boot_graph.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "BootGraph";
+
+static constexpr size_t TIMELINE_WIDTH = 32;
+
+BootGraph::~BootGraph() {
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+    if (m_wake) {
+        vSemaphoreDelete(m_wake);
+        m_wake = nullptr;
+    }
+}
+
+os_error_t BootGraph::addStage(const char* name, BootFunction function,
+                               const std::vector<const char*>& dependencies, BootAffinity affinity) {
+    if (m_started) {
+        return OS_ERROR_BUSY;
+    }
+    if (!name || !function || findStage(name) >= 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Dependencies must already exist, which also keeps the graph acyclic
+    std::vector<int> parents;
+    for (const char* dependency : dependencies) {
+        int parent = findStage(dependency);
+        if (parent < 0) {
+            ESP_LOGE(TAG, "Stage '%s' depends on unknown stage '%s'", name, dependency ? dependency : "");
+            return OS_ERROR_INVALID_PARAM;
+        }
+        parents.push_back(parent);
+    }
+
+    Stage stage;
+    stage.name = name;
+    stage.function = function;
+    stage.affinity = affinity;
+    stage.state = StageState::PENDING;
+    stage.dependencies = (uint16_t)parents.size();
+    stage.waiting = stage.dependencies;
+    stage.startUs = 0;
+    stage.endUs = 0;
+    stage.core = -1;
+    stage.result = OS_OK;
+    m_stages.push_back(stage);
+
+    uint16_t index = (uint16_t)(m_stages.size() - 1);
+    for (int parent : parents) {
+        m_stages[parent].dependents.push_back(index);
+    }
+    return OS_OK;
+}
+
+os_error_t BootGraph::run() {
+    if (m_started) {
+        return OS_ERROR_BUSY;
+    }
+
+    m_mutex = xSemaphoreCreateMutex();
+    m_wake = xSemaphoreCreateBinary();
+    if (!m_mutex || !m_wake) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_started = true;
+    m_startUs = esp_timer_get_time();
+    m_unfinished = m_stages.size();
+
+    std::vector<uint16_t> ready;
+    for (uint16_t i = 0; i < m_stages.size(); i++) {
+        if (m_stages[i].dependencies == 0) {
+            m_stages[i].state = StageState::READY;
+            ready.push_back(i);
+        }
+    }
+    dispatch(ready);
+
+    // Run main-task stages as they become ready until every stage is done
+    while (true) {
+        lock();
+        if (m_unfinished == 0) {
+            unlock();
+            break;
+        }
+        if (!m_mainQueue.empty()) {
+            uint16_t index = m_mainQueue.front();
+            m_mainQueue.erase(m_mainQueue.begin());
+            unlock();
+            execute(index);
+            continue;
+        }
+        unlock();
+        xSemaphoreTake(m_wake, pdMS_TO_TICKS(100));
+    }
+
+    m_totalUs = (uint32_t)(esp_timer_get_time() - m_startUs);
+    return m_firstError;
+}
+
+void BootGraph::dispatch(const std::vector<uint16_t>& ready) {
+    bool workers = m_pool && m_pool->getWorkerCount() > 0;
+
+    for (uint16_t index : ready) {
+        Stage& stage = m_stages[index];
+        if (stage.affinity == BootAffinity::WORKER && workers &&
+            m_pool->submit([this, index]() { execute(index); }, nullptr, WorkerPool::ANY_CORE, stage.name) != 0) {
+            continue;
+        }
+
+        // MAIN stages, and WORKER stages with nowhere else to go
+        lock();
+        m_mainQueue.push_back(index);
+        unlock();
+        xSemaphoreGive(m_wake);
+    }
+}
+
+void BootGraph::execute(uint16_t index) {
+    Stage& stage = m_stages[index];
+
+    lock();
+    stage.state = StageState::RUNNING;
+    stage.core = (int8_t)xPortGetCoreID();
+    stage.startUs = esp_timer_get_time();
+    unlock();
+
+    os_error_t result = stage.function();
+
+    std::vector<uint16_t> ready;
+    lock();
+    stage.endUs = esp_timer_get_time();
+    stage.result = result;
+    finish(index, ready);
+    unlock();
+
+    if (result != OS_OK) {
+        ESP_LOGE(TAG, "Boot stage '%s' failed: %d", stage.name, result);
+    }
+
+    xSemaphoreGive(m_wake);
+    dispatch(ready);
+}
+
+void BootGraph::finish(uint16_t index, std::vector<uint16_t>& ready) {
+    Stage& stage = m_stages[index];
+    stage.state = stage.result == OS_OK ? StageState::DONE : StageState::FAILED;
+    m_unfinished--;
+
+    if (stage.result != OS_OK) {
+        if (m_firstError == OS_OK) {
+            m_firstError = stage.result;
+        }
+        for (uint16_t dependent : stage.dependents) {
+            skip(dependent);
+        }
+        return;
+    }
+
+    for (uint16_t dependent : stage.dependents) {
+        Stage& next = m_stages[dependent];
+        if (next.state == StageState::PENDING && --next.waiting == 0) {
+            next.state = StageState::READY;
+            ready.push_back(dependent);
+        }
+    }
+}
+
+void BootGraph::skip(uint16_t index) {
+    Stage& stage = m_stages[index];
+    if (stage.state != StageState::PENDING) {
+        return;
+    }
+
+    ESP_LOGW(TAG, "Skipping boot stage '%s'", stage.name);
+    stage.state = StageState::SKIPPED;
+    stage.result = OS_ERROR_CANCELLED;
+    m_unfinished--;
+    for (uint16_t dependent : stage.dependents) {
+        skip(dependent);
+    }
+}
+
+bool BootGraph::isDone(const char* name) const {
+    int index = findStage(name);
+    if (index < 0) {
+        return false;
+    }
+
+    lock();
+    StageState state = m_stages[index].state;
+    unlock();
+    return state == StageState::DONE || state == StageState::FAILED || state == StageState::SKIPPED;
+}
+
+uint32_t BootGraph::getFinishedAtUs(const char* name) const {
+    int index = findStage(name);
+    if (index < 0 || !isDone(name) || m_stages[index].endUs == 0) {
+        return 0;
+    }
+    return (uint32_t)(m_stages[index].endUs - m_startUs);
+}
+
+bool BootGraph::getStageTiming(size_t index, BootStageTiming& timing) const {
+    if (index >= m_stages.size()) {
+        return false;
+    }
+
+    lock();
+    const Stage& stage = m_stages[index];
+    bool ran = stage.endUs != 0;
+    timing.name = stage.name;
+    timing.startUs = ran ? (uint32_t)(stage.startUs - m_startUs) : 0;
+    timing.durationUs = ran ? (uint32_t)(stage.endUs - stage.startUs) : 0;
+    timing.core = ran ? stage.core : -1;
+    timing.result = stage.result;
+    timing.skipped = stage.state == StageState::SKIPPED;
+    unlock();
+    return true;
+}
+
+void BootGraph::printTimeline(const char* tag) const {
+    std::vector<BootStageTiming> timeline(m_stages.size());
+    uint64_t workUs = 0;
+    for (size_t i = 0; i < m_stages.size(); i++) {
+        getStageTiming(i, timeline[i]);
+        workUs += timeline[i].durationUs;
+    }
+    std::stable_sort(timeline.begin(), timeline.end(),
+                     [](const BootStageTiming& a, const BootStageTiming& b) {
+                         return a.core >= 0 && (b.core < 0 || a.startUs < b.startUs);
+                     });
+
+    // Work over wall time is how much the stages overlapped
+    uint32_t totalUs = std::max<uint32_t>(m_totalUs, 1);
+    ESP_LOGI(tag, "=== Boot Timeline: %d stages in %d ms, %d ms of work (%d.%dx) ===",
+             m_stages.size(), m_totalUs / 1000, (int)(workUs / 1000),
+             (int)(workUs / totalUs), (int)(workUs * 10 / totalUs % 10));
+
+    for (const BootStageTiming& timing : timeline) {
+        char bar[TIMELINE_WIDTH + 1];
+        memset(bar, '.', TIMELINE_WIDTH);
+        bar[TIMELINE_WIDTH] = '\0';
+        if (timing.core >= 0) {
+            size_t first = (size_t)((uint64_t)timing.startUs * TIMELINE_WIDTH / totalUs);
+            size_t last = (size_t)((uint64_t)(timing.startUs + timing.durationUs) * TIMELINE_WIDTH / totalUs);
+            first = std::min(first, TIMELINE_WIDTH - 1);
+            last = std::min(std::max(last, first + 1), TIMELINE_WIDTH);
+            memset(bar + first, '#', last - first);
+        }
+
+        if (timing.core < 0) {
+            ESP_LOGI(tag, "%-12s |%s| %s", timing.name, bar, timing.skipped ? "skipped" : "not run");
+        } else {
+            ESP_LOGI(tag, "%-12s |%s| %5d +%5d ms core %d%s", timing.name, bar,
+                     timing.startUs / 1000, timing.durationUs / 1000, timing.core,
+                     timing.result != OS_OK ? " FAILED" : "");
+        }
+    }
+}
+
+int BootGraph::findStage(const char* name) const {
+    if (!name) {
+        return -1;
+    }
+    for (size_t i = 0; i < m_stages.size(); i++) {
+        if (strcmp(m_stages[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void BootGraph::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void BootGraph::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
@@ -0,0 +1,178 @@
+#ifndef BOOT_GRAPH_H
+#define BOOT_GRAPH_H
+
+#include "os_config.h"
+#include "worker_pool.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include <vector>
+
+/**
+ * @file boot_graph.h
+ * @brief Dependency-ordered, parallel subsystem start-up
+ *
+ * Each stage names the stages it needs. run() starts every stage whose
+ * dependencies are done: MAIN stages on the calling task (LVGL and
+ * anything else that must stay on the main loop's task), WORKER stages on
+ * the scheduler's WorkerPool, one worker per HP core. Until a pool is
+ * attached with setWorkerPool() WORKER stages run on the calling task as
+ * well, so the graph degrades to a plain ordered boot.
+ *
+ * A failed stage skips everything that depends on it; independent stages
+ * still run, and run() returns the first error. Start and end times of
+ * every stage are kept for the boot timeline.
+ */
+
+enum class BootAffinity : uint8_t {
+    MAIN,       // Calling task
+    WORKER      // Worker pool, either core
+};
+
+typedef std::function<os_error_t()> BootFunction;
+
+/**
+ * @brief Timing of one stage, relative to the start of run()
+ */
+struct BootStageTiming {
+    const char* name;
+    uint32_t startUs;
+    uint32_t durationUs;
+    int8_t core;            // -1 if the stage did not run
+    os_error_t result;
+    bool skipped;           // A dependency failed
+};
+
+class BootGraph {
+public:
+    BootGraph() = default;
+    ~BootGraph();
+
+    BootGraph(const BootGraph&) = delete;
+    BootGraph& operator=(const BootGraph&) = delete;
+
+    /**
+     * @brief Add a stage
+     * @param name Static stage name
+     * @param function Initialises the component
+     * @param dependencies Names of stages added earlier that must finish first
+     * @param affinity Where the stage may run
+     * @return OS_OK, OS_ERROR_INVALID_PARAM for an unknown dependency or a
+     *         duplicate name, OS_ERROR_BUSY once run() has been called
+     */
+    os_error_t addStage(const char* name, BootFunction function,
+                        const std::vector<const char*>& dependencies = {},
+                        BootAffinity affinity = BootAffinity::MAIN);
+
+    /**
+     * @brief Attach the pool whose workers run WORKER stages
+     *
+     * Usually called by the stage that initialises the scheduler.
+     * @param pool Running pool, or nullptr to run everything inline
+     */
+    void setWorkerPool(WorkerPool* pool) { m_pool = pool; }
+
+    /**
+     * @brief Run every stage and wait for all of them
+     * @return OS_OK, or the first stage error
+     */
+    os_error_t run();
+
+    /**
+     * @brief Check if a stage has finished (with or without success)
+     * @param name Stage name
+     * @return true if finished or skipped
+     */
+    bool isDone(const char* name) const;
+
+    /**
+     * @brief Get the time from the start of run() until the last stage finished
+     * @return Microseconds, 0 before run() returns
+     */
+    uint32_t getTotalUs() const { return m_totalUs; }
+
+    /**
+     * @brief Get the time from the start of run() until a stage finished
+     * @param name Stage name
+     * @return Microseconds, 0 if the stage has not finished
+     */
+    uint32_t getFinishedAtUs(const char* name) const;
+
+    size_t getStageCount() const { return m_stages.size(); }
+
+    /**
+     * @brief Get the timing of a stage
+     * @param index Stage index, in order of addStage()
+     * @param timing Output timing
+     * @return true if the stage exists
+     */
+    bool getStageTiming(size_t index, BootStageTiming& timing) const;
+
+    /**
+     * @brief Log the boot timeline: one line and bar per stage, in start order
+     * @param tag Log tag of the owner
+     */
+    void printTimeline(const char* tag) const;
+
+private:
+    enum class StageState : uint8_t {
+        PENDING,
+        READY,
+        RUNNING,
+        DONE,
+        FAILED,
+        SKIPPED
+    };
+
+    struct Stage {
+        const char* name;
+        BootFunction function;
+        BootAffinity affinity;
+        StageState state;
+        uint16_t dependencies;
+        uint16_t waiting;
+        std::vector<uint16_t> dependents;
+        int64_t startUs;
+        int64_t endUs;
+        int8_t core;
+        os_error_t result;
+    };
+
+    int findStage(const char* name) const;
+
+    /**
+     * @brief Hand ready stages to a worker or to the calling task's queue
+     * @param ready Stage indices whose dependencies are done
+     */
+    void dispatch(const std::vector<uint16_t>& ready);
+
+    /**
+     * @brief Run a stage and record its completion (any task)
+     * @param index Stage index
+     */
+    void execute(uint16_t index);
+
+    /**
+     * @brief Mark a stage finished and release or skip its dependents (under the lock)
+     * @param index Stage index
+     * @param ready Appended with dependents that became ready
+     */
+    void finish(uint16_t index, std::vector<uint16_t>& ready);
+
+    void skip(uint16_t index);
+    void lock() const;
+    void unlock() const;
+
+    std::vector<Stage> m_stages;
+    std::vector<uint16_t> m_mainQueue;      // Ready stages for the calling task
+    WorkerPool* m_pool = nullptr;
+    SemaphoreHandle_t m_mutex = nullptr;
+    SemaphoreHandle_t m_wake = nullptr;     // Given whenever a stage finishes
+    size_t m_unfinished = 0;
+    os_error_t m_firstError = OS_OK;
+    int64_t m_startUs = 0;
+    uint32_t m_totalUs = 0;
+    bool m_started = false;
+};
+
+#endif // BOOT_GRAPH_H
@@ -0,0 +1,142 @@
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @file byte_ring.h
+ * @brief Lock-free single-producer single-consumer byte ring
+ *
+ * Stream counterpart of EventRing for serial data: one task writes, one
+ * task reads, and neither blocks. Storage is supplied by the owner so it
+ * can live in PSRAM; capacity must be a power of two. Head and tail run
+ * freely and are masked on access, so all capacity bytes are usable.
+ */
+
+class ByteRing {
+public:
+    ByteRing() = default;
+
+    /**
+     * @brief Attach storage and reset to empty (no reader or writer active)
+     * @param storage Buffer of capacity bytes, owned by the caller
+     * @param capacity Buffer size, a power of two
+     * @return true on success, false if capacity is not a power of two
+     */
+    bool init(uint8_t* storage, size_t capacity) {
+        if (!storage || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            return false;
+        }
+        m_data = storage;
+        m_capacity = capacity;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Append bytes (producer only)
+     * @param data Source bytes
+     * @param length Number of bytes
+     * @return Bytes written; less than length if the ring filled up
+     */
+    size_t write(const uint8_t* data, size_t length) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        size_t count = std::min(length, m_capacity - (size_t)(tail - head));
+        copyIn(tail, data, count);
+        m_tail.store(tail + (uint32_t)count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Remove up to maxLength bytes (consumer only)
+     * @param out Destination buffer
+     * @param maxLength Destination size
+     * @return Bytes read
+     */
+    size_t read(uint8_t* out, size_t maxLength) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        size_t count = std::min(maxLength, (size_t)(tail - head));
+        copyOut(head, out, count);
+        m_head.store(head + (uint32_t)count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Copy up to maxLength bytes without removing them (consumer only)
+     * @param out Destination buffer
+     * @param maxLength Destination size
+     * @return Bytes copied
+     */
+    size_t peek(uint8_t* out, size_t maxLength) const {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        size_t count = std::min(maxLength, (size_t)(tail - head));
+        copyOut(head, out, count);
+        return count;
+    }
+
+    /**
+     * @brief Remove bytes already seen with peek() (consumer only)
+     * @param count Bytes to drop, at most available()
+     */
+    void consume(size_t count) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        m_head.store(head + (uint32_t)std::min(count, available()), std::memory_order_release);
+    }
+
+    /**
+     * @brief Bytes waiting to be read
+     * @return Byte count
+     */
+    size_t available() const {
+        return (size_t)(m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Bytes that can be written without dropping
+     * @return Byte count
+     */
+    size_t space() const { return m_capacity - available(); }
+
+    /**
+     * @brief Get ring capacity
+     * @return Capacity in bytes
+     */
+    size_t capacity() const { return m_capacity; }
+
+    /**
+     * @brief Discard all data (no reader or writer active)
+     */
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    void copyIn(uint32_t pos, const uint8_t* data, size_t count) {
+        size_t offset = pos & (m_capacity - 1);
+        size_t first = std::min(count, m_capacity - offset);
+        memcpy(m_data + offset, data, first);
+        memcpy(m_data, data + first, count - first);
+    }
+
+    void copyOut(uint32_t pos, uint8_t* out, size_t count) const {
+        size_t offset = pos & (m_capacity - 1);
+        size_t first = std::min(count, m_capacity - offset);
+        memcpy(out, m_data + offset, first);
+        memcpy(out + first, m_data, count - first);
+    }
+
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0;
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+};
+
+#endif // BYTE_RING_H
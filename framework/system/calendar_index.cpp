@@ -0,0 +1,241 @@
+#include "calendar_index.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <climits>
+
+static constexpr uint32_t MAX_OCCURRENCE_STEPS = 1000;    // Guard for malformed series
+
+static int64_t durationOf(const CalendarEvent& event) {
+    return std::max<int64_t>((int64_t)event.endTime - event.startTime, 1);
+}
+
+static int64_t nominalPeriod(const CalendarEvent& event) {
+    int64_t interval = std::max<uint16_t>(event.recurrenceInterval, 1);
+    switch (event.recurrence) {
+        case EventRecurrence::DAILY:   return 86400LL * interval;
+        case EventRecurrence::WEEKLY:  return 604800LL * interval;
+        case EventRecurrence::MONTHLY: return 2629746LL * interval;    // Mean Gregorian month
+        case EventRecurrence::YEARLY:  return 31556952LL * interval;
+        default:                       return 0;
+    }
+}
+
+std::time_t CalendarIndex::occurrenceStart(const CalendarEvent& event, uint32_t n) {
+    if (event.recurrence == EventRecurrence::NONE || n == 0) {
+        return event.startTime;
+    }
+
+    // In local time, so a series keeps its wall-clock time across DST; a day
+    // a month does not have rolls over, as mktime() normalises it
+    int steps = (int)n * std::max<uint16_t>(event.recurrenceInterval, 1);
+    struct tm local;
+    localtime_r(&event.startTime, &local);
+    switch (event.recurrence) {
+        case EventRecurrence::DAILY:   local.tm_mday += steps; break;
+        case EventRecurrence::WEEKLY:  local.tm_mday += 7 * steps; break;
+        case EventRecurrence::MONTHLY: local.tm_mon += steps; break;
+        case EventRecurrence::YEARLY:  local.tm_year += steps; break;
+        default: break;
+    }
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+bool CalendarIndex::firstOccurrenceAfter(const CalendarEvent& event, std::time_t after, uint32_t& n) {
+    int64_t duration = durationOf(event);
+    if (event.recurrence == EventRecurrence::NONE) {
+        n = 0;
+        return event.startTime + duration > after;
+    }
+
+    // Jump close by the nominal period, step back past any overshoot, then forward
+    n = 0;
+    int64_t gap = (int64_t)after - duration - event.startTime;
+    if (gap > 0) {
+        n = (uint32_t)std::min<int64_t>(gap / nominalPeriod(event), UINT32_MAX - MAX_OCCURRENCE_STEPS);
+    }
+    for (uint32_t i = 0; i < MAX_OCCURRENCE_STEPS && n > 0 && occurrenceStart(event, n) + duration > after; i++) {
+        n--;
+    }
+    for (uint32_t i = 0; i < MAX_OCCURRENCE_STEPS; i++, n++) {
+        std::time_t start = occurrenceStart(event, n);
+        if (event.recurrenceUntil != 0 && start > event.recurrenceUntil) {
+            return false;
+        }
+        if (start + duration > after) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CalendarIndex::rebuild(const std::vector<CalendarEvent>& events) {
+    m_spans.clear();
+    m_spans.reserve(events.size());
+    for (size_t i = 0; i < events.size(); i++) {
+        const CalendarEvent& event = events[i];
+        int64_t duration = durationOf(event);
+        int64_t end = event.startTime + duration;
+        if (event.recurrence != EventRecurrence::NONE) {
+            end = event.recurrenceUntil != 0 ? (int64_t)event.recurrenceUntil + duration : INT64_MAX;
+        }
+        m_spans.push_back({(int64_t)event.startTime, end, end, (uint32_t)i});
+    }
+    std::sort(m_spans.begin(), m_spans.end(),
+              [](const Span& a, const Span& b) { return a.start < b.start; });
+
+    // Leaves sit at even positions; the node at level k has k trailing one
+    // bits. The rightmost nodes of an incomplete tree take their right
+    // child's value from the last node that exists.
+    int64_t n = (int64_t)m_spans.size();
+    if (n == 0) {
+        m_rootLevel = -1;
+        return;
+    }
+    int64_t lastIndex = 0;
+    int64_t last = 0;
+    for (int64_t i = 0; i < n; i += 2) {
+        lastIndex = i;
+        last = m_spans[i].maxEnd = m_spans[i].end;
+    }
+    int k = 1;
+    for (; (1LL << k) <= n; k++) {
+        int64_t x = 1LL << (k - 1);
+        for (int64_t i = (x << 1) - 1; i < n; i += x << 2) {
+            int64_t left = m_spans[i - x].maxEnd;
+            int64_t right = i + x < n ? m_spans[i + x].maxEnd : last;
+            m_spans[i].maxEnd = std::max({m_spans[i].end, left, right});
+        }
+        lastIndex = (lastIndex >> k & 1) ? lastIndex - x : lastIndex + x;
+        if (lastIndex < n && m_spans[lastIndex].maxEnd > last) {
+            last = m_spans[lastIndex].maxEnd;
+        }
+    }
+    m_rootLevel = k - 1;
+}
+
+void CalendarIndex::query(const std::vector<CalendarEvent>& events, std::time_t from, std::time_t to,
+                          std::vector<CalendarOccurrence>& out) const {
+    out.clear();
+    m_lastVisited = 0;
+    int64_t n = (int64_t)m_spans.size();
+    if (n == 0 || from >= to) {
+        m_lastOccurrences = 0;
+        return;
+    }
+
+    // Top-down walk; a subtree is skipped when everything in it ends by
+    // 'from', and the walk stops at the first start at or after 'to'
+    struct Frame {
+        int64_t x;
+        int k;
+        bool leftDone;
+    };
+    Frame stack[64];
+    int top = 0;
+    std::vector<uint32_t> hits;
+    stack[top++] = {(1LL << m_rootLevel) - 1, m_rootLevel, false};
+    while (top > 0) {
+        Frame z = stack[--top];
+        if (z.k <= 3) {
+            // Small subtree: a linear scan is cheaper than descending
+            int64_t i0 = z.x >> z.k << z.k;
+            int64_t i1 = std::min<int64_t>(i0 + (1LL << (z.k + 1)) - 1, n);
+            for (int64_t i = i0; i < i1 && m_spans[i].start < to; i++) {
+                m_lastVisited++;
+                if (from < m_spans[i].end) {
+                    hits.push_back((uint32_t)i);
+                }
+            }
+        } else if (!z.leftDone) {
+            int64_t y = z.x - (1LL << (z.k - 1));
+            stack[top++] = {z.x, z.k, true};
+            if (y >= n || m_spans[y].maxEnd > from) {
+                stack[top++] = {y, z.k - 1, false};
+            }
+        } else if (z.x < n && m_spans[z.x].start < to) {
+            m_lastVisited++;
+            if (from < m_spans[z.x].end) {
+                hits.push_back((uint32_t)z.x);
+            }
+            stack[top++] = {z.x + (1LL << (z.k - 1)), z.k - 1, false};
+        }
+    }
+
+    // Expand series only across the range asked for
+    for (uint32_t hit : hits) {
+        const CalendarEvent& event = events[m_spans[hit].event];
+        int64_t duration = durationOf(event);
+        uint32_t occurrence;
+        if (!firstOccurrenceAfter(event, from, occurrence)) {
+            continue;
+        }
+        for (uint32_t i = 0; i < MAX_OCCURRENCE_STEPS; i++, occurrence++) {
+            std::time_t start = occurrenceStart(event, occurrence);
+            if (start >= to || (event.recurrenceUntil != 0 && start > event.recurrenceUntil)) {
+                break;
+            }
+            out.push_back({&event, start, (std::time_t)(start + duration)});
+            if (event.recurrence == EventRecurrence::NONE) {
+                break;
+            }
+        }
+    }
+    std::stable_sort(out.begin(), out.end(), [](const CalendarOccurrence& a, const CalendarOccurrence& b) {
+        return a.start < b.start;
+    });
+    m_lastOccurrences = out.size();
+}
+
+void CalendarIndex::printStats(const char* tag) const {
+    ESP_LOGI(tag, "Calendar index: %d spans, depth %d; last query visited %d for %d occurrences",
+             m_spans.size(), m_rootLevel + 1, m_lastVisited, m_lastOccurrences);
+}
+
+void ReminderQueue::rebuild(const std::vector<CalendarEvent>& events, std::time_t now) {
+    m_heap.clear();
+    for (size_t i = 0; i < events.size(); i++) {
+        const CalendarEvent& event = events[i];
+        if (!event.hasReminder) {
+            continue;
+        }
+
+        // First occurrence whose reminder is at most a minute old: its start
+        // is after now - 60 + lead, i.e. it ends after that plus its duration
+        int64_t lead = (int64_t)event.reminderMinutes * 60;
+        uint32_t occurrence;
+        if (CalendarIndex::firstOccurrenceAfter(event, now - 61 + lead + durationOf(event), occurrence)) {
+            schedule(event, (uint32_t)i, occurrence);
+        }
+    }
+}
+
+bool ReminderQueue::takeDue(const std::vector<CalendarEvent>& events, std::time_t now,
+                            CalendarOccurrence& occurrence, std::time_t& reminderTime) {
+    if (m_heap.empty() || m_heap.front().when > now) {
+        return false;
+    }
+
+    auto later = [](const Entry& a, const Entry& b) { return a.when > b.when; };
+    std::pop_heap(m_heap.begin(), m_heap.end(), later);
+    Entry entry = m_heap.back();
+    m_heap.pop_back();
+
+    const CalendarEvent& event = events[entry.event];
+    std::time_t start = CalendarIndex::occurrenceStart(event, entry.occurrence);
+    occurrence = {&event, start, (std::time_t)(start + durationOf(event))};
+    reminderTime = entry.when;
+    if (event.recurrence != EventRecurrence::NONE) {
+        schedule(event, entry.event, entry.occurrence + 1);
+    }
+    return true;
+}
+
+void ReminderQueue::schedule(const CalendarEvent& event, uint32_t index, uint32_t occurrence) {
+    std::time_t start = CalendarIndex::occurrenceStart(event, occurrence);
+    if (event.recurrenceUntil != 0 && start > event.recurrenceUntil) {
+        return;
+    }
+    m_heap.push_back({(std::time_t)(start - (int64_t)event.reminderMinutes * 60), index, occurrence});
+    std::push_heap(m_heap.begin(), m_heap.end(), [](const Entry& a, const Entry& b) { return a.when > b.when; });
+}
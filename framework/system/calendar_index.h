@@ -0,0 +1,162 @@
+#ifndef CALENDAR_INDEX_H
+#define CALENDAR_INDEX_H
+
+#include "os_config.h"
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * @file calendar_index.h
+ * @brief Range queries and reminder scheduling over calendar events
+ *
+ * CalendarIndex keeps one span per event, from its first start to the end
+ * of its last occurrence (open-ended for a series without an end), sorted
+ * by start and laid out as an implicit interval tree: every odd position
+ * is an internal node holding the latest end below it, so a range query
+ * visits O(log n + k) spans and yields them in start order. A recurring
+ * event is a single span; its occurrences are expanded only for the range
+ * asked for, jumping straight to the first one inside it.
+ *
+ * ReminderQueue is a min-heap of the next reminder time of every event, so
+ * checking for due reminders is a look at the top until one is due; firing
+ * a recurring event's reminder pushes the one for its next occurrence.
+ *
+ * Both are rebuilt from the event list when it changes and hold indices
+ * into it; they belong to the thread that owns the events.
+ */
+
+enum class EventRecurrence : uint8_t {
+    NONE,
+    DAILY,
+    WEEKLY,
+    MONTHLY,
+    YEARLY
+};
+
+struct CalendarEvent {
+    std::string id;
+    std::string title;
+    std::string description;
+    std::time_t startTime;
+    std::time_t endTime;
+    std::string location;
+    bool isAllDay;
+    bool hasReminder;
+    uint32_t reminderMinutes;
+    std::string category;
+    uint32_t color;
+    EventRecurrence recurrence = EventRecurrence::NONE;
+    uint16_t recurrenceInterval = 1;    // Every n days, weeks, months or years
+    std::time_t recurrenceUntil = 0;    // Last occurrence starts no later; 0 repeats forever
+};
+
+/**
+ * @brief One occurrence of an event; points into the event list
+ */
+struct CalendarOccurrence {
+    const CalendarEvent* event;
+    std::time_t start;
+    std::time_t end;
+};
+
+class CalendarIndex {
+public:
+    CalendarIndex() = default;
+
+    /**
+     * @brief Index an event list
+     * @param events Events; must stay unchanged until the next rebuild
+     */
+    void rebuild(const std::vector<CalendarEvent>& events);
+
+    /**
+     * @brief Find the occurrences overlapping a time range
+     * @param events The list last indexed
+     * @param from Range start
+     * @param to Range end (exclusive)
+     * @param out Filled with occurrences sorted by start
+     */
+    void query(const std::vector<CalendarEvent>& events, std::time_t from, std::time_t to,
+               std::vector<CalendarOccurrence>& out) const;
+
+    /**
+     * @brief Get the start of an event's n-th occurrence
+     * @param event Event
+     * @param n Occurrence number, 0 for the first
+     * @return Start time
+     */
+    static std::time_t occurrenceStart(const CalendarEvent& event, uint32_t n);
+
+    /**
+     * @brief Find an event's first occurrence ending after a time
+     * @param event Event
+     * @param after Time
+     * @param n Set to the occurrence number
+     * @return false if the event has no such occurrence
+     */
+    static bool firstOccurrenceAfter(const CalendarEvent& event, std::time_t after, uint32_t& n);
+
+    /**
+     * @brief Print index size and the last query cost
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    struct Span {
+        int64_t start;
+        int64_t end;
+        int64_t maxEnd;                 // Latest end in the subtree rooted here
+        uint32_t event;
+    };
+
+    std::vector<Span> m_spans;          // Sorted by start
+    int m_rootLevel = -1;
+
+    // Statistics
+    mutable uint32_t m_lastVisited = 0;
+    mutable uint32_t m_lastOccurrences = 0;
+};
+
+class ReminderQueue {
+public:
+    /**
+     * @brief Schedule the next reminder of every event
+     * @param events Event list; must stay unchanged until the next rebuild
+     * @param now Current time; reminders before it are not scheduled
+     */
+    void rebuild(const std::vector<CalendarEvent>& events, std::time_t now);
+
+    /**
+     * @brief Take the next reminder if it is due
+     * @param events The list last scheduled
+     * @param now Current time
+     * @param occurrence Set to the occurrence the reminder is for
+     * @param reminderTime Set to when the reminder was due
+     * @return true if a reminder was taken
+     */
+    bool takeDue(const std::vector<CalendarEvent>& events, std::time_t now,
+                 CalendarOccurrence& occurrence, std::time_t& reminderTime);
+
+    /**
+     * @brief Get the next reminder time
+     * @return Time, or 0 when nothing is scheduled
+     */
+    std::time_t nextTime() const { return m_heap.empty() ? 0 : m_heap.front().when; }
+
+    size_t size() const { return m_heap.size(); }
+
+private:
+    struct Entry {
+        std::time_t when;
+        uint32_t event;
+        uint32_t occurrence;
+    };
+
+    void schedule(const CalendarEvent& event, uint32_t index, uint32_t occurrence);
+
+    std::vector<Entry> m_heap;
+};
+
+#endif // CALENDAR_INDEX_H
@@ -0,0 +1,283 @@
+#include "chat_stream.h"
+#include "os_manager.h"
+#include <cJSON.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "ChatStream";
+
+static uint32_t elapsedMs(int64_t sinceUs) {
+    return (uint32_t)((esp_timer_get_time() - sinceUs) / 1000);
+}
+
+ChatStream::~ChatStream() {
+    cancel();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+void ChatStream::addMessage(const char* role, const std::string& content) {
+    cJSON* message = cJSON_CreateObject();
+    if (!message) {
+        return;
+    }
+    cJSON_AddStringToObject(message, "role", role);
+    cJSON_AddStringToObject(message, "content", content.c_str());
+    char* json = cJSON_PrintUnformatted(message);
+    if (json) {
+        if (!m_messages.empty()) {
+            m_messages += ',';
+        }
+        m_messages += json;
+        cJSON_free(json);
+    }
+    cJSON_Delete(message);
+}
+
+os_error_t ChatStream::start(HttpsSession* session, const std::string& apiKey) {
+    if (!session || apiKey.empty() || m_messages.empty()) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    if (m_task) {
+        return OS_ERROR_BUSY;
+    }
+
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+    }
+    if (!m_buffer) {
+        m_buffer = (char*)OS_MALLOC(OS_HTTPS_BUFFER_SIZE);
+    }
+    if (!m_line) {
+        m_line = (char*)OS_MALLOC(OS_LLM_MAX_LINE + 1);
+    }
+    if (!m_mutex || !m_buffer || !m_line) {
+        ESP_LOGE(TAG, "Failed to allocate stream buffers");
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_body = "{\"model\":\"" OS_LLM_MODEL "\",\"stream\":true,\"messages\":[" + m_messages + "]}";
+    m_messages.clear();
+    m_session = session;
+    m_apiKey = apiKey;
+    m_lineLength = 0;
+    m_lineOverflow = false;
+    m_streamDone = false;
+    m_stats = {};
+    m_startUs = esp_timer_get_time();
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_pending.clear();
+    m_error.clear();
+    xSemaphoreGive(m_mutex);
+
+    m_cancelled = false;
+    m_state.store(ChatStreamState::CONNECTING, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(streamTask, "chat_stream", OS_LLM_TASK_STACK, this,
+                                OS_LLM_TASK_PRIORITY, &m_task, OS_LLM_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        m_task = nullptr;
+        m_state.store(ChatStreamState::IDLE, std::memory_order_release);
+        return OS_ERROR_NO_MEMORY;
+    }
+    return OS_OK;
+}
+
+void ChatStream::cancel() {
+    if (m_task) {
+        m_cancelled = true;
+        for (int i = 0; i < 50 && m_task; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Stream task did not exit, deleting it");
+            vTaskDelete(m_task);
+            m_task = nullptr;
+        }
+    }
+    m_messages.clear();
+    m_body.clear();
+    if (m_buffer) {
+        OS_FREE(m_buffer);
+        m_buffer = nullptr;
+    }
+    if (m_line) {
+        OS_FREE(m_line);
+        m_line = nullptr;
+    }
+    m_state.store(ChatStreamState::IDLE, std::memory_order_release);
+}
+
+bool ChatStream::isFinished() const {
+    ChatStreamState state = getState();
+    return state == ChatStreamState::DONE || state == ChatStreamState::ERROR;
+}
+
+bool ChatStream::takeTokens(std::string& text) {
+    if (!m_mutex) {
+        return false;
+    }
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    bool any = !m_pending.empty();
+    text += m_pending;
+    m_pending.clear();
+    xSemaphoreGive(m_mutex);
+    return any;
+}
+
+std::string ChatStream::getError() {
+    if (!m_mutex) {
+        return std::string();
+    }
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    std::string error = m_error;
+    xSemaphoreGive(m_mutex);
+    return error;
+}
+
+void ChatStream::run() {
+    uint32_t reusedBefore = m_session->getStats().reused;
+    os_error_t result = m_session->begin(OS_LLM_PATH, "application/json", (int)m_body.size(),
+                                         m_apiKey, "text/event-stream");
+    if (result != OS_OK) {
+        setError(result == OS_ERROR_BUSY ? "Assistant busy" : "Could not reach the assistant");
+        return;
+    }
+    m_stats.reusedConnection = m_session->getStats().reused != reusedBefore;
+
+    bool ok = m_session->write(m_body.data(), m_body.size());
+    m_stats.httpStatus = ok ? m_session->fetchResponse() : -1;
+    m_state.store(ChatStreamState::WAITING, std::memory_order_release);
+
+    if (m_stats.httpStatus == 200) {
+        ok = readEvents();
+        if (ok) {
+            m_stats.totalMs = elapsedMs(m_startUs);
+            m_state.store(ChatStreamState::DONE, std::memory_order_release);
+            ESP_LOGI(TAG, "First token %d ms, %d tokens in %d ms (%s connection)",
+                     m_stats.ttftMs, m_stats.tokens, m_stats.totalMs,
+                     m_stats.reusedConnection ? "reused" : "new");
+        } else if (!m_cancelled) {
+            setError("Reply interrupted");
+        }
+    } else if (m_stats.httpStatus > 0) {
+        // Errors come back as one JSON document rather than an event stream
+        int length = 0;
+        while (length < OS_LLM_MAX_LINE) {
+            int received = m_session->read(m_line + length, OS_LLM_MAX_LINE - length);
+            if (received <= 0) {
+                break;
+            }
+            length += received;
+        }
+        m_line[length] = '\0';
+        cJSON* root = cJSON_Parse(m_line);
+        cJSON* error = root ? cJSON_GetObjectItem(root, "error") : nullptr;
+        cJSON* message = error ? cJSON_GetObjectItem(error, "message") : nullptr;
+        char fallback[32];
+        snprintf(fallback, sizeof(fallback), "Assistant error %d", m_stats.httpStatus);
+        setError(cJSON_IsString(message) ? message->valuestring : fallback);
+        cJSON_Delete(root);
+        ESP_LOGW(TAG, "Chat request failed: HTTP %d", m_stats.httpStatus);
+    } else {
+        ok = false;
+        setError("Could not reach the assistant");
+    }
+
+    m_session->end(ok && !m_cancelled);
+}
+
+bool ChatStream::readEvents() {
+    while (!m_streamDone && !m_cancelled) {
+        int received = m_session->read(m_buffer, OS_HTTPS_BUFFER_SIZE);
+        if (received < 0) {
+            return false;
+        }
+        if (received == 0) {
+            break;
+        }
+        m_stats.bytes += received;
+
+        // Events may split anywhere across reads; assemble lines as they complete
+        for (int i = 0; i < received && !m_streamDone; i++) {
+            char c = m_buffer[i];
+            if (c != '\n') {
+                if (m_lineLength < OS_LLM_MAX_LINE) {
+                    m_line[m_lineLength++] = c;
+                } else {
+                    m_lineOverflow = true;
+                }
+                continue;
+            }
+            if (m_lineLength > 0 && m_line[m_lineLength - 1] == '\r') {
+                m_lineLength--;
+            }
+            if (m_lineOverflow) {
+                ESP_LOGW(TAG, "Dropped an event over %d bytes", OS_LLM_MAX_LINE);
+            } else {
+                m_line[m_lineLength] = '\0';
+                handleLine(m_line, m_lineLength);
+            }
+            m_lineLength = 0;
+            m_lineOverflow = false;
+        }
+    }
+    return m_streamDone && !m_cancelled;
+}
+
+void ChatStream::handleLine(char* line, size_t length) {
+    // Blank lines separate events; comments and other fields carry no text
+    if (length < 5 || strncmp(line, "data:", 5) != 0) {
+        return;
+    }
+    char* data = line + 5;
+    if (*data == ' ') {
+        data++;
+    }
+    if (strcmp(data, "[DONE]") == 0) {
+        m_streamDone = true;
+        return;
+    }
+
+    cJSON* root = cJSON_Parse(data);
+    cJSON* choices = root ? cJSON_GetObjectItem(root, "choices") : nullptr;
+    cJSON* choice = cJSON_IsArray(choices) ? cJSON_GetArrayItem(choices, 0) : nullptr;
+    cJSON* delta = choice ? cJSON_GetObjectItem(choice, "delta") : nullptr;
+    cJSON* content = delta ? cJSON_GetObjectItem(delta, "content") : nullptr;
+    if (cJSON_IsString(content) && content->valuestring[0]) {
+        appendTokens(content->valuestring);
+    }
+    cJSON_Delete(root);
+}
+
+void ChatStream::appendTokens(const char* text) {
+    if (m_stats.tokens == 0) {
+        m_stats.ttftMs = elapsedMs(m_startUs);
+        m_state.store(ChatStreamState::STREAMING, std::memory_order_release);
+    }
+    m_stats.tokens++;
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_pending += text;
+    xSemaphoreGive(m_mutex);
+}
+
+void ChatStream::setError(const char* message) {
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_error = message ? message : "";
+    xSemaphoreGive(m_mutex);
+    m_state.store(ChatStreamState::ERROR, std::memory_order_release);
+}
+
+void ChatStream::streamTask(void* parameter) {
+    ChatStream* stream = static_cast<ChatStream*>(parameter);
+    stream->run();
+    if (stream->m_cancelled && !stream->isFinished()) {
+        stream->setError("Cancelled");
+    }
+
+    stream->m_task = nullptr;
+    vTaskDelete(NULL);
+}
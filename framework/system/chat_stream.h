@@ -0,0 +1,138 @@
+#ifndef CHAT_STREAM_H
+#define CHAT_STREAM_H
+
+#include "os_config.h"
+#include "https_session.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <string>
+
+/**
+ * @file chat_stream.h
+ * @brief Streams a chat completion token by token over the shared HTTPS session
+ *
+ * The request asks OS_LLM_PATH for a server-sent-event stream
+ * ("stream": true). A task reads the body as it arrives and splits it into
+ * lines without waiting for the whole reply; each "data: {...}" event
+ * carries the next piece of text in choices[0].delta.content, and
+ * "data: [DONE]" ends the stream. Text is handed to the UI through
+ * takeTokens(), so the reply appears as it is generated and the user waits
+ * only for the first token rather than the last.
+ *
+ * Time to first token, measured from start(), is kept in the statistics.
+ * addMessage(), start(), cancel() and takeTokens() come from one task.
+ */
+
+enum class ChatStreamState : uint8_t {
+    IDLE,
+    CONNECTING,     // Waiting for the session and sending the request
+    WAITING,        // Request sent, no text yet
+    STREAMING,      // Text arriving
+    DONE,           // Stream complete
+    ERROR
+};
+
+struct ChatStreamStats {
+    uint32_t ttftMs;            // start() to first text: the latency the user feels
+    uint32_t totalMs;           // start() to the end of the stream
+    uint32_t tokens;            // Content events received
+    uint32_t bytes;             // Response body bytes
+    bool reusedConnection;      // Sent on a kept-alive connection, no handshake
+    int httpStatus;
+};
+
+class ChatStream {
+public:
+    ChatStream() = default;
+    ~ChatStream();
+
+    ChatStream(const ChatStream&) = delete;
+    ChatStream& operator=(const ChatStream&) = delete;
+
+    /**
+     * @brief Queue a message for the next request, oldest first
+     * @param role "system", "user" or "assistant"
+     * @param content Message text
+     */
+    void addMessage(const char* role, const std::string& content);
+
+    /**
+     * @brief Send the queued messages and start streaming the reply
+     * @param session Connection to the backend; must outlive the stream
+     * @param apiKey Bearer token for the backend
+     * @return OS_OK on success, OS_ERROR_INVALID_PARAM without messages,
+     *         OS_ERROR_BUSY or OS_ERROR_NO_MEMORY
+     */
+    os_error_t start(HttpsSession* session, const std::string& apiKey);
+
+    /**
+     * @brief Abort the stream, wait for the task and drop queued messages
+     */
+    void cancel();
+
+    /**
+     * @brief Get the stream state
+     * @return Current state
+     */
+    ChatStreamState getState() const { return m_state.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if the task has finished (done or error)
+     * @return true once no more text will arrive
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Move text received since the last call to the end of a string
+     * @param text String the new text is appended to
+     * @return true if any text was appended
+     */
+    bool takeTokens(std::string& text);
+
+    /**
+     * @brief Get the failure reason once the state is ERROR
+     * @return Error text
+     */
+    std::string getError();
+
+    /**
+     * @brief Get latency counters
+     * @return Statistics snapshot
+     */
+    ChatStreamStats getStats() const { return m_stats; }
+
+private:
+    void run();
+    bool readEvents();
+    void handleLine(char* line, size_t length);
+    void appendTokens(const char* text);
+    void setError(const char* message);
+
+    static void streamTask(void* parameter);
+
+    HttpsSession* m_session = nullptr;
+    std::string m_apiKey;
+    std::string m_messages;         // JSON objects, comma separated
+    std::string m_body;
+
+    char* m_buffer = nullptr;       // OS_HTTPS_BUFFER_SIZE receive buffer
+    char* m_line = nullptr;         // OS_LLM_MAX_LINE + 1, the event being assembled
+    size_t m_lineLength = 0;
+    bool m_lineOverflow = false;
+    bool m_streamDone = false;
+
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_cancelled = false;
+    std::atomic<ChatStreamState> m_state{ChatStreamState::IDLE};
+
+    SemaphoreHandle_t m_mutex = nullptr;
+    std::string m_pending;          // Guarded by m_mutex
+    std::string m_error;            // Guarded by m_mutex
+
+    int64_t m_startUs = 0;
+    ChatStreamStats m_stats = {};
+};
+
+#endif // CHAT_STREAM_H
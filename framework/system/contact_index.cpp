@@ -0,0 +1,310 @@
+#include "contact_index.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+static void insertSorted(std::vector<uint32_t>& ids, uint32_t id) {
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) {
+        ids.insert(it, id);
+    }
+}
+
+static void eraseSorted(std::vector<uint32_t>& ids, uint32_t id) {
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id) {
+        ids.erase(it);
+    }
+}
+
+static void intersectInto(std::vector<uint32_t>& ids, const std::vector<uint32_t>& other) {
+    auto end = std::set_intersection(ids.begin(), ids.end(), other.begin(), other.end(), ids.begin());
+    ids.erase(end, ids.end());
+}
+
+static bool isPhoneQuery(const char* query) {
+    bool digits = false;
+    for (const char* c = query; *c; c++) {
+        if (isdigit((unsigned char)*c)) {
+            digits = true;
+        } else if (!strchr("+-() .", *c)) {
+            return false;
+        }
+    }
+    return digits;
+}
+
+void ContactIndex::add(uint32_t id, const std::string& name, const std::string& email, const std::string& phone) {
+    std::string digits = digitsOf(phone);
+    std::string text = normalize(name) + ' ' + normalize(email) + ' ' + digits;
+    addText(id, text);
+    m_text[id] = std::move(text);
+
+    if (!digits.empty()) {
+        insertSorted(m_phones[trieInsert(digits)], id);
+    }
+}
+
+void ContactIndex::remove(uint32_t id, const std::string& phone) {
+    auto text = m_text.find(id);
+    if (text == m_text.end()) {
+        return;
+    }
+    removeText(id, text->second);
+    m_text.erase(text);
+
+    // Trie nodes stay behind; a number typed again reuses them
+    std::string digits = digitsOf(phone);
+    uint32_t node = digits.empty() ? 0 : trieFind(digits);
+    auto phones = m_phones.find(node);
+    if (node != 0 && phones != m_phones.end()) {
+        eraseSorted(phones->second, id);
+        if (phones->second.empty()) {
+            m_phones.erase(phones);
+        }
+    }
+}
+
+void ContactIndex::clear() {
+    m_grams.clear();
+    m_words.clear();
+    m_wordsSorted = true;
+    m_text.clear();
+    m_trie.assign(1, TrieNode{0, 0, 0});
+    m_phones.clear();
+}
+
+void ContactIndex::search(const char* query, std::vector<uint32_t>& ids) {
+    int64_t start = esp_timer_get_time();
+    ids.clear();
+    m_queries++;
+
+    if (query && isPhoneQuery(query)) {
+        matchDigits(digitsOf(query), ids);
+    } else if (query) {
+        // Every word of the query has to match
+        std::string text = normalize(query);
+        Postings matches;
+        bool first = true;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find(' ', pos);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            matchWord(text.substr(pos, end - pos), first ? ids : matches);
+            if (!first) {
+                intersectInto(ids, matches);
+            }
+            first = false;
+            if (ids.empty()) {
+                break;
+            }
+            pos = end + 1;
+        }
+    }
+
+    m_lastResults = ids.size();
+    m_lastQueryUs = (uint32_t)(esp_timer_get_time() - start);
+}
+
+void ContactIndex::printStats(const char* tag) const {
+    size_t postings = 0;
+    for (const auto& gram : m_grams) {
+        postings += gram.second.size();
+    }
+    ESP_LOGI(tag, "Contact index: %d contacts, %d trigrams (%d postings), %d words, %d trie nodes",
+             m_text.size(), m_grams.size(), postings, m_words.size(), m_trie.size());
+    ESP_LOGI(tag, "Queries: %d, last %d us for %d results", m_queries, m_lastQueryUs, m_lastResults);
+}
+
+std::string ContactIndex::normalize(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (isalnum((unsigned char)c)) {
+            out += (char)tolower((unsigned char)c);
+        } else if (!out.empty() && out.back() != ' ') {
+            out += ' ';
+        }
+    }
+    if (!out.empty() && out.back() == ' ') {
+        out.pop_back();
+    }
+    return out;
+}
+
+std::string ContactIndex::digitsOf(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (isdigit((unsigned char)c)) {
+            out += c;
+        }
+    }
+    return out;
+}
+
+uint32_t ContactIndex::gramKey(const char* gram) {
+    return ((uint32_t)(uint8_t)gram[0] << 16) | ((uint32_t)(uint8_t)gram[1] << 8) | (uint8_t)gram[2];
+}
+
+void ContactIndex::addText(uint32_t id, const std::string& text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = std::min(text.find(' ', pos), text.size());
+        if (end > pos) {
+            m_words.emplace_back(text.substr(pos, end - pos), id);
+            m_wordsSorted = false;
+            for (size_t i = pos; i + 3 <= end; i++) {
+                insertSorted(m_grams[gramKey(&text[i])], id);
+            }
+        }
+        pos = end + 1;
+    }
+}
+
+void ContactIndex::removeText(uint32_t id, const std::string& text) {
+    sortWords();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = std::min(text.find(' ', pos), text.size());
+        if (end > pos) {
+            auto word = std::make_pair(text.substr(pos, end - pos), id);
+            auto it = std::lower_bound(m_words.begin(), m_words.end(), word);
+            if (it != m_words.end() && *it == word) {
+                m_words.erase(it);
+            }
+            for (size_t i = pos; i + 3 <= end; i++) {
+                auto gram = m_grams.find(gramKey(&text[i]));
+                if (gram != m_grams.end()) {
+                    eraseSorted(gram->second, id);
+                    if (gram->second.empty()) {
+                        m_grams.erase(gram);
+                    }
+                }
+            }
+        }
+        pos = end + 1;
+    }
+}
+
+void ContactIndex::sortWords() {
+    if (!m_wordsSorted) {
+        std::sort(m_words.begin(), m_words.end());
+        m_wordsSorted = true;
+    }
+}
+
+void ContactIndex::matchWord(const std::string& word, Postings& out) {
+    out.clear();
+    if (word.size() >= 3) {
+        matchGrams(word, out);
+        return;
+    }
+
+    // Too short for trigrams: words starting with it
+    sortWords();
+    auto it = std::lower_bound(m_words.begin(), m_words.end(), std::make_pair(word, (uint32_t)0));
+    for (; it != m_words.end() && it->first.compare(0, word.size(), word) == 0; ++it) {
+        out.push_back(it->second);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void ContactIndex::matchDigits(const std::string& digits, Postings& out) {
+    out.clear();
+
+    // Numbers starting with the digits: everything below their trie node
+    uint32_t node = trieFind(digits);
+    if (node != 0) {
+        std::vector<uint32_t> stack;
+        stack.push_back(node);
+        while (!stack.empty()) {
+            uint32_t current = stack.back();
+            stack.pop_back();
+            auto phones = m_phones.find(current);
+            if (phones != m_phones.end()) {
+                out.insert(out.end(), phones->second.begin(), phones->second.end());
+            }
+            for (uint32_t child = m_trie[current].child; child != 0; child = m_trie[child].sibling) {
+                stack.push_back(child);
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    // Long enough to look inside numbers too
+    if (digits.size() >= 3) {
+        Postings inside;
+        matchGrams(digits, inside);
+        Postings merged;
+        merged.reserve(out.size() + inside.size());
+        std::set_union(out.begin(), out.end(), inside.begin(), inside.end(), std::back_inserter(merged));
+        out.swap(merged);
+    }
+}
+
+void ContactIndex::matchGrams(const std::string& word, Postings& out) {
+    out.clear();
+
+    // Intersect from the shortest list so the work shrinks at every step
+    std::vector<const Postings*> lists;
+    for (size_t i = 0; i + 3 <= word.size(); i++) {
+        auto gram = m_grams.find(gramKey(&word[i]));
+        if (gram == m_grams.end()) {
+            return;
+        }
+        lists.push_back(&gram->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+    out = *lists[0];
+    for (size_t i = 1; i < lists.size() && !out.empty(); i++) {
+        intersectInto(out, *lists[i]);
+    }
+
+    // Trigrams in common do not make a substring beyond three characters
+    if (word.size() > 3) {
+        out.erase(std::remove_if(out.begin(), out.end(), [&](uint32_t id) {
+                      auto text = m_text.find(id);
+                      return text == m_text.end() || text->second.find(word) == std::string::npos;
+                  }), out.end());
+    }
+}
+
+uint32_t ContactIndex::trieInsert(const std::string& digits) {
+    uint32_t node = 0;
+    for (char c : digits) {
+        uint8_t digit = (uint8_t)(c - '0');
+        uint32_t child = m_trie[node].child;
+        while (child != 0 && m_trie[child].digit != digit) {
+            child = m_trie[child].sibling;
+        }
+        if (child == 0) {
+            child = (uint32_t)m_trie.size();
+            m_trie.push_back(TrieNode{0, m_trie[node].child, digit});
+            m_trie[node].child = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+uint32_t ContactIndex::trieFind(const std::string& digits) const {
+    uint32_t node = 0;
+    for (char c : digits) {
+        uint8_t digit = (uint8_t)(c - '0');
+        uint32_t child = m_trie[node].child;
+        while (child != 0 && m_trie[child].digit != digit) {
+            child = m_trie[child].sibling;
+        }
+        if (child == 0) {
+            return 0;
+        }
+        node = child;
+    }
+    return node;
+}
@@ -0,0 +1,108 @@
+#ifndef CONTACT_INDEX_H
+#define CONTACT_INDEX_H
+
+#include "os_config.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @file contact_index.h
+ * @brief Search-as-you-type index over contact names, emails and phones
+ *
+ * Text is normalised to lower-case ASCII letters and digits, split into
+ * words at anything else. Three structures answer a query:
+ * - trigram postings: every three-character run of every word maps to the
+ *   sorted IDs containing it, so a query word of three or more characters
+ *   is the intersection of its trigrams' lists, confirmed against the
+ *   normalised text (substring semantics);
+ * - a sorted word list answers one- and two-character query words as word
+ *   prefixes, where trigrams do not exist yet;
+ * - a digit trie over phone numbers, separators stripped, answers queries
+ *   made only of digits as number prefixes; from three digits on, numbers
+ *   containing them anywhere match too.
+ * Query words must all match. Results are contact IDs in ascending order,
+ * written into a caller-owned vector, so a keystroke copies no records.
+ *
+ * add() and remove() keep the index current one contact at a time; a
+ * bulk load adds everything and the word list is sorted once, on the
+ * first query. Updates and queries belong to one thread.
+ */
+
+class ContactIndex {
+public:
+    ContactIndex() = default;
+
+    /**
+     * @brief Index a contact
+     * @param id Contact ID, not already indexed
+     * @param name Display name
+     * @param email Email address
+     * @param phone Phone number in any format
+     */
+    void add(uint32_t id, const std::string& name, const std::string& email, const std::string& phone);
+
+    /**
+     * @brief Drop a contact
+     * @param id Contact ID
+     * @param phone Phone number it was added with
+     */
+    void remove(uint32_t id, const std::string& phone);
+
+    /**
+     * @brief Drop everything
+     */
+    void clear();
+
+    /**
+     * @brief Find the contacts matching a query
+     * @param query Text as typed
+     * @param ids Filled with matching IDs in ascending order; empty query matches nothing
+     */
+    void search(const char* query, std::vector<uint32_t>& ids);
+
+    /**
+     * @brief Print index sizes and the last query time
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    typedef std::vector<uint32_t> Postings;
+
+    static std::string normalize(const std::string& text);
+    static std::string digitsOf(const std::string& text);
+    static uint32_t gramKey(const char* gram);
+
+    void addText(uint32_t id, const std::string& text);
+    void removeText(uint32_t id, const std::string& text);
+    void sortWords();
+
+    void matchWord(const std::string& word, Postings& out);
+    void matchDigits(const std::string& digits, Postings& out);
+    void matchGrams(const std::string& word, Postings& out);
+
+    // Digit trie as first-child / next-sibling links; node 0 is the root
+    struct TrieNode {
+        uint32_t child;
+        uint32_t sibling;
+        uint8_t digit;
+    };
+    uint32_t trieInsert(const std::string& digits);
+    uint32_t trieFind(const std::string& digits) const;
+
+    std::unordered_map<uint32_t, Postings> m_grams;
+    std::vector<std::pair<std::string, uint32_t>> m_words;     // (word, id)
+    bool m_wordsSorted = true;
+    std::unordered_map<uint32_t, std::string> m_text;          // Normalised text the grams came from
+    std::vector<TrieNode> m_trie = {{0, 0, 0}};
+    std::unordered_map<uint32_t, Postings> m_phones;           // Trie node to the numbers ending there
+
+    // Statistics
+    uint32_t m_queries = 0;
+    uint32_t m_lastQueryUs = 0;
+    uint32_t m_lastResults = 0;
+};
+
+#endif // CONTACT_INDEX_H
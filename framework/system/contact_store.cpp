@@ -0,0 +1,246 @@
+#include "contact_store.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+static const char* TAG = "ContactStore";
+
+static constexpr uint32_t FILE_MAGIC = 0x31544E43;     // "CNT1"
+static constexpr uint16_t FILE_VERSION = 1;
+static constexpr size_t FIELD_COUNT = 5;
+static constexpr size_t MAX_FIELD_LENGTH = UINT16_MAX;
+
+struct ContactFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t nextId;
+};
+
+struct ContactRecordHeader {
+    uint32_t id;
+    uint16_t lengths[FIELD_COUNT];     // name, phone, email, address, category
+};
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Field order on disk
+static std::string* fieldsOf(Contact& contact, size_t index) {
+    std::string* fields[FIELD_COUNT] = {&contact.name, &contact.phone, &contact.email,
+                                        &contact.address, &contact.category};
+    return fields[index];
+}
+
+os_error_t ContactStore::load(const char* path) {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    m_path = path;
+
+    int64_t start = esp_timer_get_time();
+    std::string temp = m_path + ".tmp";
+    os_error_t ret = readFile(m_path.c_str());
+    if (ret == OS_ERROR_NOT_FOUND && readFile(temp.c_str()) == OS_OK) {
+        ESP_LOGW(TAG, "Recovered contacts from an interrupted save");
+        ::rename(temp.c_str(), m_path.c_str());
+        ret = OS_OK;
+    }
+    m_loadMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    m_dirty = false;
+
+    if (ret == OS_OK) {
+        ESP_LOGI(TAG, "Loaded %d contacts (%d KB) in %d ms", m_contacts.size(), m_fileBytes / 1024, m_loadMs);
+    }
+    return ret;
+}
+
+os_error_t ContactStore::readFile(const char* path) {
+    m_contacts.clear();
+    m_index.clear();
+    m_nextId = 1;
+    m_fileBytes = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    setvbuf(file, nullptr, _IOFBF, OS_CONTACTS_IO_BUFFER);
+
+    ContactFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != FILE_MAGIC ||
+        header.version != FILE_VERSION) {
+        ESP_LOGE(TAG, "%s is not a contact file", path);
+        fclose(file);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_contacts.reserve(header.count);
+    uint32_t checksum = 2166136261u;
+    bool ok = true;
+    for (uint32_t i = 0; i < header.count && ok; i++) {
+        ContactRecordHeader record;
+        Contact contact;
+        ok = fread(&record, sizeof(record), 1, file) == 1;
+        checksum = fnv1a(checksum, &record, sizeof(record));
+        for (size_t f = 0; f < FIELD_COUNT && ok; f++) {
+            std::string* field = fieldsOf(contact, f);
+            field->resize(record.lengths[f]);
+            ok = record.lengths[f] == 0 || fread(&(*field)[0], 1, record.lengths[f], file) == record.lengths[f];
+            checksum = fnv1a(checksum, field->data(), field->size());
+        }
+        contact.id = record.id;
+        ok = ok && (m_contacts.empty() || contact.id > m_contacts.back().id);
+        if (ok) {
+            m_contacts.push_back(std::move(contact));
+        }
+    }
+    uint32_t stored = 0;
+    ok = ok && fread(&stored, sizeof(stored), 1, file) == 1 && stored == checksum;
+    m_fileBytes = (uint32_t)ftell(file);
+    fclose(file);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "%s is damaged; no contacts loaded", path);
+        m_contacts.clear();
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_nextId = std::max(header.nextId, m_contacts.empty() ? 1 : m_contacts.back().id + 1);
+    for (const Contact& contact : m_contacts) {
+        m_index.add(contact.id, contact.name, contact.email, contact.phone);
+    }
+    return OS_OK;
+}
+
+os_error_t ContactStore::save() {
+    if (m_path.empty()) {
+        return OS_ERROR_NOT_AVAILABLE;
+    }
+
+    int64_t start = esp_timer_get_time();
+    std::string temp = m_path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to create %s", temp.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    setvbuf(file, nullptr, _IOFBF, OS_CONTACTS_IO_BUFFER);
+
+    ContactFileHeader header = {FILE_MAGIC, FILE_VERSION, 0, (uint32_t)m_contacts.size(), m_nextId};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint32_t checksum = 2166136261u;
+    for (Contact& contact : m_contacts) {
+        ContactRecordHeader record = {};
+        record.id = contact.id;
+        for (size_t f = 0; f < FIELD_COUNT; f++) {
+            record.lengths[f] = (uint16_t)std::min(fieldsOf(contact, f)->size(), MAX_FIELD_LENGTH);
+        }
+        ok = ok && fwrite(&record, sizeof(record), 1, file) == 1;
+        checksum = fnv1a(checksum, &record, sizeof(record));
+        for (size_t f = 0; f < FIELD_COUNT; f++) {
+            const std::string* field = fieldsOf(contact, f);
+            ok = ok && fwrite(field->data(), 1, record.lengths[f], file) == record.lengths[f];
+            checksum = fnv1a(checksum, field->data(), record.lengths[f]);
+        }
+    }
+    ok = ok && fwrite(&checksum, sizeof(checksum), 1, file) == 1;
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    m_fileBytes = (uint32_t)ftell(file);
+    ok = fclose(file) == 0 && ok;
+
+    // FAT cannot rename over an existing file; load() covers the gap
+    if (ok) {
+        ::remove(m_path.c_str());
+        ok = ::rename(temp.c_str(), m_path.c_str()) == 0;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to save contacts to %s", m_path.c_str());
+        ::remove(temp.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_dirty = false;
+    m_saveMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    ESP_LOGD(TAG, "Saved %d contacts in %d ms", m_contacts.size(), m_saveMs);
+    return OS_OK;
+}
+
+uint32_t ContactStore::add(const Contact& contact) {
+    Contact record = contact;
+    record.id = m_nextId++;
+    m_index.add(record.id, record.name, record.email, record.phone);
+    m_contacts.push_back(std::move(record));
+    m_dirty = true;
+    return m_contacts.back().id;
+}
+
+bool ContactStore::update(uint32_t id, const Contact& contact) {
+    Contact* record = findMutable(id);
+    if (!record) {
+        return false;
+    }
+    m_index.remove(id, record->phone);
+    *record = contact;
+    record->id = id;
+    m_index.add(id, record->name, record->email, record->phone);
+    m_dirty = true;
+    return true;
+}
+
+bool ContactStore::remove(uint32_t id) {
+    Contact* record = findMutable(id);
+    if (!record) {
+        return false;
+    }
+    m_index.remove(id, record->phone);
+    m_contacts.erase(m_contacts.begin() + (record - m_contacts.data()));
+    m_dirty = true;
+    return true;
+}
+
+const Contact* ContactStore::find(uint32_t id) const {
+    auto it = std::lower_bound(m_contacts.begin(), m_contacts.end(), id,
+                               [](const Contact& contact, uint32_t value) { return contact.id < value; });
+    return it != m_contacts.end() && it->id == id ? &*it : nullptr;
+}
+
+Contact* ContactStore::findMutable(uint32_t id) {
+    return const_cast<Contact*>(find(id));
+}
+
+void ContactStore::search(const std::string& query, const std::string& category, std::vector<uint32_t>& ids) {
+    if (query.empty()) {
+        ids.clear();
+        ids.reserve(m_contacts.size());
+        for (const Contact& contact : m_contacts) {
+            if (category.empty() || contact.category == category) {
+                ids.push_back(contact.id);
+            }
+        }
+        return;
+    }
+
+    m_index.search(query.c_str(), ids);
+    if (!category.empty()) {
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [&](uint32_t id) {
+                      const Contact* contact = find(id);
+                      return !contact || contact->category != category;
+                  }), ids.end());
+    }
+}
+
+void ContactStore::printStats(const char* tag) const {
+    ESP_LOGI(tag, "Contacts: %d (%d KB file), load %d ms, last save %d ms%s",
+             m_contacts.size(), m_fileBytes / 1024, m_loadMs, m_saveMs, m_dirty ? ", unsaved changes" : "");
+    m_index.printStats(tag);
+}
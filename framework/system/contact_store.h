@@ -0,0 +1,121 @@
+#ifndef CONTACT_STORE_H
+#define CONTACT_STORE_H
+
+#include "os_config.h"
+#include "contact_index.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file contact_store.h
+ * @brief Contact records, their file on the SD card and their search index
+ *
+ * Records stay sorted by ID (IDs only grow), so lookups are a binary
+ * search and no second map is kept. The file is a header followed by one
+ * packed record per contact: the ID, five 16-bit field lengths and the
+ * field bytes, then a checksum of the records. save() writes a temporary
+ * file and renames it over the old one; load() falls back to the
+ * temporary file when a save was cut off between the two steps.
+ *
+ * Every change updates the ContactIndex incrementally, so search() stays
+ * a few postings lookups at any size.
+ */
+
+struct Contact {
+    std::string name;
+    std::string phone;
+    std::string email;
+    std::string address;
+    std::string category;
+    uint32_t id;
+};
+
+class ContactStore {
+public:
+    ContactStore() = default;
+
+    /**
+     * @brief Read contacts from a file, replacing those held
+     * @param path Contact file path
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if there is no file yet
+     */
+    os_error_t load(const char* path);
+
+    /**
+     * @brief Write all contacts to the file last loaded
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t save();
+
+    /**
+     * @brief Check for changes not yet saved
+     * @return true if dirty
+     */
+    bool isDirty() const { return m_dirty; }
+
+    /**
+     * @brief Add a contact under a new ID
+     * @param contact Fields; the ID is ignored
+     * @return New ID
+     */
+    uint32_t add(const Contact& contact);
+
+    /**
+     * @brief Replace a contact's fields
+     * @param id Contact ID
+     * @param contact New fields; the ID is ignored
+     * @return true if the contact exists
+     */
+    bool update(uint32_t id, const Contact& contact);
+
+    /**
+     * @brief Delete a contact
+     * @param id Contact ID
+     * @return true if the contact existed
+     */
+    bool remove(uint32_t id);
+
+    /**
+     * @brief Look up a contact
+     * @param id Contact ID
+     * @return Contact, or nullptr; valid until the next change
+     */
+    const Contact* find(uint32_t id) const;
+
+    /**
+     * @brief Get the number of contacts
+     * @return Contact count
+     */
+    size_t size() const { return m_contacts.size(); }
+
+    /**
+     * @brief Find contacts by text and category
+     * @param query Search text; empty matches every contact
+     * @param category Category to keep, or empty for all
+     * @param ids Filled with matching IDs in ascending order
+     */
+    void search(const std::string& query, const std::string& category, std::vector<uint32_t>& ids);
+
+    /**
+     * @brief Print store and index statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    Contact* findMutable(uint32_t id);
+    os_error_t readFile(const char* path);
+
+    std::vector<Contact> m_contacts;    // Sorted by ID
+    uint32_t m_nextId = 1;
+    ContactIndex m_index;
+    std::string m_path;
+    bool m_dirty = false;
+
+    // Statistics
+    uint32_t m_loadMs = 0;
+    uint32_t m_saveMs = 0;
+    uint32_t m_fileBytes = 0;
+};
+
+#endif // CONTACT_STORE_H
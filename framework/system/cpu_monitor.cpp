@@ -0,0 +1,123 @@
+#include "cpu_monitor.h"
+#include <esp_log.h>
+#include <esp_idf_version.h>
+#include <algorithm>
+
+static const char* TAG = "CpuMonitor";
+
+static TaskHandle_t idleTaskForCore(int core) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+    return xTaskGetIdleTaskHandleForCore(core);
+#else
+    return xTaskGetIdleTaskHandleForCPU(core);
+#endif
+}
+
+bool CpuMonitor::isSupported() {
+#if configGENERATE_RUN_TIME_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CpuMonitor::sample() {
+#if configGENERATE_RUN_TIME_STATS
+    // Leave headroom for tasks created between the count and the snapshot
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    if (m_snapshot.size() < capacity) {
+        m_snapshot.resize(capacity);
+    }
+
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(m_snapshot.data(), m_snapshot.size(), &totalRunTime);
+    uint32_t windowTime = totalRunTime - m_lastTotalRunTime;
+    bool havePrevious = m_lastTotalRunTime != 0 && windowTime > 0;
+    m_lastTotalRunTime = totalRunTime;
+
+    std::vector<Counter> current;
+    current.reserve(count);
+    m_tasks.clear();
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& status = m_snapshot[i];
+        current.push_back({status.xHandle, status.ulRunTimeCounter});
+
+        // Tasks without a previous counter were created during the window
+        uint32_t delta = 0;
+        for (const auto& previous : m_previous) {
+            if (previous.handle == status.xHandle) {
+                delta = status.ulRunTimeCounter - previous.runTime;
+                break;
+            }
+        }
+
+        TaskCpuStats stats;
+        stats.handle = status.xHandle;
+        stats.name = status.pcTaskName;
+#if configTASKLIST_INCLUDE_COREID
+        stats.core = status.xCoreID == tskNO_AFFINITY ? -1 : (int)status.xCoreID;
+#else
+        stats.core = -1;
+#endif
+        stats.runTimeDelta = delta;
+        uint64_t load = havePrevious ? ((uint64_t)delta * 100) / windowTime : 0;
+        stats.load = load > 100 ? 100 : (uint8_t)load;
+        m_tasks.push_back(stats);
+    }
+    m_previous.swap(current);
+
+    if (!havePrevious) {
+        return;
+    }
+
+    uint32_t totalLoad = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint8_t idleLoad = getTaskLoad(idleTaskForCore(core));
+        m_coreLoad[core] = 100 - idleLoad;
+        totalLoad += m_coreLoad[core];
+    }
+    m_totalLoad = (uint8_t)(totalLoad / portNUM_PROCESSORS);
+
+    std::sort(m_tasks.begin(), m_tasks.end(),
+              [](const TaskCpuStats& a, const TaskCpuStats& b) {
+                  return a.runTimeDelta > b.runTimeDelta;
+              });
+#endif
+}
+
+uint8_t CpuMonitor::getCoreLoad(int core) const {
+    if (core < 0 || core >= portNUM_PROCESSORS) {
+        return 0;
+    }
+    return m_coreLoad[core];
+}
+
+uint8_t CpuMonitor::getTaskLoad(TaskHandle_t handle) const {
+    if (!handle) {
+        return 0;
+    }
+    for (const auto& task : m_tasks) {
+        if (task.handle == handle) {
+            return task.load;
+        }
+    }
+    return 0;
+}
+
+void CpuMonitor::printStats() const {
+    ESP_LOGI(TAG, "=== CPU Statistics ===");
+    if (!isSupported()) {
+        ESP_LOGW(TAG, "configGENERATE_RUN_TIME_STATS disabled, no per-task accounting");
+        return;
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        ESP_LOGI(TAG, "Core %d: %d%%", core, m_coreLoad[core]);
+    }
+    ESP_LOGI(TAG, "Total: %d%%", m_totalLoad);
+
+    for (const auto& task : m_tasks) {
+        ESP_LOGI(TAG, "  %-16s core %2d  %3d%%", task.name, task.core, task.load);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef CPU_MONITOR_H
+#define CPU_MONITOR_H
+
+#include "os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <vector>
+
+/**
+ * @file cpu_monitor.h
+ * @brief Per-task, per-core CPU accounting for M5Stack Tab5
+ *
+ * Samples FreeRTOS run-time statistics (uxTaskGetSystemState) once per
+ * window and turns the counter deltas into load percentages. Core load is
+ * 100% minus the share used by that core's idle task; task load is a
+ * percentage of one core. Requires configGENERATE_RUN_TIME_STATS, which
+ * ESP-IDF backs with esp_timer; without it every load reads as zero.
+ */
+
+/**
+ * @brief Load of a single FreeRTOS task over the last window
+ */
+struct TaskCpuStats {
+    TaskHandle_t handle;
+    const char* name;       // Owned by FreeRTOS, valid while the task lives
+    int core;               // Pinned core or -1 if unpinned
+    uint8_t load;           // Percent of one core
+    uint32_t runTimeDelta;  // Run-time counter ticks in the window
+};
+
+class CpuMonitor {
+public:
+    CpuMonitor() = default;
+
+    /**
+     * @brief Take a run-time stats snapshot and update loads
+     *
+     * Call once per accounting window (OSManager does so every second).
+     */
+    void sample();
+
+    /**
+     * @brief Check if FreeRTOS run-time stats are available
+     * @return true if loads are meaningful
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Get load of one core
+     * @param core Core index
+     * @return Load percentage (0-100)
+     */
+    uint8_t getCoreLoad(int core) const;
+
+    /**
+     * @brief Get load averaged over all cores
+     * @return Load percentage (0-100)
+     */
+    uint8_t getTotalLoad() const { return m_totalLoad; }
+
+    /**
+     * @brief Get load of a task
+     * @param handle Task handle
+     * @return Percent of one core, 0 if unknown
+     */
+    uint8_t getTaskLoad(TaskHandle_t handle) const;
+
+    /**
+     * @brief Get per-task loads from the last window
+     * @return Task statistics sorted by load, highest first
+     */
+    const std::vector<TaskCpuStats>& getTaskStats() const { return m_tasks; }
+
+    /**
+     * @brief Print per-core and per-task loads
+     */
+    void printStats() const;
+
+private:
+    struct Counter {
+        TaskHandle_t handle;
+        uint32_t runTime;
+    };
+
+    std::vector<TaskStatus_t> m_snapshot;
+    std::vector<Counter> m_previous;
+    std::vector<TaskCpuStats> m_tasks;
+    uint32_t m_lastTotalRunTime = 0;
+    uint8_t m_coreLoad[portNUM_PROCESSORS] = {};
+    uint8_t m_totalLoad = 0;
+};
+
+#endif // CPU_MONITOR_H
@@ -0,0 +1,123 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file event_ring.h
+ * @brief Fixed-capacity lock-free MPSC ring buffer
+ *
+ * Bounded multi-producer single-consumer queue with a sequence number
+ * per cell. Producers claim a slot with one compare-and-swap and never
+ * block or allocate, so push() is safe from ISRs and from any FreeRTOS
+ * task. pop() must only be called from a single consumer (the main loop).
+ */
+
+template <typename T, size_t Capacity>
+class EventRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "EventRing capacity must be a power of two");
+
+public:
+    EventRing() { reset(); }
+
+    /**
+     * @brief Queue an element (any context, including ISRs)
+     * @param value Element to copy into the ring
+     * @return true if queued, false if the ring is full
+     */
+    bool push(const T& value) {
+        uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell = &m_cells[pos & MASK];
+            uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue the oldest element (single consumer only)
+     * @param value Output element
+     * @return true if an element was dequeued, false if empty
+     */
+    bool pop(T& value) {
+        uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[pos & MASK];
+        uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+
+        // Empty, or a producer claimed the slot but has not published yet
+        if ((int32_t)(seq - (pos + 1)) < 0) {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued elements
+     * @return Element count
+     */
+    size_t size() const {
+        uint32_t head = m_dequeuePos.load(std::memory_order_relaxed);
+        uint32_t tail = m_enqueuePos.load(std::memory_order_relaxed);
+        return (size_t)(tail - head);
+    }
+
+    /**
+     * @brief Check if the ring is empty
+     * @return true if no elements are queued
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Get ring capacity
+     * @return Maximum number of elements
+     */
+    static constexpr size_t capacity() { return Capacity; }
+
+    /**
+     * @brief Reset to empty (no producers may be active)
+     */
+    void reset() {
+        for (size_t i = 0; i < Capacity; i++) {
+            m_cells[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Cell m_cells[Capacity];
+    std::atomic<uint32_t> m_enqueuePos;
+    std::atomic<uint32_t> m_dequeuePos;
+};
+
+#endif // EVENT_RING_H
@@ -1,9 +1,21 @@
 #include "event_system.h"
+#include "os_manager.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <algorithm>
+#include <new>
 
 static const char* TAG = "EventSystem";
 
+// Header at the start of each pooled payload slot
+struct PayloadHeader {
+    std::atomic<uint16_t> refs;
+    uint16_t size;
+};
+
+static constexpr size_t PAYLOAD_HEADER_SIZE = 8;
+static_assert(sizeof(PayloadHeader) <= PAYLOAD_HEADER_SIZE, "payload header too large");
+
 EventSystem::~EventSystem() {
     shutdown();
 }
@@ -16,10 +28,29 @@ os_error_t EventSystem::initialize() {
     ESP_LOGI(TAG, "Initializing Event System");
     
     // Clear any existing state
-    m_listeners.clear();
+    for (auto& list : m_dispatchTable) {
+        list.clear();
+    }
+    m_sparseListeners.clear();
+    m_listenerTypes.clear();
+    m_pendingListeners.clear();
+    m_needsCleanup = false;
     clearQueue();
-    
+
+    m_payloadPool = std::make_unique<MemoryPool>(OS_EVENT_PAYLOAD_BLOCK, OS_EVENT_PAYLOAD_BLOCKS,
+                                                 MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    // Fixed capacity so producers never see the slot vector move
+    m_coalesceSlots.clear();
+    m_coalesceSlots.reserve(OS_EVENT_COALESCE_SLOTS);
     m_initialized = true;
+
+    // High-rate events only need their latest value
+    setCoalescePolicy(EVENT_UI_TOUCH_MOVE, CoalescePolicy::LATEST);
+    setCoalescePolicy(EVENT_HAL_SENSOR_UPDATE, CoalescePolicy::LATEST);
+    setCoalescePolicy(EVENT_HAL_BATTERY_CHANGE, CoalescePolicy::LATEST);
+    setCoalescePolicy(EVENT_HAL_FILE_OP_PROGRESS, CoalescePolicy::LATEST);
+
     ESP_LOGI(TAG, "Event System initialized");
     
     return OS_OK;
@@ -33,8 +64,16 @@ os_error_t EventSystem::shutdown() {
     ESP_LOGI(TAG, "Shutting down Event System");
     
     // Clear all listeners and queued events
-    m_listeners.clear();
+    for (auto& list : m_dispatchTable) {
+        list.clear();
+    }
+    m_sparseListeners.clear();
+    m_listenerTypes.clear();
+    m_pendingListeners.clear();
+    m_needsCleanup = false;
     clearQueue();
+    m_coalesceSlots.clear();
+    m_payloadPool.reset();
     
     m_initialized = false;
     ESP_LOGI(TAG, "Event System shutdown complete");
@@ -49,32 +88,136 @@ size_t EventSystem::processEvents() {
 
     size_t eventsProcessed = 0;
     
-    // Process events in batches to avoid blocking too long
-    const size_t maxEventsPerFrame = 10;
-    
-    while (!m_eventQueue.empty() && eventsProcessed < maxEventsPerFrame) {
-        EventData event = m_eventQueue.front();
-        m_eventQueue.pop();
-        
-        size_t listenersNotified = publishSync(event);
-        
-        if (m_loggingEnabled && listenersNotified > 0) {
-            ESP_LOGD(TAG, "Processed async event %d, notified %d listeners", 
-                    event.type, listenersNotified);
-        }
-        
-        eventsProcessed++;
-        m_eventsProcessed++;
+    // Work to a time budget rather than a fixed count; lanes are drained
+    // in priority order so lifecycle events never wait behind telemetry
+    int64_t deadline = esp_timer_get_time() + m_timeBudgetUs;
+
+    size_t depth = getQueuedEventCount();
+    if (depth > m_peakQueueDepth) {
+        m_peakQueueDepth = depth;
     }
+    OS_TRACE_COUNTER("event_queue", depth);
     
-    // Clean up one-shot listeners that have been called
-    if (eventsProcessed > 0) {
-        cleanupListeners();
+    drainLane(m_criticalQueue, EventLane::CRITICAL, deadline, eventsProcessed);
+    drainLane(m_eventQueue, EventLane::NORMAL, deadline, eventsProcessed);
+    drainCoalesced(deadline, eventsProcessed);
+    drainLane(m_telemetryQueue, EventLane::TELEMETRY, deadline, eventsProcessed);
+
+    if (esp_timer_get_time() >= deadline && getQueuedEventCount() > 0) {
+        m_budgetExhausted++;
     }
     
     return eventsProcessed;
 }
 
+template <typename Ring>
+void EventSystem::drainLane(Ring& ring, EventLane lane, int64_t deadline, size_t& processed) {
+    EventData event;
+
+    // Always make progress on at least one event per call
+    while ((processed == 0 || esp_timer_get_time() < deadline) && ring.pop(event)) {
+        // Producers may queue again once we have made room
+        m_overflowing.store(false, std::memory_order_relaxed);
+        dispatchQueued(event, lane);
+        processed++;
+    }
+}
+
+void EventSystem::drainCoalesced(int64_t deadline, size_t& processed) {
+    for (auto& slot : m_coalesceSlots) {
+        if (processed > 0 && esp_timer_get_time() >= deadline) {
+            return;
+        }
+
+        EventData event;
+        bool hasEvent = false;
+
+        portENTER_CRITICAL(&m_coalesceLock);
+        if (slot.hasPending) {
+            event = slot.pending;
+            slot.hasPending = false;
+            hasEvent = true;
+        }
+        portEXIT_CRITICAL(&m_coalesceLock);
+
+        if (hasEvent) {
+            dispatchQueued(event, EventLane::TELEMETRY);
+            processed++;
+        }
+    }
+}
+
+void EventSystem::dispatchQueued(EventData& event, EventLane lane) {
+    size_t listenersNotified = publishSync(event);
+    detachPayload(event);
+
+    if (m_loggingEnabled && listenersNotified > 0) {
+        ESP_LOGD(TAG, "Processed async event %d, notified %d listeners", 
+                event.type, listenersNotified);
+    }
+
+    m_eventsProcessed++;
+    m_laneProcessed[(size_t)lane]++;
+}
+
+bool EventSystem::setCoalescePolicy(EventType eventType, CoalescePolicy policy,
+                                    EventMergeFunction merge) {
+    if (!m_initialized || (policy == CoalescePolicy::MERGE && !merge)) {
+        return false;
+    }
+
+    for (auto& slot : m_coalesceSlots) {
+        if (slot.type == eventType) {
+            portENTER_CRITICAL(&m_coalesceLock);
+            slot.policy = policy;
+            slot.merge = merge;
+            portEXIT_CRITICAL(&m_coalesceLock);
+            return true;
+        }
+    }
+
+    if (policy == CoalescePolicy::NONE) {
+        return true;
+    }
+    if (m_coalesceSlots.size() >= OS_EVENT_COALESCE_SLOTS) {
+        ESP_LOGW(TAG, "No coalescing slot left for event %d", eventType);
+        return false;
+    }
+
+    CoalesceSlot slot;
+    slot.type = eventType;
+    slot.policy = policy;
+    slot.merge = merge;
+    slot.hasPending = false;
+    slot.coalesced = 0;
+
+    portENTER_CRITICAL(&m_coalesceLock);
+    m_coalesceSlots.push_back(slot);
+    portEXIT_CRITICAL(&m_coalesceLock);
+    return true;
+}
+
+EventLane EventSystem::getLane(EventType eventType) {
+    switch (eventType) {
+        case EVENT_UI_TOUCH_MOVE:
+        case EVENT_HAL_SENSOR_UPDATE:
+        case EVENT_HAL_BATTERY_CHANGE:
+            return EventLane::TELEMETRY;
+        default:
+            break;
+    }
+
+    if (eventType < EVENT_USER_DEFINED) {
+        EventType group = eventType / EVENT_GROUP_STRIDE;
+        if (group == EVENT_SYSTEM_STARTUP / EVENT_GROUP_STRIDE ||
+            group == EVENT_APP_LAUNCH / EVENT_GROUP_STRIDE ||
+            group == EVENT_SERVICE_START / EVENT_GROUP_STRIDE) {
+            return EventLane::CRITICAL;
+        }
+    }
+    return EventLane::NORMAL;
+}
+
 ListenerId EventSystem::subscribe(EventType eventType, EventCallback callback, 
                                  uint8_t priority, bool oneShot) {
     if (!m_initialized || !callback) {
@@ -89,13 +232,14 @@ ListenerId EventSystem::subscribe(EventType eventType, EventCallback callback,
     listener.oneShot = oneShot;
     listener.callCount = 0;
 
-    m_listeners[eventType].push_back(listener);
-    
-    // Sort listeners by priority (higher priority first)
-    std::sort(m_listeners[eventType].begin(), m_listeners[eventType].end(),
-              [](const EventListener& a, const EventListener& b) {
-                  return a.priority > b.priority;
-              });
+    m_listenerTypes[listener.id] = eventType;
+
+    if (m_dispatchDepth > 0) {
+        // Don't grow a list that may be mid-iteration
+        m_pendingListeners.push_back(listener);
+    } else {
+        insertListener(listener);
+    }
 
     if (m_loggingEnabled) {
         ESP_LOGD(TAG, "Subscribed listener %d to event %d (priority %d, one-shot: %s)", 
@@ -110,22 +254,34 @@ bool EventSystem::unsubscribe(ListenerId listenerId) {
         return false;
     }
 
-    for (auto& [eventType, listeners] : m_listeners) {
-        auto it = std::find_if(listeners.begin(), listeners.end(),
-                              [listenerId](const EventListener& listener) {
-                                  return listener.id == listenerId;
-                              });
-        
-        if (it != listeners.end()) {
-            if (m_loggingEnabled) {
-                ESP_LOGD(TAG, "Unsubscribed listener %d from event %d", 
-                        listenerId, eventType);
-            }
-            listeners.erase(it);
+    auto typeIt = m_listenerTypes.find(listenerId);
+    if (typeIt == m_listenerTypes.end()) {
+        return false;
+    }
+    EventType eventType = typeIt->second;
+    m_listenerTypes.erase(typeIt);
+
+    if (m_loggingEnabled) {
+        ESP_LOGD(TAG, "Unsubscribed listener %d from event %d", listenerId, eventType);
+    }
+
+    for (auto it = m_pendingListeners.begin(); it != m_pendingListeners.end(); ++it) {
+        if (it->id == listenerId) {
+            m_pendingListeners.erase(it);
             return true;
         }
     }
-    
+
+    ListenerList* listeners = findListeners(eventType);
+    if (listeners) {
+        for (size_t i = 0; i < listeners->size(); i++) {
+            if ((*listeners)[i].id == listenerId) {
+                removeListener(*listeners, i);
+                return true;
+            }
+        }
+    }
+
     return false;
 }
 
@@ -134,19 +290,41 @@ size_t EventSystem::unsubscribeAll(EventType eventType) {
         return 0;
     }
 
-    auto it = m_listeners.find(eventType);
-    if (it != m_listeners.end()) {
-        size_t count = it->second.size();
-        m_listeners.erase(it);
-        
-        if (m_loggingEnabled) {
-            ESP_LOGD(TAG, "Unsubscribed all %d listeners from event %d", count, eventType);
+    size_t count = 0;
+
+    for (auto it = m_pendingListeners.begin(); it != m_pendingListeners.end();) {
+        if (it->eventType == eventType) {
+            m_listenerTypes.erase(it->id);
+            it = m_pendingListeners.erase(it);
+            count++;
+        } else {
+            ++it;
         }
-        
-        return count;
     }
-    
-    return 0;
+
+    ListenerList* listeners = findListeners(eventType);
+    if (listeners) {
+        for (auto& listener : *listeners) {
+            if (listener.id != 0) {
+                m_listenerTypes.erase(listener.id);
+                count++;
+                if (m_dispatchDepth > 0) {
+                    listener.id = 0;
+                    m_needsCleanup = true;
+                }
+            }
+        }
+        if (m_dispatchDepth == 0) {
+            listeners->clear();
+            m_sparseListeners.erase(eventType);
+        }
+    }
+
+    if (m_loggingEnabled && count > 0) {
+        ESP_LOGD(TAG, "Unsubscribed all %d listeners from event %d", count, eventType);
+    }
+
+    return count;
 }
 
 size_t EventSystem::publishSync(const EventData& event) {
@@ -154,19 +332,42 @@ size_t EventSystem::publishSync(const EventData& event) {
         return 0;
     }
 
-    auto listeners = findListeners(event.type);
+    ListenerList* listeners = findListeners(event.type);
+    if (!listeners || listeners->empty()) {
+        return 0;
+    }
+
+    OS_TRACE_SCOPE_ARG("event", event.type);
     size_t notified = 0;
+    m_dispatchDepth++;
+
+    // Walk the list in place; callbacks only tombstone entries or defer
+    // new ones, so neither the size nor the storage changes under us
+    for (size_t i = 0; i < listeners->size(); i++) {
+        EventListener& listener = (*listeners)[i];
+        if (listener.id == 0) {
+            continue;
+        }
 
-    for (auto* listener : listeners) {
         try {
-            listener->callback(event);
-            listener->callCount++;
+            listener.callback(event);
+            listener.callCount++;
             notified++;
             m_listenersNotified++;
         } catch (...) {
             ESP_LOGE(TAG, "Exception in event listener %d for event %d", 
-                    listener->id, event.type);
+                    listener.id, event.type);
         }
+
+        if (listener.oneShot && listener.id != 0) {
+            m_listenerTypes.erase(listener.id);
+            removeListener(*listeners, i);
+        }
+    }
+
+    m_dispatchDepth--;
+    if (m_dispatchDepth == 0) {
+        flushDeferred();
     }
 
     if (m_loggingEnabled && notified > 0) {
@@ -182,21 +383,123 @@ bool EventSystem::publishAsync(const EventData& event) {
         return false;
     }
 
-    if (m_eventQueue.size() >= OS_EVENT_QUEUE_SIZE) {
+    EventData queued = event;
+    attachPayload(queued, false);
+
+    if (!enqueue(queued, false)) {
+        detachPayload(queued);
         ESP_LOGW(TAG, "Event queue full, dropping event %d", event.type);
         return false;
     }
 
-    m_eventQueue.push(event);
-    m_eventsPublished++;
-
     if (m_loggingEnabled) {
         ESP_LOGD(TAG, "Queued async event %d", event.type);
     }
 
+    // Cut a tickless sleep short so the event is dispatched promptly
+    // (a no-op when the main loop itself publishes)
+    OS().wake();
     return true;
 }
 
+bool EventSystem::publishFromISR(const EventData& event) {
+    // No logging here: ESP_LOG is not safe from interrupt context
+    if (!m_initialized) {
+        return false;
+    }
+
+    EventData queued = event;
+    attachPayload(queued, true);
+    if (!enqueue(queued, true)) {
+        return false;
+    }
+
+    OS().wakeFromISR();
+    return true;
+}
+
+bool EventSystem::coalesce(const EventData& event, bool fromISR) {
+    CoalesceSlot* slot = nullptr;
+    for (auto& candidate : m_coalesceSlots) {
+        if (candidate.type == event.type) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (!slot || slot->policy == CoalescePolicy::NONE) {
+        return false;
+    }
+
+    // Pooled payloads displaced by the update are released outside the lock
+    void* displaced[2] = {nullptr, nullptr};
+
+    if (fromISR) {
+        portENTER_CRITICAL_ISR(&m_coalesceLock);
+    } else {
+        portENTER_CRITICAL(&m_coalesceLock);
+    }
+
+    if (!slot->hasPending) {
+        slot->pending = event;
+        slot->hasPending = true;
+    } else {
+        void* previous = (slot->pending.payload == EventPayload::POOLED) ? slot->pending.data : nullptr;
+        if (slot->policy == CoalescePolicy::LATEST) {
+            slot->pending = event;
+        } else {
+            slot->merge(slot->pending, event);
+        }
+        if (previous && slot->pending.data != previous) {
+            displaced[0] = previous;
+        }
+        if (event.payload == EventPayload::POOLED && slot->pending.data != event.data) {
+            displaced[1] = event.data;
+        }
+        slot->coalesced++;
+        m_eventsCoalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (fromISR) {
+        portEXIT_CRITICAL_ISR(&m_coalesceLock);
+    } else {
+        portEXIT_CRITICAL(&m_coalesceLock);
+    }
+
+    // Only pooled payloads are ever displaced, and those are never attached from an ISR
+    releasePayload(displaced[0]);
+    releasePayload(displaced[1]);
+
+    m_eventsPublished.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool EventSystem::enqueue(const EventData& event, bool fromISR) {
+    if (coalesce(event, fromISR)) {
+        return true;
+    }
+
+    bool queued = false;
+    switch (getLane(event.type)) {
+        case EventLane::CRITICAL: queued = m_criticalQueue.push(event); break;
+        case EventLane::NORMAL: queued = m_eventQueue.push(event); break;
+        case EventLane::TELEMETRY: queued = m_telemetryQueue.push(event); break;
+    }
+
+    if (queued) {
+        m_eventsPublished.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    m_eventsDropped.fetch_add(1, std::memory_order_relaxed);
+    if (fromISR) {
+        m_isrEventsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!m_overflowing.exchange(true, std::memory_order_relaxed)) {
+        m_overflowEpisodes.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
 size_t EventSystem::publish(EventType eventType, void* data, size_t dataSize,
                            uint32_t senderId, bool async) {
     EventData event(eventType, data, dataSize, senderId);
@@ -209,31 +512,160 @@ size_t EventSystem::publish(EventType eventType, void* data, size_t dataSize,
 }
 
 bool EventSystem::hasListeners(EventType eventType) const {
-    auto it = m_listeners.find(eventType);
-    return it != m_listeners.end() && !it->second.empty();
+    return getListenerCount(eventType) > 0;
 }
 
 size_t EventSystem::getListenerCount(EventType eventType) const {
-    auto it = m_listeners.find(eventType);
-    return (it != m_listeners.end()) ? it->second.size() : 0;
+    size_t count = 0;
+
+    const ListenerList* listeners = findListeners(eventType);
+    if (listeners) {
+        for (const auto& listener : *listeners) {
+            if (listener.id != 0) {
+                count++;
+            }
+        }
+    }
+    for (const auto& listener : m_pendingListeners) {
+        if (listener.eventType == eventType) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+size_t EventSystem::getQueuedEventCount() const {
+    size_t count = m_criticalQueue.size() + m_eventQueue.size() + m_telemetryQueue.size();
+    for (const auto& slot : m_coalesceSlots) {
+        if (slot.hasPending) {
+            count++;
+        }
+    }
+    return count;
 }
 
 void EventSystem::clearQueue() {
-    while (!m_eventQueue.empty()) {
-        m_eventQueue.pop();
+    EventData event;
+    while (m_criticalQueue.pop(event)) {
+        detachPayload(event);
+    }
+    while (m_eventQueue.pop(event)) {
+        detachPayload(event);
+    }
+    while (m_telemetryQueue.pop(event)) {
+        detachPayload(event);
+    }
+    for (auto& slot : m_coalesceSlots) {
+        if (slot.hasPending) {
+            slot.hasPending = false;
+            detachPayload(slot.pending);
+        }
+    }
+}
+
+void* EventSystem::retainPayload(const EventData& event) {
+    if (event.payload == EventPayload::POOLED) {
+        PayloadHeader* header = reinterpret_cast<PayloadHeader*>(
+            static_cast<uint8_t*>(event.data) - PAYLOAD_HEADER_SIZE);
+        header->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return event.data;
+}
+
+void EventSystem::releasePayload(void* data) {
+    if (!data || !m_payloadPool) {
+        return;
+    }
+
+    uint8_t* block = static_cast<uint8_t*>(data) - PAYLOAD_HEADER_SIZE;
+    if (!m_payloadPool->owns(block)) {
+        return;
+    }
+
+    PayloadHeader* header = reinterpret_cast<PayloadHeader*>(block);
+    if (header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        header->~PayloadHeader();
+        portENTER_CRITICAL(&m_payloadLock);
+        m_payloadPool->deallocate(block);
+        portEXIT_CRITICAL(&m_payloadLock);
+    }
+}
+
+void EventSystem::attachPayload(EventData& event, bool fromISR) {
+    if (event.payload != EventPayload::BORROWED || !event.data || event.dataSize == 0) {
+        return;
+    }
+
+    // Copies are NUL-terminated so string payloads stay usable
+    if (event.dataSize < OS_EVENT_INLINE_PAYLOAD) {
+        memcpy(event.inlineData, event.data, event.dataSize);
+        event.inlineData[event.dataSize] = 0;
+        event.data = event.inlineData;
+        event.payload = EventPayload::INLINE;
+        m_inlinePayloads.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!fromISR && m_payloadPool &&
+        event.dataSize < OS_EVENT_PAYLOAD_BLOCK - PAYLOAD_HEADER_SIZE) {
+        portENTER_CRITICAL(&m_payloadLock);
+        void* block = m_payloadPool->allocate();
+        portEXIT_CRITICAL(&m_payloadLock);
+
+        if (block) {
+            PayloadHeader* header = new (block) PayloadHeader;
+            header->refs.store(1, std::memory_order_relaxed);
+            header->size = (uint16_t)event.dataSize;
+
+            uint8_t* payload = static_cast<uint8_t*>(block) + PAYLOAD_HEADER_SIZE;
+            memcpy(payload, event.data, event.dataSize);
+            payload[event.dataSize] = 0;
+            event.data = payload;
+            event.payload = EventPayload::POOLED;
+            m_pooledPayloads.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Too large or pool exhausted: the publisher must keep the data alive
+    m_borrowedPayloads.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventSystem::detachPayload(const EventData& event) {
+    if (event.payload == EventPayload::POOLED) {
+        releasePayload(event.data);
     }
 }
 
 void EventSystem::printStats() const {
     ESP_LOGI(TAG, "=== Event System Statistics ===");
-    ESP_LOGI(TAG, "Events published: %d", m_eventsPublished);
+    ESP_LOGI(TAG, "Events published: %d", m_eventsPublished.load());
     ESP_LOGI(TAG, "Events processed: %d", m_eventsProcessed);
     ESP_LOGI(TAG, "Listeners notified: %d", m_listenersNotified);
-    ESP_LOGI(TAG, "Queued events: %d/%d", m_eventQueue.size(), OS_EVENT_QUEUE_SIZE);
-    ESP_LOGI(TAG, "Event types with listeners: %d", m_listeners.size());
+    ESP_LOGI(TAG, "Queued events: %d (peak %d)", getQueuedEventCount(), m_peakQueueDepth);
+    ESP_LOGI(TAG, "Lanes: critical %d/%d, normal %d/%d, telemetry %d/%d queued",
+            m_criticalQueue.size(), OS_EVENT_CRITICAL_QUEUE_SIZE,
+            m_eventQueue.size(), OS_EVENT_QUEUE_SIZE,
+            m_telemetryQueue.size(), OS_EVENT_TELEMETRY_QUEUE_SIZE);
+    ESP_LOGI(TAG, "Processed per lane: critical=%d normal=%d telemetry=%d",
+            m_laneProcessed[0], m_laneProcessed[1], m_laneProcessed[2]);
+    ESP_LOGI(TAG, "Time budget: %d us, exhausted %d times; events coalesced: %d",
+            m_timeBudgetUs, m_budgetExhausted, m_eventsCoalesced.load());
+    for (const auto& slot : m_coalesceSlots) {
+        ESP_LOGI(TAG, "  Coalesced event %d: %s, %d merged",
+                slot.type, slot.policy == CoalescePolicy::LATEST ? "latest" :
+                slot.policy == CoalescePolicy::MERGE ? "merge" : "off", slot.coalesced);
+    }
+    ESP_LOGI(TAG, "Events dropped: %d (%d from ISR), overflow episodes: %d",
+            m_eventsDropped.load(), m_isrEventsDropped.load(), m_overflowEpisodes.load());
+    ESP_LOGI(TAG, "Listeners registered: %d", m_listenerTypes.size());
+    ESP_LOGI(TAG, "Async payloads: inline=%d pooled=%d borrowed=%d, pool %d/%d slots free",
+            m_inlinePayloads.load(), m_pooledPayloads.load(), m_borrowedPayloads.load(),
+            m_payloadPool ? m_payloadPool->getFreeBlocks() : 0, OS_EVENT_PAYLOAD_BLOCKS);
 
     ESP_LOGI(TAG, "=== Event Type Statistics ===");
-    for (const auto& [eventType, listeners] : m_listeners) {
+    auto printListeners = [](EventType eventType, const ListenerList& listeners) {
         ESP_LOGI(TAG, "Event %d: %d listeners", eventType, listeners.size());
         
         for (const auto& listener : listeners) {
@@ -241,29 +673,180 @@ void EventSystem::printStats() const {
                     listener.id, listener.priority, listener.callCount,
                     listener.oneShot ? "yes" : "no");
         }
+    };
+
+    for (size_t i = 0; i < EVENT_GROUP_COUNT * EVENT_GROUP_SPAN; i++) {
+        if (!m_dispatchTable[i].empty()) {
+            printListeners(denseType(i), m_dispatchTable[i]);
+        }
+    }
+    for (const auto& [eventType, listeners] : m_sparseListeners) {
+        printListeners(eventType, listeners);
     }
 }
 
-std::vector<EventListener*> EventSystem::findListeners(EventType eventType) {
-    std::vector<EventListener*> result;
-    
-    auto it = m_listeners.find(eventType);
-    if (it != m_listeners.end()) {
-        for (auto& listener : it->second) {
-            result.push_back(&listener);
+os_error_t EventSystem::runDispatchBenchmark(uint32_t iterations,
+                                             std::vector<DispatchBenchmarkResult>& results) {
+    // Last user-defined slot of the dense table is reserved for the benchmark
+    const EventType benchType = EVENT_USER_DEFINED + EVENT_GROUP_SPAN - 1;
+    static const uint16_t listenerCounts[] = {0, 1, 4, 16, 64};
+    static const uint32_t asyncBatch = 32;      // Well inside the normal lane
+
+    if (!m_initialized || iterations == 0 || hasListeners(benchType)) {
+        return OS_ERROR_BUSY;
+    }
+
+    volatile uint32_t sink = 0;
+    size_t subscribed = 0;
+    EventData event(benchType);
+    results.clear();
+
+    // Events already queued would be counted in the async figures
+    while (processEvents() > 0) {
+    }
+
+    for (uint16_t count : listenerCounts) {
+        while (subscribed < count) {
+            subscribe(benchType, [&sink](const EventData& e) { sink = sink + e.type; });
+            subscribed++;
+        }
+
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++) {
+            publishSync(event);
+        }
+        int64_t syncUs = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (uint32_t done = 0; done < iterations; ) {
+            uint32_t batch = std::min(asyncBatch, iterations - done);
+            for (uint32_t i = 0; i < batch; i++) {
+                publishAsync(event);
+            }
+            while (processEvents() > 0) {
+            }
+            done += batch;
         }
+        int64_t asyncUs = esp_timer_get_time() - start;
+
+        DispatchBenchmarkResult result;
+        result.listeners = count;
+        result.syncNs = (uint32_t)((syncUs * 1000) / iterations);
+        result.asyncNs = (uint32_t)((asyncUs * 1000) / iterations);
+        results.push_back(result);
+    }
+
+    unsubscribeAll(benchType);
+    return OS_OK;
+}
+
+void EventSystem::runDispatchBenchmark(uint32_t iterations) {
+    std::vector<DispatchBenchmarkResult> results;
+    if (runDispatchBenchmark(iterations, results) != OS_OK) {
+        ESP_LOGW(TAG, "Dispatch benchmark unavailable");
+        return;
+    }
+
+    ESP_LOGI(TAG, "=== Event Dispatch Benchmark (%d publishes) ===", iterations);
+    for (const DispatchBenchmarkResult& result : results) {
+        ESP_LOGI(TAG, "%d listeners: %d ns/publish, %d ns queued", result.listeners,
+                 result.syncNs, result.asyncNs);
+    }
+}
+
+int EventSystem::denseIndex(EventType eventType) {
+    size_t group;
+    EventType offset;
+
+    if (eventType >= EVENT_USER_DEFINED) {
+        group = EVENT_GROUP_COUNT - 1;
+        offset = eventType - EVENT_USER_DEFINED;
+    } else {
+        EventType base = eventType / EVENT_GROUP_STRIDE;
+        if (base < 1 || base >= EVENT_GROUP_COUNT) {
+            return -1;
+        }
+        group = base - 1;
+        offset = eventType - base * EVENT_GROUP_STRIDE;
+    }
+
+    if (offset >= EVENT_GROUP_SPAN) {
+        return -1;
+    }
+    return (int)(group * EVENT_GROUP_SPAN + offset);
+}
+
+EventType EventSystem::denseType(size_t index) {
+    size_t group = index / EVENT_GROUP_SPAN;
+    EventType offset = index % EVENT_GROUP_SPAN;
+
+    if (group == EVENT_GROUP_COUNT - 1) {
+        return EVENT_USER_DEFINED + offset;
+    }
+    return (group + 1) * EVENT_GROUP_STRIDE + offset;
+}
+
+EventSystem::ListenerList* EventSystem::findListeners(EventType eventType) {
+    int index = denseIndex(eventType);
+    if (index >= 0) {
+        return &m_dispatchTable[index];
+    }
+
+    auto it = m_sparseListeners.find(eventType);
+    return (it != m_sparseListeners.end()) ? &it->second : nullptr;
+}
+
+const EventSystem::ListenerList* EventSystem::findListeners(EventType eventType) const {
+    return const_cast<EventSystem*>(this)->findListeners(eventType);
+}
+
+void EventSystem::insertListener(const EventListener& listener) {
+    int index = denseIndex(listener.eventType);
+    ListenerList& listeners = (index >= 0) ? m_dispatchTable[index]
+                                           : m_sparseListeners[listener.eventType];
+
+    // Higher priority first; equal priorities keep subscription order
+    auto pos = std::find_if(listeners.begin(), listeners.end(),
+                           [&listener](const EventListener& other) {
+                               return other.priority < listener.priority;
+                           });
+    listeners.insert(pos, listener);
+}
+
+void EventSystem::removeListener(ListenerList& list, size_t index) {
+    if (m_dispatchDepth > 0) {
+        // Tombstone: the callback may still be running
+        list[index].id = 0;
+        m_needsCleanup = true;
+    } else {
+        list.erase(list.begin() + index);
+    }
+}
+
+void EventSystem::flushDeferred() {
+    if (m_needsCleanup) {
+        cleanupListeners();
+        m_needsCleanup = false;
+    }
+
+    if (!m_pendingListeners.empty()) {
+        for (const auto& listener : m_pendingListeners) {
+            insertListener(listener);
+        }
+        m_pendingListeners.clear();
     }
-    
-    return result;
 }
 
 void EventSystem::cleanupListeners() {
-    for (auto& [eventType, listeners] : m_listeners) {
-        listeners.erase(
-            std::remove_if(listeners.begin(), listeners.end(),
-                          [](const EventListener& listener) {
-                              return listener.oneShot && listener.callCount > 0;
-                          }),
-            listeners.end());
-    }
-}
\ No newline at end of file
+    auto isTombstone = [](const EventListener& listener) { return listener.id == 0; };
+
+    for (auto& listeners : m_dispatchTable) {
+        listeners.erase(std::remove_if(listeners.begin(), listeners.end(), isTombstone),
+                        listeners.end());
+    }
+    for (auto it = m_sparseListeners.begin(); it != m_sparseListeners.end();) {
+        it->second.erase(std::remove_if(it->second.begin(), it->second.end(), isTombstone),
+                         it->second.end());
+        it = it->second.empty() ? m_sparseListeners.erase(it) : std::next(it);
+    }
+}
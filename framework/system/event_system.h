@@ -2,9 +2,12 @@
 #define EVENT_SYSTEM_H
 
 #include "os_config.h"
+#include "event_ring.h"
+#include "memory_manager.h"
+#include <freertos/FreeRTOS.h>
+#include <atomic>
 #include <functional>
 #include <vector>
-#include <queue>
 #include <map>
 
 /**
@@ -13,6 +16,24 @@
  * 
  * Provides a publish-subscribe event system for loose coupling
  * between system components and applications.
+ *
+ * Async events go through a fixed-capacity lock-free ring, so they can
+ * be published from any FreeRTOS task or ISR and are dispatched on the
+ * main loop by processEvents().
+ *
+ * Listeners live in a dense table indexed by event group and offset,
+ * kept in priority order at insertion time, so dispatch walks them in
+ * place without allocating. Types outside the dense ranges fall back
+ * to a sparse map.
+ *
+ * Async payloads are copied at publish time: up to
+ * OS_EVENT_INLINE_PAYLOAD bytes travel inside EventData, larger ones go
+ * into refcounted pool slots released after the last listener returns.
+ *
+ * Queued events are split into priority lanes so lifecycle events run
+ * ahead of telemetry, and processEvents() works to a microsecond budget.
+ * High-rate types can be coalesced so only the latest (or a merged)
+ * event is pending at a time.
  */
 
 typedef uint32_t EventType;
@@ -40,7 +61,10 @@ enum SystemEvents : EventType {
     EVENT_HAL_BUTTON_PRESS = 4000,
     EVENT_HAL_BUTTON_RELEASE,
     EVENT_HAL_SENSOR_UPDATE,
-    EVENT_HAL_BATTERY_CHANGE,
+    EVENT_HAL_BATTERY_CHANGE,       // data: uint8_t level; published on level/charge changes
+    EVENT_HAL_WIFI_CHANGE,          // data: uint8_t enabled
+    EVENT_HAL_FILE_OP_PROGRESS,     // data: FileOpStatus of the running file operation
+    EVENT_HAL_FILE_OP_COMPLETE,     // data: FileOpStatus, final
     
     EVENT_SERVICE_START = 5000,
     EVENT_SERVICE_STOP,
@@ -49,21 +73,77 @@ enum SystemEvents : EventType {
     EVENT_USER_DEFINED = 10000
 };
 
+// Dense dispatch table layout: one row per SystemEvents group
+static constexpr EventType EVENT_GROUP_STRIDE = 1000;
+static constexpr size_t EVENT_GROUP_SPAN = 32;   // Event types per group held in the dense table
+static constexpr size_t EVENT_GROUP_COUNT = 6;   // System, UI, app, HAL, service, user-defined
+
+/**
+ * @brief Dispatch lane; lower lanes are drained first
+ */
+enum class EventLane : uint8_t {
+    CRITICAL,   // System, app lifecycle and service events
+    NORMAL,     // Discrete UI/HAL and user-defined events
+    TELEMETRY   // High-rate touch move and sensor updates
+};
+
+static constexpr size_t EVENT_LANE_COUNT = 3;
+
+/**
+ * @brief How repeated events of one type are combined while pending
+ */
+enum class CoalescePolicy : uint8_t {
+    NONE,       // Queue every event
+    LATEST,     // Keep only the most recent event
+    MERGE       // Fold new events into the pending one
+};
+
+enum class EventPayload : uint8_t {
+    BORROWED,   // data points at publisher-owned memory
+    INLINE,     // data points at inlineData inside the event
+    POOLED      // data points into a refcounted pool slot
+};
+
 struct EventData {
     EventType type;
     void* data;
     size_t dataSize;
     uint32_t timestamp;
     uint32_t senderId;
+    EventPayload payload;
+    uint8_t inlineData[OS_EVENT_INLINE_PAYLOAD];
     
-    EventData() : type(0), data(nullptr), dataSize(0), timestamp(0), senderId(0) {}
+    EventData() : type(0), data(nullptr), dataSize(0), timestamp(0), senderId(0),
+                  payload(EventPayload::BORROWED) {}
     
     EventData(EventType t, void* d = nullptr, size_t size = 0, uint32_t sender = 0)
-        : type(t), data(d), dataSize(size), timestamp(millis()), senderId(sender) {}
+        : type(t), data(d), dataSize(size), timestamp(millis()), senderId(sender),
+          payload(EventPayload::BORROWED) {}
+
+    // Copies keep an inline payload pointing at their own buffer
+    EventData(const EventData& other) { *this = other; }
+
+    EventData& operator=(const EventData& other) {
+        type = other.type;
+        dataSize = other.dataSize;
+        timestamp = other.timestamp;
+        senderId = other.senderId;
+        payload = other.payload;
+        if (payload == EventPayload::INLINE) {
+            memcpy(inlineData, other.inlineData, dataSize + 1);
+            data = inlineData;
+        } else {
+            data = other.data;
+        }
+        return *this;
+    }
 };
 
 typedef std::function<void(const EventData&)> EventCallback;
 
+// Folds incoming into pending; runs under a spinlock, so keep it short
+typedef std::function<void(EventData& pending, const EventData& incoming)> EventMergeFunction;
+
 struct EventListener {
     ListenerId id;
     EventType eventType;
@@ -73,6 +153,15 @@ struct EventListener {
     uint32_t callCount;
 };
 
+/**
+ * @brief One listener count measured by EventSystem::runDispatchBenchmark()
+ */
+struct DispatchBenchmarkResult {
+    uint16_t listeners;
+    uint32_t syncNs;            // publishSync, per event
+    uint32_t asyncNs;           // publishAsync plus its share of processEvents, per event
+};
+
 class EventSystem {
 public:
     EventSystem() = default;
@@ -129,12 +218,19 @@ public:
     size_t publishSync(const EventData& event);
 
     /**
-     * @brief Queue an event for async processing
+     * @brief Queue an event for async processing (any task)
      * @param event Event data to queue
      * @return true if event was queued, false if queue is full
      */
     bool publishAsync(const EventData& event);
 
+    /**
+     * @brief Queue an event from an interrupt handler
+     * @param event Event data to queue (data must outlive dispatch)
+     * @return true if event was queued, false if queue is full
+     */
+    bool publishFromISR(const EventData& event);
+
     /**
      * @brief Publish an event with simple data
      * @param eventType Event type
@@ -147,6 +243,44 @@ public:
     size_t publish(EventType eventType, void* data = nullptr, size_t dataSize = 0,
                   uint32_t senderId = 0, bool async = true);
 
+    /**
+     * @brief Set how pending events of a type are coalesced
+     * @param eventType Event type to configure
+     * @param policy Coalescing policy (NONE removes coalescing)
+     * @param merge Merge function, required for CoalescePolicy::MERGE
+     * @return true on success, false if no slot is free or merge is missing
+     * @note Configure policies during start-up, before producers run
+     */
+    bool setCoalescePolicy(EventType eventType, CoalescePolicy policy,
+                           EventMergeFunction merge = nullptr);
+
+    /**
+     * @brief Set the per-call dispatch budget for processEvents()
+     * @param budgetUs Budget in microseconds
+     */
+    void setTimeBudget(uint32_t budgetUs) { m_timeBudgetUs = budgetUs; }
+
+    /**
+     * @brief Get the lane an event type is queued on
+     * @param eventType Event type
+     * @return Dispatch lane
+     */
+    static EventLane getLane(EventType eventType);
+
+    /**
+     * @brief Keep a pooled payload alive past the listener callback
+     * @param event Event whose payload to retain
+     * @return Payload pointer (release with releasePayload), or the
+     *         borrowed pointer unchanged for non-pooled payloads
+     */
+    void* retainPayload(const EventData& event);
+
+    /**
+     * @brief Drop a reference taken with retainPayload()
+     * @param data Pointer returned by retainPayload()
+     */
+    void releasePayload(void* data);
+
     /**
      * @brief Check if there are listeners for an event type
      * @param eventType Event type to check
@@ -165,7 +299,13 @@ public:
      * @brief Get number of queued events
      * @return Number of events in queue
      */
-    size_t getQueuedEventCount() const { return m_eventQueue.size(); }
+    size_t getQueuedEventCount() const;
+
+    /**
+     * @brief Get number of async events dropped because the queue was full
+     * @return Dropped event count
+     */
+    uint32_t getDroppedEventCount() const { return m_eventsDropped.load(std::memory_order_relaxed); }
 
     /**
      * @brief Clear all queued events
@@ -183,33 +323,172 @@ public:
      */
     void setLoggingEnabled(bool enabled) { m_loggingEnabled = enabled; }
 
+    /**
+     * @brief Measure publishSync cost against listener count and log it
+     * @param iterations Publishes per measurement
+     */
+    void runDispatchBenchmark(uint32_t iterations = 1000);
+
+    /**
+     * @brief Measure sync and queued dispatch against listener count (main task)
+     * @param iterations Publishes per measurement
+     * @param results Output, one row per listener count
+     * @return OS_OK, or OS_ERROR_BUSY if the benchmark event type is in use
+     */
+    os_error_t runDispatchBenchmark(uint32_t iterations, std::vector<DispatchBenchmarkResult>& results);
+
 private:
+    typedef std::vector<EventListener> ListenerList;
+
     /**
      * @brief Generate unique listener ID
      * @return Unique listener ID
      */
     ListenerId generateListenerId() { return ++m_nextListenerId; }
 
+    /**
+     * @brief Map an event type to its dense table row
+     * @param eventType Event type
+     * @return Row index or -1 if the type is outside the dense ranges
+     */
+    static int denseIndex(EventType eventType);
+
+    /**
+     * @brief Map a dense table row back to its event type
+     * @param index Row index
+     * @return Event type
+     */
+    static EventType denseType(size_t index);
+
     /**
      * @brief Find listeners for an event type
      * @param eventType Event type to find
-     * @return Vector of listeners (sorted by priority)
+     * @return Listener list (priority order) or nullptr if none
      */
-    std::vector<EventListener*> findListeners(EventType eventType);
+    ListenerList* findListeners(EventType eventType);
+    const ListenerList* findListeners(EventType eventType) const;
 
     /**
-     * @brief Remove one-shot listeners that have been called
+     * @brief Insert a listener in priority order
+     * @param listener Listener to insert
+     */
+    void insertListener(const EventListener& listener);
+
+    /**
+     * @brief Drop a listener, deferring the erase while dispatching
+     * @param list List holding the listener
+     * @param index Index of the listener in the list
+     */
+    void removeListener(ListenerList& list, size_t index);
+
+    /**
+     * @brief Apply subscribe/unsubscribe calls made during dispatch
+     */
+    void flushDeferred();
+
+    /**
+     * @brief Erase tombstoned listeners
      */
     void cleanupListeners();
 
-    // Event listeners organized by type
-    std::map<EventType, std::vector<EventListener>> m_listeners;
+    /**
+     * @brief Push to the ring and account for drops (any context)
+     * @param event Event to queue
+     * @param fromISR True when called from an interrupt handler
+     * @return true if queued
+     */
+    bool enqueue(const EventData& event, bool fromISR);
+
+    /**
+     * @brief Absorb an event into its coalescing slot
+     * @param event Event to coalesce
+     * @param fromISR True when called from an interrupt handler
+     * @return true if the event was absorbed, false if its type is not coalesced
+     */
+    bool coalesce(const EventData& event, bool fromISR);
+
+    /**
+     * @brief Dispatch events from one lane until empty or out of budget
+     * @param ring Lane ring buffer
+     * @param lane Lane being drained
+     * @param deadline esp_timer deadline in microseconds
+     * @param processed Running count of events processed this call
+     */
+    template <typename Ring>
+    void drainLane(Ring& ring, EventLane lane, int64_t deadline, size_t& processed);
+
+    /**
+     * @brief Dispatch pending coalesced events until done or out of budget
+     * @param deadline esp_timer deadline in microseconds
+     * @param processed Running count of events processed this call
+     */
+    void drainCoalesced(int64_t deadline, size_t& processed);
+
+    /**
+     * @brief Dispatch one dequeued event and release its payload
+     * @param event Event to dispatch
+     * @param lane Lane the event came from
+     */
+    void dispatchQueued(EventData& event, EventLane lane);
+
+    /**
+     * @brief Copy a borrowed payload into inline or pooled storage
+     * @param event Event to update in place
+     * @param fromISR True when called from an interrupt handler (inline only)
+     */
+    void attachPayload(EventData& event, bool fromISR);
+
+    /**
+     * @brief Release the storage owned by a queued event
+     * @param event Event whose payload is no longer needed
+     */
+    void detachPayload(const EventData& event);
+
+    // Event listeners: dense rows for grouped types, sparse map for the rest
+    ListenerList m_dispatchTable[EVENT_GROUP_COUNT * EVENT_GROUP_SPAN];
+    std::map<EventType, ListenerList> m_sparseListeners;
+    std::map<ListenerId, EventType> m_listenerTypes;
+
+    // Refcounted storage for async payloads above the inline size
+    std::unique_ptr<MemoryPool> m_payloadPool;
+    portMUX_TYPE m_payloadLock = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<uint32_t> m_inlinePayloads{0};
+    std::atomic<uint32_t> m_pooledPayloads{0};
+    std::atomic<uint32_t> m_borrowedPayloads{0};
+
+    // Subscriptions made from inside a callback, applied after dispatch
+    ListenerList m_pendingListeners;
+    uint8_t m_dispatchDepth = 0;
+    bool m_needsCleanup = false;
     
-    // Event queue for async processing
-    std::queue<EventData> m_eventQueue;
+    // Event queues for async processing (multi-producer, main loop consumer)
+    EventRing<EventData, OS_EVENT_CRITICAL_QUEUE_SIZE> m_criticalQueue;
+    EventRing<EventData, OS_EVENT_QUEUE_SIZE> m_eventQueue;
+    EventRing<EventData, OS_EVENT_TELEMETRY_QUEUE_SIZE> m_telemetryQueue;
+
+    // Coalescing slots (fixed capacity, configured at start-up)
+    struct CoalesceSlot {
+        EventType type;
+        CoalescePolicy policy;
+        EventMergeFunction merge;
+        EventData pending;
+        bool hasPending;
+        uint32_t coalesced;
+    };
+    std::vector<CoalesceSlot> m_coalesceSlots;
+    portMUX_TYPE m_coalesceLock = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t m_timeBudgetUs = OS_EVENT_TIME_BUDGET_US;
     
-    // Statistics
-    uint32_t m_eventsPublished = 0;
+    // Statistics (producer-side counters are updated from any context)
+    std::atomic<uint32_t> m_eventsPublished{0};
+    std::atomic<uint32_t> m_eventsDropped{0};
+    std::atomic<uint32_t> m_isrEventsDropped{0};
+    std::atomic<uint32_t> m_overflowEpisodes{0};
+    std::atomic<bool> m_overflowing{false};
+    std::atomic<uint32_t> m_eventsCoalesced{0};
+    size_t m_peakQueueDepth = 0;
+    uint32_t m_laneProcessed[EVENT_LANE_COUNT] = {};
+    uint32_t m_budgetExhausted = 0;
     uint32_t m_eventsProcessed = 0;
     uint32_t m_listenersNotified = 0;
     
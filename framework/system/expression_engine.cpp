@@ -0,0 +1,491 @@
+#include "expression_engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+static constexpr int MAX_EXPRESSION_DEPTH = 32;  // Nesting guard for the recursive compiler
+
+/**
+ * @brief Single-pass tokenizer and recursive-descent compiler to postfix
+ */
+class ExpressionCompiler {
+public:
+    explicit ExpressionCompiler(std::vector<CompiledExpression::Instruction>& code) : m_code(code) {}
+
+    CellError run(const char* text) {
+        m_error = tokenize(text);
+        if (m_error == CellError::NONE) {
+            parseExpression();
+            if (peek().type != TokenType::END) {
+                fail(CellError::PARSE);
+            }
+        }
+        return m_error;
+    }
+
+private:
+    typedef CompiledExpression::Op Op;
+    typedef CompiledExpression::Function Function;
+
+    enum class TokenType : uint8_t {
+        END,
+        NUMBER,
+        CELL,
+        RANGE,
+        FUNCTION,       // Name and its opening parenthesis
+        PLUS,
+        MINUS,
+        STAR,
+        SLASH,
+        PERCENT,
+        OPEN,
+        CLOSE,
+        COMMA
+    };
+
+    struct Token {
+        TokenType type;
+        Function function;
+        union {
+            double number;
+            uint32_t key;
+            CellRange range;
+        };
+    };
+
+    static bool inSheet(int row, int col) {
+        return row >= 0 && row < OS_SHEET_MAX_ROWS && col >= 0 && col < OS_SHEET_MAX_COLS;
+    }
+
+    static bool isLetter(char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+
+    static bool lookupFunction(const char* name, size_t length, Function& function) {
+        static const struct {
+            const char* name;
+            Function function;
+        } functions[] = {
+            {"SUM", Function::SUM}, {"AVG", Function::AVERAGE}, {"AVERAGE", Function::AVERAGE},
+            {"MIN", Function::MIN}, {"MAX", Function::MAX}, {"COUNT", Function::COUNT},
+        };
+        for (const auto& entry : functions) {
+            if (strlen(entry.name) == length && strncasecmp(entry.name, name, length) == 0) {
+                function = entry.function;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    CellError tokenize(const char* p) {
+        m_tokens.clear();
+        while (true) {
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            Token token = {};
+            char c = *p;
+            if (c == '\0') {
+                token.type = TokenType::END;
+                m_tokens.push_back(token);
+                return CellError::NONE;
+            }
+
+            if ((c >= '0' && c <= '9') || c == '.') {
+                const char* start = p;
+                while ((*p >= '0' && *p <= '9') || *p == '.') {
+                    p++;
+                }
+                if (*p == 'e' || *p == 'E') {
+                    const char* exponent = p + 1;
+                    if (*exponent == '+' || *exponent == '-') {
+                        exponent++;
+                    }
+                    if (*exponent >= '0' && *exponent <= '9') {
+                        p = exponent;
+                        while (*p >= '0' && *p <= '9') {
+                            p++;
+                        }
+                    }
+                }
+                // strtod would also take hex and "inf"; only hand it the span scanned
+                char digits[40];
+                size_t length = p - start;
+                if (length >= sizeof(digits)) {
+                    return CellError::PARSE;
+                }
+                memcpy(digits, start, length);
+                digits[length] = '\0';
+                char* end = nullptr;
+                token.type = TokenType::NUMBER;
+                token.number = strtod(digits, &end);
+                if (end != digits + length) {
+                    return CellError::PARSE;
+                }
+            } else if (isLetter(c) || c == '$') {
+                // A run of letters followed by '(' is a function, otherwise a reference
+                const char* name = p;
+                while (isLetter(*p)) {
+                    p++;
+                }
+                const char* after = p;
+                while (*after == ' ' || *after == '\t') {
+                    after++;
+                }
+                if (p > name && *after == '(') {
+                    if (!lookupFunction(name, p - name, token.function)) {
+                        return CellError::PARSE;
+                    }
+                    token.type = TokenType::FUNCTION;
+                    p = after + 1;
+                } else {
+                    p = name;
+                    int row0, col0;
+                    size_t used = CompiledExpression::parseCellName(p, row0, col0);
+                    if (used == 0) {
+                        return CellError::PARSE;
+                    }
+                    p += used;
+                    after = p;
+                    while (*after == ' ' || *after == '\t') {
+                        after++;
+                    }
+                    if (*after == ':') {
+                        p = after + 1;
+                        while (*p == ' ' || *p == '\t') {
+                            p++;
+                        }
+                        int row1, col1;
+                        used = CompiledExpression::parseCellName(p, row1, col1);
+                        if (used == 0) {
+                            return CellError::PARSE;
+                        }
+                        p += used;
+                        if (!inSheet(row0, col0) || !inSheet(row1, col1)) {
+                            return CellError::REF;
+                        }
+                        token.type = TokenType::RANGE;
+                        token.range = {(uint16_t)std::min(row0, row1), (uint16_t)std::min(col0, col1),
+                                       (uint16_t)std::max(row0, row1), (uint16_t)std::max(col0, col1)};
+                    } else {
+                        if (!inSheet(row0, col0)) {
+                            return CellError::REF;
+                        }
+                        token.type = TokenType::CELL;
+                        token.key = cellKey(row0, col0);
+                    }
+                }
+            } else if ((uint8_t)c == 0xC3 && ((uint8_t)p[1] == 0x97 || (uint8_t)p[1] == 0xB7)) {
+                token.type = (uint8_t)p[1] == 0x97 ? TokenType::STAR : TokenType::SLASH;    // × and ÷
+                p += 2;
+            } else {
+                switch (c) {
+                    case '+': token.type = TokenType::PLUS; break;
+                    case '-': token.type = TokenType::MINUS; break;
+                    case '*': token.type = TokenType::STAR; break;
+                    case '/': token.type = TokenType::SLASH; break;
+                    case '%': token.type = TokenType::PERCENT; break;
+                    case '(': token.type = TokenType::OPEN; break;
+                    case ')': token.type = TokenType::CLOSE; break;
+                    case ',': token.type = TokenType::COMMA; break;
+                    default: return CellError::PARSE;
+                }
+                p++;
+            }
+            m_tokens.push_back(token);
+        }
+    }
+
+    const Token& peek() const { return m_tokens[m_position]; }
+
+    bool accept(TokenType type) {
+        if (m_error == CellError::NONE && peek().type == type) {
+            m_position++;
+            return true;
+        }
+        return false;
+    }
+
+    void fail(CellError error) {
+        if (m_error == CellError::NONE) {
+            m_error = error;
+        }
+    }
+
+    // Track the value stack the program will need, and refuse what would overflow it
+    void emit(Op op, int stackChange) {
+        CompiledExpression::Instruction instruction = {};
+        instruction.op = op;
+        m_code.push_back(instruction);
+        m_stack += stackChange;
+        if (m_stack > OS_EXPR_MAX_STACK) {
+            fail(CellError::PARSE);
+        }
+    }
+
+    void parseExpression() {
+        if (++m_depth > MAX_EXPRESSION_DEPTH) {
+            fail(CellError::PARSE);
+        }
+        parseTerm();
+        while (m_error == CellError::NONE) {
+            if (accept(TokenType::PLUS)) {
+                parseTerm();
+                emit(Op::ADD, -1);
+            } else if (accept(TokenType::MINUS)) {
+                parseTerm();
+                emit(Op::SUBTRACT, -1);
+            } else {
+                break;
+            }
+        }
+        m_depth--;
+    }
+
+    void parseTerm() {
+        parseUnary();
+        while (m_error == CellError::NONE) {
+            if (accept(TokenType::STAR)) {
+                parseUnary();
+                emit(Op::MULTIPLY, -1);
+            } else if (accept(TokenType::SLASH)) {
+                parseUnary();
+                emit(Op::DIVIDE, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseUnary() {
+        // A run of signs is folded in a loop: recursing per sign would let
+        // a long "----1" overflow the stack past the depth guard
+        bool negate = false;
+        while (true) {
+            if (accept(TokenType::MINUS)) {
+                negate = !negate;
+            } else if (!accept(TokenType::PLUS)) {
+                break;
+            }
+        }
+        parsePrimary();
+        while (accept(TokenType::PERCENT)) {
+            emit(Op::PERCENT, 0);
+        }
+        if (negate) {
+            emit(Op::NEGATE, 0);
+        }
+    }
+
+    void parsePrimary() {
+        if (m_error != CellError::NONE) {
+            return;
+        }
+        const Token& token = peek();
+        switch (token.type) {
+            case TokenType::NUMBER:
+                m_position++;
+                emit(Op::NUMBER, 1);
+                m_code.back().number = token.number;
+                break;
+            case TokenType::CELL:
+                m_position++;
+                emit(Op::CELL, 1);
+                m_code.back().key = token.key;
+                break;
+            case TokenType::OPEN:
+                m_position++;
+                parseExpression();
+                if (!accept(TokenType::CLOSE)) {
+                    fail(CellError::PARSE);
+                }
+                break;
+            case TokenType::FUNCTION:
+                m_position++;
+                parseFunction(token.function);
+                break;
+            default:
+                fail(CellError::PARSE);     // Includes a range outside a function
+                break;
+        }
+    }
+
+    void parseFunction(Function function) {
+        if (++m_nesting > OS_EXPR_MAX_NESTING) {
+            fail(CellError::PARSE);
+        }
+        emit(Op::AGGREGATE_BEGIN, 0);
+        if (!accept(TokenType::CLOSE)) {
+            do {
+                if (peek().type == TokenType::RANGE) {
+                    emit(Op::AGGREGATE_RANGE, 0);
+                    m_code.back().range = peek().range;
+                    m_position++;
+                } else {
+                    parseExpression();
+                    emit(Op::AGGREGATE_VALUE, -1);
+                }
+            } while (accept(TokenType::COMMA));
+            if (!accept(TokenType::CLOSE)) {
+                fail(CellError::PARSE);
+            }
+        }
+        emit(Op::AGGREGATE_END, 1);
+        m_code.back().function = function;
+        m_nesting--;
+    }
+
+    std::vector<CompiledExpression::Instruction>& m_code;
+    std::vector<Token> m_tokens;
+    size_t m_position = 0;
+    CellError m_error = CellError::NONE;
+    int m_depth = 0;
+    int m_nesting = 0;
+    int m_stack = 0;
+};
+
+CellError CompiledExpression::compile(const char* text) {
+    m_code.clear();
+    m_error = ExpressionCompiler(m_code).run(text);
+    if (m_error != CellError::NONE) {
+        m_code.clear();
+    }
+    m_code.shrink_to_fit();
+    return m_error;
+}
+
+double CompiledExpression::evaluate(const ExpressionContext* context, CellError& error) const {
+    error = m_error;
+    if (error != CellError::NONE) {
+        return 0.0;
+    }
+
+    // The compiler has checked both depths
+    double stack[OS_EXPR_MAX_STACK];
+    ExpressionAggregate aggregates[OS_EXPR_MAX_NESTING];
+    int top = 0;
+    int nesting = 0;
+
+    for (const Instruction& instruction : m_code) {
+        switch (instruction.op) {
+            case Op::NUMBER:
+                stack[top++] = instruction.number;
+                break;
+            case Op::CELL:
+                error = context ? context->readValue(instruction.key, stack[top++]) : CellError::REF;
+                break;
+            case Op::NEGATE:
+                stack[top - 1] = -stack[top - 1];
+                break;
+            case Op::PERCENT:
+                stack[top - 1] /= 100.0;
+                break;
+            case Op::ADD:
+                top--;
+                stack[top - 1] += stack[top];
+                break;
+            case Op::SUBTRACT:
+                top--;
+                stack[top - 1] -= stack[top];
+                break;
+            case Op::MULTIPLY:
+                top--;
+                stack[top - 1] *= stack[top];
+                break;
+            case Op::DIVIDE:
+                top--;
+                if (stack[top] == 0.0) {
+                    error = CellError::DIV_ZERO;
+                } else {
+                    stack[top - 1] /= stack[top];
+                }
+                break;
+            case Op::AGGREGATE_BEGIN:
+                aggregates[nesting++] = ExpressionAggregate();
+                break;
+            case Op::AGGREGATE_VALUE:
+                aggregates[nesting - 1].add(stack[--top]);
+                break;
+            case Op::AGGREGATE_RANGE:
+                error = context ? context->aggregateRange(instruction.range, aggregates[nesting - 1]) : CellError::REF;
+                break;
+            case Op::AGGREGATE_END: {
+                const ExpressionAggregate& aggregate = aggregates[--nesting];
+                double result = 0.0;
+                switch (instruction.function) {
+                    case Function::SUM:     result = aggregate.sum; break;
+                    case Function::MIN:     result = aggregate.min; break;
+                    case Function::MAX:     result = aggregate.max; break;
+                    case Function::COUNT:   result = aggregate.count; break;
+                    case Function::AVERAGE:
+                        if (aggregate.count == 0) {
+                            error = CellError::DIV_ZERO;
+                        } else {
+                            result = aggregate.sum / aggregate.count;
+                        }
+                        break;
+                }
+                stack[top++] = result;
+                break;
+            }
+        }
+        if (error != CellError::NONE) {
+            return 0.0;
+        }
+    }
+    return stack[0];
+}
+
+void CompiledExpression::getReferences(std::vector<uint32_t>& cells, std::vector<CellRange>& ranges) const {
+    for (const Instruction& instruction : m_code) {
+        if (instruction.op == Op::CELL) {
+            cells.push_back(instruction.key);
+        } else if (instruction.op == Op::AGGREGATE_RANGE) {
+            ranges.push_back(instruction.range);
+        }
+    }
+}
+
+size_t CompiledExpression::parseCellName(const char* text, int& row, int& col) {
+    const char* p = text;
+    if (*p == '$') {
+        p++;
+    }
+    col = 0;
+    int letters = 0;
+    for (; letters < 3; letters++, p++) {
+        char c = *p;
+        if (c >= 'a' && c <= 'z') {
+            c = c - 'a' + 'A';
+        }
+        if (c < 'A' || c > 'Z') {
+            break;
+        }
+        col = col * 26 + (c - 'A' + 1);
+    }
+    if (letters == 0) {
+        return 0;
+    }
+    if (*p == '$') {
+        p++;
+    }
+    row = 0;
+    int digits = 0;
+    for (; *p >= '0' && *p <= '9'; digits++, p++) {
+        if (digits < 7) {
+            row = row * 10 + (*p - '0');
+        }
+    }
+    if (digits == 0 || digits > 7 || row == 0) {
+        return 0;
+    }
+    // A letter right after means this is not a name at all
+    if ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z') || *p == '_') {
+        return 0;
+    }
+    row -= 1;
+    col -= 1;
+    return p - text;
+}
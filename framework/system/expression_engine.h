@@ -0,0 +1,170 @@
+#ifndef EXPRESSION_ENGINE_H
+#define EXPRESSION_ENGINE_H
+
+#include "os_config.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file expression_engine.h
+ * @brief Arithmetic expressions compiled once to postfix bytecode
+ *
+ * The source is tokenized in one pass and compiled by recursive descent
+ * into a flat postfix program; evaluating it is a loop over that program
+ * with a fixed-size value stack, so nothing is parsed or allocated again.
+ * The calculator compiles what was typed; the spreadsheet keeps each
+ * formula's program and reruns it on every recalculation.
+ *
+ * Supported: numbers, + - * / (also × and ÷), unary minus, postfix %,
+ * parentheses, cell references (A1, $B$2), and SUM, AVG/AVERAGE, MIN, MAX
+ * and COUNT over ranges (A1:B10) and values. Cells and ranges are read
+ * through an ExpressionContext.
+ */
+
+enum class CellError : uint8_t {
+    NONE,
+    PARSE,          // #ERROR!
+    REF,            // #REF!
+    DIV_ZERO,       // #DIV/0!
+    VALUE,          // #VALUE!, text used as a number
+    CYCLE           // #CYCLE!
+};
+
+struct CellRange {
+    uint16_t row0;
+    uint16_t col0;
+    uint16_t row1;
+    uint16_t col1;
+
+    bool contains(uint32_t row, uint32_t col) const {
+        return row >= row0 && row <= row1 && col >= col0 && col <= col1;
+    }
+};
+
+/**
+ * @brief Cell key as used by references: row << 16 | column, both zero-based
+ */
+inline uint32_t cellKey(int row, int col) {
+    return ((uint32_t)row << 16) | (uint32_t)col;
+}
+
+/**
+ * @brief Running totals of an aggregate function
+ */
+struct ExpressionAggregate {
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    uint32_t count = 0;
+
+    void add(double value) {
+        min = count == 0 || value < min ? value : min;
+        max = count == 0 || value > max ? value : max;
+        sum += value;
+        count++;
+    }
+};
+
+/**
+ * @brief Where compiled expressions read cells from
+ */
+class ExpressionContext {
+public:
+    virtual ~ExpressionContext() = default;
+
+    /**
+     * @brief Read a referenced cell as a number
+     * @param key Cell key
+     * @param value Set to the value; 0 for an empty cell
+     * @return CellError::NONE, VALUE for text, or the cell's own error
+     */
+    virtual CellError readValue(uint32_t key, double& value) const = 0;
+
+    /**
+     * @brief Add the numbers in a range to an aggregate, skipping text and empty cells
+     * @param range Range
+     * @param aggregate Aggregate to add to
+     * @return CellError::NONE, or the first error found in the range
+     */
+    virtual CellError aggregateRange(const CellRange& range, ExpressionAggregate& aggregate) const = 0;
+};
+
+class CompiledExpression {
+public:
+    CompiledExpression() = default;
+
+    /**
+     * @brief Compile an expression, replacing any previous program
+     * @param text Source, without a leading '='
+     * @return CellError::NONE, PARSE for bad syntax, REF for a reference outside the sheet
+     */
+    CellError compile(const char* text);
+
+    /**
+     * @brief Run the program
+     * @param context Cell source, or nullptr if references are not allowed
+     * @param error Set to CellError::NONE or the first error met
+     * @return Result; 0 on error
+     */
+    double evaluate(const ExpressionContext* context, CellError& error) const;
+
+    /**
+     * @brief List what the program reads
+     * @param cells Appended with referenced cell keys (may repeat)
+     * @param ranges Appended with referenced ranges
+     */
+    void getReferences(std::vector<uint32_t>& cells, std::vector<CellRange>& ranges) const;
+
+    bool isValid() const { return m_error == CellError::NONE; }
+    size_t getCodeSize() const { return m_code.size(); }
+
+    /**
+     * @brief Parse a cell name
+     * @param text Name such as "B7" or "$B$7"
+     * @param row Set to the row
+     * @param col Set to the column
+     * @return Characters used, 0 if the text does not start with a cell name
+     */
+    static size_t parseCellName(const char* text, int& row, int& col);
+
+private:
+    enum class Op : uint8_t {
+        NUMBER,
+        CELL,
+        NEGATE,
+        PERCENT,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        AGGREGATE_BEGIN,
+        AGGREGATE_VALUE,    // Pops a value into the innermost aggregate
+        AGGREGATE_RANGE,
+        AGGREGATE_END       // Pushes the innermost aggregate's result
+    };
+
+    enum class Function : uint8_t {
+        SUM,
+        AVERAGE,
+        MIN,
+        MAX,
+        COUNT
+    };
+
+    struct Instruction {
+        Op op;
+        Function function;
+        union {
+            double number;
+            uint32_t key;
+            CellRange range;
+        };
+    };
+
+    friend class ExpressionCompiler;
+
+    std::vector<Instruction> m_code;
+    CellError m_error = CellError::PARSE;
+};
+
+#endif // EXPRESSION_ENGINE_H
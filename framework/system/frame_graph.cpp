@@ -0,0 +1,236 @@
+#include "frame_graph.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char* TAG = "FrameGraph";
+
+FrameGraph::FrameGraph() {
+    for (Stage& entry : m_stages) {
+        entry.stage = nullptr;
+        entry.core = WorkerPool::ANY_CORE;
+        entry.busy.store(false);
+        entry.processed.store(0);
+        entry.dropped.store(0);
+    }
+    for (Slot& slot : m_slots) {
+        slot.release = nullptr;
+        slot.context = nullptr;
+        slot.refs.store(0);
+        slot.inUse.store(false);
+    }
+    m_mutex = xSemaphoreCreateMutex();
+}
+
+FrameGraph::~FrameGraph() {
+    if (!waitIdle(OS_FRAME_GRAPH_REMOVE_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "Frames still held by stages at destruction");
+    }
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t FrameGraph::addStage(FrameStage* stage, int core) {
+    if (!stage) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    lock();
+    Stage* empty = nullptr;
+    for (Stage& entry : m_stages) {
+        if (entry.stage == stage) {
+            unlock();
+            return OS_OK;
+        }
+        if (!entry.stage && !empty) {
+            empty = &entry;
+        }
+    }
+    if (!empty) {
+        unlock();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    empty->core = core;
+    empty->busy.store(false);
+    empty->processed.store(0);
+    empty->dropped.store(0);
+    empty->timing.reset();
+    empty->stage = stage;
+    m_stageCount++;
+    unlock();
+
+    ESP_LOGI(TAG, "Stage '%s' added", stage->getName());
+    return OS_OK;
+}
+
+os_error_t FrameGraph::removeStage(FrameStage* stage) {
+    lock();
+    for (Stage& entry : m_stages) {
+        if (entry.stage != stage) {
+            continue;
+        }
+
+        // Holding the lock keeps dispatch() from posting it again
+        for (uint32_t waited = 0; entry.busy.load(); waited++) {
+            if (waited >= OS_FRAME_GRAPH_REMOVE_TIMEOUT_MS) {
+                unlock();
+                ESP_LOGW(TAG, "Stage '%s' still running, not removed", stage->getName());
+                return OS_ERROR_TIMEOUT;
+            }
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        entry.stage = nullptr;
+        m_stageCount--;
+        unlock();
+        return OS_OK;
+    }
+    unlock();
+    return OS_ERROR_NOT_FOUND;
+}
+
+void FrameGraph::dispatch(const CameraFrameInfo& frame, FrameReleaseFunction release, void* context) {
+    if (!release) {
+        return;
+    }
+    if (!hasStages()) {
+        release(context);
+        return;
+    }
+
+    Slot* slot = nullptr;
+    for (Slot& candidate : m_slots) {
+        if (!candidate.inUse.load(std::memory_order_acquire)) {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    lock();
+    if (!slot) {
+        // Analysis already holds its share of driver buffers
+        for (Stage& entry : m_stages) {
+            if (entry.stage) {
+                entry.dropped++;
+            }
+        }
+        unlock();
+        m_framesSkipped++;
+        release(context);
+        return;
+    }
+
+    slot->info = frame;
+    slot->release = release;
+    slot->context = context;
+    slot->refs.store(1);        // Held by this call until every stage is posted
+    slot->inUse.store(true);
+
+    WorkerPool& pool = OS().getTaskScheduler().getWorkerPool();
+    for (Stage& entry : m_stages) {
+        if (!entry.stage || !entry.stage->accepts(frame)) {
+            continue;
+        }
+
+        // One frame per stage at a time; a busy stage skips this one
+        bool expected = false;
+        if (!entry.busy.compare_exchange_strong(expected, true)) {
+            entry.dropped++;
+            continue;
+        }
+
+        slot->refs++;
+        Stage* target = &entry;
+        if (pool.submit([target, slot]() { runStage(target, slot); },
+                        nullptr, entry.core, entry.stage->getName()) == 0) {
+            slot->refs--;
+            entry.busy.store(false);
+            entry.dropped++;
+        }
+    }
+    unlock();
+
+    m_framesDispatched++;
+    releaseRef(slot);
+}
+
+bool FrameGraph::waitIdle(uint32_t timeoutMs) {
+    for (uint32_t waited = 0;; waited += 5) {
+        bool idle = true;
+        for (const Slot& slot : m_slots) {
+            idle = idle && !slot.inUse.load(std::memory_order_acquire);
+        }
+        if (idle) {
+            return true;
+        }
+        if (waited >= timeoutMs) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+bool FrameGraph::getStageStats(size_t index, FrameStageStats& stats) const {
+    if (index >= OS_FRAME_GRAPH_MAX_STAGES) {
+        return false;
+    }
+
+    lock();
+    const Stage& entry = m_stages[index];
+    bool found = entry.stage != nullptr;
+    if (found) {
+        stats.name = entry.stage->getName();
+        stats.processed = entry.processed.load();
+        stats.dropped = entry.dropped.load();
+        stats.averageUs = entry.timing.averageUs();
+        stats.p95Us = entry.timing.percentileUs(95);
+        stats.maxUs = entry.timing.maxUs();
+    }
+    unlock();
+    return found;
+}
+
+void FrameGraph::printStats(const char* tag) const {
+    ESP_LOGI(tag, "Frame graph: %d stages, %d frames dispatched, %d skipped (no slot)",
+             m_stageCount.load(), m_framesDispatched.load(), m_framesSkipped.load());
+    for (size_t i = 0; i < OS_FRAME_GRAPH_MAX_STAGES; i++) {
+        FrameStageStats stats;
+        if (getStageStats(i, stats)) {
+            ESP_LOGI(tag, "  %-12s %d processed, %d dropped, avg %d us, p95 %d us, max %d us",
+                     stats.name, stats.processed, stats.dropped,
+                     stats.averageUs, stats.p95Us, stats.maxUs);
+        }
+    }
+}
+
+void FrameGraph::runStage(Stage* entry, Slot* slot) {
+    int64_t start = esp_timer_get_time();
+    entry->stage->process(slot->info);
+    entry->timing.add((uint32_t)(esp_timer_get_time() - start));
+    entry->processed++;
+
+    entry->busy.store(false, std::memory_order_release);
+    releaseRef(slot);
+}
+
+void FrameGraph::releaseRef(Slot* slot) {
+    if (slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Last reader: hand the buffer back to the driver
+        slot->release(slot->context);
+        slot->inUse.store(false, std::memory_order_release);
+    }
+}
+
+void FrameGraph::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void FrameGraph::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
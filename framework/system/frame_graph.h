@@ -0,0 +1,181 @@
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include "os_config.h"
+#include "latency_histogram.h"
+#include "worker_pool.h"
+#include "../hal/camera_preview.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+
+/**
+ * @file frame_graph.h
+ * @brief Zero-copy fan-out of camera frames to analysis stages
+ *
+ * dispatch() wraps a driver frame in a refcounted slot and posts one
+ * WorkerPool job per registered stage; every stage reads the same driver
+ * buffer, and the frame goes back to its owner through the release
+ * function when the last stage finishes.
+ *
+ * Backpressure drops analysis, never the caller's own use of the frame:
+ * a stage still busy with an earlier frame skips the new one, and when
+ * OS_FRAME_GRAPH_MAX_FRAMES frames are already held the frame is released
+ * at once without analysis. The caller (the camera task) feeds preview and
+ * recording before dispatching, so a slow stage costs only its own rate.
+ *
+ * dispatch() is called from one producer task; stages may be added and
+ * removed from any task.
+ */
+
+/**
+ * @brief Read-only view of one driver frame
+ */
+struct CameraFrameInfo {
+    const uint8_t* data;
+    size_t length;
+    uint16_t width;
+    uint16_t height;
+    CameraFrameFormat format;
+    int64_t timestampUs;
+    uint32_t sequence;
+};
+
+/**
+ * @brief One analysis step (motion detection, metering, code scanning...)
+ */
+class FrameStage {
+public:
+    virtual ~FrameStage() = default;
+
+    /**
+     * @brief Get the stage name for statistics
+     * @return Static name
+     */
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief Decide if a frame is worth processing (camera task; keep cheap)
+     * @param frame Frame about to be dispatched
+     * @return true to process it
+     */
+    virtual bool accepts(const CameraFrameInfo& frame) const { return true; }
+
+    /**
+     * @brief Analyse a frame on a worker
+     *
+     * The pixels belong to the driver: read them, do not keep the pointer.
+     * @param frame Frame to analyse
+     */
+    virtual void process(const CameraFrameInfo& frame) = 0;
+};
+
+/**
+ * @brief Per-stage counters from getStageStats()
+ */
+struct FrameStageStats {
+    const char* name;
+    uint32_t processed;
+    uint32_t dropped;       // Skipped while busy or with no frame slot
+    uint32_t averageUs;
+    uint32_t p95Us;
+    uint32_t maxUs;
+};
+
+typedef void (*FrameReleaseFunction)(void* context);
+
+class FrameGraph {
+public:
+    FrameGraph();
+    ~FrameGraph();
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    /**
+     * @brief Register a stage
+     * @param stage Stage, owned by the caller until removeStage()
+     * @param core Worker core to run on, or WorkerPool::ANY_CORE
+     * @return OS_OK on success, OS_ERROR_NO_MEMORY if every stage slot is used
+     */
+    os_error_t addStage(FrameStage* stage, int core = WorkerPool::ANY_CORE);
+
+    /**
+     * @brief Unregister a stage, waiting for its running job to finish
+     * @param stage Stage from addStage()
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND or OS_ERROR_TIMEOUT
+     */
+    os_error_t removeStage(FrameStage* stage);
+
+    /**
+     * @brief Check if any stage is registered
+     * @return true if dispatch() has work to post
+     */
+    bool hasStages() const { return m_stageCount.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief Fan a frame out to the stages (producer only)
+     *
+     * release(context) is called exactly once: here if nothing takes the
+     * frame, otherwise on the worker that finishes it last.
+     * @param frame Frame view; its data must stay valid until release
+     * @param release Returns the frame to its owner
+     * @param context Passed to release
+     */
+    void dispatch(const CameraFrameInfo& frame, FrameReleaseFunction release, void* context);
+
+    /**
+     * @brief Wait until every held frame has been released
+     * @param timeoutMs Longest wait
+     * @return true if idle
+     */
+    bool waitIdle(uint32_t timeoutMs);
+
+    /**
+     * @brief Get statistics for a registered stage
+     * @param index Stage position, 0 to OS_FRAME_GRAPH_MAX_STAGES - 1
+     * @param stats Output statistics
+     * @return true if a stage is registered there
+     */
+    bool getStageStats(size_t index, FrameStageStats& stats) const;
+
+    /**
+     * @brief Print graph and stage statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    struct Stage {
+        FrameStage* stage;
+        int core;
+        std::atomic<bool> busy;
+        std::atomic<uint32_t> processed;
+        std::atomic<uint32_t> dropped;
+        LatencyHistogram timing;    // Written only by the stage's running job
+    };
+
+    struct Slot {
+        CameraFrameInfo info;
+        FrameReleaseFunction release;
+        void* context;
+        std::atomic<int> refs;
+        std::atomic<bool> inUse;
+    };
+
+    static void runStage(Stage* stage, Slot* slot);
+    static void releaseRef(Slot* slot);
+    void lock() const;
+    void unlock() const;
+
+    Stage m_stages[OS_FRAME_GRAPH_MAX_STAGES];
+    Slot m_slots[OS_FRAME_GRAPH_MAX_FRAMES];
+    std::atomic<size_t> m_stageCount{0};
+    SemaphoreHandle_t m_mutex = nullptr;
+
+    // Statistics
+    std::atomic<uint32_t> m_framesDispatched{0};
+    std::atomic<uint32_t> m_framesSkipped{0};   // No free slot: released unanalysed
+};
+
+#endif // FRAME_GRAPH_H
@@ -0,0 +1,124 @@
+#include "frame_profiler.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "FrameProfiler";
+
+void FrameProfiler::record(ProfileStage stage, uint32_t durationUs) {
+    if (!m_enabled || stage >= ProfileStage::COUNT) {
+        return;
+    }
+    m_stages[(size_t)stage].add(durationUs, OS_PROFILER_FRAME_BUDGET_US);
+}
+
+void FrameProfiler::recordApp(SampleWindow* window, uint32_t durationUs) {
+    if (!m_enabled || !window) {
+        return;
+    }
+    window->add(durationUs, OS_PROFILER_FRAME_BUDGET_US);
+}
+
+ProfileStats FrameProfiler::getStageStats(ProfileStage stage) const {
+    if (stage >= ProfileStage::COUNT) {
+        return ProfileStats{};
+    }
+    return m_stages[(size_t)stage].summarize();
+}
+
+bool FrameProfiler::getAppStats(const std::string& appId, ProfileStats& stats) const {
+    auto it = m_apps.find(appId);
+    if (it == m_apps.end() || it->second.count == 0) {
+        return false;
+    }
+    stats = it->second.summarize();
+    return true;
+}
+
+bool FrameProfiler::getSlowestApp(std::string& appId, ProfileStats& stats) const {
+    bool found = false;
+    for (const auto& [id, window] : m_apps) {
+        if (window.count == 0) {
+            continue;
+        }
+        ProfileStats candidate = window.summarize();
+        if (!found || candidate.p95Us > stats.p95Us) {
+            appId = id;
+            stats = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint64_t FrameProfiler::getAppBusyUs(const std::string& appId) const {
+    auto it = m_apps.find(appId);
+    return it != m_apps.end() ? it->second.totalUs : 0;
+}
+
+const char* FrameProfiler::getStageName(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::SCHEDULER: return "sched";
+        case ProfileStage::EVENTS:    return "events";
+        case ProfileStage::HAL:       return "hal";
+        case ProfileStage::UI:        return "ui";
+        case ProfileStage::APPS:      return "apps";
+        case ProfileStage::SERVICES:  return "services";
+        case ProfileStage::FRAME:     return "frame";
+        default:                      return "?";
+    }
+}
+
+void FrameProfiler::reset() {
+    for (auto& window : m_stages) {
+        window = SampleWindow();
+    }
+    // Running apps hold pointers to their windows
+    for (auto& [id, window] : m_apps) {
+        window = SampleWindow();
+    }
+}
+
+void FrameProfiler::printStats() const {
+    ESP_LOGI(TAG, "=== Frame Profiler (last %d frames) ===", OS_PROFILER_WINDOW);
+    for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileStats stats = m_stages[i].summarize();
+        ESP_LOGI(TAG, "%-8s p50=%d us p95=%d us max=%d us over budget=%d",
+                getStageName((ProfileStage)i), stats.p50Us, stats.p95Us,
+                stats.maxUs, stats.overBudget);
+    }
+    for (const auto& [appId, window] : m_apps) {
+        ProfileStats stats = window.summarize();
+        ESP_LOGI(TAG, "app '%s' p50=%d us p95=%d us max=%d us",
+                appId.c_str(), stats.p50Us, stats.p95Us, stats.maxUs);
+    }
+}
+
+void FrameProfiler::SampleWindow::add(uint32_t durationUs, uint32_t budgetUs) {
+    samples[count % OS_PROFILER_WINDOW] = durationUs;
+    count++;
+    totalUs += durationUs;
+    if (durationUs > budgetUs) {
+        overBudget++;
+    }
+}
+
+ProfileStats FrameProfiler::SampleWindow::summarize() const {
+    ProfileStats stats = {};
+    size_t n = std::min<size_t>(count, OS_PROFILER_WINDOW);
+    if (n == 0) {
+        return stats;
+    }
+
+    // Percentiles are only needed when someone looks, so sort a copy then
+    uint32_t sorted[OS_PROFILER_WINDOW];
+    std::copy(samples, samples + n, sorted);
+    std::sort(sorted, sorted + n);
+
+    stats.p50Us = sorted[(n - 1) / 2];
+    stats.p95Us = sorted[((n - 1) * 95) / 100];
+    stats.maxUs = sorted[n - 1];
+    stats.lastUs = samples[(count - 1) % OS_PROFILER_WINDOW];
+    stats.samples = count;
+    stats.overBudget = overBudget;
+    return stats;
+}
@@ -0,0 +1,198 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "os_config.h"
+#include <esp_timer.h>
+#include <map>
+#include <string>
+
+/**
+ * @file frame_profiler.h
+ * @brief Per-subsystem frame profiler for M5Stack Tab5
+ *
+ * Scoped microsecond timers around each stage of OSManager::update() and
+ * each BaseApp::update(). Every stage keeps a rolling window of recent
+ * samples from which p50/p95/max are computed on demand, so recording a
+ * sample is a single store and costs nothing measurable in the frame.
+ * Apps get their window once from addApp() when they start; it stays at
+ * the same address until removeApp(), so the per-frame path does no lookup.
+ */
+
+enum class ProfileStage : uint8_t {
+    SCHEDULER = 0,
+    EVENTS,
+    HAL,
+    UI,
+    APPS,
+    SERVICES,
+    FRAME,          // Whole update() excluding tickless sleep
+    COUNT
+};
+
+static constexpr size_t PROFILE_STAGE_COUNT = (size_t)ProfileStage::COUNT;
+
+/**
+ * @brief Summary of a sample window
+ */
+struct ProfileStats {
+    uint32_t p50Us;
+    uint32_t p95Us;
+    uint32_t maxUs;
+    uint32_t lastUs;
+    uint32_t samples;
+    uint32_t overBudget;    // Samples above OS_PROFILER_FRAME_BUDGET_US
+};
+
+class FrameProfiler {
+public:
+    /**
+     * @brief Rolling sample window of one stage or app
+     */
+    struct SampleWindow {
+        uint32_t samples[OS_PROFILER_WINDOW] = {};
+        uint32_t count = 0;         // Total samples ever recorded
+        uint32_t overBudget = 0;
+        uint64_t totalUs = 0;       // Cumulative, for CPU accounting
+
+        void add(uint32_t durationUs, uint32_t budgetUs);
+        ProfileStats summarize() const;
+    };
+
+    FrameProfiler() = default;
+
+    /**
+     * @brief Enable/disable sample recording
+     * @param enabled True to record samples
+     */
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /**
+     * @brief Check if recording is enabled
+     * @return true if enabled, false otherwise
+     */
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Record a stage duration
+     * @param stage Stage that was timed
+     * @param durationUs Duration in microseconds
+     */
+    void record(ProfileStage stage, uint32_t durationUs);
+
+    /**
+     * @brief Get the sample window of an app, creating it if needed (app start)
+     * @param appId Application identifier
+     * @return Window, valid until removeApp() for the same app
+     */
+    SampleWindow* addApp(const std::string& appId) { return &m_apps[appId]; }
+
+    /**
+     * @brief Record an app update duration
+     * @param window Window from addApp()
+     * @param durationUs Duration in microseconds
+     */
+    void recordApp(SampleWindow* window, uint32_t durationUs);
+
+    /**
+     * @brief Forget an app's samples (app stopped)
+     * @param appId Application identifier
+     */
+    void removeApp(const std::string& appId) { m_apps.erase(appId); }
+
+    /**
+     * @brief Get rolling statistics for a stage
+     * @param stage Stage to query
+     * @return Window summary
+     */
+    ProfileStats getStageStats(ProfileStage stage) const;
+
+    /**
+     * @brief Get rolling statistics for an app
+     * @param appId Application identifier
+     * @param stats Output summary
+     * @return true if the app has samples
+     */
+    bool getAppStats(const std::string& appId, ProfileStats& stats) const;
+
+    /**
+     * @brief Find the app with the highest p95 update time
+     * @param appId Output application identifier
+     * @param stats Output summary
+     * @return true if any app has samples
+     */
+    bool getSlowestApp(std::string& appId, ProfileStats& stats) const;
+
+    /**
+     * @brief Get cumulative update time of an app
+     * @param appId Application identifier
+     * @return Total microseconds spent in the app's update()
+     */
+    uint64_t getAppBusyUs(const std::string& appId) const;
+
+    /**
+     * @brief Get display name of a stage
+     * @param stage Stage
+     * @return Short stage name
+     */
+    static const char* getStageName(ProfileStage stage);
+
+    /**
+     * @brief Clear all sample windows (app windows keep their addresses)
+     */
+    void reset();
+
+    /**
+     * @brief Print profiler statistics
+     */
+    void printStats() const;
+
+private:
+    bool m_enabled = OS_PROFILER_ENABLED;
+    SampleWindow m_stages[PROFILE_STAGE_COUNT];
+    std::map<std::string, SampleWindow> m_apps;
+};
+
+/**
+ * @brief RAII timer that records its lifetime into a FrameProfiler
+ */
+class ScopedProfileTimer {
+public:
+    ScopedProfileTimer(FrameProfiler& profiler, ProfileStage stage)
+        : m_profiler(profiler), m_stage(stage), m_appWindow(nullptr),
+          m_start(esp_timer_get_time()) {}
+
+    ScopedProfileTimer(FrameProfiler& profiler, FrameProfiler::SampleWindow* appWindow)
+        : m_profiler(profiler), m_stage(ProfileStage::COUNT), m_appWindow(appWindow),
+          m_start(esp_timer_get_time()) {}
+
+    ~ScopedProfileTimer() {
+        if (!m_profiler.isEnabled()) {
+            return;
+        }
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - m_start);
+        if (m_stage == ProfileStage::COUNT) {
+            m_profiler.recordApp(m_appWindow, elapsed);
+        } else {
+            m_profiler.record(m_stage, elapsed);
+        }
+    }
+
+    ScopedProfileTimer(const ScopedProfileTimer&) = delete;
+    ScopedProfileTimer& operator=(const ScopedProfileTimer&) = delete;
+
+private:
+    FrameProfiler& m_profiler;
+    ProfileStage m_stage;
+    FrameProfiler::SampleWindow* m_appWindow;
+    int64_t m_start;
+};
+
+// Convenience macros
+#define OS_PROFILE_CONCAT_(a, b) a##b
+#define OS_PROFILE_CONCAT(a, b) OS_PROFILE_CONCAT_(a, b)
+#define OS_PROFILE_STAGE(profiler, stage) \
+    ScopedProfileTimer OS_PROFILE_CONCAT(_profileTimer, __LINE__)(profiler, stage)
+#define OS_PROFILE_APP(profiler, appWindow) \
+    ScopedProfileTimer OS_PROFILE_CONCAT(_profileTimer, __LINE__)(profiler, appWindow)
+
+#endif // FRAME_PROFILER_H
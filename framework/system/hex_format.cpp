@@ -0,0 +1,253 @@
+#include "hex_format.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+static const char* TAG = "HexFormat";
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Word stores assume little endian");
+
+// Digit pair per value, first digit in the low byte so it lands first in memory
+struct HexTable {
+    uint16_t pairs[256];
+    uint16_t decimal[100];
+    char printable[256];
+
+    constexpr HexTable() : pairs(), decimal(), printable() {
+        const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; i++) {
+            pairs[i] = (uint16_t)(digits[i >> 4] | (digits[i & 0xF] << 8));
+            printable[i] = (i >= 32 && i <= 126) ? (char)i : '.';
+        }
+        for (int i = 0; i < 100; i++) {
+            decimal[i] = (uint16_t)(digits[i / 10] | (digits[i % 10] << 8));
+        }
+    }
+};
+
+static constexpr HexTable s_table;
+
+static inline void putPair(char* out, uint8_t value) {
+    memcpy(out, &s_table.pairs[value], 2);
+}
+
+static inline void putDecimalPair(char* out, int value) {
+    memcpy(out, &s_table.decimal[value % 100], 2);
+}
+
+// "XX " for every byte; the caller trims or keeps the final space
+static inline char* putHexSpaced(char* out, const uint8_t* data, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t p0 = s_table.pairs[data[i]];
+        uint32_t p1 = s_table.pairs[data[i + 1]];
+        uint32_t p2 = s_table.pairs[data[i + 2]];
+        uint32_t p3 = s_table.pairs[data[i + 3]];
+        uint32_t words[3] = {
+            p0 | (' ' << 16) | ((p1 & 0xFF) << 24),             // "AB C"
+            (p1 >> 8) | (' ' << 8) | (p2 << 16),                // "D EF"
+            ' ' | (p3 << 8) | ((uint32_t)' ' << 24)             // " GH "
+        };
+        memcpy(out, words, sizeof(words));
+        out += sizeof(words);
+    }
+    for (; i < count; i++) {
+        putPair(out, data[i]);
+        out[2] = ' ';
+        out += 3;
+    }
+    return out;
+}
+
+size_t HexFormat::hex(const uint8_t* data, size_t length, char* out, size_t outSize) {
+    if (!out || outSize == 0) {
+        return 0;
+    }
+
+    size_t count = data ? std::min(length, outSize / 3) : 0;
+    if (count == 0) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    char* end = putHexSpaced(out, data, count);
+    end[-1] = '\0';     // Trailing separator becomes the terminator
+    return end - 1 - out;
+}
+
+size_t HexFormat::ascii(const uint8_t* data, size_t length, char* out, size_t outSize) {
+    if (!out || outSize == 0) {
+        return 0;
+    }
+
+    size_t count = data ? std::min(length, outSize - 1) : 0;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = s_table.printable[data[i]];
+    }
+    out[count] = '\0';
+    return count;
+}
+
+size_t HexFormat::hexdump(const uint8_t* data, size_t length, uint32_t baseOffset,
+                          char* out, size_t outSize) {
+    if (!out || outSize == 0) {
+        return 0;
+    }
+
+    char* pos = out;
+    size_t remaining = outSize;
+    for (size_t done = 0; data && done < length; done += HEXDUMP_BYTES_PER_LINE) {
+        // Line, newline if another follows, and the final NUL
+        if (remaining < HEXDUMP_LINE_CHARS + 2) {
+            break;
+        }
+        if (pos != out) {
+            *pos++ = '\n';
+            remaining--;
+        }
+        size_t count = std::min(length - done, HEXDUMP_BYTES_PER_LINE);
+        size_t written = hexdumpLine(data + done, count, baseOffset + (uint32_t)done, pos);
+        pos += written;
+        remaining -= written;
+    }
+
+    *pos = '\0';
+    return pos - out;
+}
+
+size_t HexFormat::hexdumpLine(const uint8_t* data, size_t length, uint32_t offset, char* out) {
+    char* pos = out;
+    putPair(pos, offset >> 24);
+    putPair(pos + 2, offset >> 16);
+    putPair(pos + 4, offset >> 8);
+    putPair(pos + 6, offset);
+    memset(pos + 8, ' ', 2);
+    pos += 10;
+
+    // Two groups of eight, short lines padded so the ASCII column lines up
+    for (size_t group = 0; group < 2; group++) {
+        size_t start = group * 8;
+        size_t count = length > start ? std::min<size_t>(length - start, 8) : 0;
+        pos = putHexSpaced(pos, data + start, count);
+        memset(pos, ' ', (8 - count) * 3 + 1);
+        pos += (8 - count) * 3 + 1;
+    }
+
+    *pos++ = '|';
+    for (size_t i = 0; i < length; i++) {
+        *pos++ = s_table.printable[data[i]];
+    }
+    *pos++ = '|';
+    return pos - out;
+}
+
+size_t TimestampPrefix::format(char* out) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return format(tv, out);
+}
+
+size_t TimestampPrefix::format(const struct timeval& tv, char* out) {
+    // localtime_r and the clock digits only when the second changes
+    if (tv.tv_sec != m_second) {
+        struct tm timeinfo;
+        localtime_r(&tv.tv_sec, &timeinfo);
+        m_clock[0] = '[';
+        putDecimalPair(m_clock + 1, timeinfo.tm_hour);
+        m_clock[3] = ':';
+        putDecimalPair(m_clock + 4, timeinfo.tm_min);
+        m_clock[6] = ':';
+        putDecimalPair(m_clock + 7, timeinfo.tm_sec);
+        m_second = tv.tv_sec;
+    }
+
+    memcpy(out, m_clock, sizeof(m_clock) - 1);
+    size_t length = sizeof(m_clock) - 1;
+    if (m_milliseconds) {
+        uint32_t ms = (uint32_t)(tv.tv_usec / 1000) % 1000;
+        out[length] = '.';
+        out[length + 1] = (char)('0' + ms / 100);
+        putDecimalPair(out + length + 2, ms % 100);
+        length += 4;
+    }
+    out[length++] = ']';
+    out[length++] = ' ';
+    out[length] = '\0';
+    return length;
+}
+
+void HexFormat::benchmark(size_t bytes, uint32_t iterations, HexBenchmarkResult& result) {
+    std::vector<uint8_t> input(bytes);
+    std::vector<char> output(bytes * 3 + 1);
+    for (size_t i = 0; i < bytes; i++) {
+        input[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    // Reference: the per-byte snprintf loop both terminals used
+    int64_t start = esp_timer_get_time();
+    for (uint32_t n = 0; n < iterations; n++) {
+        size_t pos = 0;
+        for (size_t i = 0; i < bytes && pos < output.size() - 4; i++) {
+            pos += snprintf(output.data() + pos, output.size() - pos, "%02X ", input[i]);
+        }
+    }
+    int64_t snprintfUs = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t n = 0; n < iterations; n++) {
+        hex(input.data(), bytes, output.data(), output.size());
+    }
+    int64_t tableUs = esp_timer_get_time() - start;
+
+    std::vector<char> dump((bytes / HEXDUMP_BYTES_PER_LINE + 1) * (HEXDUMP_LINE_CHARS + 1) + 1);
+    start = esp_timer_get_time();
+    for (uint32_t n = 0; n < iterations; n++) {
+        hexdump(input.data(), bytes, 0, dump.data(), dump.size());
+    }
+    int64_t hexdumpUs = esp_timer_get_time() - start;
+
+    // Reference: localtime + snprintf per line
+    char prefix[32];
+    start = esp_timer_get_time();
+    for (uint32_t n = 0; n < iterations; n++) {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        struct tm* timeinfo = localtime(&tv.tv_sec);
+        snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03ld] ",
+                 timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, tv.tv_usec / 1000);
+    }
+    int64_t localtimeUs = esp_timer_get_time() - start;
+
+    TimestampPrefix cached;
+    start = esp_timer_get_time();
+    for (uint32_t n = 0; n < iterations; n++) {
+        cached.format(prefix);
+    }
+    int64_t cachedUs = esp_timer_get_time() - start;
+
+    result.bytes = (uint64_t)bytes * iterations;
+    result.snprintfUs = (uint32_t)snprintfUs;
+    result.tableUs = (uint32_t)tableUs;
+    result.hexdumpUs = (uint32_t)hexdumpUs;
+    result.localtimeUs = (uint32_t)localtimeUs;
+    result.cachedUs = (uint32_t)cachedUs;
+}
+
+void HexFormat::benchmark(size_t bytes, uint32_t iterations) {
+    HexBenchmarkResult result;
+    benchmark(bytes, iterations, result);
+
+    uint64_t totalBytes = result.bytes;
+    ESP_LOGI(TAG, "Hex %zu B x %d: snprintf %d us (%d KB/s), table %d us (%d KB/s)",
+             bytes, iterations, result.snprintfUs,
+             (int)(totalBytes * 1000 / std::max<uint32_t>(result.snprintfUs, 1)),
+             result.tableUs, (int)(totalBytes * 1000 / std::max<uint32_t>(result.tableUs, 1)));
+    ESP_LOGI(TAG, "Hexdump %zu B x %d: %d us (%d KB/s)", bytes, iterations, result.hexdumpUs,
+             (int)(totalBytes * 1000 / std::max<uint32_t>(result.hexdumpUs, 1)));
+    ESP_LOGI(TAG, "Timestamp x %d: localtime+snprintf %d us, cached %d us",
+             iterations, result.localtimeUs, result.cachedUs);
+}
@@ -0,0 +1,123 @@
+#ifndef HEX_FORMAT_H
+#define HEX_FORMAT_H
+
+#include "os_config.h"
+#include <sys/time.h>
+
+/**
+ * @file hex_format.h
+ * @brief Table-driven hex/ASCII formatting for terminals and logs
+ *
+ * Replaces per-byte snprintf("%02X ") with a 256-entry table of digit
+ * pairs. Four input bytes are emitted as three 32-bit stores, so a byte
+ * costs one table load instead of a printf call. TimestampPrefix caches
+ * the "[HH:MM:SS." part of a line prefix and only rewrites the
+ * milliseconds while the second is unchanged.
+ */
+
+/**
+ * @brief Timings from HexFormat::benchmark(), totals over all iterations
+ */
+struct HexBenchmarkResult {
+    uint64_t bytes;             // Input bytes formatted per path
+    uint32_t snprintfUs;
+    uint32_t tableUs;
+    uint32_t hexdumpUs;
+    uint32_t localtimeUs;       // Timestamp prefixes
+    uint32_t cachedUs;
+};
+
+class HexFormat {
+public:
+    /** Characters in a full hexdump() line, without newline or NUL */
+    static constexpr size_t HEXDUMP_LINE_CHARS = 78;
+    static constexpr size_t HEXDUMP_BYTES_PER_LINE = 16;
+
+    /**
+     * @brief Format bytes as space-separated hex ("48 65 6C")
+     * @param data Input bytes
+     * @param length Input length
+     * @param out Output buffer; always NUL terminated
+     * @param outSize Output size; 3 bytes per input byte
+     * @return Characters written, excluding the NUL
+     */
+    static size_t hex(const uint8_t* data, size_t length, char* out, size_t outSize);
+
+    /**
+     * @brief Copy bytes with unprintable ones replaced by '.'
+     * @param data Input bytes
+     * @param length Input length
+     * @param out Output buffer; always NUL terminated
+     * @param outSize Output size
+     * @return Characters written, excluding the NUL
+     */
+    static size_t ascii(const uint8_t* data, size_t length, char* out, size_t outSize);
+
+    /**
+     * @brief Format a classic hexdump with offset and ASCII columns
+     *
+     * "00000010  48 65 6C 6C 6F 20 77 6F  72 6C 64 0A 00 00 00 00  |Hello world.....|"
+     * Lines are separated by '\n'; only whole lines are written.
+     * @param data Input bytes
+     * @param length Input length
+     * @param baseOffset Offset printed for the first byte
+     * @param out Output buffer; always NUL terminated
+     * @param outSize Output size; HEXDUMP_LINE_CHARS + 1 per 16 bytes
+     * @return Characters written, excluding the NUL
+     */
+    static size_t hexdump(const uint8_t* data, size_t length, uint32_t baseOffset,
+                          char* out, size_t outSize);
+
+    /**
+     * @brief Time the formatters against the snprintf/localtime code they replace
+     *
+     * Results are logged; takes a few tens of milliseconds.
+     * @param bytes Input size per iteration
+     * @param iterations Number of iterations
+     */
+    static void benchmark(size_t bytes = 1024, uint32_t iterations = 200);
+
+    /**
+     * @brief Time the formatters and return the timings instead of logging them
+     * @param bytes Input size per iteration
+     * @param iterations Number of iterations
+     * @param result Output timings
+     */
+    static void benchmark(size_t bytes, uint32_t iterations, HexBenchmarkResult& result);
+
+private:
+    static size_t hexdumpLine(const uint8_t* data, size_t length, uint32_t offset, char* out);
+};
+
+class TimestampPrefix {
+public:
+    /** Longest prefix produced, without NUL: "[HH:MM:SS.mmm] " */
+    static constexpr size_t MAX_CHARS = 15;
+
+    /**
+     * @param milliseconds Include ".mmm" after the seconds
+     */
+    explicit TimestampPrefix(bool milliseconds = true) : m_milliseconds(milliseconds) {}
+
+    /**
+     * @brief Write the prefix for the current wall-clock time
+     * @param out Output buffer of at least MAX_CHARS + 1 bytes; NUL terminated
+     * @return Characters written, excluding the NUL
+     */
+    size_t format(char* out);
+
+    /**
+     * @brief Write the prefix for a given time
+     * @param tv Time of day
+     * @param out Output buffer of at least MAX_CHARS + 1 bytes; NUL terminated
+     * @return Characters written, excluding the NUL
+     */
+    size_t format(const struct timeval& tv, char* out);
+
+private:
+    bool m_milliseconds;
+    time_t m_second = (time_t)-1;
+    char m_clock[10] = {};          // "[HH:MM:SS" for m_second
+};
+
+#endif // HEX_FORMAT_H
@@ -0,0 +1,164 @@
+#include "https_session.h"
+#include <esp_crt_bundle.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char* TAG = "HttpsSession";
+
+HttpsSession::HttpsSession() {
+    m_mutex = xSemaphoreCreateMutex();
+}
+
+HttpsSession::~HttpsSession() {
+    destroyClient();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t HttpsSession::begin(const char* path, const char* contentType, int contentLength,
+                               const std::string& bearer, const char* accept) {
+    if (!path || !contentType) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    if (!m_mutex || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(OS_HTTPS_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return OS_ERROR_BUSY;
+    }
+
+    // Servers drop idle keep-alive sockets; a stale one fails only after the body is sent
+    if (m_connected && esp_timer_get_time() - m_lastUseUs > (int64_t)OS_HTTPS_IDLE_CLOSE_MS * 1000) {
+        destroyClient();
+    }
+    if (!ensureClient()) {
+        xSemaphoreGive(m_mutex);
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    bool reused = m_connected;
+    if (!openRequest(path, contentType, contentLength, bearer, accept)) {
+        destroyClient();
+        if (!reused || !ensureClient() || !openRequest(path, contentType, contentLength, bearer, accept)) {
+            ESP_LOGE(TAG, "Failed to reach %s%s", OS_API_BASE_URL, path);
+            destroyClient();
+            xSemaphoreGive(m_mutex);
+            return OS_ERROR_NOT_AVAILABLE;
+        }
+        reused = false;
+    }
+
+    m_stats.requests++;
+    if (reused) {
+        m_stats.reused++;
+    }
+    m_connected = false;    // Until end() sees the response through
+    return OS_OK;
+}
+
+bool HttpsSession::write(const void* data, size_t length) {
+    const char* bytes = (const char*)data;
+    while (length > 0) {
+        int written = esp_http_client_write(m_client, bytes, (int)length);
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        length -= written;
+    }
+    return true;
+}
+
+int HttpsSession::fetchResponse() {
+    if (esp_http_client_fetch_headers(m_client) < 0) {
+        return -1;
+    }
+    return esp_http_client_get_status_code(m_client);
+}
+
+int HttpsSession::read(char* buffer, size_t length) {
+    return esp_http_client_read(m_client, buffer, (int)length);
+}
+
+void HttpsSession::end(bool ok) {
+    if (ok && m_client) {
+        int drained = 0;
+        ok = esp_http_client_flush_response(m_client, &drained) == ESP_OK;
+    }
+    if (ok) {
+        m_connected = true;
+        m_lastUseUs = esp_timer_get_time();
+    } else {
+        destroyClient();
+    }
+    xSemaphoreGive(m_mutex);
+}
+
+void HttpsSession::close() {
+    if (!m_mutex || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(OS_HTTPS_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Session still in use, not closing");
+        return;
+    }
+    destroyClient();
+    xSemaphoreGive(m_mutex);
+}
+
+bool HttpsSession::ensureClient() {
+    if (m_client) {
+        return true;
+    }
+
+    esp_http_client_config_t config = {};
+    config.url = OS_API_BASE_URL;
+    config.method = HTTP_METHOD_POST;
+    config.timeout_ms = OS_HTTPS_TIMEOUT_MS;
+    config.buffer_size = OS_HTTPS_BUFFER_SIZE;
+    config.keep_alive_enable = true;
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+    m_client = esp_http_client_init(&config);
+    m_connected = false;
+    if (!m_client) {
+        ESP_LOGE(TAG, "Failed to create HTTP client");
+    }
+    return m_client != nullptr;
+}
+
+bool HttpsSession::openRequest(const char* path, const char* contentType, int contentLength,
+                               const std::string& bearer, const char* accept) {
+    std::string url = std::string(OS_API_BASE_URL) + path;
+    esp_http_client_set_url(m_client, url.c_str());
+    esp_http_client_set_method(m_client, HTTP_METHOD_POST);
+
+    // Headers persist on the client; clear the framing left by the previous request
+    esp_http_client_delete_header(m_client, "Transfer-Encoding");
+    esp_http_client_delete_header(m_client, "Content-Length");
+    std::string authorization = "Bearer " + bearer;
+    esp_http_client_set_header(m_client, "Authorization", authorization.c_str());
+    esp_http_client_set_header(m_client, "Content-Type", contentType);
+    if (accept) {
+        esp_http_client_set_header(m_client, "Accept", accept);
+    } else {
+        esp_http_client_delete_header(m_client, "Accept");
+    }
+
+    bool fresh = !m_connected;
+    int64_t startUs = esp_timer_get_time();
+    esp_err_t ret = esp_http_client_open(m_client, contentLength);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Open on %s connection failed: %s", fresh ? "new" : "reused", esp_err_to_name(ret));
+        return false;
+    }
+    if (fresh) {
+        m_stats.connections++;
+        m_stats.lastConnectMs = (uint32_t)((esp_timer_get_time() - startUs) / 1000);
+        ESP_LOGI(TAG, "Connected to %s in %d ms", OS_API_BASE_URL, m_stats.lastConnectMs);
+    }
+    return true;
+}
+
+void HttpsSession::destroyClient() {
+    if (m_client) {
+        esp_http_client_cleanup(m_client);
+        m_client = nullptr;
+    }
+    m_connected = false;
+}
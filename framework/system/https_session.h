@@ -0,0 +1,111 @@
+#ifndef HTTPS_SESSION_H
+#define HTTPS_SESSION_H
+
+#include "os_config.h"
+#include <esp_http_client.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <string>
+
+/**
+ * @file https_session.h
+ * @brief One kept-alive HTTPS connection to the assistant API, shared by all calls
+ *
+ * Speech-to-text uploads, chat completions and speech synthesis all go to
+ * OS_API_BASE_URL. Opening a TLS connection for each call costs a full
+ * handshake (several round trips plus certificate verification). The
+ * session keeps one esp_http_client, and so one TLS connection, and sends
+ * each request on it while the server keeps it open. A request that fails
+ * before any response on a reused connection (the server closed it while
+ * idle) is retried once on a fresh one, and a connection left idle for
+ * OS_HTTPS_IDLE_CLOSE_MS is replaced before use rather than trusted.
+ *
+ * Requests are serialised: begin() takes the session until end(), so
+ * callers on different tasks queue rather than interleave. Between begin()
+ * and end() the calls come from the task that called begin().
+ */
+
+struct HttpsSessionStats {
+    uint32_t requests;
+    uint32_t connections;       // TLS handshakes performed
+    uint32_t reused;            // Requests sent on an already open connection
+    uint32_t lastConnectMs;     // Duration of the latest handshake
+};
+
+class HttpsSession {
+public:
+    HttpsSession();
+    ~HttpsSession();
+
+    HttpsSession(const HttpsSession&) = delete;
+    HttpsSession& operator=(const HttpsSession&) = delete;
+
+    /**
+     * @brief Take the session and send request headers on the shared connection
+     * @param path Path under OS_API_BASE_URL
+     * @param contentType Request body type
+     * @param contentLength Body length, or -1 to send it with chunked encoding
+     * @param bearer Bearer token for the Authorization header
+     * @param accept Accept header, or nullptr
+     * @return OS_OK with the session held, OS_ERROR_BUSY, OS_ERROR_NO_MEMORY or
+     *         OS_ERROR_NOT_AVAILABLE if the server cannot be reached
+     */
+    os_error_t begin(const char* path, const char* contentType, int contentLength,
+                     const std::string& bearer, const char* accept = nullptr);
+
+    /**
+     * @brief Send body bytes as they are (chunk framing is the caller's)
+     * @param data Bytes to send
+     * @param length Byte count
+     * @return true if everything was written
+     */
+    bool write(const void* data, size_t length);
+
+    /**
+     * @brief Finish sending and read the response headers
+     * @return HTTP status, or -1 if the connection failed
+     */
+    int fetchResponse();
+
+    /**
+     * @brief Read response body bytes (transfer encoding already removed)
+     * @param buffer Destination
+     * @param length Destination size
+     * @return Bytes read, 0 at the end of the body, negative on error
+     */
+    int read(char* buffer, size_t length);
+
+    /**
+     * @brief Finish the request and release the session
+     *
+     * The rest of the response is drained so the connection can carry the
+     * next request; after an error it is closed instead.
+     * @param ok false if the request failed part way
+     */
+    void end(bool ok);
+
+    /**
+     * @brief Close the connection (the next begin() reconnects)
+     */
+    void close();
+
+    /**
+     * @brief Get connection counters
+     * @return Statistics snapshot
+     */
+    HttpsSessionStats getStats() const { return m_stats; }
+
+private:
+    bool ensureClient();
+    bool openRequest(const char* path, const char* contentType, int contentLength,
+                     const std::string& bearer, const char* accept);
+    void destroyClient();
+
+    esp_http_client_handle_t m_client = nullptr;
+    bool m_connected = false;       // Last request ended cleanly; the socket may be reused
+    int64_t m_lastUseUs = 0;
+    SemaphoreHandle_t m_mutex = nullptr;
+    HttpsSessionStats m_stats = {};
+};
+
+#endif // HTTPS_SESSION_H
@@ -0,0 +1,450 @@
+#include "keyword_spotter.h"
+#include "os_manager.h"
+#include <esp_dsp.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const char* TAG = "KeywordSpotter";
+
+static constexpr size_t FFT_BINS = OS_KWS_FFT_SIZE / 2;
+static constexpr size_t OVERLAP = OS_KWS_FFT_SIZE - OS_AUDIO_FRAME_SAMPLES;
+static_assert(OS_KWS_FFT_SIZE >= OS_AUDIO_FRAME_SAMPLES && OVERLAP <= OS_AUDIO_FRAME_SAMPLES,
+              "Analysis window must span one to two frames");
+
+static constexpr size_t MAX_CLASSES = 16;
+static constexpr float MEL_LOW_HZ = 20.0f;
+static constexpr float MEL_HIGH_HZ = 7600.0f;
+static constexpr uint32_t ONSET_QUIET_FRAMES = 15;     // 300 ms of quiet before a new utterance
+static constexpr int64_t CPU_WINDOW_US = 1000000;
+
+static float hzToMel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float melToHz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+static int16_t toQ15(float value) {
+    float scaled = value * 32768.0f;
+    return (int16_t)std::max(-32768.0f, std::min(32767.0f, roundf(scaled)));
+}
+
+KeywordSpotter::~KeywordSpotter() {
+    stop();
+    unload();
+}
+
+os_error_t KeywordSpotter::start(const char* modelPath) {
+    if (m_task) {
+        return OS_ERROR_BUSY;
+    }
+    if (!m_loaded) {
+        os_error_t result = loadModel(modelPath ? modelPath : OS_KWS_MODEL_PATH);
+        if (result != OS_OK) {
+            return result;
+        }
+    }
+
+    // The spotter never needs the mic PGA boosted
+    os_error_t result = m_input.open(4);
+    if (result != OS_OK) {
+        return result;
+    }
+
+    memset(m_history, 0, OVERLAP * sizeof(int16_t));
+    memset(m_features, 0, m_header.frames * m_header.coefficients * sizeof(int16_t));
+    memset(m_scores, 0, sizeof(m_scores));
+    m_scoreIndex = 0;
+    m_hopCounter = 0;
+    m_quietFrames = m_header.frames;
+    m_warmupFrames = m_header.frames;
+    m_onsetUs = 0;
+    m_detected.store(false);
+    m_windowStartUs = esp_timer_get_time();
+    m_windowBusyUs = 0;
+    m_lastStatsLogUs = m_windowStartUs;
+
+    m_running = true;
+    if (xTaskCreatePinnedToCore(spotterTask, "kws", OS_KWS_TASK_STACK, this,
+                                OS_KWS_TASK_PRIORITY, &m_task, OS_KWS_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create spotter task");
+        m_running = false;
+        m_task = nullptr;
+        m_input.close();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    ESP_LOGI(TAG, "Listening for \"%s\"", m_header.keyword);
+    return OS_OK;
+}
+
+void KeywordSpotter::stop() {
+    if (m_task) {
+        m_running = false;
+        for (int i = 0; i < 30 && m_task; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Spotter task did not exit, deleting it");
+            vTaskDelete(m_task);
+            m_task = nullptr;
+        }
+    }
+    m_input.close();
+}
+
+void KeywordSpotter::unload() {
+    for (Layer& layer : m_layers) {
+        if (layer.weights) {
+            OS_FREE(layer.weights);
+        }
+        if (layer.bias) {
+            OS_FREE(layer.bias);
+        }
+        layer = {};
+    }
+    for (int16_t*& buffer : m_activations) {
+        if (buffer) {
+            OS_FREE(buffer);
+            buffer = nullptr;
+        }
+    }
+    float** tables[] = {&m_window, &m_fft, &m_power, &m_dct, &m_melWeights};
+    for (float** table : tables) {
+        if (*table) {
+            OS_FREE(*table);
+            *table = nullptr;
+        }
+    }
+    if (m_history) {
+        OS_FREE(m_history);
+        m_history = nullptr;
+    }
+    if (m_features) {
+        OS_FREE(m_features);
+        m_features = nullptr;
+    }
+    m_header = {};
+    m_maxWidth = 0;
+    m_loaded = false;
+}
+
+os_error_t KeywordSpotter::loadModel(const char* path) {
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    FileHandle handle = storage.openFile(path, FileOpenMode::READ);
+    if (handle == INVALID_FILE_HANDLE) {
+        ESP_LOGW(TAG, "No wake-word model at %s", path);
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    os_error_t result = OS_OK;
+    KwsModelHeader& header = m_header;
+    if (storage.read(handle, &header, sizeof(header)) != (int)sizeof(header) ||
+        header.magic != KWS_MODEL_MAGIC || header.version != KWS_MODEL_VERSION ||
+        header.layerCount == 0 || header.layerCount > OS_KWS_MAX_LAYERS ||
+        header.frames == 0 || header.frames > OS_KWS_MAX_FRAMES ||
+        header.coefficients == 0 || header.coefficients > OS_KWS_MAX_COEFFS ||
+        header.classes == 0 || header.classes > MAX_CLASSES || header.keywordClass >= header.classes) {
+        result = OS_ERROR_NOT_SUPPORTED;
+    }
+    header.keyword[sizeof(header.keyword) - 1] = '\0';
+
+    uint16_t previousOutputs = header.frames * header.coefficients;
+    for (uint16_t i = 0; result == OS_OK && i < header.layerCount; i++) {
+        Layer& layer = m_layers[i];
+        KwsLayerHeader& info = layer.header;
+        if (storage.read(handle, &info, sizeof(info)) != (int)sizeof(info) ||
+            info.inputs % 8 != 0 || info.inputs < previousOutputs || info.outputs == 0) {
+            result = OS_ERROR_NOT_SUPPORTED;
+            break;
+        }
+
+        // Rows stay 16-byte aligned for the SIMD dot product
+        size_t weightBytes = (size_t)info.inputs * info.outputs * sizeof(int16_t);
+        layer.weights = (int16_t*)OS_MALLOC_DMA(weightBytes);
+        layer.bias = (float*)OS_MALLOC(info.outputs * sizeof(float));
+        if (!layer.weights || !layer.bias) {
+            result = OS_ERROR_NO_MEMORY;
+            break;
+        }
+        if (storage.read(handle, layer.weights, weightBytes) != (int)weightBytes ||
+            storage.read(handle, layer.bias, info.outputs * sizeof(float)) !=
+                (int)(info.outputs * sizeof(float))) {
+            result = OS_ERROR_NOT_SUPPORTED;
+            break;
+        }
+        m_maxWidth = std::max(m_maxWidth, std::max(info.inputs, info.outputs));
+        previousOutputs = info.outputs;
+    }
+    if (result == OS_OK && previousOutputs != header.classes) {
+        result = OS_ERROR_NOT_SUPPORTED;
+    }
+    storage.closeFile(handle);
+
+    if (result == OS_OK) {
+        result = buildTables();
+    }
+    if (result != OS_OK) {
+        ESP_LOGE(TAG, "Failed to load wake-word model %s: %d", path, result);
+        unload();
+        return result;
+    }
+
+    m_loaded = true;
+    ESP_LOGI(TAG, "Model \"%s\": %d layers, %d x %d features, %d classes",
+             header.keyword, header.layerCount, header.frames, header.coefficients, header.classes);
+    return OS_OK;
+}
+
+os_error_t KeywordSpotter::buildTables() {
+    const uint16_t coefficients = m_header.coefficients;
+    for (int16_t*& buffer : m_activations) {
+        buffer = (int16_t*)OS_MALLOC_DMA(m_maxWidth * sizeof(int16_t));
+    }
+    m_window = (float*)OS_MALLOC_DMA(OS_KWS_FFT_SIZE * sizeof(float));
+    m_fft = (float*)OS_MALLOC_DMA(OS_KWS_FFT_SIZE * sizeof(float));
+    m_power = (float*)OS_MALLOC_DMA(FFT_BINS * sizeof(float));
+    m_dct = (float*)OS_MALLOC_DMA(coefficients * OS_KWS_MEL_BANDS * sizeof(float));
+    m_history = (int16_t*)OS_MALLOC(OVERLAP * sizeof(int16_t));
+    m_features = (int16_t*)OS_MALLOC(m_header.frames * coefficients * sizeof(int16_t));
+    if (!m_activations[0] || !m_activations[1] || !m_window || !m_fft || !m_power ||
+        !m_dct || !m_history || !m_features) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    // Real FFT of OS_KWS_FFT_SIZE points as a half-size complex transform
+    esp_err_t ret = dsps_fft4r_init_fc32(nullptr, FFT_BINS);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "FFT init failed: %s", esp_err_to_name(ret));
+        return OS_ERROR_GENERIC;
+    }
+    dsps_wind_hann_f32(m_window, OS_KWS_FFT_SIZE);
+
+    // Triangular mel filters, stored as dense runs over the bins they cover
+    float edges[OS_KWS_MEL_BANDS + 2];
+    float melLow = hzToMel(MEL_LOW_HZ);
+    float melHigh = hzToMel(MEL_HIGH_HZ);
+    for (size_t i = 0; i < OS_KWS_MEL_BANDS + 2; i++) {
+        float hz = melToHz(melLow + (melHigh - melLow) * i / (OS_KWS_MEL_BANDS + 1));
+        edges[i] = hz * OS_KWS_FFT_SIZE / OS_AUDIO_SAMPLE_RATE;
+    }
+    size_t total = 0;
+    for (size_t band = 0; band < OS_KWS_MEL_BANDS; band++) {
+        size_t first = (size_t)ceilf(edges[band]);
+        size_t last = std::min((size_t)floorf(edges[band + 2]), FFT_BINS - 1);
+        m_mel[band].firstBin = (uint16_t)first;
+        m_mel[band].length = (uint16_t)(last >= first ? last - first + 1 : 0);
+        total += m_mel[band].length;
+    }
+    m_melWeights = (float*)OS_MALLOC_DMA(std::max(total, (size_t)1) * sizeof(float));
+    if (!m_melWeights) {
+        return OS_ERROR_NO_MEMORY;
+    }
+    float* weights = m_melWeights;
+    for (size_t band = 0; band < OS_KWS_MEL_BANDS; band++) {
+        MelFilter& filter = m_mel[band];
+        filter.weights = weights;
+        for (size_t i = 0; i < filter.length; i++) {
+            float bin = (float)(filter.firstBin + i);
+            float rising = (bin - edges[band]) / (edges[band + 1] - edges[band]);
+            float falling = (edges[band + 2] - bin) / (edges[band + 2] - edges[band + 1]);
+            weights[i] = std::max(0.0f, std::min(rising, falling));
+        }
+        weights += filter.length;
+    }
+
+    // Orthonormal DCT-II rows
+    for (size_t k = 0; k < coefficients; k++) {
+        float norm = sqrtf((k == 0 ? 1.0f : 2.0f) / OS_KWS_MEL_BANDS);
+        for (size_t m = 0; m < OS_KWS_MEL_BANDS; m++) {
+            m_dct[k * OS_KWS_MEL_BANDS + m] = norm * cosf((float)M_PI * k * (m + 0.5f) / OS_KWS_MEL_BANDS);
+        }
+    }
+    return OS_OK;
+}
+
+void KeywordSpotter::computeFeatures(const int16_t* samples, int16_t* out) {
+    // Previous frame's tail plus this frame fill the analysis window
+    for (size_t i = 0; i < OVERLAP; i++) {
+        m_fft[i] = m_history[i] * (1.0f / 32768.0f);
+    }
+    for (size_t i = 0; i < OS_AUDIO_FRAME_SAMPLES; i++) {
+        m_fft[OVERLAP + i] = samples[i] * (1.0f / 32768.0f);
+    }
+    dsps_mul_f32(m_fft, m_window, m_fft, OS_KWS_FFT_SIZE, 1, 1, 1);
+
+    dsps_fft4r_fc32(m_fft, FFT_BINS);
+    dsps_bit_rev4r_fc32(m_fft, FFT_BINS);
+    dsps_cplx2real_fc32(m_fft, FFT_BINS);
+    for (size_t i = 0; i < FFT_BINS; i++) {
+        m_power[i] = m_fft[2 * i] * m_fft[2 * i] + m_fft[2 * i + 1] * m_fft[2 * i + 1];
+    }
+
+    float logMel[OS_KWS_MEL_BANDS];
+    for (size_t band = 0; band < OS_KWS_MEL_BANDS; band++) {
+        const MelFilter& filter = m_mel[band];
+        float energy = 0.0f;
+        if (filter.length) {
+            dsps_dotprod_f32(m_power + filter.firstBin, filter.weights, &energy, filter.length);
+        }
+        logMel[band] = logf(energy + 1e-6f);
+    }
+
+    for (size_t k = 0; k < m_header.coefficients; k++) {
+        float coefficient = 0.0f;
+        dsps_dotprod_f32(m_dct + k * OS_KWS_MEL_BANDS, logMel, &coefficient, OS_KWS_MEL_BANDS);
+        out[k] = toQ15(coefficient * m_header.featureScale);
+    }
+}
+
+float KeywordSpotter::runModel() {
+    int16_t* input = m_activations[0];
+    int16_t* output = m_activations[1];
+    size_t featureCount = m_header.frames * m_header.coefficients;
+    memcpy(input, m_features, featureCount * sizeof(int16_t));
+    memset(input + featureCount, 0, (m_layers[0].header.inputs - featureCount) * sizeof(int16_t));
+
+    float logits[MAX_CLASSES];
+    for (uint16_t l = 0; l < m_header.layerCount; l++) {
+        const Layer& layer = m_layers[l];
+        const KwsLayerHeader& info = layer.header;
+        bool last = l + 1 == m_header.layerCount;
+
+        for (uint16_t o = 0; o < info.outputs; o++) {
+            int16_t dot = 0;
+            dsps_dotprod_s16(layer.weights + (size_t)o * info.inputs, input, &dot, info.inputs, info.shift);
+            float value = dot * info.weightScale + layer.bias[o];
+            if (last) {
+                logits[o] = value;
+            } else {
+                output[o] = toQ15((info.relu ? std::max(value, 0.0f) : value) / info.outputScale);
+            }
+        }
+        if (!last) {
+            uint16_t nextInputs = m_layers[l + 1].header.inputs;
+            memset(output + info.outputs, 0, (nextInputs - info.outputs) * sizeof(int16_t));
+            std::swap(input, output);
+        }
+    }
+
+    float peak = *std::max_element(logits, logits + m_header.classes);
+    float sum = 0.0f;
+    for (uint16_t c = 0; c < m_header.classes; c++) {
+        logits[c] = expf(logits[c] - peak);
+        sum += logits[c];
+    }
+    return logits[m_header.keywordClass] / sum;
+}
+
+void KeywordSpotter::processFrame(const int16_t* samples) {
+    int64_t startUs = esp_timer_get_time();
+    m_stats.frames++;
+
+    int64_t energy = 0;
+    for (size_t i = 0; i < OS_AUDIO_FRAME_SAMPLES; i++) {
+        energy += (int32_t)samples[i] * samples[i];
+    }
+    bool loud = sqrtf((float)energy / OS_AUDIO_FRAME_SAMPLES) >= OS_KWS_GATE_RMS;
+    if (loud) {
+        if (m_quietFrames >= ONSET_QUIET_FRAMES) {
+            m_onsetUs = startUs;
+        }
+        m_quietFrames = 0;
+    } else {
+        m_quietFrames++;
+    }
+
+    // Slide the feature window by one frame
+    const uint16_t coefficients = m_header.coefficients;
+    const uint16_t frames = m_header.frames;
+    memmove(m_features, m_features + coefficients, (frames - 1) * coefficients * sizeof(int16_t));
+    int16_t* newest = m_features + (frames - 1) * coefficients;
+    if (m_warmupFrames > 0 || m_quietFrames <= frames) {
+        computeFeatures(samples, newest);
+        m_featureTotalUs += esp_timer_get_time() - startUs;
+        m_stats.featureFrames++;
+        m_stats.featureAvgUs = (uint32_t)(m_featureTotalUs / m_stats.featureFrames);
+        if (m_warmupFrames > 0) {
+            m_warmupFrames--;
+        }
+    } else if (frames > 1) {
+        // The whole window is quiet: repeat the last quiet frame instead of an FFT
+        memcpy(newest, newest - coefficients, coefficients * sizeof(int16_t));
+    }
+    memcpy(m_history, samples + OS_AUDIO_FRAME_SAMPLES - OVERLAP, OVERLAP * sizeof(int16_t));
+
+    // Inference only while the window holds sound, every few frames
+    if (m_quietFrames < frames && ++m_hopCounter >= OS_KWS_INFERENCE_HOP) {
+        m_hopCounter = 0;
+        int64_t inferenceStart = esp_timer_get_time();
+        float probability = runModel();
+        uint32_t inferenceUs = (uint32_t)(esp_timer_get_time() - inferenceStart);
+        m_inferenceTotalUs += inferenceUs;
+        m_stats.inferences++;
+        m_stats.inferenceAvgUs = (uint32_t)(m_inferenceTotalUs / m_stats.inferences);
+        m_stats.inferenceMaxUs = std::max(m_stats.inferenceMaxUs, inferenceUs);
+
+        m_scores[m_scoreIndex++ % OS_KWS_SMOOTHING] = probability;
+        float smoothed = 0.0f;
+        for (float score : m_scores) {
+            smoothed += score;
+        }
+        smoothed /= OS_KWS_SMOOTHING;
+        m_stats.lastScore = smoothed;
+
+        if (smoothed >= m_header.threshold) {
+            int64_t nowUs = esp_timer_get_time();
+            m_stats.detections++;
+            m_stats.lastLatencyMs = m_onsetUs ? (uint32_t)((nowUs - m_onsetUs) / 1000) : 0;
+            ESP_LOGI(TAG, "\"%s\" detected (score %.2f, %d ms after onset, inference %d us)",
+                     m_header.keyword, smoothed, m_stats.lastLatencyMs, inferenceUs);
+            m_running = false;
+            m_detected.store(true, std::memory_order_release);
+            OS().wake();
+        }
+    }
+
+    // CPU share of this core, over one-second windows
+    int64_t endUs = esp_timer_get_time();
+    m_windowBusyUs += endUs - startUs;
+    if (endUs - m_windowStartUs >= CPU_WINDOW_US) {
+        m_stats.cpuPercent = 100.0f * m_windowBusyUs / (endUs - m_windowStartUs);
+        m_windowStartUs = endUs;
+        m_windowBusyUs = 0;
+    }
+    if (endUs - m_lastStatsLogUs >= (int64_t)OS_KWS_STATS_MS * 1000) {
+        m_lastStatsLogUs = endUs;
+        ESP_LOGI(TAG, "CPU %.1f%%, %d/%d frames analysed, %d inferences (avg %d us, max %d us), MFCC %d us",
+                 m_stats.cpuPercent, m_stats.featureFrames, m_stats.frames, m_stats.inferences,
+                 m_stats.inferenceAvgUs, m_stats.inferenceMaxUs, m_stats.featureAvgUs);
+    }
+}
+
+void KeywordSpotter::spotterTask(void* parameter) {
+    KeywordSpotter* spotter = static_cast<KeywordSpotter*>(parameter);
+    static constexpr uint32_t FRAME_MS = OS_AUDIO_FRAME_SAMPLES * 1000 / OS_AUDIO_SAMPLE_RATE;
+    int16_t frame[OS_AUDIO_FRAME_SAMPLES];
+
+    while (spotter->m_running) {
+        // Blocks in the I2S driver between frames; the core is free meanwhile
+        size_t count = spotter->m_input.read(frame, OS_AUDIO_FRAME_SAMPLES, FRAME_MS * 4);
+        if (count == 0) {
+            ESP_LOGE(TAG, "Microphone stopped delivering samples");
+            break;
+        }
+        if (count < OS_AUDIO_FRAME_SAMPLES) {
+            memset(frame + count, 0, (OS_AUDIO_FRAME_SAMPLES - count) * sizeof(int16_t));
+        }
+        spotter->processFrame(frame);
+    }
+
+    // Hand the microphone to the voice pipeline straight away
+    spotter->m_input.close();
+    spotter->m_running = false;
+    spotter->m_task = nullptr;
+    vTaskDelete(NULL);
+}
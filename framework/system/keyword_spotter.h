@@ -0,0 +1,188 @@
+#ifndef KEYWORD_SPOTTER_H
+#define KEYWORD_SPOTTER_H
+
+#include "os_config.h"
+#include "../hal/audio_input.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+
+/**
+ * @file keyword_spotter.h
+ * @brief On-device wake-word detection; no audio leaves the device
+ *
+ * While armed, a task on OS_KWS_TASK_CORE owns the microphone and turns
+ * every 20 ms frame into MFCCs: Hann window, real FFT, mel filterbank and
+ * DCT, all through ESP-DSP kernels (the P4 builds use its SIMD paths).
+ * The coefficients slide through a feature window that feeds a small
+ * dense network with Q15 weights and activations (dsps_dotprod_s16).
+ *
+ * Work is duty-cycled on frame energy. Below OS_KWS_GATE_RMS nothing runs
+ * but an RMS sum; once the whole window is quiet even the FFT is skipped
+ * and the last quiet frame's features are repeated. The network runs
+ * every OS_KWS_INFERENCE_HOP frames only while loud frames are in the
+ * window. A detection closes the microphone and sets a flag for the owner
+ * to wake the full voice pipeline.
+ *
+ * Model file (little endian, written by tools/kws_pack.py):
+ *   KwsModelHeader, then per layer KwsLayerHeader, int16 weights
+ *   [outputs][inputs] (inputs padded to a multiple of 8) and float bias
+ *   [outputs]. Layer output = dot(weights, input) * weightScale + bias,
+ *   with ReLU on hidden layers and a softmax over the last one.
+ *
+ * start(), stop() and takeDetection() come from one task.
+ */
+
+static constexpr uint32_t KWS_MODEL_MAGIC = 0x3153574B;    // "KWS1"
+static constexpr uint16_t KWS_MODEL_VERSION = 1;
+
+struct KwsModelHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t layerCount;
+    uint16_t frames;            // Feature frames per inference window
+    uint16_t coefficients;      // MFCCs per frame
+    uint16_t classes;
+    uint16_t keywordClass;      // Output index of the wake word
+    float featureScale;         // MFCC x scale gives Q15 input in [-1, 1)
+    float threshold;            // Smoothed keyword probability that fires
+    char keyword[24];           // Display name, NUL padded
+};
+static_assert(sizeof(KwsModelHeader) == 48, "KWS model header layout");
+
+struct KwsLayerHeader {
+    uint16_t inputs;            // Multiple of 8
+    uint16_t outputs;
+    int8_t shift;               // dsps_dotprod_s16 shift used when quantising
+    uint8_t relu;
+    uint16_t reserved;
+    float weightScale;          // Real value of one Q15 dot product step
+    float outputScale;          // Activation range mapped onto Q15 for the next layer
+};
+static_assert(sizeof(KwsLayerHeader) == 16, "KWS layer header layout");
+
+struct KeywordSpotterStats {
+    uint32_t frames;            // Microphone frames seen
+    uint32_t featureFrames;     // Frames that ran the FFT/MFCC path
+    uint32_t inferences;
+    uint32_t detections;
+    uint32_t featureAvgUs;      // MFCC path per frame
+    uint32_t inferenceAvgUs;
+    uint32_t inferenceMaxUs;
+    float cpuPercent;           // Busy share of one core over the last second
+    uint32_t lastLatencyMs;     // First loud frame of the utterance to detection
+    float lastScore;            // Smoothed keyword probability at the last inference
+};
+
+class KeywordSpotter {
+public:
+    KeywordSpotter() = default;
+    ~KeywordSpotter();
+
+    KeywordSpotter(const KeywordSpotter&) = delete;
+    KeywordSpotter& operator=(const KeywordSpotter&) = delete;
+
+    /**
+     * @brief Load the model if needed, open the microphone and listen
+     * @param modelPath Model file, nullptr for OS_KWS_MODEL_PATH
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND without a model file,
+     *         OS_ERROR_NOT_SUPPORTED for a malformed one, OS_ERROR_HARDWARE
+     *         or OS_ERROR_NO_MEMORY
+     */
+    os_error_t start(const char* modelPath = nullptr);
+
+    /**
+     * @brief Stop listening and release the microphone (the model stays loaded)
+     */
+    void stop();
+
+    /**
+     * @brief Check if the spotter holds the microphone
+     * @return true while armed
+     */
+    bool isRunning() const { return m_task != nullptr; }
+
+    /**
+     * @brief Consume a pending detection
+     * @return true once per detection; the microphone is already released
+     */
+    bool takeDetection() { return m_detected.exchange(false, std::memory_order_acq_rel); }
+
+    /**
+     * @brief Get the wake word the loaded model spots
+     * @return Keyword name, empty before a model is loaded
+     */
+    const char* getKeyword() const { return m_header.keyword; }
+
+    /**
+     * @brief Get CPU, latency and detection counters
+     * @return Statistics snapshot
+     */
+    KeywordSpotterStats getStats() const { return m_stats; }
+
+    /**
+     * @brief Free the model and feature tables
+     */
+    void unload();
+
+private:
+    struct Layer {
+        KwsLayerHeader header;
+        int16_t* weights;
+        float* bias;
+    };
+
+    struct MelFilter {
+        uint16_t firstBin;
+        uint16_t length;
+        float* weights;
+    };
+
+    os_error_t loadModel(const char* path);
+    os_error_t buildTables();
+    void computeFeatures(const int16_t* samples, int16_t* out);
+    float runModel();
+    void processFrame(const int16_t* samples);
+
+    static void spotterTask(void* parameter);
+
+    AudioInput m_input;
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_running = false;
+    std::atomic<bool> m_detected{false};
+
+    // Model
+    KwsModelHeader m_header = {};
+    Layer m_layers[OS_KWS_MAX_LAYERS] = {};
+    int16_t* m_activations[2] = {nullptr, nullptr};  // Ping-pong layer buffers
+    uint16_t m_maxWidth = 0;
+    bool m_loaded = false;
+
+    // Feature extraction tables and scratch
+    float* m_window = nullptr;          // Hann, OS_KWS_FFT_SIZE
+    float* m_fft = nullptr;             // OS_KWS_FFT_SIZE floats, packed complex
+    float* m_power = nullptr;           // OS_KWS_FFT_SIZE / 2 bins
+    float* m_dct = nullptr;             // coefficients x OS_KWS_MEL_BANDS
+    MelFilter m_mel[OS_KWS_MEL_BANDS] = {};
+    float* m_melWeights = nullptr;
+    int16_t* m_history = nullptr;       // FFT_SIZE - FRAME overlap samples
+    int16_t* m_features = nullptr;      // frames x coefficients, Q15, oldest first
+
+    // Detector state, touched only by the task
+    uint32_t m_quietFrames = 0;
+    uint32_t m_hopCounter = 0;
+    float m_scores[OS_KWS_SMOOTHING] = {};
+    uint32_t m_scoreIndex = 0;
+    uint32_t m_warmupFrames = 0;        // Fill the window with real features after start()
+    int64_t m_onsetUs = 0;
+
+    // Statistics
+    int64_t m_windowStartUs = 0;
+    int64_t m_windowBusyUs = 0;
+    int64_t m_lastStatsLogUs = 0;
+    uint64_t m_featureTotalUs = 0;
+    uint64_t m_inferenceTotalUs = 0;
+    KeywordSpotterStats m_stats = {};
+};
+
+#endif // KEYWORD_SPOTTER_H
@@ -0,0 +1,87 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file latency_histogram.h
+ * @brief Fixed-bucket latency histogram
+ *
+ * Buckets are spaced around frame periods (a 60 Hz frame is 16.7 ms), so
+ * "how many frames late" reads straight off the distribution. Percentiles
+ * resolve to a bucket's upper edge.
+ */
+
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 10;
+
+    /**
+     * @brief Get a bucket's upper edge
+     * @param bucket Bucket index
+     * @return Upper edge in microseconds (UINT32_MAX for the last bucket)
+     */
+    static uint32_t bucketLimitUs(size_t bucket) {
+        static const uint32_t limits[BUCKETS] = {
+            4000, 8000, 12000, 17000, 25000, 34000, 50000, 67000, 100000, UINT32_MAX
+        };
+        return limits[bucket];
+    }
+
+    /**
+     * @brief Record a sample
+     * @param us Latency in microseconds
+     */
+    void add(uint32_t us) {
+        size_t bucket = 0;
+        while (us >= bucketLimitUs(bucket) && bucket < BUCKETS - 1) {
+            bucket++;
+        }
+        m_counts[bucket]++;
+        m_samples++;
+        m_totalUs += us;
+        if (us > m_maxUs) m_maxUs = us;
+        if (us < m_minUs) m_minUs = us;
+    }
+
+    /**
+     * @brief Forget all samples
+     */
+    void reset() { *this = LatencyHistogram(); }
+
+    /**
+     * @brief Get the upper edge of the bucket holding a percentile
+     * @param percent Percentile (0-100)
+     * @return Microseconds, 0 if there are no samples
+     */
+    uint32_t percentileUs(uint8_t percent) const {
+        if (m_samples == 0) {
+            return 0;
+        }
+        uint32_t target = (uint32_t)(((uint64_t)m_samples * percent + 99) / 100);
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += m_counts[i];
+            if (seen >= target && seen > 0) {
+                return i == BUCKETS - 1 ? m_maxUs : bucketLimitUs(i);
+            }
+        }
+        return m_maxUs;
+    }
+
+    uint32_t count(size_t bucket) const { return m_counts[bucket]; }
+    uint32_t samples() const { return m_samples; }
+    uint32_t averageUs() const { return m_samples ? (uint32_t)(m_totalUs / m_samples) : 0; }
+    uint32_t minUs() const { return m_samples ? m_minUs : 0; }
+    uint32_t maxUs() const { return m_maxUs; }
+
+private:
+    uint32_t m_counts[BUCKETS] = {};
+    uint32_t m_samples = 0;
+    uint64_t m_totalUs = 0;
+    uint32_t m_minUs = UINT32_MAX;
+    uint32_t m_maxUs = 0;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,121 @@
+#include "memory_arena.h"
+#include "memory_manager.h"
+#include <esp_log.h>
+
+static const char* TAG = "MemoryArena";
+
+MemoryArena::MemoryArena(MemoryManager& owner, const char* name, size_t limit, size_t chunkSize)
+    : m_owner(owner), m_name(name ? name : "arena"),
+      m_limit(limit ? limit : OS_APP_HEAP_SIZE), m_chunkSize(chunkSize) {
+}
+
+MemoryArena::~MemoryArena() {
+    release();
+}
+
+void* MemoryArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    Chunk* chunk = m_head;
+    size_t aligned = 0;
+
+    if (chunk) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunkData(chunk));
+        aligned = ((base + chunk->offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    }
+
+    if (!chunk || aligned + size > chunk->size) {
+        chunk = addChunk(size + alignment);
+        if (!chunk) {
+            ESP_LOGW(TAG, "Arena '%s' cannot satisfy %d bytes (%d/%d reserved)",
+                     m_name, size, m_reserved, m_limit);
+            return nullptr;
+        }
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunkData(chunk));
+        aligned = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    }
+
+    m_used += (aligned - chunk->offset) + size;
+    chunk->offset = aligned + size;
+    m_allocationCount++;
+
+    return chunkData(chunk) + aligned;
+}
+
+void MemoryArena::reset() {
+    // Keep the oldest chunk and free the rest
+    while (m_head && m_head->next) {
+        Chunk* chunk = m_head;
+        m_head = chunk->next;
+        m_reserved -= sizeof(Chunk) + chunk->size;
+        m_owner.releaseAppHeap(sizeof(Chunk) + chunk->size);
+        heap_caps_free(chunk);
+    }
+
+    if (m_head) {
+        m_head->offset = 0;
+    }
+    m_used = 0;
+}
+
+void MemoryArena::release() {
+    size_t freed = m_reserved;
+
+    while (m_head) {
+        Chunk* chunk = m_head;
+        m_head = chunk->next;
+        m_owner.releaseAppHeap(sizeof(Chunk) + chunk->size);
+        heap_caps_free(chunk);
+    }
+
+    m_used = 0;
+    m_reserved = 0;
+
+    if (freed > 0) {
+        ESP_LOGD(TAG, "Released arena '%s' (%d bytes, %d allocations)",
+                 m_name, freed, m_allocationCount);
+    }
+}
+
+MemoryArena::Chunk* MemoryArena::addChunk(size_t minSize) {
+    size_t usable = minSize > m_chunkSize ? minSize : m_chunkSize;
+    size_t total = sizeof(Chunk) + usable;
+
+    // Shrink a default-sized chunk to whatever headroom is left under the limit
+    if (m_reserved + total > m_limit) {
+        if (m_reserved + sizeof(Chunk) + minSize > m_limit) {
+            return nullptr;
+        }
+        usable = m_limit - m_reserved - sizeof(Chunk);
+        total = sizeof(Chunk) + usable;
+    }
+
+    if (!m_owner.reserveAppHeap(total)) {
+        return nullptr;
+    }
+
+    // Arenas hold bulk app data; prefer PSRAM and keep internal SRAM for the system
+    void* mem = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!mem) {
+        mem = heap_caps_malloc(total, MALLOC_CAP_DEFAULT);
+    }
+    if (!mem) {
+        m_owner.releaseAppHeap(total);
+        return nullptr;
+    }
+
+    Chunk* chunk = static_cast<Chunk*>(mem);
+    chunk->next = m_head;
+    chunk->size = usable;
+    chunk->offset = 0;
+    m_head = chunk;
+
+    m_reserved += total;
+    if (m_reserved > m_peakReserved) {
+        m_peakReserved = m_reserved;
+    }
+
+    return chunk;
+}
@@ -0,0 +1,131 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include "os_config.h"
+#include <esp_heap_caps.h>
+#include <new>
+#include <utility>
+
+/**
+ * @file memory_arena.h
+ * @brief Region (bump-pointer) allocator for per-application memory
+ * 
+ * Each application launched by the AppManager owns one arena. Allocation
+ * is a pointer bump inside the current chunk; individual objects are never
+ * freed. The whole arena is returned to the app heap in a single release()
+ * when the application is killed, which also yields exact per-app usage.
+ */
+
+class MemoryManager;
+
+class MemoryArena {
+public:
+    /**
+     * @brief Constructor
+     * @param owner Memory manager that accounts for the app heap budget
+     * @param name Arena name for debugging (usually the app ID)
+     * @param limit Maximum bytes this arena may reserve (0 = app heap size)
+     * @param chunkSize Default chunk size in bytes
+     */
+    MemoryArena(MemoryManager& owner, const char* name, size_t limit = 0,
+                size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    /**
+     * @brief Allocate memory from the arena
+     * @param size Size in bytes
+     * @param alignment Required alignment (power of two)
+     * @return Pointer to memory or nullptr if the arena limit is reached
+     */
+    void* allocate(size_t size, size_t alignment = sizeof(void*) * 2);
+
+    /**
+     * @brief Construct an object in the arena
+     * @note Destructors are not run on release(); only use for objects
+     *       that do not own resources outside the arena.
+     * @return Pointer to constructed object or nullptr on failure
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        void* mem = allocate(sizeof(T), alignof(T));
+        return mem ? new (mem) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * @brief Rewind the arena to empty, keeping the first chunk reserved
+     */
+    void reset();
+
+    /**
+     * @brief Free every chunk back to the app heap in one operation
+     */
+    void release();
+
+    /**
+     * @brief Get bytes handed out to callers
+     * @return Used bytes
+     */
+    size_t getUsed() const { return m_used; }
+
+    /**
+     * @brief Get bytes reserved from the app heap (used + slack)
+     * @return Reserved bytes
+     */
+    size_t getReserved() const { return m_reserved; }
+
+    /**
+     * @brief Get peak reserved bytes
+     * @return Peak reserved bytes
+     */
+    size_t getPeakReserved() const { return m_peakReserved; }
+
+    /**
+     * @brief Get arena limit
+     * @return Limit in bytes
+     */
+    size_t getLimit() const { return m_limit; }
+
+    /**
+     * @brief Get number of allocations served
+     * @return Allocation count
+     */
+    uint32_t getAllocationCount() const { return m_allocationCount; }
+
+    const char* getName() const { return m_name; }
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;    // Usable bytes after the header
+        size_t offset;  // Bump pointer within the usable area
+    };
+
+    /**
+     * @brief Reserve a new chunk able to hold at least minSize bytes
+     * @param minSize Minimum usable size
+     * @return New chunk or nullptr if over budget / out of memory
+     */
+    Chunk* addChunk(size_t minSize);
+
+    static char* chunkData(Chunk* chunk) {
+        return reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+    }
+
+    MemoryManager& m_owner;
+    const char* m_name;
+    size_t m_limit;
+    size_t m_chunkSize;
+
+    Chunk* m_head = nullptr;  // Current chunk (most recently added)
+    size_t m_used = 0;
+    size_t m_reserved = 0;
+    size_t m_peakReserved = 0;
+    uint32_t m_allocationCount = 0;
+};
+
+#endif // MEMORY_ARENA_H
@@ -1,19 +1,42 @@
 #include "memory_manager.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
+#include <algorithm>
 
 static const char* TAG = "MemoryManager";
 
 // MemoryPool Implementation
-MemoryPool::MemoryPool(size_t blockSize, size_t blockCount) 
-    : m_blockSize(blockSize), m_totalBlocks(blockCount), m_freeBlocks(blockCount) {
+MemoryPool::MemoryPool(size_t blockSize, size_t blockCount, uint32_t caps) 
+    : m_blockSize(blockSize), m_totalBlocks(blockCount), m_freeBlocks(blockCount), m_caps(caps) {
     
-    size_t totalSize = blockSize * blockCount;
-    m_memory = heap_caps_malloc(totalSize, MALLOC_CAP_DEFAULT);
+    // Every free block must be able to hold the free-list link
+    if (m_blockSize < sizeof(FreeNode)) {
+        m_blockSize = sizeof(FreeNode);
+    }
+    m_blockSize = (m_blockSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    size_t totalSize = m_blockSize * blockCount;
+    m_memory = heap_caps_malloc(totalSize, caps);
+    if (!m_memory && caps != MALLOC_CAP_DEFAULT) {
+        ESP_LOGW(TAG, "Pool caps 0x%x unavailable, falling back to default heap", caps);
+        m_caps = MALLOC_CAP_DEFAULT;
+        m_memory = heap_caps_malloc(totalSize, MALLOC_CAP_DEFAULT);
+    }
     
     if (m_memory) {
-        m_blockUsed.resize(blockCount, false);
-        ESP_LOGI(TAG, "Created memory pool: %d blocks of %d bytes", blockCount, blockSize);
+        m_usedBitmap.assign((blockCount + 31) / 32, 0);
+
+        // Thread every block onto the free list, lowest address first
+        char* base = static_cast<char*>(m_memory);
+        for (size_t i = blockCount; i > 0; i--) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(base + (i - 1) * m_blockSize);
+            node->next = m_freeList;
+            m_freeList = node;
+        }
+
+        ESP_LOGI(TAG, "Created memory pool: %d blocks of %d bytes (%s)", blockCount, m_blockSize,
+                 (m_caps & MALLOC_CAP_SPIRAM) ? "PSRAM" :
+                 (m_caps & MALLOC_CAP_INTERNAL) ? "internal" : "default");
     } else {
         ESP_LOGE(TAG, "Failed to allocate memory pool");
         m_totalBlocks = 0;
@@ -28,52 +51,55 @@ MemoryPool::~MemoryPool() {
 }
 
 void* MemoryPool::allocate() {
-    if (m_freeBlocks == 0) {
+    FreeNode* node = m_freeList;
+    if (!node) {
         return nullptr;
     }
 
-    for (size_t i = 0; i < m_totalBlocks; i++) {
-        if (!m_blockUsed[i]) {
-            m_blockUsed[i] = true;
-            m_freeBlocks--;
-            return static_cast<char*>(m_memory) + (i * m_blockSize);
-        }
-    }
+    m_freeList = node->next;
+    m_freeBlocks--;
 
-    return nullptr;
+    size_t blockIndex = (reinterpret_cast<char*>(node) - static_cast<char*>(m_memory)) / m_blockSize;
+    m_usedBitmap[blockIndex >> 5] |= (1u << (blockIndex & 31));
+
+    return node;
 }
 
 bool MemoryPool::deallocate(void* ptr) {
-    if (!ptr || !m_memory) {
-        return false;
-    }
-
-    char* charPtr = static_cast<char*>(ptr);
-    char* basePtr = static_cast<char*>(m_memory);
-    
-    if (charPtr < basePtr) {
+    if (!ptr || !owns(ptr)) {
         return false;
     }
 
-    size_t offset = charPtr - basePtr;
+    size_t offset = static_cast<char*>(ptr) - static_cast<char*>(m_memory);
     if (offset % m_blockSize != 0) {
         return false;
     }
 
     size_t blockIndex = offset / m_blockSize;
-    if (blockIndex >= m_totalBlocks) {
-        return false;
-    }
-
-    if (!m_blockUsed[blockIndex]) {
+    uint32_t mask = 1u << (blockIndex & 31);
+    uint32_t& word = m_usedBitmap[blockIndex >> 5];
+    if (!(word & mask)) {
         return false; // Double free
     }
 
-    m_blockUsed[blockIndex] = false;
+    word &= ~mask;
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next = m_freeList;
+    m_freeList = node;
     m_freeBlocks++;
     return true;
 }
 
+bool MemoryPool::owns(const void* ptr) const {
+    if (!m_memory || !ptr) {
+        return false;
+    }
+
+    const char* charPtr = static_cast<const char*>(ptr);
+    const char* basePtr = static_cast<const char*>(m_memory);
+    return charPtr >= basePtr && charPtr < basePtr + m_blockSize * m_totalBlocks;
+}
+
 // MemoryManager Implementation
 MemoryManager::~MemoryManager() {
     if (m_initialized) {
@@ -88,14 +114,31 @@ os_error_t MemoryManager::initialize() {
 
     ESP_LOGI(TAG, "Initializing Memory Manager");
 
-    // Create memory pools for common allocation sizes
-    m_pools.push_back(std::make_unique<MemoryPool>(16, 64));    // Small objects
-    m_pools.push_back(std::make_unique<MemoryPool>(64, 32));    // Medium objects
-    m_pools.push_back(std::make_unique<MemoryPool>(256, 16));   // Large objects
-    m_pools.push_back(std::make_unique<MemoryPool>(1024, 8));   // Very large objects
+    m_mutex = xSemaphoreCreateRecursiveMutex();
+    if (!m_mutex) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    // Create memory pools for common allocation sizes. Small pools back the
+    // hot event/touch paths and stay in internal SRAM; bulk pools go to PSRAM.
+    const uint32_t internalCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const uint32_t bulkCaps = OS_PSRAM_ENABLED ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : MALLOC_CAP_DEFAULT;
+    m_pools.push_back(std::make_unique<MemoryPool>(16, 64, internalCaps));  // Small objects
+    m_pools.push_back(std::make_unique<MemoryPool>(64, 32, internalCaps));  // Medium objects
+    m_pools.push_back(std::make_unique<MemoryPool>(256, 16, bulkCaps));     // Large objects
+    m_pools.push_back(std::make_unique<MemoryPool>(1024, 8, bulkCaps));     // Very large objects
 
     // Reserve space for tracking allocations
-    m_activeBlocks.reserve(256);
+    if (!rehash(512)) {
+        ESP_LOGE(TAG, "Failed to allocate allocation index");
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    // Call-site table; entry 0 collects unknown sites and table overflow
+    m_callsites.reserve(CALLSITE_TABLE_SIZE);
+    m_callsites.push_back(CallsiteStats{nullptr, 0, 0, 0, 0, 0, 0, 0});
+    m_callsiteSlots.assign(CALLSITE_TABLE_SIZE * 2, 0);
+    m_rateWindowStart = millis();
 
     m_initialized = true;
     ESP_LOGI(TAG, "Memory Manager initialized with %d pools", m_pools.size());
@@ -104,28 +147,23 @@ os_error_t MemoryManager::initialize() {
 }
 
 void* MemoryManager::allocate(size_t size, const char* file, int line) {
-    if (!m_initialized || size == 0) {
-        return nullptr;
-    }
+    return allocate(size, MemoryTier::AUTO, file, line);
+}
 
-    void* ptr = nullptr;
+void* MemoryManager::allocate(size_t size, MemoryTier tier, const char* file, int line) {
+    lock();
+    void* ptr = allocateLocked(size, tier, file, line);
+    unlock();
+    return ptr;
+}
 
-    // Try to allocate from pools first for small allocations
-    if (size <= 1024) {
-        for (auto& pool : m_pools) {
-            if (size <= pool->getBlockSize() && pool->getFreeBlocks() > 0) {
-                ptr = pool->allocate();
-                if (ptr) {
-                    break;
-                }
-            }
-        }
+void* MemoryManager::allocateLocked(size_t size, MemoryTier tier, const char* file, int line) {
+    if (!m_initialized || size == 0) {
+        return nullptr;
     }
 
-    // Fall back to heap allocation
-    if (!ptr) {
-        ptr = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
-    }
+    MemoryTier placed = tier;
+    void* ptr = allocateFromTier(size, tier, placed);
 
     if (ptr) {
         // Track the allocation
@@ -136,8 +174,34 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
         block.file = file;
         block.line = line;
         block.inUse = true;
+        block.tier = placed;
+        block.callsite = lookupCallsite(file, line);
+
+        if (!insertBlock(block)) {
+            // An untracked pointer could never be passed to OS_FREE, so give it back
+            releaseMemory(ptr);
+            m_tierStats[(size_t)tier].failures++;
+            ESP_LOGE(TAG, "Allocation index full, failing %d byte allocation", size);
+            updateStats();
+            return nullptr;
+        }
+
+        CallsiteStats& site = m_callsites[block.callsite];
+        site.liveBytes += size;
+        site.liveCount++;
+        site.totalAllocs++;
+        site.windowAllocs++;
+        if (site.liveBytes > site.peakBytes) {
+            site.peakBytes = site.liveBytes;
+        }
+
+        TierStats& tierStats = m_tierStats[(size_t)placed];
+        tierStats.liveBytes += size;
+        tierStats.allocations++;
+        if (tierStats.liveBytes > tierStats.peakBytes) {
+            tierStats.peakBytes = tierStats.liveBytes;
+        }
 
-        m_activeBlocks.push_back(block);
         m_totalAllocated += size;
         m_allocationCount++;
 
@@ -150,43 +214,124 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
                 file ? file : "unknown", line);
         #endif
     } else {
-        ESP_LOGW(TAG, "Failed to allocate %d bytes", size);
+        m_tierStats[(size_t)tier].failures++;
+        ESP_LOGW(TAG, "Failed to allocate %d bytes (tier %d)", size, (int)tier);
     }
 
+    updateStats();
     return ptr;
 }
 
-bool MemoryManager::deallocate(void* ptr) {
-    if (!ptr || !m_initialized) {
-        return false;
+void* MemoryManager::allocateFromPools(size_t size, uint32_t requiredCaps, MemoryTier& placed) {
+    for (auto& pool : m_pools) {
+        if (size > pool->getBlockSize() || pool->getFreeBlocks() == 0) {
+            continue;
+        }
+        if (requiredCaps && (pool->getCaps() & requiredCaps) != requiredCaps) {
+            continue;
+        }
+        void* ptr = pool->allocate();
+        if (ptr) {
+            placed = (pool->getCaps() & MALLOC_CAP_SPIRAM) ? MemoryTier::BULK_PSRAM
+                                                           : MemoryTier::HOT_INTERNAL;
+            return ptr;
+        }
     }
+    return nullptr;
+}
 
-    auto it = findBlock(ptr);
-    if (it == m_activeBlocks.end()) {
-        ESP_LOGW(TAG, "Attempt to free untracked pointer %p", ptr);
-        return false;
-    }
+void* MemoryManager::allocateFromTier(size_t size, MemoryTier tier, MemoryTier& placed) {
+    void* ptr = nullptr;
 
-    size_t size = it->size;
-    bool freedFromPool = false;
+    switch (tier) {
+        case MemoryTier::AUTO:
+            // Small allocations come from pools, mid-size from internal SRAM,
+            // and large buffers go straight to PSRAM
+            if (size <= 1024) {
+                ptr = allocateFromPools(size, 0, placed);
+                if (ptr) {
+                    return ptr;
+                }
+            }
+            return allocateFromTier(size, size > OS_MEM_PSRAM_THRESHOLD ?
+                                    MemoryTier::BULK_PSRAM : MemoryTier::HOT_INTERNAL, placed);
+
+        case MemoryTier::HOT_INTERNAL:
+            placed = MemoryTier::HOT_INTERNAL;
+            ptr = allocateFromPools(size, MALLOC_CAP_INTERNAL, placed);
+            if (!ptr) {
+                ptr = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+            if (!ptr) {
+                ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+                if (ptr) {
+                    placed = MemoryTier::BULK_PSRAM;
+                    m_tierStats[(size_t)tier].fallbacks++;
+                }
+            }
+            break;
 
-    // Try to free from pools first
-    for (auto& pool : m_pools) {
-        if (pool->deallocate(ptr)) {
-            freedFromPool = true;
+        case MemoryTier::BULK_PSRAM:
+            placed = MemoryTier::BULK_PSRAM;
+            ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (!ptr) {
+                ptr = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+                if (ptr) {
+                    placed = MemoryTier::HOT_INTERNAL;
+                    m_tierStats[(size_t)tier].fallbacks++;
+                }
+            }
+            break;
+
+        case MemoryTier::DMA_ALIGNED: {
+            // DMA buffers are padded to whole cache lines so cache
+            // maintenance never touches a neighbouring allocation
+            placed = MemoryTier::DMA_ALIGNED;
+            size_t padded = (size + OS_MEM_DMA_ALIGNMENT - 1) & ~(size_t)(OS_MEM_DMA_ALIGNMENT - 1);
+            if (padded > OS_MEM_PSRAM_THRESHOLD) {
+                ptr = heap_caps_aligned_alloc(OS_MEM_DMA_ALIGNMENT, padded,
+                                              MALLOC_CAP_SPIRAM | MALLOC_CAP_DMA);
+            }
+            if (!ptr) {
+                ptr = heap_caps_aligned_alloc(OS_MEM_DMA_ALIGNMENT, padded,
+                                              MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+            }
             break;
         }
     }
 
-    // Fall back to heap deallocation
-    if (!freedFromPool) {
-        heap_caps_free(ptr);
+    return ptr;
+}
+
+bool MemoryManager::deallocate(void* ptr) {
+    lock();
+    bool result = deallocateLocked(ptr);
+    unlock();
+    return result;
+}
+
+bool MemoryManager::deallocateLocked(void* ptr) {
+    if (!ptr || !m_initialized) {
+        return false;
     }
 
+    size_t slot = findBlock(ptr);
+    if (slot == SIZE_MAX) {
+        ESP_LOGW(TAG, "Attempt to free untracked pointer %p", ptr);
+        return false;
+    }
+
+    size_t size = m_blockTable[slot].size;
+    CallsiteStats& site = m_callsites[m_blockTable[slot].callsite];
+    releaseMemory(ptr);
+
     // Update tracking
     m_totalAllocated -= size;
     m_deallocationCount++;
-    m_activeBlocks.erase(it);
+    m_tierStats[(size_t)m_blockTable[slot].tier].liveBytes -= size;
+    site.liveBytes -= size;
+    site.liveCount--;
+    eraseBlock(slot);
 
     #if OS_DEBUG_ENABLED >= 3
     ESP_LOGD(TAG, "Deallocated %d bytes at %p", size, ptr);
@@ -195,12 +340,30 @@ bool MemoryManager::deallocate(void* ptr) {
     return true;
 }
 
+void MemoryManager::releaseMemory(void* ptr) {
+    // Try to free from pools first
+    for (auto& pool : m_pools) {
+        if (pool->owns(ptr)) {
+            if (!pool->deallocate(ptr)) {
+                ESP_LOGW(TAG, "Pool rejected free of %p", ptr);
+            }
+            return;
+        }
+    }
+
+    // Fall back to heap deallocation
+    heap_caps_free(ptr);
+}
+
 void* MemoryManager::allocateFromPool(size_t poolIndex) {
     if (!m_initialized || poolIndex >= m_pools.size()) {
         return nullptr;
     }
 
-    return m_pools[poolIndex]->allocate();
+    lock();
+    void* ptr = m_pools[poolIndex]->allocate();
+    unlock();
+    return ptr;
 }
 
 bool MemoryManager::deallocateFromPool(void* ptr, size_t poolIndex) {
@@ -208,44 +371,129 @@ bool MemoryManager::deallocateFromPool(void* ptr, size_t poolIndex) {
         return false;
     }
 
-    return m_pools[poolIndex]->deallocate(ptr);
+    lock();
+    bool result = m_pools[poolIndex]->deallocate(ptr);
+    unlock();
+    return result;
 }
 
-size_t MemoryManager::checkLeaks() {
-    size_t leakCount = 0;
-    uint32_t currentTime = millis();
-
-    for (const auto& block : m_activeBlocks) {
-        if (block.inUse) {
-            leakCount++;
-            ESP_LOGW(TAG, "Memory leak: %d bytes at %p, allocated %d ms ago (%s:%d)",
-                    block.size, block.ptr, currentTime - block.timestamp,
-                    block.file ? block.file : "unknown", block.line);
+bool MemoryManager::reserveAppHeap(size_t size) {
+    lock();
+    bool fits = m_appHeapUsed + size <= OS_APP_HEAP_SIZE;
+    if (fits) {
+        m_appHeapUsed += size;
+        if (m_appHeapUsed > m_appHeapPeak) {
+            m_appHeapPeak = m_appHeapUsed;
         }
     }
+    unlock();
+
+    if (!fits) {
+        ESP_LOGW(TAG, "App heap exhausted: %d + %d > %d bytes", m_appHeapUsed, size, OS_APP_HEAP_SIZE);
+    }
+    return fits;
+}
+
+void MemoryManager::releaseAppHeap(size_t size) {
+    lock();
+    m_appHeapUsed = size > m_appHeapUsed ? 0 : m_appHeapUsed - size;
+    unlock();
+}
+
+size_t MemoryManager::checkLeaks() {
+    size_t leakCount = m_activeCount;
 
     if (leakCount > 0) {
-        ESP_LOGW(TAG, "Found %d memory leaks", leakCount);
+        ESP_LOGW(TAG, "Found %d memory leaks (%d bytes)", leakCount, m_totalAllocated);
+
+        CallsiteStats top[TOP_CALLSITES_REPORTED];
+        size_t count = getTopCallsites(top, TOP_CALLSITES_REPORTED);
+        for (size_t i = 0; i < count; i++) {
+            ESP_LOGW(TAG, "  %d bytes in %d blocks from %s:%d",
+                    top[i].liveBytes, top[i].liveCount,
+                    top[i].file ? top[i].file : "unknown", top[i].line);
+        }
+
+        #if OS_DEBUG_ENABLED >= 3
+        uint32_t currentTime = millis();
+        for (const auto& block : m_blockTable) {
+            if (block.ptr) {
+                ESP_LOGD(TAG, "Memory leak: %d bytes at %p, allocated %d ms ago (%s:%d)",
+                        block.size, block.ptr, currentTime - block.timestamp,
+                        block.file ? block.file : "unknown", block.line);
+            }
+        }
+        #endif
     }
 
     return leakCount;
 }
 
+size_t MemoryManager::getTopCallsites(CallsiteStats* out, size_t maxCount) const {
+    if (!out || maxCount == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (const auto& site : m_callsites) {
+        if (site.liveBytes == 0) {
+            continue;
+        }
+
+        // Insertion into a small sorted array (maxCount is tiny)
+        size_t pos = count < maxCount ? count++ : maxCount;
+        while (pos > 0 && out[pos - 1].liveBytes < site.liveBytes) {
+            if (pos < maxCount) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < maxCount) {
+            out[pos] = site;
+        }
+    }
+
+    return count;
+}
+
 void MemoryManager::printStats() {
     ESP_LOGI(TAG, "=== Memory Statistics ===");
     ESP_LOGI(TAG, "Total allocated: %d bytes", m_totalAllocated);
     ESP_LOGI(TAG, "Peak allocated: %d bytes", m_peakAllocated);
-    ESP_LOGI(TAG, "Active allocations: %d", m_activeBlocks.size());
+    ESP_LOGI(TAG, "Active allocations: %d (index capacity %d)", m_activeCount, m_blockTable.size());
     ESP_LOGI(TAG, "Total allocations: %d", m_allocationCount);
     ESP_LOGI(TAG, "Total deallocations: %d", m_deallocationCount);
     ESP_LOGI(TAG, "Free heap: %d bytes", getFreeHeap());
     ESP_LOGI(TAG, "Largest free block: %d bytes", getLargestFreeBlock());
+    ESP_LOGI(TAG, "App heap: %d/%d bytes (peak %d)", m_appHeapUsed, OS_APP_HEAP_SIZE, m_appHeapPeak);
 
     ESP_LOGI(TAG, "=== Pool Statistics ===");
     for (size_t i = 0; i < m_pools.size(); i++) {
         auto& pool = m_pools[i];
-        ESP_LOGI(TAG, "Pool %d: %d/%d blocks free (%d bytes each)", 
-                i, pool->getFreeBlocks(), pool->getTotalBlocks(), pool->getBlockSize());
+        ESP_LOGI(TAG, "Pool %d: %d/%d blocks free (%d bytes each, %s)", 
+                i, pool->getFreeBlocks(), pool->getTotalBlocks(), pool->getBlockSize(),
+                (pool->getCaps() & MALLOC_CAP_SPIRAM) ? "PSRAM" : "internal");
+    }
+
+    ESP_LOGI(TAG, "=== Tier Statistics ===");
+    static const char* const tierNames[MEMORY_TIER_COUNT] = {"auto", "internal", "psram", "dma"};
+    for (size_t i = 1; i < MEMORY_TIER_COUNT; i++) {
+        const TierStats& t = m_tierStats[i];
+        ESP_LOGI(TAG, "%s: live=%d bytes peak=%d bytes allocs=%d failures=%d fallbacks=%d",
+                tierNames[i], t.liveBytes, t.peakBytes, t.allocations, t.failures, t.fallbacks);
+    }
+    ESP_LOGI(TAG, "Free internal: %d bytes, PSRAM: %d bytes, DMA: %d bytes",
+            heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+            heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+            heap_caps_get_free_size(MALLOC_CAP_DMA));
+
+    ESP_LOGI(TAG, "=== Top Call Sites (%d tracked) ===", m_callsites.size() - 1);
+    CallsiteStats top[TOP_CALLSITES_REPORTED];
+    size_t count = getTopCallsites(top, TOP_CALLSITES_REPORTED);
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "%s:%d live=%d bytes/%d blocks peak=%d bytes rate=%d/s",
+                top[i].file ? top[i].file : "unknown", top[i].line,
+                top[i].liveBytes, top[i].liveCount, top[i].peakBytes, top[i].allocRate);
     }
 }
 
@@ -255,6 +503,18 @@ void MemoryManager::garbageCollect() {
     checkLeaks();
 }
 
+void MemoryManager::lock() const {
+    if (m_mutex) {
+        xSemaphoreTakeRecursive(m_mutex, portMAX_DELAY);
+    }
+}
+
+void MemoryManager::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGiveRecursive(m_mutex);
+    }
+}
+
 size_t MemoryManager::getFreeHeap() const {
     return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
 }
@@ -263,9 +523,125 @@ size_t MemoryManager::getLargestFreeBlock() const {
     return heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
 }
 
-std::vector<MemoryBlock>::iterator MemoryManager::findBlock(void* ptr) {
-    return std::find_if(m_activeBlocks.begin(), m_activeBlocks.end(),
-                       [ptr](const MemoryBlock& block) {
-                           return block.ptr == ptr;
-                       });
-}
\ No newline at end of file
+size_t MemoryManager::findBlock(const void* ptr) const {
+    if (m_blockTable.empty()) {
+        return SIZE_MAX;
+    }
+
+    size_t slot = hashPointer(ptr) & m_blockMask;
+    while (m_blockTable[slot].ptr) {
+        if (m_blockTable[slot].ptr == ptr) {
+            return slot;
+        }
+        slot = (slot + 1) & m_blockMask;
+    }
+
+    return SIZE_MAX;
+}
+
+bool MemoryManager::insertBlock(const MemoryBlock& block) {
+    // Keep load factor below 3/4 so probe sequences stay short
+    if ((m_activeCount + 1) * 4 > m_blockTable.size() * 3) {
+        if (!rehash(m_blockTable.size() * 2)) {
+            return false;
+        }
+    }
+
+    size_t slot = hashPointer(block.ptr) & m_blockMask;
+    while (m_blockTable[slot].ptr) {
+        slot = (slot + 1) & m_blockMask;
+    }
+
+    m_blockTable[slot] = block;
+    m_activeCount++;
+    return true;
+}
+
+void MemoryManager::eraseBlock(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & m_blockMask;
+
+    while (m_blockTable[next].ptr) {
+        size_t home = hashPointer(m_blockTable[next].ptr) & m_blockMask;
+        // Move the entry back if the hole lies cyclically between its home and its slot
+        if (((next - home) & m_blockMask) >= ((next - hole) & m_blockMask)) {
+            m_blockTable[hole] = m_blockTable[next];
+            hole = next;
+        }
+        next = (next + 1) & m_blockMask;
+    }
+
+    m_blockTable[hole].ptr = nullptr;
+    m_activeCount--;
+}
+
+bool MemoryManager::rehash(size_t newCapacity) {
+    std::vector<MemoryBlock> oldTable;
+    try {
+        oldTable.resize(newCapacity);
+    } catch (...) {
+        ESP_LOGE(TAG, "Failed to grow allocation index to %u slots", (unsigned)newCapacity);
+        return false;
+    }
+    // The index now holds empty slots; oldTable holds the entries to reinsert
+    oldTable.swap(m_blockTable);
+
+    for (auto& block : m_blockTable) {
+        block.ptr = nullptr;
+    }
+    m_blockMask = newCapacity - 1;
+    m_activeCount = 0;
+
+    for (const auto& block : oldTable) {
+        if (block.ptr) {
+            size_t slot = hashPointer(block.ptr) & m_blockMask;
+            while (m_blockTable[slot].ptr) {
+                slot = (slot + 1) & m_blockMask;
+            }
+            m_blockTable[slot] = block;
+            m_activeCount++;
+        }
+    }
+
+    return true;
+}
+
+uint16_t MemoryManager::lookupCallsite(const char* file, int line) {
+    if (!file || m_callsiteSlots.empty()) {
+        return 0;
+    }
+
+    size_t mask = m_callsiteSlots.size() - 1;
+    size_t slot = (hashPointer(file) ^ (static_cast<size_t>(line) * 0x85EBCA6Bu)) & mask;
+
+    while (m_callsiteSlots[slot] != 0) {
+        const CallsiteStats& site = m_callsites[m_callsiteSlots[slot]];
+        if (site.file == file && site.line == line) {
+            return m_callsiteSlots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (m_callsites.size() >= CALLSITE_TABLE_SIZE) {
+        return 0; // Table full, aggregate into the overflow entry
+    }
+
+    uint16_t index = static_cast<uint16_t>(m_callsites.size());
+    m_callsites.push_back(CallsiteStats{file, line, 0, 0, 0, 0, 0, 0});
+    m_callsiteSlots[slot] = index;
+    return index;
+}
+
+void MemoryManager::updateStats() {
+    uint32_t now = millis();
+    uint32_t elapsed = now - m_rateWindowStart;
+
+    if (elapsed >= 1000) { // Roll the allocation-rate window every second
+        for (auto& site : m_callsites) {
+            site.allocRate = (site.windowAllocs * 1000) / elapsed;
+            site.windowAllocs = 0;
+        }
+        m_rateWindowStart = now;
+    }
+}
@@ -2,6 +2,9 @@
 #define MEMORY_MANAGER_H
 
 #include "os_config.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <vector>
 #include <memory>
 
@@ -10,9 +13,33 @@
  * @brief Memory management system for M5Stack Tab5
  * 
  * Provides memory allocation, tracking, and pool management
- * with debugging and leak detection capabilities.
+ * with debugging and leak detection capabilities. Allocation and release
+ * may come from any task (boot stages and workers run in parallel).
  */
 
+/**
+ * @brief Placement hint for an allocation
+ */
+enum class MemoryTier : uint8_t {
+    AUTO,           // Route by size: pools, then internal SRAM, then PSRAM
+    HOT_INTERNAL,   // Latency-sensitive data in internal SRAM
+    BULK_PSRAM,     // Large buffers in PSRAM
+    DMA_ALIGNED     // DMA-capable, cache-line aligned (display, camera, UART)
+};
+
+static constexpr size_t MEMORY_TIER_COUNT = 4;
+
+/**
+ * @brief Per-tier allocation statistics
+ */
+struct TierStats {
+    size_t liveBytes;
+    size_t peakBytes;
+    uint32_t allocations;
+    uint32_t failures;
+    uint32_t fallbacks;  // Requests placed outside their requested tier
+};
+
 struct MemoryBlock {
     void* ptr;
     size_t size;
@@ -20,25 +47,70 @@ struct MemoryBlock {
     const char* file;
     int line;
     bool inUse;
+    MemoryTier tier;    // Tier the block was actually placed in
+    uint16_t callsite;  // Index into the call-site table
 };
 
+/**
+ * @brief Aggregated allocation statistics for one file:line call site
+ */
+struct CallsiteStats {
+    const char* file;
+    int line;
+    size_t liveBytes;
+    size_t peakBytes;
+    uint32_t liveCount;
+    uint32_t totalAllocs;
+    uint32_t windowAllocs;  // Allocations in the current rate window
+    uint32_t allocRate;     // Allocations per second over the last window
+};
+
+/**
+ * @brief Fixed-size block pool with constant-time allocate/deallocate
+ *
+ * Free blocks are chained through their first word (intrusive free list),
+ * so allocate() and deallocate() never scan. A one-bit-per-block usage
+ * bitmap is kept alongside to reject double frees in O(1).
+ */
 class MemoryPool {
 public:
-    MemoryPool(size_t blockSize, size_t blockCount);
+    /**
+     * @brief Create a pool
+     * @param blockSize Size of each block in bytes (rounded up to pointer size)
+     * @param blockCount Number of blocks in the pool
+     * @param caps heap_caps capability flags for the backing region
+     *             (e.g. MALLOC_CAP_INTERNAL for hot pools, MALLOC_CAP_SPIRAM for bulk)
+     */
+    MemoryPool(size_t blockSize, size_t blockCount, uint32_t caps = MALLOC_CAP_DEFAULT);
     ~MemoryPool();
 
     void* allocate();
     bool deallocate(void* ptr);
+
+    /**
+     * @brief Check whether a pointer lies inside this pool's region
+     * @param ptr Pointer to check
+     * @return true if the pointer belongs to this pool
+     */
+    bool owns(const void* ptr) const;
+
     size_t getBlockSize() const { return m_blockSize; }
     size_t getFreeBlocks() const { return m_freeBlocks; }
     size_t getTotalBlocks() const { return m_totalBlocks; }
+    uint32_t getCaps() const { return m_caps; }
 
 private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
     size_t m_blockSize;
     size_t m_totalBlocks;
     size_t m_freeBlocks;
-    void* m_memory;
-    std::vector<bool> m_blockUsed;
+    uint32_t m_caps;
+    void* m_memory = nullptr;
+    FreeNode* m_freeList = nullptr;
+    std::vector<uint32_t> m_usedBitmap;
 };
 
 class MemoryManager {
@@ -61,6 +133,23 @@ public:
      */
     void* allocate(size_t size, const char* file = nullptr, int line = 0);
 
+    /**
+     * @brief Allocate memory with a placement hint
+     * @param size Size in bytes to allocate
+     * @param tier Memory tier to place the allocation in
+     * @param file Source file for debugging (use __FILE__)
+     * @param line Source line for debugging (use __LINE__)
+     * @return Pointer to allocated memory or nullptr on failure
+     */
+    void* allocate(size_t size, MemoryTier tier, const char* file = nullptr, int line = 0);
+
+    /**
+     * @brief Get statistics for a memory tier
+     * @param tier Tier to query
+     * @return Tier statistics
+     */
+    const TierStats& getTierStats(MemoryTier tier) const { return m_tierStats[(size_t)tier]; }
+
     /**
      * @brief Deallocate tracked memory
      * @param ptr Pointer to memory to deallocate
@@ -99,7 +188,34 @@ public:
      * @brief Get number of active allocations
      * @return Number of active allocations
      */
-    size_t getActiveAllocations() const { return m_activeBlocks.size(); }
+    size_t getActiveAllocations() const { return m_activeCount; }
+
+    /**
+     * @brief Get the call sites with the most live bytes
+     * @param out Destination array
+     * @param maxCount Capacity of the destination array
+     * @return Number of entries written, sorted by live bytes (largest first)
+     */
+    size_t getTopCallsites(CallsiteStats* out, size_t maxCount) const;
+
+    /**
+     * @brief Reserve bytes from the application heap budget
+     * @param size Bytes to reserve
+     * @return true if the reservation fits within OS_APP_HEAP_SIZE
+     */
+    bool reserveAppHeap(size_t size);
+
+    /**
+     * @brief Return bytes to the application heap budget
+     * @param size Bytes previously reserved with reserveAppHeap()
+     */
+    void releaseAppHeap(size_t size);
+
+    /**
+     * @brief Get bytes currently reserved from the application heap
+     * @return Reserved app heap bytes
+     */
+    size_t getAppHeapUsed() const { return m_appHeapUsed; }
 
     /**
      * @brief Check for memory leaks
@@ -130,37 +246,119 @@ public:
     size_t getLargestFreeBlock() const;
 
 private:
+    void* allocateLocked(size_t size, MemoryTier tier, const char* file, int line);
+    bool deallocateLocked(void* ptr);
+    void lock() const;
+    void unlock() const;
+
+    /**
+     * @brief Allocate raw memory for a tier, applying fallbacks
+     * @param size Size in bytes
+     * @param tier Requested tier (AUTO is resolved by size)
+     * @param placed Receives the tier the memory was placed in
+     * @return Pointer to memory or nullptr on failure
+     */
+    void* allocateFromTier(size_t size, MemoryTier tier, MemoryTier& placed);
+
+    /**
+     * @brief Allocate from the first pool that fits and matches caps
+     * @param size Size in bytes
+     * @param requiredCaps Capability bits the pool must have (0 = any)
+     * @param placed Receives the tier implied by the pool's caps
+     * @return Pointer to block or nullptr if no pool fits
+     */
+    void* allocateFromPools(size_t size, uint32_t requiredCaps, MemoryTier& placed);
+
+    /**
+     * @brief Return raw memory to the pool that owns it, or to the heap
+     * @param ptr Pointer from allocateFromTier()
+     */
+    void releaseMemory(void* ptr);
+
     /**
-     * @brief Find memory block by pointer
+     * @brief Find the table slot holding a pointer
      * @param ptr Pointer to find
-     * @return Iterator to block or end() if not found
+     * @return Slot index or SIZE_MAX if not tracked
+     */
+    size_t findBlock(const void* ptr) const;
+
+    /**
+     * @brief Insert a block into the pointer index, growing it if needed
+     * @param block Block to track
+     * @return true on success, false if the index could not grow
+     */
+    bool insertBlock(const MemoryBlock& block);
+
+    /**
+     * @brief Remove the block at a slot (backward-shift deletion)
+     * @param slot Slot index returned by findBlock()
+     */
+    void eraseBlock(size_t slot);
+
+    /**
+     * @brief Rebuild the pointer index with a new capacity
+     * @param newCapacity New capacity (power of two)
+     * @return true on success, false on allocation failure
      */
-    std::vector<MemoryBlock>::iterator findBlock(void* ptr);
+    bool rehash(size_t newCapacity);
 
     /**
-     * @brief Update memory statistics
+     * @brief Find or create the call-site entry for file:line
+     * @return Call-site index (entry 0 collects overflow and unknown sites)
+     */
+    uint16_t lookupCallsite(const char* file, int line);
+
+    /**
+     * @brief Update memory statistics (allocation rate windows)
      */
     void updateStats();
 
-    // Memory tracking
-    std::vector<MemoryBlock> m_activeBlocks;
+    static size_t hashPointer(const void* ptr) {
+        return (static_cast<size_t>(reinterpret_cast<uintptr_t>(ptr)) >> 3) * 0x9E3779B1u;
+    }
+
+    // Open-addressing pointer -> block index (linear probing, ptr == nullptr is empty)
+    std::vector<MemoryBlock> m_blockTable;
+    size_t m_blockMask = 0;
+    size_t m_activeCount = 0;
     size_t m_totalAllocated = 0;
     size_t m_peakAllocated = 0;
     uint32_t m_allocationCount = 0;
     uint32_t m_deallocationCount = 0;
 
+    // Per-call-site aggregation (open addressing on file pointer + line)
+    static constexpr size_t CALLSITE_TABLE_SIZE = 256;
+    static constexpr size_t TOP_CALLSITES_REPORTED = 8;
+    std::vector<CallsiteStats> m_callsites;
+    std::vector<uint16_t> m_callsiteSlots;  // Hash slot -> index into m_callsites (0 = empty)
+    uint32_t m_rateWindowStart = 0;
+
+    // Per-tier statistics, indexed by MemoryTier
+    TierStats m_tierStats[MEMORY_TIER_COUNT] = {};
+
+    // Application heap budget shared by per-app arenas
+    size_t m_appHeapUsed = 0;
+    size_t m_appHeapPeak = 0;
+
     // Memory pools for common sizes
     std::vector<std::unique_ptr<MemoryPool>> m_pools;
+    SemaphoreHandle_t m_mutex = nullptr;     // Recursive: pools and the index allocate through here
     bool m_initialized = false;
 };
 
 // Memory allocation macros for debugging
 #ifdef OS_DEBUG_ENABLED
 #define OS_MALLOC(size) OS().getMemoryManager().allocate(size, __FILE__, __LINE__)
+#define OS_MALLOC_TIER(size, tier) OS().getMemoryManager().allocate(size, tier, __FILE__, __LINE__)
 #define OS_FREE(ptr) OS().getMemoryManager().deallocate(ptr)
 #else
 #define OS_MALLOC(size) OS().getMemoryManager().allocate(size)
+#define OS_MALLOC_TIER(size, tier) OS().getMemoryManager().allocate(size, tier)
 #define OS_FREE(ptr) OS().getMemoryManager().deallocate(ptr)
 #endif
 
+#define OS_MALLOC_HOT(size)   OS_MALLOC_TIER(size, MemoryTier::HOT_INTERNAL)
+#define OS_MALLOC_PSRAM(size) OS_MALLOC_TIER(size, MemoryTier::BULK_PSRAM)
+#define OS_MALLOC_DMA(size)   OS_MALLOC_TIER(size, MemoryTier::DMA_ALIGNED)
+
 #endif // MEMORY_MANAGER_H
\ No newline at end of file
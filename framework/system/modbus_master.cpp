@@ -0,0 +1,458 @@
+#include "modbus_master.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "ModbusMaster";
+
+static constexpr uint8_t EXCEPTION_FLAG = 0x80;
+static constexpr size_t MIN_RESPONSE_BYTES = 5;     // Exception: id, fn, code, CRC
+static constexpr uint16_t MAX_READ_REGISTERS = 125;
+static constexpr uint16_t MAX_READ_BITS = 2000;
+static constexpr uint32_t FIXED_T35_US = 1750;      // Spec value above 19200 baud
+static constexpr uint8_t MAX_RX_TIMEOUT_SYMBOLS = 100;
+
+struct CrcTable {
+    uint16_t values[256];
+
+    constexpr CrcTable() : values() {
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = (uint16_t)i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+
+static constexpr CrcTable s_crcTable;
+
+static bool isBitRead(ModbusFunction function) {
+    return function == ModbusFunction::READ_COILS ||
+           function == ModbusFunction::READ_DISCRETE_INPUTS;
+}
+
+static TickType_t usToTicks(int64_t us) {
+    const int64_t tickUs = (int64_t)portTICK_PERIOD_MS * 1000;
+    return (TickType_t)std::max<int64_t>((us + tickUs - 1) / tickUs, 1);
+}
+
+ModbusMaster::ModbusMaster() : m_mutex(xSemaphoreCreateMutex()) {
+}
+
+ModbusMaster::~ModbusMaster() {
+    end();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t ModbusMaster::begin(uart_port_t port, uint32_t baudRate, uint8_t bitsPerChar, int dePin) {
+    if (m_active) {
+        return OS_OK;
+    }
+    if (!m_mutex || baudRate == 0 || bitsPerChar == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // DE follows RTS, which half-duplex mode releases after the last stop bit
+    esp_err_t ret = uart_set_pin(port, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                                 dePin, UART_PIN_NO_CHANGE);
+    if (ret == ESP_OK) {
+        ret = uart_set_mode(port, UART_MODE_RS485_HALF_DUPLEX);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to take over UART %d: %s", port, esp_err_to_name(ret));
+        return OS_ERROR_HARDWARE;
+    }
+
+    m_port = port;
+    m_active = true;
+    setLineTiming(baudRate, bitsPerChar);
+
+    m_pendingId = 0;
+    m_frameLength = 0;
+    m_frameCorrupt = false;
+    uart_flush_input(m_port);
+
+    int64_t now = esp_timer_get_time();
+    lock();
+    for (PollEntry& entry : m_polls) {
+        entry.nextDueUs = now;
+    }
+    unlock();
+    m_windowStartUs = now;
+    m_windowCount = 0;
+
+    ESP_LOGI(TAG, "Polling on UART %d: %u baud, t3.5 %u us, %d polls",
+             port, baudRate, m_t35Us, getPollCount());
+    return OS_OK;
+}
+
+void ModbusMaster::end() {
+    m_active = false;
+    m_pendingId = 0;
+    m_rate = 0;
+}
+
+void ModbusMaster::setLineTiming(uint32_t baudRate, uint8_t bitsPerChar) {
+    if (baudRate == 0 || bitsPerChar == 0) {
+        return;
+    }
+
+    m_charUs = (uint32_t)((uint64_t)bitsPerChar * 1000000 / baudRate);
+    m_t35Us = baudRate > 19200 ? FIXED_T35_US : (m_charUs * 7 + 1) / 2;
+
+    // RX timeout counts whole characters; round up so t1.5 gaps never split a frame
+    uint32_t symbols = (m_t35Us + m_charUs - 1) / std::max<uint32_t>(m_charUs, 1);
+    symbols = std::min<uint32_t>(std::max<uint32_t>(symbols, 4), MAX_RX_TIMEOUT_SYMBOLS);
+    if (m_active) {
+        uart_set_rx_timeout(m_port, (uint8_t)symbols);
+    }
+}
+
+uint32_t ModbusMaster::addPoll(const ModbusPoll& poll) {
+    uint16_t maxCount = isBitRead(poll.function) ? MAX_READ_BITS : MAX_READ_REGISTERS;
+    if (poll.slaveId == BROADCAST_ID || poll.slaveId > MAX_SLAVE_ID ||
+        poll.count == 0 || poll.count > maxCount ||
+        (uint32_t)poll.address + poll.count > 0x10000) {
+        return 0;
+    }
+
+    PollEntry entry;
+    entry.poll = poll;
+    entry.request[0] = poll.slaveId;
+    entry.request[1] = (uint8_t)poll.function;
+    entry.request[2] = (uint8_t)(poll.address >> 8);
+    entry.request[3] = (uint8_t)poll.address;
+    entry.request[4] = (uint8_t)(poll.count >> 8);
+    entry.request[5] = (uint8_t)poll.count;
+    uint16_t crc = crc16(entry.request, 6);
+    entry.request[6] = (uint8_t)crc;
+    entry.request[7] = (uint8_t)(crc >> 8);
+    entry.nextDueUs = esp_timer_get_time();
+    entry.sequence = 0;
+    entry.exception = 0;
+    entry.valueCount = 0;
+    entry.values.assign(isBitRead(poll.function) ? (poll.count + 15) / 16 : poll.count, 0);
+
+    lock();
+    if (m_polls.size() >= OS_MODBUS_MAX_POLLS) {
+        unlock();
+        return 0;
+    }
+    entry.id = m_nextPollId++;
+    slaveStats(poll.slaveId);
+    m_polls.push_back(std::move(entry));
+    uint32_t id = m_polls.back().id;
+    unlock();
+    return id;
+}
+
+bool ModbusMaster::removePoll(uint32_t pollId) {
+    lock();
+    int index = findPoll(pollId);
+    if (index >= 0) {
+        m_polls.erase(m_polls.begin() + index);
+    }
+    unlock();
+    return index >= 0;
+}
+
+void ModbusMaster::clearPolls() {
+    lock();
+    m_polls.clear();
+    unlock();
+}
+
+size_t ModbusMaster::getPollCount() const {
+    lock();
+    size_t count = m_polls.size();
+    unlock();
+    return count;
+}
+
+bool ModbusMaster::getResult(size_t index, ModbusResult& result) const {
+    lock();
+    if (index >= m_polls.size()) {
+        unlock();
+        return false;
+    }
+
+    const PollEntry& entry = m_polls[index];
+    result.pollId = entry.id;
+    result.poll = entry.poll;
+    result.sequence = entry.sequence;
+    result.exception = entry.exception;
+    result.valueCount = std::min(entry.valueCount, ModbusResult::MAX_VALUES);
+    memcpy(result.values, entry.values.data(), result.valueCount * sizeof(uint16_t));
+    unlock();
+    return true;
+}
+
+void ModbusMaster::onData(size_t length, bool frameEnd) {
+    if (!m_active) {
+        return;
+    }
+
+    size_t buffered = 0;
+    uart_get_buffered_data_len(m_port, &buffered);
+    length = std::max(length, buffered);
+
+    while (length > 0) {
+        size_t space = MAX_ADU - m_frameLength;
+        if (space == 0) {
+            // Longer than any legal ADU; drain it and reject the frame
+            uint8_t discard[32];
+            int bytesRead = uart_read_bytes(m_port, discard, std::min(length, sizeof(discard)), 0);
+            if (bytesRead <= 0) {
+                break;
+            }
+            length -= bytesRead;
+            m_frameCorrupt = true;
+            continue;
+        }
+
+        int bytesRead = uart_read_bytes(m_port, m_frame + m_frameLength, std::min(length, space), 0);
+        if (bytesRead <= 0) {
+            break;
+        }
+        m_frameLength += bytesRead;
+        length -= bytesRead;
+    }
+
+    // FIFO-threshold events only carry part of a frame; t3.5 ends it
+    if (frameEnd) {
+        completeFrame();
+    }
+}
+
+void ModbusMaster::onLineError() {
+    m_frameCorrupt = true;
+}
+
+TickType_t ModbusMaster::service() {
+    if (!m_active) {
+        return portMAX_DELAY;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now - m_windowStartUs >= (int64_t)OS_MODBUS_RATE_WINDOW_MS * 1000) {
+        m_rate = (uint32_t)((uint64_t)m_windowCount * 1000000 / (now - m_windowStartUs));
+        m_windowCount = 0;
+        m_windowStartUs = now;
+    }
+
+    if (m_pendingId) {
+        if (now < m_deadlineUs) {
+            return usToTicks(m_deadlineUs - now);
+        }
+        lock();
+        slaveStats(m_pendingSlave).timeouts++;
+        unlock();
+        m_pendingId = 0;
+    }
+
+    // Earliest-due poll; overdue polls go out back to back
+    uint8_t request[sizeof(PollEntry::request)];
+    uint32_t pollId = 0;
+    TickType_t wait = portMAX_DELAY;
+
+    lock();
+    PollEntry* next = nullptr;
+    for (PollEntry& entry : m_polls) {
+        if (!next || entry.nextDueUs < next->nextDueUs) {
+            next = &entry;
+        }
+    }
+    if (next && next->nextDueUs <= now) {
+        memcpy(request, next->request, sizeof(request));
+        pollId = next->id;
+        m_pendingSlave = next->poll.slaveId;
+        slaveStats(m_pendingSlave).requests++;
+
+        // Keep the cadence, but never queue up a backlog after a stall
+        next->nextDueUs += (int64_t)next->poll.intervalMs * 1000;
+        if (next->nextDueUs < now) {
+            next->nextDueUs = now + (int64_t)next->poll.intervalMs * 1000;
+        }
+    } else if (next) {
+        wait = usToTicks(next->nextDueUs - now);
+    }
+    unlock();
+
+    if (pollId) {
+        transmit(pollId, request, sizeof(request));
+        wait = usToTicks(m_deadlineUs - esp_timer_get_time());
+    }
+    return wait;
+}
+
+uint16_t ModbusMaster::crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ s_crcTable.values[(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+void ModbusMaster::printStats(const char* tag) const {
+    lock();
+    ESP_LOGI(tag, "Modbus: %u transactions, %u/s, %d polls, %u stray frames, t3.5 %u us",
+             m_transactions, m_rate, m_polls.size(), m_strayFrames, m_t35Us);
+    for (const ModbusSlaveStats& stats : m_slaves) {
+        ESP_LOGI(tag, "  Slave %u: %u req, %u ok, %u timeout, %u crc, %u exception",
+                 stats.slaveId, stats.requests, stats.responses, stats.timeouts,
+                 stats.crcErrors, stats.exceptions);
+        if (stats.latency.samples() > 0) {
+            ESP_LOGI(tag, "    latency avg %u us, min %u us, p95 <%u us, max %u us",
+                     stats.latency.averageUs(), stats.latency.minUs(),
+                     stats.latency.percentileUs(95), stats.latency.maxUs());
+        }
+    }
+    unlock();
+}
+
+void ModbusMaster::resetStats() {
+    lock();
+    for (ModbusSlaveStats& stats : m_slaves) {
+        uint8_t slaveId = stats.slaveId;
+        stats = ModbusSlaveStats();
+        stats.slaveId = slaveId;
+    }
+    m_transactions = 0;
+    m_strayFrames = 0;
+    unlock();
+}
+
+void ModbusMaster::transmit(uint32_t pollId, const uint8_t* request, size_t length) {
+    // Anything still on the line belongs to an expired transaction
+    uart_flush_input(m_port);
+    m_frameLength = 0;
+    m_frameCorrupt = false;
+
+    uart_write_bytes(m_port, request, length);
+    uart_wait_tx_done(m_port, usToTicks((int64_t)m_charUs * length) + 1);
+
+    // Drop our own echo when the receiver is not gated by DE
+    uart_flush_input(m_port);
+    m_frameLength = 0;
+
+    m_sentUs = esp_timer_get_time();
+    m_deadlineUs = m_sentUs + (int64_t)OS_MODBUS_RESPONSE_TIMEOUT_MS * 1000;
+    m_pendingId = pollId;
+}
+
+void ModbusMaster::completeFrame() {
+    size_t length = m_frameLength;
+    bool corrupt = m_frameCorrupt;
+    m_frameLength = 0;
+    m_frameCorrupt = false;
+
+    // Echo tail or an empty idle event
+    if (length == 0) {
+        return;
+    }
+
+    if (!m_pendingId) {
+        m_strayFrames++;
+        return;
+    }
+
+    bool valid = !corrupt && length >= MIN_RESPONSE_BYTES &&
+                 crc16(m_frame, length - 2) == (uint16_t)(m_frame[length - 2] | (m_frame[length - 1] << 8));
+    if (valid && m_frame[0] != m_pendingSlave) {
+        // Another master or a late reply; keep waiting for ours
+        m_strayFrames++;
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    lock();
+    ModbusSlaveStats& stats = slaveStats(m_pendingSlave);
+    int index = findPoll(m_pendingId);
+    if (!valid) {
+        stats.crcErrors++;
+    } else if (index < 0 || parseResponse(m_polls[index], length, stats)) {
+        // A poll removed mid-transaction still counts as answered
+        stats.responses++;
+        stats.latency.add((uint32_t)(now - m_sentUs));
+        m_transactions++;
+        m_windowCount++;
+    } else {
+        stats.crcErrors++;
+    }
+    unlock();
+
+    // The line has been idle for t3.5 already, so the next request may go now
+    m_pendingId = 0;
+}
+
+bool ModbusMaster::parseResponse(PollEntry& entry, size_t length, ModbusSlaveStats& stats) {
+    uint8_t function = (uint8_t)entry.poll.function;
+    if (m_frame[1] == (function | EXCEPTION_FLAG)) {
+        entry.exception = m_frame[2];
+        entry.sequence++;
+        stats.exceptions++;
+        return true;
+    }
+
+    bool bits = isBitRead(entry.poll.function);
+    size_t byteCount = bits ? (entry.poll.count + 7) / 8 : entry.poll.count * 2;
+    if (m_frame[1] != function || m_frame[2] != byteCount || length != byteCount + 5) {
+        return false;
+    }
+
+    const uint8_t* payload = m_frame + 3;
+    if (bits) {
+        // Bits arrive LSB first per byte; two bytes per stored word
+        std::fill(entry.values.begin(), entry.values.end(), 0);
+        for (size_t i = 0; i < byteCount; i++) {
+            entry.values[i / 2] |= (uint16_t)(payload[i] << ((i & 1) * 8));
+        }
+    } else {
+        for (size_t i = 0; i < entry.poll.count; i++) {
+            entry.values[i] = (uint16_t)((payload[i * 2] << 8) | payload[i * 2 + 1]);
+        }
+    }
+
+    entry.valueCount = entry.values.size();
+    entry.exception = 0;
+    entry.sequence++;
+    return true;
+}
+
+int ModbusMaster::findPoll(uint32_t pollId) const {
+    for (size_t i = 0; i < m_polls.size(); i++) {
+        if (m_polls[i].id == pollId) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+ModbusSlaveStats& ModbusMaster::slaveStats(uint8_t slaveId) {
+    for (ModbusSlaveStats& stats : m_slaves) {
+        if (stats.slaveId == slaveId) {
+            return stats;
+        }
+    }
+    m_slaves.emplace_back();
+    m_slaves.back().slaveId = slaveId;
+    return m_slaves.back();
+}
+
+void ModbusMaster::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void ModbusMaster::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
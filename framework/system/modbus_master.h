@@ -0,0 +1,232 @@
+#ifndef MODBUS_MASTER_H
+#define MODBUS_MASTER_H
+
+#include "os_config.h"
+#include "latency_histogram.h"
+#include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+
+/**
+ * @file modbus_master.h
+ * @brief Modbus RTU master polling engine for a half-duplex UART
+ *
+ * Frame boundaries come from the UART's own RX idle timeout, set to the
+ * t3.5 silence of the current baud rate: the driver raises UART_DATA with
+ * timeout_flag once the line has been quiet that long, so the response is
+ * complete without any software timer. The driving transceiver enable is
+ * routed to the UART RTS output, which RS-485 half-duplex mode drops right
+ * after the last stop bit.
+ *
+ * Requests are built once, CRC included, when a poll is added. The poll
+ * list is served earliest-due first and the next request goes out as soon
+ * as the previous response ends, so a busy list runs back to back.
+ *
+ * onData(), onLineError() and service() belong to the task that owns the
+ * UART event queue; the poll list and results may be used from any task.
+ */
+
+enum class ModbusFunction : uint8_t {
+    READ_COILS = 0x01,
+    READ_DISCRETE_INPUTS = 0x02,
+    READ_HOLDING_REGISTERS = 0x03,
+    READ_INPUT_REGISTERS = 0x04
+};
+
+struct ModbusPoll {
+    uint8_t slaveId = 1;
+    ModbusFunction function = ModbusFunction::READ_HOLDING_REGISTERS;
+    uint16_t address = 0;
+    uint16_t count = 1;         // Registers, or bits for coil/input reads
+    uint32_t intervalMs = 1000;
+};
+
+struct ModbusResult {
+    static constexpr size_t MAX_VALUES = 125;
+
+    uint32_t pollId = 0;
+    ModbusPoll poll;
+    uint32_t sequence = 0;      // Bumped by every response, 0 before the first
+    uint8_t exception = 0;      // Exception code of the last response, 0 if none
+    size_t valueCount = 0;
+    uint16_t values[MAX_VALUES];  // Registers, or bits packed LSB first
+};
+
+struct ModbusSlaveStats {
+    uint8_t slaveId = 0;
+    uint32_t requests = 0;
+    uint32_t responses = 0;
+    uint32_t timeouts = 0;
+    uint32_t crcErrors = 0;     // Bad CRC, short or malformed frames
+    uint32_t exceptions = 0;
+    LatencyHistogram latency;   // End of request to end of response
+};
+
+class ModbusMaster {
+public:
+    static constexpr size_t MAX_ADU = 256;
+    static constexpr uint8_t BROADCAST_ID = 0;
+    static constexpr uint8_t MAX_SLAVE_ID = 247;
+
+    ModbusMaster();
+    ~ModbusMaster();
+
+    ModbusMaster(const ModbusMaster&) = delete;
+    ModbusMaster& operator=(const ModbusMaster&) = delete;
+
+    /**
+     * @brief Take over an installed RS-485 half-duplex UART
+     * @param port UART port with its driver installed
+     * @param baudRate Line rate
+     * @param bitsPerChar Start + data + parity + stop bits
+     * @param dePin Transceiver driver enable, routed to the UART RTS output
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t begin(uart_port_t port, uint32_t baudRate, uint8_t bitsPerChar, int dePin);
+
+    /**
+     * @brief Stop polling; the caller restores the UART and DE pin
+     */
+    void end();
+
+    /**
+     * @brief Check if the engine owns the bus
+     * @return true between begin() and end()
+     */
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief Recompute t3.5 and the RX timeout after a line change
+     * @param baudRate Line rate
+     * @param bitsPerChar Start + data + parity + stop bits
+     */
+    void setLineTiming(uint32_t baudRate, uint8_t bitsPerChar);
+
+    /**
+     * @brief Add a request to the poll list
+     * @param poll Request and interval
+     * @return Poll ID or 0 on failure
+     */
+    uint32_t addPoll(const ModbusPoll& poll);
+
+    /**
+     * @brief Remove a request from the poll list
+     * @param pollId Poll ID
+     * @return true if the poll was found
+     */
+    bool removePoll(uint32_t pollId);
+
+    /**
+     * @brief Remove all polls
+     */
+    void clearPolls();
+
+    /**
+     * @brief Get the number of polls
+     * @return Poll count
+     */
+    size_t getPollCount() const;
+
+    /**
+     * @brief Copy the latest result of a poll
+     * @param index Poll index (0 to getPollCount() - 1)
+     * @param result Output
+     * @return true if the index exists
+     */
+    bool getResult(size_t index, ModbusResult& result) const;
+
+    /**
+     * @brief Read bytes announced by a UART_DATA event (UART task)
+     * @param length Bytes announced
+     * @param frameEnd Event was raised by the RX idle timeout (t3.5)
+     */
+    void onData(size_t length, bool frameEnd);
+
+    /**
+     * @brief Mark the frame being received as corrupt (UART task)
+     */
+    void onLineError();
+
+    /**
+     * @brief Expire a timed-out request and send the next due one (UART task)
+     * @return Ticks until service() has work again
+     */
+    TickType_t service();
+
+    /**
+     * @brief Modbus CRC16 (poly 0xA001, init 0xFFFF), table driven
+     * @param data Bytes to check
+     * @param length Byte count
+     * @return CRC; transmitted low byte first
+     */
+    static uint16_t crc16(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get completed transactions over the last rate window
+     * @return Transactions per second
+     */
+    uint32_t getTransactionsPerSecond() const { return m_rate; }
+
+    /**
+     * @brief Print totals and per-slave statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+    /**
+     * @brief Reset statistics
+     */
+    void resetStats();
+
+private:
+    struct PollEntry {
+        uint32_t id;
+        ModbusPoll poll;
+        uint8_t request[8];
+        int64_t nextDueUs;
+        uint32_t sequence;
+        uint8_t exception;
+        size_t valueCount;
+        std::vector<uint16_t> values;
+    };
+
+    void transmit(uint32_t pollId, const uint8_t* request, size_t length);
+    void completeFrame();
+    bool parseResponse(PollEntry& entry, size_t length, ModbusSlaveStats& stats);
+    int findPoll(uint32_t pollId) const;
+    ModbusSlaveStats& slaveStats(uint8_t slaveId);
+    void lock() const;
+    void unlock() const;
+
+    uart_port_t m_port = UART_NUM_0;
+    volatile bool m_active = false;
+    SemaphoreHandle_t m_mutex = nullptr;
+
+    // Poll list (guarded by m_mutex)
+    std::vector<PollEntry> m_polls;
+    std::vector<ModbusSlaveStats> m_slaves;
+    uint32_t m_nextPollId = 1;
+
+    // Transaction in flight (UART task only)
+    uint32_t m_pendingId = 0;
+    uint8_t m_pendingSlave = 0;
+    int64_t m_sentUs = 0;
+    int64_t m_deadlineUs = 0;
+    uint8_t m_frame[MAX_ADU];
+    size_t m_frameLength = 0;
+    bool m_frameCorrupt = false;
+
+    // Line timing
+    uint32_t m_t35Us = 0;
+    uint32_t m_charUs = 0;
+
+    // Statistics
+    uint32_t m_transactions = 0;
+    uint32_t m_strayFrames = 0;
+    uint32_t m_rate = 0;
+    uint32_t m_windowCount = 0;
+    int64_t m_windowStartUs = 0;
+};
+
+#endif // MODBUS_MASTER_H
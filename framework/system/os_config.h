@@ -24,12 +24,33 @@
 #define OS_SYSTEM_HEAP_SIZE     (2 * 1024 * 1024)   // 2MB for system
 #define OS_APP_HEAP_SIZE        (4 * 1024 * 1024)   // 4MB for apps
 #define OS_BUFFER_POOL_SIZE     (1 * 1024 * 1024)   // 1MB for buffers
+#define OS_APP_CPU_LIMIT        50      // Percent of one core a background app may use
+#define OS_APP_HIBERNATE_IDLE_MS 120000 // Background apps untouched this long are hibernated
+#define OS_HIBERNATE_PSRAM_BUDGET (2 * 1024 * 1024) // Snapshots held in PSRAM; the rest go to flash
+#define OS_HIBERNATE_DIR        OS_STORAGE_MOUNT_POINT "/.hibernate"
+#define OS_APP_WARM_POOL        2       // Prelaunched apps kept initialised but not started
+#define OS_APP_PRELAUNCH_DELAY_MS 5000  // Quiet time after boot and launches before prelaunching
+#define OS_APP_PREPARE_TASK_STACK 8192
+#define OS_APP_PREPARE_TASK_PRIORITY 2  // Below storage, like the thumbnail worker
+#define OS_APP_PREPARE_TASK_CORE 1
+#define OS_APP_INSTALL_DIR      OS_STORAGE_MOUNT_POINT "/apps"
+#define OS_APP_PACKAGE_DIR      OS_STORAGE_MOUNT_POINT "/packages"  // Downloaded .app files
+#define OS_APP_INSTALL_CHUNK_SIZE (16 * 1024)   // Package bytes read per step while installing
+#define OS_APP_MANIFEST_MAX     4096    // Largest package manifest
+#define OS_APP_PACKAGE_PATH_MAX 128     // Longest path inside a package
+#define OS_APP_SIGNATURE_MAX    512
+#define OS_APP_REQUIRE_SIGNATURE 0      // Reject unsigned packages
+#define OS_APP_SIGNING_KEY      ""      // PEM public key for package signatures; empty skips the check
 
 // PSRAM Configuration
 #define OS_PSRAM_HEAP_SIZE      (16 * 1024 * 1024)  // 16MB PSRAM heap
 #define OS_DISPLAY_BUFFER_SIZE  (4 * 1024 * 1024)   // 4MB for display buffers
 #define OS_GRAPHICS_CACHE_SIZE  (2 * 1024 * 1024)   // 2MB graphics cache
 
+// Allocation Tier Routing
+#define OS_MEM_PSRAM_THRESHOLD  4096    // Untiered allocations above this go to PSRAM
+#define OS_MEM_DMA_ALIGNMENT    64      // Cache-line alignment for DMA buffers
+
 // Task Configuration - Increased for better multitasking
 #define OS_MAX_TASKS            32
 #define OS_TASK_PRIORITY_HIGH   3
@@ -37,31 +58,294 @@
 #define OS_TASK_PRIORITY_LOW    1
 #define OS_TASK_PRIORITY_IDLE   0
 
+// Worker Pool Configuration (background jobs off the main loop)
+#define OS_WORKER_COUNT         2       // One worker pinned per HP core
+#define OS_WORKER_STACK_SIZE    8192
+#define OS_WORKER_PRIORITY      4       // FreeRTOS priority, below UART/network tasks
+#define OS_WORKER_QUEUE_DEPTH   32      // Max pending jobs per worker
+
 // Event System Configuration - Increased for HD display
 #define OS_MAX_EVENT_LISTENERS  64
 #define OS_EVENT_QUEUE_SIZE     128
+#define OS_EVENT_CRITICAL_QUEUE_SIZE  32    // System/app lifecycle lane
+#define OS_EVENT_TELEMETRY_QUEUE_SIZE 32    // High-rate input/sensor lane
+#define OS_EVENT_COALESCE_SLOTS 16      // Event types with a coalescing policy
+#define OS_EVENT_TIME_BUDGET_US 2000    // Event dispatch budget per frame
+#define OS_EVENT_INLINE_PAYLOAD 32      // Payload bytes carried inside EventData
+#define OS_EVENT_PAYLOAD_BLOCK  256     // Pooled payload slot size (incl. header)
+#define OS_EVENT_PAYLOAD_BLOCKS 16      // Pooled payload slots for larger async payloads
 
 // Touch Configuration
 #define OS_TOUCH_THRESHOLD      10
 #define OS_TOUCH_DEBOUNCE_MS    50
 #define OS_GESTURE_TIMEOUT_MS   500
+#define OS_GESTURE_TAP_MS       200     // Longest press that still counts as a tap
+#define OS_GESTURE_DOUBLE_TAP_MS 300    // Max gap between the taps of a double tap
+#define OS_GESTURE_LONG_PRESS_MS 600    // Stationary hold before LONG_PRESS fires
+#define OS_GESTURE_SLOP_PX      16      // Travel before a touch stops being a tap
+#define OS_GESTURE_SWIPE_PX     48      // Travel along the dominant axis for a swipe
+#define OS_GESTURE_PINCH_PX     24      // Two-finger span change for a pinch
+#define OS_GESTURE_ROTATE_DEG   12      // Two-finger turn for a rotate
+#define OS_TOUCH_RING_SIZE      16      // GT911 reports buffered between main-loop drains
+#define OS_TOUCH_TASK_STACK     3072
+#define OS_TOUCH_TASK_PRIORITY  6       // FreeRTOS priority, above workers and the main loop
+#define OS_TOUCH_TASK_CORE      0
+#define OS_TOUCH_FILTER_MIN_CUTOFF 1.0f // One-Euro cutoff at rest (Hz)
+#define OS_TOUCH_FILTER_BETA    0.007f  // Cutoff gain per px/s of speed
+#define OS_TOUCH_FILTER_D_CUTOFF 1.0f   // Speed estimate cutoff (Hz)
+#define OS_INPUT_LATENCY_TIMEOUT_MS 250 // Touch samples with no frame by then are dropped
 
 // File System Configuration - Enhanced for media files
 #define OS_MAX_FILES_OPEN       16
 #define OS_MAX_FILENAME_LEN     256
 #define OS_STORAGE_MOUNT_POINT  "/storage"
 #define OS_LARGE_FILE_BUFFER    (512 * 1024)  // 512KB for large file operations
+#define OS_STORAGE_ASYNC_DEPTH  16      // Queued async read/write requests
+#define OS_STORAGE_TASK_STACK   4096
+#define OS_STORAGE_TASK_PRIORITY 5      // FreeRTOS priority, mostly blocked on the card
+#define OS_STORAGE_TASK_CORE    1
+#define OS_STORAGE_CACHE_BLOCKS 8       // Per-path append blocks (write-back)
+#define OS_STORAGE_CACHE_BLOCK_SIZE (4 * 1024)
+#define OS_STORAGE_CACHE_FLUSH_MS 2000  // Longest a dirty append block waits
+#define OS_STORAGE_STREAM_BUFFERS 4     // Large stdio buffers lent to open handles
+#define OS_STORAGE_STREAM_BUFFER_SIZE (32 * 1024)
+#define OS_STORAGE_DIR_CACHE_DIRS 4     // Directory listings kept by the enumerator
+#define OS_STORAGE_DIR_PAGE_SIZE 64     // Entries per page when listing a whole directory
+#define OS_STORAGE_COPY_CHUNK_SIZE (64 * 1024)  // Each of the two pipelined copy buffers
+#define OS_STORAGE_COPY_QUEUE_DEPTH 8   // Copy jobs waiting behind the running one
+#define OS_STORAGE_COPY_TASK_STACK 4096
+#define OS_STORAGE_COPY_TASK_PRIORITY 4 // Below the async queue so app I/O stays responsive
+#define OS_STORAGE_COPY_TASK_CORE 1
+#define OS_STORAGE_COPY_PROGRESS_MS 100 // Progress callback rate
+#define OS_FILE_OP_QUEUE_DEPTH 8        // Tree operations waiting behind the running one
+#define OS_FILE_OP_TASK_STACK 8192      // Walks recurse once per directory level
+#define OS_FILE_OP_TASK_PRIORITY 3      // Below the copy engine it feeds
+#define OS_FILE_OP_TASK_CORE 1
+#define OS_FILE_OP_MAX_DEPTH 16         // Deeper trees are refused rather than overflow the stack
+#define OS_FILE_OP_PROGRESS_MS 250      // EVENT_HAL_FILE_OP_PROGRESS rate
+#define OS_FILE_OP_PAUSE_POLL_MS 50     // How often a paused operation checks to resume
+#define OS_ASSET_PARTITION      "assets" // Data partition holding the packed assets/ directory
+#define OS_ASSET_DRIVE_LETTER   'A'     // LVGL drive letter for packed assets
+
+// Power-Aware Main Loop
+#define OS_TICKLESS_ENABLED     1       // Block between deadlines instead of spinning
+#define OS_TICKLESS_MAX_SLEEP_MS 100    // Cap so app and service updates still run
+#define OS_TOUCH_POLL_MS        10      // Touch poll interval while a finger is down
+
+// CPU Frequency Governor
+#define OS_DVFS_ENABLED         1       // Scale the CPU clock with load (needs CONFIG_PM_ENABLE)
+#define OS_DVFS_MAX_MHZ         360     // Fastest step; steps are max, max/2, max/4, min
+#define OS_DVFS_MIN_MHZ         40      // Slowest step and the clock with no lock held
+#define OS_DVFS_LIGHT_SLEEP     0       // Let esp_pm enter light sleep in idle (display stays on)
+#define OS_DVFS_UP_LOAD         80      // Load (%) that steps the clock up
+#define OS_DVFS_PANIC_LOAD      95      // Load (%) that jumps to the fastest step
+#define OS_DVFS_DOWN_LOAD       30      // Load (%) that steps down once held for DOWN_HOLD_MS
+#define OS_DVFS_DOWN_HOLD_MS    3000
+#define OS_DVFS_MIN_HEADROOM    20      // Frame budget left (%) below which the clock steps up
+#define OS_DVFS_BOOST_HOLD_MS   500     // Stay at the fastest step after touch or animation
+
+// Frame Profiler
+#define OS_PROFILER_ENABLED     1       // Scoped stage timers in OSManager::update()
+#define OS_PROFILER_WINDOW      128     // Rolling samples per stage/app
+#define OS_PROFILER_FRAME_BUDGET_US 16000 // Frame budget assumed by TaskScheduler
+#define OS_PROFILER_OVERLAY_REFRESH_MS 500
+
+// Timeline Tracing (trace_recorder.h)
+#define OS_TRACE_ENABLED        1       // 0 compiles the OS_TRACE_* macros out
+#define OS_TRACE_EVENTS_PER_CORE 8192   // Ring size per core, power of two (24 bytes each, PSRAM)
+#ifndef OS_TRACE_CONSOLE
+#define OS_TRACE_CONSOLE        1       // "trace ..." commands on the USB serial console
+#endif
+
+// Display Pipeline
+#define OS_DISPLAY_FULL_FRAME   0       // 1 = render into two PSRAM framebuffers swapped on vsync
+#define OS_DISPLAY_DIRTY_RECTS  16      // Dirty rectangles tracked per frame before merging
+#define OS_DISPLAY_PPA_ENABLED  1       // Offload large fills/blends/zooms to the PPA
+#define OS_DISPLAY_PPA_MIN_PIXELS 4096  // Smaller areas stay on the CPU (DMA setup cost)
 
 // UI Configuration
 #define OS_UI_REFRESH_RATE      30  // FPS
 #define OS_UI_ANIMATION_TIME    200 // ms
 #define OS_STATUS_BAR_HEIGHT    40
 #define OS_DOCK_HEIGHT          60
+// Cached screens are charged their build's change in MALLOC_CAP_DEFAULT heap
+// use (LVGL mallocs directly with LV_MEM_CUSTOM=1); sized for the 5-screen
+// limit at ~16K each (60-80 widgets with styles and allocator headers), an
+// estimate to check against the sizes ScreenManager::printStats() reports
+#define OS_UI_SCREEN_CACHE_BYTES (80 * 1024)
+#define OS_UI_SCREEN_PREBUILD_IDLE_MS 500   // Input idle time before prebuilding a screen
+
+// Frame Pacing
+#define OS_UI_INTERACTIVE_FPS   60  // Panel rate while animating or touched
+#define OS_UI_STATIC_FPS        4   // Rate once nothing has changed for a while
+#define OS_UI_STATIC_DELAY_MS   1000 // Quiet time before dropping to the static rate
+#define OS_UI_INTERACTION_HOLD_MS 300 // Keep panel rate after release (scroll throw)
+#define OS_UI_LOW_BATTERY_FPS   30
+#define OS_UI_CRITICAL_BATTERY_FPS 10
+
+// Terminal Scrollback
+#define OS_TERM_SCROLLBACK_LINES 4000   // Rows kept per terminal view
+#define OS_TERM_SCROLLBACK_BYTES (256 * 1024) // PSRAM text pool per terminal view
+#define OS_TERM_MAX_ROW_BYTES   256     // Longest row rendered into a label
+#define OS_TERM_DEFAULT_COLUMNS 96      // Wrap width until the view knows its size
+
+// Virtual Lists
+#define OS_VLIST_MARGIN_ROWS    4       // Rows bound beyond each edge of the viewport
+#define OS_VLIST_FLING_DECAY_MS 325     // Fling speed falls to 1/e in this long
+#define OS_VLIST_FLING_MIN_SPEED 30.0f  // px/s below which a fling stops
+#define OS_VLIST_FLING_HOLD_MS  80      // Finger still this long before release: no fling
+#define OS_VLIST_TAP_SLOP       8       // Drag in px that still counts as a tap
+#define OS_FILE_LIST_ROW_HEIGHT 32
+#define OS_FILE_LIST_PAGE_SIZE  48      // Entries read per StorageHAL page
+#define OS_FILE_LIST_PREFETCH   16      // Load the next page this many rows before the end
+
+// VT100 Emulation
+#define OS_VT_COLUMNS           80      // Emulated screen; hosts assume 80x24
+#define OS_VT_ROWS              24
+#define OS_VT_MAX_PARAMS        16      // CSI parameters kept per sequence
+
+// Modbus RTU Master
+#define OS_MODBUS_MAX_POLLS     32      // Scheduled requests in the poll list
+#define OS_MODBUS_RESPONSE_TIMEOUT_MS 200 // From end of request to end of response
+#define OS_MODBUS_RATE_WINDOW_MS 1000   // Window for the transactions/sec figure
+
+// Serial Capture
+#define OS_CAPTURE_DIR          "/sdcard/captures"
+#define OS_CAPTURE_BLOCK_SIZE   (16 * 1024)     // Record bytes per log block
+#define OS_CAPTURE_BLOCKS       8       // PSRAM blocks queued between the UART task and the card
+#define OS_CAPTURE_FLUSH_MS     1000    // Longest a partly filled block waits for more data
+#define OS_CAPTURE_SYNC_BLOCKS  32      // fsync() after this many blocks
+#define OS_CAPTURE_TASK_STACK   4096
+#define OS_CAPTURE_TASK_PRIORITY 3      // Below the UART tasks; only drains full blocks
+#define OS_CAPTURE_TASK_CORE    1
+
+// Camera Preview
+#define OS_CAMERA_MAX_FRAME_WIDTH  1600 // Largest sensor frame the JPEG decode buffer holds (UXGA)
+#define OS_CAMERA_MAX_FRAME_HEIGHT 1200
+#define OS_CAMERA_JPEG_TIMEOUT_MS  50   // Hardware decode of one frame
+#define OS_CAMERA_TASK_STACK    4096
+#define OS_CAMERA_TASK_PRIORITY 4       // Below touch and storage; blocks on the sensor
+#define OS_CAMERA_TASK_CORE     1
+#define OS_CAMERA_FB_COUNT      3       // Driver buffers: one filling, one for preview, one for analysis
+
+// Camera Frame Graph
+#define OS_FRAME_GRAPH_MAX_STAGES 8
+#define OS_FRAME_GRAPH_MAX_FRAMES 1     // Frames analysis may hold (below OS_CAMERA_FB_COUNT - 1)
+#define OS_FRAME_GRAPH_REMOVE_TIMEOUT_MS 500
+
+// Video Recording
+#define OS_VIDEO_SLOTS          8       // PSRAM frame slots between the camera task and the writer
+#define OS_VIDEO_SLOT_SIZE      (384 * 1024) // Largest JPEG frame recorded, plus its chunk header
+#define OS_VIDEO_MAX_FRAMES     54000   // Index entries kept (30 min at 30 FPS)
+#define OS_VIDEO_MAX_FILE_BYTES (1000ULL * 1024 * 1024) // Below the AVI 1.0 RIFF limit
+#define OS_VIDEO_SYNC_FRAMES    60      // fsync() after this many frames
+#define OS_VIDEO_TASK_STACK     4096
+#define OS_VIDEO_TASK_PRIORITY  3
+#define OS_VIDEO_TASK_CORE      0       // Opposite core from the camera task
+
+// Voice Capture
+#define OS_AUDIO_SAMPLE_RATE    16000   // Speech bandwidth; what STT backends expect
+#define OS_AUDIO_FRAME_SAMPLES  320     // 20 ms per I2S DMA frame and VAD step
+#define OS_AUDIO_DMA_DESC       6       // DMA frames the driver buffers (120 ms of slack)
+#define OS_VOICE_RING_BYTES     (256 * 1024) // PSRAM speech ring, power of two (8 s)
+#define OS_VOICE_PREROLL_MS     300     // Kept from before onset so the first word is whole
+#define OS_VOICE_ONSET_MS       60      // Above threshold this long to count as speech
+#define OS_VOICE_HANGOVER_MS    240     // Pause kept inside an utterance; longer pauses are trimmed
+#define OS_VOICE_ENDPOINT_MS    800     // Silence that ends the utterance
+#define OS_VOICE_NO_SPEECH_MS   6000    // Give up if nobody starts talking
+#define OS_VOICE_MAX_UTTERANCE_MS 15000
+#define OS_VOICE_TASK_STACK     4096
+#define OS_VOICE_TASK_PRIORITY  6       // Above the camera; must keep up with I2S DMA
+#define OS_VOICE_TASK_CORE      1
+
+// Assistant API Session
+#define OS_API_BASE_URL         "https://api.openai.com"
+#define OS_HTTPS_TIMEOUT_MS     15000   // Socket timeout for uploads and replies
+#define OS_HTTPS_LOCK_TIMEOUT_MS 20000  // Wait for another request to finish with the session
+#define OS_HTTPS_IDLE_CLOSE_MS  50000   // Reconnect rather than trust a socket idle this long
+#define OS_HTTPS_BUFFER_SIZE    2048    // esp_http_client receive buffer
+
+// Speech Upload
+#define OS_STT_PATH             "/v1/audio/transcriptions"
+#define OS_STT_MODEL            "whisper-1"
+#define OS_STT_CHUNK_BYTES      4096    // Speech per HTTP chunk (128 ms at 16 kHz)
+#define OS_STT_MAX_RESPONSE     4096
+#define OS_STT_TASK_STACK       8192    // TLS handshake needs the room
+#define OS_STT_TASK_PRIORITY    3
+#define OS_STT_TASK_CORE        0       // With the network stack, opposite the capture task
+
+// Chat Streaming
+#define OS_LLM_PATH             "/v1/chat/completions"
+#define OS_LLM_MODEL            "gpt-4o-mini"
+#define OS_LLM_HISTORY_MESSAGES 10      // Earlier turns sent with each request
+#define OS_LLM_MAX_LINE         2048    // Longest server-sent event line kept
+#define OS_LLM_TASK_STACK       8192
+#define OS_LLM_TASK_PRIORITY    3
+#define OS_LLM_TASK_CORE        0
+
+// Keyword Spotting
+#define OS_KWS_MODEL_PATH       "/sdcard/models/wakeword.kws"
+#define OS_KWS_FFT_SIZE         512     // 32 ms analysis window over 20 ms hops
+#define OS_KWS_MEL_BANDS        40
+#define OS_KWS_MAX_FRAMES       64      // Feature window limit; the model sets its own length
+#define OS_KWS_MAX_COEFFS       16
+#define OS_KWS_MAX_LAYERS       4
+#define OS_KWS_GATE_RMS         150     // Frame RMS that counts as sound worth analysing
+#define OS_KWS_INFERENCE_HOP    3       // Frames between inferences while the gate is open
+#define OS_KWS_SMOOTHING        3       // Inferences averaged before the threshold test
+#define OS_KWS_STATS_MS         30000   // Log CPU share and latency this often
+#define OS_KWS_TASK_STACK       6144
+#define OS_KWS_TASK_PRIORITY    5
+#define OS_KWS_TASK_CORE        0       // Second core; the UI loop runs on core 1
+
+// Contacts
+#define OS_CONTACTS_PATH        "/sdcard/contacts.db"
+#define OS_CONTACTS_SAVE_DELAY_MS 2000  // Edits are batched into one rewrite of the file
+#define OS_CONTACTS_IO_BUFFER   8192    // stdio buffer for loading and saving
+#define OS_CONTACT_ROW_HEIGHT   40
+
+// Tasks
+#define OS_TASKS_PATH           "/sdcard/tasks.log"
+#define OS_TASKS_COMPACT_SLACK  64      // Superseded log records allowed before the log is rewritten
+#define OS_TASK_ROW_HEIGHT      40
+
+// Spreadsheet
+#define OS_SHEET_MAX_ROWS       9999    // Rows 1..9999
+#define OS_SHEET_MAX_COLS       702     // Columns A..ZZ
+#define OS_SHEET_TILE_SHIFT     4       // Cells are stored in 16x16 tiles
+#define OS_EXPR_MAX_STACK       32      // Value stack of a compiled expression
+#define OS_EXPR_MAX_NESTING     8       // Function calls inside function calls
+
+// Thumbnails
+#define OS_THUMB_WIDTH          40      // Fits the file list icon column
+#define OS_THUMB_HEIGHT         30
+#define OS_THUMB_CACHE_ENTRIES  64      // Decoded thumbnails kept in PSRAM (150 KB)
+#define OS_THUMB_QUEUE_DEPTH    32      // Pending loads; the oldest are dropped first
+#define OS_THUMB_PACK_PATH      "/sdcard/.thumbs.pack"
+#define OS_THUMB_PACK_MAX_SIZE  (16 * 1024 * 1024) // Started afresh beyond this (about 6000 records)
+#define OS_THUMB_MAX_PATH       255     // Longest source path a record holds
+#define OS_THUMB_EXIF_SCAN_BYTES (64 * 1024) // Header read looking for an embedded thumbnail
+#define OS_THUMB_MAX_JPEG_SIZE  (4 * 1024 * 1024) // Larger files only get an embedded thumbnail
+#define OS_THUMB_MAX_DECODE_PIXELS (2592 * 1944) // Largest picture decoded whole (5 MP)
+#define OS_THUMB_JPEG_TIMEOUT_MS 200
+#define OS_THUMB_TASK_STACK     4096
+#define OS_THUMB_TASK_PRIORITY  2       // Below storage and the file operations
+#define OS_THUMB_TASK_CORE      1
 
 // System Timing
 #define OS_WATCHDOG_TIMEOUT_MS  30000
 #define OS_IDLE_TIMEOUT_MS      300000  // 5 minutes
 #define OS_SLEEP_CHECK_MS       1000
+#define OS_LIGHT_SLEEP_MAX_MS   60000   // Longest light sleep without a wakeup request
+#define OS_DEEP_SLEEP_MAX_MS    (5 * 60 * 1000) // Longest deep sleep without a wakeup request
+
+// Benchmark Configuration (bench/, pio run -e benchmark)
+#define OS_BENCHMARK_FILE_SIZE  (1024 * 1024)   // Sequential storage test file
+#define OS_BENCHMARK_IO_CHUNK   (32 * 1024)     // Sequential read/write size
+#define OS_BENCHMARK_RANDOM_BLOCK 4096          // Random read/write size
+#define OS_BENCHMARK_RANDOM_OPS 256
+#define OS_BENCHMARK_FLUSH_FRAMES 30            // Full-screen flushes timed
+#define OS_BENCHMARK_SHEET_CELLS 10000
 
 // Debug Configuration
 #ifdef DEBUG
@@ -92,7 +376,8 @@ typedef enum {
     OS_ERROR_FILESYSTEM = -9,
     OS_ERROR_PERMISSION = -10,
     OS_ERROR_NOT_AVAILABLE = -11,
-    OS_ERROR_NOT_IMPLEMENTED = -12
+    OS_ERROR_NOT_IMPLEMENTED = -12,
+    OS_ERROR_CANCELLED = -13
 } os_error_t;
 
 // Forward declarations
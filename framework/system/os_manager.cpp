@@ -1,6 +1,8 @@
 #include "os_manager.h"
 #include <esp_log.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <algorithm>
 
 static const char* TAG = "OSManager";
 
@@ -20,6 +22,11 @@ os_error_t OSManager::initialize() {
     // Record start time
     m_startTime = millis();
 
+    // Trace rings first so any subsystem can record once a capture starts
+    if (TraceRecorder::initialize() != OS_OK) {
+        ESP_LOGW(TAG, "Tracing unavailable");
+    }
+
     // Initialize subsystems in order of dependency
     os_error_t result = initializeSubsystems();
     if (result != OS_OK) {
@@ -48,6 +55,10 @@ os_error_t OSManager::start() {
     m_running = true;
     m_lastUpdate = millis();
 
+    // update() is driven from this task; wake() notifies it
+    m_mainTask = xTaskGetCurrentTaskHandle();
+    m_idleWindowStartUs = esp_timer_get_time();
+
     return OS_OK;
 }
 
@@ -69,6 +80,7 @@ os_error_t OSManager::shutdown() {
     if (m_uiManager) {
         m_uiManager->shutdown();
     }
+    m_thumbnails.stop();
     if (m_halManager) {
         m_halManager->shutdown();
     }
@@ -90,112 +102,271 @@ os_error_t OSManager::update() {
     m_lastUpdate = now;
 
     // Update CPU usage statistics
-    if (now - m_lastCPUCheck >= 1000) {
-        updateCPUUsage();
+    bool newSample = now - m_lastCPUCheck >= 1000;
+    if (newSample) {
         m_lastCPUCheck = now;
+
+        int64_t nowUs = esp_timer_get_time();
+        uint64_t windowUs = nowUs - m_idleWindowStartUs;
+        if (windowUs > 0) {
+            uint64_t residency = (m_idleUs * 100) / windowUs;
+            m_idleResidency = residency > 100 ? 100 : (uint8_t)residency;
+        }
+        m_idleUs = 0;
+        m_idleWindowStartUs = nowUs;
+
+        updateCPUUsage();
+        OS_TRACE_COUNTER("cpu_load", m_cpuUsage);
     }
 
     // Feed watchdog
     feedWatchdog();
 
-    // Update subsystems
-    if (m_taskScheduler) {
-        m_taskScheduler->update(deltaTime);
+    TraceRecorder::pollConsole();
+
+    // Update subsystems (the frame timer ends before the tickless sleep)
+    {
+        OS_PROFILE_STAGE(m_profiler, ProfileStage::FRAME);
+        OS_TRACE_SCOPE("frame");
+
+        if (m_taskScheduler) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::SCHEDULER);
+            OS_TRACE_SCOPE("scheduler");
+            m_taskScheduler->update(deltaTime);
+        }
+
+        if (m_eventSystem) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::EVENTS);
+            OS_TRACE_SCOPE("events");
+            m_eventSystem->processEvents();
+        }
+
+        if (m_halManager) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::HAL);
+            OS_TRACE_SCOPE("hal");
+            m_halManager->update(deltaTime);
+        }
+
+        if (m_uiManager) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::UI);
+            OS_TRACE_SCOPE("ui");
+            m_uiManager->update(deltaTime);
+        }
+
+        if (m_appManager) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::APPS);
+            OS_TRACE_SCOPE("apps");
+            m_appManager->update(deltaTime);
+        }
+
+        if (m_serviceManager) {
+            OS_PROFILE_STAGE(m_profiler, ProfileStage::SERVICES);
+            OS_TRACE_SCOPE("services");
+            m_serviceManager->update(deltaTime);
+        }
     }
 
-    if (m_eventSystem) {
-        m_eventSystem->processEvents();
+    updatePerformance(newSample);
+
+    // Sleep until something needs the main loop
+    if (m_tickless) {
+        OS_TRACE_SCOPE("idle");
+        idleUntil(getTimeUntilNextDeadline());
+    }
+
+    return OS_OK;
+}
+
+uint32_t OSManager::getTimeUntilNextDeadline() {
+    if (m_eventSystem && m_eventSystem->getQueuedEventCount() > 0) {
+        return 0;
     }
 
+    uint32_t next = OS_TICKLESS_MAX_SLEEP_MS;
+    if (m_taskScheduler) {
+        next = std::min(next, m_taskScheduler->getTimeUntilNextTask());
+    }
     if (m_halManager) {
-        m_halManager->update(deltaTime);
+        next = std::min(next, m_halManager->getTimeUntilNextDeadline());
     }
 
-    if (m_uiManager) {
-        m_uiManager->update(deltaTime);
+    return next;
+}
+
+void OSManager::wake() {
+    // The loop itself is awake; a self-notification would only make the
+    // next idleUntil() return at once
+    if (m_mainTask && xTaskGetCurrentTaskHandle() != m_mainTask) {
+        xTaskNotifyGive(m_mainTask);
     }
+}
 
-    if (m_appManager) {
-        m_appManager->update(deltaTime);
+void IRAM_ATTR OSManager::wakeFromISR() {
+    if (m_mainTask) {
+        BaseType_t higherPriorityWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(m_mainTask, &higherPriorityWoken);
+        portYIELD_FROM_ISR(higherPriorityWoken);
     }
+}
 
-    if (m_serviceManager) {
-        m_serviceManager->update(deltaTime);
+void OSManager::idleUntil(uint32_t timeoutMs) {
+    if (timeoutMs == 0 || !m_mainTask) {
+        return;
     }
 
-    return OS_OK;
+    // Round up: pdMS_TO_TICKS() truncates sub-tick deadlines to 0, which
+    // would turn the loop into a busy wait until the deadline passes
+    TickType_t ticks = (TickType_t)(((uint64_t)timeoutMs * configTICK_RATE_HZ + 999) / 1000);
+
+    int64_t start = esp_timer_get_time();
+    if (ulTaskNotifyTake(pdTRUE, ticks) > 0) {
+        m_earlyWakes++;
+    }
+    m_idleUs += esp_timer_get_time() - start;
+    m_sleepCount++;
+}
+
+void OSManager::printStats() const {
+    ESP_LOGI(TAG, "=== OS Statistics ===");
+    ESP_LOGI(TAG, "Uptime: %d ms", getUptime());
+    ESP_LOGI(TAG, "CPU usage: %d%%", m_cpuUsage);
+    ESP_LOGI(TAG, "Tickless: %s, idle residency: %d%%", m_tickless ? "on" : "off", m_idleResidency);
+    ESP_LOGI(TAG, "Sleeps: %d, woken early: %d", m_sleepCount, m_earlyWakes);
+    m_cpuMonitor.printStats();
+    m_profiler.printStats();
+    m_boot.printTimeline(TAG);
 }
 
 os_error_t OSManager::initializeSubsystems() {
     ESP_LOGI(TAG, "Initializing subsystems...");
 
     // Memory Manager (first - others depend on it)
-    m_memoryManager = new MemoryManager();
-    if (!m_memoryManager || m_memoryManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Memory Manager");
-        return OS_ERROR_GENERIC;
-    }
+    m_boot.addStage("memory", [this]() {
+        m_memoryManager = new MemoryManager();
+        if (!m_memoryManager || m_memoryManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Memory Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    });
+
+    // Task Scheduler; its workers take the WORKER stages from here on
+    m_boot.addStage("scheduler", [this]() {
+        m_taskScheduler = new TaskScheduler();
+        if (!m_taskScheduler || m_taskScheduler->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Task Scheduler");
+            return OS_ERROR_GENERIC;
+        }
+        m_boot.setWorkerPool(&m_taskScheduler->getWorkerPool());
+        return OS_OK;
+    }, {"memory"});
+
+    // Event System
+    m_boot.addStage("events", [this]() {
+        m_eventSystem = new EventSystem();
+        if (!m_eventSystem || m_eventSystem->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Event System");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"memory"});
 
-    // Task Scheduler
-    m_taskScheduler = new TaskScheduler();
-    if (!m_taskScheduler || m_taskScheduler->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Task Scheduler");
+    // Hardware Abstraction Layer: display, touch, power and storage side by side
+    m_halManager = new HALManager();
+    if (!m_halManager || m_halManager->addBootStages(m_boot, {"scheduler", "events"}) != OS_OK) {
+        ESP_LOGE(TAG, "Failed to set up HAL Manager");
         return OS_ERROR_GENERIC;
     }
 
-    // Event System
-    m_eventSystem = new EventSystem();
-    if (!m_eventSystem || m_eventSystem->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Event System");
-        return OS_ERROR_GENERIC;
+    // UI Manager; needs display, touch and power but not storage
+    m_boot.addStage("ui", [this]() {
+        m_uiManager = new UIManager();
+        if (!m_uiManager || m_uiManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize UI Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"hal"});
+
+    // Put the status bar and dock on the panel before the rest of boot
+    m_boot.addStage("first_frame", [this]() {
+        return m_uiManager->forceRefresh();
+    }, {"ui"});
+
+    // Application Manager
+    m_boot.addStage("apps", [this]() {
+        m_appManager = new AppManager();
+        if (!m_appManager || m_appManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize App Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"first_frame"});
+
+    // Service Manager; services may read their state from storage
+    m_boot.addStage("services", [this]() {
+        m_serviceManager = new ServiceManager();
+        if (!m_serviceManager || m_serviceManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Service Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"apps", "storage"});
+
+    os_error_t result = m_boot.run();
+    m_boot.printTimeline(TAG);
+    if (result != OS_OK) {
+        return result;
     }
 
-    // Hardware Abstraction Layer
-    m_halManager = new HALManager();
-    if (!m_halManager || m_halManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize HAL Manager");
-        return OS_ERROR_GENERIC;
+    ESP_LOGI(TAG, "All subsystems initialized successfully (first frame at %d ms)",
+             m_boot.getFinishedAtUs("first_frame") / 1000);
+    return OS_OK;
+}
+
+void OSManager::updatePerformance(bool newSample) {
+    if (!m_halManager) {
+        return;
     }
 
-    // UI Manager
-    m_uiManager = new UIManager();
-    if (!m_uiManager || m_uiManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize UI Manager");
-        return OS_ERROR_GENERIC;
+    GovernorInputs inputs;
+    inputs.cpuLoad = m_cpuUsage;
+    inputs.newSample = newSample;
+
+    if (m_uiManager) {
+        inputs.interactive = m_uiManager->getPacingLevel() == PacingLevel::INTERACTIVE;
+
+        // Headroom against the frame period the UI is currently paced at
+        ProfileStats frame = m_profiler.getStageStats(ProfileStage::FRAME);
+        uint32_t budgetUs = 1000000 / std::max<uint8_t>(m_uiManager->getTargetFps(), 1);
+        if (frame.samples > 0) {
+            uint32_t used = std::min<uint32_t>(frame.p95Us * 100 / budgetUs, 100);
+            inputs.frameHeadroom = 100 - used;
+        }
     }
 
-    // Application Manager
-    m_appManager = new AppManager();
-    if (!m_appManager || m_appManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize App Manager");
-        return OS_ERROR_GENERIC;
+    BaseApp* app = m_appManager ? m_appManager->getCurrentApp() : nullptr;
+    if (app) {
+        inputs.appPriority = (uint8_t)app->getPriority();
     }
 
-    // Service Manager
-    m_serviceManager = new ServiceManager();
-    if (!m_serviceManager || m_serviceManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Service Manager");
-        return OS_ERROR_GENERIC;
+    // Trace timestamps are cycle counts; hold the clock while recording
+    if (TraceRecorder::isRecording()) {
+        inputs.interactive = true;
     }
 
-    ESP_LOGI(TAG, "All subsystems initialized successfully");
-    return OS_OK;
+    m_halManager->getPower().updatePerformance(inputs);
 }
 
 void OSManager::updateCPUUsage() {
-    // Simple CPU usage calculation based on idle time
-    static uint32_t lastIdleTime = 0;
-    uint32_t currentIdleTime = xTaskGetIdleTaskHandle() ? 
-        uxTaskGetSystemState(NULL, 0, NULL) : 0;
-    
-    if (lastIdleTime > 0) {
-        uint32_t idleDelta = currentIdleTime - lastIdleTime;
-        uint32_t totalDelta = 1000; // 1 second
-        m_cpuUsage = 100 - ((idleDelta * 100) / totalDelta);
-        if (m_cpuUsage > 100) m_cpuUsage = 100;
+    if (!CpuMonitor::isSupported()) {
+        // Without run-time stats the main loop's own busy share is the best estimate
+        m_cpuUsage = 100 - m_idleResidency;
+        return;
     }
-    
-    lastIdleTime = currentIdleTime;
+
+    m_cpuMonitor.sample();
+    m_cpuUsage = m_cpuMonitor.getTotalLoad();
 }
 
 void OSManager::feedWatchdog() {
@@ -5,6 +5,11 @@
 #include "memory_manager.h"
 #include "task_scheduler.h"
 #include "event_system.h"
+#include "frame_profiler.h"
+#include "trace_recorder.h"
+#include "cpu_monitor.h"
+#include "thumbnail_service.h"
+#include "boot_graph.h"
 #include "../hal/hal_manager.h"
 #include "../ui/ui_manager.h"
 #include "../apps/app_manager.h"
@@ -16,6 +21,17 @@
  * 
  * The OSManager is the central coordinator for all system components.
  * It handles initialization, shutdown, and coordination between subsystems.
+ *
+ * In tickless mode each update() ends by blocking on a task notification
+ * until the earliest subsystem deadline (scheduler, LVGL timers, touch
+ * polling, queued events). Producers on other tasks or ISRs call wake()
+ * or wakeFromISR() to cut the sleep short. With CONFIG_PM_ENABLE and
+ * FreeRTOS tickless idle the idle task turns that block into light sleep.
+ *
+ * Subsystems start as a BootGraph: each one names what it needs, the
+ * independent hardware components initialise on both cores, and the UI
+ * renders its first frame while storage is still mounting. The timeline
+ * is logged at the end of initialize() and kept for getBootGraph().
  */
 
 class OSManager {
@@ -82,10 +98,73 @@ public:
 
     /**
      * @brief Get CPU usage percentage
-     * @return CPU usage as percentage (0-100)
+     * @return CPU usage averaged over both cores as percentage (0-100)
      */
     uint8_t getCPUUsage() const { return m_cpuUsage; }
 
+    /**
+     * @brief Get per-task, per-core CPU accounting
+     * @return Reference to the CPU monitor
+     */
+    const CpuMonitor& getCpuMonitor() const { return m_cpuMonitor; }
+
+    /**
+     * @brief Get the shared image thumbnail cache (LVGL thread)
+     * @return Reference to the thumbnail service
+     */
+    ThumbnailService& getThumbnails() { return m_thumbnails; }
+
+    /**
+     * @brief Enable/disable tickless main loop
+     * @param enabled True to sleep between deadlines, false to spin
+     */
+    void setTicklessEnabled(bool enabled) { m_tickless = enabled; }
+
+    /**
+     * @brief Check if tickless main loop is enabled
+     * @return true if enabled, false otherwise
+     */
+    bool isTicklessEnabled() const { return m_tickless; }
+
+    /**
+     * @brief Get time until the earliest subsystem deadline
+     * @return Milliseconds the main loop may sleep (capped at OS_TICKLESS_MAX_SLEEP_MS)
+     */
+    uint32_t getTimeUntilNextDeadline();
+
+    /**
+     * @brief Wake the main loop from another task (no-op on the loop itself)
+     */
+    void wake();
+
+    /**
+     * @brief Wake the main loop from an interrupt handler
+     */
+    void wakeFromISR();
+
+    /**
+     * @brief Get share of time the main loop spent asleep
+     * @return Idle residency as percentage (0-100) over the last second
+     */
+    uint8_t getIdleResidency() const { return m_idleResidency; }
+
+    /**
+     * @brief Print OS main loop statistics
+     */
+    void printStats() const;
+
+    /**
+     * @brief Get the main loop frame profiler
+     * @return Reference to the frame profiler
+     */
+    FrameProfiler& getProfiler() { return m_profiler; }
+
+    /**
+     * @brief Get the boot graph with per-stage timing
+     * @return Reference to the boot graph
+     */
+    const BootGraph& getBootGraph() const { return m_boot; }
+
     // Subsystem accessors
     MemoryManager& getMemoryManager() { return *m_memoryManager; }
     TaskScheduler& getTaskScheduler() { return *m_taskScheduler; }
@@ -112,11 +191,23 @@ private:
      */
     void updateCPUUsage();
 
+    /**
+     * @brief Feed the CPU frequency governor
+     * @param newSample True if CPU usage was refreshed this iteration
+     */
+    void updatePerformance(bool newSample);
+
     /**
      * @brief Handle system watchdog
      */
     void feedWatchdog();
 
+    /**
+     * @brief Block until the next deadline or a wake notification
+     * @param timeoutMs Maximum time to sleep in milliseconds
+     */
+    void idleUntil(uint32_t timeoutMs);
+
     // System state
     bool m_initialized = false;
     bool m_running = false;
@@ -125,6 +216,25 @@ private:
     uint32_t m_lastCPUCheck = 0;
     uint8_t m_cpuUsage = 0;
 
+    // Tickless loop
+    bool m_tickless = OS_TICKLESS_ENABLED;
+    TaskHandle_t m_mainTask = nullptr;
+    uint64_t m_idleUs = 0;
+    uint64_t m_idleWindowStartUs = 0;
+    uint8_t m_idleResidency = 0;
+    uint32_t m_sleepCount = 0;
+    uint32_t m_earlyWakes = 0;
+
+    // Stage timing and CPU accounting
+    FrameProfiler m_profiler;
+    CpuMonitor m_cpuMonitor;
+
+    // Subsystem start-up order and timeline
+    BootGraph m_boot;
+
+    // Shared by the apps that list pictures; started on first use
+    ThumbnailService m_thumbnails;
+
     // Subsystem managers
     MemoryManager* m_memoryManager = nullptr;
     TaskScheduler* m_taskScheduler = nullptr;
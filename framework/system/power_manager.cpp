@@ -66,6 +66,12 @@ os_error_t PowerManager::shutdown() {
     set5VOutput1(false);
     set5VOutput2(false);
 
+    gpio_isr_handler_remove(PMS150G_INT_PIN);
+    if (m_buttonQueue) {
+        vQueueDelete(m_buttonQueue);
+        m_buttonQueue = nullptr;
+    }
+
     m_initialized = false;
     return OS_OK;
 }
@@ -101,8 +107,8 @@ os_error_t PowerManager::enterSleep(PowerState sleepType) {
         case PowerState::LIGHT_SLEEP:
             m_currentState = PowerState::LIGHT_SLEEP;
             
-            // Configure sleep timer
-            esp_sleep_enable_timer_wakeup(60000000); // 60 seconds
+            // Configure sleep timer: 60 seconds, or sooner for a wakeup request
+            OS().getHALManager().getPower().armSleepTimer(OS_LIGHT_SLEEP_MAX_MS * 1000ULL);
             
             // Enter light sleep
             esp_light_sleep_start();
@@ -122,8 +128,8 @@ os_error_t PowerManager::enterSleep(PowerState sleepType) {
             setWiFiEnabled(false);
             setBluetoothEnabled(false);
             
-            // Configure deep sleep timer
-            esp_sleep_enable_timer_wakeup(5 * 60 * 1000000); // 5 minutes
+            // Configure deep sleep timer: 5 minutes, or sooner for a wakeup request
+            OS().getHALManager().getPower().armSleepTimer(OS_DEEP_SLEEP_MAX_MS * 1000ULL);
             
             ESP_LOGI(TAG, "Entering deep sleep");
             esp_deep_sleep_start();
@@ -189,6 +195,8 @@ os_error_t PowerManager::setWiFiEnabled(bool enabled) {
 
     if (ret == ESP_OK) {
         m_wifiEnabled = enabled;
+        uint8_t state = enabled ? 1 : 0;
+        PUBLISH_EVENT(EVENT_HAL_WIFI_CHANGE, &state, sizeof(state));
         return OS_OK;
     } else {
         ESP_LOGE(TAG, "Failed to %s WiFi: %s", enabled ? "enable" : "disable", esp_err_to_name(ret));
@@ -280,6 +288,9 @@ void PowerManager::printPowerStats() const {
     ESP_LOGI(TAG, "  5V Output 2: %s", m_5vOutput2Enabled ? "ON" : "OFF");
     ESP_LOGI(TAG, "  Total Wakeups: %d", m_wakeupCount);
     ESP_LOGI(TAG, "  Last Activity: %d ms ago", millis() - m_lastActivity);
+
+    // Clock steps are chosen by the governor in PowerHAL
+    OS().getHALManager().getPower().getCpuGovernor().printStats();
 }
 
 os_error_t PowerManager::initializeGPIO() {
@@ -335,8 +346,15 @@ os_error_t PowerManager::initializeGPIO() {
         return OS_ERROR_HARDWARE;
     }
 
-    // Add ISR handler for power button
-    ret = gpio_isr_handler_add(PMS150G_INT_PIN, powerButtonISR, this);
+    // Add ISR handler for power button; it only queues edges
+    if (!m_buttonQueue) {
+        m_buttonQueue = xQueueCreate(BUTTON_QUEUE_LENGTH, sizeof(ButtonEdge));
+        if (!m_buttonQueue) {
+            ESP_LOGE(TAG, "Failed to create power button queue");
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+    ret = gpio_isr_handler_add(PMS150G_INT_PIN, powerButtonISR, m_buttonQueue);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to add power button ISR: %s", esp_err_to_name(ret));
         return OS_ERROR_HARDWARE;
@@ -372,38 +390,50 @@ os_error_t PowerManager::configureSleepWakeup() {
 }
 
 void IRAM_ATTR PowerManager::powerButtonISR(void* arg) {
-    PowerManager* pm = static_cast<PowerManager*>(arg);
-    uint32_t now = millis();
-    
-    if (gpio_get_level(PMS150G_INT_PIN) == 0) {
-        // Button pressed
-        pm->m_buttonPressed = true;
-        pm->m_buttonPressTime = now;
-    } else {
-        // Button released
-        if (pm->m_buttonPressed) {
-            uint32_t pressDuration = now - pm->m_buttonPressTime;
+    // Only record the edge; EventData, coalescing and the event ring are not
+    // IRAM-safe, so the main loop classifies and publishes it
+    QueueHandle_t queue = static_cast<QueueHandle_t>(arg);
+    ButtonEdge edge;
+    edge.eventType = gpio_get_level(PMS150G_INT_PIN) == 0 ? EVENT_HAL_BUTTON_PRESS : EVENT_HAL_BUTTON_RELEASE;
+    edge.time = millis();
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xQueueSendFromISR(queue, &edge, &higherPriorityWoken);
+    portYIELD_FROM_ISR(higherPriorityWoken);
+}
+
+void PowerManager::processButtonEvents() {
+    // Edges carry their ISR timestamps, so a late main loop does not skew
+    // the press duration
+    ButtonEdge edge;
+    while (m_buttonQueue && xQueueReceive(m_buttonQueue, &edge, 0) == pdTRUE) {
+        if (edge.eventType == EVENT_HAL_BUTTON_PRESS) {
+            // Button pressed
+            m_buttonPressed = true;
+            m_buttonPressTime = edge.time;
+        } else if (m_buttonPressed) {
+            // Button released
+            uint32_t pressDuration = edge.time - m_buttonPressTime;
             
             if (pressDuration > LONG_PRESS_THRESHOLD) {
-                pm->m_buttonEvent = ButtonEvent::LONG_PRESS;
+                m_buttonEvent = ButtonEvent::LONG_PRESS;
             } else if (pressDuration > DEBOUNCE_TIME) {
                 // Check for double press
-                if (now - pm->m_lastButtonPress < DOUBLE_PRESS_WINDOW) {
-                    pm->m_buttonEvent = ButtonEvent::DOUBLE_PRESS;
+                if (edge.time - m_lastButtonPress < DOUBLE_PRESS_WINDOW) {
+                    m_buttonEvent = ButtonEvent::DOUBLE_PRESS;
                 } else {
-                    pm->m_buttonEvent = ButtonEvent::SHORT_PRESS;
+                    m_buttonEvent = ButtonEvent::SHORT_PRESS;
                 }
-                pm->m_lastButtonPress = now;
+                m_lastButtonPress = edge.time;
             }
             
-            pm->m_buttonPressed = false;
+            m_buttonPressed = false;
+        } else {
+            continue;
         }
-    }
-}
 
-void PowerManager::processButtonEvents() {
-    // This is called from the main loop to handle button events
-    // The actual detection happens in the ISR
+        OS().getEventSystem().publishAsync(EventData(edge.eventType));
+    }
 }
 
 void PowerManager::updateBatteryLevel() {
@@ -5,6 +5,8 @@
 #include "../hal/hardware_config.h"
 #include <esp_sleep.h>
 #include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 // Conditional Bluetooth include
 #ifdef CONFIG_BT_ENABLED
 #include <esp_bt.h>
@@ -186,13 +188,22 @@ private:
      */
     os_error_t configureSleepWakeup();
 
+    /**
+     * @brief Button edge passed from the ISR to processButtonEvents()
+     */
+    struct ButtonEdge {
+        uint32_t eventType;     // EVENT_HAL_BUTTON_PRESS or EVENT_HAL_BUTTON_RELEASE
+        uint32_t time;          // millis() at the edge
+    };
+
     /**
      * @brief Handle power button interrupt
+     * @param arg Button edge queue
      */
     static void IRAM_ATTR powerButtonISR(void* arg);
 
     /**
-     * @brief Process button events
+     * @brief Classify queued button edges and publish their events
      */
     void processButtonEvents();
 
@@ -222,7 +233,8 @@ private:
     bool m_5vOutput2Enabled = false;
 
     // Button handling
-    volatile ButtonEvent m_buttonEvent = ButtonEvent::NONE;
+    QueueHandle_t m_buttonQueue = nullptr;
+    ButtonEvent m_buttonEvent = ButtonEvent::NONE;
     uint32_t m_buttonPressTime = 0;
     uint32_t m_lastButtonPress = 0;
     bool m_buttonPressed = false;
@@ -236,6 +248,7 @@ private:
     static constexpr uint32_t DOUBLE_PRESS_WINDOW = 500;  // ms
     static constexpr uint32_t LONG_PRESS_THRESHOLD = 2000; // ms
     static constexpr uint32_t DEBOUNCE_TIME = 50; // ms
+    static constexpr UBaseType_t BUTTON_QUEUE_LENGTH = 16;
 };
 
 #endif // POWER_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "serial_capture.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+static const char* TAG = "SerialCapture";
+
+static constexpr size_t SLOT_SIZE = sizeof(CaptureBlockHeader) + OS_CAPTURE_BLOCK_SIZE;
+static constexpr size_t MIN_RECORD_SPACE = 16;  // Seal rather than log slivers
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+SerialCapture::~SerialCapture() {
+    stop();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t SerialCapture::start(const char* path, const char* source, uint32_t baudRate) {
+    if (m_active) {
+        return OS_ERROR_BUSY;
+    }
+
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    if (path) {
+        snprintf(m_path, sizeof(m_path), "%s", path);
+    } else {
+        // <dir>/<source>_YYYYMMDD_HHMMSS.t5cap
+        time_t now = time(nullptr);
+        struct tm timeinfo;
+        localtime_r(&now, &timeinfo);
+        char stamp[20];
+        strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &timeinfo);
+        storage.createDirectory(OS_CAPTURE_DIR);
+        snprintf(m_path, sizeof(m_path), "%s/%s_%s.t5cap", OS_CAPTURE_DIR, source ? source : "serial", stamp);
+    }
+    snprintf(m_indexPath, sizeof(m_indexPath), "%s.idx", m_path);
+
+    m_pool = (uint8_t*)OS_MALLOC_PSRAM(SLOT_SIZE * OS_CAPTURE_BLOCKS);
+    m_freeBlocks = xQueueCreate(OS_CAPTURE_BLOCKS, sizeof(uint8_t));
+    m_fullBlocks = xQueueCreate(OS_CAPTURE_BLOCKS, sizeof(uint8_t));
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+    }
+    if (!m_pool || !m_freeBlocks || !m_fullBlocks || !m_mutex) {
+        ESP_LOGE(TAG, "Failed to allocate %d capture blocks", OS_CAPTURE_BLOCKS);
+        releaseResources();
+        return OS_ERROR_NO_MEMORY;
+    }
+    for (uint8_t i = 0; i < OS_CAPTURE_BLOCKS; i++) {
+        xQueueSend(m_freeBlocks, &i, 0);
+    }
+
+    m_handle = storage.openFile(m_path, FileOpenMode::WRITE);
+    if (m_handle == INVALID_FILE_HANDLE) {
+        releaseResources();
+        return OS_ERROR_FILESYSTEM;
+    }
+    storage.deleteFile(m_indexPath);
+
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    CaptureFileHeader header = {};
+    header.magic = CAPTURE_FILE_MAGIC;
+    header.version = CAPTURE_VERSION;
+    header.headerSize = sizeof(CaptureFileHeader);
+    header.blockSize = OS_CAPTURE_BLOCK_SIZE;
+    header.baudRate = baudRate;
+    header.startEpochUs = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    strncpy(header.source, source ? source : "", sizeof(header.source));
+    if (storage.write(m_handle, &header, sizeof(header)) != (int)sizeof(header)) {
+        storage.closeFile(m_handle);
+        m_handle = INVALID_FILE_HANDLE;
+        releaseResources();
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_stats = {};
+    m_stats.fileBytes = sizeof(header);
+    m_startUs = esp_timer_get_time();
+    m_sequence = 0;
+    m_streamBytes = 0;
+    m_lostPending = 0;
+    m_block = NO_BLOCK;
+
+    m_writerRunning = true;
+    if (xTaskCreatePinnedToCore(writerTask, "capture_wr", OS_CAPTURE_TASK_STACK, this,
+                                OS_CAPTURE_TASK_PRIORITY, &m_writerTask,
+                                OS_CAPTURE_TASK_CORE) != pdPASS) {
+        m_writerRunning = false;
+        m_writerTask = nullptr;
+        storage.closeFile(m_handle);
+        m_handle = INVALID_FILE_HANDLE;
+        releaseResources();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_active = true;
+    ESP_LOGI(TAG, "Capturing to %s (%d x %d KB blocks)", m_path,
+             OS_CAPTURE_BLOCKS, OS_CAPTURE_BLOCK_SIZE / 1024);
+    return OS_OK;
+}
+
+os_error_t SerialCapture::stop() {
+    if (!m_active) {
+        return OS_OK;
+    }
+
+    // No new records; the partial block joins the queue the writer drains
+    m_active = false;
+    lock();
+    sealBlock();
+    unlock();
+
+    TaskHandle_t task = m_writerTask;
+    m_writerRunning = false;
+    for (int attempt = 0; attempt < 500 && m_writerTask; attempt++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (m_writerTask) {
+        ESP_LOGW(TAG, "Capture writer did not exit, deleting");
+        vTaskDelete(task);
+        m_writerTask = nullptr;
+    }
+
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    os_error_t result = storage.closeFile(m_handle);
+    m_handle = INVALID_FILE_HANDLE;
+    // The index tail follows from the write-back cache within OS_STORAGE_CACHE_FLUSH_MS
+    if (m_stats.writeErrors > 0) {
+        result = OS_ERROR_FILESYSTEM;
+    }
+
+    m_stats.elapsedMs = (uint32_t)((esp_timer_get_time() - m_startUs) / 1000);
+    ESP_LOGI(TAG, "Capture %s closed: %d blocks, %llu bytes, %d dropped, %d write errors",
+             m_path, m_stats.blocksWritten, m_stats.fileBytes, m_stats.bytesDropped,
+             m_stats.writeErrors);
+    releaseResources();
+    return result;
+}
+
+void SerialCapture::record(bool transmitted, const uint8_t* data, size_t length) {
+    if (!m_active || !data || length == 0) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time() - m_startUs;
+    uint8_t flags = transmitted ? CAPTURE_RECORD_TX : 0;
+
+    lock();
+    if (!m_active) {
+        unlock();   // stop() sealed the last block while we waited
+        return;
+    }
+    if (transmitted) {
+        m_stats.txBytes += length;
+    } else {
+        m_stats.rxBytes += length;
+    }
+
+    size_t offset = 0;
+    while (offset < length) {
+        if (m_block == NO_BLOCK && !openBlock(now)) {
+            // Every block is waiting for the card
+            m_stats.bytesDropped += length - offset;
+            m_lostPending += length - offset;
+            break;
+        }
+
+        size_t space = OS_CAPTURE_BLOCK_SIZE - m_blockUsed;
+        if (space < MAX_RECORD_HEADER + MIN_RECORD_SPACE) {
+            sealBlock();
+            continue;
+        }
+        if (m_lostPending > 0) {
+            appendRecord(CAPTURE_RECORD_DATA_LOST, now, nullptr, m_lostPending);
+            m_lostPending = 0;
+            continue;
+        }
+
+        size_t chunk = std::min(length - offset, space - MAX_RECORD_HEADER);
+        appendRecord(flags, now, data + offset, chunk);
+        offset += chunk;
+    }
+    unlock();
+}
+
+CaptureStats SerialCapture::getStats() const {
+    lock();
+    CaptureStats stats = m_stats;
+    unlock();
+    if (m_active) {
+        stats.elapsedMs = (uint32_t)((esp_timer_get_time() - m_startUs) / 1000);
+    }
+    return stats;
+}
+
+void SerialCapture::formatSummary(char* out, size_t size) const {
+    CaptureStats stats = getStats();
+    uint32_t seconds = stats.elapsedMs / 1000;
+    snprintf(out, size, "%s %02u:%02u:%02u  RX %llu  TX %llu  File %llu KB  Dropped %u  Err %u",
+             m_active ? "CAPTURE" : "STOPPED", seconds / 3600, (seconds / 60) % 60, seconds % 60,
+             stats.rxBytes, stats.txBytes, stats.fileBytes / 1024,
+             stats.bytesDropped, stats.writeErrors);
+}
+
+bool SerialCapture::openBlock(int64_t now) {
+    uint8_t index;
+    if (xQueueReceive(m_freeBlocks, &index, 0) != pdTRUE) {
+        return false;
+    }
+
+    m_block = index;
+    m_blockUsed = 0;
+    m_blockOpenedUs = now;
+    m_lastRecordUs = now;
+
+    CaptureBlockHeader* header = reinterpret_cast<CaptureBlockHeader*>(blockAt(m_block));
+    memset(header, 0, sizeof(*header));
+    header->magic = CAPTURE_BLOCK_MAGIC;
+    header->sequence = m_sequence++;
+    header->firstUs = now;
+    header->streamOffset = m_streamBytes;
+    header->flags = m_lostPending > 0 ? CAPTURE_BLOCK_DATA_LOST : 0;
+    return true;
+}
+
+void SerialCapture::sealBlock() {
+    if (m_block == NO_BLOCK) {
+        return;
+    }
+
+    uint8_t index = (uint8_t)m_block;
+    m_block = NO_BLOCK;
+    CaptureBlockHeader* header = reinterpret_cast<CaptureBlockHeader*>(blockAt(index));
+    if (header->records == 0) {
+        xQueueSend(m_freeBlocks, &index, 0);
+        return;
+    }
+
+    header->length = (uint32_t)m_blockUsed;
+    m_stats.blocksQueued++;
+    xQueueSend(m_fullBlocks, &index, 0);    // Never full: it holds at most every block
+}
+
+void SerialCapture::appendRecord(uint8_t flags, int64_t now, const uint8_t* data, size_t length) {
+    uint8_t* block = blockAt(m_block);
+    uint8_t* out = block + sizeof(CaptureBlockHeader) + m_blockUsed;
+
+    int64_t delta = std::max<int64_t>(now - m_lastRecordUs, 0);
+    m_lastRecordUs += delta;
+
+    size_t used = 0;
+    out[used++] = flags;
+    used += putVarint(out + used, (uint32_t)std::min<int64_t>(delta, UINT32_MAX));
+    used += putVarint(out + used, (uint32_t)length);
+    if (data) {
+        memcpy(out + used, data, length);
+        used += length;
+        m_streamBytes += length;
+    }
+    m_blockUsed += used;
+
+    reinterpret_cast<CaptureBlockHeader*>(block)->records++;
+    m_stats.records++;
+}
+
+uint8_t* SerialCapture::blockAt(int index) const {
+    return m_pool + (size_t)index * SLOT_SIZE;
+}
+
+void SerialCapture::releaseResources() {
+    if (m_pool) {
+        OS_FREE(m_pool);
+        m_pool = nullptr;
+    }
+    if (m_freeBlocks) {
+        vQueueDelete(m_freeBlocks);
+        m_freeBlocks = nullptr;
+    }
+    if (m_fullBlocks) {
+        vQueueDelete(m_fullBlocks);
+        m_fullBlocks = nullptr;
+    }
+    m_block = NO_BLOCK;
+}
+
+void SerialCapture::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void SerialCapture::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
+
+void SerialCapture::writerTask(void* parameter) {
+    SerialCapture* capture = static_cast<SerialCapture*>(parameter);
+    StorageHAL& storage = OS().getHALManager().getStorage();
+    uint32_t sinceSync = 0;
+
+    // Drain the queue even after stop() so the last blocks reach the card
+    while (capture->m_writerRunning || uxQueueMessagesWaiting(capture->m_fullBlocks) > 0) {
+        uint8_t index;
+        if (xQueueReceive(capture->m_fullBlocks, &index, pdMS_TO_TICKS(OS_CAPTURE_FLUSH_MS / 4)) != pdTRUE) {
+            // A quiet line must still reach the card within OS_CAPTURE_FLUSH_MS
+            int64_t now = esp_timer_get_time() - capture->m_startUs;
+            capture->lock();
+            if (capture->m_block != NO_BLOCK &&
+                now - capture->m_blockOpenedUs >= (int64_t)OS_CAPTURE_FLUSH_MS * 1000) {
+                capture->sealBlock();
+            }
+            capture->unlock();
+            continue;
+        }
+
+        uint8_t* block = capture->blockAt(index);
+        const CaptureBlockHeader* header = reinterpret_cast<const CaptureBlockHeader*>(block);
+        size_t size = sizeof(CaptureBlockHeader) + header->length;
+        CaptureIndexEntry entry = {header->firstUs, capture->m_stats.fileBytes};
+
+        bool written = storage.write(capture->m_handle, block, size) == (int)size;
+        if (written) {
+            storage.writeFile(capture->m_indexPath, &entry, sizeof(entry), true);
+            if (++sinceSync >= OS_CAPTURE_SYNC_BLOCKS) {
+                storage.flush(capture->m_handle);
+                sinceSync = 0;
+            }
+        }
+
+        capture->lock();
+        if (written) {
+            capture->m_stats.blocksWritten++;
+            capture->m_stats.fileBytes += size;
+        } else {
+            capture->m_stats.writeErrors++;
+        }
+        capture->m_stats.blocksQueued--;
+        capture->unlock();
+
+        xQueueSend(capture->m_freeBlocks, &index, 0);
+    }
+
+    capture->m_writerTask = nullptr;
+    vTaskDelete(NULL);
+}
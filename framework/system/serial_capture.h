@@ -0,0 +1,185 @@
+#ifndef SERIAL_CAPTURE_H
+#define SERIAL_CAPTURE_H
+
+#include "os_config.h"
+#include "../hal/storage_hal.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/**
+ * @file serial_capture.h
+ * @brief Headless binary capture of serial traffic to storage
+ *
+ * Raw bytes are logged with a timestamp and direction, without formatting
+ * or any LVGL work. Records collect in PSRAM blocks; full blocks (or blocks
+ * older than OS_CAPTURE_FLUSH_MS) are queued to a writer task that streams
+ * them through a StorageHAL handle, so the UART task never waits on the
+ * card. When every block is queued, bytes are dropped and the next block
+ * carries a DATA_LOST record with the count.
+ *
+ * File layout (little endian):
+ *   CaptureFileHeader, then CaptureBlockHeader + records, repeated.
+ *   Record: flags byte, varint delta (us since the previous record in the
+ *   block, the first relative to the block time), varint length, payload.
+ *   A DATA_LOST record has no payload; its length is the dropped count.
+ *
+ * Each written block appends a CaptureIndexEntry to "<path>.idx" through
+ * the write-back cache, so a reader can binary-search to a time without
+ * scanning. Blocks carry their own header, so the index can be rebuilt
+ * by walking the log if it is missing. tools/capture_decode.py decodes.
+ *
+ * record() may be called from any task; start() and stop() from one.
+ */
+
+static constexpr uint32_t CAPTURE_FILE_MAGIC = 0x50433554;    // "T5CP"
+static constexpr uint32_t CAPTURE_BLOCK_MAGIC = 0x4B423554;   // "T5BK"
+static constexpr uint16_t CAPTURE_VERSION = 1;
+
+enum CaptureRecordFlags : uint8_t {
+    CAPTURE_RECORD_TX = 0x01,           // Transmitted by us; otherwise received
+    CAPTURE_RECORD_DATA_LOST = 0x02     // Bytes dropped before this point
+};
+
+enum CaptureBlockFlags : uint16_t {
+    CAPTURE_BLOCK_DATA_LOST = 0x0001    // Block starts with a DATA_LOST record
+};
+
+struct CaptureFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t blockSize;         // Largest record area of a block
+    uint32_t baudRate;
+    int64_t startEpochUs;       // Wall clock at capture clock 0
+    char source[8];             // Capturing app, NUL padded
+};
+static_assert(sizeof(CaptureFileHeader) == 32, "Capture header layout");
+
+struct CaptureBlockHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    int64_t firstUs;            // Capture clock of the block's time base
+    uint64_t streamOffset;      // Payload bytes logged before this block
+    uint32_t length;            // Record bytes following the header
+    uint16_t records;
+    uint16_t flags;
+};
+static_assert(sizeof(CaptureBlockHeader) == 32, "Capture block layout");
+
+struct CaptureIndexEntry {
+    int64_t firstUs;
+    uint64_t fileOffset;        // Offset of the block header in the log
+};
+static_assert(sizeof(CaptureIndexEntry) == 16, "Capture index layout");
+
+struct CaptureStats {
+    uint64_t rxBytes;
+    uint64_t txBytes;
+    uint64_t fileBytes;
+    uint32_t records;
+    uint32_t blocksWritten;
+    uint32_t blocksQueued;
+    uint32_t bytesDropped;
+    uint32_t writeErrors;
+    uint32_t elapsedMs;
+};
+
+class SerialCapture {
+public:
+    SerialCapture() = default;
+    ~SerialCapture();
+
+    SerialCapture(const SerialCapture&) = delete;
+    SerialCapture& operator=(const SerialCapture&) = delete;
+
+    /**
+     * @brief Create a log and start accepting records
+     * @param path Log path; nullptr for a new file in OS_CAPTURE_DIR
+     * @param source Short name of the capturing app
+     * @param baudRate Line rate, stored for the decoder
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t start(const char* path, const char* source, uint32_t baudRate);
+
+    /**
+     * @brief Write out pending blocks and close the log
+     * @return OS_OK on success, error code if a write failed
+     */
+    os_error_t stop();
+
+    /**
+     * @brief Check if a capture is running
+     * @return true between start() and stop()
+     */
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief Log raw bytes
+     * @param transmitted true for bytes we sent, false for received
+     * @param data Bytes
+     * @param length Byte count
+     */
+    void record(bool transmitted, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get capture counters
+     * @return Statistics snapshot
+     */
+    CaptureStats getStats() const;
+
+    /**
+     * @brief Get the log path
+     * @return Path of the running or last capture
+     */
+    const char* getPath() const { return m_path; }
+
+    /**
+     * @brief Format counters as one status line
+     * @param out Output buffer
+     * @param size Output size
+     */
+    void formatSummary(char* out, size_t size) const;
+
+private:
+    static constexpr size_t MAX_RECORD_HEADER = 9;      // Flags + 5 + 3 varint bytes
+    static constexpr int NO_BLOCK = -1;
+
+    bool openBlock(int64_t now);
+    void sealBlock();
+    void appendRecord(uint8_t flags, int64_t now, const uint8_t* data, size_t length);
+    uint8_t* blockAt(int index) const;
+    void releaseResources();
+    void lock() const;
+    void unlock() const;
+
+    static void writerTask(void* parameter);
+
+    // Log file
+    char m_path[96] = {};
+    char m_indexPath[104] = {};
+    FileHandle m_handle = INVALID_FILE_HANDLE;
+    volatile bool m_active = false;
+    volatile bool m_writerRunning = false;
+    TaskHandle_t m_writerTask = nullptr;
+
+    // Block pool: the producer fills one, the writer drains the full queue
+    uint8_t* m_pool = nullptr;
+    QueueHandle_t m_freeBlocks = nullptr;
+    QueueHandle_t m_fullBlocks = nullptr;
+    SemaphoreHandle_t m_mutex = nullptr;
+    int m_block = NO_BLOCK;
+    size_t m_blockUsed = 0;
+    int64_t m_blockOpenedUs = 0;
+    int64_t m_lastRecordUs = 0;
+
+    // Capture clock and counters
+    int64_t m_startUs = 0;
+    uint32_t m_sequence = 0;
+    uint64_t m_streamBytes = 0;
+    uint32_t m_lostPending = 0;
+    CaptureStats m_stats = {};
+};
+
+#endif // SERIAL_CAPTURE_H
@@ -0,0 +1,291 @@
+#include "speech_uploader.h"
+#include "os_manager.h"
+#include <cJSON.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "SpeechUploader";
+
+/**
+ * @brief Canonical 44-byte WAV header for 16-bit mono PCM
+ */
+struct WavHeader {
+    uint32_t riff, riffSize, wave;
+    uint32_t fmt, fmtSize;
+    uint16_t audioFormat, channels;
+    uint32_t sampleRate, byteRate;
+    uint16_t blockAlign, bitsPerSample;
+    uint32_t data, dataSize;
+};
+static_assert(sizeof(WavHeader) == 44, "WAV header layout");
+
+static constexpr uint32_t fourcc(char a, char b, char c, char d) {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+static uint32_t elapsedMs(int64_t sinceUs) {
+    return (uint32_t)((esp_timer_get_time() - sinceUs) / 1000);
+}
+
+SpeechUploader::~SpeechUploader() {
+    cancel();
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+os_error_t SpeechUploader::start(VoiceCapture* source, HttpsSession* session, const std::string& apiKey,
+                                 const char* language) {
+    if (!source || !session || apiKey.empty()) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    if (m_task) {
+        return OS_ERROR_BUSY;
+    }
+
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+    }
+    if (!m_chunk) {
+        m_chunk = (uint8_t*)OS_MALLOC(CHUNK_BUFFER_SIZE);
+    }
+    if (!m_mutex || !m_chunk) {
+        ESP_LOGE(TAG, "Failed to allocate upload buffer");
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_source = source;
+    m_session = session;
+    m_apiKey = apiKey;
+    snprintf(m_language, sizeof(m_language), "%s", language ? language : "");
+    m_startUs = esp_timer_get_time();
+    m_endpointUs = 0;
+    m_stats = {};
+    snprintf(m_boundary, sizeof(m_boundary), "tab5-%016llx", (unsigned long long)m_startUs);
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_result.clear();
+    xSemaphoreGive(m_mutex);
+
+    m_cancelled = false;
+    m_state.store(SpeechUploadState::CONNECTING, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(uploadTask, "stt_upload", OS_STT_TASK_STACK, this,
+                                OS_STT_TASK_PRIORITY, &m_task, OS_STT_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create upload task");
+        m_task = nullptr;
+        m_state.store(SpeechUploadState::IDLE, std::memory_order_release);
+        return OS_ERROR_NO_MEMORY;
+    }
+    return OS_OK;
+}
+
+void SpeechUploader::cancel() {
+    if (m_task) {
+        m_cancelled = true;
+        for (int i = 0; i < 50 && m_task; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Upload task did not exit, deleting it");
+            vTaskDelete(m_task);
+            m_task = nullptr;
+        }
+    }
+    if (m_chunk) {
+        OS_FREE(m_chunk);
+        m_chunk = nullptr;
+    }
+    m_state.store(SpeechUploadState::IDLE, std::memory_order_release);
+}
+
+bool SpeechUploader::isFinished() const {
+    SpeechUploadState state = getState();
+    return state == SpeechUploadState::DONE || state == SpeechUploadState::NO_SPEECH ||
+           state == SpeechUploadState::ERROR;
+}
+
+bool SpeechUploader::takeTranscript(std::string& text) {
+    if (!isFinished() || !m_mutex) {
+        return false;
+    }
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    text = m_result;
+    xSemaphoreGive(m_mutex);
+    return true;
+}
+
+bool SpeechUploader::openRequest() {
+    char contentType[80];
+    snprintf(contentType, sizeof(contentType), "multipart/form-data; boundary=%s", m_boundary);
+
+    // Length -1: chunked transfer, the body is framed by writeChunk()
+    os_error_t result = m_session->begin(OS_STT_PATH, contentType, -1, m_apiKey);
+    if (result != OS_OK) {
+        ESP_LOGE(TAG, "Failed to open the upload: %d", result);
+        return false;
+    }
+    m_requestOpen = true;
+
+    // Form fields, then the file part up to its first PCM byte
+    char* body = (char*)m_chunk + CHUNK_PREFIX;
+    int length = snprintf(body, OS_STT_CHUNK_BYTES,
+        "--%s\r\nContent-Disposition: form-data; name=\"model\"\r\n\r\n%s\r\n"
+        "--%s\r\nContent-Disposition: form-data; name=\"response_format\"\r\n\r\njson\r\n",
+        m_boundary, OS_STT_MODEL, m_boundary);
+    if (m_language[0]) {
+        length += snprintf(body + length, OS_STT_CHUNK_BYTES - length,
+            "--%s\r\nContent-Disposition: form-data; name=\"language\"\r\n\r\n%s\r\n",
+            m_boundary, m_language);
+    }
+    length += snprintf(body + length, OS_STT_CHUNK_BYTES - length,
+        "--%s\r\nContent-Disposition: form-data; name=\"file\"; filename=\"speech.wav\"\r\n"
+        "Content-Type: audio/wav\r\n\r\n", m_boundary);
+
+    // Sizes are unknown while streaming; decoders read to the end of the part
+    WavHeader wav = {};
+    wav.riff = fourcc('R', 'I', 'F', 'F');
+    wav.riffSize = 0xFFFFFFFF;
+    wav.wave = fourcc('W', 'A', 'V', 'E');
+    wav.fmt = fourcc('f', 'm', 't', ' ');
+    wav.fmtSize = 16;
+    wav.audioFormat = 1;
+    wav.channels = 1;
+    wav.sampleRate = OS_AUDIO_SAMPLE_RATE;
+    wav.byteRate = OS_AUDIO_SAMPLE_RATE * sizeof(int16_t);
+    wav.blockAlign = sizeof(int16_t);
+    wav.bitsPerSample = 16;
+    wav.data = fourcc('d', 'a', 't', 'a');
+    wav.dataSize = 0xFFFFFFFF;
+    memcpy(body + length, &wav, sizeof(wav));
+    length += sizeof(wav);
+
+    return writeChunk(length);
+}
+
+bool SpeechUploader::writeChunk(size_t length) {
+    // The payload is already in m_chunk after CHUNK_PREFIX: frame it in place, one write
+    char prefix[CHUNK_PREFIX + 1];
+    int prefixLength = snprintf(prefix, sizeof(prefix), "%x\r\n", (unsigned)length);
+    uint8_t* start = m_chunk + CHUNK_PREFIX - prefixLength;
+    memcpy(start, prefix, prefixLength);
+    memcpy(m_chunk + CHUNK_PREFIX + length, "\r\n", CHUNK_SUFFIX);
+    return writeRaw((const char*)start, prefixLength + length + CHUNK_SUFFIX);
+}
+
+bool SpeechUploader::writeText(const char* text) {
+    size_t length = strlen(text);
+    memcpy(m_chunk + CHUNK_PREFIX, text, length);
+    return writeChunk(length);
+}
+
+bool SpeechUploader::writeRaw(const char* data, size_t length) {
+    return !m_cancelled && m_session->write(data, length);
+}
+
+void SpeechUploader::finishRequest() {
+    char closing[64];
+    snprintf(closing, sizeof(closing), "\r\n--%s--\r\n", m_boundary);
+    if (!writeText(closing) || !writeRaw("0\r\n\r\n", 5)) {
+        setResult(SpeechUploadState::ERROR, "Upload failed");
+        return;
+    }
+    m_stats.tailMs = elapsedMs(m_endpointUs);
+    m_state.store(SpeechUploadState::WAITING, std::memory_order_release);
+
+    m_stats.httpStatus = m_session->fetchResponse();
+    char* response = (char*)m_chunk;
+    int length = 0;
+    while (m_stats.httpStatus > 0 && length < OS_STT_MAX_RESPONSE) {
+        int received = m_session->read(response + length, OS_STT_MAX_RESPONSE - length);
+        if (received <= 0) {
+            break;
+        }
+        length += received;
+    }
+    response[length] = '\0';
+    m_stats.resultMs = elapsedMs(m_endpointUs);
+
+    cJSON* root = cJSON_Parse(response);
+    cJSON* text = root ? cJSON_GetObjectItem(root, "text") : nullptr;
+    if (m_stats.httpStatus == 200 && cJSON_IsString(text)) {
+        setResult(SpeechUploadState::DONE, text->valuestring);
+        ESP_LOGI(TAG, "Transcript %d ms after end-point (%d bytes in %d chunks, tail %d ms)",
+                 m_stats.resultMs, m_stats.bytesSent, m_stats.chunks, m_stats.tailMs);
+    } else {
+        cJSON* error = root ? cJSON_GetObjectItem(root, "error") : nullptr;
+        cJSON* message = error ? cJSON_GetObjectItem(error, "message") : nullptr;
+        char fallback[32];
+        snprintf(fallback, sizeof(fallback), "Speech service error %d", m_stats.httpStatus);
+        setResult(SpeechUploadState::ERROR, cJSON_IsString(message) ? message->valuestring : fallback);
+        ESP_LOGW(TAG, "Transcription failed: HTTP %d", m_stats.httpStatus);
+    }
+    cJSON_Delete(root);
+}
+
+void SpeechUploader::setResult(SpeechUploadState state, const char* text) {
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    m_result = text ? text : "";
+    xSemaphoreGive(m_mutex);
+    m_state.store(state, std::memory_order_release);
+}
+
+void SpeechUploader::uploadTask(void* parameter) {
+    SpeechUploader* uploader = static_cast<SpeechUploader*>(parameter);
+    VoiceCapture* source = uploader->m_source;
+    uint8_t* payload = uploader->m_chunk + CHUNK_PREFIX;
+
+    // Connect while the user is still starting to talk
+    bool connected = uploader->openRequest();
+    uploader->m_stats.connectMs = elapsedMs(uploader->m_startUs);
+    if (!connected) {
+        uploader->setResult(SpeechUploadState::ERROR, "Could not reach the speech service");
+    }
+
+    bool failed = !connected;
+    while (!failed && !uploader->m_cancelled) {
+        // Sample the state before draining so the utterance tail is never missed
+        bool finished = source->isFinished();
+        if (!finished && source->speechAvailable() < OS_STT_CHUNK_BYTES) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        if (finished && uploader->m_endpointUs == 0) {
+            uploader->m_endpointUs = esp_timer_get_time();
+        }
+
+        size_t length = source->readSpeech(payload, OS_STT_CHUNK_BYTES);
+        if (length == 0) {
+            break;
+        }
+        uploader->m_state.store(SpeechUploadState::STREAMING, std::memory_order_release);
+        if (!uploader->writeChunk(length)) {
+            uploader->setResult(SpeechUploadState::ERROR, "Upload failed");
+            failed = true;
+            break;
+        }
+        uploader->m_stats.bytesSent += length;
+        uploader->m_stats.chunks++;
+    }
+
+    if (!failed && !uploader->m_cancelled) {
+        if (uploader->m_stats.bytesSent > 0) {
+            uploader->finishRequest();
+        } else if (source->getState() == VoiceCaptureState::ERROR) {
+            uploader->setResult(SpeechUploadState::ERROR, "Microphone unavailable");
+        } else {
+            uploader->setResult(SpeechUploadState::NO_SPEECH, "");
+        }
+    }
+    if (uploader->m_requestOpen) {
+        // Keep the connection for the next request unless the exchange broke off
+        uploader->m_session->end(uploader->getState() == SpeechUploadState::DONE ||
+                                 (uploader->getState() == SpeechUploadState::ERROR &&
+                                  uploader->m_stats.httpStatus > 0));
+        uploader->m_requestOpen = false;
+    }
+
+    uploader->m_task = nullptr;
+    vTaskDelete(NULL);
+}
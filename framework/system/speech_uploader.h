@@ -0,0 +1,135 @@
+#ifndef SPEECH_UPLOADER_H
+#define SPEECH_UPLOADER_H
+
+#include "os_config.h"
+#include "voice_capture.h"
+#include "https_session.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <string>
+
+/**
+ * @file speech_uploader.h
+ * @brief Streams an utterance to the speech-to-text backend while it is spoken
+ *
+ * start() opens the request on the shared HttpsSession at once, so any
+ * TLS handshake overlaps the user drawing breath (a kept-alive connection
+ * skips it), and sends the request to OS_STT_PATH with chunked transfer
+ * encoding: a multipart/form-data body whose file part is a WAV header
+ * with open-ended sizes followed by PCM drained from VoiceCapture in
+ * OS_STT_CHUNK_BYTES chunks as it is captured. When the capture end-points
+ * only the last partial chunk and the closing boundary are left to send,
+ * so the transcript arrives one server round trip after the user stops
+ * talking rather than after a full record-then-upload.
+ *
+ * The upload runs on its own task so a slow network never stalls the
+ * microphone. start(), cancel() and takeTranscript() come from one task.
+ */
+
+enum class SpeechUploadState : uint8_t {
+    IDLE,
+    CONNECTING,     // Opening the request, or waiting for speech onset
+    STREAMING,      // Sending speech chunks
+    WAITING,        // Upload complete, waiting for the transcript
+    DONE,           // Transcript ready
+    NO_SPEECH,      // Capture heard nothing; request abandoned
+    ERROR
+};
+
+struct SpeechUploadStats {
+    uint32_t bytesSent;         // PCM bytes uploaded
+    uint32_t chunks;
+    uint32_t connectMs;         // start() to request headers sent
+    uint32_t tailMs;            // End-point to last chunk sent
+    uint32_t resultMs;          // End-point to transcript: the latency the user feels
+    int httpStatus;
+};
+
+class SpeechUploader {
+public:
+    SpeechUploader() = default;
+    ~SpeechUploader();
+
+    SpeechUploader(const SpeechUploader&) = delete;
+    SpeechUploader& operator=(const SpeechUploader&) = delete;
+
+    /**
+     * @brief Start streaming the capture's utterance to the backend
+     * @param source Running capture; must outlive the upload
+     * @param session Connection to the backend; must outlive the upload
+     * @param apiKey Bearer token for the backend
+     * @param language ISO-639-1 code, or nullptr to let the backend detect it
+     * @return OS_OK on success, OS_ERROR_BUSY or OS_ERROR_NO_MEMORY
+     */
+    os_error_t start(VoiceCapture* source, HttpsSession* session, const std::string& apiKey,
+                     const char* language);
+
+    /**
+     * @brief Abort the upload and wait for the task to exit
+     */
+    void cancel();
+
+    /**
+     * @brief Get the upload state
+     * @return Current state
+     */
+    SpeechUploadState getState() const { return m_state.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if the task has finished (done, no speech or error)
+     * @return true if the capture may be stopped
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Get the transcript once the state is DONE, or the error text on ERROR
+     * @param text Output text
+     * @return true if the upload has finished
+     */
+    bool takeTranscript(std::string& text);
+
+    /**
+     * @brief Get upload counters
+     * @return Statistics snapshot
+     */
+    SpeechUploadStats getStats() const { return m_stats; }
+
+private:
+    static constexpr size_t CHUNK_PREFIX = 8;       // "%x\r\n" for OS_STT_CHUNK_BYTES
+    static constexpr size_t CHUNK_SUFFIX = 2;
+    static constexpr size_t CHUNK_BUFFER_SIZE = CHUNK_PREFIX + OS_STT_CHUNK_BYTES + CHUNK_SUFFIX;
+    static_assert(CHUNK_BUFFER_SIZE > OS_STT_MAX_RESPONSE, "Chunk buffer doubles as the response buffer");
+
+    bool openRequest();
+    bool writeChunk(size_t length);
+    bool writeText(const char* text);
+    bool writeRaw(const char* data, size_t length);
+    void finishRequest();
+    void setResult(SpeechUploadState state, const char* text);
+
+    static void uploadTask(void* parameter);
+
+    VoiceCapture* m_source = nullptr;
+    HttpsSession* m_session = nullptr;
+    std::string m_apiKey;
+    char m_language[8] = {};
+    char m_boundary[40] = {};
+
+    bool m_requestOpen = false;     // The session is held by the task
+    uint8_t* m_chunk = nullptr;     // CHUNK_BUFFER_SIZE, also receives the response
+
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_cancelled = false;
+    std::atomic<SpeechUploadState> m_state{SpeechUploadState::IDLE};
+
+    SemaphoreHandle_t m_mutex = nullptr;
+    std::string m_result;           // Guarded by m_mutex
+
+    int64_t m_startUs = 0;
+    int64_t m_endpointUs = 0;
+    SpeechUploadStats m_stats = {};
+};
+
+#endif // SPEECH_UPLOADER_H
@@ -0,0 +1,492 @@
+#include "spreadsheet_engine.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+static const char* TAG = "SpreadsheetEngine";
+
+std::string SpreadsheetEngine::cellName(int row, int col) {
+    // Two letters and any int row, so out-of-range calls cannot truncate
+    char name[16];
+    if (col < 26) {
+        snprintf(name, sizeof(name), "%c%d", 'A' + col, row + 1);
+    } else {
+        snprintf(name, sizeof(name), "%c%c%d", 'A' + col / 26 - 1, 'A' + col % 26, row + 1);
+    }
+    return name;
+}
+
+uint32_t SpreadsheetEngine::slotOf(uint32_t key) {
+    const uint32_t mask = TILE_SIZE - 1;
+    return (((key >> 16) & mask) << OS_SHEET_TILE_SHIFT) | (key & mask);
+}
+
+static uint32_t tileKeyOf(uint32_t key) {
+    return ((key >> 16 >> OS_SHEET_TILE_SHIFT) << 16) | ((key & 0xFFFF) >> OS_SHEET_TILE_SHIFT);
+}
+
+SpreadsheetEngine::Tile* SpreadsheetEngine::findTile(uint32_t key) const {
+    uint32_t tileKey = tileKeyOf(key);
+    if (tileKey == m_lastTileKey) {
+        return m_lastTile;
+    }
+    auto it = m_tiles.find(tileKey);
+    m_lastTileKey = tileKey;
+    m_lastTile = it != m_tiles.end() ? it->second.get() : nullptr;
+    return m_lastTile;
+}
+
+SpreadsheetEngine::Tile* SpreadsheetEngine::getTile(uint32_t key) {
+    Tile* tile = findTile(key);
+    if (!tile) {
+        std::unique_ptr<Tile> created(new Tile());
+        tile = created.get();
+        m_tiles[tileKeyOf(key)] = std::move(created);
+        m_lastTile = tile;
+    }
+    return tile;
+}
+
+void SpreadsheetEngine::readCell(uint32_t key, double& value, CellKind& kind, CellError& error) const {
+    Tile* tile = findTile(key);
+    if (!tile) {
+        value = 0.0;
+        kind = CellKind::EMPTY;
+        error = CellError::NONE;
+        return;
+    }
+    uint32_t slot = slotOf(key);
+    value = tile->values[slot];
+    kind = tile->kinds[slot];
+    error = tile->errors[slot];
+}
+
+void SpreadsheetEngine::writeCell(uint32_t key, CellKind kind, double value, CellError error) {
+    Tile* tile = kind == CellKind::EMPTY ? findTile(key) : getTile(key);
+    if (!tile) {
+        return;
+    }
+    uint32_t slot = slotOf(key);
+    bool wasEmpty = tile->kinds[slot] == CellKind::EMPTY;
+    tile->values[slot] = value;
+    tile->kinds[slot] = kind;
+    tile->errors[slot] = error;
+
+    if (wasEmpty && kind != CellKind::EMPTY) {
+        tile->used++;
+        m_cellCount++;
+    } else if (!wasEmpty && kind == CellKind::EMPTY) {
+        tile->used--;
+        m_cellCount--;
+        if (tile->used == 0) {
+            m_tiles.erase(tileKeyOf(key));
+            m_lastTileKey = UINT32_MAX;
+            m_lastTile = nullptr;
+        }
+    }
+}
+
+CellError SpreadsheetEngine::readValue(uint32_t key, double& value) const {
+    CellKind kind;
+    CellError error;
+    readCell(key, value, kind, error);
+    if (error == CellError::NONE && kind == CellKind::TEXT) {
+        return CellError::VALUE;
+    }
+    return error;
+}
+
+CellError SpreadsheetEngine::aggregateRange(const CellRange& range, ExpressionAggregate& aggregate) const {
+    // Tile by tile, so a missing tile skips all of its cells at once; text
+    // and empty cells are skipped, as in other spreadsheets
+    for (uint32_t tileRow = range.row0 >> OS_SHEET_TILE_SHIFT; tileRow <= (uint32_t)range.row1 >> OS_SHEET_TILE_SHIFT; tileRow++) {
+        for (uint32_t tileCol = range.col0 >> OS_SHEET_TILE_SHIFT; tileCol <= (uint32_t)range.col1 >> OS_SHEET_TILE_SHIFT; tileCol++) {
+            uint32_t baseRow = tileRow << OS_SHEET_TILE_SHIFT;
+            uint32_t baseCol = tileCol << OS_SHEET_TILE_SHIFT;
+            Tile* tile = findTile(keyOf(baseRow, baseCol));
+            if (!tile) {
+                continue;
+            }
+            uint32_t row0 = std::max<uint32_t>(range.row0, baseRow);
+            uint32_t row1 = std::min<uint32_t>(range.row1, baseRow + TILE_SIZE - 1);
+            uint32_t col0 = std::max<uint32_t>(range.col0, baseCol);
+            uint32_t col1 = std::min<uint32_t>(range.col1, baseCol + TILE_SIZE - 1);
+            for (uint32_t row = row0; row <= row1; row++) {
+                uint32_t slot = (row - baseRow) << OS_SHEET_TILE_SHIFT;
+                for (uint32_t col = col0; col <= col1; col++) {
+                    uint32_t s = slot + (col - baseCol);
+                    if (tile->errors[s] != CellError::NONE) {
+                        return tile->errors[s];
+                    }
+                    if (tile->kinds[s] == CellKind::NUMBER || tile->kinds[s] == CellKind::FORMULA) {
+                        aggregate.add(tile->values[s]);
+                    }
+                }
+            }
+        }
+    }
+    return CellError::NONE;
+}
+
+void SpreadsheetEngine::link(uint32_t key, Formula& formula) {
+    formula.expression.getReferences(formula.cells, formula.ranges);
+    std::sort(formula.cells.begin(), formula.cells.end());
+    formula.cells.erase(std::unique(formula.cells.begin(), formula.cells.end()), formula.cells.end());
+    for (uint32_t cell : formula.cells) {
+        m_dependents[cell].push_back(key);
+    }
+    for (const CellRange& range : formula.ranges) {
+        m_rangeDependents.push_back({range, key});
+    }
+    m_formulas[key] = std::move(formula);
+}
+
+void SpreadsheetEngine::unlink(uint32_t key) {
+    auto formula = m_formulas.find(key);
+    if (formula == m_formulas.end()) {
+        return;
+    }
+    for (uint32_t cell : formula->second.cells) {
+        auto it = m_dependents.find(cell);
+        if (it == m_dependents.end()) {
+            continue;
+        }
+        std::vector<uint32_t>& dependents = it->second;
+        dependents.erase(std::remove(dependents.begin(), dependents.end(), key), dependents.end());
+        if (dependents.empty()) {
+            m_dependents.erase(it);
+        }
+    }
+    if (!formula->second.ranges.empty()) {
+        m_rangeDependents.erase(std::remove_if(m_rangeDependents.begin(), m_rangeDependents.end(),
+                                               [key](const std::pair<CellRange, uint32_t>& entry) {
+                                                   return entry.second == key;
+                                               }),
+                                m_rangeDependents.end());
+    }
+    m_formulas.erase(formula);
+}
+
+template <typename Visit>
+void SpreadsheetEngine::forEachDependent(uint32_t key, Visit visit) const {
+    auto it = m_dependents.find(key);
+    if (it != m_dependents.end()) {
+        for (uint32_t dependent : it->second) {
+            visit(dependent);
+        }
+    }
+    uint32_t row = key >> 16;
+    uint32_t col = key & 0xFFFF;
+    for (const auto& entry : m_rangeDependents) {
+        if (entry.first.contains(row, col)) {
+            visit(entry.second);
+        }
+    }
+}
+
+void SpreadsheetEngine::evaluate(uint32_t key) {
+    auto formula = m_formulas.find(key);
+    CellError error = CellError::PARSE;
+    double value = 0.0;
+    if (formula != m_formulas.end()) {
+        value = formula->second.expression.evaluate(this, error);
+    }
+    writeCell(key, CellKind::FORMULA, value, error);
+}
+
+void SpreadsheetEngine::recalculate(uint32_t root, bool everything) {
+    int64_t start = esp_timer_get_time();
+
+    // Formulas to evaluate: everything reachable from the changed cell
+    std::vector<uint32_t> members;
+    std::unordered_map<uint32_t, uint32_t> pending;     // Member -> inputs not yet evaluated
+    if (everything) {
+        members.reserve(m_formulas.size());
+        for (const auto& formula : m_formulas) {
+            members.push_back(formula.first);
+            pending[formula.first] = 0;
+        }
+    } else {
+        if (m_formulas.count(root)) {
+            members.push_back(root);
+            pending[root] = 0;
+        }
+        std::vector<uint32_t> frontier(1, root);
+        while (!frontier.empty()) {
+            uint32_t key = frontier.back();
+            frontier.pop_back();
+            forEachDependent(key, [&](uint32_t dependent) {
+                if (pending.emplace(dependent, 0).second) {
+                    members.push_back(dependent);
+                    frontier.push_back(dependent);
+                }
+            });
+        }
+    }
+
+    // Kahn's algorithm over the edges inside the set
+    for (uint32_t key : members) {
+        forEachDependent(key, [&](uint32_t dependent) {
+            auto it = pending.find(dependent);
+            if (it != pending.end()) {
+                it->second++;
+            }
+        });
+    }
+    std::deque<uint32_t> ready;
+    for (uint32_t key : members) {
+        if (pending[key] == 0) {
+            ready.push_back(key);
+        }
+    }
+    uint32_t evaluated = 0;
+    while (!ready.empty()) {
+        uint32_t key = ready.front();
+        ready.pop_front();
+        evaluate(key);
+        evaluated++;
+        forEachDependent(key, [&](uint32_t dependent) {
+            auto it = pending.find(dependent);
+            if (it != pending.end() && --it->second == 0) {
+                ready.push_back(dependent);
+            }
+        });
+    }
+
+    // Whatever is left waits on itself: a cycle, or a formula fed by one
+    uint32_t cycleCells = 0;
+    if (evaluated < members.size()) {
+        for (uint32_t key : members) {
+            if (pending[key] > 0) {
+                writeCell(key, CellKind::FORMULA, 0.0, CellError::CYCLE);
+                cycleCells++;
+            }
+        }
+        ESP_LOGW(TAG, "%d cells on or behind a reference cycle", cycleCells);
+    }
+
+    m_changed.swap(members);
+    if (!everything && !m_formulas.count(root)) {
+        m_changed.push_back(root);
+    }
+
+    m_recalcs++;
+    m_lastEvaluated = evaluated;
+    m_lastRecalcUs = (uint32_t)(esp_timer_get_time() - start);
+    m_maxRecalcUs = std::max(m_maxRecalcUs, m_lastRecalcUs);
+    m_cycleCells = cycleCells;
+}
+
+os_error_t SpreadsheetEngine::setCell(int row, int col, const std::string& input) {
+    if (row < 0 || row >= OS_SHEET_MAX_ROWS || col < 0 || col >= OS_SHEET_MAX_COLS) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    uint32_t key = keyOf(row, col);
+    unlink(key);
+    m_sources.erase(key);
+
+    if (input.empty()) {
+        writeCell(key, CellKind::EMPTY, 0.0, CellError::NONE);
+    } else if (input[0] == '=') {
+        // A formula that does not compile reads nothing and shows its error
+        Formula formula;
+        formula.expression.compile(input.c_str() + 1);
+        m_sources[key] = input;
+        link(key, formula);
+    } else {
+        char* end = nullptr;
+        double value = strtod(input.c_str(), &end);
+        while (end && (*end == ' ' || *end == '\t')) {
+            end++;
+        }
+        bool number = end != input.c_str() && *end == '\0' && std::isfinite(value) &&
+                      input.find_first_of("xXnN") == std::string::npos;     // Not hex, inf or nan
+        if (number) {
+            writeCell(key, CellKind::NUMBER, value, CellError::NONE);
+        } else {
+            m_sources[key] = input;
+            writeCell(key, CellKind::TEXT, 0.0, CellError::NONE);
+        }
+    }
+
+    recalculate(key, false);
+    return OS_OK;
+}
+
+void SpreadsheetEngine::clear() {
+    m_tiles.clear();
+    m_lastTileKey = UINT32_MAX;
+    m_lastTile = nullptr;
+    m_sources.clear();
+    m_cellCount = 0;
+    m_formulas.clear();
+    m_dependents.clear();
+    m_rangeDependents.clear();
+    m_changed.clear();
+}
+
+void SpreadsheetEngine::recalculateAll() {
+    recalculate(0, true);
+}
+
+CellKind SpreadsheetEngine::getKind(int row, int col) const {
+    double value;
+    CellKind kind;
+    CellError error;
+    readCell(keyOf(row, col), value, kind, error);
+    return kind;
+}
+
+double SpreadsheetEngine::getValue(int row, int col) const {
+    double value;
+    CellKind kind;
+    CellError error;
+    readCell(keyOf(row, col), value, kind, error);
+    return value;
+}
+
+CellError SpreadsheetEngine::getError(int row, int col) const {
+    double value;
+    CellKind kind;
+    CellError error;
+    readCell(keyOf(row, col), value, kind, error);
+    return error;
+}
+
+static std::string formatNumber(double value) {
+    char text[32];
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        snprintf(text, sizeof(text), "%.0f", value);
+    } else {
+        snprintf(text, sizeof(text), "%.6g", value);
+    }
+    return text;
+}
+
+std::string SpreadsheetEngine::getInput(int row, int col) const {
+    uint32_t key = keyOf(row, col);
+    auto source = m_sources.find(key);
+    if (source != m_sources.end()) {
+        return source->second;
+    }
+    double value;
+    CellKind kind;
+    CellError error;
+    readCell(key, value, kind, error);
+    if (kind != CellKind::NUMBER) {
+        return "";
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "%.15g", value);
+    return text;
+}
+
+std::string SpreadsheetEngine::getDisplay(int row, int col) const {
+    uint32_t key = keyOf(row, col);
+    double value;
+    CellKind kind;
+    CellError error;
+    readCell(key, value, kind, error);
+
+    switch (error) {
+        case CellError::PARSE:    return "#ERROR!";
+        case CellError::REF:      return "#REF!";
+        case CellError::DIV_ZERO: return "#DIV/0!";
+        case CellError::VALUE:    return "#VALUE!";
+        case CellError::CYCLE:    return "#CYCLE!";
+        default: break;
+    }
+    switch (kind) {
+        case CellKind::NUMBER:
+        case CellKind::FORMULA:
+            return formatNumber(value);
+        case CellKind::TEXT: {
+            auto source = m_sources.find(key);
+            return source != m_sources.end() ? source->second : "";
+        }
+        default:
+            return "";
+    }
+}
+
+void SpreadsheetEngine::forEachCell(const std::function<void(int row, int col, const std::string& input)>& visit) const {
+    for (const auto& tile : m_tiles) {
+        int baseRow = (int)(tile.first >> 16) << OS_SHEET_TILE_SHIFT;
+        int baseCol = (int)(tile.first & 0xFFFF) << OS_SHEET_TILE_SHIFT;
+        for (uint32_t slot = 0; slot < TILE_CELLS; slot++) {
+            if (tile.second->kinds[slot] != CellKind::EMPTY) {
+                int row = baseRow + (int)(slot >> OS_SHEET_TILE_SHIFT);
+                int col = baseCol + (int)(slot & (TILE_SIZE - 1));
+                visit(row, col, getInput(row, col));
+            }
+        }
+    }
+}
+
+void SpreadsheetEngine::printStats(const char* tag) const {
+    size_t edges = 0;
+    for (const auto& dependents : m_dependents) {
+        edges += dependents.second.size();
+    }
+    ESP_LOGI(tag, "Sheet: %zu cells in %zu tiles, %zu formulas, %zu cell links, %zu range links",
+             m_cellCount, m_tiles.size(), m_formulas.size(), edges, m_rangeDependents.size());
+    ESP_LOGI(tag, "Recalc: %d runs, last %d formulas in %d us (max %d us), %d on cycles",
+             m_recalcs, m_lastEvaluated, m_lastRecalcUs, m_maxRecalcUs, m_cycleCells);
+}
+
+os_error_t SpreadsheetEngine::runRecalcBenchmark(uint32_t cells, RecalcBenchmarkResult& result) {
+    // A square whose first row and column are values and every other cell
+    // adds the ones above and to the left, plus a SUM over all of it: an
+    // edit at the top left reaches every formula, one at the bottom right
+    // only itself and the total
+    int side = std::max(2, (int)std::ceil(std::sqrt((double)cells)));
+    if (side >= OS_SHEET_MAX_COLS || side >= OS_SHEET_MAX_ROWS) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    SpreadsheetEngine sheet;
+    int64_t start = esp_timer_get_time();
+    for (int row = 0; row < side; row++) {
+        for (int col = 0; col < side; col++) {
+            if (row == 0 || col == 0) {
+                sheet.setCell(row, col, "1");
+            } else {
+                sheet.setCell(row, col, "=" + cellName(row - 1, col) + "+" + cellName(row, col - 1));
+            }
+        }
+    }
+    sheet.setCell(side, 0, "=SUM(A1:" + cellName(side - 1, side - 1) + ")");
+    result.cells = sheet.getCellCount();
+    result.buildUs = (uint32_t)(esp_timer_get_time() - start);
+
+    sheet.recalculateAll();
+    result.fullFormulas = sheet.m_lastEvaluated;
+    result.fullUs = sheet.m_lastRecalcUs;
+
+    sheet.setCell(0, 1, "2");
+    result.topFormulas = sheet.m_lastEvaluated;
+    result.topUs = sheet.m_lastRecalcUs;
+
+    sheet.setCell(side - 1, side - 1, "0");
+    result.bottomFormulas = sheet.m_lastEvaluated;
+    result.bottomUs = sheet.m_lastRecalcUs;
+    return OS_OK;
+}
+
+void SpreadsheetEngine::runRecalcBenchmark(uint32_t cells) {
+    RecalcBenchmarkResult result;
+    if (runRecalcBenchmark(cells, result) != OS_OK) {
+        ESP_LOGW(TAG, "Recalc benchmark too large");
+        return;
+    }
+
+    ESP_LOGI(TAG, "=== Spreadsheet Recalc Benchmark (%d cells) ===", result.cells);
+    ESP_LOGI(TAG, "Build: %d cells in %d ms", result.cells, result.buildUs / 1000);
+    ESP_LOGI(TAG, "Full recalc: %d formulas in %d us", result.fullFormulas, result.fullUs);
+    ESP_LOGI(TAG, "Edit at top: %d formulas in %d us", result.topFormulas, result.topUs);
+    ESP_LOGI(TAG, "Edit at bottom: %d formulas in %d us", result.bottomFormulas, result.bottomUs);
+}
@@ -0,0 +1,204 @@
+#ifndef SPREADSHEET_ENGINE_H
+#define SPREADSHEET_ENGINE_H
+
+#include "expression_engine.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file spreadsheet_engine.h
+ * @brief Sparse cell store with incremental formula recalculation
+ *
+ * Cells live in 16x16 tiles (OS_SHEET_TILE_SHIFT) found through a hash
+ * map, each holding flat arrays of values, kinds and errors, so a range
+ * or a neighbourhood is a walk through a few contiguous blocks rather
+ * than a tree of nodes. Text and formula sources are kept apart, keyed by
+ * cell.
+ *
+ * Every formula records the cells and ranges it reads, and the reverse
+ * (which formulas read a cell, which read a range) is kept alongside. An
+ * edit marks the formulas reachable from the edited cell, orders them
+ * topologically and evaluates each once, after everything it reads.
+ * Formulas left unordered are on a cycle or fed by one and show #CYCLE!.
+ *
+ * Formulas start with '=' and are compiled once, when entered, into a
+ * CompiledExpression kept with the cell; recalculation only runs the
+ * program. Rows and columns are zero-based here.
+ */
+
+enum class CellKind : uint8_t {
+    EMPTY,
+    NUMBER,
+    TEXT,
+    FORMULA
+};
+
+/**
+ * @brief Timings from SpreadsheetEngine::runRecalcBenchmark()
+ */
+struct RecalcBenchmarkResult {
+    uint32_t cells;
+    uint32_t buildUs;           // Entering every cell, with its incremental recalc
+    uint32_t fullFormulas;
+    uint32_t fullUs;
+    uint32_t topFormulas;       // Edit that reaches every formula
+    uint32_t topUs;
+    uint32_t bottomFormulas;    // Edit that reaches only itself and the total
+    uint32_t bottomUs;
+};
+
+class SpreadsheetEngine : private ExpressionContext {
+public:
+    SpreadsheetEngine() = default;
+
+    /**
+     * @brief Set a cell from user input and recalculate what depends on it
+     * @param row Row
+     * @param col Column
+     * @param input "=..." for a formula, a number, other text, or empty to clear
+     * @return OS_OK, or OS_ERROR_INVALID_PARAM outside the sheet
+     */
+    os_error_t setCell(int row, int col, const std::string& input);
+
+    /**
+     * @brief Remove every cell
+     */
+    void clear();
+
+    CellKind getKind(int row, int col) const;
+    double getValue(int row, int col) const;
+    CellError getError(int row, int col) const;
+
+    /**
+     * @brief Get what was typed into a cell
+     * @param row Row
+     * @param col Column
+     * @return Formula source, text or number as entered; empty for an empty cell
+     */
+    std::string getInput(int row, int col) const;
+
+    /**
+     * @brief Get the text a cell shows
+     * @param row Row
+     * @param col Column
+     * @return Formatted value, text or error code
+     */
+    std::string getDisplay(int row, int col) const;
+
+    /**
+     * @brief Get the cells whose shown value the last change may have changed
+     * @return Cell keys (row << 16 | col); valid until the next change
+     */
+    const std::vector<uint32_t>& getLastChanged() const { return m_changed; }
+
+    /**
+     * @brief Visit every non-empty cell
+     * @param visit Called with row, column and input
+     */
+    void forEachCell(const std::function<void(int row, int col, const std::string& input)>& visit) const;
+
+    /**
+     * @brief Re-evaluate every formula
+     */
+    void recalculateAll();
+
+    size_t getCellCount() const { return m_cellCount; }
+    size_t getFormulaCount() const { return m_formulas.size(); }
+
+    /**
+     * @brief Print store, graph and recalculation statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+    /**
+     * @brief Time full and incremental recalculation on a generated sheet and log it
+     * @param cells Cells to generate, as a square of chained formulas
+     */
+    static void runRecalcBenchmark(uint32_t cells = 10000);
+
+    /**
+     * @brief Time recalculation on a generated sheet and return the timings
+     * @param cells Cells to generate, as a square of chained formulas
+     * @param result Output timings
+     * @return OS_OK, or OS_ERROR_INVALID_PARAM if the square does not fit the sheet
+     */
+    static os_error_t runRecalcBenchmark(uint32_t cells, RecalcBenchmarkResult& result);
+
+    /**
+     * @brief Format a cell name
+     * @param row Row
+     * @param col Column
+     * @return Name such as "B7"
+     */
+    static std::string cellName(int row, int col);
+
+    /**
+     * @brief Parse a cell name
+     * @param text Name such as "B7" or "$B$7"
+     * @param row Set to the row
+     * @param col Set to the column
+     * @return Characters used, 0 if the text does not start with a cell name
+     */
+    static size_t parseCellName(const char* text, int& row, int& col) {
+        return CompiledExpression::parseCellName(text, row, col);
+    }
+
+    static uint32_t keyOf(int row, int col) { return cellKey(row, col); }
+
+private:
+    static constexpr uint32_t TILE_SIZE = 1u << OS_SHEET_TILE_SHIFT;
+    static constexpr uint32_t TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    struct Tile {
+        double values[TILE_CELLS];
+        CellKind kinds[TILE_CELLS];
+        CellError errors[TILE_CELLS];
+        uint16_t used;
+    };
+
+    struct Formula {
+        CompiledExpression expression;
+        std::vector<uint32_t> cells;    // Read by the formula; sorted, unique
+        std::vector<CellRange> ranges;
+    };
+
+    Tile* findTile(uint32_t key) const;
+    Tile* getTile(uint32_t key);
+    static uint32_t slotOf(uint32_t key);
+    void readCell(uint32_t key, double& value, CellKind& kind, CellError& error) const;
+    void writeCell(uint32_t key, CellKind kind, double value, CellError error);
+    CellError readValue(uint32_t key, double& value) const override;
+    CellError aggregateRange(const CellRange& range, ExpressionAggregate& aggregate) const override;
+
+    void link(uint32_t key, Formula& formula);
+    void unlink(uint32_t key);
+    template <typename Visit> void forEachDependent(uint32_t key, Visit visit) const;
+    void recalculate(uint32_t root, bool everything);
+    void evaluate(uint32_t key);
+
+    std::unordered_map<uint32_t, std::unique_ptr<Tile>> m_tiles;
+    mutable uint32_t m_lastTileKey = UINT32_MAX;    // One-entry cache for runs in one tile
+    mutable Tile* m_lastTile = nullptr;
+    std::unordered_map<uint32_t, std::string> m_sources;   // Text and formula cells
+    size_t m_cellCount = 0;
+
+    // Dependency graph
+    std::unordered_map<uint32_t, Formula> m_formulas;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_dependents;
+    std::vector<std::pair<CellRange, uint32_t>> m_rangeDependents;
+
+    std::vector<uint32_t> m_changed;
+
+    // Statistics
+    uint32_t m_recalcs = 0;
+    uint32_t m_lastRecalcUs = 0;
+    uint32_t m_lastEvaluated = 0;
+    uint32_t m_maxRecalcUs = 0;
+    uint32_t m_cycleCells = 0;
+};
+
+#endif // SPREADSHEET_ENGINE_H
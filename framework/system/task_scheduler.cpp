@@ -4,6 +4,11 @@
 
 static const char* TAG = "TaskScheduler";
 
+// Min-heap ordering on deadline, tolerant of millis() wraparound
+static bool laterDeadline(const uint32_t a, const uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
 TaskScheduler::~TaskScheduler() {
     shutdown();
 }
@@ -14,8 +19,23 @@ os_error_t TaskScheduler::initialize() {
     }
 
     ESP_LOGI(TAG, "Initializing Task Scheduler");
-    
-    m_tasks.reserve(OS_MAX_TASKS);
+
+    m_tasks.assign(OS_MAX_TASKS, Task{});
+    m_freeSlots.clear();
+    m_freeSlots.reserve(OS_MAX_TASKS);
+    for (int slot = OS_MAX_TASKS - 1; slot >= 0; slot--) {
+        m_freeSlots.push_back((uint8_t)slot);
+    }
+    m_deadlineHeap.reserve(OS_MAX_TASKS * 2);
+    for (auto& list : m_readyLists) {
+        list.reserve(OS_MAX_TASKS);
+    }
+    m_activeTasks = 0;
+
+    if (m_workerPool.initialize() != OS_OK) {
+        ESP_LOGW(TAG, "Worker pool unavailable, async jobs will run inline");
+    }
+
     m_lastUpdateTime = millis();
     m_initialized = true;
 
@@ -29,9 +49,17 @@ os_error_t TaskScheduler::shutdown() {
     }
 
     ESP_LOGI(TAG, "Shutting down Task Scheduler");
-    
+
+    m_workerPool.shutdown();
+
     // Cancel all tasks
     m_tasks.clear();
+    m_freeSlots.clear();
+    m_deadlineHeap.clear();
+    for (auto& list : m_readyLists) {
+        list.clear();
+    }
+    m_activeTasks = 0;
     m_initialized = false;
 
     ESP_LOGI(TAG, "Task Scheduler shutdown complete");
@@ -45,31 +73,44 @@ os_error_t TaskScheduler::update(uint32_t deltaTime) {
 
     uint32_t currentTime = millis();
     uint32_t frameStartTime = currentTime;
+    bool budgetExceeded = false;
+
+    // Pull everything that is due off the deadline heap
+    collectDueTasks(currentTime);
 
-    // Sort tasks by priority (higher priority first)
-    std::sort(m_tasks.begin(), m_tasks.end(), 
-              [](const Task& a, const Task& b) {
-                  if (a.priority != b.priority) {
-                      return a.priority > b.priority;
-                  }
-                  return a.nextExecution < b.nextExecution;
-              });
-
-    // Execute ready tasks
-    for (auto& task : m_tasks) {
-        if (task.state == TaskState::READY && currentTime >= task.nextExecution) {
+    // Execute ready tasks, higher priority first
+    for (int priority = OS_TASK_PRIORITY_HIGH; priority >= 0 && !budgetExceeded; priority--) {
+        auto& ready = m_readyLists[priority];
+        size_t consumed = 0;
+
+        while (consumed < ready.size()) {
+            DeadlineEntry entry = ready[consumed++];
+            if (!isEntryLive(entry)) {
+                continue;
+            }
+
+            Task& task = m_tasks[entry.slot];
             executeTask(task);
-            
+
+            // Clean up completed one-shot tasks
+            if (task.state == TaskState::COMPLETED && task.autoDelete) {
+                releaseSlot(entry.slot);
+            }
+
             // Check if we've exceeded our frame budget
             uint32_t frameTime = millis() - frameStartTime;
             if (frameTime > 16) { // ~60fps budget
+                budgetExceeded = true;
                 break;
             }
         }
+
+        // Anything left over stays ready for the next update
+        ready.erase(ready.begin(), ready.begin() + consumed);
     }
 
-    // Clean up completed tasks
-    cleanupTasks();
+    // Run completion callbacks of finished background jobs
+    m_workerPool.dispatchCompletions();
 
     // Update statistics
     updateCPULoad();
@@ -77,9 +118,34 @@ os_error_t TaskScheduler::update(uint32_t deltaTime) {
     return OS_OK;
 }
 
-uint32_t TaskScheduler::scheduleOnce(TaskFunction function, uint8_t priority, 
+uint32_t TaskScheduler::getTimeUntilNextTask() {
+    if (!m_initialized) {
+        return UINT32_MAX;
+    }
+
+    for (const auto& ready : m_readyLists) {
+        if (!ready.empty()) {
+            return 0;
+        }
+    }
+
+    // Discard stale entries sitting at the top of the heap
+    while (!m_deadlineHeap.empty() && !isEntryLive(m_deadlineHeap.front())) {
+        std::pop_heap(m_deadlineHeap.begin(), m_deadlineHeap.end(), entryLater);
+        m_deadlineHeap.pop_back();
+    }
+
+    if (m_deadlineHeap.empty()) {
+        return UINT32_MAX;
+    }
+
+    int32_t remaining = (int32_t)(m_deadlineHeap.front().deadline - millis());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+uint32_t TaskScheduler::scheduleOnce(TaskFunction function, uint8_t priority,
                                     uint32_t delay, const char* name) {
-    if (!m_initialized || !function || m_tasks.size() >= OS_MAX_TASKS) {
+    if (!m_initialized || !function || m_freeSlots.empty()) {
         return 0;
     }
 
@@ -96,19 +162,19 @@ uint32_t TaskScheduler::scheduleOnce(TaskFunction function, uint8_t priority,
     task.name = name;
     task.autoDelete = true;
 
-    m_tasks.push_back(task);
+    uint32_t taskId = insertTask(task);
 
     #if OS_DEBUG_ENABLED >= 2
-    ESP_LOGD(TAG, "Scheduled one-shot task %d '%s' (priority %d, delay %d ms)", 
-            task.id, name ? name : "unnamed", priority, delay);
+    ESP_LOGD(TAG, "Scheduled one-shot task %d '%s' (priority %d, delay %d ms)",
+            taskId, name ? name : "unnamed", priority, delay);
     #endif
 
-    return task.id;
+    return taskId;
 }
 
-uint32_t TaskScheduler::schedulePeriodic(TaskFunction function, uint32_t period, 
+uint32_t TaskScheduler::schedulePeriodic(TaskFunction function, uint32_t period,
                                         uint8_t priority, uint32_t delay, const char* name) {
-    if (!m_initialized || !function || period == 0 || m_tasks.size() >= OS_MAX_TASKS) {
+    if (!m_initialized || !function || period == 0 || m_freeSlots.empty()) {
         return 0;
     }
 
@@ -125,34 +191,67 @@ uint32_t TaskScheduler::schedulePeriodic(TaskFunction function, uint32_t period,
     task.name = name;
     task.autoDelete = false;
 
-    m_tasks.push_back(task);
+    uint32_t taskId = insertTask(task);
 
     #if OS_DEBUG_ENABLED >= 2
-    ESP_LOGD(TAG, "Scheduled periodic task %d '%s' (priority %d, period %d ms, delay %d ms)", 
-            task.id, name ? name : "unnamed", priority, period, delay);
+    ESP_LOGD(TAG, "Scheduled periodic task %d '%s' (priority %d, period %d ms, delay %d ms)",
+            taskId, name ? name : "unnamed", priority, period, delay);
     #endif
 
-    return task.id;
+    return taskId;
+}
+
+uint32_t TaskScheduler::scheduleAsync(TaskFunction job, TaskFunction onComplete,
+                                     const char* name) {
+    return scheduleOnCore(job, WorkerPool::ANY_CORE, onComplete, name);
+}
+
+uint32_t TaskScheduler::scheduleOnCore(TaskFunction job, int core, TaskFunction onComplete,
+                                      const char* name) {
+    if (!m_initialized || !job) {
+        return 0;
+    }
+
+    uint32_t jobId = m_workerPool.submit(job, onComplete, core, name);
+    if (jobId == 0 && m_workerPool.getWorkerCount() == 0) {
+        // No workers: fall back to the main loop so callers still make progress
+        return scheduleOnce([job, onComplete]() {
+            job();
+            if (onComplete) {
+                onComplete();
+            }
+        }, OS_TASK_PRIORITY_LOW, 0, name);
+    }
+    return jobId;
 }
 
 bool TaskScheduler::cancelTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end()) {
-        #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Cancelled task %d '%s'", taskId, it->name ? it->name : "unnamed");
-        #endif
-        m_tasks.erase(it);
-        return true;
+    int slot = findSlot(taskId);
+    if (slot < 0) {
+        return false;
     }
-    return false;
+
+    Task& task = m_tasks[slot];
+    #if OS_DEBUG_ENABLED >= 2
+    ESP_LOGD(TAG, "Cancelled task %d '%s'", taskId, task.name ? task.name : "unnamed");
+    #endif
+
+    if (task.state == TaskState::RUNNING) {
+        // A task cancelling itself: let executeTask finish before freeing the slot
+        task.period = 0;
+        task.autoDelete = true;
+    } else {
+        releaseSlot((uint8_t)slot);
+    }
+    return true;
 }
 
 bool TaskScheduler::suspendTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end() && it->state != TaskState::SUSPENDED) {
-        it->state = TaskState::SUSPENDED;
+    int slot = findSlot(taskId);
+    if (slot >= 0 && m_tasks[slot].state != TaskState::SUSPENDED) {
+        m_tasks[slot].state = TaskState::SUSPENDED;
         #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Suspended task %d '%s'", taskId, it->name ? it->name : "unnamed");
+        ESP_LOGD(TAG, "Suspended task %d '%s'", taskId, m_tasks[slot].name ? m_tasks[slot].name : "unnamed");
         #endif
         return true;
     }
@@ -160,11 +259,12 @@ bool TaskScheduler::suspendTask(uint32_t taskId) {
 }
 
 bool TaskScheduler::resumeTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end() && it->state == TaskState::SUSPENDED) {
-        it->state = TaskState::READY;
+    int slot = findSlot(taskId);
+    if (slot >= 0 && m_tasks[slot].state == TaskState::SUSPENDED) {
+        m_tasks[slot].state = TaskState::READY;
+        pushDeadline((uint8_t)slot);
         #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Resumed task %d '%s'", taskId, it->name ? it->name : "unnamed");
+        ESP_LOGD(TAG, "Resumed task %d '%s'", taskId, m_tasks[slot].name ? m_tasks[slot].name : "unnamed");
         #endif
         return true;
     }
@@ -172,20 +272,25 @@ bool TaskScheduler::resumeTask(uint32_t taskId) {
 }
 
 const Task* TaskScheduler::getTaskInfo(uint32_t taskId) const {
-    auto it = std::find_if(m_tasks.begin(), m_tasks.end(),
-                          [taskId](const Task& task) { return task.id == taskId; });
-    return (it != m_tasks.end()) ? &(*it) : nullptr;
+    int slot = findSlot(taskId);
+    return (slot >= 0) ? &m_tasks[slot] : nullptr;
 }
 
 void TaskScheduler::printStats() const {
     ESP_LOGI(TAG, "=== Task Scheduler Statistics ===");
-    ESP_LOGI(TAG, "Active tasks: %d/%d", m_tasks.size(), OS_MAX_TASKS);
+    ESP_LOGI(TAG, "Active tasks: %d/%d", m_activeTasks, OS_MAX_TASKS);
+    ESP_LOGI(TAG, "Deadline heap entries: %d", m_deadlineHeap.size());
     ESP_LOGI(TAG, "CPU load: %d%%", m_cpuLoad);
     ESP_LOGI(TAG, "Tasks executed: %d", m_tasksExecuted);
     ESP_LOGI(TAG, "Tasks with overrun: %d", m_tasksOverrun);
+    m_workerPool.printStats();
 
     ESP_LOGI(TAG, "=== Active Tasks ===");
     for (const auto& task : m_tasks) {
+        if (task.id == 0) {
+            continue;
+        }
+
         const char* stateStr = "UNKNOWN";
         switch (task.state) {
             case TaskState::READY: stateStr = "READY"; break;
@@ -202,9 +307,96 @@ void TaskScheduler::printStats() const {
     }
 }
 
-std::vector<Task>::iterator TaskScheduler::findTask(uint32_t taskId) {
-    return std::find_if(m_tasks.begin(), m_tasks.end(),
-                       [taskId](const Task& task) { return task.id == taskId; });
+bool TaskScheduler::entryLater(const DeadlineEntry& a, const DeadlineEntry& b) {
+    return laterDeadline(a.deadline, b.deadline);
+}
+
+int TaskScheduler::findSlot(uint32_t taskId) const {
+    if (taskId == 0) {
+        return -1;
+    }
+    for (size_t slot = 0; slot < m_tasks.size(); slot++) {
+        if (m_tasks[slot].id == taskId) {
+            return (int)slot;
+        }
+    }
+    return -1;
+}
+
+uint32_t TaskScheduler::insertTask(const Task& task) {
+    if (m_freeSlots.empty()) {
+        return 0;
+    }
+
+    uint8_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    // The sequence belongs to the slot, not the task: entries a cancelled
+    // task left in the heap must stay stale for the slot's next owner
+    uint32_t seq = m_tasks[slot].scheduleSeq;
+    m_tasks[slot] = task;
+    m_tasks[slot].scheduleSeq = seq;
+    m_activeTasks++;
+    pushDeadline(slot);
+    return task.id;
+}
+
+void TaskScheduler::releaseSlot(uint8_t slot) {
+    Task& task = m_tasks[slot];
+    if (task.id == 0) {
+        return;
+    }
+
+    // Heap and ready-list entries for this slot become stale via the id check
+    task.id = 0;
+    task.function = nullptr;
+    task.state = TaskState::COMPLETED;
+    m_freeSlots.push_back(slot);
+    m_activeTasks--;
+}
+
+void TaskScheduler::pushDeadline(uint8_t slot) {
+    Task& task = m_tasks[slot];
+    task.scheduleSeq++;
+
+    if (m_deadlineHeap.size() >= OS_MAX_TASKS * 2) {
+        compactHeap();
+    }
+
+    m_deadlineHeap.push_back({task.nextExecution, task.scheduleSeq, slot});
+    std::push_heap(m_deadlineHeap.begin(), m_deadlineHeap.end(), entryLater);
+}
+
+bool TaskScheduler::isEntryLive(const DeadlineEntry& entry) const {
+    const Task& task = m_tasks[entry.slot];
+    return task.id != 0 && task.scheduleSeq == entry.seq && task.state == TaskState::READY;
+}
+
+void TaskScheduler::collectDueTasks(uint32_t now) {
+    while (!m_deadlineHeap.empty()) {
+        const DeadlineEntry& top = m_deadlineHeap.front();
+        bool live = isEntryLive(top);
+        if (live && laterDeadline(top.deadline, now)) {
+            break;
+        }
+
+        DeadlineEntry entry = top;
+        std::pop_heap(m_deadlineHeap.begin(), m_deadlineHeap.end(), entryLater);
+        m_deadlineHeap.pop_back();
+
+        if (live) {
+            uint8_t priority = std::min<uint8_t>(m_tasks[entry.slot].priority, OS_TASK_PRIORITY_HIGH);
+            m_readyLists[priority].push_back(entry);
+        }
+    }
+}
+
+void TaskScheduler::compactHeap() {
+    m_deadlineHeap.erase(
+        std::remove_if(m_deadlineHeap.begin(), m_deadlineHeap.end(),
+                      [this](const DeadlineEntry& entry) { return !isEntryLive(entry); }),
+        m_deadlineHeap.end());
+    std::make_heap(m_deadlineHeap.begin(), m_deadlineHeap.end(), entryLater);
 }
 
 void TaskScheduler::executeTask(Task& task) {
@@ -219,7 +411,7 @@ void TaskScheduler::executeTask(Task& task) {
         task.function();
         m_tasksExecuted++;
     } catch (...) {
-        ESP_LOGE(TAG, "Task %d '%s' threw an exception", 
+        ESP_LOGE(TAG, "Task %d '%s' threw an exception",
                 task.id, task.name ? task.name : "unnamed");
     }
 
@@ -233,15 +425,18 @@ void TaskScheduler::executeTask(Task& task) {
     // Check for overrun
     if (executionTime > task.maxRunTime) {
         m_tasksOverrun++;
-        ESP_LOGW(TAG, "Task %d '%s' overran: %d ms > %d ms limit", 
-                task.id, task.name ? task.name : "unnamed", 
+        ESP_LOGW(TAG, "Task %d '%s' overran: %d ms > %d ms limit",
+                task.id, task.name ? task.name : "unnamed",
                 executionTime, task.maxRunTime);
     }
 
     // Schedule next execution for periodic tasks
     if (task.period > 0) {
         task.nextExecution = endTime + task.period;
-        task.state = TaskState::READY;
+        if (task.state == TaskState::RUNNING) {
+            task.state = TaskState::READY;
+            pushDeadline((uint8_t)(&task - m_tasks.data()));
+        }
     } else {
         // One-shot task completed
         task.state = TaskState::COMPLETED;
@@ -251,7 +446,7 @@ void TaskScheduler::executeTask(Task& task) {
     m_totalExecutionTime += executionTime;
 
     #if OS_DEBUG_ENABLED >= 3
-    ESP_LOGD(TAG, "Executed task %d '%s' in %d ms", 
+    ESP_LOGD(TAG, "Executed task %d '%s' in %d ms",
             task.id, task.name ? task.name : "unnamed", executionTime);
     #endif
 }
@@ -259,21 +454,12 @@ void TaskScheduler::executeTask(Task& task) {
 void TaskScheduler::updateCPULoad() {
     uint32_t currentTime = millis();
     uint32_t elapsed = currentTime - m_lastUpdateTime;
-    
+
     if (elapsed >= 1000) { // Update every second
         m_cpuLoad = (m_totalExecutionTime * 100) / elapsed;
         if (m_cpuLoad > 100) m_cpuLoad = 100;
-        
+
         m_totalExecutionTime = 0;
         m_lastUpdateTime = currentTime;
     }
 }
-
-void TaskScheduler::cleanupTasks() {
-    m_tasks.erase(
-        std::remove_if(m_tasks.begin(), m_tasks.end(),
-                      [](const Task& task) {
-                          return task.state == TaskState::COMPLETED && task.autoDelete;
-                      }),
-        m_tasks.end());
-}
\ No newline at end of file
@@ -2,9 +2,9 @@
 #define TASK_SCHEDULER_H
 
 #include "os_config.h"
+#include "worker_pool.h"
 #include <functional>
 #include <vector>
-#include <queue>
 
 /**
  * @file task_scheduler.h
@@ -12,6 +12,14 @@
  * 
  * Provides cooperative multitasking with priority-based scheduling,
  * periodic tasks, and deferred execution capabilities.
+ *
+ * Pending tasks are kept in a min-heap keyed on nextExecution so an
+ * update only touches tasks that are actually due. Due tasks are moved
+ * to per-priority ready lists and run highest priority first.
+ *
+ * CPU-heavy jobs can be posted to the pinned WorkerPool with
+ * scheduleAsync()/scheduleOnCore(); their completion callbacks are
+ * run from update() on the main loop.
  */
 
 typedef std::function<void()> TaskFunction;
@@ -36,6 +44,7 @@ struct Task {
     uint32_t executionCount;
     const char* name;
     bool autoDelete;
+    uint32_t scheduleSeq;  // Per-slot, bumped on every (re)schedule to invalidate stale heap entries
 };
 
 class TaskScheduler {
@@ -86,6 +95,33 @@ public:
                              uint8_t priority = OS_TASK_PRIORITY_NORMAL,
                              uint32_t delay = 0, const char* name = nullptr);
 
+    /**
+     * @brief Run a job on a background worker
+     * @param job Function to run off the main loop
+     * @param onComplete Optional callback run on the main loop when done
+     * @param name Optional job name for debugging
+     * @return Job ID or 0 on failure
+     */
+    uint32_t scheduleAsync(TaskFunction job, TaskFunction onComplete = nullptr,
+                          const char* name = nullptr);
+
+    /**
+     * @brief Run a job on the worker pinned to a specific core
+     * @param job Function to run off the main loop
+     * @param core Core ID (0 or 1)
+     * @param onComplete Optional callback run on the main loop when done
+     * @param name Optional job name for debugging
+     * @return Job ID or 0 on failure
+     */
+    uint32_t scheduleOnCore(TaskFunction job, int core, TaskFunction onComplete = nullptr,
+                           const char* name = nullptr);
+
+    /**
+     * @brief Get the background worker pool
+     * @return Worker pool reference
+     */
+    WorkerPool& getWorkerPool() { return m_workerPool; }
+
     /**
      * @brief Cancel a scheduled task
      * @param taskId Task ID to cancel
@@ -118,7 +154,14 @@ public:
      * @brief Get number of active tasks
      * @return Number of active tasks
      */
-    size_t getActiveTaskCount() const { return m_tasks.size(); }
+    size_t getActiveTaskCount() const { return m_activeTasks; }
+
+    /**
+     * @brief Get time until the next task becomes due
+     * @return Milliseconds until the earliest deadline, 0 if a task is
+     *         already due, UINT32_MAX if nothing is scheduled
+     */
+    uint32_t getTimeUntilNextTask();
 
     /**
      * @brief Get CPU load percentage
@@ -139,11 +182,62 @@ public:
 
 private:
     /**
-     * @brief Find task by ID
+     * @brief Heap / ready list entry referencing a task slot
+     */
+    struct DeadlineEntry {
+        uint32_t deadline;
+        uint32_t seq;
+        uint8_t slot;
+    };
+
+    /**
+     * @brief Heap ordering: true if a is due after b
+     */
+    static bool entryLater(const DeadlineEntry& a, const DeadlineEntry& b);
+
+    /**
+     * @brief Find task slot by ID
      * @param taskId Task ID to find
-     * @return Iterator to task or end() if not found
+     * @return Slot index or -1 if not found
+     */
+    int findSlot(uint32_t taskId) const;
+
+    /**
+     * @brief Place a new task into a free slot and schedule it
+     * @param task Task to insert
+     * @return Task ID or 0 if no slot is free
+     */
+    uint32_t insertTask(const Task& task);
+
+    /**
+     * @brief Free a task slot
+     * @param slot Slot index to release
+     */
+    void releaseSlot(uint8_t slot);
+
+    /**
+     * @brief Push a task's current deadline onto the heap
+     * @param slot Slot index of the task
+     */
+    void pushDeadline(uint8_t slot);
+
+    /**
+     * @brief Check whether a heap entry still refers to a schedulable task
+     * @param entry Entry to check
+     * @return true if the entry is current
      */
-    std::vector<Task>::iterator findTask(uint32_t taskId);
+    bool isEntryLive(const DeadlineEntry& entry) const;
+
+    /**
+     * @brief Move all due tasks from the heap to the ready lists
+     * @param now Current time in milliseconds
+     */
+    void collectDueTasks(uint32_t now);
+
+    /**
+     * @brief Drop stale entries once the heap grows past its bound
+     */
+    void compactHeap();
 
     /**
      * @brief Execute a single task
@@ -156,19 +250,21 @@ private:
      */
     void updateCPULoad();
 
-    /**
-     * @brief Clean up completed tasks
-     */
-    void cleanupTasks();
-
     /**
      * @brief Generate unique task ID
      * @return Unique task ID
      */
     uint32_t generateTaskId() { return ++m_nextTaskId; }
 
-    // Task management
+    // Task management (fixed slots, id 0 marks a free slot)
     std::vector<Task> m_tasks;
+    std::vector<uint8_t> m_freeSlots;
+    std::vector<DeadlineEntry> m_deadlineHeap;
+    std::vector<DeadlineEntry> m_readyLists[OS_TASK_PRIORITY_HIGH + 1];
+    size_t m_activeTasks = 0;
+
+    // Background workers
+    WorkerPool m_workerPool;
     uint32_t m_nextTaskId = 0;
     uint32_t m_defaultMaxRunTime = 50; // 50ms default max run time
 
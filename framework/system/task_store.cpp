@@ -0,0 +1,471 @@
+#include "task_store.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <unistd.h>
+
+static const char* TAG = "TaskStore";
+
+static constexpr uint32_t FILE_MAGIC = 0x314B5354;     // "TSK1"
+static constexpr uint16_t FILE_VERSION = 1;
+static constexpr size_t FIELD_COUNT = 3;
+static constexpr size_t MAX_FIELD_LENGTH = UINT16_MAX;
+static constexpr size_t IO_BUFFER = 4096;
+
+static constexpr uint8_t RECORD_PUT = 1;
+static constexpr uint8_t RECORD_DELETE = 2;
+
+struct TaskLogHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t nextId;                    // As of the last rewrite; replay may raise it
+};
+
+struct TaskLogRecord {
+    uint32_t id;
+    uint8_t type;
+    uint8_t priority;
+    uint8_t status;
+    uint8_t hasReminder;
+    int64_t dueDate;
+    int64_t createdDate;
+    int64_t completedDate;
+    int64_t reminderTime;
+    uint16_t lengths[FIELD_COUNT];      // title, description, category; 0 for a deletion
+    uint16_t reserved;
+};
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Field order on disk
+static const std::string* fieldsOf(const AppTask& task, size_t index) {
+    const std::string* fields[FIELD_COUNT] = {&task.title, &task.description, &task.category};
+    return fields[index];
+}
+
+static std::string* fieldsOf(AppTask& task, size_t index) {
+    return const_cast<std::string*>(fieldsOf(static_cast<const AppTask&>(task), index));
+}
+
+// Record, field bytes, then the checksum of both
+static void encodeRecord(std::vector<uint8_t>& out, uint8_t type, const AppTask& task) {
+    TaskLogRecord record = {};
+    record.id = task.id;
+    record.type = type;
+    if (type == RECORD_PUT) {
+        record.priority = (uint8_t)task.priority;
+        record.status = (uint8_t)task.status;
+        record.hasReminder = task.hasReminder ? 1 : 0;
+        record.dueDate = task.dueDate;
+        record.createdDate = task.createdDate;
+        record.completedDate = task.completedDate;
+        record.reminderTime = task.reminderTime;
+        for (size_t f = 0; f < FIELD_COUNT; f++) {
+            record.lengths[f] = (uint16_t)std::min(fieldsOf(task, f)->size(), MAX_FIELD_LENGTH);
+        }
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    out.insert(out.end(), bytes, bytes + sizeof(record));
+    uint32_t checksum = fnv1a(2166136261u, &record, sizeof(record));
+    for (size_t f = 0; f < FIELD_COUNT; f++) {
+        const std::string* field = fieldsOf(task, f);
+        out.insert(out.end(), field->data(), field->data() + record.lengths[f]);
+        checksum = fnv1a(checksum, field->data(), record.lengths[f]);
+    }
+    bytes = reinterpret_cast<const uint8_t*>(&checksum);
+    out.insert(out.end(), bytes, bytes + sizeof(checksum));
+}
+
+os_error_t TaskStore::load(const char* path) {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    m_path = path;
+
+    // The temporary file only outlives a rewrite cut off after the old log
+    // was removed; next to a log it is an unfinished rewrite
+    int64_t start = esp_timer_get_time();
+    std::string temp = m_path + ".tmp";
+    os_error_t ret = readLog(m_path.c_str());
+    if (ret == OS_ERROR_NOT_FOUND && readLog(temp.c_str()) == OS_OK) {
+        ESP_LOGW(TAG, "Recovered tasks from an interrupted rewrite");
+        ::rename(temp.c_str(), m_path.c_str());
+        ret = OS_OK;
+    } else {
+        ::remove(temp.c_str());
+    }
+    m_pending.clear();
+    m_pendingRecords = 0;
+    m_rewrite = ret == OS_ERROR_FILESYSTEM;     // Appending after a damaged header would be lost
+    buildOrders();
+    m_loadMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+    if (ret == OS_OK) {
+        ESP_LOGI(TAG, "Loaded %d tasks from %d log records in %d ms", m_tasks.size(), m_logRecords, m_loadMs);
+    }
+    return ret;
+}
+
+os_error_t TaskStore::readLog(const char* path) {
+    m_tasks.clear();
+    m_nextId = 1;
+    m_logRecords = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return OS_ERROR_NOT_FOUND;
+    }
+    setvbuf(file, nullptr, _IOFBF, IO_BUFFER);
+
+    TaskLogHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != FILE_MAGIC ||
+        header.version != FILE_VERSION) {
+        ESP_LOGE(TAG, "%s is not a task log", path);
+        fclose(file);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    // Replay until the end or the first record that does not check out
+    long good = ftell(file);
+    uint32_t maxId = 0;
+    TaskLogRecord record;
+    AppTask task;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        uint32_t checksum = fnv1a(2166136261u, &record, sizeof(record));
+        bool ok = record.type == RECORD_PUT || record.type == RECORD_DELETE;
+        for (size_t f = 0; f < FIELD_COUNT && ok; f++) {
+            std::string* field = fieldsOf(task, f);
+            field->resize(record.lengths[f]);
+            ok = record.lengths[f] == 0 || fread(&(*field)[0], 1, record.lengths[f], file) == record.lengths[f];
+            checksum = fnv1a(checksum, field->data(), field->size());
+        }
+        uint32_t stored = 0;
+        if (!ok || fread(&stored, sizeof(stored), 1, file) != 1 || stored != checksum) {
+            break;
+        }
+        good = ftell(file);
+        m_logRecords++;
+        maxId = std::max(maxId, record.id);
+
+        auto it = std::lower_bound(m_tasks.begin(), m_tasks.end(), record.id,
+                                   [](const AppTask& t, uint32_t value) { return t.id < value; });
+        bool exists = it != m_tasks.end() && it->id == record.id;
+        if (record.type == RECORD_DELETE) {
+            if (exists) {
+                m_tasks.erase(it);
+            }
+            continue;
+        }
+        task.id = record.id;
+        task.priority = (TaskPriority)record.priority;
+        task.status = (TaskStatus)record.status;
+        task.hasReminder = record.hasReminder != 0;
+        task.dueDate = (time_t)record.dueDate;
+        task.createdDate = (time_t)record.createdDate;
+        task.completedDate = (time_t)record.completedDate;
+        task.reminderTime = (time_t)record.reminderTime;
+        if (exists) {
+            *it = task;
+        } else {
+            m_tasks.insert(it, task);
+        }
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+
+    // A torn tail would hide every record appended after it
+    if (good < size) {
+        ESP_LOGW(TAG, "Cutting torn task log at %ld of %ld bytes", good, size);
+        truncate(path, good);
+    }
+
+    // Deleted IDs count too, so they are never handed out again
+    m_nextId = std::max(header.nextId, maxId + 1);
+    return OS_OK;
+}
+
+os_error_t TaskStore::save() {
+    if (m_pendingRecords == 0) {
+        return OS_OK;
+    }
+    if (m_path.empty()) {
+        return OS_ERROR_NOT_AVAILABLE;
+    }
+    if (m_rewrite || m_logRecords + m_pendingRecords > m_tasks.size() + OS_TASKS_COMPACT_SLACK) {
+        return compact();
+    }
+
+    int64_t start = esp_timer_get_time();
+    FILE* file = fopen(m_path.c_str(), "ab");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to open %s", m_path.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    fseek(file, 0, SEEK_END);
+    long before = ftell(file);
+
+    bool ok = true;
+    if (before == 0) {
+        TaskLogHeader header = {FILE_MAGIC, FILE_VERSION, 0, m_nextId};
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    ok = ok && fwrite(m_pending.data(), 1, m_pending.size(), file) == m_pending.size();
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+
+    // Keep the log ending on a whole record so a retry appends after it
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to append to %s", m_path.c_str());
+        truncate(m_path.c_str(), before);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_logRecords += m_pendingRecords;
+    m_pending.clear();
+    m_pendingRecords = 0;
+    m_saveMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    return OS_OK;
+}
+
+os_error_t TaskStore::compact() {
+    int64_t start = esp_timer_get_time();
+    std::string temp = m_path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to create %s", temp.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+    setvbuf(file, nullptr, _IOFBF, IO_BUFFER);
+
+    TaskLogHeader header = {FILE_MAGIC, FILE_VERSION, 0, m_nextId};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    std::vector<uint8_t> buffer;
+    for (const AppTask& task : m_tasks) {
+        buffer.clear();
+        encodeRecord(buffer, RECORD_PUT, task);
+        ok = ok && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    }
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+
+    // FAT cannot rename over an existing file; load() covers the gap
+    if (ok) {
+        ::remove(m_path.c_str());
+        ok = ::rename(temp.c_str(), m_path.c_str()) == 0;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to rewrite %s", m_path.c_str());
+        ::remove(temp.c_str());
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    m_logRecords = m_tasks.size();
+    m_rewrite = false;
+    m_pending.clear();
+    m_pendingRecords = 0;
+    m_compactions++;
+    m_saveMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    ESP_LOGD(TAG, "Rewrote task log with %d records in %d ms", m_logRecords, m_saveMs);
+    return OS_OK;
+}
+
+uint32_t TaskStore::add(const AppTask& task, TaskViewChange& change) {
+    change = TaskViewChange();
+    AppTask record = task;
+    record.id = m_nextId++;
+    m_tasks.push_back(std::move(record));
+    linkTask((uint32_t)m_tasks.size() - 1, change);
+    appendRecord(RECORD_PUT, m_tasks.back());
+    return m_tasks.back().id;
+}
+
+bool TaskStore::update(uint32_t id, const AppTask& task, TaskViewChange& change) {
+    change = TaskViewChange();
+    size_t position = positionOf(id);
+    if (position == m_tasks.size()) {
+        return false;
+    }
+    unlinkTask((uint32_t)position, change);
+    m_tasks[position] = task;
+    m_tasks[position].id = id;
+    linkTask((uint32_t)position, change);
+    appendRecord(RECORD_PUT, m_tasks[position]);
+    return true;
+}
+
+bool TaskStore::remove(uint32_t id, TaskViewChange& change) {
+    change = TaskViewChange();
+    size_t position = positionOf(id);
+    if (position == m_tasks.size()) {
+        return false;
+    }
+    unlinkTask((uint32_t)position, change);
+    appendRecord(RECORD_DELETE, m_tasks[position]);
+    m_tasks.erase(m_tasks.begin() + position);
+
+    // Later tasks moved down one place
+    for (Order& order : m_orders) {
+        for (uint32_t& p : order) {
+            p -= p > position ? 1 : 0;
+        }
+    }
+    for (uint32_t& p : m_visible) {
+        p -= p > position ? 1 : 0;
+    }
+    return true;
+}
+
+const AppTask* TaskStore::find(uint32_t id) const {
+    size_t position = positionOf(id);
+    return position < m_tasks.size() ? &m_tasks[position] : nullptr;
+}
+
+void TaskStore::setView(TaskSort sort, const TaskFilter& filter) {
+    m_sort = sort < TaskSort::COUNT ? sort : TaskSort::DUE_DATE;
+    m_filter = filter;
+    const Order& order = m_orders[(size_t)m_sort];
+    m_visible.clear();
+    m_visible.reserve(order.size());
+    for (uint32_t position : order) {
+        if (matches(m_tasks[position])) {
+            m_visible.push_back(position);
+        }
+    }
+}
+
+int TaskStore::getViewRow(uint32_t id) const {
+    size_t position = positionOf(id);
+    if (position == m_tasks.size() || !matches(m_tasks[position])) {
+        return -1;
+    }
+    size_t row = lowerBound(m_visible, m_sort, m_tasks[position]);
+    return row < m_visible.size() && m_visible[row] == position ? (int)row : -1;
+}
+
+void TaskStore::printStats(const char* tag) const {
+    ESP_LOGI(tag, "Tasks: %d (%d in view), log %d records + %d unsaved, %d rewrites",
+             m_tasks.size(), m_visible.size(), m_logRecords, m_pendingRecords, m_compactions);
+    ESP_LOGI(tag, "Load %d ms, last save %d ms", m_loadMs, m_saveMs);
+}
+
+bool TaskStore::before(TaskSort sort, const AppTask& a, const AppTask& b) {
+    switch (sort) {
+        case TaskSort::DUE_DATE:
+            if ((a.dueDate == 0) != (b.dueDate == 0)) {
+                return b.dueDate == 0;
+            }
+            if (a.dueDate != b.dueDate) {
+                return a.dueDate < b.dueDate;
+            }
+            if (a.dueDate == 0 && a.createdDate != b.createdDate) {
+                return a.createdDate > b.createdDate;
+            }
+            break;
+        case TaskSort::PRIORITY:
+            if (a.priority != b.priority) {
+                return a.priority > b.priority;
+            }
+            break;
+        case TaskSort::CREATED:
+            if (a.createdDate != b.createdDate) {
+                return a.createdDate > b.createdDate;
+            }
+            break;
+        case TaskSort::TITLE: {
+            int order = a.title.compare(b.title);
+            if (order != 0) {
+                return order < 0;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Ties go by ID so every order is total and a task can be found in it
+    return a.id < b.id;
+}
+
+bool TaskStore::matches(const AppTask& task) const {
+    if (m_filter.status >= 0 && (int)task.status != m_filter.status) {
+        return false;
+    }
+    if (m_filter.priority >= 0 && (int)task.priority != m_filter.priority) {
+        return false;
+    }
+    return m_filter.showCompleted || task.status != TaskStatus::COMPLETED;
+}
+
+size_t TaskStore::positionOf(uint32_t id) const {
+    auto it = std::lower_bound(m_tasks.begin(), m_tasks.end(), id,
+                               [](const AppTask& task, uint32_t value) { return task.id < value; });
+    return it != m_tasks.end() && it->id == id ? (size_t)(it - m_tasks.begin()) : m_tasks.size();
+}
+
+size_t TaskStore::lowerBound(const Order& order, TaskSort sort, const AppTask& task) const {
+    auto it = std::lower_bound(order.begin(), order.end(), task, [&](uint32_t position, const AppTask& value) {
+        return before(sort, m_tasks[position], value);
+    });
+    return (size_t)(it - order.begin());
+}
+
+void TaskStore::linkTask(uint32_t position, TaskViewChange& change) {
+    const AppTask& task = m_tasks[position];
+    for (size_t s = 0; s < (size_t)TaskSort::COUNT; s++) {
+        Order& order = m_orders[s];
+        order.insert(order.begin() + lowerBound(order, (TaskSort)s, task), position);
+    }
+    if (matches(task)) {
+        size_t row = lowerBound(m_visible, m_sort, task);
+        m_visible.insert(m_visible.begin() + row, position);
+        change.inserted = (int)row;
+    }
+}
+
+void TaskStore::unlinkTask(uint32_t position, TaskViewChange& change) {
+    // Found by the task's current fields, so this comes before they change
+    const AppTask& task = m_tasks[position];
+    for (size_t s = 0; s < (size_t)TaskSort::COUNT; s++) {
+        Order& order = m_orders[s];
+        size_t index = lowerBound(order, (TaskSort)s, task);
+        if (index < order.size() && order[index] == position) {
+            order.erase(order.begin() + index);
+        }
+    }
+    if (matches(task)) {
+        size_t row = lowerBound(m_visible, m_sort, task);
+        if (row < m_visible.size() && m_visible[row] == position) {
+            m_visible.erase(m_visible.begin() + row);
+            change.removed = (int)row;
+        }
+    }
+}
+
+void TaskStore::buildOrders() {
+    for (size_t s = 0; s < (size_t)TaskSort::COUNT; s++) {
+        Order& order = m_orders[s];
+        order.resize(m_tasks.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return before((TaskSort)s, m_tasks[a], m_tasks[b]);
+        });
+    }
+    setView(m_sort, m_filter);
+}
+
+void TaskStore::appendRecord(uint8_t type, const AppTask& task) {
+    encodeRecord(m_pending, type, task);
+    m_pendingRecords++;
+}
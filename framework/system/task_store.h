@@ -0,0 +1,214 @@
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+
+#include "os_config.h"
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * @file task_store.h
+ * @brief Tasks, their sorted views and their change log on the SD card
+ *
+ * Tasks stay sorted by ID (IDs only grow), so lookups are a binary search.
+ * For every sort key the store keeps the task positions in that order,
+ * and the visible view is the active order with the filter applied. All
+ * of them are patched in place on add, update and remove (a binary search
+ * and a move of plain indices), and each change reports the view rows it
+ * removed and inserted so the list only rebinds those.
+ *
+ * The file is a log: a header, then one record per change (the whole task,
+ * or a deletion) with its own checksum. save() appends the records made
+ * since the last save; once superseded records outnumber the tasks by
+ * OS_TASKS_COMPACT_SLACK the log is rewritten with one record per task,
+ * through a temporary file as in ContactStore. load() replays the log and
+ * cuts off a record torn by a power loss.
+ */
+
+enum class TaskPriority {
+    TASK_LOW = 0,
+    TASK_MEDIUM = 1,
+    TASK_HIGH = 2,
+    TASK_URGENT = 3
+};
+
+enum class TaskStatus {
+    TODO = 0,
+    IN_PROGRESS = 1,
+    COMPLETED = 2
+};
+
+struct AppTask {
+    uint32_t id;
+    std::string title;
+    std::string description;
+    TaskPriority priority;
+    TaskStatus status;
+    time_t dueDate;
+    time_t createdDate;
+    time_t completedDate;
+    std::string category;
+    bool hasReminder;
+    time_t reminderTime;
+};
+
+/**
+ * @brief View orders, as listed in the sort dropdown
+ */
+enum class TaskSort : uint8_t {
+    DUE_DATE,       // Soonest first, undated last (newest first among them)
+    PRIORITY,       // Most urgent first
+    CREATED,        // Newest first
+    TITLE,
+    COUNT
+};
+
+struct TaskFilter {
+    int status = -1;                // TaskStatus to keep, -1 for all
+    int priority = -1;              // TaskPriority to keep, -1 for all
+    bool showCompleted = false;
+};
+
+/**
+ * @brief View rows touched by a change; -1 where none
+ *
+ * Rows between the two shifted by one; equal rows mean the task stayed in
+ * place and only that row changed.
+ */
+struct TaskViewChange {
+    int removed = -1;
+    int inserted = -1;
+};
+
+class TaskStore {
+public:
+    TaskStore() = default;
+
+    /**
+     * @brief Replay a task log, replacing the tasks held
+     * @param path Log file path
+     * @return OS_OK on success, OS_ERROR_NOT_FOUND if there is no log yet
+     */
+    os_error_t load(const char* path);
+
+    /**
+     * @brief Append the changes made since the last save to the log
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t save();
+
+    /**
+     * @brief Check for changes not yet saved
+     * @return true if dirty
+     */
+    bool isDirty() const { return m_pendingRecords > 0; }
+
+    /**
+     * @brief Add a task under a new ID
+     * @param task Fields; the ID is ignored
+     * @param change Set to the view row the task went to
+     * @return New ID
+     */
+    uint32_t add(const AppTask& task, TaskViewChange& change);
+
+    /**
+     * @brief Replace a task's fields
+     * @param id Task ID
+     * @param task New fields; the ID is ignored
+     * @param change Set to the view rows the task left and went to
+     * @return true if the task exists
+     */
+    bool update(uint32_t id, const AppTask& task, TaskViewChange& change);
+
+    /**
+     * @brief Delete a task
+     * @param id Task ID
+     * @param change Set to the view row the task left
+     * @return true if the task existed
+     */
+    bool remove(uint32_t id, TaskViewChange& change);
+
+    /**
+     * @brief Look up a task
+     * @param id Task ID
+     * @return Task, or nullptr; valid until the next change
+     */
+    const AppTask* find(uint32_t id) const;
+
+    /**
+     * @brief Get all tasks in ID order
+     * @return Tasks; valid until the next change
+     */
+    const std::vector<AppTask>& getTasks() const { return m_tasks; }
+
+    /**
+     * @brief Choose the order and filter of the visible view
+     * @param sort Sort key
+     * @param filter Filter
+     */
+    void setView(TaskSort sort, const TaskFilter& filter);
+
+    /**
+     * @brief Get the number of tasks in the visible view
+     * @return Row count
+     */
+    size_t getViewSize() const { return m_visible.size(); }
+
+    /**
+     * @brief Get the task shown in a view row
+     * @param row Row index, below getViewSize()
+     * @return Task; valid until the next change
+     */
+    const AppTask& getViewTask(size_t row) const { return m_tasks[m_visible[row]]; }
+
+    /**
+     * @brief Find a task's view row
+     * @param id Task ID
+     * @return Row, or -1 if the task is not in the view
+     */
+    int getViewRow(uint32_t id) const;
+
+    /**
+     * @brief Print store and log statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    typedef std::vector<uint32_t> Order;    // Positions in m_tasks
+
+    static bool before(TaskSort sort, const AppTask& a, const AppTask& b);
+    bool matches(const AppTask& task) const;
+    size_t positionOf(uint32_t id) const;
+    size_t lowerBound(const Order& order, TaskSort sort, const AppTask& task) const;
+    void linkTask(uint32_t position, TaskViewChange& change);
+    void unlinkTask(uint32_t position, TaskViewChange& change);
+    void buildOrders();
+
+    void appendRecord(uint8_t type, const AppTask& task);
+    os_error_t readLog(const char* path);
+    os_error_t compact();
+
+    std::vector<AppTask> m_tasks;       // Sorted by ID
+    uint32_t m_nextId = 1;
+
+    // Views
+    Order m_orders[(size_t)TaskSort::COUNT];
+    Order m_visible;
+    TaskSort m_sort = TaskSort::DUE_DATE;
+    TaskFilter m_filter;
+
+    // Log
+    std::string m_path;
+    std::vector<uint8_t> m_pending;     // Records not yet appended
+    uint32_t m_pendingRecords = 0;
+    uint32_t m_logRecords = 0;          // Records in the file
+    bool m_rewrite = false;             // Next save rewrites the whole log
+
+    // Statistics
+    uint32_t m_loadMs = 0;
+    uint32_t m_saveMs = 0;
+    uint32_t m_compactions = 0;
+};
+
+#endif // TASK_STORE_H
@@ -0,0 +1,700 @@
+#include "thumbnail_service.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+#include <unistd.h>
+
+static const char* TAG = "Thumbnails";
+
+static constexpr uint32_t RECORD_MAGIC = 0x31424D54;   // "TMB1"
+static constexpr size_t THUMB_PIXELS = OS_THUMB_WIDTH * OS_THUMB_HEIGHT;
+
+// Pack record header; the source path and width * height RGB565 pixels follow
+struct PackRecord {
+    uint32_t magic;
+    uint32_t pathHash;
+    uint32_t mtime;
+    uint32_t size;
+    uint16_t width;
+    uint16_t height;
+    uint16_t pathLength;
+    uint16_t reserved;
+    uint32_t checksum;          // Of the pixels
+};
+
+static uint32_t fnv1a(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t alignBytes(size_t bytes) {
+    // Decoder buffers are cache-synced whole; round up to the cache line
+    return (bytes + OS_MEM_DMA_ALIGNMENT - 1) & ~(size_t)(OS_MEM_DMA_ALIGNMENT - 1);
+}
+
+static uint32_t alignUp(uint32_t value, uint32_t step) {
+    return (value + step - 1) / step * step;
+}
+
+/**
+ * @brief Area-average an RGB565 picture down to fit the thumbnail size
+ *
+ * Each output pixel averages up to 8x8 samples spread over its source area,
+ * which is enough to avoid aliasing at these ratios without touching every
+ * pixel of a multi-megapixel picture.
+ */
+static void downscale(const uint8_t* source, uint16_t width, uint16_t height, uint32_t stride,
+                      uint16_t* dest, uint16_t& outWidth, uint16_t& outHeight) {
+    if ((uint32_t)width * OS_THUMB_HEIGHT >= (uint32_t)height * OS_THUMB_WIDTH) {
+        outWidth = std::min<uint16_t>(width, OS_THUMB_WIDTH);
+        outHeight = (uint16_t)std::max<uint32_t>((uint32_t)height * outWidth / width, 1);
+    } else {
+        outHeight = std::min<uint16_t>(height, OS_THUMB_HEIGHT);
+        outWidth = (uint16_t)std::max<uint32_t>((uint32_t)width * outHeight / height, 1);
+    }
+
+    for (uint32_t oy = 0; oy < outHeight; oy++) {
+        uint32_t y0 = oy * height / outHeight;
+        uint32_t y1 = std::max(y0 + 1, (oy + 1) * height / outHeight);
+        uint32_t stepY = std::max<uint32_t>((y1 - y0) / 8, 1);
+        for (uint32_t ox = 0; ox < outWidth; ox++) {
+            uint32_t x0 = ox * width / outWidth;
+            uint32_t x1 = std::max(x0 + 1, (ox + 1) * width / outWidth);
+            uint32_t stepX = std::max<uint32_t>((x1 - x0) / 8, 1);
+
+            uint32_t r = 0, g = 0, b = 0, n = 0;
+            for (uint32_t y = y0; y < y1; y += stepY) {
+                const uint16_t* row = reinterpret_cast<const uint16_t*>(source + y * stride);
+                for (uint32_t x = x0; x < x1; x += stepX) {
+                    uint16_t pixel = row[x];
+                    r += pixel >> 11;
+                    g += (pixel >> 5) & 0x3F;
+                    b += pixel & 0x1F;
+                    n++;
+                }
+            }
+            dest[oy * outWidth + ox] = (uint16_t)(((r / n) << 11) | ((g / n) << 5) | (b / n));
+        }
+    }
+}
+
+/**
+ * @brief Find the JPEG thumbnail in a picture's Exif header (APP1, IFD1)
+ * @param data Start of the file
+ * @param length Bytes available
+ * @param offset Set to the thumbnail's offset in data
+ * @param size Set to the thumbnail's length
+ * @return true if one lies entirely within data
+ */
+static bool findExifThumbnail(const uint8_t* data, size_t length, size_t& offset, size_t& size) {
+    if (length < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;      // Start of scan: the headers are over
+        }
+        size_t segment = ((size_t)data[pos + 2] << 8) | data[pos + 3];
+        if (marker == 0xE1 && segment >= 16 && pos + 2 + segment <= length &&
+            memcmp(data + pos + 4, "Exif\0\0", 6) == 0) {
+            const uint8_t* tiff = data + pos + 10;
+            size_t tiffSize = segment - 8;
+            bool little = tiff[0] == 'I' && tiff[1] == 'I';
+            if (!little && !(tiff[0] == 'M' && tiff[1] == 'M')) {
+                return false;
+            }
+            auto u16 = [&](size_t at) -> uint32_t {
+                return little ? (tiff[at] | (tiff[at + 1] << 8)) : ((tiff[at] << 8) | tiff[at + 1]);
+            };
+            auto u32 = [&](size_t at) -> uint32_t {
+                return little ? (u16(at) | (u16(at + 2) << 16)) : ((u16(at) << 16) | u16(at + 2));
+            };
+
+            // IFD0 links to IFD1, which describes the thumbnail
+            uint32_t ifd0 = u32(4);
+            if ((size_t)ifd0 + 2 > tiffSize) {
+                return false;
+            }
+            size_t next = ifd0 + 2 + u16(ifd0) * 12;
+            if (next + 4 > tiffSize) {
+                return false;
+            }
+            uint32_t ifd1 = u32(next);
+            if (ifd1 == 0 || (size_t)ifd1 + 2 > tiffSize) {
+                return false;
+            }
+            uint32_t count = u16(ifd1);
+            uint32_t thumbOffset = 0;
+            uint32_t thumbSize = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                size_t entry = ifd1 + 2 + i * 12;
+                if (entry + 12 > tiffSize) {
+                    break;
+                }
+                uint32_t tag = u16(entry);
+                if (tag == 0x0201) {            // JPEGInterchangeFormat
+                    thumbOffset = u32(entry + 8);
+                } else if (tag == 0x0202) {     // JPEGInterchangeFormatLength
+                    thumbSize = u32(entry + 8);
+                }
+            }
+            if (thumbOffset == 0 || thumbSize == 0 || (size_t)thumbOffset + thumbSize > tiffSize) {
+                return false;
+            }
+            offset = (size_t)(tiff - data) + thumbOffset;
+            size = thumbSize;
+            return true;
+        }
+        pos += 2 + segment;
+    }
+    return false;
+}
+
+ThumbnailService::~ThumbnailService() {
+    stop();
+}
+
+os_error_t ThumbnailService::start() {
+    if (m_running) {
+        return OS_OK;
+    }
+
+    m_lock = xSemaphoreCreateMutex();
+    m_slotPixels = (uint16_t*)OS_MALLOC_PSRAM(OS_THUMB_CACHE_ENTRIES * THUMB_PIXELS * sizeof(uint16_t));
+    if (!m_lock || !m_slotPixels) {
+        ESP_LOGE(TAG, "Failed to allocate the thumbnail cache");
+        stop();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_slots.resize(OS_THUMB_CACHE_ENTRIES);
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        Slot& slot = m_slots[i];
+        slot.pixels = m_slotPixels + i * THUMB_PIXELS;
+        slot.image.header.cf = LV_IMG_CF_TRUE_COLOR;
+        slot.image.data = reinterpret_cast<const uint8_t*>(slot.pixels);
+    }
+
+    m_stopping = false;
+    m_running = true;
+    if (xTaskCreatePinnedToCore(workerTask, "thumbs", OS_THUMB_TASK_STACK, this,
+                                OS_THUMB_TASK_PRIORITY, &m_task, OS_THUMB_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create thumbnail task");
+        m_task = nullptr;
+        stop();
+        return OS_ERROR_NO_MEMORY;
+    }
+    return OS_OK;
+}
+
+void ThumbnailService::stop() {
+    if (m_task) {
+        m_stopping = true;
+        xTaskNotifyGive(m_task);
+        for (int i = 0; i < 100 && m_task; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Thumbnail task did not stop, deleting it");
+            vTaskDelete(m_task);
+            m_task = nullptr;
+        }
+    }
+
+    // The worker closes these on its way out; only a forced delete leaves them
+    if (m_pack) {
+        fclose(m_pack);
+        m_pack = nullptr;
+    }
+    if (m_decoder) {
+        jpeg_del_decoder_engine(m_decoder);
+        m_decoder = nullptr;
+    }
+    m_packIndex.clear();
+    m_packSize = 0;
+
+    for (auto* jobs : {&m_loads, &m_writes}) {
+        for (Job& job : *jobs) {
+            OS_FREE(job.pixels);
+        }
+        jobs->clear();
+    }
+    for (Job& job : m_ready) {
+        OS_FREE(job.pixels);
+    }
+    m_ready.clear();
+    m_pending.clear();
+
+    m_slots.clear();
+    m_slotIndex.clear();
+    m_failed.clear();
+    if (m_slotPixels) {
+        OS_FREE(m_slotPixels);
+        m_slotPixels = nullptr;
+    }
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+    if (m_running) {
+        m_running = false;
+        m_generation++;
+    }
+}
+
+bool ThumbnailService::isSupported(const char* name) {
+    const char* ext = name ? strrchr(name, '.') : nullptr;
+    return ext && (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0);
+}
+
+const lv_img_dsc_t* ThumbnailService::get(const char* path, uint32_t mtime, uint32_t size) {
+    if (!path || size == 0) {
+        return nullptr;
+    }
+    if (!m_running && start() != OS_OK) {
+        return nullptr;
+    }
+
+    std::string key = path;
+    Slot* slot = findSlot(key, mtime, size);
+    if (slot) {
+        m_hits++;
+        slot->lastUse = ++m_useCounter;
+        return &slot->image;
+    }
+    auto failed = m_failed.find(key);
+    if (failed != m_failed.end() && failed->second == mtime) {
+        return nullptr;
+    }
+
+    bool queued = false;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    if (m_pending.insert(key).second) {
+        // Rows scrolled past long ago make way for the ones on screen now
+        if (m_loads.size() >= OS_THUMB_QUEUE_DEPTH) {
+            m_pending.erase(m_loads.back().path);
+            m_loads.pop_back();
+        }
+        Job job;
+        job.path = key;
+        job.mtime = mtime;
+        job.size = size;
+        m_loads.push_front(std::move(job));
+        queued = true;
+        m_misses++;
+    }
+    xSemaphoreGive(m_lock);
+
+    if (queued) {
+        xTaskNotifyGive(m_task);
+    }
+    return nullptr;
+}
+
+os_error_t ThumbnailService::store(const char* path, uint32_t mtime, uint32_t size, const uint8_t* pixels,
+                                   uint16_t width, uint16_t height, uint32_t stride) {
+    if (!path || !pixels || width == 0 || height == 0 || stride < (uint32_t)width * sizeof(uint16_t)) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    if (!m_running) {
+        os_error_t ret = start();
+        if (ret != OS_OK) {
+            return ret;
+        }
+    }
+
+    Job job;
+    job.path = path;
+    job.mtime = mtime;
+    job.size = size;
+    job.pixels = (uint16_t*)OS_MALLOC_PSRAM(THUMB_PIXELS * sizeof(uint16_t));
+    if (!job.pixels) {
+        return OS_ERROR_NO_MEMORY;
+    }
+    downscale(pixels, width, height, stride, job.pixels, job.width, job.height);
+    install(job);
+    m_failed.erase(job.path);
+
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_writes.push_back(std::move(job));
+    xSemaphoreGive(m_lock);
+    xTaskNotifyGive(m_task);
+    return OS_OK;
+}
+
+void ThumbnailService::update() {
+    if (!m_running) {
+        return;
+    }
+
+    std::vector<Job> ready;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    ready.swap(m_ready);
+    for (const Job& job : ready) {
+        m_pending.erase(job.path);
+    }
+    xSemaphoreGive(m_lock);
+
+    for (Job& job : ready) {
+        if (job.pixels) {
+            install(job);
+            OS_FREE(job.pixels);
+        } else {
+            m_failed[job.path] = job.mtime;
+        }
+    }
+}
+
+void ThumbnailService::printStats() const {
+    if (!m_running) {
+        ESP_LOGI(TAG, "Thumbnails: not started");
+        return;
+    }
+    ESP_LOGI(TAG, "Thumbnails: %d hits, %d misses, %d cached of %d",
+             m_hits, m_misses, m_slotIndex.size(), m_slots.size());
+    ESP_LOGI(TAG, "Sources: %d from pack, %d Exif, %d full decodes (last %d us), %d failed",
+             m_packReads, m_exifThumbs, m_fullDecodes, m_lastDecodeUs, m_failures);
+    ESP_LOGI(TAG, "Pack: %d records, %d KB", m_packIndex.size(), m_packSize / 1024);
+}
+
+void ThumbnailService::install(Job& job) {
+    auto it = m_slotIndex.find(job.path);
+    Slot& slot = it != m_slotIndex.end() ? m_slots[it->second] : evictSlot();
+
+    memcpy(slot.pixels, job.pixels, (size_t)job.width * job.height * sizeof(uint16_t));
+    slot.path = job.path;
+    slot.mtime = job.mtime;
+    slot.size = job.size;
+    slot.lastUse = ++m_useCounter;
+    slot.image.header.w = job.width;
+    slot.image.header.h = job.height;
+    slot.image.data_size = (uint32_t)job.width * job.height * sizeof(uint16_t);
+    m_slotIndex[slot.path] = (size_t)(&slot - m_slots.data());
+    m_generation++;
+}
+
+ThumbnailService::Slot* ThumbnailService::findSlot(const std::string& path, uint32_t mtime, uint32_t size) {
+    auto it = m_slotIndex.find(path);
+    if (it == m_slotIndex.end()) {
+        return nullptr;
+    }
+    Slot& slot = m_slots[it->second];
+    return slot.mtime == mtime && slot.size == size ? &slot : nullptr;
+}
+
+ThumbnailService::Slot& ThumbnailService::evictSlot() {
+    Slot* oldest = &m_slots[0];
+    for (Slot& slot : m_slots) {
+        if (slot.path.empty()) {
+            return slot;
+        }
+        if (slot.lastUse < oldest->lastUse) {
+            oldest = &slot;
+        }
+    }
+    m_slotIndex.erase(oldest->path);
+    return *oldest;
+}
+
+bool ThumbnailService::openPack() {
+    m_pack = fopen(OS_THUMB_PACK_PATH, "r+b");
+    if (!m_pack) {
+        m_pack = fopen(OS_THUMB_PACK_PATH, "w+b");
+    }
+    if (!m_pack) {
+        ESP_LOGW(TAG, "Thumbnail pack unavailable, thumbnails are not kept");
+        return false;
+    }
+
+    fseek(m_pack, 0, SEEK_END);
+    long size = ftell(m_pack);
+    if (size > OS_THUMB_PACK_MAX_SIZE) {
+        ESP_LOGI(TAG, "Thumbnail pack reached %ld KB, starting a new one", size / 1024);
+        fclose(m_pack);
+        m_pack = fopen(OS_THUMB_PACK_PATH, "w+b");
+        if (!m_pack) {
+            return false;
+        }
+        size = 0;
+    }
+    m_packSize = size > 0 ? (uint32_t)size : 0;
+    indexPack();
+    return true;
+}
+
+void ThumbnailService::indexPack() {
+    int64_t start = esp_timer_get_time();
+    uint32_t offset = 0;
+    PackRecord record;
+
+    // Headers only: the path hash keys the index, paths are checked on read
+    while (offset + sizeof(record) <= m_packSize) {
+        if (fseek(m_pack, offset, SEEK_SET) != 0 || fread(&record, sizeof(record), 1, m_pack) != 1) {
+            break;
+        }
+        uint32_t length = sizeof(record) + record.pathLength + (uint32_t)record.width * record.height * 2;
+        if (record.magic != RECORD_MAGIC || record.width > OS_THUMB_WIDTH || record.height > OS_THUMB_HEIGHT ||
+            record.pathLength == 0 || record.pathLength > OS_THUMB_MAX_PATH || offset + length > m_packSize) {
+            break;
+        }
+        // A later record for the same path replaces the earlier one
+        m_packIndex[record.pathHash] = {offset, record.mtime, record.size};
+        offset += length;
+    }
+
+    if (offset < m_packSize) {
+        ESP_LOGW(TAG, "Cutting torn thumbnail pack at %d of %d bytes", offset, m_packSize);
+        fflush(m_pack);
+        if (ftruncate(fileno(m_pack), offset) == 0) {
+            m_packSize = offset;
+        }
+    }
+    ESP_LOGI(TAG, "Thumbnail pack: %d records in %d KB, indexed in %d ms",
+             m_packIndex.size(), m_packSize / 1024, (int)((esp_timer_get_time() - start) / 1000));
+}
+
+bool ThumbnailService::readFromPack(Job& job) {
+    if (!m_pack) {
+        return false;
+    }
+    auto it = m_packIndex.find(fnv1a(job.path.data(), job.path.size()));
+    if (it == m_packIndex.end() || it->second.mtime != job.mtime || it->second.size != job.size) {
+        return false;
+    }
+
+    PackRecord record;
+    if (fseek(m_pack, it->second.offset, SEEK_SET) != 0 || fread(&record, sizeof(record), 1, m_pack) != 1 ||
+        record.magic != RECORD_MAGIC || record.pathLength != job.path.size()) {
+        return false;
+    }
+    char path[OS_THUMB_MAX_PATH];
+    size_t pixelBytes = (size_t)record.width * record.height * sizeof(uint16_t);
+    if (fread(path, 1, record.pathLength, m_pack) != record.pathLength ||
+        memcmp(path, job.path.data(), record.pathLength) != 0 ||
+        fread(job.pixels, 1, pixelBytes, m_pack) != pixelBytes ||
+        fnv1a(job.pixels, pixelBytes) != record.checksum) {
+        return false;      // Hash collision or a damaged record: make it again
+    }
+    job.width = record.width;
+    job.height = record.height;
+    m_packReads++;
+    return true;
+}
+
+void ThumbnailService::appendToPack(const Job& job) {
+    if (!m_pack || job.path.empty() || job.path.size() > OS_THUMB_MAX_PATH) {
+        return;
+    }
+    size_t pixelBytes = (size_t)job.width * job.height * sizeof(uint16_t);
+    uint32_t length = sizeof(PackRecord) + job.path.size() + pixelBytes;
+    if (m_packSize + length > OS_THUMB_PACK_MAX_SIZE) {
+        return;            // Full until the next start replaces it
+    }
+
+    PackRecord record = {};
+    record.magic = RECORD_MAGIC;
+    record.pathHash = fnv1a(job.path.data(), job.path.size());
+    record.mtime = job.mtime;
+    record.size = job.size;
+    record.width = job.width;
+    record.height = job.height;
+    record.pathLength = (uint16_t)job.path.size();
+    record.checksum = fnv1a(job.pixels, pixelBytes);
+
+    bool written = fseek(m_pack, m_packSize, SEEK_SET) == 0 &&
+                   fwrite(&record, sizeof(record), 1, m_pack) == 1 &&
+                   fwrite(job.path.data(), 1, job.path.size(), m_pack) == job.path.size() &&
+                   fwrite(job.pixels, 1, pixelBytes, m_pack) == pixelBytes &&
+                   fflush(m_pack) == 0;
+    if (!written) {
+        ESP_LOGW(TAG, "Thumbnail pack write failed; closing it");
+        ftruncate(fileno(m_pack), m_packSize);
+        fclose(m_pack);
+        m_pack = nullptr;
+        return;
+    }
+    m_packIndex[record.pathHash] = {m_packSize, job.mtime, job.size};
+    m_packSize += length;
+}
+
+bool ThumbnailService::makeThumbnail(Job& job) {
+    FILE* file = fopen(job.path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    // Read the header first; the whole file only if it has to be decoded
+    bool whole = job.size <= OS_THUMB_MAX_JPEG_SIZE;
+    size_t capacity = whole ? job.size : OS_THUMB_EXIF_SCAN_BYTES;
+    uint8_t* data = (uint8_t*)OS_MALLOC_DMA(alignBytes(capacity));
+    if (!data) {
+        fclose(file);
+        return false;
+    }
+    size_t length = fread(data, 1, std::min<size_t>(capacity, OS_THUMB_EXIF_SCAN_BYTES), file);
+
+    bool made = false;
+    size_t offset = 0;
+    size_t size = 0;
+    if (findExifThumbnail(data, length, offset, size)) {
+        // The decoder reads its input by DMA from the start of an aligned buffer
+        memmove(data, data + offset, size);
+        made = decodeJpeg(data, size, job);
+        if (made) {
+            m_exifThumbs++;
+        } else if (whole) {
+            fseek(file, 0, SEEK_SET);
+            length = fread(data, 1, std::min<size_t>(capacity, OS_THUMB_EXIF_SCAN_BYTES), file);
+        }
+    }
+    if (!made && whole) {
+        if (length < capacity) {
+            length += fread(data + length, 1, capacity - length, file);
+        }
+        made = decodeJpeg(data, length, job);
+        if (made) {
+            m_fullDecodes++;
+        }
+    }
+
+    fclose(file);
+    OS_FREE(data);
+    return made;
+}
+
+bool ThumbnailService::decodeJpeg(const uint8_t* data, size_t length, Job& job) {
+    if (!m_decoder) {
+        jpeg_decode_engine_cfg_t engineConfig = {};
+        engineConfig.intr_priority = 0;
+        engineConfig.timeout_ms = OS_THUMB_JPEG_TIMEOUT_MS;
+        esp_err_t ret = jpeg_new_decoder_engine(&engineConfig, &m_decoder);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to open JPEG decoder: %s", esp_err_to_name(ret));
+            m_decoder = nullptr;
+            return false;
+        }
+    }
+
+    jpeg_decode_picture_info_t info = {};
+    if (jpeg_decoder_get_info(data, length, &info) != ESP_OK || info.width == 0 || info.height == 0) {
+        return false;
+    }
+
+    // Output is whole MCUs: 16x16 for 4:2:0, 16x8 for 4:2:2, 8x8 otherwise
+    uint32_t mcuWidth = 8;
+    uint32_t mcuHeight = 8;
+    if (info.sample_method == JPEG_DOWN_SAMPLING_YUV420) {
+        mcuWidth = 16;
+        mcuHeight = 16;
+    } else if (info.sample_method == JPEG_DOWN_SAMPLING_YUV422) {
+        mcuWidth = 16;
+    }
+    uint32_t stride = alignUp(info.width, mcuWidth);
+    uint32_t rows = alignUp(info.height, mcuHeight);
+    if ((uint64_t)stride * rows > OS_THUMB_MAX_DECODE_PIXELS || info.width > UINT16_MAX || info.height > UINT16_MAX) {
+        ESP_LOGD(TAG, "%s: %dx%d is too large to decode", job.path.c_str(), info.width, info.height);
+        return false;
+    }
+
+    size_t outputSize = alignBytes((size_t)stride * rows * sizeof(uint16_t));
+    uint8_t* output = (uint8_t*)OS_MALLOC_DMA(outputSize);
+    if (!output) {
+        return false;
+    }
+
+    jpeg_decode_cfg_t decodeConfig = {};
+    decodeConfig.output_format = JPEG_DECODE_OUT_FORMAT_RGB565;
+    decodeConfig.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;   // Little-endian RGB565 for LVGL
+    decodeConfig.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+
+    int64_t start = esp_timer_get_time();
+    uint32_t decoded = 0;
+    esp_err_t ret = jpeg_decoder_process(m_decoder, &decodeConfig, data, (uint32_t)length,
+                                         output, (uint32_t)outputSize, &decoded);
+    if (ret == ESP_OK) {
+        downscale(output, (uint16_t)info.width, (uint16_t)info.height, stride * sizeof(uint16_t),
+                  job.pixels, job.width, job.height);
+    } else {
+        ESP_LOGD(TAG, "JPEG decode failed: %s", esp_err_to_name(ret));
+    }
+    m_lastDecodeUs = (uint32_t)(esp_timer_get_time() - start);
+    OS_FREE(output);
+    return ret == ESP_OK;
+}
+
+void ThumbnailService::workerTask(void* arg) {
+    ThumbnailService* service = static_cast<ThumbnailService*>(arg);
+    service->openPack();
+
+    while (!service->m_stopping) {
+        Job job;
+        bool write = false;
+        bool load = false;
+        xSemaphoreTake(service->m_lock, portMAX_DELAY);
+        if (!service->m_writes.empty()) {
+            job = std::move(service->m_writes.front());
+            service->m_writes.pop_front();
+            write = true;
+        } else if (!service->m_loads.empty()) {
+            job = std::move(service->m_loads.front());
+            service->m_loads.pop_front();
+            load = true;
+        }
+        xSemaphoreGive(service->m_lock);
+
+        if (write) {
+            service->appendToPack(job);
+            OS_FREE(job.pixels);
+            continue;
+        }
+        if (!load) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        job.pixels = (uint16_t*)OS_MALLOC_PSRAM(THUMB_PIXELS * sizeof(uint16_t));
+        bool made = false;
+        if (job.pixels) {
+            if (service->readFromPack(job)) {
+                made = true;
+            } else if (service->makeThumbnail(job)) {
+                service->appendToPack(job);
+                made = true;
+            }
+        }
+        if (!made) {
+            OS_FREE(job.pixels);
+            job.pixels = nullptr;
+            service->m_failures++;
+        }
+
+        xSemaphoreTake(service->m_lock, portMAX_DELAY);
+        service->m_ready.push_back(std::move(job));
+        xSemaphoreGive(service->m_lock);
+        OS().wake();
+    }
+
+    if (service->m_pack) {
+        fclose(service->m_pack);
+        service->m_pack = nullptr;
+    }
+    if (service->m_decoder) {
+        jpeg_del_decoder_engine(service->m_decoder);
+        service->m_decoder = nullptr;
+    }
+    service->m_task = nullptr;
+    vTaskDelete(nullptr);
+}
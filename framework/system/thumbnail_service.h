@@ -0,0 +1,183 @@
+#ifndef THUMBNAIL_SERVICE_H
+#define THUMBNAIL_SERVICE_H
+
+#include "os_config.h"
+#include <lvgl.h>
+#include <driver/jpeg_decode.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @file thumbnail_service.h
+ * @brief Small RGB565 previews of JPEG files, cached in RAM and on the card
+ *
+ * Thumbnails fit OS_THUMB_WIDTH x OS_THUMB_HEIGHT with the aspect kept. A
+ * worker task makes them: from the thumbnail a camera embeds in the Exif
+ * header when there is one, otherwise by decoding the whole picture on the
+ * hardware JPEG decoder; either way the decoded image is area-averaged down.
+ *
+ * Every thumbnail made is appended to one pack file on the SD card
+ * (OS_THUMB_PACK_PATH), so the next visit to a folder reads a few KB per
+ * picture instead of decoding it. A record holds the source path, its mtime
+ * and size, and the pixels; the worker indexes the pack by path hash when
+ * it starts, and a changed file simply gets a newer record. The pack is
+ * never rewritten in place: a torn last record is cut off and an oversized
+ * pack is started afresh.
+ *
+ * In front of the pack sits an LRU of OS_THUMB_CACHE_ENTRIES decoded
+ * thumbnails ready for lv_img_set_src(). get(), store() and update() belong
+ * to the LVGL thread; finished loads are installed by update(), which is
+ * also the only place that evicts, so an image stays valid until the
+ * owner's next update() and getGeneration() tells it to rebind.
+ */
+
+class ThumbnailService {
+public:
+    ThumbnailService() = default;
+    ~ThumbnailService();
+
+    ThumbnailService(const ThumbnailService&) = delete;
+    ThumbnailService& operator=(const ThumbnailService&) = delete;
+
+    /**
+     * @brief Start the worker; called by the first get() or store()
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t start();
+
+    /**
+     * @brief Stop the worker, close the pack and drop cached thumbnails
+     */
+    void stop();
+
+    /**
+     * @brief Check if a file name is one thumbnails are made for
+     * @param name File name or path
+     * @return true for JPEG files
+     */
+    static bool isSupported(const char* name);
+
+    /**
+     * @brief Get a file's thumbnail, loading it in the background on a miss
+     * @param path Image file path
+     * @param mtime File modification time; a different one means a new picture
+     * @param size File size in bytes
+     * @return Thumbnail, or nullptr until a later update() has installed it
+     */
+    const lv_img_dsc_t* get(const char* path, uint32_t mtime, uint32_t size);
+
+    /**
+     * @brief Make a thumbnail from pixels already decoded, such as a camera preview
+     *
+     * The thumbnail is scaled here and available at once; the pack write
+     * happens on the worker.
+     * @param path Image file path the thumbnail stands for
+     * @param mtime File modification time
+     * @param size File size in bytes
+     * @param pixels RGB565 picture
+     * @param width Picture width
+     * @param height Picture height
+     * @param stride Bytes per picture row
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t store(const char* path, uint32_t mtime, uint32_t size, const uint8_t* pixels,
+                     uint16_t width, uint16_t height, uint32_t stride);
+
+    /**
+     * @brief Install thumbnails the worker finished
+     */
+    void update();
+
+    /**
+     * @brief Get a counter that changes whenever get() may return new images
+     * @return Generation
+     */
+    uint32_t getGeneration() const { return m_generation; }
+
+    /**
+     * @brief Print cache statistics
+     */
+    void printStats() const;
+
+private:
+    struct Slot {
+        std::string path;
+        uint32_t mtime = 0;
+        uint32_t size = 0;
+        uint32_t lastUse = 0;           // Use counter at the last hit
+        uint16_t* pixels = nullptr;     // OS_THUMB_WIDTH * OS_THUMB_HEIGHT
+        lv_img_dsc_t image = {};
+    };
+
+    struct Job {
+        std::string path;
+        uint32_t mtime = 0;
+        uint32_t size = 0;
+        uint16_t width = 0;             // Set for a store() write
+        uint16_t height = 0;
+        uint16_t* pixels = nullptr;     // Loads: filled by the worker; owned by the job
+    };
+
+    struct PackEntry {
+        uint32_t offset;                // Record start
+        uint32_t mtime;
+        uint32_t size;
+    };
+
+    void install(Job& job);
+    Slot* findSlot(const std::string& path, uint32_t mtime, uint32_t size);
+    Slot& evictSlot();
+
+    // Worker side: the pack, its index and the decoder are only touched here
+    bool openPack();
+    void indexPack();
+    bool readFromPack(Job& job);
+    void appendToPack(const Job& job);
+    bool makeThumbnail(Job& job);
+    bool decodeJpeg(const uint8_t* data, size_t length, Job& job);
+
+    static void workerTask(void* arg);
+
+    bool m_running = false;
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_stopping = false;
+
+    // Guards the job queues
+    SemaphoreHandle_t m_lock = nullptr;
+    std::deque<Job> m_loads;            // Newest first out: they are the rows on screen
+    std::deque<Job> m_writes;
+    std::vector<Job> m_ready;           // Finished loads, pixels null when none could be made
+    std::unordered_set<std::string> m_pending;
+
+    // LRU (LVGL thread)
+    std::vector<Slot> m_slots;
+    uint16_t* m_slotPixels = nullptr;
+    std::unordered_map<std::string, size_t> m_slotIndex;
+    std::unordered_map<std::string, uint32_t> m_failed;   // Path to the mtime that could not be read
+    uint32_t m_useCounter = 0;
+    uint32_t m_generation = 0;
+
+    // Pack (worker)
+    FILE* m_pack = nullptr;
+    uint32_t m_packSize = 0;
+    std::unordered_map<uint32_t, PackEntry> m_packIndex;
+    jpeg_decoder_handle_t m_decoder = nullptr;
+
+    // Statistics
+    uint32_t m_hits = 0;
+    uint32_t m_misses = 0;
+    uint32_t m_packReads = 0;
+    uint32_t m_exifThumbs = 0;
+    uint32_t m_fullDecodes = 0;
+    uint32_t m_failures = 0;
+    uint32_t m_lastDecodeUs = 0;
+};
+
+#endif // THUMBNAIL_SERVICE_H
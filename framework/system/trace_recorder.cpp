@@ -0,0 +1,394 @@
+#include "trace_recorder.h"
+#include "os_manager.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#if !CONFIG_FREERTOS_UNICORE
+#include <esp_ipc.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+static const char* TAG = "TraceRecorder";
+
+static_assert(OS_TRACE_EVENTS_PER_CORE >= 2 && (OS_TRACE_EVENTS_PER_CORE & (OS_TRACE_EVENTS_PER_CORE - 1)) == 0,
+              "OS_TRACE_EVENTS_PER_CORE must be a power of two");
+
+std::atomic<bool> TraceRecorder::s_recording(false);
+TraceRecorder::Ring TraceRecorder::s_rings[portNUM_PROCESSORS];
+TraceRecorder::ClockAnchor TraceRecorder::s_startAnchors[portNUM_PROCESSORS];
+TraceRecorder::ClockAnchor TraceRecorder::s_stopAnchors[portNUM_PROCESSORS];
+
+// Console line being typed (main loop only)
+static char s_consoleLine[96];
+static size_t s_consoleLength = 0;
+
+/**
+ * @brief Buffers JSON text on its way to a file or the console
+ */
+class TraceOutput {
+public:
+    TraceOutput(StorageHAL* storage, FileHandle handle)
+        : m_storage(storage), m_handle(handle), m_buffer(4096) {}
+
+    void append(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (m_length > m_buffer.size() - 256) {
+            flush();
+        }
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(m_buffer.data() + m_length, m_buffer.size() - m_length, format, args);
+        va_end(args);
+        if (written > 0) {
+            m_length = std::min(m_length + (size_t)written, m_buffer.size() - 1);
+        }
+    }
+
+    void flush() {
+        if (m_length == 0) {
+            return;
+        }
+        if (m_storage) {
+            if (m_storage->write(m_handle, m_buffer.data(), m_length) != (int)m_length) {
+                m_error = OS_ERROR_FILESYSTEM;
+            }
+        } else {
+            fwrite(m_buffer.data(), 1, m_length, stdout);
+        }
+        m_length = 0;
+    }
+
+    os_error_t getError() const { return m_error; }
+
+private:
+    StorageHAL* m_storage;
+    FileHandle m_handle;
+    std::vector<char> m_buffer;     // Heap, not the main task's stack
+    size_t m_length = 0;
+    os_error_t m_error = OS_OK;
+};
+
+/**
+ * @brief Copy a name into JSON string form (quotes and controls replaced)
+ */
+static const char* jsonName(const char* name, char* buffer, size_t size) {
+    size_t i = 0;
+    for (; name && name[i] && i < size - 1; i++) {
+        char c = name[i];
+        buffer[i] = (c == '"' || c == '\\' || (unsigned char)c < 0x20) ? '_' : c;
+    }
+    buffer[i] = '\0';
+    return buffer;
+}
+
+os_error_t TraceRecorder::initialize() {
+#if OS_TRACE_ENABLED
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (s_rings[core].events) {
+            continue;
+        }
+
+        TraceEvent* events = static_cast<TraceEvent*>(
+            heap_caps_malloc(OS_TRACE_EVENTS_PER_CORE * sizeof(TraceEvent), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (!events) {
+            ESP_LOGE(TAG, "No PSRAM for the core %d trace ring", core);
+            return OS_ERROR_NO_MEMORY;
+        }
+        for (size_t i = 0; i < OS_TRACE_EVENTS_PER_CORE; i++) {
+            new (&events[i]) TraceEvent();
+            events[i].sequence.store(0, std::memory_order_relaxed);
+        }
+        s_rings[core].head.store(0, std::memory_order_relaxed);
+        s_rings[core].events = events;
+    }
+
+    ESP_LOGI(TAG, "Trace rings: %d x %d events (%d KB PSRAM)", portNUM_PROCESSORS, OS_TRACE_EVENTS_PER_CORE,
+             (int)(portNUM_PROCESSORS * OS_TRACE_EVENTS_PER_CORE * sizeof(TraceEvent) / 1024));
+#endif
+    return OS_OK;
+}
+
+os_error_t TraceRecorder::start() {
+    if (!s_rings[0].events) {
+        ESP_LOGW(TAG, "Tracing not available (OS_TRACE_ENABLED %d)", OS_TRACE_ENABLED);
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    stop();
+    clear();
+    takeAnchors(s_startAnchors);
+    s_recording.store(true, std::memory_order_release);
+    ESP_LOGI(TAG, "Trace started");
+    return OS_OK;
+}
+
+void TraceRecorder::stop() {
+    if (!s_recording.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    takeAnchors(s_stopAnchors);
+    ESP_LOGI(TAG, "Trace stopped after %d events", (int)getRecordedCount());
+}
+
+void TraceRecorder::clear() {
+    bool recording = s_recording.exchange(false, std::memory_order_acq_rel);
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        Ring& ring = s_rings[core];
+        if (!ring.events) {
+            continue;
+        }
+        // Old sequence numbers would otherwise pass for events of the next capture
+        uint32_t written = std::min<uint32_t>(ring.head.load(std::memory_order_relaxed), OS_TRACE_EVENTS_PER_CORE);
+        for (uint32_t i = 0; i < written; i++) {
+            ring.events[i].sequence.store(0, std::memory_order_relaxed);
+        }
+        ring.head.store(0, std::memory_order_release);
+    }
+
+    if (recording) {
+        takeAnchors(s_startAnchors);
+        s_recording.store(true, std::memory_order_release);
+    }
+}
+
+uint32_t TraceRecorder::getRecordedCount() {
+    uint32_t count = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        count += s_rings[core].head.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void TraceRecorder::readAnchor(void* arg) {
+    ClockAnchor* anchor = static_cast<ClockAnchor*>(arg);
+    anchor->cycles = esp_cpu_get_cycle_count();
+    anchor->timeUs = esp_timer_get_time();
+}
+
+void TraceRecorder::takeAnchors(ClockAnchor* anchors) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        // Each core reads its own counter
+#if !CONFIG_FREERTOS_UNICORE
+        if (esp_ipc_call_blocking(core, readAnchor, &anchors[core]) != ESP_OK) {
+            readAnchor(&anchors[core]);
+        }
+#else
+        readAnchor(&anchors[core]);
+#endif
+    }
+}
+
+os_error_t TraceRecorder::dump(const char* path) {
+    if (!s_rings[0].events) {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+    stop();
+
+    StorageHAL* storage = nullptr;
+    FileHandle handle = INVALID_FILE_HANDLE;
+    if (path && path[0]) {
+        storage = &OS().getHALManager().getStorage();
+        handle = storage->openFile(path, FileOpenMode::WRITE);
+        if (handle == INVALID_FILE_HANDLE) {
+            ESP_LOGE(TAG, "Cannot write %s", path);
+            return OS_ERROR_FILESYSTEM;
+        }
+    } else {
+        fflush(stdout);
+        printf("\nTRACE BEGIN\n");
+    }
+
+    // Names of the tasks still alive; the rest are shown by handle
+    std::vector<TaskStatus_t> tasks;
+#if configUSE_TRACE_FACILITY
+    tasks.resize(uxTaskGetNumberOfTasks() + 4);
+    tasks.resize(uxTaskGetSystemState(tasks.data(), tasks.size(), nullptr));
+#endif
+
+    TraceOutput out(storage, handle);
+    out.append("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"os\":\"" OS_VERSION_STRING "\",\"recorded\":%u},\n"
+               "\"traceEvents\":[\n", (unsigned)getRecordedCount());
+    out.append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Tab5\"}}");
+
+    std::vector<uintptr_t> threads;
+    std::vector<double> timestamps;
+    uint32_t written = 0;
+    uint32_t torn = 0;
+    char name[64];
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        Ring& ring = s_rings[core];
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+        uint32_t count = std::min<uint32_t>(head, OS_TRACE_EVENTS_PER_CORE);
+        uint32_t first = head - count;
+        if (count == 0) {
+            continue;
+        }
+
+        // Cycles per microsecond over the capture, with the counter wraps
+        // worked out from the elapsed esp_timer time
+        const ClockAnchor& begin = s_startAnchors[core];
+        const ClockAnchor& end = s_stopAnchors[core];
+        double elapsedUs = (double)(end.timeUs - begin.timeUs);
+        double nominal = getCpuFrequencyMhz();
+        double rate = nominal;
+        if (elapsedUs > 0) {
+            double low = (double)(uint32_t)(end.cycles - begin.cycles);
+            double wraps = std::round((elapsedUs * nominal - low) / 4294967296.0);
+            rate = (low + std::max(wraps, 0.0) * 4294967296.0) / elapsedUs;
+        }
+        if (rate <= 0) {
+            rate = nominal > 0 ? nominal : 1;
+        }
+
+        // Walk back from the stop anchor; neighbours are never 2^31 cycles apart
+        timestamps.assign(count, 0);
+        uint32_t previous = end.cycles;
+        double back = 0;
+        for (uint32_t i = count; i-- > 0; ) {
+            back += (int32_t)(previous - ring.events[(first + i) & (OS_TRACE_EVENTS_PER_CORE - 1)].cycles);
+            previous = ring.events[(first + i) & (OS_TRACE_EVENTS_PER_CORE - 1)].cycles;
+            timestamps[i] = (double)(end.timeUs - s_startAnchors[0].timeUs) - back / rate;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t index = first + i;
+            const TraceEvent& slot = ring.events[index & (OS_TRACE_EVENTS_PER_CORE - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+                torn++;
+                continue;
+            }
+
+            uintptr_t tid = (slot.flags & TRACE_FLAG_ISR) ? (uintptr_t)(core + 1) : (uintptr_t)slot.task;
+            if (slot.phase != TracePhase::COUNTER && std::find(threads.begin(), threads.end(), tid) == threads.end()) {
+                threads.push_back(tid);
+            }
+
+            jsonName(slot.name, name, sizeof(name));
+            switch (slot.phase) {
+            case TracePhase::BEGIN:
+            case TracePhase::INSTANT:
+                // Instants are scoped to their thread ("s":"t")
+                out.append(",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"core\":%d",
+                           name, slot.phase == TracePhase::BEGIN ? "B" : "i\",\"s\":\"t", timestamps[i],
+                           (unsigned)tid, core);
+                if (slot.flags & TRACE_FLAG_VALUE) {
+                    out.append(",\"value\":%d", (int)slot.value);
+                }
+                out.append("}}");
+                break;
+            case TracePhase::END:
+                out.append(",\n{\"name\":\"%s\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                           name, timestamps[i], (unsigned)tid);
+                break;
+            case TracePhase::COUNTER:
+                out.append(",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%d}}",
+                           name, timestamps[i], (int)slot.value);
+                break;
+            }
+            written++;
+        }
+    }
+
+    for (uintptr_t tid : threads) {
+        const char* taskName = nullptr;
+        for (const TaskStatus_t& task : tasks) {
+            if ((uintptr_t)task.xHandle == tid) {
+                taskName = task.pcTaskName;
+                break;
+            }
+        }
+        if (tid <= portNUM_PROCESSORS) {
+            snprintf(name, sizeof(name), "ISR core %d", (int)tid - 1);
+        } else if (taskName) {
+            jsonName(taskName, name, sizeof(name));
+        } else {
+            snprintf(name, sizeof(name), "task %08x", (unsigned)tid);
+        }
+        out.append(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                   (unsigned)tid, name);
+    }
+    out.append("\n]}\n");
+    out.flush();
+
+    os_error_t result = out.getError();
+    if (storage) {
+        if (storage->flush(handle) != OS_OK) {
+            result = OS_ERROR_FILESYSTEM;
+        }
+        storage->closeFile(handle);
+    } else {
+        printf("TRACE END\n");
+        fflush(stdout);
+    }
+
+    ESP_LOGI(TAG, "Trace dump: %d events, %d incomplete, %d threads%s%s", (int)written, (int)torn,
+             (int)threads.size(), path ? " to " : "", path ? path : "");
+    return result;
+}
+
+void TraceRecorder::pollConsole() {
+#if OS_TRACE_ENABLED && OS_TRACE_CONSOLE
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) {
+            break;
+        }
+        if (c == '\r') {
+            continue;
+        }
+        if (c != '\n') {
+            if (s_consoleLength < sizeof(s_consoleLine) - 1) {
+                s_consoleLine[s_consoleLength++] = (char)c;
+            }
+            continue;
+        }
+
+        s_consoleLine[s_consoleLength] = '\0';
+        s_consoleLength = 0;
+        if (s_consoleLine[0] && !handleCommand(s_consoleLine)) {
+            ESP_LOGW(TAG, "Unknown command: %s", s_consoleLine);
+        }
+    }
+#endif
+}
+
+bool TraceRecorder::handleCommand(const char* line) {
+    char command[16] = {};
+    char argument[80] = {};
+    if (sscanf(line, "trace %15s %79s", command, argument) < 1) {
+        return false;
+    }
+
+    if (strcmp(command, "start") == 0) {
+        start();
+    } else if (strcmp(command, "stop") == 0) {
+        stop();
+    } else if (strcmp(command, "clear") == 0) {
+        clear();
+    } else if (strcmp(command, "dump") == 0) {
+        os_error_t result = dump(argument[0] ? argument : nullptr);
+        if (result != OS_OK) {
+            ESP_LOGE(TAG, "Trace dump failed: %d", result);
+        }
+    } else if (strcmp(command, "status") == 0) {
+        ESP_LOGI(TAG, "Trace %s, %d events recorded, ring %d per core",
+                 isRecording() ? "recording" : "stopped", (int)getRecordedCount(), OS_TRACE_EVENTS_PER_CORE);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* TraceRecorder::intern(const std::string& name) {
+    static std::unordered_set<std::string> names;
+    return names.insert(name).first->c_str();
+}
@@ -0,0 +1,223 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_cpu.h>
+#include <atomic>
+#include <string>
+
+/**
+ * @file trace_recorder.h
+ * @brief Timeline tracing into per-core rings, exported as Chrome trace JSON
+ *
+ * The OS_TRACE_* macros record begin/end, instant and counter events while
+ * a capture is running. Each core has its own ring of
+ * OS_TRACE_EVENTS_PER_CORE events in PSRAM; a writer claims a slot with one
+ * atomic add on the ring head (kept in internal RAM) and publishes it with
+ * a sequence store, so tasks on either core never lock or wait, and the
+ * oldest events are overwritten once a ring is full. Timestamps are the
+ * core's cycle counter; start() and stop() take a cycle/esp_timer pair on
+ * every core, from which dump() converts cycles to microseconds. While
+ * recording the CPU governor holds its clock step so the rate stays fixed.
+ * Two consecutive events on one core more than 2^31 cycles (about 6 s at
+ * 360 MHz) apart lose their true spacing.
+ *
+ * Event names must outlive the capture: string literals, or intern() for
+ * names built at run time. With OS_TRACE_ENABLED 0 the macros compile to
+ * nothing and no rings are allocated.
+ *
+ * The serial console takes "trace start", "trace stop", "trace clear",
+ * "trace status" and "trace dump [path]". A dump without a path goes to the
+ * console between "TRACE BEGIN" and "TRACE END" lines; either form opens in
+ * ui.perfetto.dev or chrome://tracing.
+ */
+
+enum class TracePhase : uint8_t {
+    BEGIN = 0,
+    END,
+    INSTANT,
+    COUNTER
+};
+
+/**
+ * @brief One recorded event (24 bytes)
+ */
+struct TraceEvent {
+    std::atomic<uint32_t> sequence;     // Claimed index + 1 once written, 0 while writing
+    uint32_t cycles;
+    const char* name;
+    TaskHandle_t task;                  // nullptr when recorded from an ISR
+    int32_t value;
+    TracePhase phase;
+    uint8_t flags;
+    uint16_t reserved;
+};
+
+static constexpr uint8_t TRACE_FLAG_VALUE = 1 << 0;   // value is reported as an argument
+static constexpr uint8_t TRACE_FLAG_ISR = 1 << 1;
+
+class TraceRecorder {
+public:
+    /**
+     * @brief Allocate the rings (no-op with OS_TRACE_ENABLED 0)
+     * @return OS_OK on success, error code on failure
+     */
+    static os_error_t initialize();
+
+    /**
+     * @brief Clear the rings and start recording
+     * @return OS_OK on success, error code on failure
+     */
+    static os_error_t start();
+
+    /**
+     * @brief Stop recording; the rings keep their events for dump()
+     */
+    static void stop();
+
+    /**
+     * @brief Drop all recorded events
+     */
+    static void clear();
+
+    /**
+     * @brief Check if a capture is running
+     * @return true while recording
+     */
+    static bool isRecording() { return s_recording.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Write the rings as Chrome trace JSON, stopping the capture first
+     * @param path File to write, or nullptr for the serial console
+     * @return OS_OK on success, error code on failure
+     */
+    static os_error_t dump(const char* path = nullptr);
+
+    /**
+     * @brief Read console input and run complete "trace" commands (main loop)
+     */
+    static void pollConsole();
+
+    /**
+     * @brief Run one console command
+     * @param line Command line without the newline
+     * @return true if the line was a trace command
+     */
+    static bool handleCommand(const char* line);
+
+    /**
+     * @brief Get a name that stays valid for the rest of the run (main loop)
+     * @param name Name to copy
+     * @return Stable pointer to the same text
+     */
+    static const char* intern(const std::string& name);
+
+    /**
+     * @brief Number of events recorded since start(), including overwritten ones
+     * @return Event count
+     */
+    static uint32_t getRecordedCount();
+
+    /**
+     * @brief Record an event; use the OS_TRACE_* macros instead
+     * @param phase Event phase
+     * @param name Static event name
+     * @param value Counter value or argument
+     * @param flags TRACE_FLAG_* bits
+     */
+    static inline __attribute__((always_inline))
+    void record(TracePhase phase, const char* name, int32_t value, uint8_t flags) {
+        if (!s_recording.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        uint32_t cycles = esp_cpu_get_cycle_count();
+        Ring& ring = s_rings[esp_cpu_get_core_id()];
+        uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+        TraceEvent& event = ring.events[index & (OS_TRACE_EVENTS_PER_CORE - 1)];
+
+        // Readers reject the slot until the final sequence store
+        event.sequence.store(0, std::memory_order_relaxed);
+        event.cycles = cycles;
+        event.name = name;
+        if (xPortInIsrContext()) {
+            event.task = nullptr;
+            flags |= TRACE_FLAG_ISR;
+        } else {
+            event.task = xTaskGetCurrentTaskHandle();
+        }
+        event.value = value;
+        event.phase = phase;
+        event.flags = flags;
+        event.sequence.store(index + 1, std::memory_order_release);
+    }
+
+private:
+    struct Ring {
+        std::atomic<uint32_t> head;
+        TraceEvent* events;
+    };
+
+    /**
+     * @brief Cycle counter and esp_timer read together on one core
+     */
+    struct ClockAnchor {
+        uint32_t cycles;
+        int64_t timeUs;
+    };
+
+    static void readAnchor(void* arg);
+    static void takeAnchors(ClockAnchor* anchors);
+
+    static std::atomic<bool> s_recording;
+    static Ring s_rings[portNUM_PROCESSORS];
+    static ClockAnchor s_startAnchors[portNUM_PROCESSORS];
+    static ClockAnchor s_stopAnchors[portNUM_PROCESSORS];
+};
+
+/**
+ * @brief Records a BEGIN on construction and an END on destruction
+ */
+class ScopedTrace {
+public:
+    ScopedTrace(const char* name) : m_name(name) {
+        TraceRecorder::record(TracePhase::BEGIN, name, 0, 0);
+    }
+
+    ScopedTrace(const char* name, int32_t value) : m_name(name) {
+        TraceRecorder::record(TracePhase::BEGIN, name, value, TRACE_FLAG_VALUE);
+    }
+
+    ~ScopedTrace() {
+        TraceRecorder::record(TracePhase::END, m_name, 0, 0);
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    const char* m_name;
+};
+
+// Convenience macros
+#if OS_TRACE_ENABLED
+#define OS_TRACE_CONCAT_(a, b) a##b
+#define OS_TRACE_CONCAT(a, b) OS_TRACE_CONCAT_(a, b)
+#define OS_TRACE_BEGIN(name) TraceRecorder::record(TracePhase::BEGIN, name, 0, 0)
+#define OS_TRACE_END(name) TraceRecorder::record(TracePhase::END, name, 0, 0)
+#define OS_TRACE_INSTANT(name, value) TraceRecorder::record(TracePhase::INSTANT, name, value, TRACE_FLAG_VALUE)
+#define OS_TRACE_COUNTER(name, value) TraceRecorder::record(TracePhase::COUNTER, name, value, TRACE_FLAG_VALUE)
+#define OS_TRACE_SCOPE(name) ScopedTrace OS_TRACE_CONCAT(_trace, __LINE__)(name)
+#define OS_TRACE_SCOPE_ARG(name, value) ScopedTrace OS_TRACE_CONCAT(_trace, __LINE__)(name, (int32_t)(value))
+#else
+#define OS_TRACE_BEGIN(name) do {} while (0)
+#define OS_TRACE_END(name) do {} while (0)
+#define OS_TRACE_INSTANT(name, value) do {} while (0)
+#define OS_TRACE_COUNTER(name, value) do {} while (0)
+#define OS_TRACE_SCOPE(name) do {} while (0)
+#define OS_TRACE_SCOPE_ARG(name, value) do {} while (0)
+#endif
+
+#endif // TRACE_RECORDER_H
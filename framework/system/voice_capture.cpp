@@ -0,0 +1,249 @@
+#include "voice_capture.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const char* TAG = "VoiceCapture";
+
+static constexpr size_t BAND_SAMPLES = OS_AUDIO_FRAME_SAMPLES / VOICE_LEVEL_BANDS;
+static_assert(OS_AUDIO_FRAME_SAMPLES % VOICE_LEVEL_BANDS == 0, "Frame must split into meter bands");
+static_assert((OS_VOICE_RING_BYTES & (OS_VOICE_RING_BYTES - 1)) == 0, "Voice ring must be a power of two");
+
+static constexpr float MIN_THRESHOLD = 120.0f;          // About -49 dBFS: below this is never speech
+static constexpr float INITIAL_FLOOR = 60.0f;
+static constexpr float METER_FLOOR_DB = -60.0f;         // Meter bottom, dBFS
+
+VoiceCapture::~VoiceCapture() {
+    stop();
+}
+
+os_error_t VoiceCapture::start(uint8_t sensitivity) {
+    if (m_task) {
+        return OS_ERROR_BUSY;
+    }
+    stop();
+
+    m_ringStorage = (uint8_t*)OS_MALLOC_PSRAM(OS_VOICE_RING_BYTES);
+    m_preroll = (int16_t*)OS_MALLOC_PSRAM(PREROLL_FRAMES * FRAME_BYTES);
+    if (!m_ringStorage || !m_preroll || !m_ring.init(m_ringStorage, OS_VOICE_RING_BYTES)) {
+        ESP_LOGE(TAG, "Failed to allocate %d-byte voice ring", OS_VOICE_RING_BYTES);
+        stop();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    // Sensitivity drives both the mic PGA and how far above the floor speech must be
+    sensitivity = sensitivity > 100 ? 100 : sensitivity;
+    os_error_t result = m_input.open((uint8_t)(sensitivity * 8 / 100));
+    if (result != OS_OK) {
+        stop();
+        m_state.store(VoiceCaptureState::ERROR, std::memory_order_release);
+        return result;
+    }
+    m_ratio = 1.5f + (100 - sensitivity) * 0.045f;
+
+    m_prerollNext = 0;
+    m_prerollCount = 0;
+    m_framesAbove = 0;
+    m_silentMs = 0;
+    m_elapsedMs = 0;
+    m_speechMs = 0;
+    m_onsetMs = 0;
+    m_stats = {};
+    m_stats.noiseFloor = INITIAL_FLOOR;
+    m_stats.threshold = std::max(INITIAL_FLOOR * m_ratio, MIN_THRESHOLD);
+    for (auto& level : m_levels) {
+        level.store(0);
+    }
+    m_level.store(0);
+
+    m_finishRequested = false;
+    m_running = true;
+    m_state.store(VoiceCaptureState::WAITING, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(captureTask, "voice_capture", OS_VOICE_TASK_STACK, this,
+                                OS_VOICE_TASK_PRIORITY, &m_task, OS_VOICE_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create capture task");
+        m_running = false;
+        m_task = nullptr;
+        stop();
+        m_state.store(VoiceCaptureState::ERROR, std::memory_order_release);
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    ESP_LOGI(TAG, "Listening (sensitivity %d, ratio %.1f)", sensitivity, m_ratio);
+    return OS_OK;
+}
+
+void VoiceCapture::finish() {
+    m_finishRequested = true;
+}
+
+void VoiceCapture::stop() {
+    if (m_task) {
+        m_running = false;
+        for (int i = 0; i < 30 && m_task; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (m_task) {
+            ESP_LOGW(TAG, "Capture task did not exit, deleting it");
+            vTaskDelete(m_task);
+            m_task = nullptr;
+        }
+    }
+    m_input.close();
+
+    if (m_ringStorage) {
+        OS_FREE(m_ringStorage);
+        m_ringStorage = nullptr;
+    }
+    if (m_preroll) {
+        OS_FREE(m_preroll);
+        m_preroll = nullptr;
+    }
+    m_ring.reset();
+    m_state.store(VoiceCaptureState::IDLE, std::memory_order_release);
+}
+
+bool VoiceCapture::isFinished() const {
+    VoiceCaptureState state = getState();
+    return state == VoiceCaptureState::ENDPOINT || state == VoiceCaptureState::NO_SPEECH ||
+           state == VoiceCaptureState::ERROR;
+}
+
+size_t VoiceCapture::readSpeech(uint8_t* out, size_t maxLength) {
+    return m_ring.read(out, maxLength & ~(size_t)1);
+}
+
+void VoiceCapture::getLevels(uint8_t* levels) const {
+    for (size_t i = 0; i < VOICE_LEVEL_BANDS; i++) {
+        levels[i] = m_levels[i].load(std::memory_order_relaxed);
+    }
+}
+
+VoiceCaptureStats VoiceCapture::getStats() const {
+    return m_stats;
+}
+
+void VoiceCapture::processFrame(const int16_t* samples) {
+    // One pass: per-band energy for the meter, summed for the frame RMS
+    float total = 0.0f;
+    for (size_t band = 0; band < VOICE_LEVEL_BANDS; band++) {
+        const int16_t* slice = samples + band * BAND_SAMPLES;
+        int64_t energy = 0;
+        for (size_t i = 0; i < BAND_SAMPLES; i++) {
+            energy += (int32_t)slice[i] * slice[i];
+        }
+        total += (float)energy;
+        m_levels[band].store(meterLevel(sqrtf((float)energy / BAND_SAMPLES)), std::memory_order_relaxed);
+    }
+    float rms = sqrtf(total / OS_AUDIO_FRAME_SAMPLES);
+    m_level.store(meterLevel(rms), std::memory_order_relaxed);
+
+    m_stats.framesRead++;
+    m_elapsedMs += FRAME_MS;
+    bool loud = rms > m_stats.threshold;
+    VoiceCaptureState state = getState();
+
+    if (state == VoiceCaptureState::WAITING) {
+        // Track the floor only outside speech: quickly down, slowly up
+        float& floor = m_stats.noiseFloor;
+        floor += (rms - floor) * (rms < floor ? 0.2f : 0.02f);
+        m_stats.threshold = std::max(floor * m_ratio, MIN_THRESHOLD);
+
+        // Keep recent frames so the start of the first word is not lost
+        memcpy(m_preroll + m_prerollNext * OS_AUDIO_FRAME_SAMPLES, samples, FRAME_BYTES);
+        m_prerollNext = (m_prerollNext + 1) % PREROLL_FRAMES;
+        m_prerollCount = std::min(m_prerollCount + 1, PREROLL_FRAMES);
+
+        m_framesAbove = loud ? m_framesAbove + 1 : 0;
+        if (m_framesAbove * FRAME_MS >= OS_VOICE_ONSET_MS) {
+            m_onsetMs = m_elapsedMs;
+            m_silentMs = 0;
+            size_t first = (m_prerollNext + PREROLL_FRAMES - m_prerollCount) % PREROLL_FRAMES;
+            for (size_t i = 0; i < m_prerollCount; i++) {
+                writeSpeech(m_preroll + ((first + i) % PREROLL_FRAMES) * OS_AUDIO_FRAME_SAMPLES);
+            }
+            m_state.store(VoiceCaptureState::SPEECH, std::memory_order_release);
+            ESP_LOGI(TAG, "Speech onset at %d ms (rms %.0f, floor %.0f)",
+                     m_onsetMs, rms, m_stats.noiseFloor);
+        } else if (m_finishRequested || m_elapsedMs >= OS_VOICE_NO_SPEECH_MS) {
+            endUtterance(VoiceCaptureState::NO_SPEECH);
+        }
+        return;
+    }
+
+    // SPEECH: stream it, bridge short pauses, trim long ones, end-point
+    m_speechMs += FRAME_MS;
+    m_silentMs = loud ? 0 : m_silentMs + FRAME_MS;
+    if (m_silentMs <= OS_VOICE_HANGOVER_MS) {
+        writeSpeech(samples);
+    } else {
+        m_stats.trimmedFrames++;
+    }
+
+    if (m_finishRequested || m_silentMs >= OS_VOICE_ENDPOINT_MS ||
+        m_speechMs >= OS_VOICE_MAX_UTTERANCE_MS) {
+        endUtterance(VoiceCaptureState::ENDPOINT);
+    }
+}
+
+void VoiceCapture::writeSpeech(const int16_t* samples) {
+    size_t written = m_ring.write((const uint8_t*)samples, FRAME_BYTES);
+    m_stats.droppedBytes += FRAME_BYTES - written;
+    m_stats.speechFrames++;
+}
+
+void VoiceCapture::endUtterance(VoiceCaptureState state) {
+    m_running = false;
+    m_state.store(state, std::memory_order_release);
+    ESP_LOGI(TAG, "%s after %d ms: %d speech frames, %d trimmed, %d bytes dropped",
+             state == VoiceCaptureState::ENDPOINT ? "End-point" : "No speech",
+             m_elapsedMs, m_stats.speechFrames, m_stats.trimmedFrames, m_stats.droppedBytes);
+}
+
+uint8_t VoiceCapture::meterLevel(float rms) {
+    if (rms < 1.0f) {
+        return 0;
+    }
+    float db = 20.0f * log10f(rms / 32768.0f);
+    if (db <= METER_FLOOR_DB) {
+        return 0;
+    }
+    return (uint8_t)std::min(100.0f, (db - METER_FLOOR_DB) * 100.0f / -METER_FLOOR_DB);
+}
+
+void VoiceCapture::captureTask(void* parameter) {
+    VoiceCapture* capture = static_cast<VoiceCapture*>(parameter);
+    int16_t frame[OS_AUDIO_FRAME_SAMPLES];
+
+    while (capture->m_running) {
+        size_t count = capture->m_input.read(frame, OS_AUDIO_FRAME_SAMPLES, FRAME_MS * 4);
+        if (count == 0) {
+            ESP_LOGE(TAG, "Microphone stopped delivering samples");
+            capture->m_running = false;
+            capture->m_state.store(VoiceCaptureState::ERROR, std::memory_order_release);
+            break;
+        }
+        if (count < OS_AUDIO_FRAME_SAMPLES) {
+            capture->m_stats.shortReads++;
+            memset(frame + count, 0, (OS_AUDIO_FRAME_SAMPLES - count) * sizeof(int16_t));
+        }
+        capture->processFrame(frame);
+    }
+
+    // Release the microphone as soon as the utterance is over
+    capture->m_input.close();
+    for (auto& level : capture->m_levels) {
+        level.store(0, std::memory_order_relaxed);
+    }
+    capture->m_level.store(0, std::memory_order_relaxed);
+    if (capture->getState() == VoiceCaptureState::WAITING) {
+        capture->m_state.store(VoiceCaptureState::NO_SPEECH, std::memory_order_release);
+    } else if (capture->getState() == VoiceCaptureState::SPEECH) {
+        capture->m_state.store(VoiceCaptureState::ENDPOINT, std::memory_order_release);
+    }
+
+    capture->m_task = nullptr;
+    vTaskDelete(NULL);
+}
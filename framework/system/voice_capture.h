@@ -0,0 +1,171 @@
+#ifndef VOICE_CAPTURE_H
+#define VOICE_CAPTURE_H
+
+#include "os_config.h"
+#include "byte_ring.h"
+#include "../hal/audio_input.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+
+/**
+ * @file voice_capture.h
+ * @brief Microphone capture with voice-activity detection and end-pointing
+ *
+ * A capture task on OS_VOICE_TASK_CORE reads OS_AUDIO_FRAME_SAMPLES frames
+ * from AudioInput and computes, in one pass over the samples, the energy
+ * of VOICE_LEVEL_BANDS consecutive slices of the frame. The slice levels
+ * feed the UI meter and their sum is the frame RMS the detector uses, so
+ * the bars show exactly what the VAD hears.
+ *
+ * The detector keeps an adaptive noise floor and declares speech after
+ * OS_VOICE_ONSET_MS above floor x ratio (the ratio comes from the mic
+ * sensitivity setting). Only speech reaches the PSRAM ring: the
+ * OS_VOICE_PREROLL_MS before onset so the first syllable is kept, speech
+ * frames, and up to OS_VOICE_HANGOVER_MS of each pause; longer silence is
+ * trimmed. OS_VOICE_ENDPOINT_MS of silence after speech ends the utterance
+ * and the task closes the microphone on its own.
+ *
+ * A consumer (the speech uploader) drains the ring with readSpeech() while
+ * the user is still talking. start(), finish() and stop() come from one
+ * task; readSpeech() from one consumer task; the getters from anywhere.
+ */
+
+static constexpr size_t VOICE_LEVEL_BANDS = 8;
+
+enum class VoiceCaptureState : uint8_t {
+    IDLE,           // Not started, or stopped
+    WAITING,        // Listening for speech onset
+    SPEECH,         // Utterance in progress, audio streaming into the ring
+    ENDPOINT,       // Utterance complete; the ring holds its tail
+    NO_SPEECH,      // Gave up before any speech was heard
+    ERROR           // Microphone failed
+};
+
+struct VoiceCaptureStats {
+    uint32_t framesRead;
+    uint32_t speechFrames;      // Frames written to the ring, pre-roll included
+    uint32_t trimmedFrames;     // Pause frames dropped beyond the hangover
+    uint32_t droppedBytes;      // Ring full: the consumer fell behind
+    uint32_t shortReads;        // Frames the I2S driver delivered incomplete
+    float noiseFloor;           // RMS, full scale 32768
+    float threshold;
+};
+
+class VoiceCapture {
+public:
+    VoiceCapture() = default;
+    ~VoiceCapture();
+
+    VoiceCapture(const VoiceCapture&) = delete;
+    VoiceCapture& operator=(const VoiceCapture&) = delete;
+
+    /**
+     * @brief Open the microphone and listen for one utterance
+     * @param sensitivity Mic sensitivity 0-100; higher triggers on quieter speech
+     * @return OS_OK on success, OS_ERROR_BUSY, OS_ERROR_NO_MEMORY or OS_ERROR_HARDWARE
+     */
+    os_error_t start(uint8_t sensitivity);
+
+    /**
+     * @brief End the utterance now (manual stop); buffered speech stays readable
+     */
+    void finish();
+
+    /**
+     * @brief Stop the task, close the microphone and free the ring
+     *
+     * Call only once the consumer has stopped reading.
+     */
+    void stop();
+
+    /**
+     * @brief Get the capture state
+     * @return Current state
+     */
+    VoiceCaptureState getState() const { return m_state.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if no more audio will be added to the ring
+     * @return true once the utterance ended, was abandoned or failed
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Read captured speech (consumer only)
+     * @param out Destination for 16-bit mono PCM at OS_AUDIO_SAMPLE_RATE
+     * @param maxLength Destination size in bytes
+     * @return Bytes read, always a whole number of samples
+     */
+    size_t readSpeech(uint8_t* out, size_t maxLength);
+
+    /**
+     * @brief Bytes of speech waiting in the ring
+     * @return Byte count
+     */
+    size_t speechAvailable() const { return m_ring.available(); }
+
+    /**
+     * @brief Get the latest meter levels
+     * @param levels Output, VOICE_LEVEL_BANDS values 0-100
+     */
+    void getLevels(uint8_t* levels) const;
+
+    /**
+     * @brief Get the latest frame level
+     * @return Frame RMS as 0-100 on the meter scale
+     */
+    uint8_t getLevel() const { return m_level.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the time from start() to speech onset
+     * @return Milliseconds, 0 before onset
+     */
+    uint32_t getOnsetMs() const { return m_onsetMs; }
+
+    /**
+     * @brief Get capture counters
+     * @return Statistics snapshot
+     */
+    VoiceCaptureStats getStats() const;
+
+private:
+    static constexpr uint32_t FRAME_MS = OS_AUDIO_FRAME_SAMPLES * 1000 / OS_AUDIO_SAMPLE_RATE;
+    static constexpr size_t FRAME_BYTES = OS_AUDIO_FRAME_SAMPLES * sizeof(int16_t);
+    static constexpr size_t PREROLL_FRAMES = OS_VOICE_PREROLL_MS / FRAME_MS;
+
+    void processFrame(const int16_t* samples);
+    void writeSpeech(const int16_t* samples);
+    void endUtterance(VoiceCaptureState state);
+
+    static uint8_t meterLevel(float rms);
+    static void captureTask(void* parameter);
+
+    AudioInput m_input;
+    ByteRing m_ring;
+    uint8_t* m_ringStorage = nullptr;
+    int16_t* m_preroll = nullptr;       // PREROLL_FRAMES frames, circular
+    size_t m_prerollNext = 0;
+    size_t m_prerollCount = 0;
+
+    TaskHandle_t m_task = nullptr;
+    volatile bool m_running = false;
+    volatile bool m_finishRequested = false;
+    std::atomic<VoiceCaptureState> m_state{VoiceCaptureState::IDLE};
+
+    // Detector, touched only by the capture task
+    float m_ratio = 3.0f;
+    uint32_t m_framesAbove = 0;
+    uint32_t m_silentMs = 0;
+    uint32_t m_elapsedMs = 0;
+    uint32_t m_speechMs = 0;
+    uint32_t m_onsetMs = 0;
+
+    // Meter, published by the capture task
+    std::atomic<uint8_t> m_levels[VOICE_LEVEL_BANDS] = {};
+    std::atomic<uint8_t> m_level{0};
+
+    VoiceCaptureStats m_stats = {};
+};
+
+#endif // VOICE_CAPTURE_H
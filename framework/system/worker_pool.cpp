@@ -0,0 +1,299 @@
+#include "worker_pool.h"
+#include "os_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char* TAG = "WorkerPool";
+
+static constexpr uint64_t UTILIZATION_WINDOW_US = 1000000;
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+os_error_t WorkerPool::initialize() {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Starting %d workers", OS_WORKER_COUNT);
+
+    m_completionLock = xSemaphoreCreateMutex();
+    if (!m_completionLock) {
+        return OS_ERROR_NO_MEMORY;
+    }
+    m_completions.reserve(OS_WORKER_QUEUE_DEPTH);
+    m_running = true;
+
+    for (size_t i = 0; i < OS_WORKER_COUNT; i++) {
+        Worker* worker = new Worker();
+        worker->pool = this;
+        worker->index = i;
+        worker->core = (int)(i % portNUM_PROCESSORS);
+        worker->handle = nullptr;
+        worker->lock = xSemaphoreCreateMutex();
+        worker->idle = true;
+        worker->jobsExecuted = 0;
+        worker->jobsStolen = 0;
+        worker->busyUs = 0;
+        worker->windowStartUs = esp_timer_get_time();
+        worker->utilization = 0;
+
+        if (!worker->lock) {
+            delete worker;
+            shutdown();
+            return OS_ERROR_NO_MEMORY;
+        }
+        m_workers.push_back(worker);
+    }
+
+    // Start tasks only once the worker list is complete, since workers
+    // walk it when stealing
+    for (auto* worker : m_workers) {
+        char taskName[16];
+        snprintf(taskName, sizeof(taskName), "os_worker%d", (int)worker->index);
+
+        if (xTaskCreatePinnedToCore(workerTask, taskName, OS_WORKER_STACK_SIZE, worker,
+                                    OS_WORKER_PRIORITY, &worker->handle, worker->core) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start worker %d", (int)worker->index);
+            worker->handle = nullptr;
+            shutdown();
+            return OS_ERROR_GENERIC;
+        }
+    }
+
+    m_initialized = true;
+    return OS_OK;
+}
+
+os_error_t WorkerPool::shutdown() {
+    if (!m_running && m_workers.empty()) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Stopping workers");
+    m_running = false;
+
+    for (auto* worker : m_workers) {
+        if (worker->handle) {
+            xTaskNotifyGive(worker->handle);
+        }
+    }
+
+    // Workers clear their handle on exit; give in-flight jobs time to finish
+    for (int attempt = 0; attempt < 50; attempt++) {
+        bool anyRunning = false;
+        for (auto* worker : m_workers) {
+            if (worker->handle) {
+                anyRunning = true;
+            }
+        }
+        if (!anyRunning) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    for (auto* worker : m_workers) {
+        if (worker->handle) {
+            ESP_LOGW(TAG, "Worker %d did not exit, deleting", (int)worker->index);
+            vTaskDelete(worker->handle);
+        }
+        vSemaphoreDelete(worker->lock);
+        delete worker;
+    }
+    m_workers.clear();
+
+    if (m_completionLock) {
+        vSemaphoreDelete(m_completionLock);
+        m_completionLock = nullptr;
+    }
+    m_completions.clear();
+    m_initialized = false;
+
+    return OS_OK;
+}
+
+uint32_t WorkerPool::submit(WorkerJobFunction job, WorkerJobFunction onComplete,
+                            int core, const char* name) {
+    if (!m_initialized || !job) {
+        return 0;
+    }
+
+    // Pinned jobs go to the worker on that core; others round-robin
+    size_t target = m_nextWorker++ % m_workers.size();
+    if (core != ANY_CORE) {
+        bool found = false;
+        for (auto* worker : m_workers) {
+            if (worker->core == core) {
+                target = worker->index;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            ESP_LOGW(TAG, "No worker on core %d", core);
+            return 0;
+        }
+    }
+
+    uint32_t jobId = __atomic_add_fetch(&m_nextJobId, 1, __ATOMIC_RELAXED);
+
+    Job entry;
+    entry.id = jobId;
+    entry.function = std::move(job);
+    entry.onComplete = std::move(onComplete);
+    entry.name = name;
+    entry.pinned = (core != ANY_CORE);
+
+    Worker& worker = *m_workers[target];
+    xSemaphoreTake(worker.lock, portMAX_DELAY);
+    if (worker.jobs.size() >= OS_WORKER_QUEUE_DEPTH) {
+        xSemaphoreGive(worker.lock);
+        ESP_LOGW(TAG, "Worker %d queue full, dropping job '%s'",
+                (int)target, name ? name : "unnamed");
+        return 0;
+    }
+    worker.jobs.push_back(std::move(entry));
+    xSemaphoreGive(worker.lock);
+
+    xTaskNotifyGive(worker.handle);
+    if (!worker.idle && core == ANY_CORE) {
+        wakeIdleWorker(target);
+    }
+
+    return jobId;
+}
+
+size_t WorkerPool::dispatchCompletions() {
+    if (!m_initialized) {
+        return 0;
+    }
+
+    std::vector<WorkerJobFunction> ready;
+    xSemaphoreTake(m_completionLock, portMAX_DELAY);
+    ready.swap(m_completions);
+    xSemaphoreGive(m_completionLock);
+
+    for (auto& callback : ready) {
+        callback();
+    }
+    return ready.size();
+}
+
+bool WorkerPool::getWorkerStats(size_t index, WorkerStats& stats) const {
+    if (index >= m_workers.size()) {
+        return false;
+    }
+
+    const Worker& worker = *m_workers[index];
+    stats.core = worker.core;
+    stats.jobsExecuted = worker.jobsExecuted;
+    stats.jobsStolen = worker.jobsStolen;
+    stats.pending = worker.jobs.size();
+    stats.utilization = worker.utilization;
+    return true;
+}
+
+void WorkerPool::printStats() const {
+    ESP_LOGI(TAG, "=== Worker Pool Statistics ===");
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        WorkerStats stats;
+        getWorkerStats(i, stats);
+        ESP_LOGI(TAG, "Worker %d (core %d): %d%% busy, executed=%d stolen=%d pending=%d",
+                (int)i, stats.core, stats.utilization, stats.jobsExecuted,
+                stats.jobsStolen, stats.pending);
+    }
+}
+
+void WorkerPool::workerTask(void* param) {
+    Worker& worker = *static_cast<Worker*>(param);
+    WorkerPool& pool = *worker.pool;
+
+    while (pool.m_running) {
+        Job job;
+        if (!pool.takeJob(worker, job)) {
+            worker.idle = true;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            updateUtilization(worker);
+            continue;
+        }
+
+        worker.idle = false;
+        uint64_t start = esp_timer_get_time();
+        job.function();
+        worker.busyUs += esp_timer_get_time() - start;
+        worker.jobsExecuted++;
+        updateUtilization(worker);
+
+        if (job.onComplete) {
+            xSemaphoreTake(pool.m_completionLock, portMAX_DELAY);
+            pool.m_completions.push_back(std::move(job.onComplete));
+            xSemaphoreGive(pool.m_completionLock);
+
+            // The callback runs on the main loop, which may be asleep
+            OS().wake();
+        }
+    }
+
+    worker.handle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+bool WorkerPool::takeJob(Worker& worker, Job& job) {
+    // Own work comes off the back (most recently posted, cache-warm)
+    xSemaphoreTake(worker.lock, portMAX_DELAY);
+    if (!worker.jobs.empty()) {
+        job = std::move(worker.jobs.back());
+        worker.jobs.pop_back();
+        xSemaphoreGive(worker.lock);
+        return true;
+    }
+    xSemaphoreGive(worker.lock);
+
+    return stealJob(worker, job);
+}
+
+bool WorkerPool::stealJob(Worker& thief, Job& job) {
+    for (size_t offset = 1; offset < m_workers.size(); offset++) {
+        Worker& victim = *m_workers[(thief.index + offset) % m_workers.size()];
+
+        // Victims are never blocked on: a busy lock just means try the next one
+        if (xSemaphoreTake(victim.lock, 0) != pdTRUE) {
+            continue;
+        }
+
+        // Steal the oldest job that is not pinned to the victim's core
+        for (auto it = victim.jobs.begin(); it != victim.jobs.end(); ++it) {
+            if (!it->pinned) {
+                job = std::move(*it);
+                victim.jobs.erase(it);
+                xSemaphoreGive(victim.lock);
+                thief.jobsStolen++;
+                return true;
+            }
+        }
+        xSemaphoreGive(victim.lock);
+    }
+    return false;
+}
+
+void WorkerPool::wakeIdleWorker(size_t except) {
+    for (auto* worker : m_workers) {
+        if (worker->index != except && worker->idle && worker->handle) {
+            xTaskNotifyGive(worker->handle);
+            return;
+        }
+    }
+}
+
+void WorkerPool::updateUtilization(Worker& worker) {
+    uint64_t now = esp_timer_get_time();
+    uint64_t elapsed = now - worker.windowStartUs;
+    if (elapsed >= UTILIZATION_WINDOW_US) {
+        uint64_t percent = (worker.busyUs * 100) / elapsed;
+        worker.utilization = percent > 100 ? 100 : (uint8_t)percent;
+        worker.busyUs = 0;
+        worker.windowStartUs = now;
+    }
+}
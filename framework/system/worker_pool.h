@@ -0,0 +1,158 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include <deque>
+#include <vector>
+
+/**
+ * @file worker_pool.h
+ * @brief Pinned background worker pool for M5Stack Tab5
+ *
+ * Runs CPU-heavy jobs (file copies, image decoding, formatting) on
+ * FreeRTOS workers pinned to the HP cores so they do not stall the
+ * cooperative main loop. Each worker owns a deque: it pops its own work
+ * from the back and idle workers steal from the front of their peers.
+ * Completion callbacks are queued and invoked from the main loop.
+ */
+
+typedef std::function<void()> WorkerJobFunction;
+
+/**
+ * @brief Per-worker statistics
+ */
+struct WorkerStats {
+    int core;
+    uint32_t jobsExecuted;
+    uint32_t jobsStolen;
+    uint32_t pending;
+    uint8_t utilization;  // Percent busy over the last window
+};
+
+class WorkerPool {
+public:
+    static constexpr int ANY_CORE = -1;
+
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    /**
+     * @brief Start the worker tasks
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize();
+
+    /**
+     * @brief Stop the worker tasks and drop pending jobs
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t shutdown();
+
+    /**
+     * @brief Post a job to the pool
+     * @param job Function to run on a worker
+     * @param onComplete Optional callback run on the main loop afterwards
+     * @param core Core to pin the job to, or ANY_CORE to allow stealing
+     * @param name Optional job name for debugging
+     * @return Job ID or 0 on failure
+     */
+    uint32_t submit(WorkerJobFunction job, WorkerJobFunction onComplete = nullptr,
+                    int core = ANY_CORE, const char* name = nullptr);
+
+    /**
+     * @brief Run completion callbacks of finished jobs (main loop only)
+     * @return Number of callbacks invoked
+     */
+    size_t dispatchCompletions();
+
+    /**
+     * @brief Get statistics for a worker
+     * @param index Worker index
+     * @param stats Output statistics
+     * @return true if the worker exists
+     */
+    bool getWorkerStats(size_t index, WorkerStats& stats) const;
+
+    /**
+     * @brief Get number of workers
+     * @return Worker count
+     */
+    size_t getWorkerCount() const { return m_workers.size(); }
+
+    /**
+     * @brief Print worker statistics
+     */
+    void printStats() const;
+
+private:
+    struct Job {
+        uint32_t id;
+        WorkerJobFunction function;
+        WorkerJobFunction onComplete;
+        const char* name;
+        bool pinned;
+    };
+
+    struct Worker {
+        WorkerPool* pool;
+        size_t index;
+        int core;
+        TaskHandle_t handle;
+        SemaphoreHandle_t lock;
+        std::deque<Job> jobs;
+        volatile bool idle;
+        uint32_t jobsExecuted;
+        uint32_t jobsStolen;
+        uint64_t busyUs;
+        uint64_t windowStartUs;
+        uint8_t utilization;
+    };
+
+    /**
+     * @brief FreeRTOS entry point for a worker
+     * @param param Worker pointer
+     */
+    static void workerTask(void* param);
+
+    /**
+     * @brief Take the next job for a worker, stealing if its deque is empty
+     * @param worker Worker looking for work
+     * @param job Output job
+     * @return true if a job was found
+     */
+    bool takeJob(Worker& worker, Job& job);
+
+    /**
+     * @brief Steal an unpinned job from another worker
+     * @param thief Worker doing the stealing
+     * @param job Output job
+     * @return true if a job was stolen
+     */
+    bool stealJob(Worker& thief, Job& job);
+
+    /**
+     * @brief Wake an idle worker other than the given one
+     * @param except Worker index to skip
+     */
+    void wakeIdleWorker(size_t except);
+
+    /**
+     * @brief Fold busy time into the utilisation estimate
+     * @param worker Worker to update
+     */
+    static void updateUtilization(Worker& worker);
+
+    std::vector<Worker*> m_workers;
+    SemaphoreHandle_t m_completionLock = nullptr;
+    std::vector<WorkerJobFunction> m_completions;
+    uint32_t m_nextJobId = 0;
+    size_t m_nextWorker = 0;
+    volatile bool m_running = false;
+    bool m_initialized = false;
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,80 @@
+#include "frame_governor.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "FrameGovernor";
+
+static bool validRate(uint8_t fps) {
+    return fps >= 1 && fps <= 60;
+}
+
+os_error_t FrameGovernor::setConfig(const FramePacingConfig& config) {
+    if (!validRate(config.interactiveFps) || !validRate(config.activeFps) ||
+        !validRate(config.staticFps) || !validRate(config.lowBatteryFps) ||
+        !validRate(config.criticalBatteryFps)) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    m_config = config;
+    return OS_OK;
+}
+
+uint8_t FrameGovernor::update(const PacingInputs& inputs, uint32_t now) {
+    if (m_lastUpdate != 0) {
+        m_levelTimeMs[(int)m_level] += now - m_lastUpdate;
+    }
+    m_lastUpdate = now;
+
+    if (inputs.animating || inputs.touching) {
+        m_lastInteraction = now;
+        m_lastChange = now;
+    }
+    if (inputs.redrawPending) {
+        m_lastChange = now;
+    }
+
+    if (now - m_lastInteraction < OS_UI_INTERACTION_HOLD_MS) {
+        m_level = PacingLevel::INTERACTIVE;
+    } else if (now - m_lastChange < m_config.staticDelayMs) {
+        m_level = PacingLevel::ACTIVE;
+    } else {
+        m_level = PacingLevel::STATIC;
+    }
+
+    uint8_t fps;
+    if (m_policy == RefreshPolicy::FIXED) {
+        fps = m_fixedFps;
+    } else if (m_level == PacingLevel::INTERACTIVE) {
+        fps = m_config.interactiveFps;
+    } else if (m_level == PacingLevel::ACTIVE) {
+        fps = m_config.activeFps;
+    } else {
+        fps = m_config.staticFps;
+    }
+
+    // Power caps apply to every policy
+    if (m_policy == RefreshPolicy::POWER_SAVE || inputs.batteryLow || inputs.lowPowerMode) {
+        fps = std::min(fps, m_config.lowBatteryFps);
+    }
+    if (inputs.batteryCritical) {
+        fps = std::min(fps, m_config.criticalBatteryFps);
+    }
+    if (inputs.powerIdle) {
+        fps = std::min(fps, m_config.staticFps);
+    }
+
+    if (fps != m_targetFps) {
+        m_targetFps = fps;
+        m_rateChanges++;
+    }
+    return m_targetFps;
+}
+
+void FrameGovernor::printStats() const {
+    static const char* policyNames[] = {"fixed", "adaptive", "power save"};
+    static const char* levelNames[] = {"interactive", "active", "static"};
+
+    ESP_LOGI(TAG, "Policy: %s, level: %s, target: %d FPS",
+             policyNames[(int)m_policy], levelNames[(int)m_level], m_targetFps);
+    ESP_LOGI(TAG, "Time interactive/active/static: %d/%d/%d ms, rate changes: %d",
+             m_levelTimeMs[0], m_levelTimeMs[1], m_levelTimeMs[2], m_rateChanges);
+}
@@ -0,0 +1,126 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include "../system/os_config.h"
+
+/**
+ * @file frame_governor.h
+ * @brief Adaptive LVGL refresh-rate governor
+ *
+ * Picks a render rate from what the UI is doing: the panel rate while
+ * something animates or a finger is down, the normal UI rate while content
+ * keeps changing, and a few Hz once the screen has been static. Battery and
+ * power state cap the result.
+ */
+
+enum class RefreshPolicy {
+    FIXED,      // Always the rate set with UIManager::setRefreshRate()
+    ADAPTIVE,   // Follow activity
+    POWER_SAVE  // Follow activity, capped at the low-battery rate
+};
+
+enum class PacingLevel {
+    INTERACTIVE,    // Animation or touch in progress
+    ACTIVE,         // Content changed recently
+    STATIC          // Nothing changed for staticDelayMs
+};
+
+struct FramePacingConfig {
+    uint8_t interactiveFps = OS_UI_INTERACTIVE_FPS;
+    uint8_t activeFps = OS_UI_REFRESH_RATE;
+    uint8_t staticFps = OS_UI_STATIC_FPS;
+    uint32_t staticDelayMs = OS_UI_STATIC_DELAY_MS;
+    uint8_t lowBatteryFps = OS_UI_LOW_BATTERY_FPS;
+    uint8_t criticalBatteryFps = OS_UI_CRITICAL_BATTERY_FPS;
+};
+
+/**
+ * @brief Inputs sampled once per UI update
+ */
+struct PacingInputs {
+    bool animating = false;
+    bool touching = false;
+    bool redrawPending = false;
+    bool lowPowerMode = false;
+    bool powerIdle = false;         // PowerState other than ACTIVE
+    bool batteryLow = false;        // Low and not charging
+    bool batteryCritical = false;   // Critical and not charging
+};
+
+class FrameGovernor {
+public:
+    FrameGovernor() = default;
+
+    /**
+     * @brief Set pacing policy
+     * @param policy New policy
+     */
+    void setPolicy(RefreshPolicy policy) { m_policy = policy; }
+
+    /**
+     * @brief Get pacing policy
+     * @return Current policy
+     */
+    RefreshPolicy getPolicy() const { return m_policy; }
+
+    /**
+     * @brief Set per-level rates
+     * @param config New configuration (all rates 1-60 FPS)
+     * @return OS_OK on success, OS_ERROR_INVALID_PARAM on bad rates
+     */
+    os_error_t setConfig(const FramePacingConfig& config);
+
+    /**
+     * @brief Get per-level rates
+     * @return Current configuration
+     */
+    const FramePacingConfig& getConfig() const { return m_config; }
+
+    /**
+     * @brief Set rate used by the FIXED policy
+     * @param fps Frames per second
+     */
+    void setFixedRate(uint8_t fps) { m_fixedFps = fps; }
+
+    /**
+     * @brief Evaluate inputs and choose a rate
+     * @param inputs Current UI and power state
+     * @param now Current time in milliseconds
+     * @return Target frames per second
+     */
+    uint8_t update(const PacingInputs& inputs, uint32_t now);
+
+    /**
+     * @brief Get last chosen rate
+     * @return Target FPS
+     */
+    uint8_t getTargetFps() const { return m_targetFps; }
+
+    /**
+     * @brief Get last activity level
+     * @return Pacing level
+     */
+    PacingLevel getLevel() const { return m_level; }
+
+    /**
+     * @brief Print pacing statistics
+     */
+    void printStats() const;
+
+private:
+    RefreshPolicy m_policy = RefreshPolicy::ADAPTIVE;
+    FramePacingConfig m_config;
+    uint8_t m_fixedFps = OS_UI_REFRESH_RATE;
+    uint8_t m_targetFps = OS_UI_REFRESH_RATE;
+    PacingLevel m_level = PacingLevel::ACTIVE;
+
+    uint32_t m_lastInteraction = 0;
+    uint32_t m_lastChange = 0;
+    uint32_t m_lastUpdate = 0;
+
+    // Statistics
+    uint32_t m_levelTimeMs[3] = {};
+    uint32_t m_rateChanges = 0;
+};
+
+#endif // FRAME_GOVERNOR_H
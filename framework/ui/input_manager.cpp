@@ -1,6 +1,7 @@
 #include "input_manager.h"
 #include "../system/os_manager.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 
 static const char* TAG = "InputManager";
 
@@ -28,12 +29,16 @@ os_error_t InputManager::initialize() {
     }
 
     // Subscribe to touch events from HAL
-    SUBSCRIBE_EVENT(EVENT_UI_TOUCH_PRESS, 
-                   [this](const EventData& event) {
-                       if (event.data && event.dataSize >= sizeof(TouchEventData)) {
-                           handleTouchEvent(*(TouchEventData*)event.data);
-                       }
-                   });
+    const EventType touchEvents[] = {EVENT_UI_TOUCH_PRESS, EVENT_UI_TOUCH_MOVE,
+                                     EVENT_UI_TOUCH_RELEASE};
+    for (size_t i = 0; i < 3; i++) {
+        m_touchListeners[i] = SUBSCRIBE_EVENT(touchEvents[i],
+                       [this](const EventData& event) {
+                           if (event.data && event.dataSize >= sizeof(TouchEventData)) {
+                               handleTouchEvent(*(TouchEventData*)event.data);
+                           }
+                       });
+    }
 
     m_initialized = true;
     ESP_LOGI(TAG, "Input Manager initialized");
@@ -48,6 +53,13 @@ os_error_t InputManager::shutdown() {
 
     ESP_LOGI(TAG, "Shutting down Input Manager");
 
+    for (auto& listener : m_touchListeners) {
+        if (listener) {
+            OS().getEventSystem().unsubscribe(listener);
+            listener = 0;
+        }
+    }
+
     // Reset touch state
     s_touched = false;
     s_touchX = 0;
@@ -65,14 +77,72 @@ os_error_t InputManager::update(uint32_t deltaTime) {
     }
 
     // Input processing is handled by LVGL and event callbacks
+    updateLatency();
     return OS_OK;
 }
 
+void InputManager::updateLatency() {
+    if (!m_photonPending) {
+        return;
+    }
+
+    int64_t doneUs = 0;
+    DisplayHAL& display = OS().getHALManager().getDisplay();
+    if (display.getFrameDoneTime(m_photonFrame, doneUs)) {
+        m_photonLatency.add((uint32_t)doneUs - m_photonSampleUs);
+        m_photonPending = false;
+        return;
+    }
+
+    // No frame followed the read: the input changed nothing visible
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    if (nowUs - m_photonReadUs > OS_INPUT_LATENCY_TIMEOUT_MS * 1000 ||
+        display.getFramesStarted() >= m_photonFrame + 4) {
+        m_photonDropped++;
+        m_photonPending = false;
+    }
+}
+
+void InputManager::resetLatencyStats() {
+    m_indevLatency.reset();
+    m_photonLatency.reset();
+    m_photonDropped = 0;
+    m_photonPending = false;
+}
+
+void InputManager::printStats() const {
+    ESP_LOGI(TAG, "=== Input Manager Statistics ===");
+    ESP_LOGI(TAG, "Enabled: %s", m_enabled ? "yes" : "no");
+    ESP_LOGI(TAG, "Touch to indev (us): avg %d, p50 <%d, p95 <%d, max %d, samples %d",
+             m_indevLatency.averageUs(), m_indevLatency.percentileUs(50),
+             m_indevLatency.percentileUs(95), m_indevLatency.maxUs(), m_indevLatency.samples());
+    ESP_LOGI(TAG, "Touch to photon (us): avg %d, p50 <%d, p95 <%d, max %d, samples %d, dropped %d",
+             m_photonLatency.averageUs(), m_photonLatency.percentileUs(50),
+             m_photonLatency.percentileUs(95), m_photonLatency.maxUs(),
+             m_photonLatency.samples(), m_photonDropped);
+
+    uint32_t lower = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        uint32_t upper = LatencyHistogram::bucketLimitUs(i);
+        if (i == LatencyHistogram::BUCKETS - 1) {
+            ESP_LOGI(TAG, "  >= %3d ms: %d", lower / 1000, m_photonLatency.count(i));
+        } else {
+            ESP_LOGI(TAG, "  %3d-%3d ms: %d", lower / 1000, upper / 1000, m_photonLatency.count(i));
+        }
+        lower = upper;
+    }
+}
+
 void InputManager::handleTouchEvent(const TouchEventData& eventData) {
     if (!m_initialized || !m_enabled) {
         return;
     }
 
+    if (eventData.event != TouchEvent::GESTURE) {
+        m_sampleUs = eventData.point.timestamp;
+        m_samplePending = true;
+    }
+
     switch (eventData.event) {
         case TouchEvent::PRESS:
             s_touched = true;
@@ -106,6 +176,7 @@ os_error_t InputManager::initializeLVGLInput() {
     lv_indev_drv_init(&m_inputDriver);
     m_inputDriver.type = LV_INDEV_TYPE_POINTER;
     m_inputDriver.read_cb = lvglInputRead;
+    m_inputDriver.user_data = this;
 
     // Register input device with LVGL
     m_inputDevice = lv_indev_drv_register(&m_inputDriver);
@@ -123,4 +194,26 @@ void InputManager::lvglInputRead(lv_indev_drv_t* indev_drv, lv_indev_data_t* dat
     data->point.x = s_touchX;
     data->point.y = s_touchY;
     data->state = s_touched ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    // Closes the touch driver's interrupt-to-indev latency sample
+    HALManager& hal = OS().getHALManager();
+    if (hal.isInitialized()) {
+        hal.getTouch().onIndevRead();
+    }
+
+    // Start a touch-to-photon sample unless one is still waiting for its frame
+    InputManager* self = static_cast<InputManager*>(indev_drv->user_data);
+    if (!self || !self->m_samplePending || !hal.isInitialized()) {
+        return;
+    }
+    self->m_samplePending = false;
+
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    self->m_indevLatency.add(nowUs - self->m_sampleUs);
+    if (!self->m_photonPending) {
+        self->m_photonPending = true;
+        self->m_photonSampleUs = self->m_sampleUs;
+        self->m_photonReadUs = nowUs;
+        self->m_photonFrame = hal.getDisplay().getFramesStarted() + 1;
+    }
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "../system/os_config.h"
 #include "../hal/touch_hal.h"
+#include "../system/event_system.h"
+#include "../system/latency_histogram.h"
 #include <lvgl.h>
 
 /**
@@ -11,6 +13,13 @@
  * 
  * Manages touch input integration with LVGL and provides
  * high-level input event handling.
+ *
+ * Measures touch-to-photon latency: each touch sample carries its GT911
+ * interrupt time, the LVGL indev read picks one sample at a time, and the
+ * sample completes when the first frame rendered after that read has
+ * finished flushing (LVGL renders an input's invalidations in the refresh
+ * that follows the read). Samples with no frame within
+ * OS_INPUT_LATENCY_TIMEOUT_MS changed nothing on screen and are dropped.
  */
 
 class InputManager {
@@ -55,6 +64,22 @@ public:
      */
     bool isEnabled() const { return m_enabled; }
 
+    /**
+     * @brief Get touch-to-photon latency distribution
+     * @return Histogram of interrupt-to-flush-complete times
+     */
+    const LatencyHistogram& getPhotonLatency() const { return m_photonLatency; }
+
+    /**
+     * @brief Clear latency measurements
+     */
+    void resetLatencyStats();
+
+    /**
+     * @brief Print input and latency statistics
+     */
+    void printStats() const;
+
 private:
     /**
      * @brief Initialize LVGL input device
@@ -69,6 +94,11 @@ private:
      */
     static void lvglInputRead(lv_indev_drv_t* indev_drv, lv_indev_data_t* data);
 
+    /**
+     * @brief Resolve the in-flight latency sample against display frames
+     */
+    void updateLatency();
+
     // Input state
     bool m_initialized = false;
     bool m_enabled = true;
@@ -76,6 +106,18 @@ private:
     // LVGL input device
     lv_indev_drv_t m_inputDriver;
     lv_indev_t* m_inputDevice = nullptr;
+    ListenerId m_touchListeners[3] = {};
+
+    // Touch-to-photon measurement; one sample in flight at a time
+    bool m_samplePending = false;       // Newer touch sample than LVGL has read
+    uint32_t m_sampleUs = 0;            // Latest sample's interrupt time
+    bool m_photonPending = false;       // Read by LVGL, waiting for its frame
+    uint32_t m_photonSampleUs = 0;
+    uint32_t m_photonReadUs = 0;
+    uint32_t m_photonFrame = 0;         // First frame that can show the sample
+    LatencyHistogram m_indevLatency;    // Interrupt to LVGL indev read
+    LatencyHistogram m_photonLatency;   // Interrupt to frame flush complete
+    uint32_t m_photonDropped = 0;
     
     // Touch state for LVGL
     static bool s_touched;
@@ -1,10 +1,14 @@
 #include "screen_manager.h"
 #include "../system/os_manager.h"
 #include <esp_log.h>
+#include <esp_heap_caps.h>
 #include <algorithm>
 
 static const char* TAG = "ScreenManager";
 
+// Animation progress resolution for transitions
+static constexpr int32_t TRANSITION_STEPS = 1024;
+
 ScreenManager::~ScreenManager() {
     shutdown();
 }
@@ -34,12 +38,16 @@ os_error_t ScreenManager::shutdown() {
 
     ESP_LOGI(TAG, "Shutting down Screen Manager");
 
+    finishTransition();
+
     // Destroy all screens
     for (auto& [name, info] : m_screens) {
         destroyScreen(name);
     }
 
     m_screens.clear();
+    m_cachedBytes = 0;
+    m_builtScreens = 0;
     m_screenHistory.clear();
     m_currentScreenName.clear();
 
@@ -63,6 +71,8 @@ os_error_t ScreenManager::update(uint32_t deltaTime) {
         lastCleanup = now;
     }
 
+    prebuildIdle();
+
     return OS_OK;
 }
 
@@ -87,6 +97,7 @@ os_error_t ScreenManager::registerScreen(const std::string& name,
     info.persistent = persistent;
     info.createTime = 0;
     info.lastAccess = 0;
+    info.memoryBytes = 0;
 
     m_screens[name] = info;
 
@@ -115,6 +126,11 @@ os_error_t ScreenManager::unregisterScreen(const std::string& name) {
     destroyScreen(name);
     m_screens.erase(it);
 
+    // Forget it as a successor of other screens
+    for (auto& [otherName, info] : m_screens) {
+        info.successors.erase(name);
+    }
+
     ESP_LOGD(TAG, "Unregistered screen '%s'", name.c_str());
 
     return OS_OK;
@@ -140,18 +156,31 @@ os_error_t ScreenManager::switchToScreen(const std::string& name,
     // Get current screen
     lv_obj_t* currentScreen = getCurrentScreen();
 
-    // Create new screen if needed
+    // Create new screen if needed (rebuilds evicted screens)
+    if (m_screens[name].screen) {
+        m_cacheHits++;
+    } else {
+        m_cacheMisses++;
+    }
     lv_obj_t* newScreen = createScreen(name);
     if (!newScreen) {
         ESP_LOGE(TAG, "Failed to create screen '%s'", name.c_str());
         return OS_ERROR_GENERIC;
     }
 
-    // Apply transition animation
+    // Animate (or directly load) the new screen
     applyTransition(currentScreen, newScreen, transition, animationTime);
 
     // Update navigation state
     if (!m_currentScreenName.empty()) {
+        // Learn which screens follow which, for prebuilding
+        auto& successors = m_screens[m_currentScreenName].successors;
+        if (++successors[name] == UINT16_MAX) {
+            for (auto& [next, count] : successors) {
+                count /= 2;
+            }
+        }
+
         m_screenHistory.push_back(m_currentScreenName);
         
         // Limit history size
@@ -162,12 +191,13 @@ os_error_t ScreenManager::switchToScreen(const std::string& name,
 
     m_currentScreenName = name;
     updateAccessTime(name);
-
-    // Set as active screen
-    lv_scr_load(newScreen);
+    m_lastSwitch = millis();
 
     m_totalTransitions++;
 
+    // The new screen is current now, so it can't evict itself
+    cleanupScreens();
+
     ESP_LOGD(TAG, "Switched to screen '%s'", name.c_str());
     PUBLISH_EVENT(EVENT_UI_SCREEN_CHANGE, (void*)name.c_str(), name.length());
 
@@ -235,19 +265,25 @@ void ScreenManager::printStats() const {
     ESP_LOGI(TAG, "Total transitions: %d", m_totalTransitions);
     ESP_LOGI(TAG, "Screen creations: %d", m_screenCreations);
     ESP_LOGI(TAG, "Screen destructions: %d", m_screenDestructions);
+    ESP_LOGI(TAG, "Cache: %d screens, %d/%d bytes, hits: %d, misses: %d, evictions: %d, prebuilds: %d",
+             m_builtScreens, m_cachedBytes, m_cacheBudget, m_cacheHits, m_cacheMisses,
+             m_evictions, m_prebuilds);
+    ESP_LOGI(TAG, "Snapshot transitions: %d, fallbacks to direct load: %d",
+             m_snapshotTransitions, m_transitionFallbacks);
 
     ESP_LOGI(TAG, "=== Screen Details ===");
     for (const auto& [name, info] : m_screens) {
-        ESP_LOGI(TAG, "Screen '%s': %s, persistent: %s, created: %s",
+        ESP_LOGI(TAG, "Screen '%s': %s, persistent: %s, created: %s, size: %d bytes",
                 name.c_str(),
                 info.screen ? "in memory" : "not loaded",
                 info.persistent ? "yes" : "no",
-                info.createTime > 0 ? "yes" : "no");
+                info.createTime > 0 ? "yes" : "no",
+                info.memoryBytes);
     }
 }
 
 void ScreenManager::cleanupScreens() {
-    if (m_screens.size() <= m_maxScreens) {
+    if (m_builtScreens <= m_maxScreens && m_cachedBytes <= m_cacheBudget) {
         return;
     }
 
@@ -266,16 +302,116 @@ void ScreenManager::cleanupScreens() {
                   return a.second < b.second;
               });
 
-    // Clean up oldest screens
-    size_t toRemove = m_screens.size() - m_maxScreens;
-    for (size_t i = 0; i < std::min(toRemove, candidates.size()); i++) {
-        destroyScreen(candidates[i].first);
+    // Evict oldest screens until back within both limits
+    size_t evicted = 0;
+    for (const auto& candidate : candidates) {
+        if (m_builtScreens <= m_maxScreens && m_cachedBytes <= m_cacheBudget) {
+            break;
+        }
+        destroyScreen(candidate.first);
+        evicted++;
+    }
+
+    if (evicted > 0) {
+        m_evictions += evicted;
+        ESP_LOGD(TAG, "Evicted %d screens, cache now %d/%d bytes",
+                evicted, m_cachedBytes, m_cacheBudget);
+    }
+}
+
+void ScreenManager::setCacheBudget(size_t bytes) {
+    m_cacheBudget = bytes;
+    cleanupScreens();
+}
+
+os_error_t ScreenManager::prebuildScreen(const std::string& name) {
+    if (!m_initialized || !hasScreen(name)) {
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    if (m_screens[name].screen) {
+        return OS_OK;
+    }
+
+    if (!createScreen(name)) {
+        return OS_ERROR_GENERIC;
+    }
+
+    // Not visited yet: make it the first candidate if the budget is tight
+    m_screens[name].lastAccess = 0;
+    m_prebuilds++;
+    cleanupScreens();
+
+    ESP_LOGD(TAG, "Prebuilt screen '%s'", name.c_str());
+    return OS_OK;
+}
+
+std::string ScreenManager::predictNextScreen() const {
+    auto current = m_screens.find(m_currentScreenName);
+    if (current == m_screens.end()) {
+        return "";
+    }
+
+    // Most frequent successor that isn't built yet
+    std::string best;
+    uint16_t bestCount = 0;
+    for (const auto& [name, count] : current->second.successors) {
+        auto it = m_screens.find(name);
+        if (it != m_screens.end() && !it->second.screen && count > bestCount) {
+            best = name;
+            bestCount = count;
+        }
+    }
+
+    // Otherwise the screen goBack() would return to
+    if (best.empty() && !m_screenHistory.empty()) {
+        auto it = m_screens.find(m_screenHistory.back());
+        if (it != m_screens.end() && !it->second.screen) {
+            best = it->first;
+        }
+    }
+    return best;
+}
+
+void ScreenManager::prebuildIdle() {
+    if (!m_prebuildEnabled || m_currentScreenName.empty()) {
+        return;
     }
 
-    if (!candidates.empty()) {
-        ESP_LOGD(TAG, "Cleaned up %d unused screens", 
-                std::min(toRemove, candidates.size()));
+    // Only when nothing is animating and input has been quiet
+    uint32_t now = millis();
+    if (now - m_lastSwitch < OS_UI_SCREEN_PREBUILD_IDLE_MS ||
+        lv_disp_get_inactive_time(nullptr) < OS_UI_SCREEN_PREBUILD_IDLE_MS ||
+        lv_anim_count_running() > 0) {
+        return;
     }
+
+    std::string next = predictNextScreen();
+    if (next.empty()) {
+        return;
+    }
+
+    // Prebuilding must not evict anything; the last build size is the estimate
+    size_t estimate = m_screens[next].memoryBytes;
+    if (m_builtScreens >= m_maxScreens || m_cachedBytes + estimate > m_cacheBudget) {
+        return;
+    }
+
+    prebuildScreen(next);
+}
+
+size_t ScreenManager::lvglHeapUsed() {
+#if LV_MEM_CUSTOM
+    // LVGL allocates with the system malloc, which lv_mem_monitor() cannot
+    // see; measure the default heap instead. Other tasks allocating during
+    // a build add noise, but the delta is dominated by the screen's objects.
+    return heap_caps_get_total_size(MALLOC_CAP_DEFAULT) -
+           heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#else
+    lv_mem_monitor_t monitor;
+    lv_mem_monitor(&monitor);
+    return monitor.total_size - monitor.free_size;
+#endif
 }
 
 lv_obj_t* ScreenManager::createScreen(const std::string& name) {
@@ -292,7 +428,8 @@ lv_obj_t* ScreenManager::createScreen(const std::string& name) {
         return info.screen;
     }
 
-    // Create new screen
+    // Create new screen, measuring the LVGL heap it takes
+    size_t heapBefore = lvglHeapUsed();
     info.screen = lv_obj_create(nullptr);
     if (!info.screen) {
         ESP_LOGE(TAG, "Failed to create LVGL screen object");
@@ -310,6 +447,11 @@ lv_obj_t* ScreenManager::createScreen(const std::string& name) {
         updateAccessTime(name);
         m_screenCreations++;
 
+        size_t heapAfter = lvglHeapUsed();
+        info.memoryBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+        m_cachedBytes += info.memoryBytes;
+        m_builtScreens++;
+
         ESP_LOGD(TAG, "Created screen '%s'", name.c_str());
     } catch (...) {
         ESP_LOGE(TAG, "Exception in screen create callback for '%s'", name.c_str());
@@ -342,6 +484,8 @@ void ScreenManager::destroyScreen(const std::string& name) {
     lv_obj_del(info.screen);
     info.screen = nullptr;
     info.createTime = 0;
+    m_cachedBytes -= std::min(m_cachedBytes, info.memoryBytes);
+    m_builtScreens--;
     
     m_screenDestructions++;
 
@@ -350,38 +494,174 @@ void ScreenManager::destroyScreen(const std::string& name) {
 
 void ScreenManager::applyTransition(lv_obj_t* fromScreen, lv_obj_t* toScreen,
                                    ScreenTransition transition, uint32_t animationTime) {
+    // A new switch cuts the previous transition short
+    finishTransition();
+
     if (!toScreen) return;
 
-    // For now, implement simple transitions
-    // In a full implementation, this would handle complex animations
-    
-    switch (transition) {
-        case ScreenTransition::FADE:
-            // Simple fade transition
-            lv_obj_set_style_opa(toScreen, LV_OPA_TRANSP, 0);
-            lv_anim_t anim;
-            lv_anim_init(&anim);
-            lv_anim_set_var(&anim, toScreen);
-            lv_anim_set_values(&anim, LV_OPA_TRANSP, LV_OPA_COVER);
-            lv_anim_set_time(&anim, animationTime);
-            lv_anim_set_exec_cb(&anim, (lv_anim_exec_xcb_t)lv_obj_set_style_opa);
-            lv_anim_start(&anim);
-            break;
+    if (transition == ScreenTransition::NONE || !fromScreen || animationTime == 0) {
+        lv_scr_load(toScreen);
+        return;
+    }
+
+    // Capture both screens once; the animation then only moves two images
+    lv_obj_update_layout(toScreen);
+    if (!takeSnapshot(fromScreen, m_transition.fromDsc, m_transition.fromBuffer) ||
+        !takeSnapshot(toScreen, m_transition.toDsc, m_transition.toBuffer)) {
+        ESP_LOGW(TAG, "Snapshot failed, switching without animation");
+        releaseSnapshots();
+        m_transitionFallbacks++;
+        lv_scr_load(toScreen);
+        return;
+    }
+
+    m_transition.overlay = lv_obj_create(nullptr);
+    lv_obj_remove_style_all(m_transition.overlay);
+    lv_obj_set_size(m_transition.overlay, LV_HOR_RES, LV_VER_RES);
+    lv_obj_set_style_bg_color(m_transition.overlay, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(m_transition.overlay, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(m_transition.overlay, LV_OBJ_FLAG_SCROLLABLE);
+
+    // Zoom-out shrinks the outgoing image on top of the incoming one
+    if (transition == ScreenTransition::ZOOM_OUT) {
+        m_transition.toImage = lv_img_create(m_transition.overlay);
+        m_transition.fromImage = lv_img_create(m_transition.overlay);
+    } else {
+        m_transition.fromImage = lv_img_create(m_transition.overlay);
+        m_transition.toImage = lv_img_create(m_transition.overlay);
+    }
+    lv_img_set_src(m_transition.fromImage, &m_transition.fromDsc);
+    lv_img_set_src(m_transition.toImage, &m_transition.toDsc);
+
+    m_transition.target = toScreen;
+    m_transition.type = transition;
+    transitionAnimCallback(this, 0);
+    lv_scr_load(m_transition.overlay);
+
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, this);
+    lv_anim_set_values(&anim, 0, TRANSITION_STEPS);
+    lv_anim_set_time(&anim, animationTime);
+    lv_anim_set_exec_cb(&anim, transitionAnimCallback);
+    lv_anim_set_path_cb(&anim, lv_anim_path_ease_out);
+    lv_anim_set_ready_cb(&anim, transitionReadyCallback);
+    lv_anim_start(&anim);
+
+    m_snapshotTransitions++;
+}
+
+bool ScreenManager::takeSnapshot(lv_obj_t* screen, lv_img_dsc_t& dsc, void*& buffer) {
+    uint32_t size = lv_snapshot_buf_size_needed(screen, LV_IMG_CF_TRUE_COLOR);
+    if (size == 0) {
+        return false;
+    }
+
+    // Full-screen images don't fit the LVGL heap; PSRAM is also PPA-readable
+    buffer = OS_MALLOC_PSRAM(size);
+    if (!buffer) {
+        return false;
+    }
+
+    if (lv_snapshot_take_to_buf(screen, LV_IMG_CF_TRUE_COLOR, &dsc, buffer, size) != LV_RES_OK) {
+        OS_FREE(buffer);
+        buffer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ScreenManager::releaseSnapshots() {
+    if (m_transition.fromBuffer) {
+        lv_img_cache_invalidate_src(&m_transition.fromDsc);
+        OS_FREE(m_transition.fromBuffer);
+        m_transition.fromBuffer = nullptr;
+    }
+    if (m_transition.toBuffer) {
+        lv_img_cache_invalidate_src(&m_transition.toDsc);
+        OS_FREE(m_transition.toBuffer);
+        m_transition.toBuffer = nullptr;
+    }
+}
+
+void ScreenManager::finishTransition() {
+    if (!m_transition.overlay) {
+        return;
+    }
+
+    lv_anim_del(this, transitionAnimCallback);
 
+    lv_obj_t* overlay = m_transition.overlay;
+    m_transition.overlay = nullptr;
+    m_transition.fromImage = nullptr;
+    m_transition.toImage = nullptr;
+
+    if (m_transition.target) {
+        lv_scr_load(m_transition.target);
+        m_transition.target = nullptr;
+    }
+    lv_obj_del(overlay);
+    releaseSnapshots();
+}
+
+void ScreenManager::transitionAnimCallback(void* var, int32_t progress) {
+    ScreenManager* self = static_cast<ScreenManager*>(var);
+    TransitionState& t = self->m_transition;
+    if (!t.overlay) {
+        return;
+    }
+
+    lv_coord_t w = LV_HOR_RES;
+    lv_coord_t h = LV_VER_RES;
+    lv_coord_t dx = (lv_coord_t)((w * progress) / TRANSITION_STEPS);
+    lv_coord_t dy = (lv_coord_t)((h * progress) / TRANSITION_STEPS);
+
+    // Zoom in 1/16 steps, which the PPA scales exactly
+    uint16_t zoomDelta = (uint16_t)((128 * progress) / TRANSITION_STEPS) & ~15;
+
+    switch (t.type) {
         case ScreenTransition::SLIDE_LEFT:
+            lv_obj_set_x(t.fromImage, -dx);
+            lv_obj_set_x(t.toImage, w - dx);
+            break;
+
         case ScreenTransition::SLIDE_RIGHT:
+            lv_obj_set_x(t.fromImage, dx);
+            lv_obj_set_x(t.toImage, dx - w);
+            break;
+
         case ScreenTransition::SLIDE_UP:
+            lv_obj_set_y(t.fromImage, -dy);
+            lv_obj_set_y(t.toImage, h - dy);
+            break;
+
         case ScreenTransition::SLIDE_DOWN:
-            // TODO: Implement slide transitions
+            lv_obj_set_y(t.fromImage, dy);
+            lv_obj_set_y(t.toImage, dy - h);
+            break;
+
+        case ScreenTransition::FADE:
+            lv_obj_set_style_img_opa(t.toImage, (lv_opa_t)((LV_OPA_COVER * progress) / TRANSITION_STEPS), 0);
+            break;
+
+        case ScreenTransition::ZOOM_IN:
+            // Opaque images keep the zoom on the PPA scaling path
+            lv_img_set_zoom(t.toImage, LV_IMG_ZOOM_NONE / 2 + zoomDelta);
+            break;
+
+        case ScreenTransition::ZOOM_OUT:
+            lv_img_set_zoom(t.fromImage, LV_IMG_ZOOM_NONE - zoomDelta);
             break;
 
-        case ScreenTransition::NONE:
         default:
-            // No animation, just show the screen
             break;
     }
 }
 
+void ScreenManager::transitionReadyCallback(lv_anim_t* anim) {
+    static_cast<ScreenManager*>(anim->var)->finishTransition();
+}
+
 void ScreenManager::updateAccessTime(const std::string& name) {
     auto it = m_screens.find(name);
     if (it != m_screens.end()) {
@@ -13,6 +13,16 @@
  * 
  * Manages screen transitions, history, and provides
  * a framework for creating and managing UI screens.
+ *
+ * Built screens form a cache bounded by a byte budget of LVGL heap. When
+ * the budget is exceeded the least recently used non-persistent screens
+ * have their object trees destroyed; they are rebuilt from their create
+ * callback on the next switchToScreen(). While input is idle, the screen
+ * most often visited next from the current one is prebuilt if it fits.
+ *
+ * Animated transitions render both screens once into PSRAM snapshots and
+ * then animate only the two images on a temporary screen, so their cost
+ * does not depend on how complex the screens are.
  */
 
 typedef std::function<void(lv_obj_t*)> ScreenCallback;
@@ -36,6 +46,8 @@ struct ScreenInfo {
     bool persistent;
     uint32_t createTime;
     uint32_t lastAccess;
+    size_t memoryBytes;     // LVGL heap used by the last build (kept after eviction)
+    std::map<std::string, uint16_t> successors; // Switch counts to other screens
 };
 
 class ScreenManager {
@@ -66,7 +78,9 @@ public:
      * @brief Register a screen
      * @param name Screen name/identifier
      * @param createCallback Function to create screen content
-     * @param destroyCallback Function to cleanup screen (optional)
+     * @param destroyCallback Function to cleanup screen (optional); non-persistent
+     *        screens can be evicted whenever they are not current, so this must
+     *        drop any pointers into the screen's object tree
      * @param persistent True to keep screen in memory
      * @return OS_OK on success, error code on failure
      */
@@ -142,13 +156,44 @@ public:
      */
     void setMaxScreens(size_t maxScreens) { m_maxScreens = maxScreens; }
 
+    /**
+     * @brief Set LVGL heap budget for built screens
+     * @param bytes Budget in bytes
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Get LVGL heap budget for built screens
+     * @return Budget in bytes
+     */
+    size_t getCacheBudget() const { return m_cacheBudget; }
+
+    /**
+     * @brief Get LVGL heap currently held by built screens
+     * @return Bytes in use
+     */
+    size_t getCachedBytes() const { return m_cachedBytes; }
+
+    /**
+     * @brief Enable/disable idle-time prebuilding of likely next screens
+     * @param enabled True to prebuild
+     */
+    void setPrebuildEnabled(bool enabled) { m_prebuildEnabled = enabled; }
+
+    /**
+     * @brief Build a screen without switching to it
+     * @param name Screen name
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t prebuildScreen(const std::string& name);
+
     /**
      * @brief Get screen statistics
      */
     void printStats() const;
 
     /**
-     * @brief Force cleanup of unused screens
+     * @brief Evict least recently used screens until within count and byte limits
      */
     void cleanupScreens();
 
@@ -167,7 +212,7 @@ private:
     void destroyScreen(const std::string& name);
 
     /**
-     * @brief Apply transition animation
+     * @brief Apply transition animation and load the target screen
      * @param fromScreen Source screen
      * @param toScreen Target screen
      * @param transition Transition type
@@ -176,12 +221,51 @@ private:
     void applyTransition(lv_obj_t* fromScreen, lv_obj_t* toScreen,
                         ScreenTransition transition, uint32_t animationTime);
 
+    /**
+     * @brief Render a screen into a PSRAM image
+     * @param screen Screen to capture
+     * @param dsc Image descriptor to fill
+     * @param buffer Receives the allocated pixel buffer
+     * @return true on success, false on failure
+     */
+    bool takeSnapshot(lv_obj_t* screen, lv_img_dsc_t& dsc, void*& buffer);
+
+    /**
+     * @brief Free transition snapshots
+     */
+    void releaseSnapshots();
+
+    /**
+     * @brief Load the target of a running transition and remove its images
+     */
+    void finishTransition();
+
+    static void transitionAnimCallback(void* var, int32_t progress);
+    static void transitionReadyCallback(lv_anim_t* anim);
+
     /**
      * @brief Update screen access time
      * @param name Screen name
      */
     void updateAccessTime(const std::string& name);
 
+    /**
+     * @brief Pick the screen to prebuild from the current one
+     * @return Screen name or empty string if nothing to do
+     */
+    std::string predictNextScreen() const;
+
+    /**
+     * @brief Prebuild the predicted next screen when input is idle
+     */
+    void prebuildIdle();
+
+    /**
+     * @brief Get the heap LVGL allocates from currently in use
+     * @return Bytes used (the whole default heap with LV_MEM_CUSTOM)
+     */
+    static size_t lvglHeapUsed();
+
     // Screen registry
     std::map<std::string, ScreenInfo> m_screens;
     
@@ -192,11 +276,38 @@ private:
     // Configuration
     size_t m_maxScreens = 5;
     size_t m_maxHistory = 10;
+    size_t m_cacheBudget = OS_UI_SCREEN_CACHE_BYTES;
+    bool m_prebuildEnabled = true;
+
+    // Cache state
+    size_t m_cachedBytes = 0;
+    size_t m_builtScreens = 0;
+    uint32_t m_lastSwitch = 0;
+
+    // Snapshot transition in progress
+    struct TransitionState {
+        lv_obj_t* overlay = nullptr;    // Temporary screen holding both images
+        lv_obj_t* fromImage = nullptr;
+        lv_obj_t* toImage = nullptr;
+        lv_obj_t* target = nullptr;
+        ScreenTransition type = ScreenTransition::NONE;
+        lv_img_dsc_t fromDsc = {};
+        lv_img_dsc_t toDsc = {};
+        void* fromBuffer = nullptr;
+        void* toBuffer = nullptr;
+    };
+    TransitionState m_transition;
     
     // Statistics
     uint32_t m_totalTransitions = 0;
     uint32_t m_screenCreations = 0;
     uint32_t m_screenDestructions = 0;
+    uint32_t m_cacheHits = 0;
+    uint32_t m_cacheMisses = 0;
+    uint32_t m_evictions = 0;
+    uint32_t m_prebuilds = 0;
+    uint32_t m_snapshotTransitions = 0;
+    uint32_t m_transitionFallbacks = 0;
     
     bool m_initialized = false;
 };
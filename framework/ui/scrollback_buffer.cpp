@@ -0,0 +1,147 @@
+#include "scrollback_buffer.h"
+#include "../system/os_manager.h"
+#include "../system/memory_arena.h"
+#include <algorithm>
+#include <cstring>
+
+ScrollbackBuffer::~ScrollbackBuffer() {
+    release();
+}
+
+os_error_t ScrollbackBuffer::initialize(size_t maxLines, size_t maxBytes, MemoryArena* arena) {
+    release();
+    if (maxLines == 0 || maxBytes == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    m_arenaBacked = arena != nullptr;
+    if (arena) {
+        m_text = (char*)arena->allocate(maxBytes);
+        m_lines = (LineRef*)arena->allocate(maxLines * sizeof(LineRef), alignof(LineRef));
+    } else {
+        m_text = (char*)OS_MALLOC_PSRAM(maxBytes);
+        m_lines = (LineRef*)OS_MALLOC_PSRAM(maxLines * sizeof(LineRef));
+    }
+    if (!m_text || !m_lines) {
+        release();
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_textCapacity = maxBytes;
+    m_lineCapacity = maxLines;
+    clear();
+    m_evicted = 0;
+    return OS_OK;
+}
+
+void ScrollbackBuffer::release() {
+    // Arena memory is reclaimed when the owning app's arena is released
+    if (m_text && !m_arenaBacked) {
+        OS_FREE(m_text);
+    }
+    if (m_lines && !m_arenaBacked) {
+        OS_FREE(m_lines);
+    }
+    m_text = nullptr;
+    m_lines = nullptr;
+    m_arenaBacked = false;
+    m_textCapacity = 0;
+    m_lineCapacity = 0;
+    m_firstLine += (uint32_t)m_count;
+    m_count = 0;
+    m_bytesUsed = 0;
+}
+
+bool ScrollbackBuffer::append(const char* text, size_t length) {
+    if (!m_text || !text) {
+        return false;
+    }
+
+    length = std::min(length, std::min(m_textCapacity - 1, (size_t)UINT16_MAX));
+
+    if (m_count == m_lineCapacity) {
+        evictOldest();
+    }
+    uint32_t offset;
+    while (!findSpace(length, offset)) {
+        evictOldest();
+    }
+
+    memcpy(m_text + offset, text, length);
+    m_textTail = offset + (uint32_t)length;
+
+    LineRef& line = m_lines[(m_firstIndex + m_count) % m_lineCapacity];
+    line.offset = offset;
+    line.length = (uint16_t)length;
+    m_count++;
+    m_bytesUsed += length;
+    return true;
+}
+
+void ScrollbackBuffer::clear() {
+    m_firstLine += (uint32_t)m_count;
+    m_firstIndex = 0;
+    m_count = 0;
+    m_textTail = 0;
+    m_bytesUsed = 0;
+}
+
+const char* ScrollbackBuffer::getLine(uint32_t lineNumber, size_t& length) const {
+    uint32_t index = lineNumber - m_firstLine;
+    if (lineNumber < m_firstLine || index >= m_count) {
+        length = 0;
+        return nullptr;
+    }
+
+    const LineRef& line = m_lines[(m_firstIndex + index) % m_lineCapacity];
+    length = line.length;
+    return m_text + line.offset;
+}
+
+size_t ScrollbackBuffer::getMemoryUsage() const {
+    return m_textCapacity + m_lineCapacity * sizeof(LineRef);
+}
+
+bool ScrollbackBuffer::findSpace(size_t length, uint32_t& offset) const {
+    if (m_count == 0) {
+        offset = 0;
+        return true;
+    }
+
+    // Live text runs from the oldest line to the tail, possibly wrapped.
+    // Strict comparisons keep tail != head while lines are stored.
+    uint32_t head = m_lines[m_firstIndex].offset;
+    if (m_textTail >= head) {
+        if (m_textTail + length <= m_textCapacity) {
+            offset = m_textTail;
+            return true;
+        }
+        if (length < head) {
+            offset = 0;     // The unused end of the pool is skipped
+            return true;
+        }
+        return false;
+    }
+
+    if (m_textTail + length < head) {
+        offset = m_textTail;
+        return true;
+    }
+    return false;
+}
+
+void ScrollbackBuffer::evictOldest() {
+    if (m_count == 0) {
+        return;
+    }
+
+    m_bytesUsed -= m_lines[m_firstIndex].length;
+    m_firstIndex = (m_firstIndex + 1) % m_lineCapacity;
+    m_count--;
+    m_firstLine++;
+    m_evicted++;
+    if (m_count == 0) {
+        m_firstIndex = 0;
+        m_textTail = 0;
+    }
+}
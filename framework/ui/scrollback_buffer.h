@@ -0,0 +1,127 @@
+#ifndef SCROLLBACK_BUFFER_H
+#define SCROLLBACK_BUFFER_H
+
+#include "../system/os_config.h"
+
+class MemoryArena;
+
+/**
+ * @file scrollback_buffer.h
+ * @brief Bounded line store for terminal scrollback
+ *
+ * Keeps the newest lines of a terminal within a fixed line count and a
+ * fixed text pool, both allocated once in PSRAM. Each line is stored
+ * contiguously; appending evicts the oldest lines until the new one fits,
+ * so an endless capture costs constant memory and O(line) time per append.
+ *
+ * Lines are addressed by an absolute line number that keeps increasing
+ * across evictions, so views can hold on to a position while old lines
+ * scroll out. When given an application arena the storage is carved from
+ * it and goes away with the app instead of being freed by release().
+ * Not thread-safe; TerminalView serializes access.
+ */
+
+class ScrollbackBuffer {
+public:
+    ScrollbackBuffer() = default;
+    ~ScrollbackBuffer();
+
+    ScrollbackBuffer(const ScrollbackBuffer&) = delete;
+    ScrollbackBuffer& operator=(const ScrollbackBuffer&) = delete;
+
+    /**
+     * @brief Allocate the line index and text pool
+     * @param maxLines Maximum number of lines kept
+     * @param maxBytes Text pool size in bytes
+     * @param arena Application arena to allocate from (nullptr = app heap)
+     * @return OS_OK on success, OS_ERROR_NO_MEMORY if PSRAM is exhausted
+     */
+    os_error_t initialize(size_t maxLines, size_t maxBytes, MemoryArena* arena = nullptr);
+
+    /**
+     * @brief Free all storage
+     */
+    void release();
+
+    /**
+     * @brief Append one line, evicting the oldest lines if needed
+     * @param text Line text (no newline, need not be NUL terminated)
+     * @param length Text length; longer lines are truncated to 64 KB or the pool size
+     * @return true if stored
+     */
+    bool append(const char* text, size_t length);
+
+    /**
+     * @brief Drop all lines (line numbers keep counting)
+     */
+    void clear();
+
+    /**
+     * @brief Get a stored line
+     * @param lineNumber Absolute line number in [getFirstLine(), getEndLine())
+     * @param length Set to the line length
+     * @return Line text (not NUL terminated), or nullptr if not stored
+     */
+    const char* getLine(uint32_t lineNumber, size_t& length) const;
+
+    /**
+     * @brief Absolute number of the oldest stored line
+     */
+    uint32_t getFirstLine() const { return m_firstLine; }
+
+    /**
+     * @brief Absolute number one past the newest stored line
+     */
+    uint32_t getEndLine() const { return m_firstLine + (uint32_t)m_count; }
+
+    /**
+     * @brief Number of stored lines
+     */
+    size_t getLineCount() const { return m_count; }
+
+    /**
+     * @brief Text bytes held by stored lines
+     */
+    size_t getBytesUsed() const { return m_bytesUsed; }
+
+    /**
+     * @brief Allocated storage (index plus text pool)
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * @brief Lines evicted to make room since initialize()
+     */
+    uint32_t getEvictedLines() const { return m_evicted; }
+
+private:
+    struct LineRef {
+        uint32_t offset;
+        uint16_t length;
+    };
+
+    /**
+     * @brief Find a contiguous region for length bytes without evicting
+     * @param offset Set to the region start
+     * @return true if the region is free
+     */
+    bool findSpace(size_t length, uint32_t& offset) const;
+
+    void evictOldest();
+
+    bool m_arenaBacked = false;     // Storage belongs to an app arena
+    char* m_text = nullptr;
+    size_t m_textCapacity = 0;
+    uint32_t m_textTail = 0;        // Next write position; may equal capacity
+
+    LineRef* m_lines = nullptr;
+    size_t m_lineCapacity = 0;
+    size_t m_firstIndex = 0;        // Slot of the oldest line in m_lines
+    size_t m_count = 0;
+    uint32_t m_firstLine = 0;
+
+    size_t m_bytesUsed = 0;
+    uint32_t m_evicted = 0;
+};
+
+#endif // SCROLLBACK_BUFFER_H
@@ -0,0 +1,268 @@
+#include "terminal_view.h"
+#include "../system/os_manager.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t NO_LINE = UINT32_MAX;
+static constexpr lv_coord_t VIEW_PADDING = 4;
+
+TerminalView::~TerminalView() {
+    shutdown();
+}
+
+os_error_t TerminalView::initialize(size_t maxLines, size_t maxBytes, MemoryArena* arena) {
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+        if (!m_mutex) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    lock();
+    os_error_t result = m_scrollback.initialize(maxLines, maxBytes, arena);
+    m_topLine = m_scrollback.getFirstLine();
+    m_follow = true;
+    unlock();
+    return result;
+}
+
+void TerminalView::shutdown() {
+    if (m_container) {
+        lv_obj_del(m_container);
+    }
+
+    lock();
+    m_scrollback.release();
+    unlock();
+
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+lv_obj_t* TerminalView::create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height,
+                               const lv_font_t* font, lv_color_t color) {
+    if (m_container || !parent || !font) {
+        return m_container;
+    }
+
+    m_container = lv_obj_create(parent);
+    lv_obj_set_size(m_container, width, height);
+    lv_obj_clear_flag(m_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(m_container, VIEW_PADDING, 0);
+    lv_obj_set_style_bg_color(m_container, lv_color_black(), 0);
+    lv_obj_set_style_border_width(m_container, 0, 0);
+    lv_obj_set_style_radius(m_container, 0, 0);
+    lv_obj_add_event_cb(m_container, eventCallback, LV_EVENT_ALL, this);
+
+    lv_coord_t contentWidth = width - 2 * VIEW_PADDING;
+    lv_coord_t contentHeight = height - 2 * VIEW_PADDING;
+    lv_coord_t lineHeight = lv_font_get_line_height(font);
+    m_rowHeight = std::max<lv_coord_t>(lineHeight, 1);
+    m_visibleRows = std::max<lv_coord_t>(contentHeight / m_rowHeight, 1);
+
+    // Wrap on digit width; wider glyphs are clipped rather than reflowed
+    uint16_t glyphWidth = lv_font_get_glyph_width(font, '0', 0);
+    size_t columns = std::max<size_t>(contentWidth / std::max<uint16_t>(glyphWidth, 1), 8);
+
+    m_rows.resize(m_visibleRows);
+    m_rowLine.assign(m_visibleRows, NO_LINE);
+    for (uint32_t i = 0; i < m_visibleRows; i++) {
+        lv_obj_t* label = lv_label_create(m_container);
+        lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+        lv_label_set_text_static(label, "");
+        lv_obj_set_width(label, contentWidth);
+        lv_obj_set_style_text_font(label, font, 0);
+        lv_obj_set_style_text_color(label, color, 0);
+        lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+        m_rows[i] = label;
+    }
+
+    lock();
+    m_columns = std::min<size_t>(columns, OS_TERM_MAX_ROW_BYTES);
+    unlock();
+
+    m_dirty = true;
+    return m_container;
+}
+
+void TerminalView::appendText(const char* text, size_t length) {
+    if (!text) {
+        return;
+    }
+
+    lock();
+    appendRows(text, length);
+    unlock();
+
+    m_dirty = true;
+    OS().wake();
+}
+
+void TerminalView::appendText(const char* text) {
+    if (text) {
+        appendText(text, strlen(text));
+    }
+}
+
+void TerminalView::clear() {
+    lock();
+    m_scrollback.clear();
+    m_topLine = m_scrollback.getFirstLine();
+    m_follow = true;
+    unlock();
+
+    m_dirty = true;
+}
+
+void TerminalView::refresh() {
+    if (!m_container || !m_dirty) {
+        return;
+    }
+    m_dirty = false;
+
+    lock();
+    uint32_t bottom = bottomTop();
+    if (m_follow) {
+        m_topLine = bottom;
+    } else {
+        m_topLine = std::min(std::max(m_topLine, m_scrollback.getFirstLine()), bottom);
+    }
+    bindRows(m_topLine);
+    unlock();
+
+    m_refreshes++;
+}
+
+void TerminalView::setAutoScroll(bool enabled) {
+    m_follow = enabled;
+    m_dirty = true;
+}
+
+void TerminalView::printStats(const char* tag) const {
+    lock();
+    ESP_LOGI(tag, "Scrollback: %d lines, %d KB of %d KB, %d evicted",
+             m_scrollback.getLineCount(), m_scrollback.getBytesUsed() / 1024,
+             m_scrollback.getMemoryUsage() / 1024, m_scrollback.getEvictedLines());
+    unlock();
+    ESP_LOGI(tag, "Terminal view: %d rows x %d columns, %d redraws, %d rows re-texted",
+             m_visibleRows, m_columns, m_refreshes, m_rowsBound);
+}
+
+void TerminalView::appendRows(const char* text, size_t length) {
+    const char* end = text + length;
+    while (text < end) {
+        const char* newline = static_cast<const char*>(memchr(text, '\n', end - text));
+        const char* lineEnd = newline ? newline : end;
+        size_t lineLength = lineEnd - text;
+        if (lineLength > 0 && text[lineLength - 1] == '\r') {
+            lineLength--;
+        }
+
+        // Hard wrap at the column count; an empty line still takes a row
+        size_t offset = 0;
+        do {
+            size_t rowLength = std::min(lineLength - offset, m_columns);
+            m_scrollback.append(text + offset, rowLength);
+            offset += rowLength;
+        } while (offset < lineLength);
+
+        text = newline ? newline + 1 : end;
+    }
+}
+
+void TerminalView::bindRows(uint32_t top) {
+    uint32_t end = m_scrollback.getEndLine();
+    char buffer[OS_TERM_MAX_ROW_BYTES + 1];
+
+    // Consecutive lines map to distinct labels, so each label is touched
+    // once. Line numbers never repeat, even across clear(), so a label whose
+    // line matches still shows the right text.
+    for (uint32_t i = 0; i < m_visibleRows; i++) {
+        uint32_t line = top + i;
+        uint32_t slot = line % m_visibleRows;
+        lv_obj_t* label = m_rows[slot];
+
+        if (line >= end) {
+            if (m_rowLine[slot] != NO_LINE) {
+                lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+                m_rowLine[slot] = NO_LINE;
+            }
+            continue;
+        }
+
+        if (m_rowLine[slot] != line) {
+            size_t length = 0;
+            const char* text = m_scrollback.getLine(line, length);
+            length = std::min<size_t>(length, OS_TERM_MAX_ROW_BYTES);
+            if (text) {
+                memcpy(buffer, text, length);
+            }
+            buffer[length] = '\0';
+            lv_label_set_text(label, buffer);
+            lv_obj_clear_flag(label, LV_OBJ_FLAG_HIDDEN);
+            m_rowLine[slot] = line;
+            m_rowsBound++;
+        }
+        lv_obj_set_y(label, (lv_coord_t)(i * m_rowHeight));
+    }
+}
+
+uint32_t TerminalView::bottomTop() const {
+    uint32_t first = m_scrollback.getFirstLine();
+    uint32_t end = m_scrollback.getEndLine();
+    return end - first > m_visibleRows ? end - m_visibleRows : first;
+}
+
+void TerminalView::scrollBy(int rows) {
+    lock();
+    uint32_t bottom = bottomTop();
+    uint32_t first = m_scrollback.getFirstLine();
+    int64_t top = (int64_t)(m_follow ? bottom : m_topLine) + rows;
+    m_topLine = (uint32_t)std::min<int64_t>(std::max<int64_t>(top, first), bottom);
+    m_follow = m_topLine == bottom;
+    unlock();
+
+    m_dirty = true;
+}
+
+void TerminalView::lock() const {
+    if (m_mutex) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+}
+
+void TerminalView::unlock() const {
+    if (m_mutex) {
+        xSemaphoreGive(m_mutex);
+    }
+}
+
+void TerminalView::eventCallback(lv_event_t* e) {
+    TerminalView* view = static_cast<TerminalView*>(lv_event_get_user_data(e));
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DELETE) {
+        view->m_container = nullptr;
+        view->m_rows.clear();
+        view->m_rowLine.clear();
+        view->m_visibleRows = 0;
+        return;
+    }
+
+    if (code == LV_EVENT_PRESSING) {
+        // Dragging down reveals older rows
+        lv_point_t vect;
+        lv_indev_get_vect(lv_indev_get_act(), &vect);
+        view->m_dragRemainder += vect.y;
+        int rows = view->m_dragRemainder / view->m_rowHeight;
+        if (rows != 0) {
+            view->m_dragRemainder -= rows * view->m_rowHeight;
+            view->scrollBy(-rows);
+        }
+    } else if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST) {
+        view->m_dragRemainder = 0;
+    }
+}
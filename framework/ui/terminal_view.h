@@ -0,0 +1,155 @@
+#ifndef TERMINAL_VIEW_H
+#define TERMINAL_VIEW_H
+
+#include "../system/os_config.h"
+#include "scrollback_buffer.h"
+#include <lvgl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+
+/**
+ * @file terminal_view.h
+ * @brief Virtualized terminal output backed by a scrollback ring
+ *
+ * Text goes into a ScrollbackBuffer, wrapped into rows of the view's
+ * column count; the widget only owns one label per visible row. Each
+ * stored row maps to label (row % visible rows), so scrolling by one row
+ * re-texts one label and moves the rest. Appends only mark the view dirty
+ * and refresh() redraws at most once per frame however many rows arrived,
+ * so cost no longer grows with the length of a capture.
+ *
+ * appendText() and clear() may be called from any task; create(),
+ * refresh() and the scroll setters belong to the LVGL thread.
+ */
+
+class TerminalView {
+public:
+    TerminalView() = default;
+    ~TerminalView();
+
+    TerminalView(const TerminalView&) = delete;
+    TerminalView& operator=(const TerminalView&) = delete;
+
+    /**
+     * @brief Allocate scrollback storage
+     * @param maxLines Rows kept
+     * @param maxBytes Text pool size in bytes
+     * @param arena Application arena to allocate from (nullptr = app heap)
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(size_t maxLines = OS_TERM_SCROLLBACK_LINES,
+                          size_t maxBytes = OS_TERM_SCROLLBACK_BYTES,
+                          MemoryArena* arena = nullptr);
+
+    /**
+     * @brief Free scrollback storage (widget must already be deleted)
+     */
+    void shutdown();
+
+    /**
+     * @brief Create the widget
+     *
+     * The widget is deleted with its parent; the view notices and can be
+     * created again later with the scrollback intact.
+     * @param parent Parent object
+     * @param width Widget width
+     * @param height Widget height
+     * @param font Text font; row height and wrap width derive from it
+     * @param color Text color
+     * @return Widget container, or nullptr on failure
+     */
+    lv_obj_t* create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height,
+                     const lv_font_t* font, lv_color_t color);
+
+    /**
+     * @brief Get the widget container
+     * @return Container or nullptr if not created
+     */
+    lv_obj_t* getObject() const { return m_container; }
+
+    /**
+     * @brief Append text; each newline starts a new row
+     * @param text Text to append
+     * @param length Text length
+     */
+    void appendText(const char* text, size_t length);
+
+    /**
+     * @brief Append NUL-terminated text
+     * @param text Text to append
+     */
+    void appendText(const char* text);
+
+    /**
+     * @brief Drop all rows
+     */
+    void clear();
+
+    /**
+     * @brief Redraw visible rows if anything changed (once per frame)
+     */
+    void refresh();
+
+    /**
+     * @brief Follow new output
+     * @param enabled true to keep the newest row in view
+     */
+    void setAutoScroll(bool enabled);
+
+    /**
+     * @brief Jump to the newest row and follow output
+     */
+    void scrollToBottom() { setAutoScroll(true); }
+
+    /**
+     * @brief Check if the view follows new output
+     * @return true if following
+     */
+    bool isFollowing() const { return m_follow; }
+
+    /**
+     * @brief Get the scrollback store (LVGL thread only)
+     * @return Scrollback buffer
+     */
+    const ScrollbackBuffer& getScrollback() const { return m_scrollback; }
+
+    /**
+     * @brief Print scrollback and redraw statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    void appendRows(const char* text, size_t length);
+    void bindRows(uint32_t top);
+    uint32_t bottomTop() const;
+    void scrollBy(int rows);
+    void lock() const;
+    void unlock() const;
+
+    static void eventCallback(lv_event_t* e);
+
+    ScrollbackBuffer m_scrollback;
+    SemaphoreHandle_t m_mutex = nullptr;
+
+    // Widget
+    lv_obj_t* m_container = nullptr;
+    std::vector<lv_obj_t*> m_rows;      // One label per visible row
+    std::vector<uint32_t> m_rowLine;    // Line shown by each label
+    uint32_t m_visibleRows = 0;
+    lv_coord_t m_rowHeight = 0;
+    size_t m_columns = OS_TERM_DEFAULT_COLUMNS;
+
+    // View position
+    uint32_t m_topLine = 0;
+    bool m_follow = true;
+    volatile bool m_dirty = false;
+    lv_coord_t m_dragRemainder = 0;
+
+    // Statistics
+    uint32_t m_refreshes = 0;
+    uint32_t m_rowsBound = 0;
+};
+
+#endif // TERMINAL_VIEW_H
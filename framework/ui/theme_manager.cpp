@@ -3,6 +3,30 @@
 
 static const char* TAG = "ThemeManager";
 
+static const ThemePalette LIGHT_PALETTE = {
+    0x2980B9,   // Primary
+    0x7F8C8D,   // Secondary
+    0xECF0F1,   // Background
+    0xFFFFFF,   // Surface
+    0x2C3E50,   // Text
+    0x7F8C8D,   // Muted text
+    0xE74C3C,   // Danger
+    0x27AE60,   // Success
+    false
+};
+
+static const ThemePalette DARK_PALETTE = {
+    0x3498DB,
+    0x95A5A6,
+    0x1E1E1E,
+    0x2C2C2C,
+    0xECF0F1,
+    0x95A5A6,
+    0xE74C3C,
+    0x27AE60,
+    true
+};
+
 ThemeManager::~ThemeManager() {
     shutdown();
 }
@@ -14,14 +38,14 @@ os_error_t ThemeManager::initialize() {
 
     ESP_LOGI(TAG, "Initializing Theme Manager");
 
-    // Initialize themes
-    initializeLightTheme();
-    initializeDarkTheme();
+    for (auto& style : m_styles) {
+        lv_style_init(&style);
+    }
+    m_initialized = true;
 
     // Set default theme
     setTheme(ThemeType::LIGHT);
 
-    m_initialized = true;
     ESP_LOGI(TAG, "Theme Manager initialized");
 
     return OS_OK;
@@ -34,7 +58,10 @@ os_error_t ThemeManager::shutdown() {
 
     ESP_LOGI(TAG, "Shutting down Theme Manager");
 
-    // Cleanup themes would go here if needed
+    // Objects still referencing the shared styles must be gone by now
+    for (auto& style : m_styles) {
+        lv_style_reset(&style);
+    }
     m_initialized = false;
 
     ESP_LOGI(TAG, "Theme Manager shutdown complete");
@@ -52,84 +79,121 @@ os_error_t ThemeManager::setTheme(ThemeType theme) {
     }
 
     m_currentTheme = theme;
-
-    // Apply theme to current display
-    lv_theme_t* activeTheme = nullptr;
-    switch (theme) {
-        case ThemeType::LIGHT:
-            activeTheme = m_lightTheme;
-            break;
-        case ThemeType::DARK:
-            activeTheme = m_darkTheme;
-            break;
-        case ThemeType::AUTO:
-            // TODO: Determine based on time/sensor
-            activeTheme = m_lightTheme;
-            break;
+    const ThemePalette& palette = getPalette();
+
+    // LVGL 8 has a single default theme instance; re-initializing it
+    // rewrites its styles in place for the other mode
+    updateSharedStyles(palette);
+    m_theme = lv_theme_default_init(nullptr,
+                                    lv_color_hex(palette.primary),
+                                    lv_color_hex(palette.secondary),
+                                    palette.dark,
+                                    lv_font_default());
+    if (m_theme) {
+        lv_disp_set_theme(nullptr, m_theme);
     }
 
-    if (activeTheme) {
-        lv_disp_set_theme(nullptr, activeTheme);
-    }
+    // One refresh for every object using any of the changed styles
+    lv_obj_report_style_change(nullptr);
 
     ESP_LOGI(TAG, "Set theme to %d", (int)theme);
     return OS_OK;
 }
 
 os_error_t ThemeManager::applyTheme(lv_obj_t* obj) {
-    // Apply current theme styles to object
-    // This would be more complex in a full implementation
+    if (!m_initialized || !obj) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    addStyle(obj, StyleRole::SURFACE);
     return OS_OK;
 }
 
-lv_color_t ThemeManager::getPrimaryColor() const {
-    switch (m_currentTheme) {
-        case ThemeType::DARK:
-            return lv_color_hex(0x3498DB);
-        default:
-            return lv_color_hex(0x2980B9);
+lv_style_t* ThemeManager::getStyle(StyleRole role) {
+    if (role >= StyleRole::COUNT) {
+        return nullptr;
     }
+    return &m_styles[(size_t)role];
 }
 
-lv_color_t ThemeManager::getSecondaryColor() const {
-    switch (m_currentTheme) {
-        case ThemeType::DARK:
-            return lv_color_hex(0x95A5A6);
-        default:
-            return lv_color_hex(0x7F8C8D);
+void ThemeManager::addStyle(lv_obj_t* obj, StyleRole role, lv_style_selector_t selector) {
+    lv_style_t* style = getStyle(role);
+    if (obj && style) {
+        lv_obj_add_style(obj, style, selector);
     }
 }
 
+const ThemePalette& ThemeManager::getPalette() const {
+    return m_currentTheme == ThemeType::DARK ? DARK_PALETTE : LIGHT_PALETTE;
+}
+
+lv_color_t ThemeManager::getPrimaryColor() const {
+    return lv_color_hex(getPalette().primary);
+}
+
+lv_color_t ThemeManager::getSecondaryColor() const {
+    return lv_color_hex(getPalette().secondary);
+}
+
 lv_color_t ThemeManager::getBackgroundColor() const {
-    switch (m_currentTheme) {
-        case ThemeType::DARK:
-            return lv_color_hex(0x2C3E50);
-        default:
-            return lv_color_hex(0xECF0F1);
-    }
+    return lv_color_hex(getPalette().background);
 }
 
 lv_color_t ThemeManager::getTextColor() const {
-    switch (m_currentTheme) {
-        case ThemeType::DARK:
-            return lv_color_hex(0xECF0F1);
-        default:
-            return lv_color_hex(0x2C3E50);
-    }
+    return lv_color_hex(getPalette().text);
 }
 
-void ThemeManager::initializeLightTheme() {
-    m_lightTheme = lv_theme_default_init(nullptr, 
-                                        lv_color_hex(0x2980B9),  // Primary
-                                        lv_color_hex(0x7F8C8D),  // Secondary
-                                        false,                    // Dark mode
-                                        lv_font_default());
+void ThemeManager::updateSharedStyles(const ThemePalette& palette) {
+    lv_color_t background = lv_color_hex(palette.background);
+    lv_color_t surface = lv_color_hex(palette.surface);
+    lv_color_t text = lv_color_hex(palette.text);
+
+    lv_style_t* style = getStyle(StyleRole::SURFACE);
+    lv_style_set_bg_color(style, background);
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_text_color(style, text);
+    lv_style_set_border_opa(style, LV_OPA_TRANSP);
+
+    style = getStyle(StyleRole::PANEL);
+    lv_style_set_bg_color(style, surface);
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_text_color(style, text);
+    lv_style_set_radius(style, 6);
+
+    style = getStyle(StyleRole::TOOLBAR);
+    lv_style_set_bg_color(style, surface);
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_text_color(style, text);
+    lv_style_set_border_opa(style, LV_OPA_TRANSP);
+
+    style = getStyle(StyleRole::BUTTON);
+    lv_style_set_bg_color(style, lv_color_hex(palette.primary));
+    lv_style_set_text_color(style, lv_color_white());
+
+    style = getStyle(StyleRole::BUTTON_DANGER);
+    lv_style_set_bg_color(style, lv_color_hex(palette.danger));
+    lv_style_set_text_color(style, lv_color_white());
+
+    style = getStyle(StyleRole::BUTTON_SUCCESS);
+    lv_style_set_bg_color(style, lv_color_hex(palette.success));
+    lv_style_set_text_color(style, lv_color_white());
+
+    style = getStyle(StyleRole::TEXT);
+    lv_style_set_text_color(style, text);
+    lv_style_set_text_font(style, &lv_font_montserrat_14);
+
+    style = getStyle(StyleRole::TEXT_MUTED);
+    lv_style_set_text_color(style, lv_color_hex(palette.textMuted));
+    lv_style_set_text_font(style, &lv_font_montserrat_12);
+
+    style = getStyle(StyleRole::TEXT_TITLE);
+    lv_style_set_text_color(style, text);
+    lv_style_set_text_font(style, &lv_font_montserrat_16);
+
+    style = getStyle(StyleRole::DIALOG);
+    lv_style_set_bg_color(style, surface);
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_text_color(style, text);
+    lv_style_set_border_color(style, lv_color_hex(palette.primary));
+    lv_style_set_border_width(style, 2);
 }
-
-void ThemeManager::initializeDarkTheme() {
-    m_darkTheme = lv_theme_default_init(nullptr,
-                                       lv_color_hex(0x3498DB),   // Primary
-                                       lv_color_hex(0x95A5A6),   // Secondary
-                                       true,                     // Dark mode
-                                       lv_font_default());
-}
\ No newline at end of file
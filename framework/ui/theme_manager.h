@@ -10,6 +10,11 @@
  * @brief Theme management system for M5Stack Tab5
  * 
  * Manages UI themes, colors, fonts, and visual styling.
+ *
+ * Apps attach the shared role styles below by reference instead of
+ * setting local colors on each object. A theme switch rewrites only these
+ * few lv_style_t objects and reports a single style change, so its cost
+ * does not grow with the number of objects styled.
  */
 
 enum class ThemeType {
@@ -18,6 +23,34 @@ enum class ThemeType {
     AUTO  // Automatic based on time or ambient light
 };
 
+enum class StyleRole {
+    SURFACE,        // Screen/app background
+    PANEL,          // Lists, cards, detail panes
+    TOOLBAR,        // Toolbars and search bars
+    BUTTON,         // Default action button
+    BUTTON_DANGER,  // Delete/cancel
+    BUTTON_SUCCESS, // Save/confirm
+    TEXT,           // Body text
+    TEXT_MUTED,     // Secondary text
+    TEXT_TITLE,     // Headings
+    DIALOG,         // Modal dialogs
+    COUNT
+};
+
+static constexpr size_t STYLE_ROLE_COUNT = (size_t)StyleRole::COUNT;
+
+struct ThemePalette {
+    uint32_t primary;
+    uint32_t secondary;
+    uint32_t background;
+    uint32_t surface;
+    uint32_t text;
+    uint32_t textMuted;
+    uint32_t danger;
+    uint32_t success;
+    bool dark;
+};
+
 class ThemeManager {
 public:
     ThemeManager() = default;
@@ -56,12 +89,27 @@ public:
     ThemeType getCurrentTheme() const { return m_currentTheme; }
 
     /**
-     * @brief Apply theme to an object
+     * @brief Apply theme to an object (attaches the SURFACE style)
      * @param obj LVGL object to apply theme to
      * @return OS_OK on success, error code on failure
      */
     os_error_t applyTheme(lv_obj_t* obj);
 
+    /**
+     * @brief Get shared style for a role
+     * @param role Style role
+     * @return Style owned by the theme manager (valid until shutdown)
+     */
+    lv_style_t* getStyle(StyleRole role);
+
+    /**
+     * @brief Attach a shared role style to an object
+     * @param obj Object to style
+     * @param role Style role
+     * @param selector Part/state selector
+     */
+    void addStyle(lv_obj_t* obj, StyleRole role, lv_style_selector_t selector = 0);
+
     /**
      * @brief Get primary color for current theme
      * @return Primary color
@@ -86,20 +134,22 @@ public:
      */
     lv_color_t getTextColor() const;
 
-private:
     /**
-     * @brief Initialize light theme
+     * @brief Get active palette
+     * @return Palette for current theme
      */
-    void initializeLightTheme();
+    const ThemePalette& getPalette() const;
 
+private:
     /**
-     * @brief Initialize dark theme
+     * @brief Write palette colors into the shared role styles
+     * @param palette Palette to apply
      */
-    void initializeDarkTheme();
+    void updateSharedStyles(const ThemePalette& palette);
 
     ThemeType m_currentTheme = ThemeType::LIGHT;
-    lv_theme_t* m_lightTheme = nullptr;
-    lv_theme_t* m_darkTheme = nullptr;
+    lv_theme_t* m_theme = nullptr;
+    lv_style_t m_styles[STYLE_ROLE_COUNT];
     bool m_initialized = false;
 };
 
@@ -77,6 +77,16 @@ os_error_t UIManager::shutdown() {
 
     // Clean up notifications
     hideNotifications();
+    setProfilerOverlayEnabled(false);
+
+    if (m_batteryListener) {
+        OS().getEventSystem().unsubscribe(m_batteryListener);
+        m_batteryListener = 0;
+    }
+    if (m_wifiListener) {
+        OS().getEventSystem().unsubscribe(m_wifiListener);
+        m_wifiListener = 0;
+    }
 
     // Shutdown component managers
     if (m_inputManager) {
@@ -123,6 +133,8 @@ os_error_t UIManager::update(uint32_t deltaTime) {
 
     // Update status bar
     updateStatusBar();
+    updateProfilerOverlay();
+    updateFramePacing();
 
     // Update FPS statistics
     m_frameCount++;
@@ -238,21 +250,57 @@ os_error_t UIManager::setRefreshRate(uint8_t fps) {
     }
 
     m_refreshRate = fps;
-    
-    // TODO: Update LVGL timer period based on FPS
+    m_frameGovernor.setFixedRate(fps);
     ESP_LOGI(TAG, "Set refresh rate to %d FPS", fps);
 
     return OS_OK;
 }
 
+void UIManager::setRefreshPolicy(RefreshPolicy policy) {
+    m_frameGovernor.setPolicy(policy);
+    ESP_LOGI(TAG, "Refresh policy set to %d", (int)policy);
+}
+
+os_error_t UIManager::setFramePacing(const FramePacingConfig& config) {
+    return m_frameGovernor.setConfig(config);
+}
+
+void UIManager::updateFramePacing() {
+    HALManager& hal = OS().getHALManager();
+    PowerHAL& power = hal.getPower();
+    lv_disp_t* disp = lv_disp_get_default();
+
+    ChargeState charge = power.getChargeState();
+    bool charging = charge == ChargeState::CHARGING || charge == ChargeState::CHARGED;
+
+    PacingInputs inputs;
+    inputs.animating = lv_anim_count_running() > 0;
+    inputs.touching = hal.getTouch().getActiveTouchCount() > 0;
+    inputs.redrawPending = disp && disp->inv_p > 0;
+    inputs.lowPowerMode = hal.getDisplay().isLowPowerMode();
+    inputs.powerIdle = !power.isActive();
+    inputs.batteryLow = !charging && power.isBatteryLow();
+    inputs.batteryCritical = !charging && power.isBatteryCritical();
+
+    uint8_t fps = m_frameGovernor.update(inputs, millis());
+    if (fps != m_appliedFps && hal.getDisplay().setRefreshPeriod(1000 / fps) == OS_OK) {
+        m_appliedFps = fps;
+    }
+}
+
 void UIManager::printStats() const {
     ESP_LOGI(TAG, "=== UI Manager Statistics ===");
     ESP_LOGI(TAG, "UI Scale: %.1f", m_uiScale);
     ESP_LOGI(TAG, "Animations: %s", m_animationsEnabled ? "enabled" : "disabled");
-    ESP_LOGI(TAG, "Target FPS: %d", m_refreshRate);
+    ESP_LOGI(TAG, "Target FPS: %d (fixed rate %d)", m_frameGovernor.getTargetFps(), m_refreshRate);
     ESP_LOGI(TAG, "Actual FPS: %.1f", m_actualFPS);
     ESP_LOGI(TAG, "Active notifications: %d", m_notificationCount);
+    ESP_LOGI(TAG, "Status bar label updates: %d", m_statusBarUpdates);
+    m_frameGovernor.printStats();
 
+    if (m_inputManager) {
+        m_inputManager->printStats();
+    }
     if (m_screenManager) {
         m_screenManager->printStats();
     }
@@ -303,6 +351,31 @@ void UIManager::hideLoadingSpinner(lv_obj_t* spinner) {
     }
 }
 
+void UIManager::setProfilerOverlayEnabled(bool enabled) {
+    if (enabled == (m_profilerOverlay != nullptr)) {
+        return;
+    }
+
+    if (!enabled) {
+        lv_obj_del(m_profilerOverlay);
+        m_profilerOverlay = nullptr;
+        return;
+    }
+
+    // Top layer keeps the overlay above app screens and transitions
+    m_profilerOverlay = lv_label_create(lv_layer_top());
+    lv_obj_set_style_bg_color(m_profilerOverlay, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(m_profilerOverlay, LV_OPA_70, 0);
+    lv_obj_set_style_text_color(m_profilerOverlay, lv_color_hex(0x00FF88), 0);
+    lv_obj_set_style_pad_all(m_profilerOverlay, 4, 0);
+    lv_obj_align(m_profilerOverlay, LV_ALIGN_TOP_RIGHT, 0, OS_STATUS_BAR_HEIGHT);
+    lv_obj_clear_flag(m_profilerOverlay, LV_OBJ_FLAG_CLICKABLE);
+    lv_label_set_text(m_profilerOverlay, "profiler");
+
+    OS().getProfiler().setEnabled(true);
+    m_lastOverlayUpdate = 0;
+}
+
 os_error_t UIManager::initializeStyles() {
     // TODO: Initialize custom LVGL styles
     // This would include defining colors, fonts, borders, etc.
@@ -321,57 +394,115 @@ os_error_t UIManager::createStatusBar() {
     lv_obj_clear_flag(m_statusBar, LV_OBJ_FLAG_SCROLLABLE);
 
     // Create time label
-    m_timeLabel = lv_label_create(m_statusBar);
-    lv_label_set_text(m_timeLabel, "12:34");
-    lv_obj_set_style_text_color(m_timeLabel, lv_color_white(), 0);
-    lv_obj_align(m_timeLabel, LV_ALIGN_LEFT_MID, 10, 0);
+    m_timeField.label = lv_label_create(m_statusBar);
+    lv_label_set_text(m_timeField.label, "00:00");
+    lv_obj_set_style_text_color(m_timeField.label, lv_color_white(), 0);
+    lv_obj_align(m_timeField.label, LV_ALIGN_LEFT_MID, 10, 0);
 
     // Create battery icon
-    m_batteryIcon = lv_label_create(m_statusBar);
-    lv_label_set_text(m_batteryIcon, "100%");
-    lv_obj_set_style_text_color(m_batteryIcon, lv_color_white(), 0);
-    lv_obj_align(m_batteryIcon, LV_ALIGN_RIGHT_MID, -10, 0);
+    m_batteryField.label = lv_label_create(m_statusBar);
+    lv_label_set_text(m_batteryField.label, "");
+    lv_obj_set_style_text_color(m_batteryField.label, lv_color_white(), 0);
+    lv_obj_align(m_batteryField.label, LV_ALIGN_RIGHT_MID, -10, 0);
 
     // Create WiFi icon
-    m_wifiIcon = lv_label_create(m_statusBar);
-    lv_label_set_text(m_wifiIcon, "WiFi");
-    lv_obj_set_style_text_color(m_wifiIcon, lv_color_white(), 0);
-    lv_obj_align(m_wifiIcon, LV_ALIGN_RIGHT_MID, -60, 0);
+    m_wifiField.label = lv_label_create(m_statusBar);
+    lv_label_set_text(m_wifiField.label, "WiFi");
+    lv_obj_set_style_text_color(m_wifiField.label, lv_color_white(), 0);
+    lv_obj_align(m_wifiField.label, LV_ALIGN_RIGHT_MID, -60, 0);
+    m_wifiField.value = 1;
+
+    // Battery and Wi-Fi only change on HAL events; the clock is checked in update()
+    m_batteryListener = SUBSCRIBE_EVENT(EVENT_HAL_BATTERY_CHANGE,
+                                        [this](const EventData&) { updateBatteryStatus(); });
+    m_wifiListener = SUBSCRIBE_EVENT(EVENT_HAL_WIFI_CHANGE,
+                                     [this](const EventData& event) {
+                                         if (!event.data || event.dataSize < 1) {
+                                             return;
+                                         }
+                                         bool enabled = *(const uint8_t*)event.data != 0;
+                                         if (m_wifiField.changed(enabled ? 1 : 0)) {
+                                             lv_label_set_text(m_wifiField.label, enabled ? "WiFi" : "");
+                                             m_statusBarUpdates++;
+                                         }
+                                     });
+    updateBatteryStatus();
 
     ESP_LOGD(TAG, "Created status bar");
     return OS_OK;
 }
 
 void UIManager::updateStatusBar() {
-    if (!m_timeLabel || !m_batteryIcon || !m_wifiIcon) {
+    // Minute resolution; checking once a second is enough
+    uint32_t now = millis();
+    if (now - m_lastClockCheck < 1000) {
         return;
     }
+    m_lastClockCheck = now;
 
-    // Update time (simplified)
-    static uint32_t lastTimeUpdate = 0;
-    uint32_t now = millis();
-    if (now - lastTimeUpdate >= 1000) {
-        // TODO: Get actual time from RTC
-        uint32_t seconds = now / 1000;
-        uint32_t minutes = (seconds / 60) % 60;
-        uint32_t hours = (seconds / 3600) % 24;
-        
+    // TODO: Get actual time from RTC
+    uint32_t seconds = now / 1000;
+    uint32_t minutes = (seconds / 60) % 60;
+    uint32_t hours = (seconds / 3600) % 24;
+
+    if (m_timeField.changed(hours * 60 + minutes)) {
         char timeStr[16];
         snprintf(timeStr, sizeof(timeStr), "%02d:%02d", hours, minutes);
-        lv_label_set_text(m_timeLabel, timeStr);
-        
-        lastTimeUpdate = now;
+        lv_label_set_text(m_timeField.label, timeStr);
+        m_statusBarUpdates++;
+    }
+}
+
+void UIManager::updateBatteryStatus() {
+    if (!OS().getHALManager().isInitialized()) {
+        return;
     }
 
-    // Update battery level
-    if (OS().getHALManager().isInitialized()) {
-        uint8_t batteryLevel = OS().getHALManager().getPower().getBatteryLevel();
+    PowerHAL& power = OS().getHALManager().getPower();
+    uint8_t batteryLevel = power.getBatteryLevel();
+    bool charging = power.getChargeState() == ChargeState::CHARGING;
+
+    if (m_batteryField.changed(batteryLevel | (charging ? 0x100 : 0))) {
         char batteryStr[16];
-        snprintf(batteryStr, sizeof(batteryStr), "%d%%", batteryLevel);
-        lv_label_set_text(m_batteryIcon, batteryStr);
+        snprintf(batteryStr, sizeof(batteryStr), "%s%d%%", charging ? LV_SYMBOL_CHARGE : "", batteryLevel);
+        lv_label_set_text(m_batteryField.label, batteryStr);
+        m_statusBarUpdates++;
     }
 }
 
+void UIManager::updateProfilerOverlay() {
+    if (!m_profilerOverlay) {
+        return;
+    }
+
+    uint32_t now = millis();
+    if (now - m_lastOverlayUpdate < OS_PROFILER_OVERLAY_REFRESH_MS) {
+        return;
+    }
+    m_lastOverlayUpdate = now;
+
+    const FrameProfiler& profiler = OS().getProfiler();
+    char text[384];
+    size_t len = 0;
+
+    for (size_t i = 0; i < PROFILE_STAGE_COUNT && len < sizeof(text); i++) {
+        ProfileStage stage = (ProfileStage)i;
+        ProfileStats stats = profiler.getStageStats(stage);
+        len += snprintf(text + len, sizeof(text) - len, "%-8s %5d %5d %6d us\n",
+                        FrameProfiler::getStageName(stage),
+                        stats.p50Us, stats.p95Us, stats.maxUs);
+    }
+
+    std::string appId;
+    ProfileStats appStats;
+    if (len < sizeof(text) && profiler.getSlowestApp(appId, appStats)) {
+        snprintf(text + len, sizeof(text) - len, "%.8s %5d %5d %6d us",
+                 appId.c_str(), appStats.p50Us, appStats.p95Us, appStats.maxUs);
+    }
+
+    lv_label_set_text(m_profilerOverlay, text);
+}
+
 os_error_t UIManager::createDock() {
     // Create dock container
     m_dock = lv_obj_create(lv_scr_act());
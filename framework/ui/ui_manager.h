@@ -2,9 +2,11 @@
 #define UI_MANAGER_H
 
 #include "../system/os_config.h"
+#include "../system/event_system.h"
 #include "screen_manager.h"
 #include "theme_manager.h"
 #include "input_manager.h"
+#include "frame_governor.h"
 #include <lvgl.h>
 #include <map>
 #include <string>
@@ -110,18 +112,55 @@ public:
     bool areAnimationsEnabled() const { return m_animationsEnabled; }
 
     /**
-     * @brief Set UI refresh rate
+     * @brief Set UI refresh rate (used by the FIXED refresh policy)
      * @param fps Frames per second (10-60)
      * @return OS_OK on success, error code on failure
      */
     os_error_t setRefreshRate(uint8_t fps);
 
     /**
-     * @brief Get current refresh rate
-     * @return Current FPS
+     * @brief Get configured fixed refresh rate
+     * @return Configured FPS
      */
     uint8_t getRefreshRate() const { return m_refreshRate; }
 
+    /**
+     * @brief Set frame pacing policy
+     * @param policy FIXED, ADAPTIVE or POWER_SAVE
+     */
+    void setRefreshPolicy(RefreshPolicy policy);
+
+    /**
+     * @brief Get frame pacing policy
+     * @return Current policy
+     */
+    RefreshPolicy getRefreshPolicy() const { return m_frameGovernor.getPolicy(); }
+
+    /**
+     * @brief Set per-level rates for the adaptive policies
+     * @param config Pacing configuration
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setFramePacing(const FramePacingConfig& config);
+
+    /**
+     * @brief Get per-level rates
+     * @return Current pacing configuration
+     */
+    const FramePacingConfig& getFramePacing() const { return m_frameGovernor.getConfig(); }
+
+    /**
+     * @brief Get rate currently chosen by the governor
+     * @return Target FPS
+     */
+    uint8_t getTargetFps() const { return m_frameGovernor.getTargetFps(); }
+
+    /**
+     * @brief Get activity level seen by the governor
+     * @return Pacing level
+     */
+    PacingLevel getPacingLevel() const { return m_frameGovernor.getLevel(); }
+
     /**
      * @brief Get UI statistics
      */
@@ -148,6 +187,18 @@ public:
      */
     void hideLoadingSpinner(lv_obj_t* spinner);
 
+    /**
+     * @brief Show/hide the frame profiler overlay below the status bar
+     * @param enabled True to show per-stage p50/p95/max timings
+     */
+    void setProfilerOverlayEnabled(bool enabled);
+
+    /**
+     * @brief Check if the profiler overlay is shown
+     * @return true if shown, false otherwise
+     */
+    bool isProfilerOverlayEnabled() const { return m_profilerOverlay != nullptr; }
+
 private:
     /**
      * @brief Initialize LVGL styles and themes
@@ -162,10 +213,41 @@ private:
     os_error_t createStatusBar();
 
     /**
-     * @brief Update status bar information
+     * @brief Update status bar clock (battery and Wi-Fi are event driven)
      */
     void updateStatusBar();
 
+    /**
+     * @brief Render battery level and charge state
+     */
+    void updateBatteryStatus();
+
+    /**
+     * @brief Status-bar label that is only rewritten when its value changes
+     */
+    struct StatusField {
+        lv_obj_t* label = nullptr;
+        int32_t value = INT32_MIN;      // Last value rendered
+
+        bool changed(int32_t newValue) {
+            if (!label || newValue == value) {
+                return false;
+            }
+            value = newValue;
+            return true;
+        }
+    };
+
+    /**
+     * @brief Refresh profiler overlay text
+     */
+    void updateProfilerOverlay();
+
+    /**
+     * @brief Sample UI/power state and apply the governor's refresh rate
+     */
+    void updateFramePacing();
+
     /**
      * @brief Create dock/navigation bar
      * @return OS_OK on success, error code on failure
@@ -183,15 +265,27 @@ private:
     bool m_animationsEnabled = true;
     uint8_t m_refreshRate = OS_UI_REFRESH_RATE;
 
+    // Frame pacing
+    FrameGovernor m_frameGovernor;
+    uint8_t m_appliedFps = 0;
+
     // UI components
     lv_obj_t* m_statusBar = nullptr;
     lv_obj_t* m_dock = nullptr;
     lv_obj_t* m_notificationContainer = nullptr;
 
     // Status bar elements
-    lv_obj_t* m_timeLabel = nullptr;
-    lv_obj_t* m_batteryIcon = nullptr;
-    lv_obj_t* m_wifiIcon = nullptr;
+    StatusField m_timeField;
+    StatusField m_batteryField;
+    StatusField m_wifiField;
+    uint32_t m_lastClockCheck = 0;
+    ListenerId m_batteryListener = 0;
+    ListenerId m_wifiListener = 0;
+    uint32_t m_statusBarUpdates = 0;
+
+    // Profiler overlay
+    lv_obj_t* m_profilerOverlay = nullptr;
+    uint32_t m_lastOverlayUpdate = 0;
 
     // Statistics
     uint32_t m_frameCount = 0;
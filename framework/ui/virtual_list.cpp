@@ -0,0 +1,292 @@
+#include "virtual_list.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static constexpr size_t NO_ITEM = SIZE_MAX;
+static constexpr lv_coord_t ROW_PADDING = 8;
+static constexpr lv_coord_t ICON_WIDTH = OS_THUMB_WIDTH + 4;
+static constexpr lv_coord_t DETAIL_WIDTH = 100;
+static constexpr lv_coord_t SCROLLBAR_WIDTH = 4;
+static constexpr lv_coord_t SCROLLBAR_MIN_HEIGHT = 20;
+
+VirtualList::~VirtualList() {
+    if (m_container) {
+        lv_obj_del(m_container);
+    }
+}
+
+lv_obj_t* VirtualList::create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height, lv_coord_t rowHeight) {
+    if (m_container || !parent || rowHeight <= 0) {
+        return m_container;
+    }
+
+    m_container = lv_obj_create(parent);
+    lv_obj_set_size(m_container, width, height);
+    lv_obj_clear_flag(m_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(m_container, 0, 0);
+    lv_obj_set_style_border_width(m_container, 0, 0);
+    lv_obj_set_style_radius(m_container, 0, 0);
+    lv_obj_set_style_bg_color(m_container, lv_color_hex(0x2A2A2A), 0);
+    lv_obj_add_event_cb(m_container, eventCallback, LV_EVENT_ALL, this);
+
+    m_rowHeight = rowHeight;
+    m_viewHeight = height;
+    lv_coord_t rowWidth = width - SCROLLBAR_WIDTH - 2;
+    size_t pool = height / rowHeight + 2 + 2 * OS_VLIST_MARGIN_ROWS;
+
+    // Rows are not clickable: presses reach the container, which tells taps from drags
+    m_rows.resize(pool);
+    m_rowItem.assign(pool, NO_ITEM);
+    for (size_t i = 0; i < pool; i++) {
+        VirtualListRow& row = m_rows[i];
+        row.object = lv_obj_create(m_container);
+        lv_obj_set_size(row.object, rowWidth, rowHeight - 2);
+        lv_obj_clear_flag(row.object, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_set_style_pad_hor(row.object, ROW_PADDING, 0);
+        lv_obj_set_style_pad_ver(row.object, 0, 0);
+        lv_obj_set_style_border_width(row.object, 0, 0);
+        lv_obj_set_style_radius(row.object, 4, 0);
+        lv_obj_set_style_bg_color(row.object, lv_color_hex(0x0066CC), LV_STATE_CHECKED);
+
+        row.icon = lv_label_create(row.object);
+        lv_obj_align(row.icon, LV_ALIGN_LEFT_MID, 0, 0);
+        lv_obj_set_style_text_color(row.icon, lv_color_white(), 0);
+        lv_label_set_text_static(row.icon, "");
+
+        row.image = lv_img_create(row.object);
+        lv_obj_align(row.image, LV_ALIGN_LEFT_MID, 0, 0);
+        lv_obj_add_flag(row.image, LV_OBJ_FLAG_HIDDEN);
+
+        row.text = lv_label_create(row.object);
+        lv_label_set_long_mode(row.text, LV_LABEL_LONG_DOT);
+        lv_obj_set_width(row.text, rowWidth - 2 * ROW_PADDING - ICON_WIDTH - DETAIL_WIDTH);
+        lv_obj_align(row.text, LV_ALIGN_LEFT_MID, ICON_WIDTH, 0);
+        lv_obj_set_style_text_color(row.text, lv_color_white(), 0);
+        lv_label_set_text_static(row.text, "");
+
+        row.detail = lv_label_create(row.object);
+        lv_obj_align(row.detail, LV_ALIGN_RIGHT_MID, 0, 0);
+        lv_obj_set_style_text_color(row.detail, lv_color_hex(0xAAAAAA), 0);
+        lv_label_set_text_static(row.detail, "");
+
+        lv_obj_add_flag(row.object, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    m_scrollbar = lv_obj_create(m_container);
+    lv_obj_set_size(m_scrollbar, SCROLLBAR_WIDTH, SCROLLBAR_MIN_HEIGHT);
+    lv_obj_align(m_scrollbar, LV_ALIGN_TOP_RIGHT, -1, 0);
+    lv_obj_clear_flag(m_scrollbar, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_border_width(m_scrollbar, 0, 0);
+    lv_obj_set_style_radius(m_scrollbar, SCROLLBAR_WIDTH / 2, 0);
+    lv_obj_set_style_bg_color(m_scrollbar, lv_color_hex(0x888888), 0);
+    lv_obj_add_flag(m_scrollbar, LV_OBJ_FLAG_HIDDEN);
+
+    m_dirty = true;
+    return m_container;
+}
+
+void VirtualList::reset(size_t count) {
+    m_count = count;
+    m_offset = 0;
+    m_velocity = 0.0f;
+    m_selected = -1;
+    invalidate();
+    refresh(0);
+}
+
+void VirtualList::setCount(size_t count) {
+    size_t unchanged = std::min(count, m_count);
+    for (size_t& item : m_rowItem) {
+        if (item != NO_ITEM && item >= unchanged) {
+            item = NO_ITEM;
+        }
+    }
+    m_count = count;
+    scrollTo(m_offset);
+    m_dirty = true;
+}
+
+void VirtualList::invalidate() {
+    std::fill(m_rowItem.begin(), m_rowItem.end(), NO_ITEM);
+    m_dirty = true;
+}
+
+void VirtualList::invalidate(size_t first, size_t last) {
+    for (size_t& item : m_rowItem) {
+        if (item != NO_ITEM && item >= first && item < last) {
+            item = NO_ITEM;
+            m_dirty = true;
+        }
+    }
+}
+
+void VirtualList::setSelected(int index) {
+    if (m_selected != index) {
+        m_selected = index;
+        m_dirty = true;
+    }
+}
+
+size_t VirtualList::getLastVisible() const {
+    if (m_count == 0 || m_rowHeight <= 0) {
+        return 0;
+    }
+    size_t last = (size_t)((m_offset + m_viewHeight - 1) / m_rowHeight);
+    return std::min(last, m_count - 1);
+}
+
+void VirtualList::refresh(uint32_t deltaTime) {
+    if (!m_container) {
+        return;
+    }
+
+    // Fling: keep the release speed and let it decay
+    if (deltaTime > 0 && std::fabs(m_velocity) >= OS_VLIST_FLING_MIN_SPEED) {
+        int32_t before = m_offset;
+        scrollTo(m_offset + (int32_t)(m_velocity * deltaTime / 1000.0f));
+        m_velocity *= expf(-(float)deltaTime / OS_VLIST_FLING_DECAY_MS);
+        if (m_offset == before) {
+            m_velocity = 0.0f;     // Hit an end
+        }
+    } else {
+        m_velocity = 0.0f;
+    }
+
+    if (m_dirty) {
+        m_dirty = false;
+        layoutRows();
+        updateScrollbar();
+        m_layouts++;
+    }
+}
+
+void VirtualList::printStats(const char* tag) const {
+    ESP_LOGI(tag, "Virtual list: %d items, %d rows pooled, %d layouts, %d rows bound",
+             m_count, m_rows.size(), m_layouts, m_rowsBound);
+}
+
+void VirtualList::scrollTo(int32_t offset) {
+    offset = std::min(std::max<int32_t>(offset, 0), maxOffset());
+    if (offset != m_offset) {
+        m_offset = offset;
+        m_dirty = true;
+    }
+}
+
+void VirtualList::layoutRows() {
+    size_t pool = m_rows.size();
+    if (pool == 0) {
+        return;
+    }
+
+    size_t top = (size_t)(m_offset / m_rowHeight);
+    size_t firstItem = top > OS_VLIST_MARGIN_ROWS ? top - OS_VLIST_MARGIN_ROWS : 0;
+    size_t endItem = std::min(m_count, firstItem + pool);
+
+    // Consecutive items map to distinct rows, so each row is touched once and
+    // rows keep their binding while they stay in range
+    for (size_t item = firstItem; item < endItem; item++) {
+        size_t slot = item % pool;
+        const VirtualListRow& row = m_rows[slot];
+        if (m_rowItem[slot] != item) {
+            if (m_bind) {
+                m_bind(item, row);
+            }
+            m_rowItem[slot] = item;
+            m_rowsBound++;
+        }
+        if (lv_obj_has_flag(row.object, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_clear_flag(row.object, LV_OBJ_FLAG_HIDDEN);
+        }
+        if ((int)item == m_selected) {
+            lv_obj_add_state(row.object, LV_STATE_CHECKED);
+        } else {
+            lv_obj_clear_state(row.object, LV_STATE_CHECKED);
+        }
+        lv_obj_set_y(row.object, (lv_coord_t)((int32_t)item * m_rowHeight - m_offset));
+    }
+
+    // Rows with no item in range (short lists, the end of the list)
+    for (size_t slot = 0; slot < pool; slot++) {
+        size_t item = firstItem + (slot + pool - firstItem % pool) % pool;
+        if (item >= endItem && !lv_obj_has_flag(m_rows[slot].object, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(m_rows[slot].object, LV_OBJ_FLAG_HIDDEN);
+            m_rowItem[slot] = NO_ITEM;
+        }
+    }
+}
+
+void VirtualList::updateScrollbar() {
+    int64_t total = (int64_t)m_count * m_rowHeight;
+    if (total <= m_viewHeight) {
+        lv_obj_add_flag(m_scrollbar, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+
+    lv_coord_t height = (lv_coord_t)std::max<int64_t>((int64_t)m_viewHeight * m_viewHeight / total,
+                                                      SCROLLBAR_MIN_HEIGHT);
+    lv_coord_t y = (lv_coord_t)((int64_t)(m_viewHeight - height) * m_offset / maxOffset());
+    lv_obj_set_height(m_scrollbar, height);
+    lv_obj_set_y(m_scrollbar, y);
+    lv_obj_move_foreground(m_scrollbar);
+    lv_obj_clear_flag(m_scrollbar, LV_OBJ_FLAG_HIDDEN);
+}
+
+int32_t VirtualList::maxOffset() const {
+    int64_t total = (int64_t)m_count * m_rowHeight;
+    return (int32_t)std::max<int64_t>(total - m_viewHeight, 0);
+}
+
+void VirtualList::eventCallback(lv_event_t* e) {
+    VirtualList* list = static_cast<VirtualList*>(lv_event_get_user_data(e));
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DELETE) {
+        list->m_container = nullptr;
+        list->m_scrollbar = nullptr;
+        list->m_rows.clear();
+        list->m_rowItem.clear();
+        return;
+    }
+
+    if (code == LV_EVENT_PRESSED) {
+        list->m_velocity = 0.0f;
+        list->m_dragDistance = 0;
+        list->m_lastDragTick = lv_tick_get();
+    } else if (code == LV_EVENT_PRESSING) {
+        // Dragging up moves further down the list
+        lv_point_t vect;
+        lv_indev_get_vect(lv_indev_get_act(), &vect);
+        if (vect.y == 0) {
+            return;
+        }
+        uint32_t elapsed = std::max<uint32_t>(lv_tick_elaps(list->m_lastDragTick), 1);
+        list->m_lastDragTick = lv_tick_get();
+        list->m_dragDistance += abs(vect.y);
+        list->m_velocity = 0.6f * list->m_velocity - 0.4f * vect.y * 1000.0f / elapsed;
+        list->scrollTo(list->m_offset - vect.y);
+        list->refresh(0);
+    } else if (code == LV_EVENT_RELEASED) {
+        // A finger that stopped before lifting throws nothing
+        if (lv_tick_elaps(list->m_lastDragTick) > OS_VLIST_FLING_HOLD_MS) {
+            list->m_velocity = 0.0f;
+        }
+    } else if (code == LV_EVENT_PRESS_LOST) {
+        list->m_velocity = 0.0f;
+    } else if (code == LV_EVENT_CLICKED) {
+        if (list->m_dragDistance > OS_VLIST_TAP_SLOP || !list->m_click) {
+            return;
+        }
+        lv_point_t point;
+        lv_indev_get_point(lv_indev_get_act(), &point);
+        lv_area_t area;
+        lv_obj_get_coords(list->m_container, &area);
+        int32_t y = list->m_offset + (point.y - area.y1);
+        size_t item = (size_t)(y / list->m_rowHeight);
+        if (y >= 0 && item < list->m_count) {
+            list->m_click(item);
+        }
+    }
+}
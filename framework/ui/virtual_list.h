@@ -0,0 +1,168 @@
+#ifndef VIRTUAL_LIST_H
+#define VIRTUAL_LIST_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+#include <functional>
+#include <vector>
+
+/**
+ * @file virtual_list.h
+ * @brief List view that owns widgets only for the rows around the viewport
+ *
+ * A list of thousands of items cannot be one LVGL object per item (each
+ * costs heap and creation time) and does not fit LVGL's 16-bit content
+ * coordinates either. The view keeps a fixed pool of rows covering the
+ * viewport plus OS_VLIST_MARGIN_ROWS above and below, and scrolls itself
+ * like TerminalView: item i is shown by row (i % pool) at its offset from
+ * the scroll position, so a scroll step moves the rows and rebinds only
+ * those whose item changed. Releasing a drag keeps the list moving with
+ * decaying speed.
+ *
+ * The owner fills rows in the bind callback and may grow the count as it
+ * loads more items; getLastVisible() says how far the user has scrolled.
+ * All calls belong to the LVGL thread.
+ */
+
+struct VirtualListRow {
+    lv_obj_t* object;           // Row background; checked while selected
+    lv_obj_t* icon;
+    lv_obj_t* image;            // Hidden; shown over the icon column for thumbnails
+    lv_obj_t* text;
+    lv_obj_t* detail;           // Right aligned secondary text
+};
+
+/**
+ * @brief Fill a row for an item
+ * @param index Item index
+ * @param row Row widgets to update
+ */
+typedef std::function<void(size_t index, const VirtualListRow& row)> VirtualListBindCallback;
+
+/**
+ * @brief Handle a tap on an item
+ * @param index Item index
+ */
+typedef std::function<void(size_t index)> VirtualListClickCallback;
+
+class VirtualList {
+public:
+    VirtualList() = default;
+    ~VirtualList();
+
+    VirtualList(const VirtualList&) = delete;
+    VirtualList& operator=(const VirtualList&) = delete;
+
+    /**
+     * @brief Create the widget and its row pool
+     *
+     * The widget is deleted with its parent; the view notices and can be
+     * created again later.
+     * @param parent Parent object
+     * @param width Widget width
+     * @param height Widget height
+     * @param rowHeight Height of every row
+     * @return Widget container, or nullptr on failure
+     */
+    lv_obj_t* create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height, lv_coord_t rowHeight);
+
+    /**
+     * @brief Get the widget container
+     * @return Container or nullptr if not created
+     */
+    lv_obj_t* getObject() const { return m_container; }
+
+    void setBindCallback(VirtualListBindCallback callback) { m_bind = callback; }
+    void setClickCallback(VirtualListClickCallback callback) { m_click = callback; }
+
+    /**
+     * @brief Show new content from the top
+     * @param count Item count
+     */
+    void reset(size_t count);
+
+    /**
+     * @brief Change the item count, keeping the scroll position
+     *
+     * Rows of items at or beyond the old count are rebound.
+     * @param count Item count
+     */
+    void setCount(size_t count);
+
+    /**
+     * @brief Get the item count
+     * @return Items in the list
+     */
+    size_t getCount() const { return m_count; }
+
+    /**
+     * @brief Rebind every row (item contents changed)
+     */
+    void invalidate();
+
+    /**
+     * @brief Rebind the rows of some items (only those items changed)
+     * @param first First item
+     * @param last One past the last item
+     */
+    void invalidate(size_t first, size_t last);
+
+    /**
+     * @brief Mark one item selected (-1 for none)
+     * @param index Item index
+     */
+    void setSelected(int index);
+
+    /**
+     * @brief Get the last item at least partly in view
+     * @return Item index, 0 for an empty list
+     */
+    size_t getLastVisible() const;
+
+    /**
+     * @brief Advance the fling and rebind rows that came into range
+     * @param deltaTime Time since the last call in milliseconds
+     */
+    void refresh(uint32_t deltaTime);
+
+    /**
+     * @brief Print pool and rebinding statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    void scrollTo(int32_t offset);
+    void layoutRows();
+    void updateScrollbar();
+    int32_t maxOffset() const;
+
+    static void eventCallback(lv_event_t* e);
+
+    // Widget
+    lv_obj_t* m_container = nullptr;
+    lv_obj_t* m_scrollbar = nullptr;
+    std::vector<VirtualListRow> m_rows;
+    std::vector<size_t> m_rowItem;      // Item bound to each row
+    lv_coord_t m_rowHeight = 0;
+    lv_coord_t m_viewHeight = 0;
+
+    VirtualListBindCallback m_bind;
+    VirtualListClickCallback m_click;
+    size_t m_count = 0;
+    int m_selected = -1;
+
+    // Scroll position in pixels from the top of the first item; wider than
+    // lv_coord_t so long lists still scroll by the pixel
+    int32_t m_offset = 0;
+    float m_velocity = 0.0f;            // px/s, positive scrolls down the list
+    uint32_t m_lastDragTick = 0;
+    int32_t m_dragDistance = 0;
+    bool m_dirty = false;
+
+    // Statistics
+    uint32_t m_rowsBound = 0;
+    uint32_t m_layouts = 0;
+};
+
+#endif // VIRTUAL_LIST_H
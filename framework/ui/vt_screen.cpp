@@ -0,0 +1,664 @@
+#include "vt_screen.h"
+#include "../system/os_manager.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t XTERM_PALETTE[16] = {
+    0x000000, 0xCD0000, 0x00CD00, 0xCDCD00, 0x0000EE, 0xCD00CD, 0x00CDCD, 0xE5E5E5,
+    0x7F7F7F, 0xFF0000, 0x00FF00, 0xFFFF00, 0x5C5CFF, 0xFF00FF, 0x00FFFF, 0xFFFFFF
+};
+
+static constexpr uint16_t TAB_WIDTH = 8;
+static constexpr int MAX_PARAM_VALUE = 9999;
+
+VtScreen::~VtScreen() {
+    release();
+}
+
+os_error_t VtScreen::initialize(uint16_t columns, uint16_t rows) {
+    release();
+    if (columns == 0 || rows == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    m_cells = (VtCell*)OS_MALLOC_PSRAM((size_t)columns * rows * sizeof(VtCell));
+    if (!m_cells) {
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_columns = columns;
+    m_rows = rows;
+    m_dirtyRows.assign(rows, 0);
+    reset();
+    return OS_OK;
+}
+
+void VtScreen::release() {
+    if (m_cells) {
+        OS_FREE(m_cells);
+        m_cells = nullptr;
+    }
+    m_columns = 0;
+    m_rows = 0;
+    m_dirtyRows.clear();
+    m_dirty = false;
+}
+
+void VtScreen::write(const uint8_t* data, size_t length) {
+    if (!m_cells || !data) {
+        return;
+    }
+
+    m_bytes += length;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t b = data[i];
+
+        // A multi-byte character ends at the first byte that cannot continue it
+        if (m_utf8Remaining > 0) {
+            if ((b & 0xC0) == 0x80) {
+                m_utf8 = (m_utf8 << 6) | (b & 0x3F);
+                if (--m_utf8Remaining == 0) {
+                    put(m_utf8 <= 0xFFFF ? (uint16_t)m_utf8 : '?');
+                }
+                continue;
+            }
+            m_utf8Remaining = 0;
+            put('?');
+        }
+
+        // ESC, CAN and SUB interrupt any sequence, including OSC strings
+        if (b == 0x1B) {
+            m_state = ParseState::ESCAPE;
+            continue;
+        }
+        if (b == 0x18 || b == 0x1A) {
+            m_state = ParseState::GROUND;
+            continue;
+        }
+
+        switch (m_state) {
+            case ParseState::GROUND:
+                if (b < 0x20 || b == 0x7F) {
+                    control(b);
+                } else if (b < 0x80) {
+                    put(b);
+                } else if ((b & 0xE0) == 0xC0) {
+                    m_utf8 = b & 0x1F;
+                    m_utf8Remaining = 1;
+                } else if ((b & 0xF0) == 0xE0) {
+                    m_utf8 = b & 0x0F;
+                    m_utf8Remaining = 2;
+                } else if ((b & 0xF8) == 0xF0) {
+                    m_utf8 = b & 0x07;
+                    m_utf8Remaining = 3;
+                } else {
+                    put('?');
+                }
+                break;
+
+            case ParseState::ESCAPE:
+                if (b == '[') {
+                    memset(m_params, 0, sizeof(m_params));
+                    m_paramCount = 0;
+                    m_private = 0;
+                    m_intermediate = 0;
+                    m_state = ParseState::CSI;
+                } else if (b == ']' || b == 'P' || b == 'X' || b == '^' || b == '_') {
+                    // OSC, DCS, SOS, PM and APC strings run to BEL or ST
+                    m_state = ParseState::OSC;
+                } else if (b >= 0x20 && b <= 0x2F) {
+                    // Charset designation and friends; the final byte is skipped
+                    m_state = ParseState::ESCAPE_SKIP;
+                } else if (b < 0x20) {
+                    control(b);
+                } else {
+                    escapeDispatch(b);
+                    m_state = ParseState::GROUND;
+                }
+                break;
+
+            case ParseState::ESCAPE_SKIP:
+                m_state = ParseState::GROUND;
+                break;
+
+            case ParseState::CSI:
+                if (b >= '0' && b <= '9') {
+                    if (m_paramCount == 0) {
+                        m_paramCount = 1;
+                    }
+                    int& value = m_params[m_paramCount - 1];
+                    value = std::min(value * 10 + (b - '0'), MAX_PARAM_VALUE);
+                } else if (b == ';' || b == ':') {
+                    if (m_paramCount == 0) {
+                        m_paramCount = 1;
+                    }
+                    if (m_paramCount < OS_VT_MAX_PARAMS) {
+                        m_params[m_paramCount++] = 0;
+                    }
+                } else if (b >= 0x3C && b <= 0x3F) {
+                    m_private = b;
+                } else if (b >= 0x20 && b <= 0x2F) {
+                    m_intermediate = b;
+                } else if (b >= 0x40 && b <= 0x7E) {
+                    csiDispatch(b);
+                    m_state = ParseState::GROUND;
+                } else if (b < 0x20) {
+                    control(b);
+                }
+                break;
+
+            case ParseState::OSC:
+                if (b == 0x07) {
+                    m_state = ParseState::GROUND;
+                }
+                break;
+        }
+    }
+}
+
+void VtScreen::write(const char* text) {
+    if (text) {
+        write(reinterpret_cast<const uint8_t*>(text), strlen(text));
+    }
+}
+
+void VtScreen::reset() {
+    m_pen = {' ', VT_DEFAULT_COLOR, VT_DEFAULT_COLOR, 0};
+    m_row = 0;
+    m_column = 0;
+    m_wrapPending = false;
+    m_autoWrap = true;
+    m_originMode = false;
+    m_cursorVisible = true;
+    m_scrollTop = 0;
+    m_scrollBottom = m_rows > 0 ? m_rows - 1 : 0;
+    m_savedRow = 0;
+    m_savedColumn = 0;
+    m_savedPen = m_pen;
+    m_savedOriginMode = false;
+    m_state = ParseState::GROUND;
+    m_utf8Remaining = 0;
+    eraseRows(0, m_rows);
+}
+
+const VtCell* VtScreen::getRow(uint16_t row) const {
+    if (!m_cells || row >= m_rows) {
+        return nullptr;
+    }
+    return m_cells + (size_t)row * m_columns;
+}
+
+void VtScreen::clearDirty() {
+    std::fill(m_dirtyRows.begin(), m_dirtyRows.end(), 0);
+    m_dirty = false;
+}
+
+void VtScreen::markAllDirty() {
+    std::fill(m_dirtyRows.begin(), m_dirtyRows.end(), 1);
+    m_dirty = m_rows > 0;
+}
+
+void VtScreen::getStats(uint32_t& bytes, uint32_t& sequences, uint32_t& rowsScrolled) const {
+    bytes = m_bytes;
+    sequences = m_sequences;
+    rowsScrolled = m_rowsScrolled;
+}
+
+uint32_t VtScreen::paletteColor(uint8_t index) {
+    return XTERM_PALETTE[index & 0x0F];
+}
+
+void VtScreen::put(uint16_t ch) {
+    if (m_wrapPending) {
+        m_column = 0;
+        lineFeed();
+    }
+
+    VtCell* cell = cellAt(m_row, m_column);
+    *cell = m_pen;
+    cell->ch = ch;
+    markRow(m_row);
+
+    // The cursor stays on the last column until the next glyph wraps it
+    if (m_column + 1 < m_columns) {
+        m_column++;
+    } else {
+        m_wrapPending = m_autoWrap;
+    }
+}
+
+void VtScreen::control(uint8_t c) {
+    switch (c) {
+        case 0x08:  // BS
+            if (m_column > 0) {
+                m_column--;
+            }
+            m_wrapPending = false;
+            break;
+
+        case 0x09:  // HT, fixed stops every 8 columns
+            m_column = std::min<uint16_t>((m_column / TAB_WIDTH + 1) * TAB_WIDTH, m_columns - 1);
+            m_wrapPending = false;
+            break;
+
+        case 0x0A:  // LF
+        case 0x0B:  // VT
+        case 0x0C:  // FF
+            lineFeed();
+            break;
+
+        case 0x0D:  // CR
+            m_column = 0;
+            m_wrapPending = false;
+            break;
+
+        default:
+            // BEL, SO/SI and the rest have no visible effect
+            break;
+    }
+}
+
+void VtScreen::escapeDispatch(uint8_t c) {
+    m_sequences++;
+    switch (c) {
+        case '7':   // DECSC
+            saveCursor();
+            break;
+        case '8':   // DECRC
+            restoreCursor();
+            break;
+        case 'D':   // IND
+            lineFeed();
+            break;
+        case 'E':   // NEL
+            m_column = 0;
+            lineFeed();
+            break;
+        case 'M':   // RI
+            reverseIndex();
+            break;
+        case 'c':   // RIS
+            reset();
+            break;
+        default:
+            // Keypad modes, ST and the rest are ignored
+            break;
+    }
+}
+
+void VtScreen::csiDispatch(uint8_t final) {
+    m_sequences++;
+
+    if (m_private == '?') {
+        if (final == 'h' || final == 'l') {
+            for (size_t i = 0; i < std::max<size_t>(m_paramCount, 1); i++) {
+                setPrivateMode(m_params[i], final == 'h');
+            }
+        }
+        return;
+    }
+    if (m_private != 0 || m_intermediate != 0) {
+        // Secondary DA, cursor style and other extensions
+        return;
+    }
+
+    int count = param(0, 1);
+    uint16_t regionTop = m_row >= m_scrollTop ? m_scrollTop : 0;
+    uint16_t regionBottom = m_row <= m_scrollBottom ? m_scrollBottom : m_rows - 1;
+    bool inRegion = m_row >= m_scrollTop && m_row <= m_scrollBottom;
+
+    switch (final) {
+        case 'A':   // CUU
+            moveCursor(std::max<int>(m_row - count, regionTop), m_column);
+            break;
+        case 'B':   // CUD
+        case 'e':   // VPR
+            moveCursor(std::min<int>(m_row + count, regionBottom), m_column);
+            break;
+        case 'C':   // CUF
+        case 'a':   // HPR
+            moveCursor(m_row, m_column + count);
+            break;
+        case 'D':   // CUB
+            moveCursor(m_row, m_column - count);
+            break;
+        case 'E':   // CNL
+            moveCursor(std::min<int>(m_row + count, regionBottom), 0);
+            break;
+        case 'F':   // CPL
+            moveCursor(std::max<int>(m_row - count, regionTop), 0);
+            break;
+        case 'G':   // CHA
+        case '`':   // HPA
+            moveCursor(m_row, count - 1);
+            break;
+
+        case 'H':   // CUP
+        case 'f':   // HVP
+        case 'd': { // VPA
+            int row = param(0, 1) - 1;
+            int column = final == 'd' ? m_column : param(1, 1) - 1;
+            if (m_originMode) {
+                row = std::min<int>(row + m_scrollTop, m_scrollBottom);
+            }
+            moveCursor(row, column);
+            break;
+        }
+
+        case 'J':   // ED
+            switch (param(0, 0)) {
+                case 0:
+                    eraseCells(m_row, m_column, m_columns);
+                    eraseRows(m_row + 1, m_rows);
+                    break;
+                case 1:
+                    eraseRows(0, m_row);
+                    eraseCells(m_row, 0, m_column + 1);
+                    break;
+                default:
+                    eraseRows(0, m_rows);
+                    break;
+            }
+            break;
+
+        case 'K':   // EL
+            switch (param(0, 0)) {
+                case 0:
+                    eraseCells(m_row, m_column, m_columns);
+                    break;
+                case 1:
+                    eraseCells(m_row, 0, m_column + 1);
+                    break;
+                default:
+                    eraseCells(m_row, 0, m_columns);
+                    break;
+            }
+            break;
+
+        case 'L':   // IL
+            if (inRegion) {
+                scrollDown(m_row, m_scrollBottom, count);
+                moveCursor(m_row, 0);
+            }
+            break;
+        case 'M':   // DL
+            if (inRegion) {
+                scrollUp(m_row, m_scrollBottom, count);
+                moveCursor(m_row, 0);
+            }
+            break;
+
+        case 'P': { // DCH
+            int n = std::min<int>(count, m_columns - m_column);
+            VtCell* row = cellAt(m_row, 0);
+            memmove(row + m_column, row + m_column + n, (m_columns - m_column - n) * sizeof(VtCell));
+            eraseCells(m_row, m_columns - n, m_columns);
+            m_wrapPending = false;
+            break;
+        }
+        case '@': { // ICH
+            int n = std::min<int>(count, m_columns - m_column);
+            VtCell* row = cellAt(m_row, 0);
+            memmove(row + m_column + n, row + m_column, (m_columns - m_column - n) * sizeof(VtCell));
+            eraseCells(m_row, m_column, m_column + n);
+            m_wrapPending = false;
+            break;
+        }
+        case 'X':   // ECH
+            eraseCells(m_row, m_column, std::min<int>(m_column + count, m_columns));
+            m_wrapPending = false;
+            break;
+
+        case 'S':   // SU
+            scrollUp(m_scrollTop, m_scrollBottom, count);
+            break;
+        case 'T':   // SD
+            scrollDown(m_scrollTop, m_scrollBottom, count);
+            break;
+
+        case 'm':   // SGR
+            selectGraphicRendition();
+            break;
+
+        case 'r': { // DECSTBM
+            int top = param(0, 1) - 1;
+            int bottom = std::min<int>(param(1, m_rows), m_rows) - 1;
+            if (top < bottom) {
+                m_scrollTop = top;
+                m_scrollBottom = bottom;
+                moveCursor(m_originMode ? m_scrollTop : 0, 0);
+            }
+            break;
+        }
+
+        case 's':   // SCOSC
+            saveCursor();
+            break;
+        case 'u':   // SCORC
+            restoreCursor();
+            break;
+
+        default:
+            // Modes, device status and other queries need a reply channel
+            break;
+    }
+}
+
+void VtScreen::selectGraphicRendition() {
+    if (m_paramCount == 0) {
+        m_pen = {' ', VT_DEFAULT_COLOR, VT_DEFAULT_COLOR, 0};
+        return;
+    }
+
+    for (size_t i = 0; i < m_paramCount; i++) {
+        int p = m_params[i];
+        if (p == 0) {
+            m_pen = {' ', VT_DEFAULT_COLOR, VT_DEFAULT_COLOR, 0};
+        } else if (p == 1) {
+            m_pen.attrs |= VT_ATTR_BOLD;
+        } else if (p == 4) {
+            m_pen.attrs |= VT_ATTR_UNDERLINE;
+        } else if (p == 7) {
+            m_pen.attrs |= VT_ATTR_REVERSE;
+        } else if (p == 22) {
+            m_pen.attrs &= ~VT_ATTR_BOLD;
+        } else if (p == 24) {
+            m_pen.attrs &= ~VT_ATTR_UNDERLINE;
+        } else if (p == 27) {
+            m_pen.attrs &= ~VT_ATTR_REVERSE;
+        } else if (p >= 30 && p <= 37) {
+            m_pen.fg = p - 30;
+        } else if (p == 39) {
+            m_pen.fg = VT_DEFAULT_COLOR;
+        } else if (p >= 40 && p <= 47) {
+            m_pen.bg = p - 40;
+        } else if (p == 49) {
+            m_pen.bg = VT_DEFAULT_COLOR;
+        } else if (p >= 90 && p <= 97) {
+            m_pen.fg = p - 90 + 8;
+        } else if (p >= 100 && p <= 107) {
+            m_pen.bg = p - 100 + 8;
+        } else if (p == 38 || p == 48) {
+            // 38;5;n indexed or 38;2;r;g;b direct colour
+            uint8_t color;
+            if (i + 2 < m_paramCount && m_params[i + 1] == 5) {
+                int n = std::min(m_params[i + 2], 255);
+                if (n < 16) {
+                    color = n;
+                } else if (n < 232) {
+                    static constexpr uint8_t LEVELS[6] = {0, 95, 135, 175, 215, 255};
+                    n -= 16;
+                    color = nearestColor(LEVELS[n / 36], LEVELS[(n / 6) % 6], LEVELS[n % 6]);
+                } else {
+                    uint8_t gray = 8 + (n - 232) * 10;
+                    color = nearestColor(gray, gray, gray);
+                }
+                i += 2;
+            } else if (i + 4 < m_paramCount && m_params[i + 1] == 2) {
+                color = nearestColor(std::min(m_params[i + 2], 255), std::min(m_params[i + 3], 255),
+                                     std::min(m_params[i + 4], 255));
+                i += 4;
+            } else {
+                return;
+            }
+
+            if (p == 38) {
+                m_pen.fg = color;
+            } else {
+                m_pen.bg = color;
+            }
+        }
+    }
+}
+
+void VtScreen::setPrivateMode(int mode, bool enabled) {
+    switch (mode) {
+        case 6:     // DECOM
+            m_originMode = enabled;
+            moveCursor(enabled ? m_scrollTop : 0, 0);
+            break;
+
+        case 7:     // DECAWM
+            m_autoWrap = enabled;
+            m_wrapPending = false;
+            break;
+
+        case 25:    // DECTCEM
+            m_cursorVisible = enabled;
+            break;
+
+        case 47:
+        case 1047:
+        case 1049:
+            // No second grid: entering and leaving both start from a clean screen
+            if (mode == 1049 && enabled) {
+                saveCursor();
+            }
+            eraseRows(0, m_rows);
+            if (mode == 1049 && !enabled) {
+                restoreCursor();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void VtScreen::lineFeed() {
+    m_wrapPending = false;
+    if (m_row == m_scrollBottom) {
+        scrollUp(m_scrollTop, m_scrollBottom, 1);
+    } else if (m_row + 1 < m_rows) {
+        m_row++;
+    }
+}
+
+void VtScreen::reverseIndex() {
+    m_wrapPending = false;
+    if (m_row == m_scrollTop) {
+        scrollDown(m_scrollTop, m_scrollBottom, 1);
+    } else if (m_row > 0) {
+        m_row--;
+    }
+}
+
+void VtScreen::moveCursor(int row, int column) {
+    m_row = std::min<int>(std::max(row, 0), m_rows - 1);
+    m_column = std::min<int>(std::max(column, 0), m_columns - 1);
+    m_wrapPending = false;
+}
+
+void VtScreen::saveCursor() {
+    m_savedRow = m_row;
+    m_savedColumn = m_column;
+    m_savedPen = m_pen;
+    m_savedOriginMode = m_originMode;
+}
+
+void VtScreen::restoreCursor() {
+    m_pen = m_savedPen;
+    m_originMode = m_savedOriginMode;
+    moveCursor(m_savedRow, m_savedColumn);
+}
+
+void VtScreen::scrollUp(uint16_t top, uint16_t bottom, int count) {
+    if (count <= 0 || top > bottom || bottom >= m_rows) {
+        return;
+    }
+
+    int height = bottom - top + 1;
+    count = std::min(count, height);
+    if (count < height) {
+        memmove(cellAt(top, 0), cellAt(top + count, 0), (size_t)(height - count) * m_columns * sizeof(VtCell));
+    }
+    eraseRows(bottom + 1 - count, bottom + 1);
+    for (uint16_t row = top; row <= bottom; row++) {
+        markRow(row);
+    }
+    m_rowsScrolled += count;
+}
+
+void VtScreen::scrollDown(uint16_t top, uint16_t bottom, int count) {
+    if (count <= 0 || top > bottom || bottom >= m_rows) {
+        return;
+    }
+
+    int height = bottom - top + 1;
+    count = std::min(count, height);
+    if (count < height) {
+        memmove(cellAt(top + count, 0), cellAt(top, 0), (size_t)(height - count) * m_columns * sizeof(VtCell));
+    }
+    eraseRows(top, top + count);
+    for (uint16_t row = top; row <= bottom; row++) {
+        markRow(row);
+    }
+    m_rowsScrolled += count;
+}
+
+void VtScreen::eraseCells(uint16_t row, uint16_t from, uint16_t to) {
+    to = std::min(to, m_columns);
+    if (row >= m_rows || from >= to) {
+        return;
+    }
+
+    std::fill(cellAt(row, from), cellAt(row, 0) + to, blank());
+    markRow(row);
+}
+
+void VtScreen::eraseRows(uint16_t from, uint16_t to) {
+    to = std::min(to, m_rows);
+    for (uint16_t row = from; row < to; row++) {
+        eraseCells(row, 0, m_columns);
+    }
+}
+
+void VtScreen::markRow(uint16_t row) {
+    m_dirtyRows[row] = 1;
+    m_dirty = true;
+}
+
+int VtScreen::param(size_t index, int fallback) const {
+    return index < m_paramCount && m_params[index] != 0 ? m_params[index] : fallback;
+}
+
+VtCell VtScreen::blank() const {
+    // Erased cells take the current background (xterm's BCE)
+    return {' ', VT_DEFAULT_COLOR, m_pen.bg, 0};
+}
+
+uint8_t VtScreen::nearestColor(uint8_t red, uint8_t green, uint8_t blue) {
+    uint8_t best = 0;
+    uint32_t bestDistance = UINT32_MAX;
+    for (uint8_t i = 0; i < 16; i++) {
+        int dr = (int)((XTERM_PALETTE[i] >> 16) & 0xFF) - red;
+        int dg = (int)((XTERM_PALETTE[i] >> 8) & 0xFF) - green;
+        int db = (int)(XTERM_PALETTE[i] & 0xFF) - blue;
+        uint32_t distance = dr * dr + dg * dg + db * db;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
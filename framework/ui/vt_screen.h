@@ -0,0 +1,206 @@
+#ifndef VT_SCREEN_H
+#define VT_SCREEN_H
+
+#include "../system/os_config.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file vt_screen.h
+ * @brief VT100/xterm subset emulator over a fixed cell grid
+ *
+ * Host output is parsed into a rows x columns grid of cells with colour
+ * and attributes, so full-screen programs that repaint with cursor
+ * addressing overwrite cells instead of growing a buffer. Supported:
+ * C0 controls, cursor movement and save/restore, erase in line/display,
+ * insert/delete of lines and characters, scroll regions (DECSTBM), SGR
+ * with 16 colours (256-colour and RGB map to the nearest), autowrap,
+ * origin mode, cursor visibility and the alternate screen switch (which
+ * clears rather than preserving the main screen). OSC strings and
+ * charset designations are consumed and ignored; UTF-8 is decoded into
+ * the Basic Multilingual Plane.
+ *
+ * Every change marks its row dirty; a VtView re-renders only those rows.
+ * Nothing is sent back to the host, so DSR/DA queries go unanswered.
+ *
+ * Not thread safe: feed and render from the same task.
+ */
+
+enum VtAttribute : uint8_t {
+    VT_ATTR_BOLD = 0x01,
+    VT_ATTR_UNDERLINE = 0x02,
+    VT_ATTR_REVERSE = 0x04
+};
+
+static constexpr uint8_t VT_DEFAULT_COLOR = 0xFF;
+
+struct VtCell {
+    uint16_t ch;        // BMP code point
+    uint8_t fg;         // Palette index 0-15, or VT_DEFAULT_COLOR
+    uint8_t bg;
+    uint8_t attrs;      // VtAttribute bits
+};
+
+class VtScreen {
+public:
+    VtScreen() = default;
+    ~VtScreen();
+
+    VtScreen(const VtScreen&) = delete;
+    VtScreen& operator=(const VtScreen&) = delete;
+
+    /**
+     * @brief Allocate the grid and reset the terminal state
+     * @param columns Screen width in cells
+     * @param rows Screen height in cells
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(uint16_t columns = OS_VT_COLUMNS, uint16_t rows = OS_VT_ROWS);
+
+    /**
+     * @brief Free the grid
+     */
+    void release();
+
+    /**
+     * @brief Parse host output
+     * @param data Bytes from the host
+     * @param length Byte count
+     */
+    void write(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Parse NUL-terminated host output
+     * @param text Text from the host
+     */
+    void write(const char* text);
+
+    /**
+     * @brief Full reset (RIS): clear the screen, home the cursor, reset modes
+     */
+    void reset();
+
+    /**
+     * @brief Get the cells of one row
+     * @param row Row index
+     * @return First of getColumns() cells, or nullptr if out of range
+     */
+    const VtCell* getRow(uint16_t row) const;
+
+    uint16_t getColumns() const { return m_columns; }
+    uint16_t getRows() const { return m_rows; }
+    uint16_t getCursorRow() const { return m_row; }
+    uint16_t getCursorColumn() const { return m_column; }
+    bool isCursorVisible() const { return m_cursorVisible; }
+
+    /**
+     * @brief Check if any row changed since clearDirty()
+     * @return true if a row needs rendering
+     */
+    bool isDirty() const { return m_dirty; }
+
+    /**
+     * @brief Check if one row changed since clearDirty()
+     * @param row Row index
+     * @return true if the row needs rendering
+     */
+    bool isRowDirty(uint16_t row) const { return row < m_rows && m_dirtyRows[row]; }
+
+    /**
+     * @brief Mark every row rendered
+     */
+    void clearDirty();
+
+    /**
+     * @brief Mark every row for rendering, e.g. when a view binds
+     */
+    void markAllDirty();
+
+    /**
+     * @brief Get parser statistics
+     * @param bytes Bytes parsed
+     * @param sequences Escape sequences handled
+     * @param rowsScrolled Rows moved by scrolling
+     */
+    void getStats(uint32_t& bytes, uint32_t& sequences, uint32_t& rowsScrolled) const;
+
+    /**
+     * @brief Get an xterm palette colour
+     * @param index Palette index 0-15
+     * @return Colour as 0xRRGGBB
+     */
+    static uint32_t paletteColor(uint8_t index);
+
+private:
+    enum class ParseState : uint8_t {
+        GROUND,
+        ESCAPE,
+        ESCAPE_SKIP,    // One designator byte follows, e.g. ESC ( B
+        CSI,
+        OSC
+    };
+
+    void put(uint16_t ch);
+    void control(uint8_t c);
+    void escapeDispatch(uint8_t c);
+    void csiDispatch(uint8_t final);
+    void selectGraphicRendition();
+    void setPrivateMode(int mode, bool enabled);
+
+    void lineFeed();
+    void reverseIndex();
+    void moveCursor(int row, int column);
+    void saveCursor();
+    void restoreCursor();
+    void scrollUp(uint16_t top, uint16_t bottom, int count);
+    void scrollDown(uint16_t top, uint16_t bottom, int count);
+    void eraseCells(uint16_t row, uint16_t from, uint16_t to);
+    void eraseRows(uint16_t from, uint16_t to);
+    void markRow(uint16_t row);
+    int param(size_t index, int fallback) const;
+    VtCell blank() const;
+    VtCell* cellAt(uint16_t row, uint16_t column) { return m_cells + (size_t)row * m_columns + column; }
+
+    static uint8_t nearestColor(uint8_t red, uint8_t green, uint8_t blue);
+
+    // Grid
+    VtCell* m_cells = nullptr;
+    uint16_t m_columns = 0;
+    uint16_t m_rows = 0;
+    std::vector<uint8_t> m_dirtyRows;
+    bool m_dirty = false;
+
+    // Cursor and modes
+    uint16_t m_row = 0;
+    uint16_t m_column = 0;
+    bool m_wrapPending = false;     // Last column written; wrap on the next glyph
+    bool m_autoWrap = true;
+    bool m_originMode = false;
+    bool m_cursorVisible = true;
+    uint16_t m_scrollTop = 0;
+    uint16_t m_scrollBottom = 0;    // Inclusive
+    VtCell m_pen = {' ', VT_DEFAULT_COLOR, VT_DEFAULT_COLOR, 0};
+
+    // DECSC state
+    uint16_t m_savedRow = 0;
+    uint16_t m_savedColumn = 0;
+    VtCell m_savedPen = {' ', VT_DEFAULT_COLOR, VT_DEFAULT_COLOR, 0};
+    bool m_savedOriginMode = false;
+
+    // Parser
+    ParseState m_state = ParseState::GROUND;
+    int m_params[OS_VT_MAX_PARAMS] = {};
+    size_t m_paramCount = 0;
+    uint8_t m_private = 0;          // '?', '>', '=' or '<' after CSI
+    uint8_t m_intermediate = 0;
+    uint32_t m_utf8 = 0;
+    uint8_t m_utf8Remaining = 0;
+
+    // Statistics
+    uint32_t m_bytes = 0;
+    uint32_t m_sequences = 0;
+    uint32_t m_rowsScrolled = 0;
+};
+
+#endif // VT_SCREEN_H
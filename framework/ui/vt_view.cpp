@@ -0,0 +1,215 @@
+#include "vt_view.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <cstdio>
+
+static constexpr lv_coord_t VIEW_PADDING = 4;
+static constexpr uint8_t REVERSE_DEFAULT_COLOR = 15;   // Bright white
+
+lv_obj_t* VtView::create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height,
+                         const lv_font_t* font, lv_color_t color) {
+    if (m_container || !parent || !font) {
+        return m_container;
+    }
+
+    m_container = lv_obj_create(parent);
+    lv_obj_set_size(m_container, width, height);
+    lv_obj_clear_flag(m_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(m_container, VIEW_PADDING, 0);
+    lv_obj_set_style_bg_color(m_container, lv_color_black(), 0);
+    lv_obj_set_style_border_width(m_container, 0, 0);
+    lv_obj_set_style_radius(m_container, 0, 0);
+    lv_obj_add_event_cb(m_container, eventCallback, LV_EVENT_DELETE, this);
+
+    lv_coord_t contentWidth = width - 2 * VIEW_PADDING;
+    lv_coord_t lineHeight = lv_font_get_line_height(font);
+    uint16_t glyphWidth = lv_font_get_glyph_width(font, '0', 0);
+    m_rowHeight = std::max<lv_coord_t>(lineHeight, 1);
+    m_cellWidth = std::max<lv_coord_t>(glyphWidth, 1);
+
+    // Rows past the bottom edge are clipped by the container
+    m_rows.resize(OS_VT_ROWS);
+    for (uint16_t i = 0; i < OS_VT_ROWS; i++) {
+        lv_obj_t* label = lv_label_create(m_container);
+        lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+        lv_label_set_recolor(label, true);
+        lv_label_set_text_static(label, "");
+        lv_obj_set_width(label, contentWidth);
+        lv_obj_set_y(label, (lv_coord_t)(i * m_rowHeight));
+        lv_obj_set_style_text_font(label, font, 0);
+        lv_obj_set_style_text_color(label, color, 0);
+        m_rows[i] = label;
+    }
+
+    // Created last so it draws over the text
+    m_cursor = lv_obj_create(m_container);
+    lv_obj_remove_style_all(m_cursor);
+    lv_obj_set_size(m_cursor, m_cellWidth, m_rowHeight);
+    lv_obj_set_style_bg_color(m_cursor, color, 0);
+    lv_obj_set_style_bg_opa(m_cursor, LV_OPA_50, 0);
+    lv_obj_clear_flag(m_cursor, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(m_cursor, LV_OBJ_FLAG_HIDDEN);
+    m_cursorShown = false;
+    m_cursorRow = -1;
+
+    m_text.reserve(OS_VT_COLUMNS * 3);
+    if (m_screen) {
+        m_screen->markAllDirty();
+    }
+    return m_container;
+}
+
+void VtView::bind(VtScreen* screen) {
+    m_screen = screen;
+    m_cursorRow = -1;
+
+    if (m_screen) {
+        m_screen->markAllDirty();
+        return;
+    }
+
+    for (lv_obj_t* label : m_rows) {
+        lv_label_set_text_static(label, "");
+    }
+    if (m_cursor && m_cursorShown) {
+        lv_obj_add_flag(m_cursor, LV_OBJ_FLAG_HIDDEN);
+        m_cursorShown = false;
+    }
+}
+
+void VtView::refresh() {
+    if (!m_container || !m_screen) {
+        return;
+    }
+
+    if (m_screen->isDirty()) {
+        uint16_t rows = std::min<size_t>(m_screen->getRows(), m_rows.size());
+        for (uint16_t row = 0; row < rows; row++) {
+            if (m_screen->isRowDirty(row)) {
+                renderRow(row);
+            }
+        }
+        m_screen->clearDirty();
+        m_refreshes++;
+    }
+
+    // The cursor is its own object, so moving it re-texts nothing
+    bool show = m_screen->isCursorVisible();
+    if (show != m_cursorShown) {
+        if (show) {
+            lv_obj_clear_flag(m_cursor, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(m_cursor, LV_OBJ_FLAG_HIDDEN);
+        }
+        m_cursorShown = show;
+    }
+
+    int row = m_screen->getCursorRow();
+    int column = m_screen->getCursorColumn();
+    if (show && (row != m_cursorRow || column != m_cursorColumn)) {
+        lv_obj_set_pos(m_cursor, (lv_coord_t)(column * m_cellWidth), (lv_coord_t)(row * m_rowHeight));
+        m_cursorRow = row;
+        m_cursorColumn = column;
+    }
+}
+
+void VtView::printStats(const char* tag) const {
+    ESP_LOGI(tag, "VT view: %d labels, %d redraws, %d rows re-texted",
+             m_rows.size(), m_refreshes, m_rowsRendered);
+    if (m_screen) {
+        uint32_t bytes, sequences, rowsScrolled;
+        m_screen->getStats(bytes, sequences, rowsScrolled);
+        ESP_LOGI(tag, "VT screen: %dx%d, %d bytes, %d sequences, %d rows scrolled",
+                 m_screen->getColumns(), m_screen->getRows(), bytes, sequences, rowsScrolled);
+    }
+}
+
+void VtView::renderRow(uint16_t row) {
+    const VtCell* cells = m_screen->getRow(row);
+    uint16_t end = m_screen->getColumns();
+    while (end > 0 && cells[end - 1].ch == ' ') {
+        end--;
+    }
+
+    // Colour runs become "#RRGGBB text#" spans; a literal '#' is "##"
+    // outside a span, so any open span is closed first
+    m_text.clear();
+    bool spanOpen = false;
+    uint32_t spanColor = 0;
+    for (uint16_t i = 0; i < end; i++) {
+        const VtCell& cell = cells[i];
+        uint16_t ch = cell.ch < 0x20 ? ' ' : cell.ch;
+
+        if (ch == '#') {
+            if (spanOpen) {
+                m_text += '#';
+                spanOpen = false;
+            }
+            m_text += "##";
+            continue;
+        }
+
+        // Spaces keep whatever span is open
+        if (ch != ' ') {
+            bool isDefault;
+            uint32_t color = cellColor(cell, isDefault);
+            if (isDefault ? spanOpen : (!spanOpen || color != spanColor)) {
+                if (spanOpen) {
+                    m_text += '#';
+                    spanOpen = false;
+                }
+                if (!isDefault) {
+                    char tag[10];
+                    snprintf(tag, sizeof(tag), "#%06X ", (unsigned)color);
+                    m_text += tag;
+                    spanOpen = true;
+                    spanColor = color;
+                }
+            }
+        }
+
+        if (ch >= 0xD800 && ch <= 0xDFFF) {
+            ch = '?';
+        }
+        if (ch < 0x80) {
+            m_text += (char)ch;
+        } else if (ch < 0x800) {
+            m_text += (char)(0xC0 | (ch >> 6));
+            m_text += (char)(0x80 | (ch & 0x3F));
+        } else {
+            m_text += (char)(0xE0 | (ch >> 12));
+            m_text += (char)(0x80 | ((ch >> 6) & 0x3F));
+            m_text += (char)(0x80 | (ch & 0x3F));
+        }
+    }
+
+    lv_label_set_text(m_rows[row], m_text.c_str());
+    m_rowsRendered++;
+}
+
+uint32_t VtView::cellColor(const VtCell& cell, bool& isDefault) const {
+    uint8_t fg = cell.fg;
+    if (cell.attrs & VT_ATTR_REVERSE) {
+        fg = cell.bg == VT_DEFAULT_COLOR ? REVERSE_DEFAULT_COLOR : cell.bg;
+    }
+
+    isDefault = fg == VT_DEFAULT_COLOR;
+    if (isDefault) {
+        return 0;
+    }
+    if ((cell.attrs & VT_ATTR_BOLD) && fg < 8) {
+        fg += 8;
+    }
+    return VtScreen::paletteColor(fg);
+}
+
+void VtView::eventCallback(lv_event_t* e) {
+    VtView* view = static_cast<VtView*>(lv_event_get_user_data(e));
+    if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+        view->m_container = nullptr;
+        view->m_cursor = nullptr;
+        view->m_rows.clear();
+        view->m_cursorShown = false;
+        view->m_cursorRow = -1;
+    }
+}
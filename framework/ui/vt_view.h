@@ -0,0 +1,103 @@
+#ifndef VT_VIEW_H
+#define VT_VIEW_H
+
+#include "../system/os_config.h"
+#include "vt_screen.h"
+#include <lvgl.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file vt_view.h
+ * @brief Dirty-row renderer for a VtScreen
+ *
+ * One pooled label per screen row and a block object for the cursor.
+ * refresh() re-texts only rows the screen marked dirty, so a host that
+ * repaints one status line costs one label however much output arrived
+ * since the last frame. Foreground colours are drawn with label recolor
+ * spans; backgrounds and underline are not drawn, and reverse video shows
+ * the background colour (bright white on the default) as the text colour.
+ *
+ * Use a monospace font: cells are laid out at the width of '0'.
+ * All methods belong to the LVGL thread.
+ */
+
+class VtView {
+public:
+    VtView() = default;
+    ~VtView() = default;
+
+    VtView(const VtView&) = delete;
+    VtView& operator=(const VtView&) = delete;
+
+    /**
+     * @brief Create the widget
+     *
+     * The widget is deleted with its parent; the view notices and can be
+     * created again later.
+     * @param parent Parent object
+     * @param width Widget width
+     * @param height Widget height
+     * @param font Monospace text font
+     * @param color Default text color
+     * @return Widget container, or nullptr on failure
+     */
+    lv_obj_t* create(lv_obj_t* parent, lv_coord_t width, lv_coord_t height,
+                     const lv_font_t* font, lv_color_t color);
+
+    /**
+     * @brief Get the widget container
+     * @return Container or nullptr if not created
+     */
+    lv_obj_t* getObject() const { return m_container; }
+
+    /**
+     * @brief Show a screen; the whole screen is drawn on the next refresh
+     * @param screen Screen to show, or nullptr to show nothing
+     */
+    void bind(VtScreen* screen);
+
+    /**
+     * @brief Get the bound screen
+     * @return Screen or nullptr
+     */
+    VtScreen* getScreen() const { return m_screen; }
+
+    /**
+     * @brief Re-text dirty rows and move the cursor (once per frame)
+     */
+    void refresh();
+
+    /**
+     * @brief Print redraw statistics
+     * @param tag Log tag of the owner
+     */
+    void printStats(const char* tag) const;
+
+private:
+    void renderRow(uint16_t row);
+    uint32_t cellColor(const VtCell& cell, bool& isDefault) const;
+
+    static void eventCallback(lv_event_t* e);
+
+    VtScreen* m_screen = nullptr;
+
+    // Widget
+    lv_obj_t* m_container = nullptr;
+    lv_obj_t* m_cursor = nullptr;
+    std::vector<lv_obj_t*> m_rows;      // One label per screen row
+    lv_coord_t m_rowHeight = 0;
+    lv_coord_t m_cellWidth = 0;
+    std::string m_text;                 // Row text with recolor spans, reused
+
+    // Cursor shown
+    int m_cursorRow = -1;
+    int m_cursorColumn = -1;
+    bool m_cursorShown = false;
+
+    // Statistics
+    uint32_t m_refreshes = 0;
+    uint32_t m_rowsRendered = 0;
+};
+
+#endif // VT_VIEW_H
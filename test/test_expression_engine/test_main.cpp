@@ -0,0 +1,77 @@
+/**
+ * @file test_main.cpp
+ * @brief Expression compiler regression tests (pio test -e test)
+ *
+ * Expressions are compiled and run without a sheet, so the OS does not
+ * need to boot.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "../../framework/system/expression_engine.h"
+
+// Far more signs than the loop task's stack could take one frame each
+static const size_t LONG_SIGN_RUN = 10000;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static double run(const std::string& text, CellError& error) {
+    CompiledExpression expression;
+    error = expression.compile(text.c_str());
+    if (error != CellError::NONE) {
+        return 0;
+    }
+    return expression.evaluate(nullptr, error);
+}
+
+static void test_long_sign_run_compiles_flat() {
+    CellError error;
+    double value = run(std::string(LONG_SIGN_RUN + 1, '-') + "2", error);
+    TEST_ASSERT_TRUE(error == CellError::NONE);
+    TEST_ASSERT_TRUE(value == -2);
+
+    value = run(std::string(LONG_SIGN_RUN, '-') + "2", error);
+    TEST_ASSERT_TRUE(error == CellError::NONE);
+    TEST_ASSERT_TRUE(value == 2);
+
+    std::string mixed;
+    for (size_t i = 0; i < LONG_SIGN_RUN; i++) {
+        mixed += (i % 3 == 0) ? '-' : '+';
+    }
+    value = run(mixed + "3*2", error);
+    TEST_ASSERT_TRUE(error == CellError::NONE);
+    TEST_ASSERT_TRUE(value == ((LONG_SIGN_RUN + 2) / 3 % 2 ? -6 : 6));
+}
+
+static void test_signs_keep_their_precedence() {
+    CellError error;
+    TEST_ASSERT_TRUE(run("-2%", error) == -0.02 && error == CellError::NONE);
+    TEST_ASSERT_TRUE(run("--3*2", error) == 6 && error == CellError::NONE);
+    TEST_ASSERT_TRUE(run("4--+-1", error) == 3 && error == CellError::NONE);
+    TEST_ASSERT_TRUE(run("-(1+2)*-2", error) == 6 && error == CellError::NONE);
+}
+
+static void test_deep_nesting_is_a_parse_error() {
+    CellError error;
+    run(std::string(LONG_SIGN_RUN, '(') + "1" + std::string(LONG_SIGN_RUN, ')'), error);
+    TEST_ASSERT_TRUE(error == CellError::PARSE);
+}
+
+void setup() {
+    // Give the serial monitor time to attach
+    delay(2000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_long_sign_run_compiles_flat);
+    RUN_TEST(test_signs_keep_their_precedence);
+    RUN_TEST(test_deep_nesting_is_a_parse_error);
+    UNITY_END();
+}
+
+void loop() {
+}
@@ -0,0 +1,96 @@
+/**
+ * @file test_main.cpp
+ * @brief TaskScheduler regression tests (pio test -e test)
+ *
+ * Each test drives its own scheduler, so the OS does not need to boot.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "../../framework/system/task_scheduler.h"
+
+static TaskScheduler scheduler;
+
+void setUp() {
+    TEST_ASSERT_EQUAL(OS_OK, scheduler.initialize());
+}
+
+void tearDown() {
+    scheduler.shutdown();
+}
+
+// Run the scheduler for a while, the way the main loop does
+static void runFor(uint32_t ms) {
+    uint32_t start = millis();
+    while (millis() - start < ms) {
+        scheduler.update(1);
+        delay(1);
+    }
+}
+
+static void test_rescheduled_slot_ignores_cancelled_deadline() {
+    uint32_t cancelledRuns = 0;
+    uint32_t cancelled = scheduler.scheduleOnce([&cancelledRuns]() { cancelledRuns++; },
+                                                OS_TASK_PRIORITY_NORMAL, 100);
+    TEST_ASSERT_NOT_EQUAL(0, cancelled);
+    TEST_ASSERT_TRUE(scheduler.cancelTask(cancelled));
+
+    // Free slots are reused LIFO, so this lands in the cancelled task's slot
+    uint32_t runs = 0;
+    uint32_t rescheduled = scheduler.scheduleOnce([&runs]() { runs++; },
+                                                  OS_TASK_PRIORITY_NORMAL, 400);
+    TEST_ASSERT_NOT_EQUAL(0, rescheduled);
+
+    // Past the cancelled deadline but before the new one
+    runFor(250);
+    TEST_ASSERT_EQUAL_UINT32(0, runs);
+    TEST_ASSERT_EQUAL_UINT32(0, cancelledRuns);
+
+    runFor(250);
+    TEST_ASSERT_EQUAL_UINT32(1, runs);
+    TEST_ASSERT_EQUAL_UINT32(0, cancelledRuns);
+}
+
+static void test_rescheduled_periodic_keeps_its_own_period() {
+    uint32_t cancelled = scheduler.schedulePeriodic([]() {}, 50);
+    TEST_ASSERT_NOT_EQUAL(0, cancelled);
+    TEST_ASSERT_TRUE(scheduler.cancelTask(cancelled));
+
+    uint32_t runs = 0;
+    uint32_t rescheduled = scheduler.schedulePeriodic([&runs]() { runs++; }, 200,
+                                                      OS_TASK_PRIORITY_NORMAL, 200);
+    TEST_ASSERT_NOT_EQUAL(0, rescheduled);
+
+    // The 50 ms entries left behind must not run the new task
+    runFor(150);
+    TEST_ASSERT_EQUAL_UINT32(0, runs);
+
+    runFor(500);
+    TEST_ASSERT_UINT32_WITHIN(1, 3, runs);
+    TEST_ASSERT_TRUE(scheduler.cancelTask(rescheduled));
+}
+
+static void test_cancel_leaves_other_tasks_due() {
+    uint32_t runs = 0;
+    uint32_t first = scheduler.scheduleOnce([]() {}, OS_TASK_PRIORITY_NORMAL, 100);
+    uint32_t second = scheduler.scheduleOnce([&runs]() { runs++; }, OS_TASK_PRIORITY_NORMAL, 100);
+    TEST_ASSERT_TRUE(scheduler.cancelTask(first));
+
+    runFor(200);
+    TEST_ASSERT_EQUAL_UINT32(1, runs);
+    TEST_ASSERT_NULL(scheduler.getTaskInfo(second));
+}
+
+void setup() {
+    // Give the serial monitor time to attach
+    delay(2000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rescheduled_slot_ignores_cancelled_deadline);
+    RUN_TEST(test_rescheduled_periodic_keeps_its_own_period);
+    RUN_TEST(test_cancel_leaves_other_tasks_due);
+    UNITY_END();
+}
+
+void loop() {
+}
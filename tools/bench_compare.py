@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Compare two benchmark suite captures.
+
+Reads the "BENCH ..." lines printed by framework/system/benchmark_suite.h
+from serial logs (anything else in the log is ignored), pairs up the
+metrics and prints the change of each. Units decide the direction: times
+(ns, us, ms) are better lower, rates (KB/s, ops/s, fps) better higher.
+
+    pio device monitor -e benchmark | tee after.log
+    tools/bench_compare.py before.log after.log --threshold 5
+
+Exits with 1 when a metric got worse by more than the threshold (percent)
+or a case failed in the second capture.
+"""
+
+import argparse
+import sys
+
+LOWER_IS_BETTER = {"ns", "us", "ms"}
+HIGHER_IS_BETTER = {"KB/s", "ops/s", "fps"}
+
+
+def parse(path):
+    """Return ({(case, metric): (value, unit)}, failed cases, target)."""
+    results, failed, target = {}, set(), None
+    with open(path, errors="replace") as f:
+        for line in f:
+            fields = line.split()
+            if "BENCH" not in fields:
+                continue
+            fields = fields[fields.index("BENCH") + 1:]
+            if not fields:
+                continue
+            if fields[0] == "BEGIN" and len(fields) >= 3:
+                target = fields[2]
+            elif fields[0] == "FAIL" and len(fields) >= 2:
+                failed.add(fields[1])
+            elif fields[0] not in ("SKIP", "END") and len(fields) == 4:
+                try:
+                    results[(fields[0], fields[1])] = (float(fields[2]), fields[3])
+                except ValueError:
+                    pass
+    return results, failed, target
+
+
+def change(before, after, unit):
+    """Percent change, positive when better."""
+    if before == 0:
+        return 0.0
+    delta = (after - before) / before * 100.0
+    return -delta if unit in LOWER_IS_BETTER else delta
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=5.0, help="regression threshold in percent")
+    args = parser.parse_args()
+
+    before, _, before_target = parse(args.before)
+    after, failed, after_target = parse(args.after)
+    if not before or not after:
+        sys.exit("no BENCH results in %s" % (args.before if not before else args.after))
+    if before_target != after_target:
+        print("warning: comparing %s against %s" % (before_target, after_target))
+
+    regressions = 0
+    for key in sorted(set(before) | set(after)):
+        name = "%s.%s" % key
+        if key not in before or key not in after:
+            print("%-48s %s" % (name, "new" if key not in before else "gone"))
+            continue
+        (old, unit), (new, new_unit) = before[key], after[key]
+        if unit != new_unit or (unit not in LOWER_IS_BETTER and unit not in HIGHER_IS_BETTER):
+            print("%-48s %12.3f -> %12.3f %s" % (name, old, new, new_unit))
+            continue
+        better = change(old, new, unit)
+        mark = ""
+        if better < -args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif better > args.threshold:
+            mark = "  improved"
+        print("%-48s %12.3f -> %12.3f %-6s %+7.1f%%%s" % (name, old, new, unit, better, mark))
+
+    for case in sorted(failed):
+        print("%-48s FAILED" % case)
+
+    print("%d regressions over %.1f%%, %d failed cases" % (regressions, args.threshold, len(failed)))
+    return 1 if regressions or failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Decode serial capture logs written by framework/system/serial_capture.h.
+
+    python3 tools/capture_decode.py rs485_20250101_120000.t5cap
+    python3 tools/capture_decode.py LOG --from 3600 --to 3610 --hex
+    python3 tools/capture_decode.py LOG --stats
+
+Seeking uses the "<log>.idx" index written next to the log: one entry per
+block, so --from is a binary search plus one block read however long the
+capture is. Without an index (or with a stale one after power loss) the
+block headers are walked instead, which reads 32 bytes per block.
+"""
+
+import argparse
+import bisect
+import datetime
+import os
+import struct
+import sys
+
+FILE_MAGIC = 0x50433554     # "T5CP"
+BLOCK_MAGIC = 0x4B423554    # "T5BK"
+FILE_HEADER = struct.Struct("<IHHIIq8s")    # CaptureFileHeader, 32 bytes
+BLOCK_HEADER = struct.Struct("<IIqQIHH")    # CaptureBlockHeader, 32 bytes
+INDEX_ENTRY = struct.Struct("<qQ")          # CaptureIndexEntry, 16 bytes
+
+RECORD_TX = 0x01
+RECORD_DATA_LOST = 0x02
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def load_index(log, path, size, first_block):
+    """Return [(first_us, offset)] from the sidecar index, or by walking blocks."""
+    index = []
+    index_path = path + ".idx"
+    if os.path.exists(index_path):
+        with open(index_path, "rb") as f:
+            raw = f.read()
+        usable = len(raw) - len(raw) % INDEX_ENTRY.size
+        index = [INDEX_ENTRY.unpack_from(raw, i) for i in range(0, usable, INDEX_ENTRY.size)]
+        index = [(t, o) for t, o in index if o + BLOCK_HEADER.size <= size]
+
+    # Blocks written after the last index entry reached the card
+    offset = index[-1][1] if index else first_block
+    if index:
+        log.seek(offset)
+        header = log.read(BLOCK_HEADER.size)
+        if len(header) == BLOCK_HEADER.size:
+            offset += BLOCK_HEADER.size + BLOCK_HEADER.unpack(header)[4]
+    while offset + BLOCK_HEADER.size <= size:
+        log.seek(offset)
+        magic, _, first_us, _, length, _, _ = BLOCK_HEADER.unpack(log.read(BLOCK_HEADER.size))
+        if magic != BLOCK_MAGIC or offset + BLOCK_HEADER.size + length > size:
+            break
+        index.append((first_us, offset))
+        offset += BLOCK_HEADER.size + length
+    return index
+
+
+def records(log, index, start):
+    """Yield (time_us, flags, payload) from the block holding time `start` onward."""
+    times = [t for t, _ in index]
+    first = max(bisect.bisect_right(times, start) - 1, 0)
+    for _, offset in index[first:]:
+        log.seek(offset)
+        magic, _, time_us, _, length, count, _ = BLOCK_HEADER.unpack(log.read(BLOCK_HEADER.size))
+        if magic != BLOCK_MAGIC:
+            return
+        body = log.read(length)
+        pos = 0
+        for _ in range(count):
+            if pos >= len(body):
+                break
+            flags = body[pos]
+            delta, pos = read_varint(body, pos + 1)
+            size, pos = read_varint(body, pos)
+            time_us += delta
+            if flags & RECORD_DATA_LOST:
+                yield time_us, flags, size
+                continue
+            yield time_us, flags, body[pos:pos + size]
+            pos += size
+
+
+def format_payload(payload, hex_mode):
+    if hex_mode:
+        return " ".join("%02X" % b for b in payload)
+    return "".join(chr(b) if 32 <= b <= 126 else "." for b in payload)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a serial capture log")
+    parser.add_argument("log")
+    parser.add_argument("--from", dest="start", type=float, default=0.0,
+                        help="start time in seconds from the beginning of the capture")
+    parser.add_argument("--to", dest="end", type=float, default=None,
+                        help="end time in seconds")
+    parser.add_argument("--hex", action="store_true", help="print payloads as hex")
+    parser.add_argument("--direction", choices=("rx", "tx"), help="only one direction")
+    parser.add_argument("--stats", action="store_true", help="print totals only")
+    args = parser.parse_args()
+
+    size = os.path.getsize(args.log)
+    with open(args.log, "rb") as log:
+        magic, version, header_size, _, baud, epoch_us, source = \
+            FILE_HEADER.unpack(log.read(FILE_HEADER.size))
+        if magic != FILE_MAGIC:
+            sys.exit("%s: not a capture log" % args.log)
+        started = datetime.datetime.fromtimestamp(epoch_us / 1e6)
+        print("# %s v%d, %s, %d baud, started %s" % (
+            source.rstrip(b"\0").decode(errors="replace"), version, args.log, baud,
+            started.isoformat(sep=" ", timespec="milliseconds")))
+
+        index = load_index(log, args.log, size, header_size)
+        start_us = int(args.start * 1e6)
+        end_us = int(args.end * 1e6) if args.end is not None else None
+
+        totals = {"rx": 0, "tx": 0, "records": 0, "lost": 0}
+        last_us = 0
+        for time_us, flags, payload in records(log, index, start_us):
+            if time_us < start_us:
+                continue
+            if end_us is not None and time_us > end_us:
+                break
+            last_us = time_us
+            if flags & RECORD_DATA_LOST:
+                totals["lost"] += payload
+                if not args.stats:
+                    print("[%12.6f] -- %d bytes lost --" % (time_us / 1e6, payload))
+                continue
+
+            direction = "tx" if flags & RECORD_TX else "rx"
+            if args.direction and direction != args.direction:
+                continue
+            totals[direction] += len(payload)
+            totals["records"] += 1
+            if not args.stats:
+                print("[%12.6f] %s %4d: %s" % (time_us / 1e6, direction.upper(), len(payload),
+                                               format_payload(payload, args.hex)))
+
+        print("# %d blocks, %d records, RX %d bytes, TX %d bytes, %d lost, last at %.3f s" % (
+            len(index), totals["records"], totals["rx"], totals["tx"], totals["lost"],
+            last_us / 1e6))
+
+
+if __name__ == "__main__":
+    main()
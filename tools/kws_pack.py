@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Quantise a trained dense keyword-spotting network into the .kws file read by
+framework/system/keyword_spotter.h.
+
+    python3 tools/kws_pack.py model.npz wakeword.kws --keyword "hey tab" \\
+        --keyword-class 2 --frames 49 --coefficients 10 --calibration feats.npy
+
+model.npz holds W0, b0, W1, b1, ... with each W shaped (outputs, inputs) as
+a PyTorch nn.Linear stores it; hidden layers use ReLU and the last layer is
+the logits. The network input is the feature window flattened frame by frame
+(oldest first), exactly as the firmware computes it: 40 log-mel bands from a
+512-point FFT of 16 kHz audio, 20 ms hop, orthonormal DCT-II.
+
+Weights and activations become Q15. A per-layer dsps_dotprod_s16 shift keeps
+the dot product inside int16, and activation ranges come from --calibration
+(an N x frames*coefficients array of real features) when given, otherwise
+from a conservative L1 bound. Copy the result to /sdcard/models/wakeword.kws.
+"""
+
+import argparse
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = 0x3153574B      # "KWS1"
+VERSION = 1
+HEADER = struct.Struct("<IHHHHHHff24s")     # KwsModelHeader, 48 bytes
+LAYER = struct.Struct("<HHbBHff")           # KwsLayerHeader, 16 bytes
+Q15 = 32768.0
+
+
+def pad8(n):
+    return (n + 7) & ~7
+
+
+def load_layers(path):
+    data = np.load(path)
+    layers = []
+    while "W%d" % len(layers) in data:
+        i = len(layers)
+        layers.append((data["W%d" % i].astype(np.float64), data["b%d" % i].astype(np.float64)))
+    if not layers:
+        sys.exit("%s has no W0/b0 arrays" % path)
+    return layers
+
+
+def pick_shift(weights, input_scale, weight_max):
+    """Largest shift for which no row's dot product can leave int16."""
+    bound = np.abs(weights).sum(axis=1).max() * input_scale        # Real |sum| bound
+    steps = bound * (32767.0 / weight_max) * (Q15 / input_scale)   # Integer sum bound
+    for shift in range(15, -16, -1):
+        if steps / 2.0 ** (15 - shift) < 32767:
+            return shift
+    return -15
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("model", help="npz with W0, b0, W1, b1, ...")
+    parser.add_argument("output", help=".kws file to write")
+    parser.add_argument("--keyword", required=True)
+    parser.add_argument("--keyword-class", type=int, required=True)
+    parser.add_argument("--frames", type=int, default=49)
+    parser.add_argument("--coefficients", type=int, default=10)
+    parser.add_argument("--threshold", type=float, default=0.8)
+    parser.add_argument("--feature-scale", type=float, help="Default: fit calibration features into Q15")
+    parser.add_argument("--calibration", help="npy of real feature windows for activation ranges")
+    args = parser.parse_args()
+
+    layers = load_layers(args.model)
+    feature_count = args.frames * args.coefficients
+    if layers[0][0].shape[1] != feature_count:
+        sys.exit("W0 takes %d inputs, frames x coefficients is %d" % (layers[0][0].shape[1], feature_count))
+    classes = layers[-1][0].shape[0]
+    if not 0 <= args.keyword_class < classes:
+        sys.exit("--keyword-class must be below %d" % classes)
+
+    calibration = np.load(args.calibration).astype(np.float64) if args.calibration else None
+    feature_scale = args.feature_scale
+    if feature_scale is None:
+        if calibration is None:
+            sys.exit("--feature-scale is required without --calibration")
+        feature_scale = 0.99 / np.abs(calibration).max()
+
+    body = bytearray()
+    input_scale = 1.0 / feature_scale       # Real value of a full-scale Q15 input
+    activations = calibration
+    for index, (weights, bias) in enumerate(layers):
+        outputs, inputs = weights.shape
+        last = index == len(layers) - 1
+        weight_max = max(np.abs(weights).max(), 1e-12)
+        shift = pick_shift(weights, input_scale, weight_max)
+        weight_scale = 2.0 ** (15 - shift) * weight_max * input_scale / (32767.0 * Q15)
+
+        if activations is not None:
+            activations = activations @ weights.T + bias
+            if not last:
+                activations = np.maximum(activations, 0.0)
+            output_scale = np.abs(activations).max() * 1.01
+        else:
+            output_scale = np.abs(weights).sum(axis=1).max() * input_scale + np.abs(bias).max()
+        output_scale = max(output_scale, 1e-6)
+
+        quantised = np.zeros((outputs, pad8(inputs)), dtype="<i2")
+        quantised[:, :inputs] = np.clip(np.round(weights / weight_max * 32767.0), -32768, 32767)
+        body += LAYER.pack(pad8(inputs), outputs, shift, 0 if last else 1, 0, weight_scale, output_scale)
+        body += quantised.tobytes()
+        body += bias.astype("<f4").tobytes()
+        print("layer %d: %d -> %d, shift %d, output range %.3f" % (index, inputs, outputs, shift, output_scale))
+        input_scale = output_scale
+
+    header = HEADER.pack(MAGIC, VERSION, len(layers), args.frames, args.coefficients, classes,
+                         args.keyword_class, feature_scale, args.threshold,
+                         args.keyword.encode("utf-8")[:23])
+    with open(args.output, "wb") as f:
+        f.write(header)
+        f.write(body)
+    print("%s: %d bytes, keyword \"%s\"" % (args.output, len(header) + len(body), args.keyword))
+
+
+if __name__ == "__main__":
+    main()
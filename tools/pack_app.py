@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Build .app packages for ModularAppManager.
+
+Writes the layout read by framework/system/app_package.h. A package is built
+from a directory holding the app's files and a manifest.json with at least
+"id" and "version" (and optionally "name", "description", "author",
+"category", "icon", "permissions", "dependencies"):
+
+    tools/pack_app.py build apps/calendar -o calendar.app
+
+A delta package updates an installed version to a newer one and carries
+only the blocks that changed; blocks the old version already has, even at
+another offset, are copied on the device from the installed files:
+
+    tools/pack_app.py delta calendar-1.0 calendar-1.1 -o calendar-1.1.delta.app
+
+Either can be signed with an EC private key in PEM form, using the openssl
+command line tool; the firmware checks it against OS_APP_SIGNING_KEY:
+
+    tools/pack_app.py build apps/calendar -o calendar.app --key signing.pem
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import struct
+import subprocess
+import sys
+import zlib
+
+MAGIC = 0x4B503554      # "T5PK"
+END_MAGIC = 0x45503554  # "T5PE"
+VERSION = 1
+HEADER = struct.Struct("<IHHIIIIII")    # AppPackageHeader, 32 bytes
+ENTRY = struct.Struct("<HBBIII")        # AppPackageEntry, 16 bytes
+OP = struct.Struct("<II")               # AppPackageDeltaOp, 8 bytes
+TRAILER = struct.Struct("<IHH32s")      # AppPackageTrailer, 40 bytes
+
+FLAG_DELTA = 1 << 0
+FLAG_SIGNED = 1 << 1
+TYPE_FILE, TYPE_DIRECTORY, TYPE_DELTA = range(3)
+LITERAL = 0xFFFFFFFF
+
+MANIFEST = "manifest.json"
+MANIFEST_MAX = 4096     # OS_APP_MANIFEST_MAX
+PATH_MAX = 128          # OS_APP_PACKAGE_PATH_MAX
+
+
+def collect(app_dir):
+    """Return (directories, files) as sorted relative '/' paths."""
+    directories, files = [], []
+    for root, dirs, names in os.walk(app_dir):
+        dirs.sort()
+        rel = os.path.relpath(root, app_dir).replace(os.sep, "/")
+        if rel != ".":
+            directories.append(rel)
+        for name in sorted(names):
+            files.append(name if rel == "." else rel + "/" + name)
+    for path in directories + files:
+        if len(path.encode()) > PATH_MAX:
+            sys.exit("path too long for a package: " + path)
+    return directories, files
+
+
+def read(app_dir, path):
+    with open(os.path.join(app_dir, path), "rb") as f:
+        return f.read()
+
+
+def load_manifest(app_dir):
+    try:
+        manifest = json.loads(read(app_dir, MANIFEST))
+    except (OSError, ValueError) as e:
+        sys.exit("%s: %s" % (os.path.join(app_dir, MANIFEST), e))
+    if not manifest.get("id") or not manifest.get("version"):
+        sys.exit("manifest needs an id and a version")
+    return manifest
+
+
+def entry(path, type_, body, output):
+    name = path.encode()
+    return ENTRY.pack(len(name), type_, 0, len(body), len(output),
+                      zlib.crc32(output) & 0xFFFFFFFF) + name + body
+
+
+def weak_sum(block):
+    """Rolling checksum (rsync style) of a block."""
+    a = sum(block) & 0xFFFF
+    b = sum((len(block) - i) * c for i, c in enumerate(block)) & 0xFFFF
+    return a, b
+
+
+def diff(old, new, block_size):
+    """Encode new as copies of old's blocks plus literals."""
+    index = {}
+    for block in range(len(old) // block_size):
+        data = old[block * block_size:(block + 1) * block_size]
+        index.setdefault(weak_sum(data), []).append(block)
+
+    ops = []    # [block or LITERAL, length, literal bytes]
+
+    def emit_copy(block, length):
+        last = ops[-1] if ops else None
+        if last and last[0] != LITERAL and last[0] * block_size + last[1] == block * block_size:
+            last[1] += length
+        else:
+            ops.append([block, length, b""])
+
+    def emit_literal(data):
+        if ops and ops[-1][0] == LITERAL:
+            ops[-1][1] += len(data)
+            ops[-1][2] += data
+        else:
+            ops.append([LITERAL, len(data), bytes(data)])
+
+    pos, literal_start = 0, 0
+    a = b = None
+    while pos + block_size <= len(new):
+        if a is None:
+            a, b = weak_sum(new[pos:pos + block_size])
+        match = None
+        for block in index.get((a, b), ()):
+            if old[block * block_size:(block + 1) * block_size] == new[pos:pos + block_size]:
+                match = block
+                break
+        if match is not None:
+            if literal_start < pos:
+                emit_literal(new[literal_start:pos])
+            emit_copy(match, block_size)
+            pos += block_size
+            literal_start = pos
+            a = None
+            continue
+        # Roll the window one byte
+        out, inc = new[pos], new[pos + block_size] if pos + block_size < len(new) else None
+        pos += 1
+        if inc is None:
+            break
+        a = (a - out + inc) & 0xFFFF
+        b = (b - block_size * out + a) & 0xFFFF
+
+    # What is left can still end with the old file's partial last block
+    tail = new[literal_start:]
+    old_tail = len(old) // block_size * block_size
+    if len(old) > old_tail and len(tail) >= len(old) - old_tail and tail.endswith(old[old_tail:]):
+        if len(tail) > len(old) - old_tail:
+            emit_literal(tail[:len(tail) - (len(old) - old_tail)])
+        emit_copy(old_tail // block_size, len(old) - old_tail)
+    elif tail:
+        emit_literal(tail)
+
+    return b"".join(OP.pack(block, length) + data for block, length, data in ops)
+
+
+def package(manifest, entries, count, install_size, flags, block_size, key):
+    manifest = json.dumps(manifest, separators=(",", ":")).encode()
+    if len(manifest) > MANIFEST_MAX:
+        sys.exit("manifest larger than %d bytes" % MANIFEST_MAX)
+    if key:
+        flags |= FLAG_SIGNED
+    body = HEADER.pack(MAGIC, VERSION, flags, len(manifest), count, block_size,
+                       install_size, 0, 0) + manifest + b"".join(entries)
+
+    signature = b""
+    if key:
+        signature = subprocess.run(["openssl", "dgst", "-sha256", "-sign", key],
+                                   input=body, stdout=subprocess.PIPE, check=True).stdout
+    return body + TRAILER.pack(END_MAGIC, len(signature), 0, hashlib.sha256(body).digest()) + signature
+
+
+def build(app_dir, key):
+    manifest = load_manifest(app_dir)
+    directories, files = collect(app_dir)
+    entries = [entry(path, TYPE_DIRECTORY, b"", b"") for path in directories]
+    install_size = 0
+    for path in files:
+        data = read(app_dir, path)
+        entries.append(entry(path, TYPE_FILE, data, data))
+        install_size += len(data)
+    return package(manifest, entries, len(entries), install_size, 0, 0, key)
+
+
+def delta(old_dir, new_dir, block_size, key):
+    old_manifest, manifest = load_manifest(old_dir), load_manifest(new_dir)
+    if old_manifest["id"] != manifest["id"]:
+        sys.exit("delta between different apps")
+    manifest["base_version"] = old_manifest["version"]
+
+    old_files = set(collect(old_dir)[1])
+    directories, files = collect(new_dir)
+    entries = [entry(path, TYPE_DIRECTORY, b"", b"") for path in directories]
+    install_size, sent = 0, 0
+    for path in files:
+        data = read(new_dir, path)
+        install_size += len(data)
+        if path in old_files:
+            ops = diff(read(old_dir, path), data, block_size)
+            if len(ops) < len(data):
+                entries.append(entry(path, TYPE_DELTA, ops, data))
+                sent += len(ops)
+                continue
+        entries.append(entry(path, TYPE_FILE, data, data))
+        sent += len(data)
+
+    print("%s %s -> %s: %d of %d bytes sent" % (manifest["id"], manifest["base_version"],
+                                                manifest["version"], sent, install_size))
+    return package(manifest, entries, len(entries), install_size, FLAG_DELTA, block_size, key)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    full = commands.add_parser("build", help="full package")
+    full.add_argument("app_dir")
+    update = commands.add_parser("delta", help="delta package between two versions")
+    update.add_argument("old_dir")
+    update.add_argument("new_dir")
+    update.add_argument("--block-size", type=int, default=4096)
+    for command in (full, update):
+        command.add_argument("-o", "--output", required=True)
+        command.add_argument("--key", help="EC private key (PEM) to sign with")
+    args = parser.parse_args()
+
+    if args.command == "build":
+        data = build(args.app_dir, args.key)
+    else:
+        data = delta(args.old_dir, args.new_dir, args.block_size, args.key)
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+
+if __name__ == "__main__":
+    main()
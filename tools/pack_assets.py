@@ -0,0 +1,153 @@
+"""
+PlatformIO pre-build step: pack assets/ into the flash asset partition image.
+
+Produces $BUILD_DIR/assets.bin in the layout read by framework/hal/asset_pack.h
+and adds an "upload_assets" target that writes it to the "assets" partition
+from partitions.csv:
+
+    pio run -e esp32-p4-evboard -t upload_assets
+
+The image is only rebuilt when a file under assets/ is newer than it.
+LVGL images converted to binary (.bin from the LVGL image converter) are
+stored with their 4-byte header split into the index entry, so the firmware
+can point lv_img_dsc_t.data straight at mapped flash.
+"""
+
+import os
+import struct
+import zlib
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+MAGIC = 0x50413554  # "T5AP"
+VERSION = 1
+HEADER = struct.Struct("<IHHIIIIII")        # AssetPackHeader, 32 bytes
+ENTRY = struct.Struct("<IIIIBBHHH")         # AssetEntry, 24 bytes
+DATA_ALIGN = 16
+
+TYPE_RAW, TYPE_IMAGE, TYPE_FONT, TYPE_AUDIO = range(4)
+FONT_EXTENSIONS = (".fnt", ".ttf", ".otf")
+AUDIO_EXTENSIONS = (".wav", ".pcm", ".mp3", ".raw")
+
+
+def fnv1a(name):
+    value = 2166136261
+    for byte in name.encode("utf-8"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def classify(name, data):
+    """Return (type, color format, width, height, payload)."""
+    lower = name.lower()
+    if lower.endswith(".bin") and len(data) >= 4:
+        header = struct.unpack_from("<I", data)[0]
+        color_format = header & 0x1F
+        always_zero = (header >> 5) & 0x7
+        width = (header >> 10) & 0x7FF
+        height = (header >> 21) & 0x7FF
+        if always_zero == 0 and color_format and width and height:
+            return TYPE_IMAGE, color_format, width, height, data[4:]
+    if lower.endswith(FONT_EXTENSIONS):
+        return TYPE_FONT, 0, 0, 0, data
+    if lower.endswith(AUDIO_EXTENSIONS):
+        return TYPE_AUDIO, 0, 0, 0, data
+    return TYPE_RAW, 0, 0, 0, data
+
+
+def collect(asset_dir):
+    assets = []
+    for root, _, files in os.walk(asset_dir):
+        for filename in files:
+            if filename.startswith("."):
+                continue
+            path = os.path.join(root, filename)
+            name = os.path.relpath(path, asset_dir).replace(os.sep, "/")
+            with open(path, "rb") as f:
+                assets.append((name, f.read()))
+    return assets
+
+
+def pack(assets):
+    # Sorted by (hash, name) so the firmware can binary search the hash
+    assets.sort(key=lambda asset: (fnv1a(asset[0]), asset[0]))
+
+    names = bytearray()
+    name_offsets = []
+    for name, _ in assets:
+        name_offsets.append(len(names))
+        names += name.encode("utf-8") + b"\0"
+
+    index_offset = HEADER.size
+    names_offset = index_offset + ENTRY.size * len(assets)
+    data_offset = names_offset + len(names)
+    data_offset += -data_offset % DATA_ALIGN
+
+    entries = bytearray()
+    blobs = bytearray()
+    for (name, data), name_offset in zip(assets, name_offsets):
+        asset_type, color_format, width, height, payload = classify(name, data)
+        offset = data_offset + len(blobs)
+        entries += ENTRY.pack(fnv1a(name), name_offset, offset, len(payload),
+                              asset_type, color_format, width, height, 0)
+        blobs += payload
+        blobs += b"\0" * (-len(blobs) % DATA_ALIGN)
+
+    padding = b"\0" * (data_offset - names_offset - len(names))
+    index = bytes(entries) + bytes(names) + padding
+    total_size = data_offset + len(blobs)
+    header = HEADER.pack(MAGIC, VERSION, 0, len(assets), index_offset, names_offset,
+                         data_offset, total_size, zlib.crc32(index) & 0xFFFFFFFF)
+    return header + index + bytes(blobs)
+
+
+def partition_offset(partitions_csv, label):
+    """Return (offset, size) of a partition, or None."""
+    if not os.path.isfile(partitions_csv):
+        return None
+    with open(partitions_csv) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == label:
+                return int(fields[3], 0), int(fields[4], 0)
+    return None
+
+
+def newest_mtime(asset_dir):
+    newest = 0
+    for root, _, files in os.walk(asset_dir):
+        for filename in files:
+            newest = max(newest, os.path.getmtime(os.path.join(root, filename)))
+    return newest
+
+
+project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+build_dir = env.subst("$BUILD_DIR")  # noqa: F821
+asset_dir = os.path.join(project_dir, "assets")
+image_path = os.path.join(build_dir, "assets.bin")
+partitions_csv = os.path.join(project_dir, env.GetProjectOption("board_build.partitions", "partitions.csv"))  # noqa: F821
+partition = partition_offset(partitions_csv, "assets")
+
+if os.path.isdir(asset_dir):
+    if not os.path.isfile(image_path) or newest_mtime(asset_dir) > os.path.getmtime(image_path):
+        assets = collect(asset_dir)
+        image = pack(assets)
+        if partition and len(image) > partition[1]:
+            raise SystemExit("assets/ packs to %d bytes, the assets partition holds %d"
+                             % (len(image), partition[1]))
+        os.makedirs(build_dir, exist_ok=True)
+        with open(image_path, "wb") as f:
+            f.write(image)
+        print("Packed %d assets into %s (%d KB)" % (len(assets), image_path, len(image) // 1024))
+
+if partition:
+    env.AddCustomTarget(  # noqa: F821
+        name="upload_assets",
+        dependencies=None,
+        actions=[
+            '"$PYTHONEXE" "$UPLOADER" --chip esp32p4 --port "$UPLOAD_PORT" write_flash 0x%x "%s"'
+            % (partition[0], image_path)
+        ],
+        title="Upload assets",
+        description="Write the packed assets/ image to the assets partition",
+    )